@@ -0,0 +1,312 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#include <quantum_benchmark_fixture.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace Bloomberg::quantum;
+
+//==============================================================================================
+//                                      Allocators
+//==============================================================================================
+namespace {
+
+/// @brief Object of roughly the size of a small task or promise.
+struct Block
+{
+    char _data[64];
+};
+
+const AllocatorTraits::size_type PoolSize = 1000;
+const AllocatorTraits::size_type CoroPoolSize = 200;
+const AllocatorTraits::size_type CachedBlocks = 64;
+const AllocatorTraits::size_type CachedCoroStacks = 16;
+
+/// @brief Runs 'func' with AllocatorTraits::threadCacheSize() temporarily set to 'cacheSize'.
+///        The pools read the setting once, on construction.
+template <typename FUNC>
+auto withThreadCache(AllocatorTraits::size_type cacheSize, FUNC&& func) -> decltype(func())
+{
+    AllocatorTraits::size_type previous = AllocatorTraits::threadCacheSize();
+    AllocatorTraits::threadCacheSize() = cacheSize;
+    auto result = func();
+    AllocatorTraits::threadCacheSize() = previous;
+    return result;
+}
+
+// Each adapter wraps one allocator, shared by all the benchmark threads, behind the same interface.
+// 'capacity' is the pool size, beyond which the pools fall back to the heap.
+
+struct Malloc
+{
+    typedef Block* pointer;
+    static size_t capacity() { return PoolSize; }
+    pointer allocate() { return static_cast<pointer>(std::malloc(sizeof(Block))); }
+    void deallocate(pointer p) { std::free(p); }
+    size_t heapFallbacks() const { return 0; }
+};
+
+struct StdAllocator
+{
+    typedef Block* pointer;
+    static size_t capacity() { return PoolSize; }
+    pointer allocate() { return _alloc.allocate(1); }
+    void deallocate(pointer p) { _alloc.deallocate(p, 1); }
+    size_t heapFallbacks() const { return 0; }
+    std::allocator<Block> _alloc;
+};
+
+template <bool CACHED>
+struct HeapPool
+{
+    typedef Block* pointer;
+    static size_t capacity() { return PoolSize; }
+    HeapPool() : _alloc(withThreadCache(CACHED ? CachedBlocks : 0,
+                                        []{ return new HeapAllocator<Block>(PoolSize); }))
+    {}
+    pointer allocate() { return _alloc->allocate(); }
+    void deallocate(pointer p) { _alloc->deallocate(p); }
+    size_t heapFallbacks() const { return _alloc->stats().heapFallbackCount(); }
+    std::unique_ptr<HeapAllocator<Block>> _alloc;
+};
+
+struct StackPool
+{
+    typedef Block* pointer;
+    static size_t capacity() { return PoolSize; }
+    pointer allocate() { return _alloc.allocate(); }
+    void deallocate(pointer p) { _alloc.deallocate(p); }
+    size_t heapFallbacks() const { return _alloc.stats().heapFallbackCount(); }
+    StackAllocator<Block, PoolSize> _alloc;
+};
+
+struct CoroStackMalloc
+{
+    typedef boost::context::stack_context pointer;
+    static size_t capacity() { return CoroPoolSize; }
+    pointer allocate()
+    {
+        pointer ctx;
+        ctx.size = StackTraits::defaultSize();
+        ctx.sp = static_cast<char*>(std::malloc(ctx.size)) + ctx.size;
+        return ctx;
+    }
+    void deallocate(const pointer& ctx) { std::free(static_cast<char*>(ctx.sp) - ctx.size); }
+    size_t heapFallbacks() const { return 0; }
+};
+
+struct CoroStackStdAllocator
+{
+    typedef boost::context::stack_context pointer;
+    static size_t capacity() { return CoroPoolSize; }
+    pointer allocate()
+    {
+        pointer ctx;
+        ctx.size = StackTraits::defaultSize();
+        ctx.sp = _alloc.allocate(ctx.size) + ctx.size;
+        return ctx;
+    }
+    void deallocate(const pointer& ctx) { _alloc.deallocate(static_cast<char*>(ctx.sp) - ctx.size, ctx.size); }
+    size_t heapFallbacks() const { return 0; }
+    std::allocator<char> _alloc;
+};
+
+template <bool CACHED>
+struct CoroStackPool
+{
+    typedef boost::context::stack_context pointer;
+    static size_t capacity() { return CoroPoolSize; }
+    CoroStackPool() : _alloc(withThreadCache(CACHED ? CachedCoroStacks : 0,
+                                             []{ return new CoroutinePoolAllocator<StackTraitsProxy>(CoroPoolSize); }))
+    {}
+    pointer allocate() { return _alloc->allocate(); }
+    void deallocate(const pointer& ctx) { _alloc->deallocate(ctx); }
+    size_t heapFallbacks() const { return _alloc->stats().heapFallbackCount(); }
+    std::unique_ptr<CoroutinePoolAllocator<StackTraitsProxy>> _alloc;
+};
+
+/// @brief One allocator instance per adapter type, shared by all benchmarks and threads.
+///        Pools are reused across runs exactly like the library's static pools.
+template <typename ALLOC>
+ALLOC& sharedAllocator()
+{
+    static ALLOC alloc;
+    return alloc;
+}
+
+/// @brief Hands batches of blocks from a producer to a consumer thread which frees them.
+template <typename ALLOC>
+class CrossThreadFreer
+{
+public:
+    explicit CrossThreadFreer(ALLOC& alloc) :
+        _alloc(alloc),
+        _thread([this]{ run(); })
+    {}
+    ~CrossThreadFreer()
+    {
+        _stop = true;
+        _thread.join();
+    }
+    /// @brief Publishes a batch and waits until the previous one was freed. The caller may
+    ///        then reuse 'batch', which is swapped with the consumer's empty buffer.
+    void handOff(std::vector<typename ALLOC::pointer>& batch)
+    {
+        while (_pending.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        _batch.swap(batch);
+        _pending.store(true, std::memory_order_release);
+    }
+    void wait()
+    {
+        while (_pending.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+private:
+    void run()
+    {
+        while (!_stop.load(std::memory_order_relaxed))
+        {
+            if (!_pending.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for (auto& p : _batch)
+            {
+                _alloc.deallocate(p);
+            }
+            _batch.clear();
+            _pending.store(false, std::memory_order_release);
+        }
+    }
+    ALLOC&                                  _alloc;
+    std::vector<typename ALLOC::pointer>    _batch;
+    std::atomic_bool                        _pending{false};
+    std::atomic_bool                        _stop{false};
+    std::thread                             _thread;
+};
+
+}
+
+// Alloc/free throughput of one allocator shared by all the benchmark threads.
+// Each iteration allocates a batch of blocks then frees them in the same order.
+// Args: batch size per thread. Batches are sized so that 8 threads never exhaust the pools.
+template <typename ALLOC>
+static void BM_AllocFree(benchmark::State& state)
+{
+    ALLOC& alloc = sharedAllocator<ALLOC>();
+    std::vector<typename ALLOC::pointer> blocks(state.range(0));
+    for (auto _ : state)
+    {
+        for (auto& p : blocks)
+        {
+            p = alloc.allocate();
+        }
+        benchmark::ClobberMemory();
+        for (auto& p : blocks)
+        {
+            alloc.deallocate(p);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * blocks.size());
+}
+#define QUANTUM_ALLOC_FREE(ALLOC, BATCH) \
+    BENCHMARK_TEMPLATE(BM_AllocFree, ALLOC)->ArgName("batch")->Arg(1)->Arg(BATCH)->ThreadRange(1, 8)->UseRealTime()
+QUANTUM_ALLOC_FREE(Malloc, 64);
+QUANTUM_ALLOC_FREE(StdAllocator, 64);
+QUANTUM_ALLOC_FREE(HeapPool<false>, 64);
+QUANTUM_ALLOC_FREE(HeapPool<true>, 64);
+QUANTUM_ALLOC_FREE(StackPool, 64);
+QUANTUM_ALLOC_FREE(CoroStackMalloc, 16);
+QUANTUM_ALLOC_FREE(CoroStackStdAllocator, 16);
+QUANTUM_ALLOC_FREE(CoroStackPool<false>, 16);
+QUANTUM_ALLOC_FREE(CoroStackPool<true>, 16);
+
+// Cost of pool exhaustion. Each iteration holds a number of live blocks expressed as a percentage of
+// the pool capacity, so anything above 100% is served by the heap fallback. Single threaded.
+// Reports the number of heap fallbacks per iteration.
+template <typename ALLOC>
+static void BM_PoolExhaustion(benchmark::State& state)
+{
+    ALLOC& alloc = sharedAllocator<ALLOC>();
+    std::vector<typename ALLOC::pointer> blocks(ALLOC::capacity() * state.range(0) / 100);
+    size_t fallbacks = alloc.heapFallbacks();
+    for (auto _ : state)
+    {
+        for (auto& p : blocks)
+        {
+            p = alloc.allocate();
+        }
+        benchmark::ClobberMemory();
+        for (auto& p : blocks)
+        {
+            alloc.deallocate(p);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * blocks.size());
+    state.counters["fallbacks_per_iter"] = benchmark::Counter(alloc.heapFallbacks() - fallbacks,
+                                                              benchmark::Counter::kAvgIterations);
+}
+#define QUANTUM_POOL_EXHAUSTION(ALLOC) \
+    BENCHMARK_TEMPLATE(BM_PoolExhaustion, ALLOC)->ArgName("usedPercent")->Arg(50)->Arg(100)->Arg(150)->Arg(200)
+QUANTUM_POOL_EXHAUSTION(Malloc);
+QUANTUM_POOL_EXHAUSTION(StdAllocator);
+QUANTUM_POOL_EXHAUSTION(HeapPool<false>);
+QUANTUM_POOL_EXHAUSTION(StackPool);
+QUANTUM_POOL_EXHAUSTION(CoroStackMalloc);
+QUANTUM_POOL_EXHAUSTION(CoroStackPool<false>);
+
+// Blocks allocated on the benchmark thread and freed on another thread, which is how tasks,
+// promises and coroutine stacks created by a producer are released by the coroutine threads.
+// The producer allocates the next batch while the consumer frees the previous one. With the thread
+// cache enabled, freed blocks accumulate in the consumer's cache and the producer may fall back to the heap.
+// Args: batch size.
+template <typename ALLOC>
+static void BM_CrossThreadFree(benchmark::State& state)
+{
+    ALLOC& alloc = sharedAllocator<ALLOC>();
+    CrossThreadFreer<ALLOC> freer(alloc);
+    size_t fallbacks = alloc.heapFallbacks();
+    std::vector<typename ALLOC::pointer> blocks;
+    blocks.reserve(state.range(0));
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            blocks.push_back(alloc.allocate());
+        }
+        freer.handOff(blocks);
+    }
+    freer.wait();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["fallbacks_per_iter"] = benchmark::Counter(alloc.heapFallbacks() - fallbacks,
+                                                              benchmark::Counter::kAvgIterations);
+}
+#define QUANTUM_CROSS_THREAD_FREE(ALLOC, BATCH) \
+    BENCHMARK_TEMPLATE(BM_CrossThreadFree, ALLOC)->ArgName("batch")->Arg(1)->Arg(BATCH)->UseRealTime()
+QUANTUM_CROSS_THREAD_FREE(Malloc, 64);
+QUANTUM_CROSS_THREAD_FREE(StdAllocator, 64);
+QUANTUM_CROSS_THREAD_FREE(HeapPool<false>, 64);
+QUANTUM_CROSS_THREAD_FREE(HeapPool<true>, 64);
+QUANTUM_CROSS_THREAD_FREE(StackPool, 64);
+QUANTUM_CROSS_THREAD_FREE(CoroStackMalloc, 16);
+QUANTUM_CROSS_THREAD_FREE(CoroStackPool<false>, 16);
+QUANTUM_CROSS_THREAD_FREE(CoroStackPool<true>, 16);
@@ -0,0 +1,149 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#include <quantum_benchmark_fixture.h>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace Bloomberg::quantum;
+
+//==============================================================================================
+//                                  IO queue modes
+//==============================================================================================
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class IoMode : int { Shared = 0,                  ///< Single shared IO queue (default)
+                          LoadBalanced = 1,            ///< Load-balanced shared queues, fixed poll interval
+                          LoadBalancedBackoff = 2 };   ///< Load-balanced shared queues, exponential backoff
+
+std::unique_ptr<Dispatcher> makeDispatcher(IoMode mode, int numIoThreads, int pollIntervalMs)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(numIoThreads);
+    if (mode != IoMode::Shared)
+    {
+        config.setLoadBalanceSharedIoQueues(true);
+        config.setLoadBalancePollIntervalMs(std::chrono::milliseconds(pollIntervalMs));
+    }
+    if (mode == IoMode::LoadBalancedBackoff)
+    {
+        config.setLoadBalancePollIntervalBackoffPolicy(Configuration::BackoffPolicy::Exponential);
+        config.setLoadBalancePollIntervalNumBackoffs(5);
+    }
+    return std::unique_ptr<Dispatcher>(new Dispatcher(config));
+}
+
+double processCpuSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Sweeps the IO modes and thread counts. The poll interval only applies to the load-balanced modes.
+void ioModeArgs(benchmark::internal::Benchmark* benchmark, const std::vector<int64_t>& rates)
+{
+    benchmark->ArgNames({"mode", "ioThreads", "pollMs", "rate"});
+    for (int64_t mode : {0, 1, 2})
+    {
+        for (int64_t numThreads : {1, 4, 8})
+        {
+            for (int64_t pollMs : {1, 10})
+            {
+                if ((mode == 0) && (pollMs != 1))
+                {
+                    continue;
+                }
+                for (int64_t rate : rates)
+                {
+                    benchmark->Args({mode, numThreads, pollMs, rate});
+                }
+            }
+        }
+    }
+}
+
+}
+
+// Wake-up latency (post to start) and sustained throughput of shared-queue IO tasks.
+// Args: IO mode (0 = shared, 1 = load-balanced, 2 = load-balanced with backoff), number of IO threads,
+//       load-balance poll interval in ms, posting rate in tasks/s (0 = as fast as possible).
+static void BM_IoWakeup(benchmark::State& state)
+{
+    std::unique_ptr<Dispatcher> dispatcher = makeDispatcher(static_cast<IoMode>(state.range(0)),
+                                                            state.range(1), state.range(2));
+    const int64_t rate = state.range(3);
+    const Clock::duration period = rate ? Clock::duration(std::chrono::seconds(1)) / rate : Clock::duration::zero();
+    std::atomic<int64_t> completed{0};
+    std::mutex histogramMutex;
+    Histogram latency;
+    auto task = [&](ThreadPromise<int>::Ptr promise, Clock::time_point posted)->int {
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - posted).count();
+        {
+            std::lock_guard<std::mutex> lock(histogramMutex);
+            latency.record(elapsed);
+        }
+        completed.fetch_add(1, std::memory_order_relaxed);
+        return promise->set(0);
+    };
+    
+    int64_t posted = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point next = start;
+    for (auto _ : state)
+    {
+        if (rate)
+        {
+            std::this_thread::sleep_until(next);
+            next += period;
+        }
+        dispatcher->postAsyncIo(task, Clock::now());
+        ++posted;
+    }
+    waitForCompletion(state, completed, posted, start);
+    state.SetItemsProcessed(posted);
+    state.counters["p50_us"] = latency.percentile(50) / 1e3;
+    state.counters["p99_us"] = latency.percentile(99) / 1e3;
+    state.counters["p999_us"] = latency.percentile(99.9) / 1e3;
+}
+BENCHMARK(BM_IoWakeup)->Apply([](benchmark::internal::Benchmark* b){ ioModeArgs(b, {0, 1000, 10000}); })->UseRealTime();
+
+// CPU consumed by an idle dispatcher in each IO mode, as a percentage of one core.
+// The CPU used by the rest of the process over the same window is measured first and subtracted.
+// Args: same as BM_IoWakeup; the rate is unused.
+static void BM_IoIdleCpu(benchmark::State& state)
+{
+    const std::chrono::milliseconds window(250);
+    for (auto _ : state)
+    {
+        double baseline = processCpuSeconds();
+        std::this_thread::sleep_for(window);
+        baseline = processCpuSeconds() - baseline;
+        
+        std::unique_ptr<Dispatcher> dispatcher = makeDispatcher(static_cast<IoMode>(state.range(0)),
+                                                                state.range(1), state.range(2));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); //let the threads settle
+        double cpu = processCpuSeconds();
+        std::this_thread::sleep_for(window);
+        cpu = processCpuSeconds() - cpu - baseline;
+        state.counters["cpu_percent"] = std::max(0.0, cpu) * 100 * 1000 / window.count();
+    }
+}
+BENCHMARK(BM_IoIdleCpu)->Apply([](benchmark::internal::Benchmark* b){ ioModeArgs(b, {0}); })->Iterations(1)->UseRealTime();
@@ -0,0 +1,69 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_BENCHMARK_FIXTURE_H
+#define QUANTUM_BENCHMARK_FIXTURE_H
+
+#include <benchmark/benchmark.h>
+#include <quantum/quantum.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace quantum = Bloomberg::quantum;
+
+/// @brief Caches one dispatcher per thread configuration so that repeated benchmark runs
+///        do not measure thread start-up and tear-down.
+class BenchmarkDispatchers
+{
+public:
+    static quantum::Dispatcher& instance(int numCoroThreads, int numIoThreads)
+    {
+        static std::mutex mutex;
+        static std::map<std::pair<int,int>, std::unique_ptr<quantum::Dispatcher>> dispatchers;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<quantum::Dispatcher>& dispatcher = dispatchers[{numCoroThreads, numIoThreads}];
+        if (!dispatcher)
+        {
+            quantum::Configuration config;
+            config.setNumCoroutineThreads(numCoroThreads);
+            config.setNumIoThreads(numIoThreads);
+            dispatcher.reset(new quantum::Dispatcher(config));
+        }
+        return *dispatcher;
+    }
+};
+
+/// @brief Waits until 'completed' reaches 'posted' and reports the sustained rate measured from
+///        'start' as the 'sustained_per_s' counter. The benchmark timer itself stops when the loop
+///        exits and therefore only accounts for the cost of posting.
+inline void waitForCompletion(benchmark::State& state,
+                              const std::atomic<int64_t>& completed,
+                              int64_t posted,
+                              std::chrono::steady_clock::time_point start)
+{
+    while (completed.load(std::memory_order_relaxed) < posted)
+    {
+        std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    state.counters["sustained_per_s"] = posted / seconds; //summed across benchmark threads
+}
+
+#endif //QUANTUM_BENCHMARK_FIXTURE_H
@@ -0,0 +1,238 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#include <quantum_benchmark_fixture.h>
+#include <boost/coroutine2/all.hpp>
+#include <atomic>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace Bloomberg::quantum;
+
+//==============================================================================================
+//                                  Core dispatch paths
+//==============================================================================================
+// Latency of a single coroutine post followed by a blocking get() from a non-coroutine thread.
+// Arg: number of coroutine threads.
+static void BM_PostGetRoundTrip(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(state.range(0), 1);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(1);
+        })->get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PostGetRoundTrip)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+// Fire-and-forget post throughput. Each benchmark thread is a producer and waits at the end
+// until all of its coroutines have run.
+// Arg: number of coroutine threads. Threads: number of producers.
+static void BM_PostThroughput(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(state.range(0), 1);
+    std::atomic<int64_t> completed{0};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (auto _ : state)
+    {
+        dispatcher.post([&completed](CoroContext<int>::Ptr)->int {
+            completed.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    waitForCompletion(state, completed, state.iterations(), start);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PostThroughput)->RangeMultiplier(2)->Range(1, 8)->ThreadRange(1, 8)->UseRealTime();
+
+// Latency of a blocking IO task post followed by a get().
+// Arg: number of IO threads.
+static void BM_PostAsyncIoRoundTrip(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(1, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+            return promise->set(1);
+        })->get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PostAsyncIoRoundTrip)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+// Cost of a continuation chain of a given depth (first + then*N + end).
+// Args: chain depth, continuations run inline (see Configuration::setInlineContinuations()).
+static void BM_ThenChain(benchmark::State& state)
+{
+    static Dispatcher inlineDispatcher([]{
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(1);
+        config.setInlineContinuations(true);
+        return config;
+    }());
+    Dispatcher& dispatcher = state.range(1) ? inlineDispatcher : BenchmarkDispatchers::instance(4, 1);
+    auto func = [](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(1);
+    };
+    for (auto _ : state)
+    {
+        ThreadContext<int>::Ptr ctx = dispatcher.postFirst(func);
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            ctx = ctx->then(func);
+        }
+        benchmark::DoNotOptimize(ctx->end()->get());
+    }
+    state.SetItemsProcessed(state.iterations() * (state.range(0) + 1));
+}
+BENCHMARK(BM_ThenChain)->ArgsProduct({{1, 4, 16, 64, 256}, {0, 1}})->UseRealTime();
+
+// Rate at which a non-coroutine thread pulls values pushed by a coroutine into a Buffer.
+// Arg: number of values per buffer.
+static void BM_BufferPushPull(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(4, 1);
+    const int num = state.range(0);
+    for (auto _ : state)
+    {
+        ThreadContext<Buffer<int>>::Ptr ctx = dispatcher.post<Buffer<int>>([num](CoroContext<Buffer<int>>::Ptr ctx)->int {
+            for (int i = 0; i < num; ++i)
+            {
+                ctx->push(i);
+            }
+            return ctx->closeBuffer();
+        });
+        bool isBufferClosed = false;
+        while (!isBufferClosed)
+        {
+            benchmark::DoNotOptimize(ctx->pull(isBufferClosed));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num);
+}
+BENCHMARK(BM_BufferPushPull)->RangeMultiplier(10)->Range(10, 100000)->UseRealTime();
+
+//==============================================================================================
+//                                  Parallel algorithms
+//==============================================================================================
+// forEach() over a range of ints with one coroutine per element.
+// Args: number of elements, number of coroutine threads.
+static void BM_ForEach(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(state.range(1), 1);
+    std::vector<int> input(state.range(0));
+    std::iota(input.begin(), input.end(), 0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.forEach<int>(input.cbegin(), input.cend(), [](const int& value)->int {
+            return value * value;
+        })->get());
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ForEach)->ArgsProduct({{100, 10000}, {1, 2, 4, 8}})->UseRealTime();
+
+// forEachBatch() over the same input, which uses one coroutine per thread.
+// Args: number of elements, number of coroutine threads.
+static void BM_ForEachBatch(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(state.range(1), 1);
+    std::vector<int> input(state.range(0));
+    std::iota(input.begin(), input.end(), 0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.forEachBatch<int>(input.cbegin(), input.cend(), [](const int& value)->int {
+            return value * value;
+        })->get());
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ForEachBatch)->ArgsProduct({{100, 10000}, {1, 2, 4, 8}})->UseRealTime();
+
+// Word count with mapReduce() over a synthetic corpus of 64 distinct words.
+// Args: number of documents, number of coroutine threads.
+static void BM_MapReduce(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(state.range(1), 1);
+    std::vector<std::vector<std::string>> input(state.range(0));
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        for (size_t w = 0; w < 16; ++w)
+        {
+            input[i].push_back(std::to_string((i * 16 + w) % 64));
+        }
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.mapReduce<std::string, size_t, size_t>(input.begin(), input.end(),
+            [](const std::vector<std::string>& doc)->std::vector<std::pair<std::string, size_t>>
+            {
+                std::vector<std::pair<std::string, size_t>> out;
+                for (auto&& word : doc) {
+                    out.push_back({word, 1});
+                }
+                return out;
+            },
+            [](std::pair<std::string, std::vector<size_t>>&& counts)->std::pair<std::string, size_t>
+            {
+                return {std::move(counts.first), std::accumulate(counts.second.begin(), counts.second.end(), size_t{0})};
+            })->get());
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_MapReduce)->ArgsProduct({{100, 1000}, {1, 2, 4, 8}})->UseRealTime();
+
+// Cost of one resume and yield pair, without any scheduling, for each coroutine backend.
+// See __QUANTUM_USE_FIBER_COROUTINES.
+static void BM_CoroutineSwitch_Coroutines2(benchmark::State& state)
+{
+    using BoostCoro = boost::coroutines2::coroutine<int&>;
+    BoostCoro::push_type coro(Task::stackAllocator(0), [](BoostCoro::pull_type& yield) {
+        while (true) {
+            ++yield.get();
+            yield();
+        }
+    });
+    int rc = 0;
+    for (auto _ : state)
+    {
+        coro(rc);
+    }
+    benchmark::DoNotOptimize(rc);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CoroutineSwitch_Coroutines2);
+
+static void BM_CoroutineSwitch_Fiber(benchmark::State& state)
+{
+    FiberCoroutine coro(Task::stackAllocator(0), [](FiberYield& yield) {
+        while (true) {
+            ++yield.get();
+            yield();
+        }
+    });
+    int rc = 0;
+    for (auto _ : state)
+    {
+        coro(rc);
+    }
+    benchmark::DoNotOptimize(rc);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CoroutineSwitch_Fiber);
@@ -0,0 +1,121 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#include <quantum_benchmark_fixture.h>
+#include <quantum/util/quantum_sequencer.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Bloomberg::quantum;
+
+//==============================================================================================
+//                                  Sequencer
+//==============================================================================================
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class KeyDistribution : int { Uniform = 0, Zipfian = 1 };
+
+/// @brief Pre-generates a cyclic sequence of keys so that key selection is not measured.
+std::vector<int> makeKeys(int numKeys, KeyDistribution distribution, size_t count)
+{
+    std::mt19937 generator(12345);
+    std::vector<int> keys(count);
+    if (distribution == KeyDistribution::Uniform)
+    {
+        std::uniform_int_distribution<int> uniform(0, numKeys - 1);
+        for (auto&& key : keys)
+        {
+            key = uniform(generator);
+        }
+        return keys;
+    }
+    //Zipfian with exponent 0.99: sample the inverse of the cumulative distribution
+    std::vector<double> cdf(numKeys);
+    double sum = 0;
+    for (int i = 0; i < numKeys; ++i)
+    {
+        sum += 1.0 / std::pow(i + 1, 0.99);
+        cdf[i] = sum;
+    }
+    std::uniform_real_distribution<double> uniform(0, sum);
+    for (auto&& key : keys)
+    {
+        key = std::min<int>(numKeys - 1, std::lower_bound(cdf.begin(), cdf.end(), uniform(generator)) - cdf.begin());
+    }
+    return keys;
+}
+
+}
+
+// Post rate, sustained rate (posting and draining) and end-to-end (post to completion) latency of sequenced tasks.
+// Args: number of keys, key distribution (0 = uniform, 1 = Zipfian), percentage of multi-key posts,
+//       number of postAll() calls per 10000 posts.
+static void BM_SequencerPost(benchmark::State& state)
+{
+    Dispatcher& dispatcher = BenchmarkDispatchers::instance(4, 1);
+    const int numKeys = state.range(0);
+    const std::vector<int> keys = makeKeys(numKeys, static_cast<KeyDistribution>(state.range(1)), 1 << 16);
+    const int64_t multiKeyPercent = state.range(2);
+    const int64_t postAllPer10k = state.range(3);
+    
+    Sequencer<int> sequencer(dispatcher);
+    std::atomic<int64_t> completed{0};
+    std::mutex histogramMutex;
+    Histogram latency;
+    auto task = [&](CoroContext<int>::Ptr, Clock::time_point posted)->int {
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - posted).count();
+        {
+            std::lock_guard<std::mutex> lock(histogramMutex);
+            latency.record(elapsed);
+        }
+        completed.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    };
+    
+    int64_t posted = 0;
+    Clock::time_point start = Clock::now();
+    for (auto _ : state)
+    {
+        const int key = keys[posted & (keys.size() - 1)];
+        if ((postAllPer10k > 0) && ((posted % 10000) < postAllPer10k))
+        {
+            sequencer.postAll(task, Clock::now());
+        }
+        else if ((multiKeyPercent > 0) && ((posted % 100) < multiKeyPercent))
+        {
+            sequencer.post(std::vector<int>{key, keys[(posted + 1) & (keys.size() - 1)]}, task, Clock::now());
+        }
+        else
+        {
+            sequencer.post(key, task, Clock::now());
+        }
+        ++posted;
+    }
+    waitForCompletion(state, completed, posted, start);
+    state.SetItemsProcessed(posted);
+    state.counters["p50_us"] = latency.percentile(50) / 1e3;
+    state.counters["p99_us"] = latency.percentile(99) / 1e3;
+    state.counters["p999_us"] = latency.percentile(99.9) / 1e3;
+}
+BENCHMARK(BM_SequencerPost)
+    ->ArgNames({"keys", "zipf", "multi%", "postAll/10k"})
+    ->ArgsProduct({{1, 100, 10000}, {0, 1}, {0, 10}, {0, 10}})
+    ->UseRealTime();
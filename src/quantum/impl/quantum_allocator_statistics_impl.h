@@ -0,0 +1,89 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+size_t AllocatorStatistics::capacity() const
+{
+    return _capacity;
+}
+
+inline
+size_t AllocatorStatistics::allocatedCount() const
+{
+    return _allocatedCount;
+}
+
+inline
+size_t AllocatorStatistics::peakAllocatedCount() const
+{
+    return _peakAllocatedCount;
+}
+
+inline
+size_t AllocatorStatistics::heapAllocatedCount() const
+{
+    return _heapAllocatedCount;
+}
+
+inline
+size_t AllocatorStatistics::heapFallbackCount() const
+{
+    return _heapFallbackCount;
+}
+
+inline
+size_t AllocatorStatistics::lockContentionCount() const
+{
+    return _lockContentionCount;
+}
+
+inline
+void AllocatorStatistics::print(std::ostream& out) const
+{
+    out << "Capacity: " << _capacity << std::endl;
+    out << "Num allocated: " << _allocatedCount << std::endl;
+    out << "Peak allocated: " << _peakAllocatedCount << std::endl;
+    out << "Num heap allocated: " << _heapAllocatedCount << std::endl;
+    out << "Num heap fallbacks: " << _heapFallbackCount << std::endl;
+    out << "Num lock contentions: " << _lockContentionCount << std::endl;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const AllocatorStatistics& stats)
+{
+    stats.print(out);
+    return out;
+}
+
+inline
+PoolGuard::PoolGuard(SpinLock& lock, std::atomic<size_t>& contentionCount) :
+    _guard(lock, SpinLock::TryToLock{})
+{
+    if (!_guard.ownsLock()) {
+        contentionCount.fetch_add(1, std::memory_order_relaxed);
+        _guard.lock();
+    }
+}
+
+}}
@@ -0,0 +1,93 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+Barrier::Barrier(size_t numParticipants) :
+    _numParticipants(numParticipants),
+    _remaining(numParticipants),
+    _phase(0)
+{
+    if (numParticipants == 0)
+    {
+        throw std::runtime_error("Invalid number of participants");
+    }
+}
+
+inline
+bool Barrier::arriveAndWait()
+{
+    size_t phase;
+    if (arrive(phase))
+    {
+        return true;
+    }
+    _waiters.wait([this, phase]()->bool{ return _phase == phase; });
+    return false;
+}
+
+inline
+bool Barrier::arriveAndWait(ICoroSync::Ptr sync)
+{
+    size_t phase;
+    if (arrive(phase))
+    {
+        return true;
+    }
+    _waiters.wait(sync, [this, phase]()->bool{ return _phase == phase; });
+    return false;
+}
+
+inline
+size_t Barrier::numParticipants() const
+{
+    return _numParticipants;
+}
+
+inline
+size_t Barrier::phase() const
+{
+    return _phase.load(std::memory_order_acquire);
+}
+
+inline
+bool Barrier::arrive(size_t& phase)
+{
+    //A participant cannot arrive for the next phase before seeing this one complete,
+    //so the phase read here is always the one being counted.
+    phase = _phase.load(std::memory_order_acquire);
+    if (_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return false;
+    }
+    //Last participant: reset the counter before opening the next phase
+    _remaining.store(_numParticipants, std::memory_order_relaxed);
+    _phase.fetch_add(1, std::memory_order_seq_cst);
+    if (_waiters.hasWaiters())
+    {
+        _waiters.notifyAll();
+    }
+    return true;
+}
+
+}}
@@ -25,6 +25,18 @@ namespace quantum {
 template <class T, class ALLOCATOR>
 Buffer<T,ALLOCATOR>::Buffer(const ALLOCATOR& allocator) :
     _buffer(allocator),
+    _ring(allocator),
+    _head(0),
+    _size(0),
+    _isClosed(false)
+{}
+
+template <class T, class ALLOCATOR>
+Buffer<T,ALLOCATOR>::Buffer(size_t capacity, const ALLOCATOR& allocator) :
+    _buffer(allocator),
+    _ring(capacity, T(), allocator),
+    _head(0),
+    _size(0),
     _isClosed(false)
 {}
 
@@ -36,19 +48,40 @@ BufferStatus Buffer<T,ALLOCATOR>::push(V&& value)
     {
         return BufferStatus::Closed;
     }
-    _buffer.push_back(std::forward<V>(value));
+    if (_ring.empty())
+    {
+        _buffer.push_back(std::forward<V>(value));
+        return BufferStatus::DataPosted;
+    }
+    if (_size == _ring.size())
+    {
+        return BufferStatus::Full;
+    }
+    size_t tail = _head + _size;
+    _ring[(tail < _ring.size()) ? tail : tail - _ring.size()] = std::forward<V>(value);
+    ++_size;
     return BufferStatus::DataPosted;
 }
 
 template <class T, class ALLOCATOR>
 BufferStatus Buffer<T,ALLOCATOR>::pull(T& value)
 {
-    if (_buffer.empty())
+    if (empty())
     {
         return _isClosed ? BufferStatus::Closed : BufferStatus::DataPending;
     }
-    value = std::move(_buffer.front());
-    _buffer.pop_front();
+    if (_ring.empty())
+    {
+        value = std::move(_buffer.front());
+        _buffer.pop_front();
+        return BufferStatus::DataReceived;
+    }
+    value = std::move(_ring[_head]);
+    if (++_head == _ring.size())
+    {
+        _head = 0;
+    }
+    --_size;
     return BufferStatus::DataReceived;
 }
 
@@ -67,13 +100,25 @@ bool Buffer<T,ALLOCATOR>::isClosed() const
 template <class T, class ALLOCATOR>
 size_t Buffer<T,ALLOCATOR>::size() const
 {
-    return _buffer.size();
+    return _ring.empty() ? _buffer.size() : _size;
 }
 
 template <class T, class ALLOCATOR>
 bool Buffer<T,ALLOCATOR>::empty() const
 {
-    return _buffer.empty();
+    return size() == 0;
+}
+
+template <class T, class ALLOCATOR>
+size_t Buffer<T,ALLOCATOR>::capacity() const
+{
+    return _ring.size();
+}
+
+template <class T, class ALLOCATOR>
+bool Buffer<T,ALLOCATOR>::isFull() const
+{
+    return !_ring.empty() && (_size == _ring.size());
 }
 
 }}
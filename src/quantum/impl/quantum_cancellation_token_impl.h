@@ -0,0 +1,52 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+CancellationToken::Ptr CancellationToken::create()
+{
+    return std::make_shared<CancellationToken>();
+}
+
+inline
+void CancellationToken::cancel()
+{
+    _isCancelled.store(true, std::memory_order_release);
+}
+
+inline
+bool CancellationToken::isCancelled() const
+{
+    return _isCancelled.load(std::memory_order_acquire);
+}
+
+inline
+void CancellationToken::throwIfCancelled() const
+{
+    if (isCancelled())
+    {
+        throw CancellationException();
+    }
+}
+
+}}
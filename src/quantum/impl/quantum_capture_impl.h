@@ -44,111 +44,275 @@ makeCapture(FUNC&& func, ARGS&& ... args)
     return Capture<FUNC, ARGS...>(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+//==============================================================================================
+//                                 struct FunctionAllocator
+//==============================================================================================
+inline
+void* FunctionAllocator::allocate(size_t size)
+{
+    switch (sizeClass(size)) {
+        case 0: return pool<256>().allocate();
+        case 1: return pool<512>().allocate();
+        case 2: return pool<1024>().allocate();
+        case 3: return pool<2048>().allocate();
+        case 4: return pool<4096>().allocate();
+        default:
+            numHeapAllocated().fetch_add(1, std::memory_order_relaxed);
+            numHeapFallbacks().fetch_add(1, std::memory_order_relaxed);
+            return new char[size];
+    }
+}
+
+inline
+void FunctionAllocator::deallocate(void* p, size_t size)
+{
+    switch (sizeClass(size)) {
+        case 0: pool<256>().deallocate(static_cast<Block<256>*>(p)); break;
+        case 1: pool<512>().deallocate(static_cast<Block<512>*>(p)); break;
+        case 2: pool<1024>().deallocate(static_cast<Block<1024>*>(p)); break;
+        case 3: pool<2048>().deallocate(static_cast<Block<2048>*>(p)); break;
+        case 4: pool<4096>().deallocate(static_cast<Block<4096>*>(p)); break;
+        default:
+            delete[] static_cast<char*>(p);
+            numHeapAllocated().fetch_sub(1, std::memory_order_relaxed);
+            break;
+    }
+}
+
+inline
+std::map<std::string, AllocatorStatistics> FunctionAllocator::stats()
+{
+    std::map<std::string, AllocatorStatistics> stats;
+    if (isUsed(0)) stats["function256"] = pool<256>().stats();
+    if (isUsed(1)) stats["function512"] = pool<512>().stats();
+    if (isUsed(2)) stats["function1024"] = pool<1024>().stats();
+    if (isUsed(3)) stats["function2048"] = pool<2048>().stats();
+    if (isUsed(4)) stats["function4096"] = pool<4096>().stats();
+    AllocatorStatistics& heap = stats["functionHeap"];
+    heap._allocatedCount = heap._heapAllocatedCount = numHeapAllocated().load(std::memory_order_relaxed);
+    heap._heapFallbackCount = numHeapFallbacks().load(std::memory_order_relaxed);
+    return stats;
+}
+
+template <size_t SIZE>
+FunctionAllocator::Pool<SIZE>& FunctionAllocator::pool()
+{
+    static Pool<SIZE>& pool = []() -> Pool<SIZE>& {
+        Pool<SIZE>& instance = Allocator<Pool<SIZE>>::instance(AllocatorTraits::functionPoolAllocSize());
+        isUsed(sizeClass(SIZE)) = true;
+        return instance;
+    }();
+    return pool;
+}
+
+inline
+size_t FunctionAllocator::sizeClass(size_t size)
+{
+    size_t sizeClass = 0;
+    for (size_t classSize = MinPooledSize; classSize < size; classSize <<= 1) {
+        if (++sizeClass == NumSizeClasses) {
+            break;
+        }
+    }
+    return sizeClass;
+}
+
+inline
+std::atomic_bool& FunctionAllocator::isUsed(size_t sizeClass)
+{
+    static std::atomic_bool used[NumSizeClasses] = {};
+    return used[sizeClass];
+}
+
+inline
+std::atomic<size_t>& FunctionAllocator::numHeapAllocated()
+{
+    static std::atomic<size_t> count{0};
+    return count;
+}
+
+inline
+std::atomic<size_t>& FunctionAllocator::numHeapFallbacks()
+{
+    static std::atomic<size_t> count{0};
+    return count;
+}
+
 //==============================================================================================
 //                                   class Function
 //==============================================================================================
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::Function(RET(*ptr)(ARGS...)) :
-    _callable(reinterpret_cast<void*>(ptr)),
-    _deleter(dummyDeleter)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::Function(RET(*ptr)(ARGS...)) :
+    _callable(reinterpret_cast<void*>(ptr))
 {
     _callback = [](void* ptr, ARGS...args)->RET {
         return (*reinterpret_cast<Func>(ptr))(std::forward<ARGS>(args)...);
     };
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::Function(const Function<RET(ARGS...)>& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::Function(const Function& other)
 {
     *this = other;
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::Function(Function<RET(ARGS...)>&& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::Function(Function&& other)
 {
     *this = std::move(other);
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>&
-Function<RET(ARGS...)>::operator=(const Function<RET(ARGS...)>& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>&
+Function<RET(ARGS...), SIZE>::operator=(const Function& other)
 {
     if (this != &other) {
-        _callback = other._callback;
-        _deleter = other._deleter;
-        if (other._callable == other._storage.data()) {
-            _storage = other._storage;
-            _callable = _storage.data();
+        reset();
+        if (other._manager) {
+            //deep copy the owned functor
+            _callable = other._manager(Op::Copy, other._callable, other.isInline() ? storage() : nullptr);
         }
         else {
             _callable = other._callable;
         }
+        _callback = other._callback;
+        _manager = other._manager;
     }
     return *this;
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>&
-Function<RET(ARGS...)>::operator=(Function<RET(ARGS...)>&& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>&
+Function<RET(ARGS...), SIZE>::operator=(Function&& other)
 {
-    *this = other;
     if (this != &other) {
+        reset();
+        if (other._manager && other.isInline()) {
+            _callable = other._manager(Op::Move, other._callable, storage());
+        }
+        else {
+            _callable = other._callable; //steal the heap block or the unowned callable
+        }
+        _callback = other._callback;
+        _manager = other._manager;
         other._callable = nullptr; //disable
+        other._manager = nullptr;
     }
     return *this;
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::~Function()
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::~Function()
 {
-    _deleter(_callable);
+    reset();
 }
 
-template <typename RET, typename ... ARGS>
-template <typename FUNCTOR>
-Function<RET(ARGS...)>::Function(FUNCTOR&& functor)
+template <typename RET, typename ... ARGS, size_t SIZE>
+template <typename FUNCTOR, typename>
+Function<RET(ARGS...), SIZE>::Function(FUNCTOR&& functor)
 {
     initFunctor(std::forward<FUNCTOR>(functor), std::is_lvalue_reference<FUNCTOR>());
 }
 
-template <typename RET, typename ... ARGS>
-RET Function<RET(ARGS...)>::operator()(ARGS...args) {
+template <typename RET, typename ... ARGS, size_t SIZE>
+RET Function<RET(ARGS...), SIZE>::operator()(ARGS...args) {
     return _callback(_callable, std::forward<ARGS>(args)...);
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::operator bool() const {
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::operator bool() const {
     return !!_callable;
 }
 
-template <typename RET, typename ... ARGS>
+template <typename RET, typename ... ARGS, size_t SIZE>
+void Function<RET(ARGS...), SIZE>::reset()
+{
+    if (_manager && _callable) {
+        _manager(Op::Destroy, _callable, storage());
+    }
+    _callable = nullptr;
+    _manager = nullptr;
+}
+
+template <typename RET, typename ... ARGS, size_t SIZE>
+template <typename FUNCTOR>
+constexpr bool Function<RET(ARGS...), SIZE>::fitsInline()
+{
+    //moving an inline functor must not throw since it happens inside move constructors
+    return (sizeof(FUNCTOR) <= SIZE) &&
+           (alignof(FUNCTOR) <= alignof(std::max_align_t)) &&
+           std::is_nothrow_move_constructible<FUNCTOR>::value;
+}
+
+template <typename RET, typename ... ARGS, size_t SIZE>
 template <typename FUNCTOR>
-void Function<RET(ARGS...)>::initFunctor(FUNCTOR&& functor, std::true_type)
+void* Function<RET(ARGS...), SIZE>::manage(Op op, void* src, void* storage)
+{
+    FUNCTOR* functor = static_cast<FUNCTOR*>(src);
+    switch (op) {
+        case Op::Move:
+            return new (storage) FUNCTOR(std::move(*functor));
+        case Op::Copy:
+            return copy<FUNCTOR>(src, storage, std::is_copy_constructible<FUNCTOR>());
+        case Op::Destroy:
+            functor->~FUNCTOR();
+            if (src != storage) {
+                FunctionAllocator::deallocate(src, sizeof(FUNCTOR));
+            }
+            return nullptr;
+    }
+    return nullptr;
+}
+
+template <typename RET, typename ... ARGS, size_t SIZE>
+template <typename FUNCTOR>
+void* Function<RET(ARGS...), SIZE>::copy(void* src, void* storage, std::true_type)
+{
+    if (!storage) {
+        storage = FunctionAllocator::allocate(sizeof(FUNCTOR));
+    }
+    return new (storage) FUNCTOR(*static_cast<const FUNCTOR*>(src));
+}
+
+template <typename RET, typename ... ARGS, size_t SIZE>
+template <typename FUNCTOR>
+void* Function<RET(ARGS...), SIZE>::copy(void*, void*, std::false_type)
+{
+    throw std::runtime_error("Function holds a non-copyable functor");
+}
+
+template <typename RET, typename ... ARGS, size_t SIZE>
+template <typename FUNCTOR>
+void Function<RET(ARGS...), SIZE>::initFunctor(FUNCTOR&& functor, std::true_type)
 {
     _callable = std::addressof(functor);
-    _deleter = dummyDeleter;
     _callback = [](void* ptr, ARGS...args)->RET {
         return (*reinterpret_cast<std::remove_reference_t<FUNCTOR>*>(ptr))(std::forward<ARGS>(args)...);
     };
 }
 
-template <typename RET, typename ... ARGS>
+template <typename RET, typename ... ARGS, size_t SIZE>
 template <typename FUNCTOR>
-void Function<RET(ARGS...)>::initFunctor(FUNCTOR&& functor, std::false_type)
+void Function<RET(ARGS...), SIZE>::initFunctor(FUNCTOR&& functor, std::false_type)
 {
-    if (sizeof(FUNCTOR) <= size) {
-        new (_storage.data()) FUNCTOR(std::forward<FUNCTOR>(functor));
-        _callable = _storage.data();
-        _deleter = dummyDeleter;
+    using Functor = std::decay_t<FUNCTOR>;
+    if (fitsInline<Functor>()) {
+        _callable = new (storage()) Functor(std::forward<FUNCTOR>(functor));
     }
     else {
-        _callable = new char[sizeof(FUNCTOR)];
-        new (_callable) FUNCTOR(std::forward<FUNCTOR>(functor));
-        _deleter = deleter;
+        void* block = FunctionAllocator::allocate(sizeof(Functor));
+        try {
+            _callable = new (block) Functor(std::forward<FUNCTOR>(functor));
+        }
+        catch (...) {
+            FunctionAllocator::deallocate(block, sizeof(Functor));
+            throw;
+        }
     }
+    _manager = manage<Functor>;
     _callback = [](void* ptr, ARGS...args)->RET {
-        return (*reinterpret_cast<std::remove_reference_t<FUNCTOR>*>(ptr))(std::forward<ARGS>(args)...);
+        return (*reinterpret_cast<Functor*>(ptr))(std::forward<ARGS>(args)...);
     };
 }
 
@@ -0,0 +1,354 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+
+namespace Bloomberg {
+namespace quantum {
+
+template <class T>
+Channel<T>::Channel(size_t capacity) :
+    _ring(capacity ? new MpmcRing<T>(capacity) : nullptr),
+    _queueSize(0),
+    _isClosed(false),
+    _numSelectors(0)
+{}
+
+template <class T>
+template <class V>
+bool Channel<T>::send(V&& value)
+{
+    T item(std::forward<V>(value));
+    while (!_isClosed.load(std::memory_order_acquire))
+    {
+        if (push(item))
+        {
+            onValueSent();
+            return true;
+        }
+        _senders.wait([this]()->bool
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); //pairs with onValueReceived()
+            return isFull() && !_isClosed;
+        });
+    }
+    return false;
+}
+
+template <class T>
+template <class V>
+bool Channel<T>::send(ICoroSync::Ptr sync, V&& value)
+{
+    T item(std::forward<V>(value));
+    while (!_isClosed.load(std::memory_order_acquire))
+    {
+        if (push(item))
+        {
+            onValueSent();
+            return true;
+        }
+        _senders.wait(sync, [this]()->bool
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); //pairs with onValueReceived()
+            return isFull() && !_isClosed;
+        });
+    }
+    return false;
+}
+
+template <class T>
+bool Channel<T>::trySend(T& value)
+{
+    if (_isClosed.load(std::memory_order_acquire) || !push(value))
+    {
+        return false;
+    }
+    onValueSent();
+    return true;
+}
+
+template <class T>
+bool Channel<T>::recv(T& value)
+{
+    while (true)
+    {
+        if (tryRecv(value))
+        {
+            return true;
+        }
+        if (_isClosed)
+        {
+            return tryRecv(value); //drain values sent before closing
+        }
+        _receivers.wait([this]()->bool
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); //pairs with onValueSent()
+            return empty() && !_isClosed;
+        });
+    }
+}
+
+template <class T>
+bool Channel<T>::recv(ICoroSync::Ptr sync, T& value)
+{
+    while (true)
+    {
+        if (tryRecv(value))
+        {
+            return true;
+        }
+        if (_isClosed)
+        {
+            return tryRecv(value); //drain values sent before closing
+        }
+        _receivers.wait(sync, [this]()->bool
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); //pairs with onValueSent()
+            return empty() && !_isClosed;
+        });
+    }
+}
+
+template <class T>
+bool Channel<T>::tryRecv(T& value)
+{
+    if (!pop(value))
+    {
+        return false;
+    }
+    onValueReceived();
+    return true;
+}
+
+template <class T>
+int Channel<T>::select(const std::vector<Ptr>& channels, T& value)
+{
+    Selector selector;
+    return selectImpl(channels, value, selector, [&selector]()
+    {
+        selector._waiters.wait([&selector]()->bool
+        {
+            return !selector._isSignalled;
+        });
+    });
+}
+
+template <class T>
+int Channel<T>::select(ICoroSync::Ptr sync, const std::vector<Ptr>& channels, T& value)
+{
+    Selector selector;
+    return selectImpl(channels, value, selector, [&selector, &sync]()
+    {
+        selector._waiters.wait(sync, [&selector]()->bool
+        {
+            return !selector._isSignalled;
+        });
+    });
+}
+
+template <class T>
+void Channel<T>::close()
+{
+    _isClosed.store(true, std::memory_order_seq_cst);
+    _senders.notifyAll();
+    _receivers.notifyAll();
+    if (_numSelectors.load(std::memory_order_seq_cst))
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard guard(_selectorLock);
+        for (Selector* selector : _selectors)
+        {
+            selector->signal();
+        }
+    }
+}
+
+template <class T>
+bool Channel<T>::isClosed() const
+{
+    return _isClosed;
+}
+
+template <class T>
+size_t Channel<T>::size() const
+{
+    return _ring ? _ring->size() : _queueSize.load();
+}
+
+template <class T>
+bool Channel<T>::empty() const
+{
+    return size() == 0;
+}
+
+template <class T>
+size_t Channel<T>::capacity() const
+{
+    return _ring ? _ring->capacity() : 0;
+}
+
+template <class T>
+void Channel<T>::Selector::signal()
+{
+    _isSignalled.store(true, std::memory_order_seq_cst);
+    if (_waiters.hasWaiters())
+    {
+        _waiters.notifyAll();
+    }
+}
+
+template <class T>
+bool Channel<T>::push(T& value)
+{
+    if (_ring)
+    {
+        return _ring->tryPush(value);
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_spinlock);
+    _queue.emplace_back(std::move(value));
+    _queueSize.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <class T>
+bool Channel<T>::pop(T& value)
+{
+    if (_ring)
+    {
+        return _ring->tryPop(value);
+    }
+    if (_queueSize.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_spinlock);
+    if (_queue.empty())
+    {
+        return false;
+    }
+    value = std::move(_queue.front());
+    _queue.pop_front();
+    _queueSize.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <class T>
+bool Channel<T>::isFull() const
+{
+    return _ring && (_ring->size() >= _ring->capacity());
+}
+
+template <class T>
+void Channel<T>::onValueSent()
+{
+    //Pairs with the waiter registration in WaitQueue so that either the receiver sees the value
+    //or this thread sees the receiver.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_receivers.hasWaiters())
+    {
+        _receivers.notify();
+    }
+    if (_numSelectors.load(std::memory_order_seq_cst))
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard guard(_selectorLock);
+        for (Selector* selector : _selectors)
+        {
+            selector->signal();
+        }
+    }
+}
+
+template <class T>
+void Channel<T>::onValueReceived()
+{
+    if (!_ring)
+    {
+        return; //senders never wait on unbounded channels
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_senders.hasWaiters())
+    {
+        _senders.notify();
+    }
+}
+
+template <class T>
+void Channel<T>::addSelector(Selector& selector)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_selectorLock);
+    _selectors.push_back(&selector);
+    _numSelectors.fetch_add(1, std::memory_order_seq_cst);
+}
+
+template <class T>
+void Channel<T>::removeSelector(Selector& selector)
+{
+    //Once removed, no sender can signal the selector anymore
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_selectorLock);
+    auto it = std::find(_selectors.begin(), _selectors.end(), &selector);
+    if (it != _selectors.end())
+    {
+        _selectors.erase(it);
+        _numSelectors.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+template <class T>
+template <class WAIT>
+int Channel<T>::selectImpl(const std::vector<Ptr>& channels, T& value, Selector& selector, WAIT&& wait)
+{
+    for (const Ptr& channel : channels)
+    {
+        channel->addSelector(selector);
+    }
+    int index = -1;
+    while (true)
+    {
+        selector._isSignalled.store(false, std::memory_order_seq_cst);
+        bool isClosed = true;
+        for (size_t i = 0; (i < channels.size()) && (index == -1); ++i)
+        {
+            //Check the closed flag first so that values sent before closing are not missed
+            bool isChannelClosed = channels[i]->isClosed();
+            if (channels[i]->tryRecv(value))
+            {
+                index = static_cast<int>(i);
+            }
+            isClosed = isClosed && isChannelClosed;
+        }
+        if ((index != -1) || isClosed)
+        {
+            break;
+        }
+        wait();
+    }
+    for (const Ptr& channel : channels)
+    {
+        channel->removeSelector(selector);
+    }
+    return index;
+}
+
+}}
@@ -26,13 +26,18 @@ thread_local static std::atomic_int s_threadSignal{-1}; //thread specific (non-c
 
 inline
 ConditionVariable::ConditionVariable() :
+    _thisLock(LockProfiler::site<ConditionVariable>("ConditionVariable")),
+    _head(nullptr),
+    _tail(nullptr),
     _destroyed(false)
 {}
 
 inline
 ConditionVariable::~ConditionVariable()
 {
-    Mutex::Guard lock(_thisLock);
+    SpinLock::Guard lock(_thisLock);
+    //release anyone still waiting
+    notifyAllImpl();
     _destroyed = true;
 }
 
@@ -40,44 +45,110 @@ inline
 void ConditionVariable::notifyOne()
 {
     //LOCKED OR UNLOCKED SCOPE
-    Mutex::Guard lock(_thisLock);
-    if (_waiters.empty())
+    SpinLock::Guard lock(_thisLock);
+    if (!_head)
     {
         return;
     }
-    (*_waiters.front()) = 1;
-    _waiters.pop_front();
+    Waiter& waiter = *_head;
+    remove(waiter);
+    notify(waiter);
 }
 
 inline
 void ConditionVariable::notifyAll()
 {
     //LOCKED OR UNLOCKED SCOPE
-    Mutex::Guard lock(_thisLock);
-    for (auto&& waiter : _waiters)
+    SpinLock::Guard lock(_thisLock);
+    notifyAllImpl();
+}
+
+inline
+void ConditionVariable::notifyAllImpl()
+{
+    while (_head)
+    {
+        Waiter& waiter = *_head;
+        remove(waiter);
+        notify(waiter);
+    }
+}
+
+inline
+void ConditionVariable::pushBack(Waiter& waiter)
+{
+    waiter._prev = _tail;
+    waiter._next = nullptr;
+    waiter._isQueued = true;
+    if (_tail)
+    {
+        _tail->_next = &waiter;
+    }
+    else
+    {
+        _head = &waiter;
+    }
+    _tail = &waiter;
+}
+
+inline
+void ConditionVariable::remove(Waiter& waiter)
+{
+    if (waiter._prev)
+    {
+        waiter._prev->_next = waiter._next;
+    }
+    else
+    {
+        _head = waiter._next;
+    }
+    if (waiter._next)
+    {
+        waiter._next->_prev = waiter._prev;
+    }
+    else
+    {
+        _tail = waiter._prev;
+    }
+    waiter._isQueued = false;
+}
+
+inline
+void ConditionVariable::notify(Waiter& waiter)
+{
+    //Called under lock so that a timed-out waiter never leaves with a pending notification.
+    //The waiter node is no longer accessed once the signal is set.
+    if (waiter._sync)
+    {
+        //Signal the coroutine and reschedule it on its queue right away
+        ICoroSync::Ptr sync = waiter._sync;
+        sync->notify();
+    }
+    else
     {
-        (*waiter) = 1;
+        std::atomic_int& signal = *waiter._signal; //thread-local so it outlives the waiter node
+        signal = 1;
+        Futex::wake(signal);
     }
-    _waiters.clear();
 }
 
 inline
 void ConditionVariable::wait(Mutex& mutex)
 {
-    waitImpl(YieldingThread(), mutex, s_threadSignal);
+    waitImpl(YieldingThread(), mutex, s_threadSignal, ICoroSync::Ptr());
 }
 
 inline
 void ConditionVariable::wait(ICoroSync::Ptr sync, Mutex& mutex)
 {
-    waitImpl(sync->getYieldHandle(), mutex, sync->signal());
+    waitImpl(sync->getYieldHandle(), mutex, sync->signal(), sync);
 }
 
 template <class PREDICATE>
 void ConditionVariable::wait(Mutex& mutex,
                              PREDICATE predicate)
 {
-    waitImpl(YieldingThread(), mutex, predicate, s_threadSignal);
+    waitImpl(YieldingThread(), mutex, predicate, s_threadSignal, ICoroSync::Ptr());
 }
 
 template <class PREDICATE>
@@ -85,14 +156,15 @@ void ConditionVariable::wait(ICoroSync::Ptr sync,
                              Mutex& mutex,
                              PREDICATE predicate)
 {
-    waitImpl(sync->getYieldHandle(), mutex, predicate, sync->signal());
+    waitImpl(sync->getYieldHandle(), mutex, predicate, sync->signal(), sync);
 }
 
 template <class REP, class PERIOD>
 bool ConditionVariable::waitFor(Mutex& mutex,
                                 const std::chrono::duration<REP, PERIOD>& time)
 {
-    return waitForImpl(YieldingThread(), mutex, time, s_threadSignal);
+    auto duration = time;
+    return waitForImpl(YieldingThread(), mutex, duration, s_threadSignal, ICoroSync::Ptr());
 }
 
 template <class REP, class PERIOD>
@@ -100,7 +172,8 @@ bool ConditionVariable::waitFor(ICoroSync::Ptr sync,
                                 Mutex& mutex,
                                 const std::chrono::duration<REP, PERIOD>& time)
 {
-    return waitForImpl(sync->getYieldHandle(), mutex, time, sync->signal());
+    auto duration = time;
+    return waitForImpl(sync->getYieldHandle(), mutex, duration, sync->signal(), sync);
 }
 
 template <class REP, class PERIOD, class PREDICATE>
@@ -108,7 +181,7 @@ bool ConditionVariable::waitFor(Mutex& mutex,
                                 const std::chrono::duration<REP, PERIOD>& time,
                                 PREDICATE predicate)
 {
-    return waitForImpl(YieldingThread(), mutex, time, predicate, s_threadSignal);
+    return waitForImpl(YieldingThread(), mutex, time, predicate, s_threadSignal, ICoroSync::Ptr());
 }
 
 template <class REP, class PERIOD, class PREDICATE>
@@ -117,28 +190,37 @@ bool ConditionVariable::waitFor(ICoroSync::Ptr sync,
                                 const std::chrono::duration<REP, PERIOD>& time,
                                 PREDICATE predicate)
 {
-    return waitForImpl(sync->getYieldHandle(), mutex, time, predicate, sync->signal());
+    return waitForImpl(sync->getYieldHandle(), mutex, time, predicate, sync->signal(), sync);
 }
 
 template <class YIELDING>
 void ConditionVariable::waitImpl(YIELDING&& yield,
                                  Mutex& mutex,
-                                 std::atomic_int& signal)
+                                 std::atomic_int& signal,
+                                 const ICoroSync::Ptr& sync)
 {
+    Waiter waiter{&signal, sync};
     {//========= LOCKED SCOPE =========
-        Mutex::Guard lock(_thisLock);
+        SpinLock::Guard lock(_thisLock);
         if (_destroyed)
         {
             return; //don't release the mutex
         }
         signal = 0; //clear signal flag
-        _waiters.push_back(&signal);
+        pushBack(waiter);
     }
     //========= UNLOCKED SCOPE =========
-    Mutex::ReverseGuard unlock(mutex);
+    Mutex::ReverseGuard unlock(sync, mutex); //coroutines relock without blocking their thread
     while ((signal == 0) && !_destroyed)
     {
-        yield();
+        if (sync)
+        {
+            yield();
+        }
+        else
+        {
+            Futex::wait(signal, 0); //returns when notified or spuriously
+        }
     }
     signal = -1; //reset
 }
@@ -147,11 +229,12 @@ template <class YIELDING, class PREDICATE>
 void ConditionVariable::waitImpl(YIELDING&& yield,
                                  Mutex& mutex,
                                  PREDICATE predicate,
-                                 std::atomic_int& signal)
+                                 std::atomic_int& signal,
+                                 const ICoroSync::Ptr& sync)
 {
     while (!predicate() && !_destroyed)
     {
-        waitImpl(std::forward<YIELDING>(yield), mutex, signal);
+        waitImpl(std::forward<YIELDING>(yield), mutex, signal, sync);
     }
 }
 
@@ -159,10 +242,13 @@ template <class YIELDING, class REP, class PERIOD>
 bool ConditionVariable::waitForImpl(YIELDING&& yield,
                                     Mutex& mutex,
                                     std::chrono::duration<REP, PERIOD>& time,
-                                    std::atomic_int& signal)
+                                    std::atomic_int& signal,
+                                    const ICoroSync::Ptr& sync)
 {
+    UNUSED(yield); //timed waits sleep on the sync object or block on the signal instead
+    Waiter waiter{&signal, sync};
     {//========= LOCKED SCOPE =========
-        Mutex::Guard lock(_thisLock);
+        SpinLock::Guard lock(_thisLock);
         if (_destroyed)
         {
             return true; //don't release the mutex
@@ -172,10 +258,10 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
             return false; //timeout
         }
         signal = 0; //clear signal flag
-        _waiters.push_back(&signal);
+        pushBack(waiter);
     }
     //========= UNLOCKED SCOPE =========
-    Mutex::ReverseGuard unlock(mutex);
+    Mutex::ReverseGuard unlock(sync, mutex); //coroutines relock without blocking their thread
     auto start = std::chrono::high_resolution_clock::now();
     auto elapsed = std::chrono::duration<REP, PERIOD>::zero();
     bool timeout = false;
@@ -183,7 +269,16 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
     //wait until signalled or times out
     while ((signal == 0) && !_destroyed)
     {
-        yield();
+        if (sync)
+        {
+            //Sleep for the remaining time. The coroutine resumes as soon as it gets
+            //signalled or when the timer expires, whichever comes first.
+            sync->sleep(std::chrono::duration_cast<std::chrono::microseconds>(time - elapsed));
+        }
+        else
+        {
+            Futex::waitFor(signal, 0, std::chrono::duration_cast<std::chrono::microseconds>(time - elapsed));
+        }
         elapsed = std::chrono::duration_cast<std::chrono::duration<REP, PERIOD>>(std::chrono::high_resolution_clock::now() - start);
         if (elapsed >= time)
         {
@@ -192,6 +287,25 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
         }
     }
     
+    if (sync)
+    {
+        sync->sleep(std::chrono::microseconds(0)); //cancel any remaining sleep time
+    }
+    
+    if (timeout && !_destroyed)
+    {//========= LOCKED SCOPE =========
+        //Stop waiting so that we don't consume a notification destined to someone else
+        SpinLock::Guard lock(_thisLock);
+        if (waiter._isQueued)
+        {
+            remove(waiter);
+        }
+        else if (signal == 1)
+        {
+            timeout = false; //notified just as the time expired
+        }
+    }
+    
     signal = -1; //reset signal flag
     
     //adjust duration or set to zero if nothing remains
@@ -204,13 +318,14 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
                                     Mutex& mutex,
                                     const std::chrono::duration<REP, PERIOD>& time,
                                     PREDICATE predicate,
-                                    std::atomic_int& signal)
+                                    std::atomic_int& signal,
+                                    const ICoroSync::Ptr& sync)
 {
     if (time > std::chrono::duration<REP, PERIOD>(0)) {
         auto duration = time;
         while (!predicate() && !_destroyed)
         {
-            if (!waitForImpl(std::forward<YIELDING>(yield), mutex, duration, signal))
+            if (!waitForImpl(std::forward<YIELDING>(yield), mutex, duration, signal, sync))
             {
                 //timeout
                 return predicate();
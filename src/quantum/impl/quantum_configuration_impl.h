@@ -18,6 +18,9 @@
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 namespace Bloomberg {
 namespace quantum {
@@ -64,6 +67,161 @@ const std::string& Configuration::getJsonSchema()
             "loadBalancePollIntervalNumBackoffs": {
                 "type": "number",
                 "default": 0
+            },
+            "coroutineWorkStealing": {
+                "type": "boolean",
+                "default": false
+            },
+            "coroutineWorkStealingPollIntervalUs": {
+                "type": "number",
+                "default": 1000
+            },
+            "parkBlockedCoroutines": {
+                "type": "boolean",
+                "default": true
+            },
+            "coroutineMigrationThreshold": {
+                "type": "number",
+                "default": 0
+            },
+            "idleSpinCount": {
+                "type": "number",
+                "default": 0
+            },
+            "idleYieldCount": {
+                "type": "number",
+                "default": -1
+            },
+            "collectLatencyHistograms": {
+                "type": "boolean",
+                "default": false
+            },
+            "trackTasks": {
+                "type": "boolean",
+                "default": false
+            },
+            "numPriorityLevels": {
+                "type": "number",
+                "default": 2
+            },
+            "priorityLevelWeight": {
+                "type": "number",
+                "default": 4
+            },
+            "coroutineSchedulingPolicy": {
+                "type": "string",
+                "enum": [
+                    "earliestDeadlineFirst",
+                    "roundRobin"
+                ],
+                "default": "roundRobin"
+            },
+            "dropExpiredCoroutines": {
+                "type": "boolean",
+                "default": false
+            },
+            "inlineContinuations": {
+                "type": "boolean",
+                "default": false
+            },
+            "longSliceThresholdUs": {
+                "type": "number",
+                "default": 0
+            },
+            "maxPendingCoroTasks": {
+                "type": "number",
+                "default": 0
+            },
+            "maxPendingIoTasks": {
+                "type": "number",
+                "default": 0
+            },
+            "threadPlacement": {
+                "type": "string",
+                "enum": [
+                    "default",
+                    "packThreadsOnNodes",
+                    "spreadThreadsAcrossNodes"
+                ],
+                "default": "default"
+            },
+            "maxNumCoroutineThreads": {
+                "type": "number",
+                "default": -1
+            },
+            "coroutinePlacementPolicy": {
+                "type": "string",
+                "enum": [
+                    "currentQueue",
+                    "leastLoaded",
+                    "powerOfTwoChoices",
+                    "roundRobin"
+                ],
+                "default": "leastLoaded"
+            },
+            "affinityVirtualNodes": {
+                "type": "number",
+                "default": 0
+            },
+            "sharedIoRingCapacity": {
+                "type": "number",
+                "default": 0
+            },
+            "sharedIoRingFullPolicy": {
+                "type": "string",
+                "enum": [
+                    "block",
+                    "fail",
+                    "spill"
+                ],
+                "default": "spill"
+            },
+            "loadBalanceNumPollsBeforeParking": {
+                "type": "number",
+                "default": 0
+            },
+            "maxNumElasticIoThreads": {
+                "type": "number",
+                "default": 0
+            },
+            "elasticIoSpawnThresholdMs": {
+                "type": "number",
+                "default": 10
+            },
+            "elasticIoIdleTimeoutMs": {
+                "type": "number",
+                "default": 1000
+            },
+            "ioThreadCpus": {
+                "type": "string",
+                "default": ""
+            },
+            "pinIoThreadsToCores": {
+                "type": "boolean",
+                "default": false
+            },
+            "ioThreadSchedPolicy": {
+                "type": "string",
+                "enum": [
+                    "batch",
+                    "default",
+                    "fifo",
+                    "idle",
+                    "roundRobin"
+                ],
+                "default": "default"
+            },
+            "ioThreadSchedPriority": {
+                "type": "number",
+                "default": 0
+            },
+            "metricsExportPeriodMs": {
+                "type": "number",
+                "default": 1000
+            },
+            "sharedMemoryQueuePollIntervalMs": {
+                "type": "number",
+                "default": 10
             }
         },
         "additionalProperties": false,
@@ -122,6 +280,222 @@ void Configuration::setLoadBalancePollIntervalNumBackoffs(size_t numBackoffs)
     _loadBalancePollIntervalNumBackoffs = numBackoffs;
 }
 
+inline
+void Configuration::setCoroutineWorkStealing(bool value)
+{
+    _coroutineWorkStealing = value;
+}
+
+inline
+void Configuration::setCoroutineWorkStealingPollIntervalUs(std::chrono::microseconds interval)
+{
+    _coroutineWorkStealingPollIntervalUs = interval;
+}
+
+inline
+void Configuration::setParkBlockedCoroutines(bool value)
+{
+    _parkBlockedCoroutines = value;
+}
+
+inline
+void Configuration::setCoroutineMigrationThreshold(size_t threshold)
+{
+    _coroutineMigrationThreshold = threshold;
+}
+
+inline
+void Configuration::setIdleSpinCount(int count)
+{
+    _idleSpinCount = count;
+}
+
+inline
+void Configuration::setIdleYieldCount(int count)
+{
+    _idleYieldCount = count;
+}
+
+inline
+void Configuration::setCollectLatencyHistograms(bool value)
+{
+    _collectLatencyHistograms = value;
+}
+
+inline
+void Configuration::setTrackTasks(bool value)
+{
+    _trackTasks = value;
+}
+
+inline
+void Configuration::setNumPriorityLevels(int num)
+{
+    _numPriorityLevels = num;
+}
+
+inline
+void Configuration::setPriorityLevelWeight(int weight)
+{
+    _priorityLevelWeight = weight;
+}
+
+inline
+void Configuration::setCoroutineSchedulingPolicy(SchedulingPolicy policy)
+{
+    _coroutineSchedulingPolicy = policy;
+}
+
+inline
+void Configuration::setDropExpiredCoroutines(bool value)
+{
+    _dropExpiredCoroutines = value;
+}
+
+inline
+void Configuration::setInlineContinuations(bool value)
+{
+    _inlineContinuations = value;
+}
+
+inline
+void Configuration::setLongSliceThresholdUs(std::chrono::microseconds threshold)
+{
+    _longSliceThresholdUs = threshold;
+}
+
+inline
+void Configuration::setLongSliceCallback(LongSliceCallback callback)
+{
+    _longSliceCallback = std::move(callback);
+}
+
+inline
+void Configuration::setMaxPendingCoroTasks(size_t num)
+{
+    _maxPendingCoroTasks = num;
+}
+
+inline
+void Configuration::setMaxPendingIoTasks(size_t num)
+{
+    _maxPendingIoTasks = num;
+}
+
+inline
+void Configuration::setOverloadCallback(OverloadCallback callback)
+{
+    _overloadCallback = std::move(callback);
+}
+
+inline
+void Configuration::setThreadPlacement(ThreadPlacement placement)
+{
+    _threadPlacement = placement;
+}
+
+inline
+void Configuration::setMaxNumCoroutineThreads(int num)
+{
+    _maxNumCoroutineThreads = num;
+}
+
+inline
+void Configuration::setCoroutinePlacementPolicy(PlacementPolicy policy)
+{
+    _coroutinePlacementPolicy = policy;
+}
+
+inline
+void Configuration::setAffinityVirtualNodes(int num)
+{
+    _affinityVirtualNodes = num;
+}
+
+inline
+void Configuration::setSharedIoRingCapacity(size_t capacity)
+{
+    _sharedIoRingCapacity = capacity;
+}
+
+inline
+void Configuration::setSharedIoRingFullPolicy(RingFullPolicy policy)
+{
+    _sharedIoRingFullPolicy = policy;
+}
+
+inline
+void Configuration::setLoadBalanceNumPollsBeforeParking(size_t numPolls)
+{
+    _loadBalanceNumPollsBeforeParking = numPolls;
+}
+
+inline
+void Configuration::setMaxNumElasticIoThreads(int num)
+{
+    _maxNumElasticIoThreads = num;
+}
+
+inline
+void Configuration::setElasticIoSpawnThresholdMs(std::chrono::milliseconds threshold)
+{
+    _elasticIoSpawnThresholdMs = threshold;
+}
+
+inline
+void Configuration::setElasticIoIdleTimeoutMs(std::chrono::milliseconds timeout)
+{
+    _elasticIoIdleTimeoutMs = timeout;
+}
+
+inline
+void Configuration::setIoThreadCpus(const std::string& cpuList)
+{
+    _ioThreadCpus = cpuList;
+}
+
+inline
+void Configuration::setPinIoThreadsToCores(bool value)
+{
+    _pinIoThreadsToCores = value;
+}
+
+inline
+void Configuration::setIoThreadSchedPolicy(SchedPolicy policy)
+{
+    _ioThreadSchedPolicy = policy;
+}
+
+inline
+void Configuration::setIoThreadSchedPriority(int priority)
+{
+    _ioThreadSchedPriority = priority;
+}
+
+inline
+void Configuration::setMetricsSink(IMetricsSink::Ptr sink)
+{
+    _metricsSink = std::move(sink);
+}
+
+inline
+void Configuration::setMetricsExportPeriodMs(std::chrono::milliseconds period)
+{
+    _metricsExportPeriodMs = period;
+}
+
+inline
+void Configuration::setSharedMemoryQueue(SharedMemoryQueue::Ptr queue)
+{
+    _sharedMemoryQueue = std::move(queue);
+}
+
+inline
+void Configuration::setSharedMemoryQueuePollIntervalMs(std::chrono::milliseconds interval)
+{
+    _sharedMemoryQueuePollIntervalMs = interval;
+}
+
 inline
 int Configuration::getNumCoroutineThreads() const
 {
@@ -164,5 +538,241 @@ size_t Configuration::getLoadBalancePollIntervalNumBackoffs() const
     return _loadBalancePollIntervalNumBackoffs;
 }
 
+inline
+bool Configuration::getCoroutineWorkStealing() const
+{
+    return _coroutineWorkStealing;
+}
+
+inline
+std::chrono::microseconds Configuration::getCoroutineWorkStealingPollIntervalUs() const
+{
+    return _coroutineWorkStealingPollIntervalUs;
+}
+
+inline
+bool Configuration::getParkBlockedCoroutines() const
+{
+    return _parkBlockedCoroutines;
+}
+
+inline
+size_t Configuration::getCoroutineMigrationThreshold() const
+{
+    return _coroutineMigrationThreshold;
+}
+
+inline
+int Configuration::getIdleSpinCount() const
+{
+    return _idleSpinCount;
+}
+
+inline
+int Configuration::getIdleYieldCount() const
+{
+    return _idleYieldCount;
+}
+
+inline
+bool Configuration::getCollectLatencyHistograms() const
+{
+    return _collectLatencyHistograms;
+}
+
+inline
+bool Configuration::getTrackTasks() const
+{
+    return _trackTasks;
+}
+
+inline
+int Configuration::getNumPriorityLevels() const
+{
+    return _numPriorityLevels;
+}
+
+inline
+int Configuration::getPriorityLevelWeight() const
+{
+    return _priorityLevelWeight;
+}
+
+inline
+std::vector<size_t> Configuration::getPriorityLevelWeights() const
+{
+    if ((_numPriorityLevels < 1) || (_priorityLevelWeight < 1))
+    {
+        throw std::runtime_error("Invalid priority level configuration");
+    }
+    std::vector<size_t> weights;
+    size_t weight = 1;
+    for (int level = 0; level < _numPriorityLevels; ++level)
+    {
+        weights.push_back(weight);
+        if (weight < std::numeric_limits<uint32_t>::max())
+        {
+            weight *= _priorityLevelWeight; //cannot overflow
+        }
+    }
+    return weights;
+}
+
+inline
+Configuration::SchedulingPolicy Configuration::getCoroutineSchedulingPolicy() const
+{
+    return _coroutineSchedulingPolicy;
+}
+
+inline
+bool Configuration::getDropExpiredCoroutines() const
+{
+    return _dropExpiredCoroutines;
+}
+
+inline
+bool Configuration::getInlineContinuations() const
+{
+    return _inlineContinuations;
+}
+
+inline
+std::chrono::microseconds Configuration::getLongSliceThresholdUs() const
+{
+    return _longSliceThresholdUs;
+}
+
+inline
+const Configuration::LongSliceCallback& Configuration::getLongSliceCallback() const
+{
+    return _longSliceCallback;
+}
+
+inline
+size_t Configuration::getMaxPendingCoroTasks() const
+{
+    return _maxPendingCoroTasks;
+}
+
+inline
+size_t Configuration::getMaxPendingIoTasks() const
+{
+    return _maxPendingIoTasks;
+}
+
+inline
+const Configuration::OverloadCallback& Configuration::getOverloadCallback() const
+{
+    return _overloadCallback;
+}
+
+inline
+Configuration::ThreadPlacement Configuration::getThreadPlacement() const
+{
+    return _threadPlacement;
+}
+
+inline
+int Configuration::getMaxNumCoroutineThreads() const
+{
+    return _maxNumCoroutineThreads;
+}
+
+inline
+Configuration::PlacementPolicy Configuration::getCoroutinePlacementPolicy() const
+{
+    return _coroutinePlacementPolicy;
+}
+
+inline
+int Configuration::getAffinityVirtualNodes() const
+{
+    return _affinityVirtualNodes;
+}
+
+inline
+size_t Configuration::getSharedIoRingCapacity() const
+{
+    return _sharedIoRingCapacity;
+}
+
+inline
+Configuration::RingFullPolicy Configuration::getSharedIoRingFullPolicy() const
+{
+    return _sharedIoRingFullPolicy;
+}
+
+inline
+size_t Configuration::getLoadBalanceNumPollsBeforeParking() const
+{
+    return _loadBalanceNumPollsBeforeParking;
+}
+
+inline
+int Configuration::getMaxNumElasticIoThreads() const
+{
+    return _maxNumElasticIoThreads;
+}
+
+inline
+std::chrono::milliseconds Configuration::getElasticIoSpawnThresholdMs() const
+{
+    return _elasticIoSpawnThresholdMs;
+}
+
+inline
+std::chrono::milliseconds Configuration::getElasticIoIdleTimeoutMs() const
+{
+    return _elasticIoIdleTimeoutMs;
+}
+
+inline
+std::string Configuration::getIoThreadCpus() const
+{
+    return _ioThreadCpus;
+}
+
+inline
+bool Configuration::getPinIoThreadsToCores() const
+{
+    return _pinIoThreadsToCores;
+}
+
+inline
+Configuration::SchedPolicy Configuration::getIoThreadSchedPolicy() const
+{
+    return _ioThreadSchedPolicy;
+}
+
+inline
+int Configuration::getIoThreadSchedPriority() const
+{
+    return _ioThreadSchedPriority;
+}
+
+inline
+const IMetricsSink::Ptr& Configuration::getMetricsSink() const
+{
+    return _metricsSink;
+}
+
+inline
+std::chrono::milliseconds Configuration::getMetricsExportPeriodMs() const
+{
+    return _metricsExportPeriodMs;
+}
+
+inline
+const SharedMemoryQueue::Ptr& Configuration::getSharedMemoryQueue() const
+{
+    return _sharedMemoryQueue;
+}
+
+inline
+std::chrono::milliseconds Configuration::getSharedMemoryQueuePollIntervalMs() const
+{
+    return _sharedMemoryQueuePollIntervalMs;
+}
+
 }
 }
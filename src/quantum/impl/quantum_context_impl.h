@@ -40,6 +40,20 @@ const NonBufferRetType<V>& IThreadContext<RET>::getRef() const
     return static_cast<const Impl*>(this)->template getRef();
 }
 
+template <class RET>
+template <class V>
+SharedFuture<NonBufferRetType<V>> IThreadContext<RET>::share() const
+{
+    return static_cast<const Impl*>(this)->template share();
+}
+
+template <class RET>
+template <class FUNC>
+void IThreadContext<RET>::onReady(FUNC&& callback)
+{
+    static_cast<Impl*>(this)->onReady(std::forward<FUNC>(callback));
+}
+
 template <class RET>
 template <class OTHER_RET>
 NonBufferRetType<OTHER_RET> IThreadContext<RET>::getAt(int num)
@@ -75,6 +89,20 @@ BufferRetType<V> IThreadContext<RET>::pull(bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull(isBufferClosed);
 }
 
+template <class RET>
+template <class ITER, class V, class>
+void IThreadContext<RET>::pushBatch(ITER first, ITER last)
+{
+    static_cast<Impl*>(this)->template pushBatch(first, last);
+}
+
+template <class RET>
+template <class V>
+std::vector<BufferRetType<V>> IThreadContext<RET>::pullBatch(size_t maxItems, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullBatch(maxItems, isBufferClosed);
+}
+
 template <class RET>
 template <class V, class>
 int IThreadContext<RET>::closeBuffer()
@@ -142,6 +170,34 @@ const NonBufferRetType<V>& ICoroContext<RET>::getRef(ICoroSync::Ptr sync) const
     return static_cast<const Impl*>(this)->template getRef(sync);
 }
 
+template <class RET>
+template <class V>
+SharedFuture<NonBufferRetType<V>> ICoroContext<RET>::share() const
+{
+    return static_cast<const Impl*>(this)->template share();
+}
+
+template <class RET>
+template <class V>
+bool ICoroContext<RET>::getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value)
+{
+    return static_cast<Impl*>(this)->template getFor<V>(sync, timeMs, value);
+}
+
+template <class RET>
+template <class CLOCK, class DURATION, class V>
+bool ICoroContext<RET>::getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value)
+{
+    return static_cast<Impl*>(this)->template getUntil<CLOCK, DURATION, V>(sync, deadline, value);
+}
+
+template <class RET>
+template <class FUNC>
+void ICoroContext<RET>::onReady(FUNC&& callback)
+{
+    static_cast<Impl*>(this)->onReady(std::forward<FUNC>(callback));
+}
+
 template <class RET>
 template <class OTHER_RET>
 NonBufferRetType<OTHER_RET> ICoroContext<RET>::getPrev()
@@ -172,6 +228,20 @@ const NonBufferRetType<OTHER_RET>& ICoroContext<RET>::getRefAt(int num, ICoroSyn
     return static_cast<const Impl*>(this)->template getRefAt<OTHER_RET>(num, sync);
 }
 
+template <class RET>
+template <class OTHER_RET>
+bool ICoroContext<RET>::getForAt(int num, ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<OTHER_RET>& value)
+{
+    return static_cast<Impl*>(this)->template getForAt<OTHER_RET>(num, sync, timeMs, value);
+}
+
+template <class RET>
+template <class OTHER_RET, class CLOCK, class DURATION>
+bool ICoroContext<RET>::getUntilAt(int num, ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<OTHER_RET>& value)
+{
+    return static_cast<Impl*>(this)->template getUntilAt<OTHER_RET, CLOCK, DURATION>(num, sync, deadline, value);
+}
+
 template <class RET>
 template <class V, class>
 int ICoroContext<RET>::set(V&& value)
@@ -195,6 +265,21 @@ BufferRetType<V> ICoroContext<RET>::pull(ICoroSync::Ptr sync, bool& isBufferClos
     return static_cast<Impl*>(this)->template pull(sync, isBufferClosed);
 }
 
+template <class RET>
+template <class ITER, class V, class>
+void ICoroContext<RET>::pushBatch(ITER first, ITER last)
+{
+    std::shared_ptr<Impl> ctx = static_cast<Impl*>(this)->shared_from_this();
+    ctx->template pushBatch(ctx, first, last);
+}
+
+template <class RET>
+template <class V>
+std::vector<BufferRetType<V>> ICoroContext<RET>::pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullBatch(sync, maxItems, isBufferClosed);
+}
+
 template <class RET>
 template <class V, class>
 int ICoroContext<RET>::closeBuffer()
@@ -202,6 +287,13 @@ int ICoroContext<RET>::closeBuffer()
     return static_cast<Impl*>(this)->template closeBuffer();
 }
 
+template <class RET>
+template <class V, class>
+int ICoroContext<RET>::setBufferCapacity(size_t capacity)
+{
+    return static_cast<Impl*>(this)->template setBufferCapacity(capacity);
+}
+
 template <class RET>
 int ICoroContext<RET>::getNumCoroutineThreads() const
 {
@@ -230,6 +322,30 @@ ICoroContext<RET>::post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&...
     return static_cast<Impl*>(this)->template post<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::post(int queueId, int priority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template post<OTHER_RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+ICoroContext<RET>::postBatch(INPUT_IT first, INPUT_IT last)
+{
+    return static_cast<Impl*>(this)->template postBatch<OTHER_RET>(first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+ICoroContext<RET>::postBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last)
+{
+    return static_cast<Impl*>(this)->template postBatch<OTHER_RET>(queueId, isHighPriority, first, last);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroContextPtr<OTHER_RET>
@@ -246,6 +362,14 @@ ICoroContext<RET>::postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS
     return static_cast<Impl*>(this)->template postFirst<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postFirst(int queueId, int priority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postFirst<OTHER_RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroContextPtr<OTHER_RET>
@@ -293,6 +417,64 @@ ICoroContext<RET>::postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, AR
     return static_cast<Impl*>(this)->template postAsyncIo<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+ICoroContext<RET>::postAsyncIo(int queueId, int priority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAsyncIo<OTHER_RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+ICoroContext<RET>::postAsyncIoBatch(INPUT_IT first, INPUT_IT last)
+{
+    return static_cast<Impl*>(this)->template postAsyncIoBatch<OTHER_RET>(first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+ICoroContext<RET>::postAsyncIoBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last)
+{
+    return static_cast<Impl*>(this)->template postAsyncIoBatch<OTHER_RET>(queueId, isHighPriority, first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+ICoroContext<RET>::postAsyncIoGroup(const std::string& group, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAsyncIoGroup<OTHER_RET>(group, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+#if defined(__linux__)
+template <class RET>
+int ICoroContext<RET>::awaitReadable(int fd, std::chrono::milliseconds timeMs)
+{
+    return static_cast<Impl*>(this)->awaitReadable(fd, timeMs);
+}
+
+template <class RET>
+int ICoroContext<RET>::awaitWritable(int fd, std::chrono::milliseconds timeMs)
+{
+    return static_cast<Impl*>(this)->awaitWritable(fd, timeMs);
+}
+
+template <class RET>
+ssize_t ICoroContext<RET>::read(int fd, void* buf, size_t count)
+{
+    return static_cast<Impl*>(this)->read(fd, buf, count);
+}
+
+template <class RET>
+ssize_t ICoroContext<RET>::write(int fd, const void* buf, size_t count)
+{
+    return static_cast<Impl*>(this)->write(fd, buf, count);
+}
+#endif
+
 template <class RET>
 template <class OTHER_RET, class INPUT_IT, class>
 CoroContextPtr<std::vector<OTHER_RET>>
@@ -333,6 +515,39 @@ ICoroContext<RET>::forEachBatch(INPUT_IT first,
     return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, num, std::move(func));
 }
 
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+ICoroContext<RET>::forEachChunked(INPUT_IT first,
+                                  INPUT_IT last,
+                                  Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                                  size_t grainSize)
+{
+    return static_cast<Impl*>(this)->template forEachChunked<OTHER_RET>(first, last, std::move(func), grainSize);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+ICoroContext<RET>::forEachChunked(INPUT_IT first,
+                                  size_t num,
+                                  Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                                  size_t grainSize)
+{
+    return static_cast<Impl*>(this)->template forEachChunked<OTHER_RET>(first, num, std::move(func), grainSize);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+ICoroContext<RET>::forEachBatchSplit(INPUT_IT first,
+                                     INPUT_IT last,
+                                     Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                                     size_t grainSize)
+{
+    return static_cast<Impl*>(this)->template forEachBatchSplit<OTHER_RET>(first, last, std::move(func), grainSize);
+}
+
 template <class RET>
 template <class KEY,
           class MAPPED_TYPE,
@@ -395,6 +610,232 @@ ICoroContext<RET>::mapReduceBatch(INPUT_IT first,
         (first, num, std::move(mapper), std::move(reducer));
 }
 
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class INPUT_IT,
+          class>
+CoroContextPtr<RESULT>
+ICoroContext<RET>::mapReducePartitioned(INPUT_IT first,
+                                        INPUT_IT last,
+                                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                        size_t numPartitions,
+                                        Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return static_cast<Impl*>(this)->template mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>
+        (first, last, std::move(mapper), std::move(reducer), numPartitions, std::move(combiner));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class INPUT_IT>
+CoroContextPtr<RESULT>
+ICoroContext<RET>::mapReducePartitioned(INPUT_IT first,
+                                        size_t num,
+                                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                        size_t numPartitions,
+                                        Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return static_cast<Impl*>(this)->template mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>
+        (first, num, std::move(mapper), std::move(reducer), numPartitions, std::move(combiner));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class T>
+CoroContextPtr<RESULT>
+ICoroContext<RET>::mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                                   Functions::StreamMapFunc<KEY, MAPPED_TYPE, T> mapper,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                   size_t numPartitions,
+                                   Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return static_cast<Impl*>(this)->template mapReduceStream<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>
+        (std::move(input), std::move(mapper), std::move(reducer), numPartitions, std::move(combiner));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<OTHER_RET>
+Context<RET>::reduce(INPUT_IT first,
+                     INPUT_IT last,
+                     OTHER_RET init,
+                     Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return reduce<OTHER_RET>(first, std::distance(first, last), std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<OTHER_RET>
+Context<RET>::reduce(INPUT_IT first,
+                     size_t num,
+                     OTHER_RET init,
+                     Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return post<OTHER_RET>(Util::transformReduceCoro<OTHER_RET, INPUT_IT, Util::Identity<OTHER_RET>>,
+                           INPUT_IT{first},
+                           size_t{num},
+                           OTHER_RET{std::move(init)},
+                           Util::Identity<OTHER_RET>{},
+                           Functions::BinaryOpFunc<OTHER_RET>{std::move(op)},
+                           getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<OTHER_RET>
+Context<RET>::transformReduce(INPUT_IT first,
+                              INPUT_IT last,
+                              OTHER_RET init,
+                              Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                              Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return transformReduce<OTHER_RET>(first, std::distance(first, last), std::move(init), std::move(transform), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<OTHER_RET>
+Context<RET>::transformReduce(INPUT_IT first,
+                              size_t num,
+                              OTHER_RET init,
+                              Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                              Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return post<OTHER_RET>(Util::transformReduceCoro<OTHER_RET, INPUT_IT, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>,
+                           INPUT_IT{first},
+                           size_t{num},
+                           OTHER_RET{std::move(init)},
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(transform)},
+                           Functions::BinaryOpFunc<OTHER_RET>{std::move(op)},
+                           getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::inclusiveScan(INPUT_IT first,
+                            INPUT_IT last,
+                            Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return inclusiveScan<OTHER_RET>(first, std::distance(first, last), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::inclusiveScan(INPUT_IT first,
+                            size_t num,
+                            Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return post<std::vector<OTHER_RET>>(Util::inclusiveScanCoro<OTHER_RET, INPUT_IT>,
+                                        INPUT_IT{first},
+                                        size_t{num},
+                                        Functions::BinaryOpFunc<OTHER_RET>{std::move(op)},
+                                        getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::reduce(INPUT_IT first,
+                          INPUT_IT last,
+                          OTHER_RET init,
+                          Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template reduce<OTHER_RET>(first, last, std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::reduce(INPUT_IT first,
+                          size_t num,
+                          OTHER_RET init,
+                          Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template reduce<OTHER_RET>(first, num, std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::transformReduce(INPUT_IT first,
+                                   INPUT_IT last,
+                                   OTHER_RET init,
+                                   Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                                   Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template transformReduce<OTHER_RET>(first, last, std::move(init), std::move(transform), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::transformReduce(INPUT_IT first,
+                                   size_t num,
+                                   OTHER_RET init,
+                                   Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                                   Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template transformReduce<OTHER_RET>(first, num, std::move(init), std::move(transform), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::inclusiveScan(INPUT_IT first,
+                                 INPUT_IT last,
+                                 Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template inclusiveScan<OTHER_RET>(first, last, std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::inclusiveScan(INPUT_IT first,
+                                 size_t num,
+                                 Functions::BinaryOpFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template inclusiveScan<OTHER_RET>(first, num, std::move(op));
+}
+
+template <class RET>
+template <class RANDOM_IT, class COMPARE, class>
+std::shared_ptr<Context<int>>
+Context<RET>::sort(RANDOM_IT first,
+                   RANDOM_IT last,
+                   COMPARE comp)
+{
+    return post<int>(Util::sortCoro<RANDOM_IT, COMPARE>,
+                     RANDOM_IT{first},
+                     RANDOM_IT{last},
+                     COMPARE{std::move(comp)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class RANDOM_IT, class COMPARE, class>
+std::shared_ptr<ICoroContext<int>>
+ICoroContext<RET>::sort(RANDOM_IT first,
+                        RANDOM_IT last,
+                        COMPARE comp)
+{
+    return static_cast<Impl*>(this)->sort(first, last, std::move(comp));
+}
+
 //==============================================================================================
 //                                     class Context
 //==============================================================================================
@@ -403,35 +844,47 @@ ICoroContext<RET>::mapReduceBatch(INPUT_IT first,
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using ContextAllocator = HeapAllocator<Context<int>>;
+        using ContextAllocator = HeapAllocator<SharedBlock<Context<int>>>;
     #else
-        using ContextAllocator = StackAllocator<Context<int>, __QUANTUM_CONTEXT_ALLOC_SIZE>;
+        using ContextAllocator = StackAllocator<SharedBlock<Context<int>>, __QUANTUM_CONTEXT_ALLOC_SIZE>;
     #endif
 #else
-    using ContextAllocator = StlAllocator<Context<int>>;
+    using ContextAllocator = StlAllocator<SharedBlock<Context<int>>>;
 #endif
 
+struct ContextPool
+{
+    static ContextAllocator& instance()
+    {
+        return Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize());
+    }
+};
+
 template <class RET>
 Context<RET>::Context(DispatcherCore& dispatcher) :
-    _promises(1, PromisePtr<RET>(new Promise<RET>(), Promise<RET>::deleter)),
+    _promises(1, Promise<RET>::create()),
     _dispatcher(&dispatcher),
     _terminated(ATOMIC_FLAG_INIT),
-    _signal(-1),
     _yield(nullptr),
-    _sleepDuration(0)
+    _stackSize(0)
 {}
 
 template <class RET>
 template <class OTHER_RET>
 Context<RET>::Context(Context<OTHER_RET>& other) :
-    _promises(other._promises),
     _dispatcher(other._dispatcher),
     _terminated(ATOMIC_FLAG_INIT),
-    _signal(-1),
     _yield(nullptr),
-    _sleepDuration(0)
+    _stackSize(other._stackSize),
+    _cancellationToken(other._cancellationToken)
 {
-    _promises.emplace_back(PromisePtr<RET>(new Promise<RET>(), Promise<RET>::deleter)); //append a new promise
+    _localStorage.inherit(other._localStorage);
+    _promises.reserve(other._promises.size() + 1);
+    for (auto&& promise : other._promises)
+    {
+        _promises.push_back(promise);
+    }
+    _promises.emplace_back(Promise<RET>::create()); //append a new promise
 }
 
 template <class RET>
@@ -447,8 +900,8 @@ void Context<RET>::terminate()
     {
         _promises.back()->terminate();
         
-        //unlink task ptr
-        _task.reset();
+        //unlink task ptr. notify() may read it concurrently from another thread.
+        std::atomic_store(&_task, ITask::Ptr());
     }
 }
 
@@ -473,31 +926,19 @@ int Context<RET>::setException(std::exception_ptr ex)
 template <class RET>
 bool Context<RET>::isBlocked() const
 {
-    return _signal == 0;
+    return CoroutineState::isBlocked();
 }
 
 template <class RET>
 bool Context<RET>::isSleeping(bool updateTimer)
 {
-    if (_sleepDuration.count() > 0) {
-        if (!updateTimer) {
-            return true;
-        }
-        auto now = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now-_sleepTimestamp);
-        if (elapsed >= _sleepDuration) {
-            //expired so we reset all values
-            _sleepDuration = std::chrono::microseconds(0);
-            _sleepTimestamp = std::chrono::high_resolution_clock::time_point{};
-        }
-        else {
-            //reduce duration and save new timestamp
-            _sleepDuration -= elapsed;
-            _sleepTimestamp = now;
-            return true;
-        }
-    }
-    return false;
+    return CoroutineState::isSleeping(updateTimer);
+}
+
+template <class RET>
+std::chrono::high_resolution_clock::time_point Context<RET>::getSleepDeadline() const
+{
+    return CoroutineState::getSleepDeadline();
 }
 
 template <class RET>
@@ -557,24 +998,66 @@ void Context<RET>::validateTaskType(ITask::Type type) const
 }
 
 template <class RET>
-void Context<RET>::validateContext(ICoroSync::Ptr sync) const
+void Context<RET>::validateContext(ICoroSync::Ptr sync) const
+{
+    if (static_cast<const ICoroSync*>(this) == sync.get())
+    {
+        throw std::runtime_error("Must use different synchronization object");
+    }
+}
+
+template <class RET>
+void Context<RET>::setTask(ITask::Ptr task)
+{
+    std::atomic_store(&_task, task);
+}
+
+template <class RET>
+ITask::Ptr Context<RET>::getTask() const
+{
+    return _task;
+}
+
+template <class RET>
+void Context<RET>::setStackSize(size_t stackSize)
 {
-    if (static_cast<const ICoroSync*>(this) == sync.get())
-    {
-        throw std::runtime_error("Must use different synchronization object");
-    }
+    _stackSize = stackSize;
 }
 
 template <class RET>
-void Context<RET>::setTask(ITask::Ptr task)
+size_t Context<RET>::getStackSize() const
 {
-    _task = task;
+    return _stackSize;
 }
 
 template <class RET>
-ITask::Ptr Context<RET>::getTask() const
+void Context<RET>::setCancellationToken(CancellationToken::Ptr token)
 {
-    return _task;
+    _cancellationToken = std::move(token);
+}
+
+template <class RET>
+const CancellationToken::Ptr& Context<RET>::getCancellationToken() const
+{
+    return _cancellationToken;
+}
+
+template <class RET>
+bool Context<RET>::isCancelled() const
+{
+    return _cancellationToken && _cancellationToken->isCancelled();
+}
+
+template <class RET>
+CoroLocalStorage& Context<RET>::localStorage()
+{
+    return _localStorage;
+}
+
+template <class RET>
+CoroArena& Context<RET>::arena()
+{
+    return _arena;
 }
 
 template <class RET>
@@ -593,7 +1076,12 @@ Traits::Yield& Context<RET>::getYieldHandle()
 template <class RET>
 void Context<RET>::yield()
 {
+    QUANTUM_TRACE(Tracer::Event::Yielded, _task.get(), IQueue::QueueType::Coro, _task->getQueueId());
     getYieldHandle()();
+    if (isCancelled())
+    {
+        throw CancellationException();
+    }
 }
 
 template <class RET>
@@ -602,6 +1090,19 @@ std::atomic_int& Context<RET>::signal()
     return _signal;
 }
 
+template <class RET>
+void Context<RET>::notify()
+{
+    _signal = 1;
+    //The coroutine may resume and terminate as soon as it's signalled
+    ITask::Ptr task = std::atomic_load(&_task);
+    if (task)
+    {
+        //reschedule the coroutine if it was parked
+        _dispatcher->wakeUp(task);
+    }
+}
+
 template <class RET>
 void Context<RET>::sleep(const std::chrono::milliseconds& timeMs)
 {
@@ -614,7 +1115,9 @@ void Context<RET>::sleep(const std::chrono::microseconds& timeUs)
     _sleepDuration = timeUs;
     _sleepTimestamp = std::chrono::high_resolution_clock::now();
     if (isSleeping()) {
-        yield();
+        QUANTUM_TRACE(Tracer::Event::Blocked, _task.get(), IQueue::QueueType::Coro, _task->getQueueId());
+        //Timed waits sleep while registered with their primitive so this must not throw
+        getYieldHandle()();
     }
 }
 
@@ -623,15 +1126,13 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::thenImpl(ITask::Type type, FUNC&& func, ARGS&&... args)
 {
-    auto ctx = ContextPtr<OTHER_RET>(new Context<OTHER_RET>(*this),
-                                     Context<OTHER_RET>::deleter);
-    auto task = Task::Ptr(new Task(ctx,
-                                   _task->getQueueId(),      //keep current queueId
-                                   _task->isHighPriority(),  //keep current priority
-                                   type,
-                                   std::forward<FUNC>(func),
-                                   std::forward<ARGS>(args)...),
-                          Task::deleter);
+    auto ctx = Context<OTHER_RET>::create(*this);
+    auto task = Task::create(ctx,
+                             _task->getQueueId(),      //keep current queueId
+                             _task->getPriority(),  //keep current priority
+                             type,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
     ctx->setTask(task);
     
     //Chain tasks
@@ -692,25 +1193,163 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroFuturePtr<OTHER_RET>
 Context<RET>::postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
 {
-    return postAsyncIoImpl<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postAsyncIoImpl<OTHER_RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+Context<RET>::postAsyncIo(int queueId, int priority, FUNC&& func, ARGS&&... args)
+{
+    return postAsyncIoImpl<OTHER_RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+Context<RET>::postAsyncIoBatch(INPUT_IT first, INPUT_IT last)
+{
+    return postAsyncIoBatch<OTHER_RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+Context<RET>::postAsyncIoBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    std::vector<CoroFuturePtr<OTHER_RET>> futures;
+    std::vector<IoTask::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto promise = Promise<OTHER_RET>::create();
+        tasks.emplace_back(new IoTask(promise,
+                                      queueId,
+                                      isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal,
+                                      *first),
+                           IoTask::deleter);
+        futures.emplace_back(promise->getICoroFuture());
+    }
+    _dispatcher->postAsyncIoBatch(tasks);
+    return futures;
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+Context<RET>::postAsyncIoGroup(const std::string& group, FUNC&& func, ARGS&&... args)
+{
+    auto promise = Promise<OTHER_RET>::create();
+    auto task = IoTask::Ptr(new IoTask(promise,
+                                       (int)IQueue::QueueId::Any,
+                                       (int)IQueue::Priority::Normal,
+                                       std::forward<FUNC>(func),
+                                       std::forward<ARGS>(args)...),
+                            IoTask::deleter);
+    task->setCompletionPromise(promise);
+    _dispatcher->postAsyncIoGroup(group, task);
+    return promise->getICoroFuture();
+}
+
+#if defined(__linux__)
+template <class RET>
+int Context<RET>::awaitReadable(int fd, std::chrono::milliseconds timeMs)
+{
+    return awaitFd(fd, Reactor::Direction::Read, timeMs);
+}
+
+template <class RET>
+int Context<RET>::awaitWritable(int fd, std::chrono::milliseconds timeMs)
+{
+    return awaitFd(fd, Reactor::Direction::Write, timeMs);
+}
+
+template <class RET>
+ssize_t Context<RET>::read(int fd, void* buf, size_t count)
+{
+    while (true)
+    {
+        ssize_t rc = ::read(fd, buf, count);
+        if ((rc >= 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+        {
+            return rc;
+        }
+        if (errno != EINTR)
+        {
+            awaitFd(fd, Reactor::Direction::Read, std::chrono::milliseconds(-1));
+        }
+    }
+}
+
+template <class RET>
+ssize_t Context<RET>::write(int fd, const void* buf, size_t count)
+{
+    while (true)
+    {
+        ssize_t rc = ::write(fd, buf, count);
+        if ((rc >= 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+        {
+            return rc;
+        }
+        if (errno != EINTR)
+        {
+            awaitFd(fd, Reactor::Direction::Write, std::chrono::milliseconds(-1));
+        }
+    }
+}
+
+template <class RET>
+int Context<RET>::awaitFd(int fd, Reactor::Direction direction, std::chrono::milliseconds timeMs)
+{
+    auto promise = Promise<int>::create();
+    auto future = promise->getICoroFuture();
+    Reactor& reactor = _dispatcher->getReactor();
+    reactor.await(fd, direction, promise);
+    promise.reset(); //the reactor holds the only reference
+    ICoroSync::Ptr sync = this->shared_from_this();
+    if ((timeMs.count() >= 0) &&
+        (future->waitFor(sync, timeMs) == std::future_status::timeout) &&
+        reactor.cancel(fd, direction))
+    {
+        return 0; //timed out
+    }
+    //Either ready or the reactor completed it while the wait was being cancelled
+    return future->get(sync);
 }
+#endif
 
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroFuturePtr<OTHER_RET>
-Context<RET>::postAsyncIoImpl(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+Context<RET>::postAsyncIoImpl(int queueId, int priority, FUNC&& func, ARGS&&... args)
 {
     if (queueId < (int)IQueue::QueueId::Any)
     {
         throw std::runtime_error("Invalid coroutine queue id");
     }
-    auto promise = PromisePtr<OTHER_RET>(new Promise<OTHER_RET>(), Promise<OTHER_RET>::deleter);
+    if (priority < (int)IQueue::Priority::Normal)
+    {
+        throw std::runtime_error("Invalid priority");
+    }
+    auto promise = Promise<OTHER_RET>::create();
+    if (isCancelled())
+    {
+        promise->setException(std::make_exception_ptr(CancellationException()));
+        return promise->getICoroFuture();
+    }
     auto task = IoTask::Ptr(new IoTask(promise,
                                        queueId,
-                                       isHighPriority,
+                                       priority,
                                        std::forward<FUNC>(func),
                                        std::forward<ARGS>(args)...),
                             IoTask::deleter);
+    if (_cancellationToken)
+    {
+        task->setCancellationToken(_cancellationToken, promise);
+    }
     _dispatcher->postAsyncIo(task);
     return promise->getICoroFuture();
 }
@@ -762,6 +1401,49 @@ Context<RET>::forEachBatch(INPUT_IT first,
                                                      getNumCoroutineThreads());
 }
 
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::forEachChunked(INPUT_IT first,
+                             INPUT_IT last,
+                             Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                             size_t grainSize)
+{
+    return forEachChunked<OTHER_RET>(first, std::distance(first, last), std::move(func), grainSize);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::forEachChunked(INPUT_IT first,
+                             size_t num,
+                             Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                             size_t grainSize)
+{
+    return post<std::vector<OTHER_RET>>(Util::forEachChunkedCoro<OTHER_RET, INPUT_IT>,
+                                        INPUT_IT{first},
+                                        size_t{num},
+                                        Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
+                                        size_t{grainSize},
+                                        getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatchSplit(INPUT_IT first,
+                                INPUT_IT last,
+                                Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                                size_t grainSize)
+{
+    return post<std::vector<std::vector<OTHER_RET>>>(Util::forEachBatchSplitCoro<OTHER_RET, INPUT_IT>,
+                                                     INPUT_IT{first},
+                                                     INPUT_IT{last},
+                                                     Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
+                                                     size_t{grainSize},
+                                                     getNumCoroutineThreads());
+}
+
 template <class RET>
 template <class KEY,
           class MAPPED_TYPE,
@@ -830,6 +1512,71 @@ Context<RET>::mapReduceBatch(INPUT_IT first,
                                Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
 }
 
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class INPUT_IT,
+          class>
+ContextPtr<RESULT>
+Context<RET>::mapReducePartitioned(INPUT_IT first,
+                                   INPUT_IT last,
+                                   Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                   size_t numPartitions,
+                                   Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>(first, std::distance(first, last),
+        std::move(mapper), std::move(reducer), numPartitions, std::move(combiner));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class INPUT_IT>
+ContextPtr<RESULT>
+Context<RET>::mapReducePartitioned(INPUT_IT first,
+                                   size_t num,
+                                   Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                   size_t numPartitions,
+                                   Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return post<RESULT>(Util::mapReducePartitionedCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT, INPUT_IT>,
+                        INPUT_IT{first},
+                        size_t{num},
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        size_t{numPartitions},
+                        Functions::CombineFunc<MAPPED_TYPE>{std::move(combiner)},
+                        getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class T>
+ContextPtr<RESULT>
+Context<RET>::mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                              Functions::StreamMapFunc<KEY, MAPPED_TYPE, T> mapper,
+                              Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                              size_t numPartitions,
+                              Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return post<RESULT>(Util::mapReduceStreamCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT, T>,
+                        std::shared_ptr<ICoroFuture<Buffer<T>>>{std::move(input)},
+                        Functions::StreamMapFunc<KEY, MAPPED_TYPE, T>{std::move(mapper)},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        size_t{numPartitions},
+                        Functions::CombineFunc<MAPPED_TYPE>{std::move(combiner)},
+                        getNumCoroutineThreads());
+}
+
 template <class RET>
 template <class V, class>
 int Context<RET>::set(V&& value)
@@ -865,6 +1612,34 @@ BufferRetType<V> Context<RET>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     return std::static_pointer_cast<Promise<RET>>(_promises.back())->getICoroFuture()->template pull(sync, isBufferClosed);
 }
 
+template <class RET>
+template <class ITER, class V, class>
+void Context<RET>::pushBatch(ITER first, ITER last)
+{
+    std::static_pointer_cast<Promise<RET>>(_promises.back())->template pushBatch(first, last);
+}
+
+template <class RET>
+template <class ITER, class V, class>
+void Context<RET>::pushBatch(ICoroSync::Ptr sync, ITER first, ITER last)
+{
+    std::static_pointer_cast<Promise<RET>>(_promises.back())->template pushBatch(sync, first, last);
+}
+
+template <class RET>
+template <class V>
+std::vector<BufferRetType<V>> Context<RET>::pullBatch(size_t maxItems, bool& isBufferClosed)
+{
+    return std::static_pointer_cast<Promise<RET>>(_promises.back())->getIThreadFuture()->template pullBatch(maxItems, isBufferClosed);
+}
+
+template <class RET>
+template <class V>
+std::vector<BufferRetType<V>> Context<RET>::pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed)
+{
+    return std::static_pointer_cast<Promise<RET>>(_promises.back())->getICoroFuture()->template pullBatch(sync, maxItems, isBufferClosed);
+}
+
 template <class RET>
 template <class V, class>
 int Context<RET>::closeBuffer()
@@ -872,6 +1647,13 @@ int Context<RET>::closeBuffer()
     return std::static_pointer_cast<Promise<RET>>(_promises.back())->template closeBuffer();
 }
 
+template <class RET>
+template <class V, class>
+int Context<RET>::setBufferCapacity(size_t capacity)
+{
+    return std::static_pointer_cast<Promise<RET>>(_promises.back())->template setBufferCapacity(capacity);
+}
+
 template <class RET>
 template <class OTHER_RET>
 NonBufferRetType<OTHER_RET> Context<RET>::getAt(int num)
@@ -893,6 +1675,13 @@ NonBufferRetType<V> Context<RET>::get()
     return getAt<RET>(-1);
 }
 
+template <class RET>
+template <class FUNC>
+void Context<RET>::onReady(FUNC&& callback)
+{
+    std::static_pointer_cast<Promise<RET>>(_promises.back())->getIThreadFuture()->onReady(std::forward<FUNC>(callback));
+}
+
 template <class RET>
 template <class V>
 const NonBufferRetType<V>& Context<RET>::getRef() const
@@ -900,6 +1689,13 @@ const NonBufferRetType<V>& Context<RET>::getRef() const
     return getRefAt<RET>(-1);
 }
 
+template <class RET>
+template <class V>
+SharedFuture<NonBufferRetType<V>> Context<RET>::share() const
+{
+    return std::static_pointer_cast<Promise<RET>>(_promises.back())->getSharedFuture();
+}
+
 template <class RET>
 void Context<RET>::waitAt(int num) const
 {
@@ -977,6 +1773,36 @@ const NonBufferRetType<V>& Context<RET>::getRef(ICoroSync::Ptr sync) const
     return getRefAt<RET>(-1, sync);
 }
 
+template <class RET>
+template <class V>
+bool Context<RET>::getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value)
+{
+    return getForAt<RET>(-1, sync, timeMs, value);
+}
+
+template <class RET>
+template <class CLOCK, class DURATION, class V>
+bool Context<RET>::getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value)
+{
+    return getUntilAt<RET>(-1, sync, deadline, value);
+}
+
+template <class RET>
+template <class OTHER_RET>
+bool Context<RET>::getForAt(int num, ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<OTHER_RET>& value)
+{
+    validateContext(sync);
+    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(num)])->getICoroFuture()->getFor(sync, timeMs, value);
+}
+
+template <class RET>
+template <class OTHER_RET, class CLOCK, class DURATION>
+bool Context<RET>::getUntilAt(int num, ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<OTHER_RET>& value)
+{
+    validateContext(sync);
+    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(num)])->getICoroFuture()->getUntil(sync, deadline, value);
+}
+
 template <class RET>
 template <class OTHER_RET>
 NonBufferRetType<OTHER_RET> Context<RET>::getPrev(ICoroSync::Ptr sync)
@@ -1069,7 +1895,54 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
 {
-    return postImpl<OTHER_RET>(queueId, isHighPriority, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<OTHER_RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::post(int queueId, int priority, FUNC&& func, ARGS&&... args)
+{
+    return postImpl<OTHER_RET>(queueId, priority, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+Context<RET>::postBatch(INPUT_IT first, INPUT_IT last)
+{
+    return postBatch<OTHER_RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+Context<RET>::postBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last)
+{
+    if (queueId < (int)IQueue::QueueId::Same)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (queueId == (int)IQueue::QueueId::Same)
+    {
+        queueId = _task->getQueueId();
+    }
+    std::vector<CoroContextPtr<OTHER_RET>> contexts;
+    std::vector<Task::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto ctx = Context<OTHER_RET>::create(*_dispatcher);
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal,
+                                 ITask::Type::Standalone,
+                                 *first);
+        ctx->setTask(task);
+        tasks.emplace_back(std::move(task));
+        contexts.emplace_back(std::move(ctx));
+    }
+    _dispatcher->postBatch(tasks);
+    return contexts;
 }
 
 template <class RET>
@@ -1085,27 +1958,49 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
 {
-    return postImpl<OTHER_RET>(queueId, isHighPriority, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<OTHER_RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::postFirst(int queueId, int priority, FUNC&& func, ARGS&&... args)
+{
+    return postImpl<OTHER_RET>(queueId, priority, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
-Context<RET>::postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&& func, ARGS&&... args)
+Context<RET>::postImpl(int queueId, int priority, ITask::Type type, FUNC&& func, ARGS&&... args)
 {
     if (queueId < (int)IQueue::QueueId::Same)
     {
         throw std::runtime_error("Invalid coroutine queue id");
     }
-    auto ctx = ContextPtr<OTHER_RET>(new Context<OTHER_RET>(*_dispatcher),
-                                     Context<OTHER_RET>::deleter);
-    auto task = Task::Ptr(new Task(ctx,
-                                   (queueId == (int)IQueue::QueueId::Same) ? _task->getQueueId() : queueId,
-                                   isHighPriority,
-                                   type,
-                                   std::forward<FUNC>(func),
-                                   std::forward<ARGS>(args)...),
-                          Task::deleter);
+    if (priority < (int)IQueue::Priority::Normal)
+    {
+        throw std::runtime_error("Invalid priority");
+    }
+    auto ctx = Context<OTHER_RET>::create(*_dispatcher);
+    ctx->_localStorage.inherit(_localStorage);
+    if (_cancellationToken)
+    {
+        ctx->setCancellationToken(_cancellationToken);
+        if ((type == ITask::Type::Standalone) && _cancellationToken->isCancelled())
+        {
+            //Never scheduled so no stack is allocated
+            ctx->setException(std::make_exception_ptr(CancellationException()));
+            return ctx;
+        }
+    }
+    auto task = Task::create(ctx,
+                             (queueId == (int)IQueue::QueueId::Same) ? _task->getQueueId() : queueId,
+                             priority,
+                             type,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    task->setCancellationToken(_cancellationToken);
     ctx->setTask(task);
     if (type == ITask::Type::Standalone)
     {
@@ -1115,25 +2010,10 @@ Context<RET>::postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&
 }
 
 template <class RET>
-void* Context<RET>::operator new(size_t)
-{
-    return Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).allocate();
-}
-
-template <class RET>
-void Context<RET>::operator delete(void* p)
-{
-    Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).deallocate(static_cast<Context<int>*>(p));
-}
-
-template <class RET>
-void Context<RET>::deleter(Context<RET>* p)
+template <class ... ARGS>
+typename Context<RET>::Ptr Context<RET>::create(ARGS&&... args)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).dispose(reinterpret_cast<Context<int>*>(p));
-#else
-    delete p;
-#endif
+    return allocateShared<Context<RET>, ContextPool>(std::forward<ARGS>(args)...);
 }
 
 }}
@@ -17,6 +17,7 @@
 #include <type_traits>
 #include <assert.h>
 #include <exception>
+#include <cstring>
 
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
@@ -24,6 +25,23 @@
 namespace Bloomberg {
 namespace quantum {
 
+template <typename T>
+ContiguousPoolManager<T>::Segment::Segment(index_type size) :
+    _buffer(new aligned_type[size]),
+    _freeBlocks(new index_type[size]),
+    _freeBlockIndex(size-1),
+    _size(size),
+    _available(false)
+{
+    if (AllocatorTraits::useHugePages()) {
+        HugePages::advise(_buffer.get(), size * sizeof(aligned_type));
+    }
+    //build the free stack
+    for (index_type i = 0; i < size; ++i) {
+        _freeBlocks[i] = i;
+    }
+}
+
 template <typename T>
 ContiguousPoolManager<T>::ContiguousPoolManager()
 {
@@ -45,22 +63,38 @@ template <typename T>
 ContiguousPoolManager<T>& ContiguousPoolManager<T>::operator=(ContiguousPoolManager<T>&& other)
 {
     _size = other._size;
-    _buffer = other.buffer;
+    _buffer = other._buffer;
     _freeBlocks = other._freeBlocks;
     _freeBlockIndex = other._freeBlockIndex;
     _numHeapAllocatedBlocks = other._numHeapAllocatedBlocks;
     _spinlock = std::move(other._spinlock);
+    _cache = std::move(other._cache);
+    _segmentSize = other._segmentSize;
+    _releaseIdleSegments = other._releaseIdleSegments;
+    _segments = std::move(other._segments);
+    _availableSegments = std::move(other._availableSegments);
+    _numSegmentAllocatedBlocks = other._numSegmentAllocatedBlocks;
+    _peakAllocatedBlocks = other._peakAllocatedBlocks;
+    _numHeapFallbacks = other._numHeapFallbacks;
+    _lockContentionCount = other._lockContentionCount.load();
     
     // Reset other
     other._buffer = nullptr;
     other._freeBlocks = nullptr;
     other._freeBlockIndex = -1;
     other._numHeapAllocatedBlocks = 0;
+    other._segments.clear();
+    other._availableSegments.clear();
+    other._numSegmentAllocatedBlocks = 0;
+    return *this;
 }
 
 template <typename T>
 ContiguousPoolManager<T>::~ContiguousPoolManager()
 {
+    for (Segment* segment : _segments) {
+        delete segment;
+    }
     delete[] _freeBlocks;
 }
 
@@ -75,6 +109,10 @@ void ContiguousPoolManager<T>::setBuffer(aligned_type *buffer, index_type size)
     }
     _size = size;
     _buffer = buffer;
+    if (AllocatorTraits::useHugePages()) {
+        //e.g. stack allocator buffers which cannot be mapped separately
+        HugePages::advise(buffer, size * sizeof(aligned_type));
+    }
     _freeBlocks = new index_type[size];
     if (!_freeBlocks) {
         throw std::bad_alloc();
@@ -125,15 +163,29 @@ typename ContiguousPoolManager<T>::pointer
 ContiguousPoolManager<T>::allocate(size_type n, const_pointer)
 {
     assert(_buffer);
+    ThreadCache::Magazine* magazine = (n == 1) ? _cache.magazine() : nullptr;
+    if (magazine) {
+        index_type index;
+        if (magazine->pop(index) || refill(*magazine, index)) {
+            return reinterpret_cast<pointer>(&_buffer[index]);
+        }
+    }
     {
-        SpinLock::Guard lock(_spinlock);
+        PoolGuard lock(_spinlock, _lockContentionCount);
         if (findContiguous(static_cast<index_type>(n)))
         {
             _freeBlockIndex -= (n - 1);
-            return reinterpret_cast<pointer>(&_buffer[_freeBlocks[_freeBlockIndex--]]);
+            pointer p = reinterpret_cast<pointer>(&_buffer[_freeBlocks[_freeBlockIndex--]]);
+            updatePeak();
+            return p;
+        }
+        if ((n == 1) && (_segmentSize > 0)) {
+            return allocateFromSegment();
         }
         // Use heap allocation
         ++_numHeapAllocatedBlocks;
+        ++_numHeapFallbacks;
+        updatePeak();
     }
     return (pointer)new char[sizeof(value_type)];
 }
@@ -146,15 +198,26 @@ void ContiguousPoolManager<T>::deallocate(pointer p, size_type n)
         return;
     }
     if (isManaged(p)) {
+        ThreadCache::Magazine* magazine = (n == 1) ? _cache.magazine() : nullptr;
+        if (magazine) {
+            if (!magazine->push(blockIndex(p))) {
+                flush(*magazine);
+                magazine->push(blockIndex(p));
+            }
+            return;
+        }
         //find index of the block and return the individual blocks to the free pool
-        SpinLock::Guard lock(_spinlock);
+        PoolGuard lock(_spinlock, _lockContentionCount);
         for (size_type i = 0; i < n; ++i) {
             _freeBlocks[++_freeBlockIndex] = blockIndex(p+i);
         }
     }
+    else if (!_segments.empty() && deallocateToSegment(p)) {
+        return;
+    }
     else {
         delete[] (char*)p;
-        SpinLock::Guard lock(_spinlock);
+        PoolGuard lock(_spinlock, _lockContentionCount);
         --_numHeapAllocatedBlocks;
         assert(_numHeapAllocatedBlocks >= 0);
     }
@@ -179,7 +242,7 @@ void ContiguousPoolManager<T>::dispose(pointer p)
 template <typename T>
 size_t ContiguousPoolManager<T>::allocatedBlocks() const
 {
-    return _size ? _size - _freeBlockIndex - 1 : 0;
+    return _size ? _size - _freeBlockIndex - 1 - _cache.cachedBlocks() + _numSegmentAllocatedBlocks : 0;
 }
 
 template <typename T>
@@ -188,10 +251,32 @@ size_t ContiguousPoolManager<T>::allocatedHeapBlocks() const
     return _numHeapAllocatedBlocks;
 }
 
+template <typename T>
+size_t ContiguousPoolManager<T>::numSegments() const
+{
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    return _segments.size();
+}
+
+template <typename T>
+AllocatorStatistics ContiguousPoolManager<T>::stats() const
+{
+    AllocatorStatistics stats;
+    size_t cachedBlocks = _cache.cachedBlocks();
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    stats._capacity = _size + _segments.size() * _segmentSize;
+    stats._allocatedCount = (_size - _freeBlockIndex - 1) + _numSegmentAllocatedBlocks + _numHeapAllocatedBlocks - cachedBlocks;
+    stats._peakAllocatedCount = _peakAllocatedBlocks;
+    stats._heapAllocatedCount = _numHeapAllocatedBlocks;
+    stats._heapFallbackCount = _numHeapFallbacks;
+    stats._lockContentionCount = _lockContentionCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
 template <typename T>
 bool ContiguousPoolManager<T>::isFull() const
 {
-    return _freeBlockIndex == _size-1;
+    return allocatedBlocks() == 0;
 }
 
 template <typename T>
@@ -200,6 +285,16 @@ bool ContiguousPoolManager<T>::isEmpty() const
     return _freeBlockIndex == -1;
 }
 
+template <typename T>
+void ContiguousPoolManager<T>::warmUp(size_type num)
+{
+    //The buffer is committed by the OS as it is first written, so touch the blocks handed out next
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    for (ssize_t i = _freeBlockIndex; (i >= 0) && (_freeBlockIndex - i < (ssize_t)num); --i) {
+        std::memset(static_cast<void*>(&_buffer[_freeBlocks[i]]), 0, sizeof(aligned_type));
+    }
+}
+
 template <typename T>
 typename ContiguousPoolManager<T>::pointer ContiguousPoolManager<T>::bufferStart()
 {
@@ -241,5 +336,100 @@ bool ContiguousPoolManager<T>::findContiguous(index_type n)
     return found;
 }
 
-}}
+template <typename T>
+bool ContiguousPoolManager<T>::refill(ThreadCache::Magazine& magazine, index_type& index)
+{
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    if (isEmpty()) {
+        return false;
+    }
+    index = _freeBlocks[_freeBlockIndex--];
+    for (size_t i = 1; (i < magazine.batchSize()) && !isEmpty(); ++i) {
+        magazine.push(_freeBlocks[_freeBlockIndex--]);
+    }
+    updatePeak();
+    return true;
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::flush(ThreadCache::Magazine& magazine)
+{
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    index_type index;
+    for (size_t i = 0; (i < magazine.batchSize()) && magazine.pop(index); ++i) {
+        _freeBlocks[++_freeBlockIndex] = index;
+    }
+}
+
+template <typename T>
+typename ContiguousPoolManager<T>::pointer ContiguousPoolManager<T>::allocateFromSegment()
+{
+    //must be called with the lock held
+    if (_availableSegments.empty()) {
+        Segment* segment = new Segment(_segmentSize);
+        _segments.insert(std::upper_bound(_segments.begin(), _segments.end(), segment,
+            [](const Segment* lhs, const Segment* rhs) { return lhs->_buffer.get() < rhs->_buffer.get(); }),
+            segment);
+        segment->_available = true;
+        _availableSegments.push_back(segment);
+    }
+    Segment* segment = _availableSegments.back();
+    pointer p = reinterpret_cast<pointer>(&segment->_buffer[segment->_freeBlocks[segment->_freeBlockIndex--]]);
+    if (segment->_freeBlockIndex == -1) {
+        segment->_available = false;
+        _availableSegments.pop_back();
+    }
+    ++_numSegmentAllocatedBlocks;
+    updatePeak();
+    return p;
+}
+
+template <typename T>
+bool ContiguousPoolManager<T>::deallocateToSegment(pointer p)
+{
+    aligned_type* block = reinterpret_cast<aligned_type*>(p);
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    //find the last segment starting at or below the block
+    auto it = std::upper_bound(_segments.begin(), _segments.end(), block,
+        [](const aligned_type* lhs, const Segment* rhs) { return lhs < rhs->_buffer.get(); });
+    if (it == _segments.begin()) {
+        return false;
+    }
+    Segment* segment = *(--it);
+    if (block >= segment->_buffer.get() + segment->_size) {
+        return false; //heap block
+    }
+    segment->_freeBlocks[++segment->_freeBlockIndex] = static_cast<index_type>(block - segment->_buffer.get());
+    --_numSegmentAllocatedBlocks;
+    if (!segment->_available) {
+        segment->_available = true;
+        _availableSegments.push_back(segment);
+    }
+    if (_releaseIdleSegments &&
+             (segment->_freeBlockIndex == segment->_size - 1) &&
+             (_availableSegments.size() > 1)) {
+        releaseSegment(segment);
+    }
+    return true;
+}
 
+template <typename T>
+void ContiguousPoolManager<T>::releaseSegment(Segment* segment)
+{
+    //must be called with the lock held
+    _availableSegments.erase(std::find(_availableSegments.begin(), _availableSegments.end(), segment));
+    _segments.erase(std::find(_segments.begin(), _segments.end(), segment));
+    delete segment;
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::updatePeak()
+{
+    //must be called with the lock held
+    size_t allocated = (_size - _freeBlockIndex - 1) + _numSegmentAllocatedBlocks + _numHeapAllocatedBlocks;
+    if (allocated > _peakAllocatedBlocks) {
+        _peakAllocatedBlocks = allocated;
+    }
+}
+
+}}
@@ -0,0 +1,172 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#include <new>
+
+namespace Bloomberg {
+namespace quantum {
+
+struct CoroArena::ChunkCache
+{
+    ~ChunkCache()
+    {
+        while (_head)
+        {
+            Chunk* next = _head->_next;
+            ::operator delete(_head);
+            _head = next;
+        }
+    }
+    
+    Chunk*  _head{nullptr};
+    size_t  _size{0};
+};
+
+inline
+CoroArena::~CoroArena()
+{
+    release();
+}
+
+inline
+CoroArena::ChunkCache& CoroArena::threadCache()
+{
+    static thread_local ChunkCache cache;
+    return cache;
+}
+
+inline
+size_t CoroArena::chunkSize()
+{
+    return std::max<size_t>(AllocatorTraits::coroArenaChunkSize(), 2 * headerSize());
+}
+
+inline
+size_t CoroArena::headerSize()
+{
+    //keep the payload of each chunk aligned for any fundamental type
+    return (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+}
+
+inline
+void* CoroArena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(alignment - 1);
+    if (_cursor && (aligned + size <= reinterpret_cast<uintptr_t>(_end)))
+    {
+        _cursor = reinterpret_cast<char*>(aligned + size);
+        return reinterpret_cast<void*>(aligned);
+    }
+    size_t standardSize = chunkSize();
+    if (size + alignment > standardSize - headerSize())
+    {
+        return allocateDedicated(size, alignment);
+    }
+    //Start a new chunk. The space left in the current one is abandoned.
+    ChunkCache& cache = threadCache();
+    Chunk* chunk = cache._head;
+    if (chunk && (chunk->_size == standardSize))
+    {
+        cache._head = chunk->_next;
+        --cache._size;
+    }
+    else
+    {
+        chunk = static_cast<Chunk*>(::operator new(standardSize));
+        chunk->_size = standardSize;
+    }
+    chunk->_next = _chunks;
+    _chunks = chunk;
+    _capacity += standardSize;
+    _cursor = reinterpret_cast<char*>(chunk) + headerSize();
+    _end = reinterpret_cast<char*>(chunk) + standardSize;
+    aligned = (reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(alignment - 1);
+    _cursor = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+}
+
+inline
+void* CoroArena::allocateDedicated(size_t size, size_t alignment)
+{
+    size_t chunkSize = headerSize() + size + alignment;
+    Chunk* chunk = static_cast<Chunk*>(::operator new(chunkSize));
+    chunk->_size = chunkSize;
+    //Link it behind the current chunk so that bump allocation carries on where it was
+    if (_chunks)
+    {
+        chunk->_next = _chunks->_next;
+        _chunks->_next = chunk;
+    }
+    else
+    {
+        chunk->_next = nullptr;
+        _chunks = chunk;
+    }
+    _capacity += chunkSize;
+    uintptr_t payload = reinterpret_cast<uintptr_t>(chunk) + headerSize();
+    return reinterpret_cast<void*>((payload + alignment - 1) & ~(alignment - 1));
+}
+
+inline
+void CoroArena::deallocate(void* ptr, size_t size)
+{
+    if (static_cast<char*>(ptr) + size == _cursor)
+    {
+        _cursor = static_cast<char*>(ptr); //last allocation
+    }
+}
+
+inline
+void CoroArena::release()
+{
+    if (!_chunks)
+    {
+        return; //never used, don't touch the thread cache
+    }
+    ChunkCache& cache = threadCache();
+    size_t standardSize = chunkSize();
+    while (_chunks)
+    {
+        Chunk* next = _chunks->_next;
+        if ((_chunks->_size == standardSize) && (cache._size < AllocatorTraits::coroArenaCacheSize()))
+        {
+            _chunks->_next = cache._head;
+            cache._head = _chunks;
+            ++cache._size;
+        }
+        else
+        {
+            ::operator delete(_chunks);
+        }
+        _chunks = next;
+    }
+    _cursor = nullptr;
+    _end = nullptr;
+    _capacity = 0;
+}
+
+inline
+size_t CoroArena::capacity() const
+{
+    return _capacity;
+}
+
+}}
@@ -0,0 +1,127 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+static_assert(__QUANTUM_CORO_LOCAL_SLOTS > 0 && __QUANTUM_CORO_LOCAL_SLOTS <= 64,
+              "__QUANTUM_CORO_LOCAL_SLOTS must be in the range [1, 64]");
+
+inline
+void* CoroLocalStorage::get(int slot) const
+{
+    return (_setMask & (uint64_t(1) << slot)) ? _values[slot] : nullptr;
+}
+
+inline
+void CoroLocalStorage::set(int slot, void* value)
+{
+    _values[slot] = value;
+    if (value)
+    {
+        _setMask |= (uint64_t(1) << slot);
+    }
+    else
+    {
+        _setMask &= ~(uint64_t(1) << slot);
+    }
+}
+
+inline
+void CoroLocalStorage::inherit(const CoroLocalStorage& other)
+{
+    uint64_t mask = other._setMask;
+    if (!mask)
+    {
+        return; //common case when no keys are used
+    }
+    mask &= inheritableMask().load(std::memory_order_relaxed);
+    _setMask |= mask;
+    for (int slot = 0; mask; ++slot, mask >>= 1)
+    {
+        if (mask & 1)
+        {
+            _values[slot] = other._values[slot];
+        }
+    }
+}
+
+inline
+int CoroLocalStorage::allocateSlot(bool inherit)
+{
+    static std::atomic_int nextSlot{0};
+    int slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= Size)
+    {
+        throw std::runtime_error("Coroutine-local slots exhausted. Increase __QUANTUM_CORO_LOCAL_SLOTS.");
+    }
+    if (inherit)
+    {
+        inheritableMask().fetch_or(uint64_t(1) << slot, std::memory_order_relaxed);
+    }
+    return slot;
+}
+
+inline
+std::atomic<uint64_t>& CoroLocalStorage::inheritableMask()
+{
+    static std::atomic<uint64_t> mask{0};
+    return mask;
+}
+
+template <class T>
+CoroLocal<T>::CoroLocal(bool inherit) :
+    _slot(CoroLocalStorage::allocateSlot(inherit))
+{}
+
+template <class T>
+T* CoroLocal<T>::get(const CoroLocalStorage& storage) const
+{
+    return static_cast<T*>(storage.get(_slot));
+}
+
+template <class T>
+void CoroLocal<T>::set(CoroLocalStorage& storage, T* value) const
+{
+    storage.set(_slot, const_cast<void*>(static_cast<const void*>(value)));
+}
+
+template <class T>
+template <class CTX>
+T* CoroLocal<T>::get(const std::shared_ptr<CTX>& ctx) const
+{
+    return get(ctx->localStorage());
+}
+
+template <class T>
+template <class CTX>
+void CoroLocal<T>::set(const std::shared_ptr<CTX>& ctx, T* value) const
+{
+    set(ctx->localStorage(), value);
+}
+
+template <class T>
+int CoroLocal<T>::slot() const
+{
+    return _slot;
+}
+
+}}
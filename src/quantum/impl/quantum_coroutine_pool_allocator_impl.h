@@ -17,10 +17,14 @@
 #include <type_traits>
 #include <algorithm>
 #include <assert.h>
+#include <cstring>
 
 #if defined(BOOST_USE_VALGRIND)
     #include <valgrind/valgrind.h>
 #endif
+#if defined(__linux__) || defined(__APPLE__)
+    #include <sys/mman.h>
+#endif
 
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
@@ -29,27 +33,61 @@ namespace Bloomberg {
 namespace quantum {
 
 template <typename STACK_TRAITS>
-CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(index_type size) :
+CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(index_type size, size_t stackSize) :
     _size(size),
-    _blocks(new Header*[size]),
+    _blocks(nullptr),
+    _chunks(nullptr),
+    _chunkSize(0),
     _freeBlocks(new index_type[size]),
     _freeBlockIndex(size-1),
     _numHeapAllocatedBlocks(0),
-    _stackSize(std::min(std::max(traits::default_size(), traits::minimum_size()), traits::maximum_size()))
+    _stackSize(std::min(std::max(stackSize ? stackSize : traits::default_size(), traits::minimum_size()), traits::maximum_size())),
+    _spinlock(LockProfiler::site<CoroutinePoolAllocator>("CoroutinePoolAllocator")),
+    _region(nullptr),
+    _pageSize(traits::page_size()),
+    _slotSize(0),
+    _hugeRegion(nullptr),
+    _cache(AllocatorTraits::threadCacheSize()),
+    _peakAllocatedBlocks(0),
+    _numHeapFallbacks(0),
+    _lockContentionCount(0),
+    _profileStacks(AllocatorTraits::profileCoroStacks())
 {
-    if (!_blocks || !_freeBlocks) {
+    if (!_freeBlocks) {
         throw std::bad_alloc();
     }
     if (_size == 0) {
         throw std::runtime_error("Invalid coroutine allocator pool size");
     }
-    //pre-allocate all the coroutine stack blocks
-    for (index_type i = 0; i < size; ++i) {
-        _blocks[i] = reinterpret_cast<Header*>(new char[_stackSize]);
-        if (!_blocks[i]) {
-            throw std::bad_alloc();
+#if defined(__linux__) || defined(__APPLE__)
+    if (AllocatorTraits::useGuardedCoroStacks()) {
+        mapRegion();
+    }
+    else
+#endif
+    {
+        _blocks = new Header*[size]();
+        _slotSize = ((_stackSize + 63) / 64) * 64; //keep every stack cache line aligned
+        if (AllocatorTraits::useHugePages()) {
+            _hugeRegion = static_cast<char*>(HugePages::allocate(_size * _slotSize));
+        }
+        if (_hugeRegion) {
+            for (index_type i = 0; i < size; ++i) {
+                _blocks[i] = reinterpret_cast<Header*>(_hugeRegion + i * _slotSize);
+                _blocks[i]->_pos = i; //mark position
+            }
+        }
+        else {
+            //stacks are allocated by chunk on first use, or all at once if chunking is disabled
+            bool isLazy = AllocatorTraits::coroPoolChunkSize() > 0;
+            _chunkSize = isLazy ? AllocatorTraits::coroPoolChunkSize() : 1;
+            _chunks = new char*[numChunks()]();
+            if (!isLazy) {
+                for (index_type i = 0; i < size; ++i) {
+                    ensureBlock(i);
+                }
+            }
         }
-        _blocks[i]->_pos = i; //mark position
     }
     //initialize the free block list
     for (index_type i = 0; i < size; ++i) {
@@ -58,9 +96,12 @@ CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(index_type size) :
 }
 
 template <typename STACK_TRAITS>
-CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(CoroutinePoolAllocator<STACK_TRAITS>&& other)
+CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(CoroutinePoolAllocator<STACK_TRAITS>&& other) :
+    _cache(0),
+    _lockContentionCount(0),
+    _profileStacks(false)
 {
-    *this = other;
+    *this = std::move(other);
 }
 
 template <typename STACK_TRAITS>
@@ -68,37 +109,73 @@ CoroutinePoolAllocator<STACK_TRAITS>& CoroutinePoolAllocator<STACK_TRAITS>::oper
 {
     _size = other._size;
     _blocks = other._blocks;
+    _chunks = other._chunks;
+    _chunkSize = other._chunkSize;
     _freeBlocks = other._freeBlocks;
     _freeBlockIndex = other._freeBlockIndex;
     _numHeapAllocatedBlocks = other._numHeapAllocatedBlocks;
+    _stackSize = other._stackSize;
+    _region = other._region;
+    _pageSize = other._pageSize;
+    _slotSize = other._slotSize;
+    _hugeRegion = other._hugeRegion;
+    _cache = std::move(other._cache);
+    _peakAllocatedBlocks = other._peakAllocatedBlocks;
+    _numHeapFallbacks = other._numHeapFallbacks;
+    _lockContentionCount = other._lockContentionCount.load();
+    _profileStacks = other._profileStacks;
+    _stackUsage = other._stackUsage;
+    _taggedStackUsage = std::move(other._taggedStackUsage);
     
     // Reset other
+    other._size = 0;
     other._blocks = nullptr;
+    other._chunks = nullptr;
     other._freeBlocks = nullptr;
     other._freeBlockIndex = -1;
     other._numHeapAllocatedBlocks = 0;
+    other._region = nullptr;
+    other._hugeRegion = nullptr;
+    return *this;
 }
 
 template <typename STACK_TRAITS>
 CoroutinePoolAllocator<STACK_TRAITS>::~CoroutinePoolAllocator()
 {
-    for (size_t i = 0; i < _size; ++i) {
-        delete[] (char*)_blocks[i];
+#if defined(__linux__) || defined(__APPLE__)
+    if (_region) {
+        ::munmap(_region, _size * _slotSize);
     }
+#endif
+    if (_hugeRegion) {
+        HugePages::deallocate(_hugeRegion, _size * _slotSize);
+    }
+    else if (_chunks) {
+        for (index_type i = 0; i < numChunks(); ++i) {
+            delete[] _chunks[i];
+        }
+    }
+    delete[] _chunks;
     delete[] _blocks;
     delete[] _freeBlocks;
 }
 
 template <typename STACK_TRAITS>
 boost::context::stack_context CoroutinePoolAllocator<STACK_TRAITS>::allocate() {
+    boost::context::stack_context ctx = _region ? allocateMapped() : allocateBlock();
+    if (_profileStacks) {
+        paintStack(ctx);
+    }
+    return ctx;
+}
+
+template <typename STACK_TRAITS>
+boost::context::stack_context CoroutinePoolAllocator<STACK_TRAITS>::allocateBlock() {
     boost::context::stack_context ctx;
     Header* block = nullptr;
-    {
-        SpinLock::Guard lock(_spinlock);
-        if (!isEmpty())
-        {
-            block = _blocks[_freeBlocks[_freeBlockIndex--]];
-        }
+    index_type index;
+    if (takeBlock(index)) {
+        block = _blocks[index];
     }
     if (!block) {
         // Use heap allocation
@@ -107,8 +184,10 @@ boost::context::stack_context CoroutinePoolAllocator<STACK_TRAITS>::allocate() {
             throw std::bad_alloc();
         }
         block->_pos = -1; //mark position as non-managed
-        SpinLock::Guard lock(_spinlock);
+        PoolGuard lock(_spinlock, _lockContentionCount);
         ++_numHeapAllocatedBlocks;
+        ++_numHeapFallbacks;
+        updatePeak();
     }
     char* block_start = reinterpret_cast<char*>(block) + sizeof(Header);
     ctx.size = _stackSize - sizeof(Header);
@@ -124,17 +203,21 @@ void CoroutinePoolAllocator<STACK_TRAITS>::deallocate(const boost::context::stac
     if (!ctx.sp) {
         return;
     }
+    if (_profileStacks) {
+        recordStackUsage(ctx);
+    }
 #if defined(BOOST_USE_VALGRIND)
     VALGRIND_STACK_DEREGISTER(ctx.valgrind_stack_id);
 #endif
-    if (isManaged(ctx)) {
-        //find index of the block
-        SpinLock::Guard lock(_spinlock);
-        _freeBlocks[++_freeBlockIndex] = blockIndex(ctx);
+    if (_region) {
+        deallocateMapped(ctx);
+    }
+    else if (isManaged(ctx)) {
+        returnBlock(blockIndex(ctx));
     }
     else {
         delete[] (char*)getHeader(ctx);
-        SpinLock::Guard lock(_spinlock);
+        PoolGuard lock(_spinlock, _lockContentionCount);
         --_numHeapAllocatedBlocks;
         assert(_numHeapAllocatedBlocks >= 0);
     }
@@ -143,7 +226,7 @@ void CoroutinePoolAllocator<STACK_TRAITS>::deallocate(const boost::context::stac
 template <typename STACK_TRAITS>
 size_t CoroutinePoolAllocator<STACK_TRAITS>::allocatedBlocks() const
 {
-    return _size - _freeBlockIndex - 1;
+    return _size - _freeBlockIndex - 1 - _cache.cachedBlocks();
 }
 
 template <typename STACK_TRAITS>
@@ -152,10 +235,40 @@ size_t CoroutinePoolAllocator<STACK_TRAITS>::allocatedHeapBlocks() const
     return _numHeapAllocatedBlocks;
 }
 
+template <typename STACK_TRAITS>
+AllocatorStatistics CoroutinePoolAllocator<STACK_TRAITS>::stats() const
+{
+    AllocatorStatistics stats;
+    size_t cachedBlocks = _cache.cachedBlocks();
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    stats._capacity = _size;
+    stats._allocatedCount = (_size - _freeBlockIndex - 1) + _numHeapAllocatedBlocks - cachedBlocks;
+    stats._peakAllocatedCount = _peakAllocatedBlocks;
+    stats._heapAllocatedCount = _numHeapAllocatedBlocks;
+    stats._heapFallbackCount = _numHeapFallbacks;
+    stats._lockContentionCount = _lockContentionCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+template <typename STACK_TRAITS>
+Histogram CoroutinePoolAllocator<STACK_TRAITS>::stackUsage() const
+{
+    SpinLock::Guard lock(_profileLock);
+    return _stackUsage;
+}
+
+template <typename STACK_TRAITS>
+Histogram CoroutinePoolAllocator<STACK_TRAITS>::stackUsage(const std::string& tag) const
+{
+    SpinLock::Guard lock(_profileLock);
+    auto it = _taggedStackUsage.find(tag);
+    return (it == _taggedStackUsage.end()) ? Histogram() : it->second;
+}
+
 template <typename STACK_TRAITS>
 bool CoroutinePoolAllocator<STACK_TRAITS>::isFull() const
 {
-    return _freeBlockIndex == _size-1;
+    return allocatedBlocks() == 0;
 }
 
 template <typename STACK_TRAITS>
@@ -164,6 +277,42 @@ bool CoroutinePoolAllocator<STACK_TRAITS>::isEmpty() const
     return _freeBlockIndex == -1;
 }
 
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::warmUp(size_type num)
+{
+    if (!_chunks) {
+        return; //all the stacks already exist
+    }
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    for (ssize_t i = _freeBlockIndex; (i >= 0) && (_freeBlockIndex - i < (ssize_t)num); --i) {
+        ensureBlock(_freeBlocks[i]);
+    }
+}
+
+template <typename STACK_TRAITS>
+typename CoroutinePoolAllocator<STACK_TRAITS>::index_type
+CoroutinePoolAllocator<STACK_TRAITS>::numChunks() const
+{
+    return static_cast<index_type>(((size_t)_size + _chunkSize - 1) / _chunkSize);
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::ensureBlock(index_type index)
+{
+    //must be called with the lock held or from the constructor
+    if (!_chunks || _blocks[index]) {
+        return;
+    }
+    index_type chunk = index / _chunkSize;
+    size_t first = (size_t)chunk * _chunkSize;
+    size_t last = std::min(first + _chunkSize, (size_t)_size);
+    _chunks[chunk] = new char[(last - first) * _slotSize];
+    for (size_t i = first; i < last; ++i) {
+        _blocks[i] = reinterpret_cast<Header*>(_chunks[chunk] + (i - first) * _slotSize);
+        _blocks[i]->_pos = static_cast<int>(i); //mark position
+    }
+}
+
 template <typename STACK_TRAITS>
 typename CoroutinePoolAllocator<STACK_TRAITS>::Header*
 CoroutinePoolAllocator<STACK_TRAITS>::getHeader(const boost::context::stack_context& ctx) const
@@ -183,4 +332,185 @@ int CoroutinePoolAllocator<STACK_TRAITS>::blockIndex(const boost::context::stack
     return getHeader(ctx)->_pos;
 }
 
+template <typename STACK_TRAITS>
+bool CoroutinePoolAllocator<STACK_TRAITS>::takeBlock(index_type& index)
+{
+    ThreadCache::Magazine* magazine = _cache.magazine();
+    if (magazine && magazine->pop(index)) {
+        return true;
+    }
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    if (isEmpty()) {
+        return false;
+    }
+    //blocks are materialized before leaving the free list so that a failed allocation does not lose them
+    ensureBlock(_freeBlocks[_freeBlockIndex]);
+    index = _freeBlocks[_freeBlockIndex--];
+    if (magazine) {
+        //refill the thread cache while holding the lock
+        for (size_t i = 1; (i < magazine->batchSize()) && !isEmpty(); ++i) {
+            ensureBlock(_freeBlocks[_freeBlockIndex]);
+            magazine->push(_freeBlocks[_freeBlockIndex--]);
+        }
+    }
+    updatePeak();
+    return true;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::returnBlock(index_type index)
+{
+    ThreadCache::Magazine* magazine = _cache.magazine();
+    if (magazine && magazine->push(index)) {
+        return;
+    }
+    PoolGuard lock(_spinlock, _lockContentionCount);
+    _freeBlocks[++_freeBlockIndex] = index;
+    if (magazine) {
+        //flush half of the thread cache while holding the lock
+        for (size_t i = 1; (i < magazine->batchSize()) && magazine->pop(index); ++i) {
+            _freeBlocks[++_freeBlockIndex] = index;
+        }
+    }
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::updatePeak()
+{
+    //must be called with the lock held
+    size_t allocated = (_size - _freeBlockIndex - 1) + _numHeapAllocatedBlocks;
+    if (allocated > _peakAllocatedBlocks) {
+        _peakAllocatedBlocks = allocated;
+    }
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::paintStack(const boost::context::stack_context& ctx) const
+{
+    //The lowest word of the stack holds the tag and the rest is painted up to the stack pointer
+    char* bottom = static_cast<char*>(ctx.sp) - ctx.size;
+    *reinterpret_cast<const char**>(bottom) = CoroStackTag::current();
+    std::memset(bottom + sizeof(const char*), StackPaintPattern, ctx.size - sizeof(const char*));
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::recordStackUsage(const boost::context::stack_context& ctx)
+{
+    //Stacks grow downwards so the first overwritten byte from the bottom is the deepest one reached
+    const char* bottom = static_cast<const char*>(ctx.sp) - ctx.size;
+    const char* tag = *reinterpret_cast<const char* const*>(bottom);
+    const char* top = static_cast<const char*>(ctx.sp);
+    const char* deepest = bottom + sizeof(const char*);
+    while ((deepest < top) && (*deepest == StackPaintPattern)) {
+        ++deepest;
+    }
+    uint64_t used = top - deepest;
+    SpinLock::Guard lock(_profileLock);
+    _stackUsage.record(used);
+    if (tag) {
+        _taggedStackUsage[tag].record(used);
+    }
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::mapRegion()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    //Each slot holds a guard page followed by the stack, which grows downwards towards it
+    _slotSize = ((_stackSize + _pageSize - 1) / _pageSize) * _pageSize + _pageSize;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+    flags |= MAP_NORESERVE;
+#endif
+    void* region = ::mmap(nullptr, _size * _slotSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (region == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    _region = static_cast<char*>(region);
+    for (index_type i = 0; i < _size; ++i) {
+        guardSlot(_region + i * _slotSize);
+    }
+#endif
+}
+
+template <typename STACK_TRAITS>
+char* CoroutinePoolAllocator<STACK_TRAITS>::mapSlot() const
+{
+#if defined(__linux__) || defined(__APPLE__)
+    void* slot = ::mmap(nullptr, _slotSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (slot == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    guardSlot(static_cast<char*>(slot));
+    return static_cast<char*>(slot);
+#else
+    return nullptr;
+#endif
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::guardSlot(char* slot) const
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (::mprotect(slot, _pageSize, PROT_NONE) != 0) {
+        throw std::runtime_error("Failed to protect coroutine stack guard page");
+    }
+#else
+    (void)slot;
+#endif
+}
+
+template <typename STACK_TRAITS>
+boost::context::stack_context CoroutinePoolAllocator<STACK_TRAITS>::allocateMapped()
+{
+    boost::context::stack_context ctx;
+    char* slot = nullptr;
+    index_type index;
+    if (takeBlock(index)) {
+        slot = _region + index * _slotSize;
+    }
+    if (!slot) {
+        // Map a standalone guarded stack
+        slot = mapSlot();
+        PoolGuard lock(_spinlock, _lockContentionCount);
+        ++_numHeapAllocatedBlocks;
+        ++_numHeapFallbacks;
+        updatePeak();
+    }
+    ctx.size = _slotSize - _pageSize;
+    ctx.sp = slot + _slotSize;
+    #if defined(BOOST_USE_VALGRIND)
+        ctx.valgrind_stack_id = VALGRIND_STACK_REGISTER(ctx.sp, slot + _pageSize);
+    #endif
+    return ctx;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::deallocateMapped(const boost::context::stack_context& ctx)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    char* slot = reinterpret_cast<char*>(ctx.sp) - _slotSize;
+    if ((slot >= _region) && (slot < _region + _size * _slotSize)) {
+        int threshold = AllocatorTraits::coroStackReleaseThreshold();
+        bool release = false;
+        if (threshold >= 0) {
+            PoolGuard lock(_spinlock, _lockContentionCount);
+            release = (_freeBlockIndex + 1) >= threshold;
+        }
+        if (release) {
+            //Give the pages back to the OS. They are committed again (zero-filled) on next use.
+            ::madvise(slot + _pageSize, _slotSize - _pageSize, MADV_DONTNEED);
+        }
+        returnBlock(static_cast<index_type>((slot - _region) / _slotSize));
+    }
+    else {
+        ::munmap(slot, _slotSize);
+        PoolGuard lock(_spinlock, _lockContentionCount);
+        --_numHeapAllocatedBlocks;
+    }
+#else
+    (void)ctx;
+#endif
+}
+
 }}
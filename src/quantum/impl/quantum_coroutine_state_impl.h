@@ -0,0 +1,65 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+bool CoroutineState::isBlocked() const
+{
+    //A timed wait is treated as sleeping since it can resume on its own
+    return (_signal == 0) && (_sleepDuration.count() == 0);
+}
+
+inline
+bool CoroutineState::isSleeping(bool updateTimer)
+{
+    if (_signal == 1) {
+        return false; //signalled while in a timed wait
+    }
+    if (_sleepDuration.count() > 0) {
+        if (!updateTimer) {
+            return true;
+        }
+        auto now = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now-_sleepTimestamp);
+        if (elapsed >= _sleepDuration) {
+            //expired so we reset all values
+            _sleepDuration = std::chrono::microseconds(0);
+            _sleepTimestamp = std::chrono::high_resolution_clock::time_point{};
+        }
+        else {
+            //reduce duration and save new timestamp
+            _sleepDuration -= elapsed;
+            _sleepTimestamp = now;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline
+std::chrono::high_resolution_clock::time_point CoroutineState::getSleepDeadline() const
+{
+    return _sleepTimestamp + _sleepDuration;
+}
+
+}}
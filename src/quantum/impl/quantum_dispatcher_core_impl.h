@@ -18,6 +18,7 @@
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
+#include <cassert>
 
 namespace Bloomberg {
 namespace quantum {
@@ -31,7 +32,20 @@ DispatcherCore::DispatcherCore(int numCoroutineThreads,
     _sharedIoQueues((numIoThreads <= 0) ? 1 : numIoThreads),
     _ioQueues((numIoThreads <= 0) ? 1 : numIoThreads, IoQueue(Configuration(), &_sharedIoQueues)),
     _loadBalanceSharedIoQueues(false),
-    _terminated(ATOMIC_FLAG_INIT)
+    _sharedIoRingFullPolicy(Configuration::RingFullPolicy::Spill),
+    _terminated(ATOMIC_FLAG_INIT),
+    _numPendingCoroTasks(0),
+    _numPendingIoTasks(0),
+    _numActiveCoroQueues(_coroQueues.size()),
+    _placementPolicy(Configuration::PlacementPolicy::LeastLoaded),
+    _affinityVirtualNodes(0),
+    _pinIoThreadsToCores(false),
+    _ioThreadSchedPolicy(Configuration::SchedPolicy::Default),
+    _ioThreadSchedPriority(0),
+    _isElasticIoStopped(false),
+    _maxNumElasticIoThreads(0),
+    _elasticIoSpawnThresholdMs(0),
+    _elasticIoIdleTimeoutMs(0)
 {
     if (pinCoroutineThreadsToCores)
     {
@@ -41,18 +55,61 @@ DispatcherCore::DispatcherCore(int numCoroutineThreads,
             _coroQueues[i].pinToCore(i%cores);
         }
     }
+    setIdleSignal();
 }
 
 inline
 DispatcherCore::DispatcherCore(const Configuration& config) :
-    _coroQueues((config.getNumCoroutineThreads() == -1) ? std::thread::hardware_concurrency() :
-                (config.getNumCoroutineThreads() == 0) ? 1 : config.getNumCoroutineThreads(), TaskQueue(config)),
+    _coroQueues(getNumCoroQueues(config), TaskQueue(config)),
     _sharedIoQueues((config.getNumIoThreads() <= 0) ? 1 : config.getNumIoThreads(), IoQueue(config, nullptr)),
     _ioQueues((config.getNumIoThreads() <= 0) ? 1 : config.getNumIoThreads(), IoQueue(config, &_sharedIoQueues)),
-    _loadBalanceSharedIoQueues(false),
-    _terminated(ATOMIC_FLAG_INIT)
+    _loadBalanceSharedIoQueues(config.getLoadBalanceSharedIoQueues()),
+    _sharedIoRingFullPolicy(config.getSharedIoRingFullPolicy()),
+    _terminated(ATOMIC_FLAG_INIT),
+    _numPendingCoroTasks(0),
+    _numPendingIoTasks(0),
+    _numActiveCoroQueues(getNumActiveCoroQueues(config)),
+    _placementPolicy(config.getCoroutinePlacementPolicy()),
+    _affinityVirtualNodes(std::max(config.getAffinityVirtualNodes(), 0)),
+    _ioThreadCpus(NumaTopology::parseCpuList(config.getIoThreadCpus())),
+    _pinIoThreadsToCores(config.getPinIoThreadsToCores()),
+    _ioThreadSchedPolicy(config.getIoThreadSchedPolicy()),
+    _ioThreadSchedPriority(config.getIoThreadSchedPriority()),
+    _isElasticIoStopped(false),
+    _maxNumElasticIoThreads(config.getLoadBalanceSharedIoQueues() ? 0 : std::max(config.getMaxNumElasticIoThreads(), 0)),
+    _elasticIoSpawnThresholdMs(std::max(config.getElasticIoSpawnThresholdMs(), std::chrono::milliseconds(1))),
+    _elasticIoIdleTimeoutMs(config.getElasticIoIdleTimeoutMs())
 {
-    if (config.getPinCoroutineThreadsToCores())
+    buildAffinityRing(_numActiveCoroQueues);
+    setIdleSignal();
+    setPendingTaskCounters(config);
+    for (size_t i = 0; i < _coroQueues.size(); ++i)
+    {
+        _coroQueues[i].setQueueId(static_cast<int>(i));
+        _coroQueues[i].setRetired(i >= _numActiveCoroQueues);
+    }
+    if (config.getCoroutineWorkStealing() ||
+        (config.getParkBlockedCoroutines() && (config.getCoroutineMigrationThreshold() > 0)))
+    {
+        //Queues can only look at each other once they are all constructed
+        for (auto&& queue : _coroQueues)
+        {
+            queue.setSiblingQueues(&_coroQueues);
+        }
+    }
+    if (config.getThreadPlacement() != Configuration::ThreadPlacement::Default)
+    {
+        const NumaTopology& topology = NumaTopology::instance();
+        for (size_t i = 0; i < _coroQueues.size(); ++i)
+        {
+            _coroQueues[i].pinToCpus(topology.getCoroutineThreadCpus(config.getThreadPlacement(), i));
+        }
+        for (size_t i = 0; i < _ioQueues.size(); ++i)
+        {
+            _ioQueues[i].pinToCpus(topology.getIoThreadCpus(config.getThreadPlacement(), i));
+        }
+    }
+    else if (config.getPinCoroutineThreadsToCores())
     {
         unsigned int cores = std::thread::hardware_concurrency();
         for (size_t i = 0; i < _coroQueues.size(); ++i)
@@ -60,6 +117,21 @@ DispatcherCore::DispatcherCore(const Configuration& config) :
             _coroQueues[i].pinToCore(i%cores);
         }
     }
+    if (_pinIoThreadsToCores && _ioThreadCpus.empty())
+    {
+        for (int cpu = 0; cpu < (int)std::thread::hardware_concurrency(); ++cpu)
+        {
+            _ioThreadCpus.push_back(cpu);
+        }
+    }
+    for (size_t i = 0; i < _ioQueues.size(); ++i)
+    {
+        placeIoThread(_ioQueues[i], i);
+    }
+    if (_maxNumElasticIoThreads > 0)
+    {
+        _elasticIoThread = std::thread(std::bind(&DispatcherCore::manageElasticIoThreads, this));
+    }
 }
 
 inline
@@ -73,6 +145,21 @@ void DispatcherCore::terminate()
 {
     if (!_terminated.test_and_set())
     {
+        //Stop delayed and periodic posts first
+        std::call_once(_timerServiceOnce, []{});
+        if (_timerService)
+        {
+            _timerService->terminate();
+        }
+#if defined(__linux__)
+        //Complete all pending descriptor waits before the coroutine queues go away
+        std::call_once(_reactorOnce, []{});
+        if (_reactor)
+        {
+            _reactor->terminate();
+        }
+#endif
+        stopElasticIoThreads();
         for (auto&& queue : _coroQueues)
         {
             queue.terminate();
@@ -81,6 +168,10 @@ void DispatcherCore::terminate()
         {
             queue.terminate();
         }
+        for (auto&& queue : _elasticIoQueues)
+        {
+            queue->terminate();
+        }
         for (auto&& queue : _sharedIoQueues)
         {
             queue.terminate();
@@ -126,6 +217,35 @@ bool DispatcherCore::empty(IQueue::QueueType type,
     return ioEmpty(queueId);
 }
 
+inline
+size_t DispatcherCore::numPendingTasks(IQueue::QueueType type) const
+{
+    if (type == IQueue::QueueType::Coro)
+    {
+        return _numPendingCoroTasks.load(std::memory_order_relaxed);
+    }
+    if (type == IQueue::QueueType::IO)
+    {
+        return _numPendingIoTasks.load(std::memory_order_relaxed);
+    }
+    return _numPendingCoroTasks.load(std::memory_order_relaxed) + _numPendingIoTasks.load(std::memory_order_relaxed);
+}
+
+inline
+std::chrono::microseconds DispatcherCore::oldestRunnableWaitTime(int queueId) const
+{
+    if (queueId == (int)IQueue::QueueId::All)
+    {
+        std::chrono::microseconds oldest(0);
+        for (auto&& queue : _coroQueues)
+        {
+            oldest = std::max(oldest, queue.oldestRunnableWaitTime());
+        }
+        return oldest;
+    }
+    return _coroQueues.at(queueId).oldestRunnableWaitTime();
+}
+
 inline
 size_t DispatcherCore::coroSize(int queueId) const
 {
@@ -169,7 +289,7 @@ size_t DispatcherCore::ioSize(int queueId) const
         {
             size += queue.size();
         }
-        return size;
+        return size + elasticIoSize();
     }
     else if (queueId == (int)IQueue::QueueId::Any)
     {
@@ -178,7 +298,7 @@ size_t DispatcherCore::ioSize(int queueId) const
         {
             size += queue.size();
         }
-        return size;
+        return size + elasticIoSize();
     }
     return _ioQueues.at(queueId).size();
 }
@@ -202,7 +322,7 @@ bool DispatcherCore::ioEmpty(int queueId) const
                 return false;
             }
         }
-        return true;
+        return elasticIoSize() == 0;
     }
     else if (queueId == (int)IQueue::QueueId::Any)
     {
@@ -213,7 +333,7 @@ bool DispatcherCore::ioEmpty(int queueId) const
                 return false;
             }
         }
-        return true;
+        return elasticIoSize() == 0;
     }
     return _ioQueues.at(queueId).empty();
 }
@@ -272,6 +392,13 @@ QueueStatistics DispatcherCore::ioStats(int queueId)
         {
             stats += queue.stats();
         }
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        for (auto&& queue : _elasticIoQueues)
+        {
+            stats += queue->stats();
+        }
+        stats += _retiredElasticIoStats;
         return stats;
     }
     else if (queueId == (int)IQueue::QueueId::Any)
@@ -310,6 +437,17 @@ void DispatcherCore::resetStats()
     }
 }
 
+inline
+std::vector<TaskInfo> DispatcherCore::snapshotTasks() const
+{
+    std::vector<TaskInfo> tasks;
+    for (auto&& queue : _coroQueues)
+    {
+        queue.snapshotTasks(tasks);
+    }
+    return tasks;
+}
+
 inline
 void DispatcherCore::post(Task::Ptr task)
 {
@@ -320,25 +458,7 @@ void DispatcherCore::post(Task::Ptr task)
     
     if (task->getQueueId() == (int)IQueue::QueueId::Any)
     {
-        size_t index = 0;
-        
-        //Insert into the shortest queue or the first empty queue found
-        size_t numTasks = std::numeric_limits<size_t>::max();
-        for (size_t i = 0; i < _coroQueues.size(); ++i)
-        {
-            size_t queueSize = _coroQueues[i].size();
-            if (queueSize < numTasks)
-            {
-                numTasks = queueSize;
-                index = i;
-            }
-            if (numTasks == 0)
-            {
-                break; //reached an empty queue
-            }
-        }
-        
-        task->setQueueId(index); //overwrite the queueId with the selected one
+        task->setQueueId(selectCoroQueue()); //overwrite the queueId with the selected one
     }
     else
     {
@@ -352,6 +472,51 @@ void DispatcherCore::post(Task::Ptr task)
     
 }
 
+inline
+void DispatcherCore::postBatch(std::vector<Task::Ptr>& tasks)
+{
+    //Split the batch per destination queue so that each queue is only locked and signalled once
+    std::vector<std::vector<Task::Ptr>> batches(_coroQueues.size());
+    std::vector<size_t> queueSizes;
+    for (auto&& task : tasks)
+    {
+        if ((task->getQueueId() == (int)IQueue::QueueId::Any) &&
+            (_placementPolicy != Configuration::PlacementPolicy::LeastLoaded))
+        {
+            task->setQueueId(selectCoroQueue());
+        }
+        else if (task->getQueueId() == (int)IQueue::QueueId::Any)
+        {
+            if (queueSizes.empty())
+            {
+                size_t numQueues = _numActiveCoroQueues;
+                queueSizes.reserve(numQueues);
+                for (size_t i = 0; i < numQueues; ++i)
+                {
+                    queueSizes.push_back(_coroQueues[i].size());
+                }
+            }
+            //Insert into the shortest queue, counting the tasks already assigned from this batch
+            size_t index = std::distance(queueSizes.begin(), std::min_element(queueSizes.begin(), queueSizes.end()));
+            ++queueSizes[index];
+            task->setQueueId(index); //overwrite the queueId with the selected one
+        }
+        else if (task->getQueueId() >= (int)_coroQueues.size())
+        {
+            throw std::runtime_error("Queue id out of bounds");
+        }
+        batches[task->getQueueId()].emplace_back(task);
+    }
+    
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        if (!batches[i].empty())
+        {
+            _coroQueues[i].enqueue(batches[i]);
+        }
+    }
+}
+
 inline
 void DispatcherCore::postAsyncIo(IoTask::Ptr task)
 {
@@ -364,24 +529,34 @@ void DispatcherCore::postAsyncIo(IoTask::Ptr task)
     {
         if (_loadBalanceSharedIoQueues)
         {
-            static size_t index = 0;
+            static thread_local size_t index = 0;
+            size_t numQueues = _sharedIoQueues.size();
             //loop until we can find an queue that won't block
             while (1) {
-                if (_sharedIoQueues.at(++index % _sharedIoQueues.size()).tryEnqueue(task)) {
-                    break;
+                for (size_t i = 0; i < numQueues; ++i) {
+                    if (_sharedIoQueues[++index % numQueues].tryEnqueue(task)) {
+                        _sharedIoQueues[0].wakeIdleWorker();
+                        return;
+                    }
+                }
+                if (_sharedIoQueues[0].hasRing()) {
+                    //All the rings are full
+                    if (_sharedIoRingFullPolicy == Configuration::RingFullPolicy::Spill) {
+                        _sharedIoQueues[index % numQueues].enqueue(task);
+                        _sharedIoQueues[0].wakeIdleWorker();
+                        return;
+                    }
+                    if (_sharedIoRingFullPolicy == Configuration::RingFullPolicy::Fail) {
+                        throw std::runtime_error("Shared IO queue is full");
+                    }
+                    std::this_thread::yield();
                 }
             }
         }
         else
         {
-            //insert the task into the shared queue
-            _sharedIoQueues[0].enqueue(task);
-        
-            //Signal all threads there is work to do
-            for (auto&& queue : _ioQueues)
-            {
-                queue.signalEmptyCondition(false);
-            }
+            //insert the task into the shared queue and wake up a single idle thread
+            _sharedIoQueues[0].enqueueShared(task);
         }
     }
     else
@@ -396,16 +571,472 @@ void DispatcherCore::postAsyncIo(IoTask::Ptr task)
     }
 }
 
+inline
+void DispatcherCore::postAsyncIoBatch(std::vector<IoTask::Ptr>& tasks)
+{
+    //Split the batch per destination queue so that each queue is only locked and signalled once
+    std::vector<std::vector<ITask::Ptr>> batches(_ioQueues.size());
+    std::vector<ITask::Ptr> sharedBatch;
+    for (auto&& task : tasks)
+    {
+        if (!task)
+        {
+            continue;
+        }
+        if (task->getQueueId() == (int)IQueue::QueueId::Any)
+        {
+            sharedBatch.emplace_back(task);
+        }
+        else if (task->getQueueId() >= (int)_ioQueues.size())
+        {
+            throw std::runtime_error("Queue id out of bounds");
+        }
+        else
+        {
+            batches[task->getQueueId()].emplace_back(task);
+        }
+    }
+    if (_loadBalanceSharedIoQueues)
+    {
+        //Tasks are spread over all the shared queues
+        for (auto&& task : sharedBatch)
+        {
+            postAsyncIo(std::static_pointer_cast<IoTask>(task));
+        }
+    }
+    else if (!sharedBatch.empty())
+    {
+        _sharedIoQueues[0].enqueueSharedBatch(sharedBatch);
+    }
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        _ioQueues[i].enqueueBatch(batches[i]);
+    }
+}
+
+inline
+void DispatcherCore::wakeUp(ITask::Ptr task)
+{
+    //A coroutine can only wait once it runs, at which point its queue id designates its queue
+    int queueId = task->getQueueId();
+    assert((queueId >= 0) && (queueId < (int)_coroQueues.size()));
+    _coroQueues[queueId].wakeUp(std::static_pointer_cast<Task>(task));
+}
+
 inline
 int DispatcherCore::getNumCoroutineThreads() const
 {
     return _coroQueues.size();
 }
 
+inline
+int DispatcherCore::getNumActiveCoroutineThreads() const
+{
+    return _numActiveCoroQueues;
+}
+
+inline
+void DispatcherCore::setNumActiveCoroutineThreads(int num)
+{
+    if ((num < 1) || (num > (int)_coroQueues.size()))
+    {
+        throw std::runtime_error("Invalid number of coroutine threads");
+    }
+    std::lock_guard<std::mutex> lock(_resizeMutex);
+    size_t numActive = _numActiveCoroQueues;
+    for (size_t i = 0; i < _coroQueues.size(); ++i)
+    {
+        _coroQueues[i].setRetired(i >= (size_t)num);
+    }
+    _numActiveCoroQueues = num;
+    buildAffinityRing(num);
+    
+    //Move the coroutines which have not started yet from the retiring queues to the survivors.
+    //Running and pinned coroutines complete on their current thread.
+    std::vector<Task::Ptr> migrated;
+    for (size_t i = num; i < numActive; ++i)
+    {
+        _coroQueues[i].migrate(migrated);
+    }
+    for (auto&& task : migrated)
+    {
+        task->setQueueId((int)IQueue::QueueId::Any);
+    }
+    postBatch(migrated);
+}
+
+inline
+int DispatcherCore::getAffinityQueueId(const AffinityKey& key) const
+{
+    if (_affinityVirtualNodes == 0)
+    {
+        return static_cast<int>(key.hash() % _coroQueues.size());
+    }
+    std::shared_ptr<const AffinityRing> ring = std::atomic_load(&_affinityRing);
+    //The key belongs to the first virtual node at or after its position on the ring
+    auto it = std::lower_bound(ring->begin(), ring->end(), std::make_pair(key.hash(), (size_t)0));
+    if (it == ring->end())
+    {
+        it = ring->begin(); //wrap around
+    }
+    return static_cast<int>(it->second);
+}
+
+inline
+void DispatcherCore::buildAffinityRing(size_t numQueues)
+{
+    if (_affinityVirtualNodes == 0)
+    {
+        return;
+    }
+    auto ring = std::make_shared<AffinityRing>();
+    ring->reserve(numQueues * _affinityVirtualNodes);
+    for (size_t queue = 0; queue < numQueues; ++queue)
+    {
+        for (int node = 0; node < _affinityVirtualNodes; ++node)
+        {
+            //The position of a virtual node only depends on its queue so it never moves
+            ring->emplace_back(AffinityKey::mix((static_cast<uint64_t>(queue) << 32) | static_cast<uint64_t>(node)), queue);
+        }
+    }
+    std::sort(ring->begin(), ring->end());
+    std::atomic_store(&_affinityRing, std::shared_ptr<const AffinityRing>(std::move(ring)));
+}
+
+inline
+size_t DispatcherCore::selectCoroQueue() const
+{
+    size_t numQueues = _numActiveCoroQueues;
+    switch (_placementPolicy)
+    {
+        case Configuration::PlacementPolicy::RoundRobin:
+        {
+            //Each producer thread cycles on its own so they don't contend on a shared cursor
+            static thread_local size_t cursor = randomCoroQueue(numQueues);
+            return cursor++ % numQueues;
+        }
+        case Configuration::PlacementPolicy::CurrentQueue:
+        {
+            const TaskQueue* current = TaskQueue::getCurrentQueue();
+            if (current && (current >= _coroQueues.data()) && (current < _coroQueues.data() + numQueues))
+            {
+                return current - _coroQueues.data();
+            }
+        }
+        //fallthrough
+        case Configuration::PlacementPolicy::PowerOfTwoChoices:
+        {
+            size_t first = randomCoroQueue(numQueues);
+            size_t second = randomCoroQueue(numQueues);
+            return (_coroQueues[second].size() < _coroQueues[first].size()) ? second : first;
+        }
+        case Configuration::PlacementPolicy::LeastLoaded:
+        default:
+        {
+            //Insert into the shortest queue or the first empty queue found
+            size_t index = 0;
+            size_t numTasks = std::numeric_limits<size_t>::max();
+            for (size_t i = 0; i < numQueues; ++i)
+            {
+                size_t queueSize = _coroQueues[i].size();
+                if (queueSize < numTasks)
+                {
+                    numTasks = queueSize;
+                    index = i;
+                }
+                if (numTasks == 0)
+                {
+                    break; //reached an empty queue
+                }
+            }
+            return index;
+        }
+    }
+}
+
+inline
+size_t DispatcherCore::randomCoroQueue(size_t numQueues) const
+{
+    //xorshift generator seeded differently on each thread
+    static thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<size_t>(state % numQueues);
+}
+
+inline
+size_t DispatcherCore::getNumActiveCoroQueues(const Configuration& config)
+{
+    return (config.getNumCoroutineThreads() == -1) ? std::thread::hardware_concurrency() :
+           (config.getNumCoroutineThreads() == 0) ? 1 : config.getNumCoroutineThreads();
+}
+
+inline
+size_t DispatcherCore::getNumCoroQueues(const Configuration& config)
+{
+    return std::max(getNumActiveCoroQueues(config), (size_t)std::max(config.getMaxNumCoroutineThreads(), 0));
+}
+
 inline
 int DispatcherCore::getNumIoThreads() const
 {
     return _ioQueues.size();
 }
 
+inline
+void DispatcherCore::postAsyncIoGroup(const std::string& group, IoTask::Ptr task)
+{
+    if (!task)
+    {
+        return;
+    }
+    IoGroup::Ptr ioGroup = getIoGroup(group);
+    ioGroup->enqueue(std::move(task));
+    pumpIoGroup(ioGroup);
+}
+
+inline
+void DispatcherCore::setIoGroupLimits(const std::string& group,
+                                      size_t maxInFlight,
+                                      double ratePerSecond,
+                                      size_t burst)
+{
+    IoGroup::Ptr ioGroup;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_ioGroupMutex);
+        IoGroup::Ptr& entry = _ioGroups[group];
+        if (!entry)
+        {
+            entry = std::make_shared<IoGroup>(maxInFlight, ratePerSecond, burst);
+            return;
+        }
+        ioGroup = entry;
+    }
+    ioGroup->setLimits(maxInFlight, ratePerSecond, burst);
+    pumpIoGroup(ioGroup); //raising a limit may release waiting tasks
+}
+
+inline
+IoGroupStatistics DispatcherCore::ioGroupStats(const std::string& group) const
+{
+    return getIoGroup(group)->stats();
+}
+
+inline
+IoGroup::Ptr DispatcherCore::getIoGroup(const std::string& group) const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_ioGroupMutex);
+    auto it = _ioGroups.find(group);
+    if (it == _ioGroups.end())
+    {
+        throw std::runtime_error("Unknown IO group");
+    }
+    return it->second;
+}
+
+inline
+void DispatcherCore::pumpIoGroup(const IoGroup::Ptr& group)
+{
+    std::chrono::microseconds retryAfter;
+    std::vector<IoTask::Ptr> tasks = group->acquire(retryAfter);
+    for (auto&& task : tasks)
+    {
+        //Each completion frees a slot for the next waiting task. The slot is released as soon as the
+        //promise of the task is satisfied, before its waiters can observe it, or after the task has run.
+        auto isReleased = std::make_shared<std::atomic_bool>(false);
+        task->setCompletionHandler([this, group, isReleased]{
+            if (!isReleased->exchange(true))
+            {
+                group->release();
+                pumpIoGroup(group);
+            }
+        });
+        try
+        {
+            postAsyncIo(task);
+        }
+        catch (...)
+        {
+            if (!isReleased->exchange(true))
+            {
+                group->release();
+            }
+            throw;
+        }
+    }
+    if (retryAfter.count() > 0)
+    {
+        getTimerService().schedule(retryAfter, std::chrono::microseconds::zero(), [this, group]{
+            group->retry();
+            pumpIoGroup(group);
+        });
+    }
+}
+
+inline
+bool DispatcherCore::waitUntilEmpty(std::chrono::milliseconds timeout)
+{
+    return _idleSignal.waitFor(timeout, [this]()->bool {
+        return empty(IQueue::QueueType::All, (int)IQueue::QueueId::All);
+    });
+}
+
+inline
+void DispatcherCore::setIdleSignal()
+{
+    //Elastic IO queues are copies of the first IO queue and inherit its signal
+    for (auto&& queue : _coroQueues)
+    {
+        queue.setIdleSignal(&_idleSignal);
+    }
+    for (auto&& queue : _sharedIoQueues)
+    {
+        queue.setIdleSignal(&_idleSignal);
+    }
+    for (auto&& queue : _ioQueues)
+    {
+        queue.setIdleSignal(&_idleSignal);
+    }
+}
+
+inline
+void DispatcherCore::setPendingTaskCounters(const Configuration& config)
+{
+    //Queues only pay for the shared counter when Dispatcher checks it on post
+    if (config.getMaxPendingCoroTasks() > 0)
+    {
+        for (auto&& queue : _coroQueues)
+        {
+            queue.setPendingTaskCounter(&_numPendingCoroTasks);
+        }
+    }
+    if (config.getMaxPendingIoTasks() > 0)
+    {
+        //Elastic IO queues are copies of the first IO queue and inherit its counter
+        for (auto&& queue : _sharedIoQueues)
+        {
+            queue.setPendingTaskCounter(&_numPendingIoTasks);
+        }
+        for (auto&& queue : _ioQueues)
+        {
+            queue.setPendingTaskCounter(&_numPendingIoTasks);
+        }
+    }
+}
+
+inline
+void DispatcherCore::placeIoThread(IoQueue& queue, size_t index)
+{
+    if (!_ioThreadCpus.empty())
+    {
+        if (_pinIoThreadsToCores)
+        {
+            queue.pinToCore(_ioThreadCpus[index % _ioThreadCpus.size()]);
+        }
+        else
+        {
+            queue.pinToCpus(_ioThreadCpus);
+        }
+    }
+    queue.setSchedPolicy(_ioThreadSchedPolicy, _ioThreadSchedPriority);
+}
+
+inline
+TimerService& DispatcherCore::getTimerService()
+{
+    std::call_once(_timerServiceOnce, [this]{ _timerService.reset(new TimerService()); });
+    if (!_timerService)
+    {
+        throw std::runtime_error("Timer service terminated");
+    }
+    return *_timerService;
+}
+
+#if defined(__linux__)
+inline
+Reactor& DispatcherCore::getReactor()
+{
+    std::call_once(_reactorOnce, [this]{ _reactor.reset(new Reactor()); });
+    if (!_reactor)
+    {
+        throw std::runtime_error("Reactor terminated");
+    }
+    return *_reactor;
+}
+#endif
+
+inline
+int DispatcherCore::getNumElasticIoThreads() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_elasticIoMutex);
+    return _elasticIoQueues.size();
+}
+
+inline
+size_t DispatcherCore::elasticIoSize() const
+{
+    //Elastic threads have no queue of their own, so this is the number of shared tasks they are running
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_elasticIoMutex);
+    size_t size = 0;
+    for (auto&& queue : _elasticIoQueues)
+    {
+        size += queue->size();
+    }
+    return size;
+}
+
+inline
+void DispatcherCore::manageElasticIoThreads()
+{
+    IoQueue& sharedQueue = _sharedIoQueues[0];
+    std::unique_lock<std::mutex> lock(_elasticIoMutex);
+    while (!_elasticIoCond.wait_for(lock, _elasticIoSpawnThresholdMs, [this]()->bool{ return _isElasticIoStopped; }))
+    {
+        //Stop the threads which have been idle for too long
+        for (auto it = _elasticIoQueues.begin(); it != _elasticIoQueues.end();)
+        {
+            if ((*it)->retireIfIdle(_elasticIoIdleTimeoutMs))
+            {
+                (*it)->terminate();
+                _retiredElasticIoStats += (*it)->stats();
+                it = _elasticIoQueues.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        //Add a thread if all of them are busy and tasks are backing up
+        if ((_elasticIoQueues.size() < _maxNumElasticIoThreads) &&
+            !sharedQueue.hasIdleWorkers() &&
+            (sharedQueue.oldestTaskWaitTime() >= _elasticIoSpawnThresholdMs))
+        {
+            //The new thread starts in the idle list so it can be woken up right away
+            _elasticIoQueues.emplace_back(new IoQueue(_ioQueues.front()));
+            placeIoThread(*_elasticIoQueues.back(), _ioQueues.size() + _elasticIoQueues.size() - 1);
+            sharedQueue.wakeIdleWorker();
+        }
+    }
+}
+
+inline
+void DispatcherCore::stopElasticIoThreads()
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        _isElasticIoStopped = true;
+    }
+    _elasticIoCond.notify_all();
+    if (_elasticIoThread.joinable())
+    {
+        _elasticIoThread.join();
+    }
+}
+
 }}
@@ -30,15 +30,27 @@ Dispatcher::Dispatcher(int numCoroutineThreads,
                        bool pinCoroutineThreadsToCores) :
     _dispatcher(numCoroutineThreads, numIoThreads, pinCoroutineThreadsToCores),
     _drain(false),
-    _terminated(ATOMIC_FLAG_INIT)
+    _terminated(ATOMIC_FLAG_INIT),
+    _maxPendingCoroTasks(0),
+    _maxPendingIoTasks(0)
 {}
 
 inline
 Dispatcher::Dispatcher(const Configuration& config) :
     _dispatcher(config),
     _drain(false),
-    _terminated(ATOMIC_FLAG_INIT)
-{}
+    _terminated(ATOMIC_FLAG_INIT),
+    _maxPendingCoroTasks(config.getMaxPendingCoroTasks()),
+    _maxPendingIoTasks(config.getMaxPendingIoTasks()),
+    _overloadCallback(config.getOverloadCallback())
+{
+    if (config.getMetricsSink())
+    {
+        _metricsExporter.reset(new MetricsExporter(config.getMetricsSink(),
+                                                   config.getMetricsExportPeriodMs(),
+                                                   [this](MetricsSnapshot& metrics){ collectMetrics(metrics); }));
+    }
+}
 
 inline
 Dispatcher::~Dispatcher()
@@ -52,7 +64,7 @@ ThreadContextPtr<RET>
 Dispatcher::post(FUNC&& func,
                  ARGS&&... args)
 {
-    return postImpl<RET>((int)IQueue::QueueId::Any, false, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>((int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -62,7 +74,132 @@ Dispatcher::post(int queueId,
                  FUNC&& func,
                  ARGS&&... args)
 {
-    return postImpl<RET>(queueId, isHighPriority, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(int queueId,
+                 int priority,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(queueId, priority, ITask::Type::Standalone, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(AffinityKey key,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(_dispatcher.getAffinityQueueId(key), (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postWithDeadline(TimePoint deadline,
+                             FUNC&& func,
+                             ARGS&&... args)
+{
+    return postImpl<RET>((int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, ITask::Type::Standalone, deadline, 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postWithDeadline(int queueId,
+                             bool isHighPriority,
+                             TimePoint deadline,
+                             FUNC&& func,
+                             ARGS&&... args)
+{
+    return postImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::Standalone, deadline, 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postWithToken(CancellationToken::Ptr token,
+                          FUNC&& func,
+                          ARGS&&... args)
+{
+    return postImpl<RET>((int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), 0, std::move(token), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postWithToken(int queueId,
+                          bool isHighPriority,
+                          CancellationToken::Ptr token,
+                          FUNC&& func,
+                          ARGS&&... args)
+{
+    return postImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), 0, std::move(token), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAfter(std::chrono::milliseconds delay,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postAfterImpl<RET>(delay, (int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAfter(std::chrono::milliseconds delay,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postAfterImpl<RET>(delay, queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+uint64_t
+Dispatcher::postEvery(std::chrono::milliseconds period,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postEveryImpl<RET>(period, (int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+uint64_t
+Dispatcher::postEvery(std::chrono::milliseconds period,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postEveryImpl<RET>(period, queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+inline
+bool Dispatcher::cancelTimer(uint64_t timerId)
+{
+    return _dispatcher.getTimerService().cancel(timerId);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postWithStackSize(size_t stackSize,
+                              FUNC&& func,
+                              ARGS&&... args)
+{
+    return postImpl<RET>((int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postWithStackSize(int queueId,
+                              bool isHighPriority,
+                              size_t stackSize,
+                              FUNC&& func,
+                              ARGS&&... args)
+{
+    return postImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::Standalone, TimePoint::max(), stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -70,7 +207,7 @@ ThreadContextPtr<RET>
 Dispatcher::postFirst(FUNC&& func,
                       ARGS&&... args)
 {
-    return postImpl<RET>((int)IQueue::QueueId::Any, false, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>((int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, ITask::Type::First, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -80,7 +217,78 @@ Dispatcher::postFirst(int queueId,
                       FUNC&& func,
                       ARGS&&... args)
 {
-    return postImpl<RET>(queueId, isHighPriority, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::First, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(int queueId,
+                      int priority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(queueId, priority, ITask::Type::First, TimePoint::max(), 0, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirstWithStackSize(size_t stackSize,
+                                   FUNC&& func,
+                                   ARGS&&... args)
+{
+    return postImpl<RET>((int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, ITask::Type::First, TimePoint::max(), stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirstWithStackSize(int queueId,
+                                   bool isHighPriority,
+                                   size_t stackSize,
+                                   FUNC&& func,
+                                   ARGS&&... args)
+{
+    return postImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, ITask::Type::First, TimePoint::max(), stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class INPUT_IT, class>
+std::vector<ThreadContextPtr<RET>>
+Dispatcher::postBatch(INPUT_IT first,
+                      INPUT_IT last)
+{
+    return postBatch<RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET, class INPUT_IT, class>
+std::vector<ThreadContextPtr<RET>>
+Dispatcher::postBatch(int queueId,
+                      bool isHighPriority,
+                      INPUT_IT first,
+                      INPUT_IT last)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    std::vector<ThreadContextPtr<RET>> contexts;
+    std::vector<Task::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto ctx = Context<RET>::create(_dispatcher);
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal,
+                                 ITask::Type::Standalone,
+                                 *first);
+        ctx->setTask(task);
+        tasks.emplace_back(std::move(task));
+        contexts.emplace_back(std::static_pointer_cast<IThreadContext<RET>>(ctx));
+    }
+    _dispatcher.postBatch(tasks);
+    return contexts;
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -98,28 +306,136 @@ Dispatcher::postAsyncIo(int queueId,
                         FUNC&& func,
                         ARGS&&... args)
 {
-    return postAsyncIoImpl<RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postAsyncIoImpl<RET>(queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIo(int queueId,
+                        int priority,
+                        FUNC&& func,
+                        ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIoWithToken(CancellationToken::Ptr token,
+                                 FUNC&& func,
+                                 ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(nullptr, std::move(token), (int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIoWithToken(int queueId,
+                                 bool isHighPriority,
+                                 CancellationToken::Ptr token,
+                                 FUNC&& func,
+                                 ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(nullptr, std::move(token), queueId, isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class INPUT_IT, class>
+std::vector<ThreadFuturePtr<RET>>
+Dispatcher::postAsyncIoBatch(INPUT_IT first,
+                             INPUT_IT last)
+{
+    return postAsyncIoBatch<RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET, class INPUT_IT, class>
+std::vector<ThreadFuturePtr<RET>>
+Dispatcher::postAsyncIoBatch(int queueId,
+                             bool isHighPriority,
+                             INPUT_IT first,
+                             INPUT_IT last)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    std::vector<ThreadFuturePtr<RET>> futures;
+    if (isOverloaded(true))
+    {
+        //The whole batch is rejected
+        for (; first != last; ++first)
+        {
+            auto promise = Promise<RET>::create();
+            promise->setException(std::make_exception_ptr(OverloadException()));
+            futures.emplace_back(promise->getIThreadFuture());
+        }
+        return futures;
+    }
+    std::vector<IoTask::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto promise = Promise<RET>::create();
+        tasks.emplace_back(new IoTask(promise,
+                                      queueId,
+                                      isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal,
+                                      *first),
+                           IoTask::deleter);
+        futures.emplace_back(promise->getIThreadFuture());
+    }
+    _dispatcher.postAsyncIoBatch(tasks);
+    return futures;
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIoGroup(const std::string& group,
+                             FUNC&& func,
+                             ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(&group, nullptr, (int)IQueue::QueueId::Any, (int)IQueue::Priority::Normal, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+inline
+void Dispatcher::setIoGroupLimits(const std::string& group,
+                                  size_t maxInFlight,
+                                  double ratePerSecond,
+                                  size_t burst)
+{
+    _dispatcher.setIoGroupLimits(group, maxInFlight, ratePerSecond, burst);
+}
+
+inline
+IoGroupStatistics Dispatcher::ioGroupStats(const std::string& group) const
+{
+    return _dispatcher.ioGroupStats(group);
 }
 
 template <class RET, class INPUT_IT, class>
 ThreadContextPtr<std::vector<RET>>
 Dispatcher::forEach(INPUT_IT first,
                     INPUT_IT last,
-                    Functions::ForEachFunc<RET, INPUT_IT> func)
+                    Functions::ForEachFunc<RET, INPUT_IT> func,
+                    CancellationToken::Ptr token)
 {
-    return forEach<RET>(first, std::distance(first, last), std::move(func));
+    return forEach<RET>(first, std::distance(first, last), std::move(func), std::move(token));
 }
 
 template <class RET, class INPUT_IT>
 ThreadContextPtr<std::vector<RET>>
 Dispatcher::forEach(INPUT_IT first,
                     size_t num,
-                    Functions::ForEachFunc<RET, INPUT_IT> func)
+                    Functions::ForEachFunc<RET, INPUT_IT> func,
+                    CancellationToken::Ptr token)
 {
-    return post<std::vector<RET>>(Util::forEachCoro<RET, INPUT_IT>,
-                                  INPUT_IT{first},
-                                  size_t{num},
-                                  Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)});
+    //The invocations are posted from within this coroutine so they inherit the token
+    return postWithToken<std::vector<RET>>(std::move(token),
+                                           Util::forEachCoro<RET, INPUT_IT>,
+                                           INPUT_IT{first},
+                                           size_t{num},
+                                           Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)});
 }
 
 template <class RET, class INPUT_IT, class>
@@ -144,6 +460,46 @@ Dispatcher::forEachBatch(INPUT_IT first,
                                                getNumCoroutineThreads());
 }
 
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::forEachChunked(INPUT_IT first,
+                           INPUT_IT last,
+                           Functions::ForEachFunc<RET, INPUT_IT> func,
+                           size_t grainSize)
+{
+    return forEachChunked<RET>(first, std::distance(first, last), std::move(func), grainSize);
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::forEachChunked(INPUT_IT first,
+                           size_t num,
+                           Functions::ForEachFunc<RET, INPUT_IT> func,
+                           size_t grainSize)
+{
+    return post<std::vector<RET>>(Util::forEachChunkedCoro<RET, INPUT_IT>,
+                                  INPUT_IT{first},
+                                  size_t{num},
+                                  Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                                  size_t{grainSize},
+                                  getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatchSplit(INPUT_IT first,
+                              INPUT_IT last,
+                              Functions::ForEachFunc<RET, INPUT_IT> func,
+                              size_t grainSize)
+{
+    return post<std::vector<std::vector<RET>>>(Util::forEachBatchSplitCoro<RET, INPUT_IT>,
+                                               INPUT_IT{first},
+                                               INPUT_IT{last},
+                                               Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                                               size_t{grainSize},
+                                               getNumCoroutineThreads());
+}
+
 template <class KEY,
           class MAPPED_TYPE,
           class REDUCED_TYPE,
@@ -208,11 +564,167 @@ Dispatcher::mapReduceBatch(INPUT_IT first,
                                Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
 }
 
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class INPUT_IT,
+          class>
+ThreadContextPtr<RESULT>
+Dispatcher::mapReducePartitioned(INPUT_IT first,
+                                 INPUT_IT last,
+                                 Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                 Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                 size_t numPartitions,
+                                 Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>(first, std::distance(first, last),
+        std::move(mapper), std::move(reducer), numPartitions, std::move(combiner));
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class INPUT_IT>
+ThreadContextPtr<RESULT>
+Dispatcher::mapReducePartitioned(INPUT_IT first,
+                                 size_t num,
+                                 Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                 Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                                 size_t numPartitions,
+                                 Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return post<RESULT>(Util::mapReducePartitionedCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT, INPUT_IT>,
+                        INPUT_IT{first},
+                        size_t{num},
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        size_t{numPartitions},
+                        Functions::CombineFunc<MAPPED_TYPE>{std::move(combiner)},
+                        getNumCoroutineThreads());
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class RESULT,
+          class T>
+ThreadContextPtr<RESULT>
+Dispatcher::mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                            Functions::StreamMapFunc<KEY, MAPPED_TYPE, T> mapper,
+                            Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                            size_t numPartitions,
+                            Functions::CombineFunc<MAPPED_TYPE> combiner)
+{
+    return post<RESULT>(Util::mapReduceStreamCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT, T>,
+                        std::shared_ptr<ICoroFuture<Buffer<T>>>{std::move(input)},
+                        Functions::StreamMapFunc<KEY, MAPPED_TYPE, T>{std::move(mapper)},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        size_t{numPartitions},
+                        Functions::CombineFunc<MAPPED_TYPE>{std::move(combiner)},
+                        getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<RET>
+Dispatcher::reduce(INPUT_IT first,
+                   INPUT_IT last,
+                   RET init,
+                   Functions::BinaryOpFunc<RET> op)
+{
+    return reduce<RET>(first, std::distance(first, last), std::move(init), std::move(op));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<RET>
+Dispatcher::reduce(INPUT_IT first,
+                   size_t num,
+                   RET init,
+                   Functions::BinaryOpFunc<RET> op)
+{
+    return post<RET>(Util::transformReduceCoro<RET, INPUT_IT, Util::Identity<RET>>,
+                     INPUT_IT{first},
+                     size_t{num},
+                     RET{std::move(init)},
+                     Util::Identity<RET>{},
+                     Functions::BinaryOpFunc<RET>{std::move(op)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<RET>
+Dispatcher::transformReduce(INPUT_IT first,
+                            INPUT_IT last,
+                            RET init,
+                            Functions::ForEachFunc<RET, INPUT_IT> transform,
+                            Functions::BinaryOpFunc<RET> op)
+{
+    return transformReduce<RET>(first, std::distance(first, last), std::move(init), std::move(transform), std::move(op));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<RET>
+Dispatcher::transformReduce(INPUT_IT first,
+                            size_t num,
+                            RET init,
+                            Functions::ForEachFunc<RET, INPUT_IT> transform,
+                            Functions::BinaryOpFunc<RET> op)
+{
+    return post<RET>(Util::transformReduceCoro<RET, INPUT_IT, Functions::ForEachFunc<RET, INPUT_IT>>,
+                     INPUT_IT{first},
+                     size_t{num},
+                     RET{std::move(init)},
+                     Functions::ForEachFunc<RET, INPUT_IT>{std::move(transform)},
+                     Functions::BinaryOpFunc<RET>{std::move(op)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::inclusiveScan(INPUT_IT first,
+                          INPUT_IT last,
+                          Functions::BinaryOpFunc<RET> op)
+{
+    return inclusiveScan<RET>(first, std::distance(first, last), std::move(op));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::inclusiveScan(INPUT_IT first,
+                          size_t num,
+                          Functions::BinaryOpFunc<RET> op)
+{
+    return post<std::vector<RET>>(Util::inclusiveScanCoro<RET, INPUT_IT>,
+                                  INPUT_IT{first},
+                                  size_t{num},
+                                  Functions::BinaryOpFunc<RET>{std::move(op)},
+                                  getNumCoroutineThreads());
+}
+
+template <class RANDOM_IT, class COMPARE, class>
+ThreadContextPtr<int>
+Dispatcher::sort(RANDOM_IT first,
+                 RANDOM_IT last,
+                 COMPARE comp)
+{
+    return post<int>(Util::sortCoro<RANDOM_IT, COMPARE>,
+                     RANDOM_IT{first},
+                     RANDOM_IT{last},
+                     COMPARE{std::move(comp)},
+                     getNumCoroutineThreads());
+}
+
 inline
 void Dispatcher::terminate()
 {
     if (!_terminated.test_and_set())
     {
+        if (_metricsExporter)
+        {
+            //stop publishing before the queues go away
+            _metricsExporter->terminate();
+        }
         _dispatcher.terminate();
     }
 }
@@ -231,30 +743,41 @@ bool Dispatcher::empty(IQueue::QueueType type,
     return _dispatcher.empty(type, queueId);
 }
 
+inline
+bool Dispatcher::isOverloaded(bool isIoTask) const
+{
+    size_t limit = isIoTask ? _maxPendingIoTasks : _maxPendingCoroTasks;
+    if (limit == 0)
+    {
+        return false;
+    }
+    //A single shared counter is read instead of summing the size of every queue on each post
+    size_t numPending = _dispatcher.numPendingTasks(isIoTask ? IQueue::QueueType::IO : IQueue::QueueType::Coro);
+    if (numPending < limit)
+    {
+        return false;
+    }
+    if (_overloadCallback)
+    {
+        _overloadCallback(isIoTask, numPending);
+    }
+    return true;
+}
+
+inline
+std::chrono::microseconds Dispatcher::oldestRunnableWaitTime(int queueId) const
+{
+    return _dispatcher.oldestRunnableWaitTime(queueId);
+}
+
 inline
 void Dispatcher::drain(std::chrono::milliseconds timeout)
 {
     _drain = true;
     
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    //wait until all queues have completed their work
-    YieldingThread yield;
-    while (!empty())
-    {
-        yield();
-        
-        //check remaining time
-        if (timeout != std::chrono::milliseconds::zero())
-        {
-            auto present = std::chrono::high_resolution_clock::now();
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(present-start) > timeout)
-            {
-                //timeout reached
-                break;
-            }
-        }
-    }
+    //wait until all queues have completed their work. The queues signal each time they run out
+    //of work so this thread sleeps until the last task completes instead of polling.
+    _dispatcher.waitUntilEmpty(timeout);
     
 #ifdef __QUANTUM_PRINT_DEBUG
     std::lock_guard<std::mutex> guard(Util::LogMutex());
@@ -269,12 +792,30 @@ int Dispatcher::getNumCoroutineThreads() const
     return _dispatcher.getNumCoroutineThreads();
 }
 
+inline
+int Dispatcher::getNumActiveCoroutineThreads() const
+{
+    return _dispatcher.getNumActiveCoroutineThreads();
+}
+
+inline
+void Dispatcher::setNumActiveCoroutineThreads(int num)
+{
+    _dispatcher.setNumActiveCoroutineThreads(num);
+}
+
 inline
 int Dispatcher::getNumIoThreads() const
 {
     return _dispatcher.getNumIoThreads();
 }
 
+inline
+int Dispatcher::getNumElasticIoThreads() const
+{
+    return _dispatcher.getNumElasticIoThreads();
+}
+
 inline
 QueueStatistics Dispatcher::stats(IQueue::QueueType type,
                                   int queueId)
@@ -288,11 +829,143 @@ void Dispatcher::resetStats()
     _dispatcher.resetStats();
 }
 
+inline
+std::vector<TaskInfo> Dispatcher::snapshotTasks() const
+{
+    return _dispatcher.snapshotTasks();
+}
+
+inline
+std::map<std::string, LockStatistics> Dispatcher::lockStats()
+{
+    return LockProfiler::stats();
+}
+
+inline
+void Dispatcher::setMetricsSource(const std::string& name, MetricsSource source)
+{
+    std::lock_guard<std::mutex> lock(_metricsSourcesMutex);
+    if (source)
+    {
+        _metricsSources[name] = std::move(source);
+    }
+    else
+    {
+        _metricsSources.erase(name);
+    }
+}
+
+inline
+void Dispatcher::collectMetrics(MetricsSnapshot& metrics)
+{
+    auto addQueue = [&metrics](IQueue::QueueType type, int queueId, const QueueStatistics& stats)
+    {
+        QueueMetrics queue;
+        queue._type = type;
+        queue._queueId = queueId;
+        queue._numElements = stats.numElements();
+        queue._postedCount = stats.postedCount();
+        queue._completedCount = stats.completedCount() + stats.sharedQueueCompletedCount();
+        queue._errorCount = stats.errorCount() + stats.sharedQueueErrorCount();
+        queue._stolenCount = stats.stolenCount();
+        queue._migratedCount = stats.migratedCount();
+        queue._expiredCount = stats.expiredCount();
+        queue._cancelledCount = stats.cancelledCount();
+        queue._longSliceCount = stats.longSliceCount();
+        queue._queueWaitTimeNs = stats.queueWaitTimeNs();
+        queue._runTimeNs = stats.runTimeNs();
+        metrics._queues.emplace_back(std::move(queue));
+    };
+    for (int i = 0; i < getNumCoroutineThreads(); ++i)
+    {
+        addQueue(IQueue::QueueType::Coro, i, stats(IQueue::QueueType::Coro, i));
+    }
+    for (int i = 0; i < getNumIoThreads(); ++i)
+    {
+        addQueue(IQueue::QueueType::IO, i, stats(IQueue::QueueType::IO, i));
+    }
+    addQueue(IQueue::QueueType::IO, (int)IQueue::QueueId::Any, stats(IQueue::QueueType::IO, (int)IQueue::QueueId::Any));
+    metrics._allocators = allocatorStats();
+    
+    std::lock_guard<std::mutex> lock(_metricsSourcesMutex);
+    for (const auto& source : _metricsSources)
+    {
+        MetricsSnapshot::Gauges gauges;
+        source.second(gauges);
+        for (const auto& gauge : gauges)
+        {
+            metrics._gauges[source.first + "." + gauge.first] = gauge.second;
+        }
+    }
+}
+
+inline
+std::map<std::string, AllocatorStatistics> Dispatcher::allocatorStats()
+{
+    std::map<std::string, AllocatorStatistics> stats;
+#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
+    stats["context"] = Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).stats();
+    stats["future"] = Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()).stats();
+    stats["ioTask"] = Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()).stats();
+    stats["promise"] = Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).stats();
+    stats["task"] = Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).stats();
+#endif
+#ifndef __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR
+    stats["coroStack"] = Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()).stats();
+#endif
+    for (auto&& entry : FunctionAllocator::stats()) {
+        stats.insert(entry);
+    }
+    return stats;
+}
+
+inline
+void Dispatcher::warmUpPools(size_t num)
+{
+#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
+    Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).warmUp(num);
+    Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()).warmUp(num);
+    Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()).warmUp(num);
+    Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).warmUp(num);
+    Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).warmUp(num);
+#endif
+#ifndef __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR
+    Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()).warmUp(num);
+#endif
+    UNUSED(num);
+}
+
+inline
+Histogram Dispatcher::coroStackUsage(size_t stackSize)
+{
+#ifndef __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR
+    return Task::stackAllocator(stackSize).stackUsage();
+#else
+    UNUSED(stackSize);
+    return Histogram();
+#endif
+}
+
+inline
+Histogram Dispatcher::coroStackUsage(const std::string& tag, size_t stackSize)
+{
+#ifndef __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR
+    return Task::stackAllocator(stackSize).stackUsage(tag);
+#else
+    UNUSED(tag);
+    UNUSED(stackSize);
+    return Histogram();
+#endif
+}
+
 template <class RET, class FUNC, class ... ARGS>
 ThreadContextPtr<RET>
 Dispatcher::postImpl(int queueId,
-                     bool isHighPriority,
+                     int priority,
                      ITask::Type type,
+                     TimePoint deadline,
+                     size_t stackSize,
+                     CancellationToken::Ptr token,
                      FUNC&& func,
                      ARGS&&... args)
 {
@@ -304,15 +977,35 @@ Dispatcher::postImpl(int queueId,
     {
         throw std::runtime_error("Invalid coroutine queue id");
     }
-    auto ctx = ContextPtr<RET>(new Context<RET>(_dispatcher),
-                               Context<RET>::deleter);
-    auto task = Task::Ptr(new Task(ctx,
-                                   queueId,
-                                   isHighPriority,
-                                   type,
-                                   std::forward<FUNC>(func),
-                                   std::forward<ARGS>(args)...),
-                          Task::deleter);
+    if (priority < (int)IQueue::Priority::Normal)
+    {
+        throw std::runtime_error("Invalid priority");
+    }
+    auto ctx = Context<RET>::create(_dispatcher);
+    if ((type == ITask::Type::Standalone) && isOverloaded(false))
+    {
+        ctx->setException(std::make_exception_ptr(OverloadException()));
+        return std::static_pointer_cast<IThreadContext<RET>>(ctx);
+    }
+    ctx->setStackSize(stackSize);
+    if (token)
+    {
+        if ((type == ITask::Type::Standalone) && token->isCancelled())
+        {
+            //Never scheduled so no stack is allocated
+            ctx->setException(std::make_exception_ptr(CancellationException()));
+            return std::static_pointer_cast<IThreadContext<RET>>(ctx);
+        }
+        ctx->setCancellationToken(token);
+    }
+    auto task = Task::create(ctx,
+                             queueId,
+                             priority,
+                             type,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    task->setDeadline(deadline);
+    task->setCancellationToken(std::move(token));
     ctx->setTask(task);
     if (type == ITask::Type::Standalone)
     {
@@ -321,10 +1014,84 @@ Dispatcher::postImpl(int queueId,
     return std::static_pointer_cast<IThreadContext<RET>>(ctx);
 }
 
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAfterImpl(std::chrono::milliseconds delay,
+                          int queueId,
+                          int priority,
+                          FUNC&& func,
+                          ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (priority < (int)IQueue::Priority::Normal)
+    {
+        throw std::runtime_error("Invalid priority");
+    }
+    auto ctx = Context<RET>::create(_dispatcher);
+    auto task = Task::create(ctx,
+                             queueId,
+                             priority,
+                             ITask::Type::Standalone,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    ctx->setTask(task);
+    //The task was accepted when it was scheduled so it is posted even if the dispatcher is draining by then
+    DispatcherCore& dispatcher = _dispatcher;
+    dispatcher.getTimerService().schedule(delay, std::chrono::microseconds::zero(), [&dispatcher, task]{
+        dispatcher.post(task);
+    });
+    return std::static_pointer_cast<IThreadContext<RET>>(ctx);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+uint64_t
+Dispatcher::postEveryImpl(std::chrono::milliseconds period,
+                          int queueId,
+                          int priority,
+                          FUNC&& func,
+                          ARGS&&... args)
+{
+    if (period <= std::chrono::milliseconds::zero())
+    {
+        throw std::runtime_error("Invalid period");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (priority < (int)IQueue::Priority::Normal)
+    {
+        throw std::runtime_error("Invalid priority");
+    }
+    //Each run posts a fresh coroutine. Posting throws (and the run is skipped) while the dispatcher is draining.
+    return _dispatcher.getTimerService().schedule(period, period, [this, queueId, priority, func, args...]{
+        postImpl<RET>(queueId, priority, ITask::Type::Standalone, TimePoint::max(), 0, nullptr, func, args...);
+    });
+}
+
 template <class RET, class FUNC, class ... ARGS>
 ThreadFuturePtr<RET>
 Dispatcher::postAsyncIoImpl(int queueId,
-                            bool isHighPriority,
+                            int priority,
+                            FUNC&& func,
+                            ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(nullptr, nullptr, queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIoImpl(const std::string* group,
+                            CancellationToken::Ptr token,
+                            int queueId,
+                            int priority,
                             FUNC&& func,
                             ARGS&&... args)
 {
@@ -336,14 +1103,40 @@ Dispatcher::postAsyncIoImpl(int queueId,
     {
         throw std::runtime_error("Invalid IO queue id");
     }
-    auto promise = PromisePtr<RET>(new Promise<RET>(), Promise<RET>::deleter);
+    if (priority < (int)IQueue::Priority::Normal)
+    {
+        throw std::runtime_error("Invalid priority");
+    }
+    auto promise = Promise<RET>::create();
+    if (token && token->isCancelled())
+    {
+        promise->setException(std::make_exception_ptr(CancellationException()));
+        return promise->getIThreadFuture();
+    }
+    if (isOverloaded(true))
+    {
+        promise->setException(std::make_exception_ptr(OverloadException()));
+        return promise->getIThreadFuture();
+    }
     auto task = IoTask::Ptr(new IoTask(promise,
                                        queueId,
-                                       isHighPriority,
+                                       priority,
                                        std::forward<FUNC>(func),
                                        std::forward<ARGS>(args)...),
                             IoTask::deleter);
-    _dispatcher.postAsyncIo(task);
+    if (token)
+    {
+        task->setCancellationToken(std::move(token), promise);
+    }
+    if (group)
+    {
+        task->setCompletionPromise(promise);
+        _dispatcher.postAsyncIoGroup(*group, task);
+    }
+    else
+    {
+        _dispatcher.postAsyncIo(task);
+    }
     return promise->getIThreadFuture();
 }
 
@@ -0,0 +1,194 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+FiberYield::FiberYield(const boost::context::stack_context& stack) :
+    _stack(stack)
+{}
+
+inline
+FiberYield& FiberYield::operator()()
+{
+    _caller = boost::context::detail::jump_fcontext(_caller, nullptr).fctx;
+    if (_isUnwinding)
+    {
+        throw FiberUnwind();
+    }
+    return *this;
+}
+
+inline
+int& FiberYield::get() const
+{
+    return *_rc;
+}
+
+inline
+void FiberYield::entry(boost::context::detail::transfer_t transfer)
+{
+    FiberYield* self = static_cast<FiberYield*>(transfer.data);
+    self->_caller = transfer.fctx;
+    try
+    {
+        self->run();
+    }
+    catch (const FiberUnwind&)
+    {
+    }
+    catch (...)
+    {
+        self->_exception = std::current_exception();
+    }
+    self->_isComplete = true;
+    //never resumed again. The resumer releases the stack.
+    boost::context::detail::jump_fcontext(self->_caller, nullptr);
+}
+
+//==============================================================================================
+//                                  class FiberCoroutine::Record
+//==============================================================================================
+template <class STACK_ALLOCATOR, class FUNC>
+class FiberCoroutine::Record : public FiberYield
+{
+public:
+    Record(STACK_ALLOCATOR&& allocator, const boost::context::stack_context& stack, FUNC&& func) :
+        FiberYield(stack),
+        _allocator(std::move(allocator)),
+        _func(std::move(func))
+    {}
+
+    void run() final
+    {
+        _func(*this);
+    }
+
+    void destroy() final
+    {
+        STACK_ALLOCATOR allocator(std::move(_allocator));
+        boost::context::stack_context stack = _stack;
+        this->~Record();
+        allocator.deallocate(stack);
+    }
+
+private:
+    STACK_ALLOCATOR     _allocator;
+    FUNC                _func;
+};
+
+template <class STACK_ALLOCATOR, class FUNC>
+FiberCoroutine::FiberCoroutine(STACK_ALLOCATOR&& allocator, FUNC&& func)
+{
+    using AllocatorType = std::decay_t<STACK_ALLOCATOR>;
+    using FunctionType = std::decay_t<FUNC>;
+    using RecordType = Record<AllocatorType, FunctionType>;
+
+    AllocatorType stackAllocator(std::forward<STACK_ALLOCATOR>(allocator));
+    boost::context::stack_context stack = stackAllocator.allocate();
+    //The record sits at the top of the stack and the coroutine frames start right below it
+    uintptr_t top = reinterpret_cast<uintptr_t>(stack.sp) - sizeof(RecordType);
+    top &= ~static_cast<uintptr_t>(alignof(RecordType) - 1);
+    uintptr_t sp = top & ~static_cast<uintptr_t>(63);
+    _record = new (reinterpret_cast<void*>(top)) RecordType(std::move(stackAllocator), stack,
+                                                            FunctionType(std::forward<FUNC>(func)));
+    _record->_fiber = boost::context::detail::make_fcontext(reinterpret_cast<void*>(sp),
+                                                            stack.size - (reinterpret_cast<uintptr_t>(stack.sp) - sp),
+                                                            &FiberYield::entry);
+}
+
+inline
+FiberCoroutine::FiberCoroutine(FiberCoroutine&& other) :
+    _record(other._record)
+{
+    other._record = nullptr;
+}
+
+inline
+FiberCoroutine& FiberCoroutine::operator=(FiberCoroutine&& other)
+{
+    if (this != &other)
+    {
+        release();
+        _record = other._record;
+        other._record = nullptr;
+    }
+    return *this;
+}
+
+inline
+FiberCoroutine::~FiberCoroutine()
+{
+    release();
+}
+
+inline
+FiberCoroutine& FiberCoroutine::operator()(int& rc)
+{
+    _record->_rc = &rc;
+    _record->_isStarted = true;
+    _record->_fiber = boost::context::detail::jump_fcontext(_record->_fiber, _record).fctx;
+    if (_record->_isComplete)
+    {
+        std::exception_ptr exception = std::move(_record->_exception);
+        release();
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+    return *this;
+}
+
+inline
+FiberCoroutine::operator bool() const
+{
+    return _record != nullptr;
+}
+
+inline
+void FiberCoroutine::release()
+{
+    if (!_record)
+    {
+        return;
+    }
+    if (_record->_isStarted)
+    {
+        //Resume the suspended coroutine so that its pending yield throws and unwinds the stack
+        int rc = 0;
+        _record->_rc = &rc;
+        _record->_isUnwinding = true;
+        while (!_record->_isComplete)
+        {
+            _record->_fiber = boost::context::detail::jump_fcontext(_record->_fiber, _record).fctx;
+        }
+    }
+    _record->destroy();
+    _record = nullptr;
+}
+
+}}
@@ -0,0 +1,74 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+void Futex::wait(std::atomic_int& signal, int expected)
+{
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&signal), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    (void)signal;
+    (void)expected;
+    YieldingThread()();
+#endif
+}
+
+inline
+void Futex::waitFor(std::atomic_int& signal, int expected, std::chrono::microseconds time)
+{
+    if (time <= std::chrono::microseconds::zero())
+    {
+        return;
+    }
+#if defined(__linux__)
+    struct timespec timeout;
+    timeout.tv_sec = time.count() / 1000000;
+    timeout.tv_nsec = (time.count() % 1000000) * 1000;
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&signal), FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+#else
+    (void)signal;
+    (void)expected;
+    YieldingThread()(std::min(time, YieldingThread::defaultDuration()));
+#endif
+}
+
+inline
+void Futex::wake(std::atomic_int& signal, int num)
+{
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&signal), FUTEX_WAKE_PRIVATE, num, nullptr, nullptr, 0);
+#else
+    (void)signal;
+    (void)num;
+#endif
+}
+
+}}
@@ -53,6 +53,13 @@ const NonBufferRetType<V>& IThreadFuture<T>::getRef() const
     return static_cast<const Impl*>(this)->template getRef();
 }
 
+template <class T>
+template <class V>
+SharedFuture<NonBufferRetType<V>> IThreadFuture<T>::share() const
+{
+    return static_cast<const Impl*>(this)->template share();
+}
+
 template <class T>
 template <class V>
 BufferRetType<V> IThreadFuture<T>::pull(bool& isBufferClosed)
@@ -60,6 +67,34 @@ BufferRetType<V> IThreadFuture<T>::pull(bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull(isBufferClosed);
 }
 
+template <class T>
+template <class V>
+std::vector<BufferRetType<V>> IThreadFuture<T>::pullBatch(size_t maxItems, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullBatch(maxItems, isBufferClosed);
+}
+
+template <class T>
+template <class FUNC>
+void IThreadFuture<T>::onReady(FUNC&& callback)
+{
+    static_cast<Impl*>(this)->onReady(std::forward<FUNC>(callback));
+}
+
+template <class T>
+template <class DISPATCHER, class FUNC>
+void IThreadFuture<T>::onReady(DISPATCHER& dispatcher, FUNC&& func)
+{
+    static_cast<Impl*>(this)->template onReady<IThreadFuture<T>>(dispatcher, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func));
+}
+
+template <class T>
+template <class DISPATCHER, class FUNC>
+void IThreadFuture<T>::onReady(DISPATCHER& dispatcher, int queueId, bool isHighPriority, FUNC&& func)
+{
+    static_cast<Impl*>(this)->template onReady<IThreadFuture<T>>(dispatcher, queueId, isHighPriority, std::forward<FUNC>(func));
+}
+
 //==============================================================================================
 //                                class ICoroFuture
 //==============================================================================================
@@ -77,6 +112,27 @@ const NonBufferRetType<V>& ICoroFuture<T>::getRef(ICoroSync::Ptr sync) const
     return static_cast<const Impl*>(this)->template getRef(sync);
 }
 
+template <class T>
+template <class V>
+SharedFuture<NonBufferRetType<V>> ICoroFuture<T>::share() const
+{
+    return static_cast<const Impl*>(this)->template share();
+}
+
+template <class T>
+template <class V>
+bool ICoroFuture<T>::getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value)
+{
+    return static_cast<Impl*>(this)->template getFor<V>(sync, timeMs, value);
+}
+
+template <class T>
+template <class CLOCK, class DURATION, class V>
+bool ICoroFuture<T>::getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value)
+{
+    return static_cast<Impl*>(this)->template getUntil<CLOCK, DURATION, V>(sync, deadline, value);
+}
+
 template <class T>
 template <class V>
 BufferRetType<V> ICoroFuture<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
@@ -84,6 +140,34 @@ BufferRetType<V> ICoroFuture<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull(sync, isBufferClosed);
 }
 
+template <class T>
+template <class V>
+std::vector<BufferRetType<V>> ICoroFuture<T>::pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullBatch(sync, maxItems, isBufferClosed);
+}
+
+template <class T>
+template <class FUNC>
+void ICoroFuture<T>::onReady(FUNC&& callback)
+{
+    static_cast<Impl*>(this)->onReady(std::forward<FUNC>(callback));
+}
+
+template <class T>
+template <class DISPATCHER, class FUNC>
+void ICoroFuture<T>::onReady(DISPATCHER& dispatcher, FUNC&& func)
+{
+    static_cast<Impl*>(this)->template onReady<ICoroFuture<T>>(dispatcher, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func));
+}
+
+template <class T>
+template <class DISPATCHER, class FUNC>
+void ICoroFuture<T>::onReady(DISPATCHER& dispatcher, int queueId, bool isHighPriority, FUNC&& func)
+{
+    static_cast<Impl*>(this)->template onReady<ICoroFuture<T>>(dispatcher, queueId, isHighPriority, std::forward<FUNC>(func));
+}
+
 //==============================================================================================
 //                                class Future
 //==============================================================================================
@@ -114,6 +198,14 @@ const NonBufferRetType<V>& Future<T>::getRef() const
     return _sharedState->getRef();
 }
 
+template <class T>
+template <class V>
+SharedFuture<NonBufferRetType<V>> Future<T>::share() const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return SharedFuture<T>(_sharedState);
+}
+
 template <class T>
 void Future<T>::wait() const
 {
@@ -144,6 +236,23 @@ const NonBufferRetType<V>& Future<T>::getRef(ICoroSync::Ptr sync) const
     return _sharedState->getRef(sync);
 }
 
+template <class T>
+template <class V>
+bool Future<T>::getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->getFor(sync, timeMs, value);
+}
+
+template <class T>
+template <class CLOCK, class DURATION, class V>
+bool Future<T>::getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    //A deadline in the past still returns the value if it is ready
+    return _sharedState->getFor(sync, deadline - CLOCK::now(), value);
+}
+
 template <class T>
 void Future<T>::wait(ICoroSync::Ptr sync) const
 {
@@ -175,6 +284,48 @@ BufferRetType<V> Future<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     return _sharedState->template pull(sync, isBufferClosed);
 }
 
+template <class T>
+template <class V>
+std::vector<BufferRetType<V>> Future<T>::pullBatch(size_t maxItems, bool& isBufferClosed)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->pullBatch(maxItems, isBufferClosed);
+}
+
+template <class T>
+template <class V>
+std::vector<BufferRetType<V>> Future<T>::pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->pullBatch(sync, maxItems, isBufferClosed);
+}
+
+template <class T>
+template <class FUNC>
+void Future<T>::onReady(FUNC&& callback)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->onReady(std::forward<FUNC>(callback));
+}
+
+template <class T>
+template <class FUTURE, class DISPATCHER, class FUNC>
+void Future<T>::onReady(DISPATCHER& dispatcher, int queueId, bool isHighPriority, FUNC&& func)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    typename FUTURE::Ptr future = FuturePtr<T>(new Future<T>(_sharedState), Future<T>::deleter);
+    DISPATCHER* dispatcherPtr = &dispatcher;
+    //The continuation is only posted once the value is available, hence it never blocks
+    _sharedState->onReady([dispatcherPtr, queueId, isHighPriority, future, func = std::forward<FUNC>(func)]() mutable
+    {
+        dispatcherPtr->post(queueId, isHighPriority, [future, func = std::move(func)](ICoroContext<int>::Ptr ctx) mutable ->int
+        {
+            func(ctx, std::move(future));
+            return ctx->set(0);
+        });
+    });
+}
+
 template <class T>
 void* Future<T>::operator new(size_t)
 {
@@ -0,0 +1,190 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <limits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+Histogram::Histogram()
+{
+    reset();
+}
+
+inline
+void Histogram::reset()
+{
+    _buckets.fill(0);
+    _count = 0;
+    _min = std::numeric_limits<uint64_t>::max();
+    _max = 0;
+    _sum = 0;
+}
+
+inline
+void Histogram::record(uint64_t value)
+{
+    ++_buckets[bucketIndex(value)];
+    ++_count;
+    _sum += value;
+    if (value < _min)
+    {
+        _min = value;
+    }
+    if (value > _max)
+    {
+        _max = value;
+    }
+}
+
+inline
+uint64_t Histogram::count() const
+{
+    return _count;
+}
+
+inline
+uint64_t Histogram::min() const
+{
+    return _count ? _min : 0;
+}
+
+inline
+uint64_t Histogram::max() const
+{
+    return _max;
+}
+
+inline
+double Histogram::mean() const
+{
+    return _count ? _sum / _count : 0;
+}
+
+inline
+uint64_t Histogram::percentile(double percent) const
+{
+    if (_count == 0)
+    {
+        return 0;
+    }
+    if (percent <= 0)
+    {
+        return min();
+    }
+    //Find the first bucket at which the cumulative count reaches the requested rank
+    uint64_t rank = static_cast<uint64_t>((percent / 100.0) * _count + 0.5);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < NumBuckets; ++i)
+    {
+        total += _buckets[i];
+        if (total >= rank)
+        {
+            uint64_t value = bucketHighestValue(i);
+            return (value > _max) ? _max : value;
+        }
+    }
+    return _max;
+}
+
+inline
+void Histogram::print(std::ostream& out) const
+{
+    out << "count=" << _count
+        << " min=" << min()
+        << " mean=" << static_cast<uint64_t>(mean())
+        << " p50=" << percentile(50)
+        << " p90=" << percentile(90)
+        << " p99=" << percentile(99)
+        << " p99.9=" << percentile(99.9)
+        << " max=" << _max;
+}
+
+inline
+Histogram& Histogram::operator+=(const Histogram& rhs)
+{
+    for (size_t i = 0; i < NumBuckets; ++i)
+    {
+        _buckets[i] += rhs._buckets[i];
+    }
+    _count += rhs._count;
+    _sum += rhs._sum;
+    if (rhs._min < _min)
+    {
+        _min = rhs._min;
+    }
+    if (rhs._max > _max)
+    {
+        _max = rhs._max;
+    }
+    return *this;
+}
+
+inline
+size_t Histogram::bucketIndex(uint64_t value)
+{
+    if (value < SubBuckets)
+    {
+        return static_cast<size_t>(value); //exact values
+    }
+    //position of the most significant bit
+#if defined(_MSC_VER)
+    unsigned long msb;
+    _BitScanReverse64(&msb, value);
+#else
+    size_t msb = 63 - __builtin_clzll(value);
+#endif
+    size_t shift = msb - SubBucketBits;
+    //Keep the top 'SubBucketBits+1' bits of the value. The leading bit is always set.
+    return SubBuckets + (shift * SubBuckets) + static_cast<size_t>((value >> shift) - SubBuckets);
+}
+
+inline
+uint64_t Histogram::bucketHighestValue(size_t index)
+{
+    if (index < SubBuckets)
+    {
+        return index;
+    }
+    size_t shift = (index - SubBuckets) / SubBuckets;
+    uint64_t top = SubBuckets + ((index - SubBuckets) % SubBuckets);
+    if (shift + SubBucketBits == 63 && top == 2 * SubBuckets - 1)
+    {
+        return std::numeric_limits<uint64_t>::max(); //last bucket
+    }
+    return ((top + 1) << shift) - 1;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const Histogram& histogram)
+{
+    histogram.print(out);
+    return out;
+}
+
+}}
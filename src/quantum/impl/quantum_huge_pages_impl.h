@@ -0,0 +1,96 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+#endif
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+size_t HugePages::roundUp(size_t bytes)
+{
+    return ((bytes + PageSize - 1) / PageSize) * PageSize;
+}
+
+inline
+void* HugePages::allocate(size_t bytes)
+{
+#if defined(__linux__)
+    bytes = roundUp(bytes);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_HUGETLB)
+    void* region = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    if (region != MAP_FAILED) {
+        return region;
+    }
+#endif
+    //No reserved huge pages. Map an aligned region and let the kernel promote it.
+    char* raw = static_cast<char*>(::mmap(nullptr, bytes + PageSize, PROT_READ | PROT_WRITE, flags, -1, 0));
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw)));
+    if (aligned > raw) {
+        ::munmap(raw, aligned - raw);
+    }
+    if (aligned + bytes < raw + bytes + PageSize) {
+        ::munmap(aligned + bytes, (raw + bytes + PageSize) - (aligned + bytes));
+    }
+    advise(aligned, bytes);
+    return aligned;
+#else
+    (void)bytes;
+    return nullptr;
+#endif
+}
+
+inline
+void HugePages::deallocate(void* p, size_t bytes)
+{
+#if defined(__linux__)
+    if (p) {
+        ::munmap(p, roundUp(bytes));
+    }
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+inline
+void HugePages::advise(void* p, size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t start = roundUp(reinterpret_cast<uintptr_t>(p));
+    uintptr_t end = ((reinterpret_cast<uintptr_t>(p) + bytes) / PageSize) * PageSize;
+    if (end > start) {
+        ::madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE);
+    }
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+}}
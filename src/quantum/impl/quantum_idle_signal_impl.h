@@ -0,0 +1,64 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+void IdleSignal::signal()
+{
+    //Pairs with the increment in 'waitFor': either the waiter sees the queue state which led to
+    //this signal when it evaluates its condition, or this thread sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_numWaiters.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+    {
+        //Taking the mutex prevents the notification from being lost between the evaluation of the
+        //condition and the waiter blocking.
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _cond.notify_all();
+}
+
+template <class PREDICATE>
+bool IdleSignal::waitFor(std::chrono::milliseconds timeout, PREDICATE&& isIdle)
+{
+    ++_numWaiters;
+    bool result;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (timeout == std::chrono::milliseconds::zero())
+        {
+            _cond.wait(lock, isIdle);
+            result = true;
+        }
+        else
+        {
+            result = _cond.wait_for(lock, timeout, isIdle);
+        }
+    }
+    --_numWaiters;
+    return result;
+}
+
+}}
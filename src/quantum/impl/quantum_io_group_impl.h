@@ -0,0 +1,200 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+size_t IoGroupStatistics::postedCount() const
+{
+    return _postedCount;
+}
+
+inline
+size_t IoGroupStatistics::completedCount() const
+{
+    return _completedCount;
+}
+
+inline
+size_t IoGroupStatistics::inFlightCount() const
+{
+    return _inFlightCount;
+}
+
+inline
+size_t IoGroupStatistics::queuedCount() const
+{
+    return _queuedCount;
+}
+
+inline
+size_t IoGroupStatistics::maxQueuedCount() const
+{
+    return _maxQueuedCount;
+}
+
+inline
+size_t IoGroupStatistics::throttledCount() const
+{
+    return _throttledCount;
+}
+
+inline
+void IoGroupStatistics::print(std::ostream& out) const
+{
+    out << "Num posted: " << _postedCount << std::endl;
+    out << "Num completed: " << _completedCount << std::endl;
+    out << "Num in flight: " << _inFlightCount << std::endl;
+    out << "Num queued: " << _queuedCount << std::endl;
+    out << "Max queued: " << _maxQueuedCount << std::endl;
+    out << "Num throttled: " << _throttledCount << std::endl;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const IoGroupStatistics& stats)
+{
+    stats.print(out);
+    return out;
+}
+
+inline
+IoGroup::IoGroup(size_t maxInFlight, double ratePerSecond, size_t burst) :
+    _maxInFlight(0),
+    _ratePerSecond(0),
+    _burst(0),
+    _tokens(0),
+    _lastRefill(Clock::now()),
+    _isRetryScheduled(false)
+{
+    setLimits(maxInFlight, ratePerSecond, burst);
+    _tokens = _burst;
+}
+
+inline
+void IoGroup::setLimits(size_t maxInFlight, double ratePerSecond, size_t burst)
+{
+    if (ratePerSecond < 0)
+    {
+        throw std::runtime_error("Invalid rate");
+    }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill(Clock::now());
+    _maxInFlight = maxInFlight;
+    _ratePerSecond = ratePerSecond;
+    _burst = (burst > 0) ? (double)burst : 1.0;
+    _tokens = std::min(_tokens, _burst);
+}
+
+inline
+void IoGroup::enqueue(IoTask::Ptr task)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats._postedCount;
+    refill(Clock::now());
+    if (!_pending.empty() ||
+        ((_maxInFlight > 0) && (_stats._inFlightCount >= _maxInFlight)) ||
+        ((_ratePerSecond > 0) && (_tokens < 1.0)))
+    {
+        ++_stats._throttledCount;
+    }
+    _pending.emplace_back(std::move(task));
+    _stats._queuedCount = _pending.size();
+    _stats._maxQueuedCount = std::max(_stats._maxQueuedCount, _stats._queuedCount);
+}
+
+inline
+std::vector<IoTask::Ptr> IoGroup::acquire(std::chrono::microseconds& retryAfter)
+{
+    std::vector<IoTask::Ptr> tasks;
+    retryAfter = std::chrono::microseconds::zero();
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ratePerSecond > 0)
+    {
+        refill(Clock::now());
+    }
+    while (!_pending.empty() &&
+           ((_maxInFlight == 0) || (_stats._inFlightCount < _maxInFlight)))
+    {
+        if (_ratePerSecond > 0)
+        {
+            if (_tokens < 1.0)
+            {
+                //Only one retry is outstanding at any time
+                if (!_isRetryScheduled)
+                {
+                    _isRetryScheduled = true;
+                    retryAfter = std::chrono::microseconds(
+                        std::max<int64_t>(1, (int64_t)((1.0 - _tokens) * 1000000 / _ratePerSecond)));
+                }
+                break;
+            }
+            _tokens -= 1.0;
+        }
+        tasks.emplace_back(std::move(_pending.front()));
+        _pending.pop_front();
+        ++_stats._inFlightCount;
+    }
+    _stats._queuedCount = _pending.size();
+    return tasks;
+}
+
+inline
+void IoGroup::release()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_stats._inFlightCount;
+    ++_stats._completedCount;
+}
+
+inline
+void IoGroup::retry()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isRetryScheduled = false;
+}
+
+inline
+IoGroupStatistics IoGroup::stats() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+inline
+void IoGroup::refill(Clock::time_point now)
+{
+    if (_ratePerSecond > 0)
+    {
+        std::chrono::duration<double> elapsed = now - _lastRefill;
+        _tokens = std::min(_burst, _tokens + elapsed.count() * _ratePerSecond);
+    }
+    _lastRefill = now;
+}
+
+}}
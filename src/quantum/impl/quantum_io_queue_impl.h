@@ -19,6 +19,7 @@
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
 #include <cmath>
+#include <algorithm>
 
 namespace Bloomberg {
 namespace quantum {
@@ -38,13 +39,31 @@ IoQueue::IoQueue(const Configuration& config,
     _loadBalancePollIntervalBackoffPolicy(config.getLoadBalancePollIntervalBackoffPolicy()),
     _loadBalancePollIntervalNumBackoffs(config.getLoadBalancePollIntervalNumBackoffs()),
     _loadBalanceBackoffNum(0),
-    _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
+    _loadBalanceNumPollsBeforeParking(config.getLoadBalanceNumPollsBeforeParking()),
+    _loadBalanceNumEmptyPolls(0),
+    _ring((!sharedIoQueues && config.getLoadBalanceSharedIoQueues() && config.getSharedIoRingCapacity()) ?
+          new MpmcRing<IoTask::Ptr>(config.getSharedIoRingCapacity()) : nullptr),
+    _spinlock(LockProfiler::site<IoQueue>("IoQueue")),
     _isEmpty(true),
     _isInterrupted(false),
     _isIdle(true),
-    _terminated(ATOMIC_FLAG_INIT)
+    _terminated(ATOMIC_FLAG_INIT),
+    _numIdleWorkers(0),
+    _isIdleWorker(false),
+    _isElastic(!sharedIoQueues && !config.getLoadBalanceSharedIoQueues() && (config.getMaxNumElasticIoThreads() > 0)),
+    _idleSignal(nullptr),
+    _pendingTaskCounter(nullptr),
+    _sharedMemoryQueue(sharedIoQueues ? config.getSharedMemoryQueue() : nullptr),
+    _sharedMemoryQueuePollIntervalMs(config.getSharedMemoryQueuePollIntervalMs())
 {
+    initPriorityLevels(config.getPriorityLevelWeights());
     if (_sharedIoQueues) {
+        if (!_loadBalanceSharedIoQueues) {
+            //The thread starts idle so it must be reachable from the shared queue
+            //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+            SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
+            setIdle();
+        }
         //The shared queue doesn't have its own thread
         _thread = std::make_shared<std::thread>(std::bind(&IoQueue::run, this));
     }
@@ -58,18 +77,47 @@ IoQueue::IoQueue(const IoQueue& other) :
     _loadBalancePollIntervalBackoffPolicy(other._loadBalancePollIntervalBackoffPolicy),
     _loadBalancePollIntervalNumBackoffs(other._loadBalancePollIntervalNumBackoffs),
     _loadBalanceBackoffNum(0),
-    _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
+    _loadBalanceNumPollsBeforeParking(other._loadBalanceNumPollsBeforeParking),
+    _loadBalanceNumEmptyPolls(0),
+    _ring(other._ring ? new MpmcRing<IoTask::Ptr>(other._ring->capacity()) : nullptr),
+    _spinlock(LockProfiler::site<IoQueue>("IoQueue")),
     _isEmpty(true),
     _isInterrupted(false),
     _isIdle(true),
-    _terminated(ATOMIC_FLAG_INIT)
+    _terminated(ATOMIC_FLAG_INIT),
+    _numIdleWorkers(0),
+    _isIdleWorker(false),
+    _isElastic(other._isElastic),
+    _idleSignal(other._idleSignal.load()),
+    _pendingTaskCounter(other._pendingTaskCounter.load()),
+    _sharedMemoryQueue(other._sharedMemoryQueue),
+    _sharedMemoryQueuePollIntervalMs(other._sharedMemoryQueuePollIntervalMs)
 {
+    initPriorityLevels(other._weights);
     if (_sharedIoQueues) {
+        if (!_loadBalanceSharedIoQueues) {
+            //The thread starts idle so it must be reachable from the shared queue
+            //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+            SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
+            setIdle();
+        }
         //The shared queue doesn't have its own thread
         _thread = std::make_shared<std::thread>(std::bind(&IoQueue::run, this));
     }
 }
 
+inline
+void IoQueue::initPriorityLevels(const std::vector<size_t>& weights)
+{
+    _weights = weights;
+    _credits = weights;
+    _queues.reserve(weights.size());
+    for (size_t level = 0; level < weights.size(); ++level)
+    {
+        _queues.emplace_back(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize()));
+    }
+}
+
 inline
 IoQueue::~IoQueue()
 {
@@ -77,9 +125,45 @@ IoQueue::~IoQueue()
 }
 
 inline
-void IoQueue::pinToCore(int)
+void IoQueue::pinToCore(int coreId)
+{
+    pinToCpus(NumaTopology::CpuSet{coreId});
+}
+
+inline
+void IoQueue::pinToCpus(const NumaTopology::CpuSet& cpus)
 {
-    //Not used
+    if (_thread)
+    {
+        NumaTopology::pinThread(*_thread, cpus);
+    }
+}
+
+inline
+void IoQueue::setSchedPolicy(Configuration::SchedPolicy policy, int priority)
+{
+#if defined(__linux__)
+    if (!_thread || (policy == Configuration::SchedPolicy::Default))
+    {
+        return;
+    }
+    int osPolicy = SCHED_OTHER;
+    switch (policy)
+    {
+        case Configuration::SchedPolicy::Fifo: osPolicy = SCHED_FIFO; break;
+        case Configuration::SchedPolicy::RoundRobin: osPolicy = SCHED_RR; break;
+        case Configuration::SchedPolicy::Batch: osPolicy = SCHED_BATCH; break;
+        case Configuration::SchedPolicy::Idle: osPolicy = SCHED_IDLE; break;
+        default: break;
+    }
+    struct sched_param param{};
+    param.sched_priority = ((osPolicy == SCHED_FIFO) || (osPolicy == SCHED_RR)) ? priority : 0;
+    //Fails without the required privileges in which case the thread keeps the default policy
+    pthread_setschedparam(_thread->native_handle(), osPolicy, &param);
+#else
+    (void)policy;
+    (void)priority;
+#endif
 }
 
 inline
@@ -98,17 +182,53 @@ void IoQueue::run()
                     if (task)
                     {
                         _loadBalanceBackoffNum = 0; //reset
+                        _loadBalanceNumEmptyPolls = 0;
                         break;
                     }
+                    if (_sharedMemoryQueue && runSharedMemoryTask())
+                    {
+                        _loadBalanceBackoffNum = 0; //reset
+                        _loadBalanceNumEmptyPolls = 0;
+                        continue;
+                    }
+                    //A parked thread can't be woken up by other processes so keep polling the shared memory queue
+                    if (_loadBalanceNumPollsBeforeParking && !_sharedMemoryQueue &&
+                        (++_loadBalanceNumEmptyPolls >= _loadBalanceNumPollsBeforeParking))
+                    {
+                        //========================= BLOCK WHEN EMPTY =========================
+                        _loadBalanceBackoffNum = 0; //reset
+                        _loadBalanceNumEmptyPolls = 0;
+                        task = park();
+                        if (task)
+                        {
+                            break;
+                        }
+                        continue;
+                    }
+                    signalIdle();
                     YieldingThread()(getBackoffInterval());
                 } while (!_isInterrupted);
             }
             else if (_isEmpty)
             {
+                signalIdle();
+                if (_sharedMemoryQueue && !_isInterrupted && runSharedMemoryTask())
+                {
+                    continue; //check for local work before taking more from other processes
+                }
                 std::unique_lock<std::mutex> lock(_notEmptyMutex);
                 //========================= BLOCK WHEN EMPTY =========================
                 //Wait for the queue to have at least one element
-                _notEmptyCond.wait(lock, [this]() -> bool { return !_isEmpty || _isInterrupted; });
+                auto isNotEmpty = [this]() -> bool { return !_isEmpty || _isInterrupted; };
+                if (_sharedMemoryQueue)
+                {
+                    //Other processes can't notify this thread so wake up periodically to poll their queue
+                    _notEmptyCond.wait_for(lock, _sharedMemoryQueuePollIntervalMs, isNotEmpty);
+                }
+                else
+                {
+                    _notEmptyCond.wait(lock, isNotEmpty);
+                }
             }
             
             if (_isInterrupted)
@@ -126,11 +246,17 @@ void IoQueue::run()
                 }
             }
             
+            QUANTUM_TRACE(Tracer::Event::Started, task.get(), IQueue::QueueType::IO, task->getQueueId());
             //========================= START TASK =========================
             int rc = task->run();
             //========================== END TASK ==========================
+            QUANTUM_TRACE(Tracer::Event::Finished, task.get(), IQueue::QueueType::IO, task->getQueueId());
 
-            if (rc == (int)ITask::RetCode::Success)
+            if (rc == (int)ITask::RetCode::Cancelled)
+            {
+                _stats.incCancelledCount();
+            }
+            else if (rc == (int)ITask::RetCode::Success)
             {
                 if (task->getQueueId() == (int)IQueue::QueueId::Any)
                 {
@@ -203,6 +329,18 @@ bool IoQueue::tryEnqueue(ITask::Ptr task)
     {
         return false; //nothing to do
     }
+    if (_ring)
+    {
+        IoTask::Ptr ioTask = std::static_pointer_cast<IoTask>(task);
+        QUANTUM_TRACE(Tracer::Event::Posted, task.get(), IQueue::QueueType::IO, task->getQueueId());
+        incPendingCount(); //before the task becomes visible to the consumers
+        if (_ring->tryPush(ioTask))
+        {
+            return true;
+        }
+        decPendingCount();
+        return false;
+    }
     //========================= LOCKED SCOPE =========================
     SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
     if (lock.ownsLock())
@@ -212,24 +350,53 @@ bool IoQueue::tryEnqueue(ITask::Ptr task)
     return lock.ownsLock();
 }
 
+inline
+void IoQueue::enqueueBatch(std::vector<ITask::Ptr>& tasks)
+{
+    if (tasks.empty())
+    {
+        return; //nothing to do
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        for (auto&& task : tasks)
+        {
+            push(task);
+        }
+    }
+    if (!_loadBalanceSharedIoQueues || _loadBalanceNumPollsBeforeParking)
+    {
+        signalEmptyCondition(false);
+    }
+}
+
 inline
 void IoQueue::doEnqueue(ITask::Ptr task)
 {
+    push(task);
+    if (!_loadBalanceSharedIoQueues || _loadBalanceNumPollsBeforeParking)
+    {
+        signalEmptyCondition(false);
+    }
+}
+
+inline
+void IoQueue::push(const ITask::Ptr& task)
+{
+    QUANTUM_TRACE(Tracer::Event::Posted, task.get(), IQueue::QueueType::IO, task->getQueueId());
     if (task->isHighPriority())
     {
         _stats.incHighPriorityCount();
-        _queue.emplace_front(std::static_pointer_cast<IoTask>(task));
     }
-    else
+    if (_isElastic)
     {
-        _queue.emplace_back(std::static_pointer_cast<IoTask>(task));
+        std::static_pointer_cast<IoTask>(task)->_postTimestamp = std::chrono::steady_clock::now();
     }
+    _queues[getPriorityLevel(task)].emplace_back(std::static_pointer_cast<IoTask>(task));
     _stats.incPostedCount();
     _stats.incNumElements();
-    if (!_loadBalanceSharedIoQueues)
-    {
-        signalEmptyCondition(false);
-    }
+    incPendingCount();
 }
 
 inline
@@ -247,6 +414,21 @@ ITask::Ptr IoQueue::dequeue(std::atomic_bool& hint)
 inline
 ITask::Ptr IoQueue::tryDequeue(std::atomic_bool& hint)
 {
+    if (_ring)
+    {
+        IoTask::Ptr task;
+        if (_ring->tryPop(task))
+        {
+            decPendingCount();
+            hint = false;
+            return task;
+        }
+        if (isQueueEmpty())
+        {
+            hint = true; //avoid locking in the common case where nothing spilled
+            return nullptr;
+        }
+    }
     //========================= LOCKED SCOPE =========================
     SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
     if (lock.ownsLock())
@@ -259,39 +441,93 @@ ITask::Ptr IoQueue::tryDequeue(std::atomic_bool& hint)
 inline
 ITask::Ptr IoQueue::doDequeue(std::atomic_bool& hint)
 {
-    hint = _queue.empty();
+    hint = isQueueEmpty();
     if (!hint)
     {
-        ITask::Ptr task = _queue.front();
-        _queue.pop_front();
+        TaskList* queue = selectPriorityLevel();
+        ITask::Ptr task = queue->front();
+        queue->pop_front();
         _stats.decNumElements();
+        decPendingCount();
         return task;
     }
     return nullptr;
 }
 
+inline
+size_t IoQueue::getPriorityLevel(const ITask::Ptr& task) const
+{
+    return std::min(static_cast<size_t>(task->getPriority()), _queues.size()-1);
+}
+
+inline
+IoQueue::TaskList* IoQueue::selectPriorityLevel()
+{
+    //Pick the highest non-empty level which still has credit in this round. When all pending levels
+    //have used their share, a new round begins. The queue must not be empty.
+    while (true)
+    {
+        for (size_t level = _queues.size(); level-- > 0;)
+        {
+            if (!_queues[level].empty() && (_credits[level] > 0))
+            {
+                --_credits[level];
+                return &_queues[level];
+            }
+        }
+        _credits = _weights;
+    }
+}
+
+inline
+bool IoQueue::isQueueEmpty() const
+{
+    for (const auto& queue : _queues)
+    {
+        if (!queue.empty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline
+size_t IoQueue::queueSize() const
+{
+    size_t size = 0;
+    for (const auto& queue : _queues)
+    {
+        size += queue.size();
+    }
+    return size;
+}
+
 inline
 ITask::Ptr IoQueue::tryDequeueFromShared()
 {
-    static size_t index = 0;
+    static thread_local size_t index = 0;
     ITask::Ptr task;
     size_t size = 0;
     
-    for (size_t i = 0; i < (*_sharedIoQueues).size(); ++i)
+    do
     {
-        IoQueue& queue = (*_sharedIoQueues)[++index % (*_sharedIoQueues).size()];
-        size += queue.size();
-        task = queue.tryDequeue(_isIdle);
-        if (task)
+        //Retry while tasks are pending but could not be taken, i.e. a queue lock was held by a
+        //producer or a ring slot was claimed but not yet published. Iterate rather than recurse
+        //so that a burst of contention cannot exhaust the stack.
+        size = 0;
+        for (size_t i = 0; i < (*_sharedIoQueues).size(); ++i)
         {
-            return task;
+            IoQueue& queue = (*_sharedIoQueues)[++index % (*_sharedIoQueues).size()];
+            size += queue.size();
+            task = queue.tryDequeue(_isIdle);
+            if (task)
+            {
+                return task;
+            }
         }
     }
-
-    if (size) {
-        //try again
-        return tryDequeueFromShared();
-    }
+    while (size);
     return nullptr;
 }
 
@@ -316,15 +552,15 @@ size_t IoQueue::size() const
 {
 #if (__cplusplus >= 201703L)
     if (_sharedIoQueues) {
-        return _isIdle ? _queue.size() : _queue.size() + 1;
+        return _isIdle ? queueSize() : queueSize() + 1;
     }
-    return _queue.size();
+    return _ring ? queueSize() + _ring->size() : queueSize();
 #else
     //Avoid linear time implementation
     if (_sharedIoQueues) {
         return _isIdle ? _stats.numElements() : _stats.numElements() + 1;
     }
-    return _stats.numElements();
+    return _ring ? _stats.numElements() + _ring->size() : _stats.numElements();
 #endif
 }
 
@@ -332,9 +568,9 @@ inline
 bool IoQueue::empty() const
 {
     if (_sharedIoQueues) {
-        return _queue.empty() && _isIdle;
+        return isQueueEmpty() && _isIdle;
     }
-    return _queue.empty();
+    return isQueueEmpty() && (!_ring || _ring->empty());
 }
 
 inline
@@ -346,11 +582,19 @@ void IoQueue::terminate()
             std::unique_lock<std::mutex> lock(_notEmptyMutex);
             _isInterrupted = true;
         }
-        if (!_loadBalanceSharedIoQueues) {
+        if (!_loadBalanceSharedIoQueues || _loadBalanceNumPollsBeforeParking) {
             _notEmptyCond.notify_all();
         }
         _thread->join();
-        _queue.clear();
+        for (auto& queue : _queues)
+        {
+            queue.clear();
+        }
+        //Make sure this queue can no longer be woken up by the shared queue
+        IoQueue& sharedQueue = (*_sharedIoQueues)[0];
+        //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+        SpinLock::Guard lock(sharedQueue.getLock());
+        removeIdleWorker();
     }
 }
 
@@ -398,7 +642,7 @@ ITask::Ptr IoQueue::grabWorkItem()
             task = dequeue(_isIdle);
             if (!task)
             {
-                signalEmptyCondition(true);
+                setIdle();
             }
         }
     }
@@ -413,13 +657,273 @@ ITask::Ptr IoQueue::grabWorkItem()
             task = (*_sharedIoQueues)[0].dequeue(_isIdle);
             if (!task)
             {
-                signalEmptyCondition(true);
+                setIdle();
             }
         }
     }
     return task;
 }
 
+inline
+void IoQueue::setIdle()
+{
+    //NOTE: must be called with the shared queue lock held. Registering while holding the lock guarantees
+    //that a task posted to the shared queue after this point finds this thread in the idle list.
+    signalEmptyCondition(true);
+    addIdleWorker();
+}
+
+inline
+void IoQueue::addIdleWorker()
+{
+    //NOTE: must be called with the shared queue lock held
+    if (!_isIdleWorker)
+    {
+        IoQueue& sharedQueue = (*_sharedIoQueues)[0];
+        _isIdleWorker = true;
+        _idleSince = std::chrono::steady_clock::now();
+        sharedQueue._idleWorkers.push_back(this);
+        ++sharedQueue._numIdleWorkers;
+    }
+}
+
+inline
+void IoQueue::removeIdleWorker()
+{
+    //NOTE: must be called with the shared queue lock held
+    if (_isIdleWorker)
+    {
+        IoQueue& sharedQueue = (*_sharedIoQueues)[0];
+        _isIdleWorker = false;
+        sharedQueue._idleWorkers.erase(std::remove(sharedQueue._idleWorkers.begin(),
+                                                   sharedQueue._idleWorkers.end(), this),
+                                       sharedQueue._idleWorkers.end());
+        --sharedQueue._numIdleWorkers;
+    }
+}
+
+inline
+IoQueue* IoQueue::popIdleWorker()
+{
+    //NOTE: must be called on the shared queue with its lock held
+    if (_idleWorkers.empty())
+    {
+        return nullptr;
+    }
+    //Pick the thread which went idle last since its cache is the warmest
+    IoQueue* worker = _idleWorkers.back();
+    _idleWorkers.pop_back();
+    --_numIdleWorkers;
+    worker->_isIdleWorker = false;
+    return worker;
+}
+
+inline
+ITask::Ptr IoQueue::park()
+{
+    signalEmptyCondition(true);
+    signalIdle();
+    {
+        //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+        SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
+        addIdleWorker();
+    }
+    //Look for work one last time now that this thread can be woken up. This pairs with the fence
+    //in 'wakeIdleWorker': either the poster sees this thread in the idle list or this thread sees the task.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ITask::Ptr task = grabWorkItemFromAll();
+    if (!task)
+    {
+        std::unique_lock<std::mutex> lock(_notEmptyMutex);
+        _notEmptyCond.wait(lock, [this]() -> bool { return !_isEmpty || _isInterrupted; });
+    }
+    {
+        //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+        SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
+        removeIdleWorker(); //if woken up by a task in its own queue
+    }
+    return task;
+}
+
+inline
+void IoQueue::wakeIdleWorker()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_numIdleWorkers.load(std::memory_order_relaxed) == 0)
+    {
+        return; //all threads are polling
+    }
+    IoQueue* worker = nullptr;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        worker = popIdleWorker();
+    }
+    if (worker)
+    {
+        worker->signalEmptyCondition(false);
+    }
+}
+
+inline
+void IoQueue::enqueueShared(ITask::Ptr task)
+{
+    if (!task)
+    {
+        return; //nothing to do
+    }
+    IoQueue* worker = nullptr;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        doEnqueue(task);
+        worker = popIdleWorker();
+    }
+    //If all threads are busy, the task is picked up by the first one to finish
+    if (worker)
+    {
+        worker->signalEmptyCondition(false);
+    }
+}
+
+inline
+std::chrono::milliseconds IoQueue::oldestTaskWaitTime() const
+{
+    if (!_isElastic)
+    {
+        return std::chrono::milliseconds(0);
+    }
+    std::chrono::steady_clock::time_point oldest = std::chrono::steady_clock::time_point::max();
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        for (const auto& queue : _queues)
+        {
+            if (!queue.empty() && (queue.front()->_postTimestamp < oldest))
+            {
+                oldest = queue.front()->_postTimestamp;
+            }
+        }
+    }
+    if (oldest == std::chrono::steady_clock::time_point::max())
+    {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - oldest);
+}
+
+inline
+bool IoQueue::hasIdleWorkers() const
+{
+    return _numIdleWorkers > 0;
+}
+
+inline
+bool IoQueue::retireIfIdle(std::chrono::milliseconds timeout)
+{
+    //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+    SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
+    if (_isIdleWorker && (std::chrono::steady_clock::now() - _idleSince >= timeout))
+    {
+        removeIdleWorker();
+        return true;
+    }
+    return false;
+}
+
+inline
+bool IoQueue::hasRing() const
+{
+    return _ring != nullptr;
+}
+
+inline
+void IoQueue::setIdleSignal(IdleSignal* signal)
+{
+    _idleSignal = signal;
+}
+
+inline
+void IoQueue::setPendingTaskCounter(std::atomic<size_t>* counter)
+{
+    _pendingTaskCounter = counter;
+}
+
+inline
+void IoQueue::incPendingCount()
+{
+    std::atomic<size_t>* counter = _pendingTaskCounter;
+    if (counter)
+    {
+        counter->fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline
+void IoQueue::decPendingCount()
+{
+    std::atomic<size_t>* counter = _pendingTaskCounter;
+    if (counter)
+    {
+        counter->fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+inline
+bool IoQueue::runSharedMemoryTask()
+{
+    if (!_sharedMemoryQueue->tryPop(_sharedMemoryMessage))
+    {
+        return false;
+    }
+    //========================= START TASK =========================
+    int rc = _sharedMemoryQueue->run(_sharedMemoryMessage);
+    //========================== END TASK ==========================
+    UNUSED(rc);
+#ifdef __QUANTUM_PRINT_DEBUG
+    if (rc != (int)ITask::RetCode::Success)
+    {
+        std::lock_guard<std::mutex> guard(Util::LogMutex());
+        std::cerr << "Shared memory task " << _sharedMemoryMessage._functionId
+                  << " exited with error : " << rc << std::endl;
+    }
+#endif
+    return true;
+}
+
+inline
+void IoQueue::signalIdle()
+{
+    IdleSignal* signal = _idleSignal;
+    if (signal)
+    {
+        signal->signal();
+    }
+}
+
+inline
+void IoQueue::enqueueSharedBatch(std::vector<ITask::Ptr>& tasks)
+{
+    std::vector<IoQueue*> workers;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        for (auto&& task : tasks)
+        {
+            push(task);
+            if (IoQueue* worker = popIdleWorker())
+            {
+                workers.push_back(worker);
+            }
+        }
+    }
+    //Wake up one thread per task at most
+    for (auto&& worker : workers)
+    {
+        worker->signalEmptyCondition(false);
+    }
+}
+
 inline
 ITask::Ptr IoQueue::grabWorkItemFromAll()
 {
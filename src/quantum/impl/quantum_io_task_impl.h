@@ -40,27 +40,27 @@ template <class RET, class FUNC, class ... ARGS>
 IoTask::IoTask(std::shared_ptr<Promise<RET>> promise,
                FUNC&& func,
                ARGS&&... args) :
-    _func(Util::bindIoCaller(promise,
+    _func(Util::bindIoCaller(std::move(promise),
                              std::forward<FUNC>(func),
                              std::forward<ARGS>(args)...)),
     _terminated(ATOMIC_FLAG_INIT),
     _queueId((int)IQueue::QueueId::Any),
-    _isHighPriority(false)
+    _priority((int)IQueue::Priority::Normal)
 {
 }
 
 template <class RET, class FUNC, class ... ARGS>
 IoTask::IoTask(std::shared_ptr<Promise<RET>> promise,
                int queueId,
-               bool isHighPriority,
+               int priority,
                FUNC&& func,
                ARGS&&... args) :
-    _func(Util::bindIoCaller(promise,
+    _func(Util::bindIoCaller(std::move(promise),
                              std::forward<FUNC>(func),
                              std::forward<ARGS>(args)...)),
     _terminated(ATOMIC_FLAG_INIT),
     _queueId(queueId),
-    _isHighPriority(isHighPriority)
+    _priority(priority)
 {
 }
 
@@ -82,7 +82,57 @@ void IoTask::terminate()
 inline
 int IoTask::run()
 {
-    return _func ? _func() : (int)ITask::RetCode::NotCallable;
+    if (!_onComplete)
+    {
+        return invoke();
+    }
+    struct Completion
+    {
+        ~Completion()
+        {
+            try { _handler(); } catch (...) {}
+        }
+        std::function<void()>& _handler;
+    } completion{_onComplete};
+    return invoke();
+}
+
+inline
+int IoTask::invoke()
+{
+    if (!_func)
+    {
+        return (int)ITask::RetCode::NotCallable;
+    }
+    if (_cancellationToken && _cancellationToken->isCancelled())
+    {
+        _cancellationPromise->setException(std::make_exception_ptr(CancellationException()));
+        return (int)ITask::RetCode::Cancelled;
+    }
+    return _func();
+}
+
+inline
+void IoTask::setCompletionHandler(std::function<void()> handler)
+{
+    if (_completionPromise)
+    {
+        _completionPromise->onSet(handler);
+    }
+    _onComplete = std::move(handler);
+}
+
+inline
+void IoTask::setCompletionPromise(IPromiseBase::Ptr promise)
+{
+    _completionPromise = std::move(promise);
+}
+
+inline
+void IoTask::setCancellationToken(CancellationToken::Ptr token, IPromiseBase::Ptr promise)
+{
+    _cancellationToken = std::move(token);
+    _cancellationPromise = std::move(promise);
 }
 
 inline
@@ -118,7 +168,13 @@ bool IoTask::isSleeping(bool)
 inline
 bool IoTask::isHighPriority() const
 {
-    return _isHighPriority;
+    return _priority > (int)IQueue::Priority::Normal;
+}
+
+inline
+int IoTask::getPriority() const
+{
+    return _priority;
 }
 
 inline
@@ -0,0 +1,92 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+Latch::Latch(size_t count) :
+    _count(count)
+{}
+
+inline
+void Latch::countDown(size_t num)
+{
+    size_t count = _count.load(std::memory_order_relaxed);
+    do
+    {
+        if (num > count)
+        {
+            throw std::runtime_error("Latch count exceeded");
+        }
+    }
+    while (!_count.compare_exchange_weak(count, count - num, std::memory_order_seq_cst, std::memory_order_relaxed));
+    if ((count == num) && _waiters.hasWaiters())
+    {
+        _waiters.notifyAll();
+    }
+}
+
+inline
+bool Latch::tryWait() const
+{
+    return _count.load(std::memory_order_acquire) == 0;
+}
+
+inline
+void Latch::wait()
+{
+    if (!tryWait())
+    {
+        _waiters.wait([this]()->bool{ return _count != 0; });
+    }
+}
+
+inline
+void Latch::wait(ICoroSync::Ptr sync)
+{
+    if (!tryWait())
+    {
+        _waiters.wait(sync, [this]()->bool{ return _count != 0; });
+    }
+}
+
+inline
+void Latch::arriveAndWait(size_t num)
+{
+    countDown(num);
+    wait();
+}
+
+inline
+void Latch::arriveAndWait(ICoroSync::Ptr sync, size_t num)
+{
+    countDown(num);
+    wait(sync);
+}
+
+inline
+size_t Latch::count() const
+{
+    return _count.load(std::memory_order_acquire);
+}
+
+}}
@@ -0,0 +1,170 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                   class LockStatistics
+//==============================================================================================
+inline
+size_t LockStatistics::acquisitionCount() const
+{
+    return _acquisitionCount;
+}
+
+inline
+size_t LockStatistics::contentionCount() const
+{
+    return _contentionCount;
+}
+
+inline
+size_t LockStatistics::spinCount() const
+{
+    return _spinCount;
+}
+
+inline
+size_t LockStatistics::yieldCount() const
+{
+    return _yieldCount;
+}
+
+inline
+void LockStatistics::print(std::ostream& out) const
+{
+    out << "Num acquisitions: " << _acquisitionCount << std::endl;
+    out << "Num contentions: " << _contentionCount << std::endl;
+    out << "Num spins: " << _spinCount << std::endl;
+    out << "Num yields: " << _yieldCount << std::endl;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const LockStatistics& stats)
+{
+    stats.print(out);
+    return out;
+}
+
+//==============================================================================================
+//                                      class LockSite
+//==============================================================================================
+inline
+LockSite::LockSite(const char* name)
+#ifdef __QUANTUM_PROFILE_LOCKS
+    : _counters(LockProfiler::counters(name))
+#endif
+{
+    (void)name;
+}
+
+inline
+void LockSite::record(bool isContended, size_t spins, size_t yields) const
+{
+#ifdef __QUANTUM_PROFILE_LOCKS
+    _counters->_acquisitionCount.fetch_add(1, std::memory_order_relaxed);
+    if (isContended)
+    {
+        _counters->_contentionCount.fetch_add(1, std::memory_order_relaxed);
+        _counters->_spinCount.fetch_add(spins, std::memory_order_relaxed);
+        _counters->_yieldCount.fetch_add(yields, std::memory_order_relaxed);
+    }
+#else
+    (void)isContended;
+    (void)spins;
+    (void)yields;
+#endif
+}
+
+inline
+void LockSite::recordFailure() const
+{
+#ifdef __QUANTUM_PROFILE_LOCKS
+    _counters->_contentionCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+//==============================================================================================
+//                                    class LockProfiler
+//==============================================================================================
+template <class OWNER>
+const LockSite& LockProfiler::site(const char* name)
+{
+    static const LockSite site(name);
+    return site;
+}
+
+inline
+std::map<std::string, LockStatistics> LockProfiler::stats()
+{
+    std::map<std::string, LockStatistics> stats;
+    Registry& reg = registry();
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(reg._mutex);
+    for (const auto& site : reg._counters)
+    {
+        LockStatistics& siteStats = stats[site.first];
+        siteStats._acquisitionCount = site.second->_acquisitionCount.load(std::memory_order_relaxed);
+        siteStats._contentionCount = site.second->_contentionCount.load(std::memory_order_relaxed);
+        siteStats._spinCount = site.second->_spinCount.load(std::memory_order_relaxed);
+        siteStats._yieldCount = site.second->_yieldCount.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+inline
+void LockProfiler::reset()
+{
+    Registry& reg = registry();
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(reg._mutex);
+    for (const auto& site : reg._counters)
+    {
+        site.second->_acquisitionCount.store(0, std::memory_order_relaxed);
+        site.second->_contentionCount.store(0, std::memory_order_relaxed);
+        site.second->_spinCount.store(0, std::memory_order_relaxed);
+        site.second->_yieldCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline
+LockProfiler::Registry& LockProfiler::registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+inline
+LockProfiler::Counters* LockProfiler::counters(const char* name)
+{
+    Registry& reg = registry();
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(reg._mutex);
+    std::unique_ptr<Counters>& counters = reg._counters[name];
+    if (!counters)
+    {
+        counters.reset(new Counters);
+    }
+    return counters.get();
+}
+
+}}
@@ -0,0 +1,365 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct MetricsNames
+//==============================================================================================
+inline
+const std::vector<MetricsNames::Counter>& MetricsNames::queueCounters()
+{
+    static const std::vector<Counter> counters = {
+        {"posted", &QueueMetrics::_postedCount},
+        {"completed", &QueueMetrics::_completedCount},
+        {"errors", &QueueMetrics::_errorCount},
+        {"stolen", &QueueMetrics::_stolenCount},
+        {"migrated", &QueueMetrics::_migratedCount},
+        {"expired", &QueueMetrics::_expiredCount},
+        {"cancelled", &QueueMetrics::_cancelledCount},
+        {"long_slices", &QueueMetrics::_longSliceCount}
+    };
+    return counters;
+}
+
+inline
+const char* MetricsNames::queueType(const QueueMetrics& queue)
+{
+    return (queue._type == IQueue::QueueType::Coro) ? "coro" : "io";
+}
+
+inline
+std::string MetricsNames::queueId(const QueueMetrics& queue)
+{
+    return (queue._queueId == (int)IQueue::QueueId::Any) ? "any" : std::to_string(queue._queueId);
+}
+
+inline
+std::string MetricsNames::sanitize(const std::string& name, char replacement)
+{
+    std::string result(name);
+    for (char& c : result)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && (c != '_') && (c != replacement))
+        {
+            c = replacement;
+        }
+    }
+    return result;
+}
+
+//==============================================================================================
+//                                class PrometheusMetricsSink
+//==============================================================================================
+inline
+PrometheusMetricsSink::PrometheusMetricsSink(std::string prefix) :
+    _prefix(std::move(prefix))
+{
+}
+
+inline
+void PrometheusMetricsSink::publish(const MetricsSnapshot& metrics)
+{
+    std::ostringstream out;
+    out << std::setprecision(15);
+    std::vector<std::string> labels;
+    labels.reserve(metrics._queues.size());
+    for (const QueueMetrics& queue : metrics._queues)
+    {
+        labels.push_back(std::string("type=\"") + MetricsNames::queueType(queue) +
+                         "\",queue=\"" + MetricsNames::queueId(queue) + "\"");
+    }
+    //queue counters and gauges
+    for (const MetricsNames::Counter& counter : MetricsNames::queueCounters())
+    {
+        std::string name = _prefix + "_queue_" + counter.first + "_total";
+        out << "# TYPE " << name << " counter\n";
+        for (size_t i = 0; i < metrics._queues.size(); ++i)
+        {
+            addCounter(out, name, labels[i], metrics._queues[i].*counter.second);
+        }
+    }
+    out << "# TYPE " << _prefix << "_queue_elements gauge\n";
+    for (size_t i = 0; i < metrics._queues.size(); ++i)
+    {
+        out << _prefix << "_queue_elements{" << labels[i] << "} " << metrics._queues[i]._numElements << "\n";
+    }
+    //latency summaries
+    using HistogramMember = Histogram QueueMetrics::*;
+    for (const auto& histogram : {std::make_pair("queue_wait_time_ns", HistogramMember(&QueueMetrics::_queueWaitTimeNs)),
+                                  std::make_pair("run_time_ns", HistogramMember(&QueueMetrics::_runTimeNs))})
+    {
+        std::string name = _prefix + "_" + histogram.first;
+        out << "# TYPE " << name << " summary\n";
+        for (size_t i = 0; i < metrics._queues.size(); ++i)
+        {
+            const Histogram& values = metrics._queues[i].*histogram.second;
+            if (values.count() == 0)
+            {
+                continue;
+            }
+            for (double quantile : {0.5, 0.9, 0.99})
+            {
+                out << name << "{" << labels[i] << ",quantile=\"" << quantile << "\"} "
+                    << values.percentile(quantile * 100) << "\n";
+            }
+            out << name << "_sum{" << labels[i] << "} " << values.mean() * values.count() << "\n";
+            out << name << "_count{" << labels[i] << "} " << values.count() << "\n";
+        }
+    }
+    //allocators
+    if (!metrics._allocators.empty())
+    {
+        std::string name = _prefix + "_allocator_";
+        out << "# TYPE " << name << "allocated gauge\n";
+        for (const auto& allocator : metrics._allocators)
+        {
+            out << name << "allocated{pool=\"" << allocator.first << "\"} "
+                << allocator.second.allocatedCount() << "\n";
+        }
+        out << "# TYPE " << name << "peak_allocated gauge\n";
+        for (const auto& allocator : metrics._allocators)
+        {
+            out << name << "peak_allocated{pool=\"" << allocator.first << "\"} "
+                << allocator.second.peakAllocatedCount() << "\n";
+        }
+        out << "# TYPE " << name << "heap_fallbacks_total counter\n";
+        for (const auto& allocator : metrics._allocators)
+        {
+            out << name << "heap_fallbacks_total{pool=\"" << allocator.first << "\"} "
+                << allocator.second.heapFallbackCount() << "\n";
+        }
+    }
+    //user gauges
+    for (const auto& gauge : metrics._gauges)
+    {
+        std::string name = _prefix + "_" + MetricsNames::sanitize(gauge.first, '_');
+        out << "# TYPE " << name << " gauge\n";
+        out << name << " " << gauge.second << "\n";
+    }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    _text = out.str();
+}
+
+inline
+std::string PrometheusMetricsSink::text() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _text;
+}
+
+inline
+void PrometheusMetricsSink::addCounter(std::ostream& out,
+                                       const std::string& name,
+                                       const std::string& labels,
+                                       size_t delta)
+{
+    size_t& total = _totals[Labels(name, labels)];
+    total += delta;
+    out << name << "{" << labels << "} " << total << "\n";
+}
+
+//==============================================================================================
+//                                  class StatsdMetricsSink
+//==============================================================================================
+inline
+StatsdMetricsSink::StatsdMetricsSink(Writer writer,
+                                     std::string prefix,
+                                     size_t maxPacketSize) :
+    _writer(std::move(writer)),
+    _prefix(std::move(prefix)),
+    _maxPacketSize(maxPacketSize)
+{
+    if (!_writer)
+    {
+        throw std::invalid_argument("Invalid StatsD writer");
+    }
+}
+
+inline
+void StatsdMetricsSink::publish(const MetricsSnapshot& metrics)
+{
+    std::string packet;
+    for (const QueueMetrics& queue : metrics._queues)
+    {
+        std::string name = _prefix + ".queue." + MetricsNames::queueType(queue) + "." + MetricsNames::queueId(queue);
+        for (const MetricsNames::Counter& counter : MetricsNames::queueCounters())
+        {
+            addLine(packet, name + "." + counter.first, (double)(queue.*counter.second), "c");
+        }
+        addLine(packet, name + ".elements", (double)queue._numElements, "g");
+        if (queue._queueWaitTimeNs.count() > 0)
+        {
+            addLine(packet, name + ".queue_wait_time_ns.p50", (double)queue._queueWaitTimeNs.percentile(50), "g");
+            addLine(packet, name + ".queue_wait_time_ns.p99", (double)queue._queueWaitTimeNs.percentile(99), "g");
+            addLine(packet, name + ".queue_wait_time_ns.max", (double)queue._queueWaitTimeNs.max(), "g");
+        }
+        if (queue._runTimeNs.count() > 0)
+        {
+            addLine(packet, name + ".run_time_ns.p50", (double)queue._runTimeNs.percentile(50), "g");
+            addLine(packet, name + ".run_time_ns.p99", (double)queue._runTimeNs.percentile(99), "g");
+            addLine(packet, name + ".run_time_ns.max", (double)queue._runTimeNs.max(), "g");
+        }
+    }
+    for (const auto& allocator : metrics._allocators)
+    {
+        std::string name = _prefix + ".allocator." + MetricsNames::sanitize(allocator.first, '_');
+        addLine(packet, name + ".allocated", (double)allocator.second.allocatedCount(), "g");
+        addLine(packet, name + ".peak_allocated", (double)allocator.second.peakAllocatedCount(), "g");
+        addLine(packet, name + ".heap_fallbacks", (double)allocator.second.heapFallbackCount(), "g");
+    }
+    for (const auto& gauge : metrics._gauges)
+    {
+        addLine(packet, _prefix + "." + MetricsNames::sanitize(gauge.first, '.'), gauge.second, "g");
+    }
+    if (!packet.empty())
+    {
+        _writer(packet);
+    }
+}
+
+inline
+void StatsdMetricsSink::addLine(std::string& packet, const std::string& name, double value, const char* type)
+{
+    std::ostringstream line;
+    line << std::setprecision(15) << name << ":" << value << "|" << type;
+    std::string text = line.str();
+    if (!packet.empty() && (packet.size() + 1 + text.size() > _maxPacketSize))
+    {
+        _writer(packet);
+        packet.clear();
+    }
+    if (!packet.empty())
+    {
+        packet += '\n';
+    }
+    packet += text;
+}
+
+//==============================================================================================
+//                                   class MetricsExporter
+//==============================================================================================
+inline
+MetricsExporter::MetricsExporter(IMetricsSink::Ptr sink,
+                                 std::chrono::milliseconds period,
+                                 Collector collector) :
+    _sink(std::move(sink)),
+    _period(period),
+    _collector(std::move(collector)),
+    _isInterrupted(false),
+    _thread(std::bind(&MetricsExporter::run, this))
+{
+#if defined(__linux__)
+    struct sched_param param{};
+    //Fails silently if the policy is not supported in which case the thread keeps the default one
+    pthread_setschedparam(_thread.native_handle(), SCHED_IDLE, &param);
+#endif
+}
+
+inline
+MetricsExporter::~MetricsExporter()
+{
+    terminate();
+}
+
+inline
+void MetricsExporter::terminate()
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isInterrupted)
+        {
+            return;
+        }
+        _isInterrupted = true;
+    }
+    _cond.notify_one();
+    _thread.join();
+}
+
+inline
+void MetricsExporter::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_cond.wait_for(lock, _period, [this]{ return _isInterrupted; }))
+    {
+        lock.unlock();
+        publish();
+        lock.lock();
+    }
+}
+
+inline
+void MetricsExporter::publish()
+{
+    try
+    {
+        MetricsSnapshot current;
+        current._timestamp = std::chrono::system_clock::now();
+        current._period = _period;
+        _collector(current);
+        //counters are published as the change since the previous period
+        MetricsSnapshot metrics = current;
+        for (QueueMetrics& queue : metrics._queues)
+        {
+            auto previousIt = std::find_if(_previous._queues.begin(), _previous._queues.end(),
+                [&queue](const QueueMetrics& previous)->bool {
+                    return (previous._type == queue._type) && (previous._queueId == queue._queueId);
+                });
+            if (previousIt == _previous._queues.end())
+            {
+                continue;
+            }
+            for (const MetricsNames::Counter& counter : MetricsNames::queueCounters())
+            {
+                queue.*counter.second = delta(queue.*counter.second, (*previousIt).*counter.second);
+            }
+        }
+        _previous = std::move(current);
+        _sink->publish(metrics);
+    }
+    catch (...)
+    {
+        //the sink or one of the metrics sources failed, try again on the next period
+    }
+}
+
+inline
+size_t MetricsExporter::delta(size_t current, size_t previous)
+{
+    //the counters restart from 0 when the queue statistics are reset
+    return (current >= previous) ? current - previous : current;
+}
+
+}}
@@ -0,0 +1,130 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+template <typename T>
+MpmcRing<T>::MpmcRing(size_t capacity) :
+    _mask(roundUp(capacity) - 1),
+    _slots(new Slot[_mask + 1]),
+    _pushPos(0),
+    _popPos(0)
+{
+    for (size_t i = 0; i <= _mask; ++i)
+    {
+        _slots[i]._sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool MpmcRing<T>::tryPush(T& value)
+{
+    size_t pos = _pushPos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& slot = _slots[pos & _mask];
+        size_t sequence = slot._sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0)
+        {
+            //The slot is free for this position. Claim it.
+            if (_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot._value = std::move(value);
+                slot._sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; //full
+        }
+        else
+        {
+            pos = _pushPos.load(std::memory_order_relaxed); //another producer got there first
+        }
+    }
+}
+
+template <typename T>
+bool MpmcRing<T>::tryPop(T& value)
+{
+    size_t pos = _popPos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& slot = _slots[pos & _mask];
+        size_t sequence = slot._sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            //The slot holds the element for this position. Claim it.
+            if (_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                value = std::move(slot._value);
+                slot._value = T(); //release any resources held by the element
+                slot._sequence.store(pos + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; //empty
+        }
+        else
+        {
+            pos = _popPos.load(std::memory_order_relaxed); //another consumer got there first
+        }
+    }
+}
+
+template <typename T>
+size_t MpmcRing<T>::size() const
+{
+    size_t popPos = _popPos.load(std::memory_order_relaxed);
+    size_t pushPos = _pushPos.load(std::memory_order_relaxed);
+    return (pushPos > popPos) ? pushPos - popPos : 0;
+}
+
+template <typename T>
+bool MpmcRing<T>::empty() const
+{
+    return size() == 0;
+}
+
+template <typename T>
+size_t MpmcRing<T>::capacity() const
+{
+    return _mask + 1;
+}
+
+template <typename T>
+size_t MpmcRing<T>::roundUp(size_t capacity)
+{
+    size_t value = 2;
+    while (value < capacity)
+    {
+        value <<= 1;
+    }
+    return value;
+}
+
+}}
@@ -26,40 +26,182 @@ namespace quantum {
 //                                class Mutex
 //==============================================================================================
 inline
-Mutex::Mutex()
+Mutex::Mutex() :
+    _isLocked(false),
+    _head(nullptr),
+    _tail(nullptr)
+#ifdef __QUANTUM_PROFILE_LOCKS
+    , _site(nullptr)
+#endif
 {}
 
+inline
+Mutex::Mutex(const LockSite& site) :
+    _isLocked(false),
+    _head(nullptr),
+    _tail(nullptr)
+#ifdef __QUANTUM_PROFILE_LOCKS
+    , _site(&site)
+#endif
+{
+    (void)site;
+}
+
 inline
 void Mutex::lock()
 {
-    lockImpl(YieldingThread());
+    if (tryAcquire())
+    {
+        profile(false, 0);
+        return;
+    }
+    Waiter waiter;
+    size_t yields = 0;
+    if (enqueue(waiter))
+    {
+        yields = wait(waiter._signal);
+    }
+    profile(true, yields);
 }
 
 inline
 void Mutex::lock(ICoroSync::Ptr sync)
 {
-    lockImpl(sync->getYieldHandle());
+    if (tryAcquire())
+    {
+        profile(false, 0);
+        return;
+    }
+    Waiter waiter;
+    waiter._sync = sync;
+    std::atomic_int& signal = sync->signal();
+    signal = 0; //blocked until notified
+    size_t yields = 0;
+    if (enqueue(waiter))
+    {
+        Traits::Yield& yield = sync->getYieldHandle();
+        while (signal != 1)
+        {
+            yield();
+            ++yields;
+        }
+    }
+    signal = -1; //reset
+    profile(true, yields);
 }
 
-template <class YIELDING>
-void Mutex::lockImpl(YIELDING&& yield)
+inline
+bool Mutex::tryLock()
 {
-    while (!tryLock())
+    bool isLocked = tryAcquire();
+#ifdef __QUANTUM_PROFILE_LOCKS
+    if (_site)
     {
-        yield();
+        if (isLocked)
+        {
+            _site->record(false, 0, 0);
+        }
+        else
+        {
+            _site->recordFailure();
+        }
     }
+#endif
+    return isLocked;
 }
 
 inline
-bool Mutex::tryLock()
+bool Mutex::tryAcquire()
+{
+    return !_isLocked.load(std::memory_order_relaxed) &&
+           !_isLocked.exchange(true, std::memory_order_acquire);
+}
+
+inline
+void Mutex::profile(bool isContended, size_t yields) const
 {
-    return _spinlock.tryLock();
+#ifdef __QUANTUM_PROFILE_LOCKS
+    if (_site)
+    {
+        _site->record(isContended, 0, yields);
+    }
+#else
+    (void)isContended;
+    (void)yields;
+#endif
 }
 
 inline
 void Mutex::unlock()
 {
-    _spinlock.unlock();
+    Waiter* next;
+    ICoroSync::Ptr sync;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard guard(_spinlock);
+        next = _head;
+        if (!next)
+        {
+            _isLocked.store(false, std::memory_order_release);
+            return;
+        }
+        _head = next->_next;
+        if (!_head)
+        {
+            _tail = nullptr;
+        }
+        sync = next->_sync; //keeps the coroutine alive until it's notified
+    }
+    //Hand over ownership. The mutex stays locked on behalf of the next waiter.
+    if (sync)
+    {
+        sync->notify();
+    }
+    else
+    {
+        next->_signal.store(1, std::memory_order_release);
+        Futex::wake(next->_signal); //the node may already be gone, only its address is used
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 12)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdangling-pointer" //the waiter is removed from the list before it goes out of scope
+#endif
+inline
+bool Mutex::enqueue(Waiter& waiter)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_spinlock);
+    if (!_isLocked.exchange(true, std::memory_order_acquire))
+    {
+        return false; //released in the meantime
+    }
+    if (_tail)
+    {
+        _tail->_next = &waiter;
+    }
+    else
+    {
+        _head = &waiter;
+    }
+    _tail = &waiter;
+    return true;
+}
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 12)
+#pragma GCC diagnostic pop
+#endif
+
+inline
+size_t Mutex::wait(std::atomic_int& signal)
+{
+    size_t numWaits = 0;
+    while (signal.load(std::memory_order_acquire) == 0)
+    {
+        Futex::wait(signal, 0);
+        ++numWaits;
+    }
+    return numWaits;
 }
 
 //==============================================================================================
@@ -107,7 +249,10 @@ bool Mutex::Guard::ownsLock() const
 inline
 Mutex::Guard::~Guard()
 {
-    _mutex.unlock();
+    if (_ownsLock)
+    {
+        _mutex.unlock();
+    }
 }
 
 //==============================================================================================
@@ -0,0 +1,230 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+NumaTopology::NumaTopology() :
+    NumaTopology(discover())
+{
+}
+
+inline
+NumaTopology::NumaTopology(std::vector<CpuSet> nodes) :
+    _nodes(std::move(nodes))
+{
+    //Never leave empty nodes since they cannot run anything
+    _nodes.erase(std::remove_if(_nodes.begin(), _nodes.end(), [](const CpuSet& cpus)->bool { return cpus.empty(); }),
+                 _nodes.end());
+    if (_nodes.empty())
+    {
+        CpuSet cpus;
+        unsigned int numCpus = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < numCpus; ++cpu)
+        {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        _nodes.push_back(std::move(cpus));
+    }
+    for (const auto& node : _nodes)
+    {
+        _packed.insert(_packed.end(), node.begin(), node.end());
+    }
+}
+
+inline
+const NumaTopology& NumaTopology::instance()
+{
+    static NumaTopology topology;
+    return topology;
+}
+
+inline
+size_t NumaTopology::numNodes() const
+{
+    return _nodes.size();
+}
+
+inline
+const NumaTopology::CpuSet& NumaTopology::getNodeCpus(size_t node) const
+{
+    return _nodes.at(node);
+}
+
+inline
+NumaTopology::CpuSet NumaTopology::getCoroutineThreadCpus(Configuration::ThreadPlacement placement,
+                                                          size_t threadIndex) const
+{
+    if (placement == Configuration::ThreadPlacement::SpreadThreadsAcrossNodes)
+    {
+        //Alternate between nodes then between the cores of each node
+        const CpuSet& node = _nodes[threadIndex % _nodes.size()];
+        return CpuSet{node[(threadIndex / _nodes.size()) % node.size()]};
+    }
+    if (placement == Configuration::ThreadPlacement::PackThreadsOnNodes)
+    {
+        //Fill up one node before moving to the next
+        return CpuSet{_packed[threadIndex % _packed.size()]};
+    }
+    return CpuSet{};
+}
+
+inline
+NumaTopology::CpuSet NumaTopology::getIoThreadCpus(Configuration::ThreadPlacement placement,
+                                                   size_t threadIndex) const
+{
+    if (placement == Configuration::ThreadPlacement::SpreadThreadsAcrossNodes)
+    {
+        return _nodes[threadIndex % _nodes.size()];
+    }
+    if (placement == Configuration::ThreadPlacement::PackThreadsOnNodes)
+    {
+        return _nodes[getNodeOf(_packed[threadIndex % _packed.size()])];
+    }
+    return CpuSet{};
+}
+
+inline
+void NumaTopology::pinThread(std::thread& thread, const CpuSet& cpus)
+{
+    if (cpus.empty())
+    {
+        return;
+    }
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < (int)(sizeof(DWORD_PTR)*8))
+        {
+            mask |= ((DWORD_PTR)1 << cpu);
+        }
+    }
+    if (mask)
+    {
+        SetThreadAffinityMask(thread.native_handle(), mask);
+    }
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    bool isSet = false;
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &cpuSet);
+            isSet = true;
+        }
+    }
+    if (isSet)
+    {
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet);
+    }
+#else
+    (void)thread; //thread affinity not supported
+#endif
+}
+
+inline
+NumaTopology::CpuSet NumaTopology::parseCpuList(const std::string& list)
+{
+    CpuSet cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        try
+        {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        catch (const std::exception&)
+        {
+            //ignore malformed or empty entries (e.g. trailing newline)
+        }
+    }
+    return cpus;
+}
+
+inline
+std::vector<NumaTopology::CpuSet> NumaTopology::discover()
+{
+    std::vector<CpuSet> nodes;
+#ifdef __linux__
+    auto readFile = [](const std::string& path)->std::string
+    {
+        std::ifstream file(path);
+        std::string content;
+        std::getline(file, content);
+        return content;
+    };
+    for (int nodeId : parseCpuList(readFile("/sys/devices/system/node/online")))
+    {
+        CpuSet cpus = parseCpuList(readFile("/sys/devices/system/node/node" + std::to_string(nodeId) + "/cpulist"));
+        //Rank each CPU by its position amongst its hyper-thread siblings so that physical cores come first
+        std::vector<std::pair<size_t, int>> ranked;
+        for (int cpu : cpus)
+        {
+            CpuSet siblings = parseCpuList(readFile("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                                                    "/topology/thread_siblings_list"));
+            size_t rank = std::find(siblings.begin(), siblings.end(), cpu) - siblings.begin();
+            ranked.emplace_back(rank == siblings.size() ? 0 : rank, cpu);
+        }
+        std::sort(ranked.begin(), ranked.end());
+        CpuSet ordered;
+        for (const auto& entry : ranked)
+        {
+            ordered.push_back(entry.second);
+        }
+        nodes.push_back(std::move(ordered));
+    }
+#endif
+    return nodes;
+}
+
+inline
+size_t NumaTopology::getNodeOf(int cpu) const
+{
+    for (size_t node = 0; node < _nodes.size(); ++node)
+    {
+        if (std::find(_nodes[node].begin(), _nodes[node].end(), cpu) != _nodes[node].end())
+        {
+            return node;
+        }
+    }
+    return 0;
+}
+
+}}
@@ -0,0 +1,326 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <iomanip>
+#include <stdexcept>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+const std::string& PipelineStageStatistics::name() const
+{
+    return _name;
+}
+
+inline
+size_t PipelineStageStatistics::parallelism() const
+{
+    return _parallelism;
+}
+
+inline
+size_t PipelineStageStatistics::processedCount() const
+{
+    return _processedCount;
+}
+
+inline
+size_t PipelineStageStatistics::queueDepth() const
+{
+    return _queueDepth;
+}
+
+inline
+size_t PipelineStageStatistics::queueCapacity() const
+{
+    return _queueCapacity;
+}
+
+inline
+double PipelineStageStatistics::throughput() const
+{
+    return _throughput;
+}
+
+inline
+void PipelineStageStatistics::print(std::ostream& out) const
+{
+    out << *this << std::endl;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const PipelineStageStatistics& stats)
+{
+    out << "Stage: " << stats.name()
+        << " Parallelism: " << stats.parallelism()
+        << " Processed: " << stats.processedCount()
+        << " QueueDepth: " << stats.queueDepth() << "/" << stats.queueCapacity()
+        << " Throughput: " << std::fixed << std::setprecision(1) << stats.throughput() << "/s";
+    return out;
+}
+
+inline
+PipelineCore::PipelineCore(Dispatcher& dispatcher) :
+    _dispatcher(dispatcher)
+{
+}
+
+template <class IN, class OUT>
+Pipeline<IN, OUT>::Pipeline(Dispatcher& dispatcher, size_t capacity) :
+    _core(std::make_shared<PipelineCore>(dispatcher)),
+    _input(std::make_shared<Channel<IN>>(capacity)),
+    _output(_input)
+{
+    static_assert(std::is_same<IN, OUT>::value, "A new pipeline outputs its own input");
+}
+
+template <class IN, class OUT>
+Pipeline<IN, OUT>::Pipeline(std::shared_ptr<PipelineCore> core,
+                            typename Channel<IN>::Ptr input,
+                            typename Channel<OUT>::Ptr output) :
+    _core(std::move(core)),
+    _input(std::move(input)),
+    _output(std::move(output))
+{
+}
+
+template <class IN, class OUT>
+template <class NEXT>
+Pipeline<IN, NEXT> Pipeline<IN, OUT>::addStage(std::string name,
+                                               std::function<NEXT(OUT&&)> func,
+                                               size_t parallelism,
+                                               PipelineStageKind kind,
+                                               size_t capacity) const
+{
+    typename Channel<NEXT>::Ptr output = std::make_shared<Channel<NEXT>>(capacity);
+    launch<NEXT>(std::move(name), [func, output](ICoroSync::Ptr sync, OUT&& value)->bool
+    {
+        return sync ? output->send(sync, func(std::move(value))) : output->send(func(std::move(value)));
+    }, parallelism, kind, output);
+    return Pipeline<IN, NEXT>(_core, _input, std::move(output));
+}
+
+template <class IN, class OUT>
+Pipeline<IN, OUT> Pipeline<IN, OUT>::addSink(std::string name,
+                                             std::function<void(OUT&&)> func,
+                                             size_t parallelism,
+                                             PipelineStageKind kind) const
+{
+    launch<OUT>(std::move(name), [func](ICoroSync::Ptr, OUT&& value)->bool
+    {
+        func(std::move(value));
+        return true;
+    }, parallelism, kind, nullptr);
+    return Pipeline<IN, OUT>(_core, _input, nullptr);
+}
+
+template <class IN, class OUT>
+template <class NEXT>
+void Pipeline<IN, OUT>::launch(std::string name,
+                               std::function<bool(ICoroSync::Ptr, OUT&&)> process,
+                               size_t parallelism,
+                               PipelineStageKind kind,
+                               typename Channel<NEXT>::Ptr output) const
+{
+    if (!_output)
+    {
+        throw std::runtime_error("Cannot add a stage after a sink");
+    }
+    if (parallelism == 0)
+    {
+        throw std::runtime_error("Stage parallelism must be at least one");
+    }
+    typename Channel<OUT>::Ptr input = _output;
+    std::shared_ptr<PipelineStage> stage = std::make_shared<PipelineStage>();
+    stage->_name = std::move(name);
+    stage->_parallelism = parallelism;
+    stage->_queueDepth = [input]()->size_t { return input->size(); };
+    stage->_queueCapacity = input->capacity();
+    stage->_activeWorkers = parallelism;
+    
+    //Runs until the input is closed and drained. When a stage fails or its output is closed, its
+    //input is closed as well so that the stages before it do not wait forever on a full queue.
+    auto worker = [stage, input, output, process](ICoroSync::Ptr sync)
+    {
+        auto finish = [&]()
+        {
+            if ((--stage->_activeWorkers == 0) && output)
+            {
+                output->close(); //the last worker of the stage completes the next stage
+            }
+        };
+        OUT value;
+        try
+        {
+            while (sync ? input->recv(sync, value) : input->recv(value))
+            {
+                if (!process(sync, std::move(value)))
+                {
+                    input->close();
+                    break;
+                }
+                ++stage->_processedCount;
+            }
+        }
+        catch (...)
+        {
+            input->close();
+            finish();
+            throw;
+        }
+        finish();
+    };
+    for (size_t i = 0; i < parallelism; ++i)
+    {
+        if (kind == PipelineStageKind::Coroutine)
+        {
+            ThreadContextPtr<int> ctx = _core->_dispatcher.post([worker](CoroContextPtr<int> ctx)->int
+            {
+                try
+                {
+                    worker(ctx);
+                }
+                catch (...)
+                {
+                    return ctx->setException(std::current_exception());
+                }
+                return ctx->set(0);
+            });
+            stage->_waiters.emplace_back([ctx]() { ctx->get(); });
+        }
+        else
+        {
+            ThreadFuturePtr<int> future = _core->_dispatcher.postAsyncIo([worker](ThreadPromise<int>::Ptr promise)->int
+            {
+                try
+                {
+                    worker(nullptr);
+                }
+                catch (...)
+                {
+                    return static_cast<IPromiseBase&>(*promise).setException(std::current_exception());
+                }
+                return promise->set(0);
+            });
+            stage->_waiters.emplace_back([future]() { future->get(); });
+        }
+    }
+    SpinLock::Guard lock(_core->_lock);
+    _core->_stages.emplace_back(std::move(stage));
+}
+
+template <class IN, class OUT>
+bool Pipeline<IN, OUT>::push(IN value)
+{
+    return _input->send(std::move(value));
+}
+
+template <class IN, class OUT>
+bool Pipeline<IN, OUT>::push(ICoroSync::Ptr sync, IN value)
+{
+    return _input->send(sync, std::move(value));
+}
+
+template <class IN, class OUT>
+void Pipeline<IN, OUT>::close()
+{
+    _input->close();
+}
+
+template <class IN, class OUT>
+bool Pipeline<IN, OUT>::pull(OUT& value)
+{
+    if (!_output)
+    {
+        throw std::runtime_error("Cannot pull from a pipeline ending with a sink");
+    }
+    return _output->recv(value);
+}
+
+template <class IN, class OUT>
+bool Pipeline<IN, OUT>::pull(ICoroSync::Ptr sync, OUT& value)
+{
+    if (!_output)
+    {
+        throw std::runtime_error("Cannot pull from a pipeline ending with a sink");
+    }
+    return _output->recv(sync, value);
+}
+
+template <class IN, class OUT>
+void Pipeline<IN, OUT>::wait()
+{
+    std::vector<std::shared_ptr<PipelineStage>> stages;
+    {//========= LOCKED SCOPE =========
+        SpinLock::Guard lock(_core->_lock);
+        stages = _core->_stages;
+    }
+    std::exception_ptr ex;
+    for (auto&& stage : stages)
+    {
+        for (auto&& waiter : stage->_waiters)
+        {
+            try
+            {
+                waiter();
+            }
+            catch (...)
+            {
+                if (!ex)
+                {
+                    ex = std::current_exception();
+                }
+            }
+        }
+    }
+    if (ex)
+    {
+        std::rethrow_exception(ex);
+    }
+}
+
+template <class IN, class OUT>
+std::vector<PipelineStageStatistics> Pipeline<IN, OUT>::stats() const
+{
+    std::vector<std::shared_ptr<PipelineStage>> stages;
+    {//========= LOCKED SCOPE =========
+        SpinLock::Guard lock(_core->_lock);
+        stages = _core->_stages;
+    }
+    std::vector<PipelineStageStatistics> out;
+    out.reserve(stages.size());
+    auto now = std::chrono::steady_clock::now();
+    for (auto&& stage : stages)
+    {
+        PipelineStageStatistics stats;
+        stats._name = stage->_name;
+        stats._parallelism = stage->_parallelism;
+        stats._processedCount = stage->_processedCount;
+        stats._queueDepth = stage->_queueDepth();
+        stats._queueCapacity = stage->_queueCapacity;
+        double elapsed = std::chrono::duration<double>(now - stage->_started).count();
+        stats._throughput = (elapsed > 0) ? stats._processedCount/elapsed : 0;
+        out.emplace_back(std::move(stats));
+    }
+    return out;
+}
+
+}}
@@ -33,6 +33,13 @@ int IThreadPromise<PROMISE, T>::set(V&& value)
     return static_cast<Impl*>(this)->template set(std::forward<V>(value));
 }
 
+template <template<class> class PROMISE, class T>
+template <class... ARGS, class V, class>
+int IThreadPromise<PROMISE, T>::emplace(ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template emplace(std::forward<ARGS>(args)...);
+}
+
 template <template<class> class PROMISE, class T>
 template <class V, class>
 void IThreadPromise<PROMISE, T>::push(V&& value)
@@ -40,6 +47,13 @@ void IThreadPromise<PROMISE, T>::push(V&& value)
     static_cast<Impl*>(this)->template push(std::forward<V>(value));
 }
 
+template <template<class> class PROMISE, class T>
+template <class ITER, class V, class>
+void IThreadPromise<PROMISE, T>::pushBatch(ITER first, ITER last)
+{
+    static_cast<Impl*>(this)->template pushBatch(first, last);
+}
+
 template <template<class> class PROMISE, class T>
 template <class V, class>
 int IThreadPromise<PROMISE, T>::closeBuffer()
@@ -47,6 +61,13 @@ int IThreadPromise<PROMISE, T>::closeBuffer()
     return static_cast<Impl*>(this)->template closeBuffer();
 }
 
+template <template<class> class PROMISE, class T>
+template <class V, class>
+int IThreadPromise<PROMISE, T>::setBufferCapacity(size_t capacity)
+{
+    return static_cast<Impl*>(this)->template setBufferCapacity(capacity);
+}
+
 //==============================================================================================
 //                                class ICoroPromise
 //==============================================================================================
@@ -64,6 +85,13 @@ void ICoroPromise<PROMISE, T>::push(ICoroSync::Ptr sync, V&& value)
     static_cast<Impl*>(this)->template push(sync, std::forward<V>(value));
 }
 
+template <template<class> class PROMISE, class T>
+template <class ITER, class V, class>
+void ICoroPromise<PROMISE, T>::pushBatch(ICoroSync::Ptr sync, ITER first, ITER last)
+{
+    static_cast<Impl*>(this)->template pushBatch(sync, first, last);
+}
+
 template <template<class> class PROMISE, class T>
 template <class V, class>
 int ICoroPromise<PROMISE, T>::closeBuffer()
@@ -71,6 +99,13 @@ int ICoroPromise<PROMISE, T>::closeBuffer()
     return static_cast<Impl*>(this)->template closeBuffer();
 }
 
+template <template<class> class PROMISE, class T>
+template <class V, class>
+int ICoroPromise<PROMISE, T>::setBufferCapacity(size_t capacity)
+{
+    return static_cast<Impl*>(this)->template setBufferCapacity(capacity);
+}
+
 //==============================================================================================
 //                                class Promise
 //==============================================================================================
@@ -79,19 +114,27 @@ int ICoroPromise<PROMISE, T>::closeBuffer()
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using PromiseAllocator = HeapAllocator<Promise<int>>;
+        using PromiseAllocator = HeapAllocator<SharedBlock<Promise<int>>>;
     #else
-        using PromiseAllocator = StackAllocator<Promise<int>, __QUANTUM_PROMISE_ALLOC_SIZE>;
+        using PromiseAllocator = StackAllocator<SharedBlock<Promise<int>>, __QUANTUM_PROMISE_ALLOC_SIZE>;
     #endif
 #else
-    using PromiseAllocator = StlAllocator<Promise<int>>;
+    using PromiseAllocator = StlAllocator<SharedBlock<Promise<int>>>;
 #endif
 
+struct PromisePool
+{
+    static PromiseAllocator& instance()
+    {
+        return Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize());
+    }
+};
+
 template <class T>
 Promise<T>::Promise() :
     IThreadPromise<Promise, T>(this),
     ICoroPromise<Promise, T>(this),
-    _sharedState(new SharedState<T>()),
+    _sharedState(allocateShared<SharedState<T>>()),
     _terminated(ATOMIC_FLAG_INIT)
 {}
 
@@ -123,6 +166,13 @@ int Promise<T>::setException(std::exception_ptr ex)
     return _sharedState->setException(ex);
 }
 
+template <class T>
+bool Promise<T>::onSet(std::function<void()> callback)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->onSet(std::move(callback));
+}
+
 template <class T>
 IThreadFutureBase::Ptr Promise<T>::getIThreadFutureBase() const
 {
@@ -145,6 +195,14 @@ int Promise<T>::set(V&& value)
     return _sharedState->set(std::forward<V>(value));
 }
 
+template <class T>
+template <class... ARGS, class V, class>
+int Promise<T>::emplace(ARGS&&... args)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->emplace(std::forward<ARGS>(args)...);
+}
+
 template <class T>
 ThreadFuturePtr<T> Promise<T>::getIThreadFuture() const
 {
@@ -167,6 +225,14 @@ CoroFuturePtr<T> Promise<T>::getICoroFuture() const
     return FuturePtr<T>(new Future<T>(_sharedState), Future<T>::deleter);
 }
 
+template <class T>
+template <class V>
+SharedFuture<NonBufferRetType<V>> Promise<T>::getSharedFuture() const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return SharedFuture<T>(_sharedState);
+}
+
 template <class T>
 template <class V, class>
 void Promise<T>::push(V&& value)
@@ -184,33 +250,42 @@ void Promise<T>::push(ICoroSync::Ptr sync, V&& value)
 }
 
 template <class T>
-template <class V, class>
-int Promise<T>::closeBuffer()
+template <class ITER, class V, class>
+void Promise<T>::pushBatch(ITER first, ITER last)
 {
     if (!_sharedState) ThrowFutureException(FutureState::NoState);
-    return _sharedState->template closeBuffer();
+    _sharedState->pushBatch(first, last);
 }
 
 template <class T>
-void* Promise<T>::operator new(size_t)
+template <class ITER, class V, class>
+void Promise<T>::pushBatch(ICoroSync::Ptr sync, ITER first, ITER last)
 {
-    return Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).allocate();
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->pushBatch(sync, first, last);
 }
 
 template <class T>
-void Promise<T>::operator delete(void* p)
+template <class V, class>
+int Promise<T>::closeBuffer()
 {
-    Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).deallocate(static_cast<Promise<int>*>(p));
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->template closeBuffer();
 }
 
 template <class T>
-void Promise<T>::deleter(Promise<T>* p)
+template <class V, class>
+int Promise<T>::setBufferCapacity(size_t capacity)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).dispose(reinterpret_cast<Promise<int>*>(p));
-#else
-    delete p;
-#endif
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->setCapacity(capacity);
+}
+
+template <class T>
+template <class ... ARGS>
+typename Promise<T>::Ptr Promise<T>::create(ARGS&&... args)
+{
+    return allocateShared<Promise<T>, PromisePool>(std::forward<ARGS>(args)...);
 }
 
 }}
@@ -25,133 +25,399 @@ namespace quantum {
 inline
 QueueStatistics::QueueStatistics()
 {
-    reset();
+}
+
+inline
+QueueStatistics::QueueStatistics(const QueueStatistics& other) :
+    IQueueStatistics(other)
+{
+    copy(other);
+}
+
+inline
+QueueStatistics& QueueStatistics::operator=(const QueueStatistics& other)
+{
+    if (this != &other)
+    {
+        copy(other);
+    }
+    return *this;
+}
+
+inline
+QueueStatistics QueueStatistics::snapshot() const
+{
+    return *this;
+}
+
+inline
+void QueueStatistics::copy(const QueueStatistics& other)
+{
+    //read the counters of the completed tasks first
+    copyCounter(_consumer._dequeuedCount, other._consumer._dequeuedCount);
+    copyCounter(_consumer._errorCount, other._consumer._errorCount);
+    copyCounter(_consumer._sharedQueueErrorCount, other._consumer._sharedQueueErrorCount);
+    copyCounter(_consumer._completedCount, other._consumer._completedCount);
+    copyCounter(_consumer._sharedQueueCompletedCount, other._consumer._sharedQueueCompletedCount);
+    copyCounter(_consumer._stolenCount, other._consumer._stolenCount);
+    copyCounter(_consumer._migratedCount, other._consumer._migratedCount);
+    copyCounter(_consumer._expiredCount, other._consumer._expiredCount);
+    copyCounter(_consumer._cancelledCount, other._consumer._cancelledCount);
+    copyCounter(_consumer._longSliceCount, other._consumer._longSliceCount);
+    copyCounter(_consumer._resumeCount, other._consumer._resumeCount);
+    copyCounter(_consumer._yieldCount, other._consumer._yieldCount);
+    copyCounter(_consumer._taskTimeNs, other._consumer._taskTimeNs);
+    copyCounter(_consumer._schedulerTimeNs, other._consumer._schedulerTimeNs);
+    copyCounter(_producer._postedCount, other._producer._postedCount);
+    copyCounter(_producer._highPriorityCount, other._producer._highPriorityCount);
+    copyCounter(_producer._enqueuedCount, other._producer._enqueuedCount);
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(other._histogramLock);
+    _queueWaitTimeNs = other._queueWaitTimeNs;
+    _runTimeNs = other._runTimeNs;
+    _numResumes = other._numResumes;
+}
+
+inline
+void QueueStatistics::copyCounter(std::atomic_size_t& counter, const std::atomic_size_t& other)
+{
+    counter.store(other.load(std::memory_order_acquire), std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::reset()
 {
-    _numElements = 0;
-    _errorCount = 0;
-    _sharedQueueErrorCount = 0;
-    _completedCount = 0;
-    _sharedQueueCompletedCount = 0;
-    _postedCount = 0;
-    _highPriorityCount = 0;
+    _consumer._errorCount.store(0, std::memory_order_relaxed);
+    _consumer._sharedQueueErrorCount.store(0, std::memory_order_relaxed);
+    _consumer._completedCount.store(0, std::memory_order_relaxed);
+    _consumer._sharedQueueCompletedCount.store(0, std::memory_order_relaxed);
+    _consumer._stolenCount.store(0, std::memory_order_relaxed);
+    _consumer._migratedCount.store(0, std::memory_order_relaxed);
+    _consumer._expiredCount.store(0, std::memory_order_relaxed);
+    _consumer._cancelledCount.store(0, std::memory_order_relaxed);
+    _consumer._longSliceCount.store(0, std::memory_order_relaxed);
+    _consumer._resumeCount.store(0, std::memory_order_relaxed);
+    _consumer._yieldCount.store(0, std::memory_order_relaxed);
+    _consumer._taskTimeNs.store(0, std::memory_order_relaxed);
+    _consumer._schedulerTimeNs.store(0, std::memory_order_relaxed);
+    _producer._postedCount.store(0, std::memory_order_relaxed);
+    _producer._highPriorityCount.store(0, std::memory_order_relaxed);
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_histogramLock);
+    _queueWaitTimeNs.reset();
+    _runTimeNs.reset();
+    _numResumes.reset();
 }
 
 inline
 size_t QueueStatistics::numElements() const
 {
-    return _numElements;
+    //an element is always counted as enqueued before it is counted as dequeued
+    size_t dequeued = _consumer._dequeuedCount.load(std::memory_order_acquire);
+    size_t enqueued = _producer._enqueuedCount.load(std::memory_order_acquire);
+    return (enqueued > dequeued) ? enqueued - dequeued : 0;
 }
 
 inline
 void QueueStatistics::incNumElements()
 {
-    ++_numElements;
+    _producer._enqueuedCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::decNumElements()
 {
-    --_numElements;
+    _consumer._dequeuedCount.fetch_add(1, std::memory_order_release);
 }
 
 inline
 size_t QueueStatistics::errorCount() const
 {
-    return _errorCount;
+    return _consumer._errorCount.load(std::memory_order_acquire);
 }
 
 inline
 void QueueStatistics::incErrorCount()
 {
-    ++_errorCount;
+    _consumer._errorCount.fetch_add(1, std::memory_order_release);
 }
 
 inline
 size_t QueueStatistics::sharedQueueErrorCount() const
 {
-    return _sharedQueueErrorCount;
+    return _consumer._sharedQueueErrorCount.load(std::memory_order_acquire);
 }
 
 inline
 void QueueStatistics::incSharedQueueErrorCount()
 {
-    ++_sharedQueueErrorCount;
+    _consumer._sharedQueueErrorCount.fetch_add(1, std::memory_order_release);
 }
 
 inline
 size_t QueueStatistics::completedCount() const
 {
-    return _completedCount;
+    return _consumer._completedCount.load(std::memory_order_acquire);
 }
 
 inline
 void QueueStatistics::incCompletedCount()
 {
-    ++_completedCount;
+    _consumer._completedCount.fetch_add(1, std::memory_order_release);
 }
 
 inline
 size_t QueueStatistics::sharedQueueCompletedCount() const
 {
-    return _sharedQueueCompletedCount;
+    return _consumer._sharedQueueCompletedCount.load(std::memory_order_acquire);
 }
 
 inline
 void QueueStatistics::incSharedQueueCompletedCount()
 {
-    ++_sharedQueueCompletedCount;
+    _consumer._sharedQueueCompletedCount.fetch_add(1, std::memory_order_release);
 }
 
 inline
 size_t QueueStatistics::postedCount() const
 {
-    return _postedCount;
+    return _producer._postedCount.load(std::memory_order_acquire);
 }
 
 inline
 void QueueStatistics::incPostedCount()
 {
-    ++_postedCount;
+    _producer._postedCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 inline
 size_t QueueStatistics::highPriorityCount() const
 {
-    return _highPriorityCount;
+    return _producer._highPriorityCount.load(std::memory_order_acquire);
 }
 
 inline
 void QueueStatistics::incHighPriorityCount()
 {
-    ++_highPriorityCount;
+    _producer._highPriorityCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline
+size_t QueueStatistics::stolenCount() const
+{
+    return _consumer._stolenCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incStolenCount()
+{
+    _consumer._stolenCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::migratedCount() const
+{
+    return _consumer._migratedCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incMigratedCount()
+{
+    _consumer._migratedCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::expiredCount() const
+{
+    return _consumer._expiredCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incExpiredCount()
+{
+    _consumer._expiredCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::cancelledCount() const
+{
+    return _consumer._cancelledCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incCancelledCount()
+{
+    _consumer._cancelledCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::longSliceCount() const
+{
+    return _consumer._longSliceCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incLongSliceCount()
+{
+    _consumer._longSliceCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::resumeCount() const
+{
+    return _consumer._resumeCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incResumeCount()
+{
+    _consumer._resumeCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::yieldCount() const
+{
+    return _consumer._yieldCount.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::incYieldCount()
+{
+    _consumer._yieldCount.fetch_add(1, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::taskTimeNs() const
+{
+    return _consumer._taskTimeNs.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::addTaskTimeNs(size_t value)
+{
+    _consumer._taskTimeNs.fetch_add(value, std::memory_order_release);
+}
+
+inline
+size_t QueueStatistics::schedulerTimeNs() const
+{
+    return _consumer._schedulerTimeNs.load(std::memory_order_acquire);
+}
+
+inline
+void QueueStatistics::addSchedulerTimeNs(size_t value)
+{
+    _consumer._schedulerTimeNs.fetch_add(value, std::memory_order_release);
+}
+
+inline
+const Histogram& QueueStatistics::queueWaitTimeNs() const
+{
+    return _queueWaitTimeNs;
+}
+
+inline
+void QueueStatistics::recordQueueWaitTimeNs(uint64_t value)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_histogramLock);
+    _queueWaitTimeNs.record(value);
+}
+
+inline
+const Histogram& QueueStatistics::runTimeNs() const
+{
+    return _runTimeNs;
+}
+
+inline
+void QueueStatistics::recordRunTimeNs(uint64_t value)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_histogramLock);
+    _runTimeNs.record(value);
+}
+
+inline
+const Histogram& QueueStatistics::numResumes() const
+{
+    return _numResumes;
+}
+
+inline
+void QueueStatistics::recordNumResumes(uint64_t value)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_histogramLock);
+    _numResumes.record(value);
 }
 
 inline
 void QueueStatistics::print(std::ostream& out) const
 {
-    out << "Num elemetns: " << _numElements << std::endl;
-    out << "Num queued: " << _errorCount << std::endl;
-    out << "Num completed: " << _completedCount << std::endl;
-    out << "Num shared completed: " << _sharedQueueCompletedCount << std::endl;
-    out << "Num errors: " << _errorCount << std::endl;
-    out << "Num shared errors: " << _sharedQueueErrorCount << std::endl;
-    out << "Num high priority count: " << _highPriorityCount << std::endl;
+    QueueStatistics stats = snapshot();
+    out << "Num elemetns: " << stats.numElements() << std::endl;
+    out << "Num queued: " << stats.postedCount() << std::endl;
+    out << "Num completed: " << stats.completedCount() << std::endl;
+    out << "Num shared completed: " << stats.sharedQueueCompletedCount() << std::endl;
+    out << "Num errors: " << stats.errorCount() << std::endl;
+    out << "Num shared errors: " << stats.sharedQueueErrorCount() << std::endl;
+    out << "Num high priority count: " << stats.highPriorityCount() << std::endl;
+    out << "Num stolen: " << stats.stolenCount() << std::endl;
+    out << "Num migrated: " << stats.migratedCount() << std::endl;
+    out << "Num expired: " << stats.expiredCount() << std::endl;
+    out << "Num cancelled: " << stats.cancelledCount() << std::endl;
+    out << "Num long slices: " << stats.longSliceCount() << std::endl;
+    out << "Num resumes: " << stats.resumeCount() << std::endl;
+    out << "Num yields: " << stats.yieldCount() << std::endl;
+    if (stats.taskTimeNs() + stats.schedulerTimeNs() > 0)
+    {
+        out << "Task time (ns): " << stats.taskTimeNs() << std::endl;
+        out << "Scheduler time (ns): " << stats.schedulerTimeNs() << std::endl;
+    }
+    if (stats._queueWaitTimeNs.count() > 0)
+    {
+        out << "Queue wait time (ns): " << stats._queueWaitTimeNs << std::endl;
+    }
+    if (stats._runTimeNs.count() > 0)
+    {
+        out << "Run time (ns): " << stats._runTimeNs << std::endl;
+        out << "Resumes per coroutine: " << stats._numResumes << std::endl;
+    }
 }
 
 inline
 QueueStatistics& QueueStatistics::operator+=(const IQueueStatistics& rhs)
 {
-    _numElements += rhs.numElements();
-    _errorCount += rhs.errorCount();
-    _sharedQueueErrorCount += rhs.sharedQueueErrorCount();
-    _completedCount += rhs.completedCount();
-    _sharedQueueCompletedCount += rhs.sharedQueueCompletedCount();
-    _postedCount += rhs.postedCount();
-    _highPriorityCount += rhs.highPriorityCount();
+    //take a snapshot of the histograms if the queue is still running
+    const QueueStatistics* queueStats = dynamic_cast<const QueueStatistics*>(&rhs);
+    QueueStatistics stats;
+    if (queueStats)
+    {
+        stats = *queueStats;
+    }
+    const IQueueStatistics& other = queueStats ? static_cast<const IQueueStatistics&>(stats) : rhs;
+    _consumer._errorCount += other.errorCount();
+    _consumer._sharedQueueErrorCount += other.sharedQueueErrorCount();
+    _consumer._completedCount += other.completedCount();
+    _consumer._sharedQueueCompletedCount += other.sharedQueueCompletedCount();
+    _consumer._stolenCount += other.stolenCount();
+    _consumer._migratedCount += other.migratedCount();
+    _consumer._expiredCount += other.expiredCount();
+    _consumer._cancelledCount += other.cancelledCount();
+    _consumer._longSliceCount += other.longSliceCount();
+    _consumer._resumeCount += other.resumeCount();
+    _consumer._yieldCount += other.yieldCount();
+    _consumer._taskTimeNs += other.taskTimeNs();
+    _consumer._schedulerTimeNs += other.schedulerTimeNs();
+    _producer._postedCount += other.postedCount();
+    _producer._highPriorityCount += other.highPriorityCount();
+    _producer._enqueuedCount += other.numElements();
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_histogramLock);
+    _queueWaitTimeNs += other.queueWaitTimeNs();
+    _runTimeNs += other.runTimeNs();
+    _numResumes += other.numResumes();
     return *this;
 }
 
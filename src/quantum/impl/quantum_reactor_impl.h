@@ -0,0 +1,261 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+Reactor::Reactor() :
+    _epollFd(::epoll_create1(EPOLL_CLOEXEC)),
+    _eventFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+    _isInterrupted(false),
+    _terminated(ATOMIC_FLAG_INIT)
+{
+    if ((_epollFd < 0) || (_eventFd < 0))
+    {
+        int error = errno;
+        if (_epollFd >= 0) ::close(_epollFd);
+        if (_eventFd >= 0) ::close(_eventFd);
+        throw std::runtime_error(std::string("Cannot create reactor: ") + std::strerror(error));
+    }
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = _eventFd;
+    ::epoll_ctl(_epollFd, EPOLL_CTL_ADD, _eventFd, &event);
+    _thread = std::thread(std::bind(&Reactor::run, this));
+}
+
+inline
+Reactor::~Reactor()
+{
+    terminate();
+}
+
+inline
+void Reactor::terminate()
+{
+    if (!_terminated.test_and_set())
+    {
+        _isInterrupted = true;
+        uint64_t value = 1;
+        ssize_t rc = ::write(_eventFd, &value, sizeof(value));
+        (void)rc;
+        _thread.join();
+        std::unordered_map<int, Entry> entries;
+        {
+            //========================= LOCKED SCOPE =========================
+            std::lock_guard<std::mutex> lock(_mutex);
+            entries.swap(_entries);
+        }
+        std::exception_ptr ex = std::make_exception_ptr(std::runtime_error("Reactor terminated"));
+        for (auto&& entry : entries)
+        {
+            if (entry.second._reader) entry.second._reader->setException(ex);
+            if (entry.second._writer) entry.second._writer->setException(ex);
+        }
+        ::close(_eventFd);
+        ::close(_epollFd);
+    }
+}
+
+inline
+void Reactor::await(int fd, Direction direction, PromisePtr<int> promise)
+{
+    if (_isInterrupted)
+    {
+        throw std::runtime_error("Reactor terminated");
+    }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _entries[fd];
+    PromisePtr<int>& waiter = (direction == Direction::Read) ? entry._reader : entry._writer;
+    if (waiter)
+    {
+        throw std::runtime_error("Already waiting on file descriptor");
+    }
+    waiter = promise;
+    try
+    {
+        update(fd, entry);
+    }
+    catch (...)
+    {
+        waiter = nullptr;
+        if (!entry._reader && !entry._writer)
+        {
+            _entries.erase(fd);
+        }
+        throw;
+    }
+}
+
+inline
+bool Reactor::cancel(int fd, Direction direction)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(fd);
+    if (it == _entries.end())
+    {
+        return false;
+    }
+    PromisePtr<int>& waiter = (direction == Direction::Read) ? it->second._reader : it->second._writer;
+    if (!waiter)
+    {
+        return false;
+    }
+    waiter = nullptr;
+    update(fd, it->second);
+    if (!it->second._isRegistered)
+    {
+        _entries.erase(it);
+    }
+    return true;
+}
+
+inline
+size_t Reactor::size() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+inline
+void Reactor::update(int fd, Entry& entry)
+{
+    struct epoll_event event{};
+    event.events = static_cast<uint32_t>(EPOLLONESHOT) |
+                   (entry._reader ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+                   (entry._writer ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.fd = fd;
+    if (!entry._reader && !entry._writer)
+    {
+        if (entry._isRegistered)
+        {
+            ::epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, &event);
+            entry._isRegistered = false;
+        }
+        return;
+    }
+    //Interest is one-shot so the descriptor has to be re-armed after every event
+    int rc = ::epoll_ctl(_epollFd, entry._isRegistered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+    if ((rc != 0) && entry._isRegistered && (errno == ENOENT))
+    {
+        //The descriptor was closed and its number reused since it was last armed
+        rc = ::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+    if (rc != 0)
+    {
+        entry._isRegistered = false;
+        throw std::runtime_error(std::string("Cannot watch file descriptor: ") + std::strerror(errno));
+    }
+    entry._isRegistered = true;
+}
+
+inline
+void Reactor::run()
+{
+    std::vector<struct epoll_event> events(64);
+    std::vector<std::pair<PromisePtr<int>, int>> ready;
+    while (!_isInterrupted)
+    {
+        int num = ::epoll_wait(_epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (num < 0)
+        {
+            continue; //EINTR
+        }
+        {
+            //========================= LOCKED SCOPE =========================
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (int i = 0; i < num; ++i)
+            {
+                int fd = events[i].data.fd;
+                if (fd == _eventFd)
+                {
+                    continue;
+                }
+                auto it = _entries.find(fd);
+                if (it == _entries.end())
+                {
+                    continue;
+                }
+                Entry& entry = it->second;
+                entry._isRegistered = true; //still in the epoll set, only disarmed
+                uint32_t mask = events[i].events;
+                //Errors and hang-ups complete both directions so that the next read or write reports them
+                if (entry._reader && (mask & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP)))
+                {
+                    ready.emplace_back(std::move(entry._reader), static_cast<int>(mask));
+                    entry._reader = nullptr;
+                }
+                if (entry._writer && (mask & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+                {
+                    ready.emplace_back(std::move(entry._writer), static_cast<int>(mask));
+                    entry._writer = nullptr;
+                }
+                try
+                {
+                    update(fd, entry); //re-arm the remaining interest or remove the descriptor
+                }
+                catch (...)
+                {
+                    if (entry._reader) ready.emplace_back(std::move(entry._reader), -1);
+                    if (entry._writer) ready.emplace_back(std::move(entry._writer), -1);
+                    entry._reader = nullptr;
+                    entry._writer = nullptr;
+                    update(fd, entry);
+                }
+                if (!entry._reader && !entry._writer)
+                {
+                    _entries.erase(it);
+                }
+            }
+        }
+        //Resume the coroutines outside the lock
+        for (auto&& waiter : ready)
+        {
+            if (waiter.second < 0)
+            {
+                waiter.first->setException(std::make_exception_ptr(std::runtime_error("Cannot watch file descriptor")));
+            }
+            else
+            {
+                waiter.first->set(waiter.second);
+            }
+        }
+        ready.clear();
+        if (num == static_cast<int>(events.size()))
+        {
+            events.resize(events.size() * 2);
+        }
+    }
+}
+
+}}
@@ -0,0 +1,274 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <thread>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+ReadWriteMutex::ReadWriteMutex(Preference preference) :
+    _isWriterPending(false),
+    _preference(preference)
+{
+}
+
+inline
+void ReadWriteMutex::lockRead()
+{
+    lockReadImpl(YieldingThread());
+}
+
+inline
+void ReadWriteMutex::lockRead(ICoroSync::Ptr sync)
+{
+    lockReadImpl(sync->getYieldHandle());
+}
+
+inline
+bool ReadWriteMutex::tryLockRead()
+{
+    return tryAcquireRead(_readers[slotIndex()]._count);
+}
+
+inline
+void ReadWriteMutex::unlockRead()
+{
+    _readers[slotIndex()]._count.fetch_sub(1, std::memory_order_release);
+}
+
+inline
+void ReadWriteMutex::lockWrite()
+{
+    _writerMutex.lock();
+    lockWriteImpl(YieldingThread());
+}
+
+inline
+void ReadWriteMutex::lockWrite(ICoroSync::Ptr sync)
+{
+    _writerMutex.lock(sync);
+    lockWriteImpl(sync->getYieldHandle());
+}
+
+inline
+bool ReadWriteMutex::tryLockWrite()
+{
+    if (!_writerMutex.tryLock())
+    {
+        return false;
+    }
+    _isWriterPending.store(true, std::memory_order_seq_cst);
+    if (numReaders() == 0)
+    {
+        return true;
+    }
+    _isWriterPending.store(false, std::memory_order_release);
+    _writerMutex.unlock();
+    return false;
+}
+
+inline
+void ReadWriteMutex::unlockWrite()
+{
+    _isWriterPending.store(false, std::memory_order_release);
+    _writerMutex.unlock();
+}
+
+inline
+size_t ReadWriteMutex::numReaders() const
+{
+    size_t count = 0;
+    for (auto&& slot : _readers)
+    {
+        count += slot._count.load(std::memory_order_seq_cst);
+    }
+    return count;
+}
+
+inline
+bool ReadWriteMutex::isWriteLocked() const
+{
+    return _isWriterPending.load(std::memory_order_acquire);
+}
+
+inline
+size_t ReadWriteMutex::slotIndex()
+{
+    //Each thread is assigned a reader slot once. Running coroutines never migrate between threads
+    //so a read lock is always released on the slot it was acquired on.
+    static std::atomic_size_t nextSlot{0};
+    static thread_local size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % NumReaderSlots;
+    return slot;
+}
+
+inline
+bool ReadWriteMutex::tryAcquireRead(std::atomic_size_t& slot)
+{
+    //Announce the reader first, then check for a writer. The writer does the opposite
+    //so at least one of them always observes the other.
+    slot.fetch_add(1, std::memory_order_seq_cst);
+    if (!_isWriterPending.load(std::memory_order_seq_cst))
+    {
+        return true;
+    }
+    slot.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+
+template <class YIELDING>
+void ReadWriteMutex::lockReadImpl(YIELDING&& yield)
+{
+    std::atomic_size_t& slot = _readers[slotIndex()]._count;
+    while (!tryAcquireRead(slot))
+    {
+        while (_isWriterPending.load(std::memory_order_acquire))
+        {
+            yield();
+        }
+    }
+}
+
+template <class YIELDING>
+void ReadWriteMutex::lockWriteImpl(YIELDING&& yield)
+{
+    //Called with the writer mutex held
+    while (true)
+    {
+        _isWriterPending.store(true, std::memory_order_seq_cst);
+        if (_preference == Preference::Writers)
+        {
+            //New readers are held back, wait for active ones to leave
+            while (numReaders() != 0)
+            {
+                yield();
+            }
+            return;
+        }
+        if (numReaders() == 0)
+        {
+            return;
+        }
+        //Back off while readers are active
+        _isWriterPending.store(false, std::memory_order_release);
+        while (numReaders() != 0)
+        {
+            yield();
+        }
+    }
+}
+
+inline
+ReadWriteMutex::ReadGuard::ReadGuard(ReadWriteMutex& mutex,
+                                     bool tryLock) :
+    _mutex(mutex),
+    _ownsLock(true)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLockRead();
+    }
+    else
+    {
+        _mutex.lockRead();
+    }
+}
+
+inline
+ReadWriteMutex::ReadGuard::ReadGuard(ICoroSync::Ptr sync,
+                                     ReadWriteMutex& mutex,
+                                     bool tryLock) :
+    _mutex(mutex),
+    _ownsLock(true)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLockRead();
+    }
+    else
+    {
+        _mutex.lockRead(sync);
+    }
+}
+
+inline
+ReadWriteMutex::ReadGuard::~ReadGuard()
+{
+    if (_ownsLock)
+    {
+        _mutex.unlockRead();
+    }
+}
+
+inline
+bool ReadWriteMutex::ReadGuard::ownsLock() const
+{
+    return _ownsLock;
+}
+
+inline
+ReadWriteMutex::WriteGuard::WriteGuard(ReadWriteMutex& mutex,
+                                       bool tryLock) :
+    _mutex(mutex),
+    _ownsLock(true)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLockWrite();
+    }
+    else
+    {
+        _mutex.lockWrite();
+    }
+}
+
+inline
+ReadWriteMutex::WriteGuard::WriteGuard(ICoroSync::Ptr sync,
+                                       ReadWriteMutex& mutex,
+                                       bool tryLock) :
+    _mutex(mutex),
+    _ownsLock(true)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLockWrite();
+    }
+    else
+    {
+        _mutex.lockWrite(sync);
+    }
+}
+
+inline
+ReadWriteMutex::WriteGuard::~WriteGuard()
+{
+    if (_ownsLock)
+    {
+        _mutex.unlockWrite();
+    }
+}
+
+inline
+bool ReadWriteMutex::WriteGuard::ownsLock() const
+{
+    return _ownsLock;
+}
+
+}}
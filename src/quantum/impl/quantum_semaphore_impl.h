@@ -0,0 +1,132 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     class Semaphore
+//==============================================================================================
+inline
+Semaphore::Semaphore(size_t count) :
+    _count(count)
+{}
+
+inline
+void Semaphore::acquire()
+{
+    while (!tryAcquire())
+    {
+        _waiters.wait([this]()->bool{ return _count == 0; });
+    }
+}
+
+inline
+void Semaphore::acquire(ICoroSync::Ptr sync)
+{
+    while (!tryAcquire())
+    {
+        _waiters.wait(sync, [this]()->bool{ return _count == 0; });
+    }
+}
+
+inline
+bool Semaphore::tryAcquire()
+{
+    size_t count = _count.load(std::memory_order_relaxed);
+    while (count != 0)
+    {
+        if (_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline
+void Semaphore::release(size_t num)
+{
+    _count.fetch_add(num, std::memory_order_seq_cst);
+    if (_waiters.hasWaiters())
+    {
+        _waiters.notify(num);
+    }
+}
+
+inline
+size_t Semaphore::count() const
+{
+    return _count.load(std::memory_order_acquire);
+}
+
+//==============================================================================================
+//                                  class Semaphore::Guard
+//==============================================================================================
+inline
+Semaphore::Guard::Guard(Semaphore& semaphore,
+                        bool tryAcquire) :
+    _semaphore(semaphore),
+    _ownsPermit(true)
+{
+    if (tryAcquire)
+    {
+        _ownsPermit = _semaphore.tryAcquire();
+    }
+    else
+    {
+        _semaphore.acquire();
+    }
+}
+
+inline
+Semaphore::Guard::Guard(ICoroSync::Ptr sync,
+                        Semaphore& semaphore,
+                        bool tryAcquire) :
+    _semaphore(semaphore),
+    _ownsPermit(true)
+{
+    if (tryAcquire)
+    {
+        _ownsPermit = _semaphore.tryAcquire();
+    }
+    else
+    {
+        _semaphore.acquire(sync);
+    }
+}
+
+inline
+Semaphore::Guard::~Guard()
+{
+    if (_ownsPermit)
+    {
+        _semaphore.release();
+    }
+}
+
+inline
+bool Semaphore::Guard::ownsPermit() const
+{
+    return _ownsPermit;
+}
+
+}}
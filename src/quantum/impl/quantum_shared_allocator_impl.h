@@ -0,0 +1,97 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+template <typename T, typename POOL>
+template <typename P>
+constexpr bool SharedAllocator<T, POOL>::fitsPool(std::enable_if_t<!std::is_void<P>::value, long>)
+{
+    using Block = typename std::decay_t<decltype(P::instance())>::value_type;
+    return (sizeof(T) <= sizeof(Block)) && (alignof(T) <= alignof(Block));
+}
+
+template <typename T, typename POOL>
+T* SharedAllocator<T, POOL>::allocate(size_t n)
+{
+    return allocate(n, std::integral_constant<bool, fitsPool()>());
+}
+
+template <typename T, typename POOL>
+void SharedAllocator<T, POOL>::deallocate(T* p, size_t n)
+{
+    deallocate(p, n, std::integral_constant<bool, fitsPool()>());
+}
+
+template <typename T, typename POOL>
+T* SharedAllocator<T, POOL>::allocate(size_t n, std::true_type)
+{
+    if (n != 1) {
+        return std::allocator<T>().allocate(n);
+    }
+    return reinterpret_cast<T*>(POOL::instance().allocate(1));
+}
+
+template <typename T, typename POOL>
+T* SharedAllocator<T, POOL>::allocate(size_t n, std::false_type)
+{
+    return std::allocator<T>().allocate(n);
+}
+
+template <typename T, typename POOL>
+void SharedAllocator<T, POOL>::deallocate(T* p, size_t n, std::true_type)
+{
+    using Block = typename std::decay_t<decltype(POOL::instance())>::value_type;
+    if (n != 1) {
+        std::allocator<T>().deallocate(p, n);
+        return;
+    }
+    POOL::instance().deallocate(reinterpret_cast<Block*>(p), 1);
+}
+
+template <typename T, typename POOL>
+void SharedAllocator<T, POOL>::deallocate(T* p, size_t n, std::false_type)
+{
+    std::allocator<T>().deallocate(p, n);
+}
+
+template <typename T, typename POOL>
+template <typename U, typename ... ARGS>
+void SharedAllocator<T, POOL>::construct(U* p, ARGS&&... args)
+{
+    new (static_cast<void*>(p)) U(std::forward<ARGS>(args)...);
+}
+
+template <typename T, typename POOL>
+template <typename U>
+void SharedAllocator<T, POOL>::destroy(U* p)
+{
+    p->~U();
+}
+
+template <typename T, typename POOL, typename ... ARGS>
+std::shared_ptr<T> allocateShared(ARGS&&... args)
+{
+    return std::allocate_shared<T>(SharedAllocator<T, POOL>(), std::forward<ARGS>(args)...);
+}
+
+}}
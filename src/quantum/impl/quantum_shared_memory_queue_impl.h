@@ -0,0 +1,349 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <quantum/interface/quantum_itask.h>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+SharedMemoryQueue::SharedMemoryQueue(const std::string& name,
+                                     size_t capacity,
+                                     size_t maxPayloadSize,
+                                     int mode) :
+    _name(name)
+{
+    if (maxPayloadSize > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::invalid_argument("Payload size too large");
+    }
+#if defined(__linux__)
+    bool isCreator = true;
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, mode);
+    if ((fd < 0) && (errno == EEXIST))
+    {
+        isCreator = false;
+        fd = ::shm_open(name.c_str(), O_RDWR, mode);
+    }
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Cannot open shared memory segment " + name);
+    }
+    //The creator may still be sizing or initializing the segment
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    if (isCreator)
+    {
+        _segmentSize = segmentSize(capacity, maxPayloadSize);
+        if (::ftruncate(fd, _segmentSize) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error(error, std::generic_category(), "Cannot size shared memory segment " + name);
+        }
+    }
+    else
+    {
+        struct stat info;
+        while ((::fstat(fd, &info) == 0) && (info.st_size == 0) && (std::chrono::steady_clock::now() < deadline))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        _segmentSize = info.st_size;
+    }
+    void* region = (_segmentSize >= sizeof(Header)) ?
+        ::mmap(nullptr, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    int error = errno;
+    ::close(fd);
+    if (region == MAP_FAILED)
+    {
+        if (isCreator)
+        {
+            ::shm_unlink(name.c_str());
+        }
+        throw std::system_error(error, std::generic_category(), "Cannot map shared memory segment " + name);
+    }
+    _header = static_cast<Header*>(region);
+    _slots = static_cast<char*>(region) + sizeof(Header);
+    if (isCreator)
+    {
+        initialize(capacity, maxPayloadSize);
+        return;
+    }
+    while ((_header->_magic.load(std::memory_order_acquire) != Magic) && (std::chrono::steady_clock::now() < deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    try
+    {
+        validate(capacity, maxPayloadSize);
+    }
+    catch (...)
+    {
+        ::munmap(_header, _segmentSize);
+        throw;
+    }
+#else
+    (void)capacity;
+    (void)mode;
+    throw std::system_error(std::make_error_code(std::errc::not_supported), "Shared memory queues are not supported");
+#endif
+}
+
+inline
+SharedMemoryQueue::~SharedMemoryQueue()
+{
+#if defined(__linux__)
+    ::munmap(_header, _segmentSize);
+#endif
+}
+
+inline
+bool SharedMemoryQueue::remove(const std::string& name)
+{
+#if defined(__linux__)
+    return ::shm_unlink(name.c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+inline
+void SharedMemoryQueue::registerHandler(uint32_t functionId, Handler handler)
+{
+    _handlers[functionId] = std::move(handler);
+}
+
+inline
+bool SharedMemoryQueue::tryPost(uint32_t functionId, const void* payload, size_t size)
+{
+    if (size > _header->_maxPayloadSize)
+    {
+        throw std::invalid_argument("Payload larger than the maximum payload size");
+    }
+    uint64_t pos = _header->_pushPos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& current = slot(pos);
+        uint64_t sequence = current._sequence.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)sequence - (int64_t)pos;
+        if (diff == 0)
+        {
+            //The slot is free for this position. Claim it.
+            if (_header->_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                current._functionId = functionId;
+                current._size = static_cast<uint32_t>(size);
+                if (size)
+                {
+                    std::memcpy(this->payload(current), payload, size);
+                }
+                current._sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; //full
+        }
+        else
+        {
+            pos = _header->_pushPos.load(std::memory_order_relaxed); //another producer got there first
+        }
+    }
+}
+
+inline
+bool SharedMemoryQueue::tryPop(Message& message)
+{
+    uint64_t pos = _header->_popPos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& current = slot(pos);
+        uint64_t sequence = current._sequence.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)sequence - (int64_t)(pos + 1);
+        if (diff == 0)
+        {
+            //Leave the message in place if this process cannot run it. Another consumer may.
+            uint32_t functionId = current._functionId;
+            auto it = _handlers.find(functionId);
+            if ((it == _handlers.end()) || !it->second)
+            {
+                return false;
+            }
+            //The slot holds the message for this position. Claim it.
+            if (_header->_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                //The size comes from another process: never trust it beyond the slot capacity
+                uint32_t size = current._size;
+                if (size > _header->_maxPayloadSize)
+                {
+                    current._sequence.store(pos + _header->_mask + 1, std::memory_order_release);
+                    _numRejected.fetch_add(1, std::memory_order_relaxed);
+                    pos = _header->_popPos.load(std::memory_order_relaxed);
+                    continue;
+                }
+                //Copy the message out so that the slot is not held while the handler runs
+                message._functionId = functionId;
+                message._payload.assign(payload(current), payload(current) + size);
+                current._sequence.store(pos + _header->_mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; //empty
+        }
+        else
+        {
+            pos = _header->_popPos.load(std::memory_order_relaxed); //another consumer got there first
+        }
+    }
+}
+
+inline
+int SharedMemoryQueue::run(const Message& message) const
+{
+    auto it = _handlers.find(message._functionId);
+    if ((it == _handlers.end()) || !it->second)
+    {
+        return (int)ITask::RetCode::NotCallable;
+    }
+    return it->second(message._payload.data(), message._payload.size());
+}
+
+inline
+size_t SharedMemoryQueue::size() const
+{
+    uint64_t popPos = _header->_popPos.load(std::memory_order_relaxed);
+    uint64_t pushPos = _header->_pushPos.load(std::memory_order_relaxed);
+    return (pushPos > popPos) ? pushPos - popPos : 0;
+}
+
+inline
+size_t SharedMemoryQueue::numRejected() const
+{
+    return _numRejected.load(std::memory_order_relaxed);
+}
+
+inline
+size_t SharedMemoryQueue::capacity() const
+{
+    return _header->_mask + 1;
+}
+
+inline
+size_t SharedMemoryQueue::maxPayloadSize() const
+{
+    return _header->_maxPayloadSize;
+}
+
+inline
+const std::string& SharedMemoryQueue::name() const
+{
+    return _name;
+}
+
+inline
+size_t SharedMemoryQueue::roundUp(size_t capacity)
+{
+    size_t value = 2;
+    while (value < capacity)
+    {
+        value <<= 1;
+    }
+    return value;
+}
+
+inline
+size_t SharedMemoryQueue::slotSize(size_t maxPayloadSize)
+{
+    return (sizeof(Slot) + maxPayloadSize + CacheLineSize - 1) & ~(CacheLineSize - 1);
+}
+
+inline
+size_t SharedMemoryQueue::segmentSize(size_t capacity, size_t maxPayloadSize)
+{
+    return sizeof(Header) + (roundUp(capacity) * slotSize(maxPayloadSize));
+}
+
+inline
+void SharedMemoryQueue::initialize(size_t capacity, size_t maxPayloadSize)
+{
+    //The segment is zero-filled, so constructing the atomics in place only sets the fields below
+    new (_header) Header();
+    _header->_version = Version;
+    _header->_mask = roundUp(capacity) - 1;
+    _header->_slotSize = slotSize(maxPayloadSize);
+    _header->_maxPayloadSize = maxPayloadSize;
+    _header->_pushPos.store(0, std::memory_order_relaxed);
+    _header->_popPos.store(0, std::memory_order_relaxed);
+    for (uint64_t i = 0; i <= _header->_mask; ++i)
+    {
+        Slot* current = new (_slots + (i * _header->_slotSize)) Slot();
+        current->_sequence.store(i, std::memory_order_relaxed);
+    }
+    _header->_magic.store(Magic, std::memory_order_release);
+}
+
+inline
+void SharedMemoryQueue::validate(size_t capacity, size_t maxPayloadSize) const
+{
+    if (_header->_magic.load(std::memory_order_acquire) != Magic)
+    {
+        throw std::runtime_error("Shared memory segment " + _name + " is not initialized");
+    }
+    if ((_header->_version != Version) ||
+        (_header->_mask != roundUp(capacity) - 1) ||
+        (_header->_slotSize != slotSize(maxPayloadSize)) ||
+        (_header->_maxPayloadSize != maxPayloadSize) ||
+        (_segmentSize != segmentSize(capacity, maxPayloadSize)))
+    {
+        throw std::runtime_error("Shared memory segment " + _name + " has a different layout");
+    }
+}
+
+inline
+SharedMemoryQueue::Slot& SharedMemoryQueue::slot(uint64_t pos) const
+{
+    return *reinterpret_cast<Slot*>(_slots + ((pos & _header->_mask) * _header->_slotSize));
+}
+
+inline
+char* SharedMemoryQueue::payload(Slot& slot) const
+{
+    return reinterpret_cast<char*>(&slot) + sizeof(Slot);
+}
+
+}}
@@ -27,26 +27,33 @@ namespace quantum {
 //==============================================================================================
 template <class T>
 SharedState<T>::SharedState() :
+    _mutex(LockProfiler::site<SharedState>("SharedState")),
+    _status(Pending),
     _state(FutureState::PromiseNotSatisfied),
-    _value(T())
+    _hasValue(false)
 {
 }
 
+template <class T>
+SharedState<T>::~SharedState()
+{
+    if (_hasValue)
+    {
+        value().~T();
+    }
+}
+
 template <class T>
 template <class V>
 int SharedState<T>::set(V&& value)
 {
+    if (!claim())
     {
-        //========= LOCKED SCOPE =========
-        Mutex::Guard lock(_mutex);
-        if (_state != FutureState::PromiseNotSatisfied)
-        {
-            ThrowFutureException(_state);
-        }
-        _value = std::forward<V>(value);
-        _state = FutureState::PromiseAlreadySatisfied;
+        ThrowFutureException(FutureState::PromiseAlreadySatisfied);
     }
-    _cond.notifyAll();
+    construct(std::forward<V>(value));
+    _state = FutureState::PromiseAlreadySatisfied;
+    publish();
     return 0;
 }
 
@@ -54,90 +61,112 @@ template <class T>
 template <class V>
 int SharedState<T>::set(ICoroSync::Ptr sync, V&& value)
 {
+    if (!claim())
     {
-        //========= LOCKED SCOPE =========
-        Mutex::Guard lock(sync, _mutex);
-        if (_state != FutureState::PromiseNotSatisfied)
-        {
-            ThrowFutureException(_state);
-        }
-        _value = std::forward<V>(value);
-        _state = FutureState::PromiseAlreadySatisfied;
+        ThrowFutureException(FutureState::PromiseAlreadySatisfied);
     }
-    _cond.notifyAll();
+    construct(std::forward<V>(value));
+    _state = FutureState::PromiseAlreadySatisfied;
+    publish(sync);
+    return 0;
+}
+
+template <class T>
+template <class... ARGS>
+int SharedState<T>::emplace(ARGS&&... args)
+{
+    if (!claim())
+    {
+        ThrowFutureException(FutureState::PromiseAlreadySatisfied);
+    }
+    construct(std::forward<ARGS>(args)...);
+    _state = FutureState::PromiseAlreadySatisfied;
+    publish();
     return 0;
 }
 
 template <class T>
 T SharedState<T>::get()
 {
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
     conditionWait();
-    _state = FutureState::FutureAlreadyRetrieved;
-    return std::move(_value);
+    return retrieve();
 }
 
 template <class T>
 const T& SharedState<T>::getRef() const
 {
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
     conditionWait();
-    return _value;
+    return value();
 }
 
 template <class T>
 T SharedState<T>::get(ICoroSync::Ptr sync)
 {
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(sync, _mutex);
     conditionWait(sync);
-    _state = FutureState::FutureAlreadyRetrieved;
-    return std::move(_value);
+    return retrieve();
 }
 
 template <class T>
 const T& SharedState<T>::getRef(ICoroSync::Ptr sync) const
 {
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(sync, _mutex);
     conditionWait(sync);
-    return _value;
+    return value();
+}
+
+template <class T>
+template<class REP, class PERIOD>
+bool SharedState<T>::getFor(ICoroSync::Ptr sync,
+                            const std::chrono::duration<REP, PERIOD> &time,
+                            T& value)
+{
+    if (waitFor(sync, time) == std::future_status::timeout)
+    {
+        return false;
+    }
+    checkPromiseState();
+    value = retrieve();
+    return true;
 }
 
 template <class T>
 void SharedState<T>::breakPromise()
 {
-    {//========= LOCKED SCOPE =========
-        Mutex::Guard lock(_mutex);
-        if (_state == FutureState::PromiseNotSatisfied)
-        {
-            _state = FutureState::BrokenPromise;
-        }
+    if (claim())
+    {
+        _state = FutureState::BrokenPromise;
+        publish();
     }
-    _cond.notifyAll();
 }
 
 template <class T>
 void SharedState<T>::wait() const
 {
+    if (isReady())
+    {
+        return;
+    }
     //========= LOCKED SCOPE =========
     Mutex::Guard lock(_mutex);
+    _status.fetch_or(HasWaiters, std::memory_order_acq_rel);
     _cond.wait(_mutex, [this]()->bool
     {
-        return stateHasChanged();
+        return isReady();
     });
 }
 
 template <class T>
 void SharedState<T>::wait(ICoroSync::Ptr sync) const
 {
+    if (isReady())
+    {
+        return;
+    }
     //========= LOCKED SCOPE =========
     Mutex::Guard lock(sync, _mutex);
+    _status.fetch_or(HasWaiters, std::memory_order_acq_rel);
     _cond.wait(sync, _mutex, [this]()->bool
     {
-        return stateHasChanged();
+        return isReady();
     });
 }
 
@@ -145,13 +174,18 @@ template <class T>
 template<class REP, class PERIOD>
 std::future_status SharedState<T>::waitFor(const std::chrono::duration<REP, PERIOD> &time) const
 {
+    if (isReady())
+    {
+        return std::future_status::ready;
+    }
     //========= LOCKED SCOPE =========
     Mutex::Guard lock(_mutex);
+    _status.fetch_or(HasWaiters, std::memory_order_acq_rel);
     _cond.waitFor(_mutex, time, [this]()->bool
     {
-        return stateHasChanged();
+        return isReady();
     });
-    return _state == FutureState::PromiseNotSatisfied ? std::future_status::timeout : std::future_status::ready;
+    return isReady() ? std::future_status::ready : std::future_status::timeout;
 }
 
 template <class T>
@@ -159,23 +193,28 @@ template<class REP, class PERIOD>
 std::future_status SharedState<T>::waitFor(ICoroSync::Ptr sync,
                                            const std::chrono::duration<REP, PERIOD> &time) const
 {
+    if (isReady())
+    {
+        return std::future_status::ready;
+    }
     //========= LOCKED SCOPE =========
     Mutex::Guard lock(sync, _mutex);
+    _status.fetch_or(HasWaiters, std::memory_order_acq_rel);
     _cond.waitFor(sync, _mutex, time, [this]()->bool
     {
-        return stateHasChanged();
+        return isReady();
     });
-    return _state == FutureState::PromiseNotSatisfied ? std::future_status::timeout : std::future_status::ready;
+    return isReady() ? std::future_status::ready : std::future_status::timeout;
 }
 
 template <class T>
 int SharedState<T>::setException(std::exception_ptr ex)
 {
-    {//========= LOCKED SCOPE =========
-        Mutex::Guard lock(_mutex);
+    if (claim())
+    {
         _exception = ex;
+        publish();
     }
-    _cond.notifyAll();
     return -1;
 }
 
@@ -183,31 +222,182 @@ template <class T>
 int SharedState<T>::setException(ICoroSync::Ptr sync,
                                  std::exception_ptr ex)
 {
-    {//========= LOCKED SCOPE =========
-        Mutex::Guard lock(sync, _mutex);
+    if (claim())
+    {
         _exception = ex;
+        publish(sync);
     }
-    _cond.notifyAll();
     return -1;
 }
 
 template <class T>
-void SharedState<T>::conditionWait() const
+bool SharedState<T>::claim()
 {
-    _cond.wait(_mutex, [this]()->bool
+    //Only one caller may satisfy the promise
+    int status = _status.load(std::memory_order_relaxed);
+    do
     {
-        return stateHasChanged();
-    });
+        if ((status & PhaseMask) != Pending)
+        {
+            return false;
+        }
+    }
+    while (!_status.compare_exchange_weak(status, status | Setting, std::memory_order_acquire, std::memory_order_relaxed));
+    return true;
+}
+
+template <class T>
+void SharedState<T>::onReady(std::function<void()> callback)
+{
+    if (!isReady())
+    {
+        //========= LOCKED SCOPE =========
+        Mutex::Guard lock(_mutex);
+        _status.fetch_or(HasWaiters, std::memory_order_acq_rel);
+        if (!isReady())
+        {
+            _callbacks.emplace_back(std::move(callback));
+            return;
+        }
+    }
+    invokeCallback(callback);
+}
+
+template <class T>
+bool SharedState<T>::onSet(std::function<void()> callback)
+{
+    _onSet = std::move(callback);
+    return true;
+}
+
+template <class T>
+void SharedState<T>::publish()
+{
+    QUANTUM_TRACE(Tracer::Event::Set, this, IQueue::QueueType::All, (int)IQueue::QueueId::All);
+    if (_onSet)
+    {
+        //Runs before readers can observe the state. Released here so that captures don't outlive it.
+        std::function<void()> callback;
+        callback.swap(_onSet);
+        invokeCallback(callback);
+    }
+    //Setting -> Ready. Readers which set HasWaiters before this point are blocked or about to block
+    //while holding the mutex, so acquire it before notifying.
+    if (_status.fetch_add(Ready - Setting, std::memory_order_acq_rel) & HasWaiters)
+    {
+        std::vector<std::function<void()>> callbacks;
+        {
+            //========= LOCKED SCOPE =========
+            Mutex::Guard lock(_mutex);
+            callbacks.swap(_callbacks);
+        }
+        _cond.notifyAll();
+        for (auto&& callback : callbacks)
+        {
+            invokeCallback(callback);
+        }
+    }
+}
+
+template <class T>
+void SharedState<T>::publish(ICoroSync::Ptr sync)
+{
+    QUANTUM_TRACE(Tracer::Event::Set, this, IQueue::QueueType::All, (int)IQueue::QueueId::All);
+    if (_onSet)
+    {
+        //Runs before readers can observe the state. Released here so that captures don't outlive it.
+        std::function<void()> callback;
+        callback.swap(_onSet);
+        invokeCallback(callback);
+    }
+    if (_status.fetch_add(Ready - Setting, std::memory_order_acq_rel) & HasWaiters)
+    {
+        std::vector<std::function<void()>> callbacks;
+        {
+            //========= LOCKED SCOPE =========
+            Mutex::Guard lock(sync, _mutex);
+            callbacks.swap(_callbacks);
+        }
+        _cond.notifyAll();
+        for (auto&& callback : callbacks)
+        {
+            invokeCallback(callback);
+        }
+    }
+}
+
+template <class T>
+void SharedState<T>::invokeCallback(const std::function<void()>& callback)
+{
+    try
+    {
+        callback();
+    }
+    catch (...)
+    {
+        //Callbacks run on behalf of whoever satisfied the promise, don't propagate
+    }
+}
+
+template <class T>
+bool SharedState<T>::isReady() const
+{
+    return (_status.load(std::memory_order_acquire) & PhaseMask) == Ready;
+}
+
+template <class T>
+T SharedState<T>::retrieve()
+{
+    FutureState state = FutureState::PromiseAlreadySatisfied;
+    if (!_state.compare_exchange_strong(state, FutureState::FutureAlreadyRetrieved))
+    {
+        ThrowFutureException(state);
+    }
+    return std::move(value());
+}
+
+template <class T>
+template <class... ARGS>
+void SharedState<T>::construct(ARGS&&... args)
+{
+    //Only called by the thread which claimed the state
+    try
+    {
+        new (&_storage) T(std::forward<ARGS>(args)...);
+    }
+    catch (...)
+    {
+        //the future receives the exception instead of waiting forever on a claimed state
+        _exception = std::current_exception();
+        publish();
+        throw;
+    }
+    _hasValue = true;
+}
+
+template <class T>
+T& SharedState<T>::value()
+{
+    return *reinterpret_cast<T*>(&_storage);
+}
+
+template <class T>
+const T& SharedState<T>::value() const
+{
+    return *reinterpret_cast<const T*>(&_storage);
+}
+
+template <class T>
+void SharedState<T>::conditionWait() const
+{
+    wait();
     checkPromiseState();
 }
 
 template <class T>
 void SharedState<T>::conditionWait(ICoroSync::Ptr sync) const
 {
-    _cond.wait(sync, _mutex, [this]()->bool
-    {
-        return stateHasChanged();
-    });
+    wait(sync);
     checkPromiseState();
 }
 
@@ -224,17 +414,12 @@ void SharedState<T>::checkPromiseState() const
     }
 }
 
-template <class T>
-bool SharedState<T>::stateHasChanged() const
-{
-    return (_state != FutureState::PromiseNotSatisfied) || (_exception != nullptr);
-}
-
 //==============================================================================================
 //                       class SharedState<Buffer> (partial specialization)
 //==============================================================================================
 template <class T>
 SharedState<Buffer<T>>::SharedState() :
+    _mutex(LockProfiler::site<SharedState>("SharedState")),
     _state(FutureState::PromiseNotSatisfied)
 {
 }
@@ -355,6 +540,11 @@ void SharedState<Buffer<T>>::push(V&& value)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_mutex);
+        //bounded buffers block the producer until the consumer catches up
+        _cond.wait(_mutex, [this]()->bool
+        {
+            return canPush();
+        });
         if ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData))
         {
             ThrowFutureException(_state);
@@ -375,6 +565,11 @@ void SharedState<Buffer<T>>::push(ICoroSync::Ptr sync, V&& value)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(sync, _mutex);
+        //bounded buffers block the producer until the consumer catches up
+        _cond.wait(sync, _mutex, [this]()->bool
+        {
+            return canPush();
+        });
         if ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData))
         {
             ThrowFutureException(_state);
@@ -389,30 +584,52 @@ void SharedState<Buffer<T>>::push(ICoroSync::Ptr sync, V&& value)
     _cond.notifyAll();
 }
 
+template <class T>
+template <class ITER>
+void SharedState<Buffer<T>>::pushBatch(ITER first, ITER last)
+{
+    while (first != last)
+    {
+        {//========= LOCKED SCOPE =========
+            Mutex::Guard lock(_mutex);
+            _cond.wait(_mutex, [this]()->bool
+            {
+                return canPush();
+            });
+            first = pushAvailable(first, last);
+        }
+        _cond.notifyAll(); //once per locked section
+    }
+}
+
+template <class T>
+template <class ITER>
+void SharedState<Buffer<T>>::pushBatch(ICoroSync::Ptr sync, ITER first, ITER last)
+{
+    while (first != last)
+    {
+        {//========= LOCKED SCOPE =========
+            Mutex::Guard lock(sync, _mutex);
+            _cond.wait(sync, _mutex, [this]()->bool
+            {
+                return canPush();
+            });
+            first = pushAvailable(first, last);
+        }
+        _cond.notifyAll(); //once per locked section
+    }
+}
+
 template <class T>
 T SharedState<Buffer<T>>::pull(bool& isBufferClosed)
 {
     T out;
     if (!_reader.empty())
     {
-        T out;
         _reader.pull(out);
         return out;
     }
-    {//========= LOCKED SCOPE =========
-        Mutex::Guard lock(_mutex);
-        _cond.wait(_mutex, [this]()->bool
-        {
-            BufferStatus status = _writer.empty() ?
-                (_writer.isClosed() ? BufferStatus::Closed : BufferStatus::DataPending) : BufferStatus::DataPosted;
-            bool changed = stateHasChanged(status);
-            if (changed) {
-                // Move the writer to the reader for consumption
-                _reader = std::move(_writer);
-            }
-            return changed;
-        });
-    }
+    waitForData();
     isBufferClosed = _reader.empty() && _reader.isClosed();
     if (isBufferClosed) {
         //Mark the future as fully retrieved
@@ -430,31 +647,129 @@ T SharedState<Buffer<T>>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     T out;
     if (!_reader.empty())
     {
-        T out;
         _reader.pull(out);
         return out;
     }
+    waitForData(sync);
+    isBufferClosed = _reader.empty() && _reader.isClosed();
+    if (isBufferClosed) {
+        //Mark the future as fully retrieved
+        _state = FutureState::FutureAlreadyRetrieved;
+        return out;
+    }
+    _reader.pull(out);
+    checkPromiseState();
+    return out;
+}
+
+template <class T>
+std::vector<T> SharedState<Buffer<T>>::pullBatch(size_t maxItems, bool& isBufferClosed)
+{
+    if (_reader.empty())
+    {
+        waitForData();
+    }
+    return pullAvailable(maxItems, isBufferClosed);
+}
+
+template <class T>
+std::vector<T> SharedState<Buffer<T>>::pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed)
+{
+    if (_reader.empty())
+    {
+        waitForData(sync);
+    }
+    return pullAvailable(maxItems, isBufferClosed);
+}
+
+template <class T>
+void SharedState<Buffer<T>>::waitForData()
+{
+    bool wasFull = false;
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_mutex);
-        _cond.wait(sync, _mutex, [this]()->bool
+        _cond.wait(_mutex, [this, &wasFull]()->bool
         {
             BufferStatus status = _writer.empty() ?
                 (_writer.isClosed() ? BufferStatus::Closed : BufferStatus::DataPending) : BufferStatus::DataPosted;
             bool changed = stateHasChanged(status);
             if (changed) {
                 // Move the writer to the reader for consumption
-                _reader = std::move(_writer);
+                wasFull = transfer();
             }
             return changed;
         });
     }
+    if (wasFull)
+    {
+        _cond.notifyAll(); //resume the producer
+    }
+}
+
+template <class T>
+void SharedState<Buffer<T>>::waitForData(ICoroSync::Ptr sync)
+{
+    bool wasFull = false;
+    {//========= LOCKED SCOPE =========
+        Mutex::Guard lock(sync, _mutex);
+        _cond.wait(sync, _mutex, [this, &wasFull]()->bool
+        {
+            BufferStatus status = _writer.empty() ?
+                (_writer.isClosed() ? BufferStatus::Closed : BufferStatus::DataPending) : BufferStatus::DataPosted;
+            bool changed = stateHasChanged(status);
+            if (changed) {
+                // Move the writer to the reader for consumption
+                wasFull = transfer();
+            }
+            return changed;
+        });
+    }
+    if (wasFull)
+    {
+        _cond.notifyAll(); //resume the producer
+    }
+}
+
+template <class T>
+template <class ITER>
+ITER SharedState<Buffer<T>>::pushAvailable(ITER first, ITER last)
+{
+    if ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData))
+    {
+        ThrowFutureException(_state);
+    }
+    for (; first != last; ++first)
+    {
+        BufferStatus status = _writer.push(*first);
+        if (status == BufferStatus::Full)
+        {
+            break; //wait for the consumer
+        }
+        if (status == BufferStatus::Closed)
+        {
+            ThrowFutureException(FutureState::BufferClosed);
+        }
+        _state = FutureState::BufferingData;
+    }
+    return first;
+}
+
+template <class T>
+std::vector<T> SharedState<Buffer<T>>::pullAvailable(size_t maxItems, bool& isBufferClosed)
+{
+    std::vector<T> out;
     isBufferClosed = _reader.empty() && _reader.isClosed();
     if (isBufferClosed) {
         //Mark the future as fully retrieved
         _state = FutureState::FutureAlreadyRetrieved;
         return out;
     }
-    _reader.pull(out);
+    out.reserve(std::min(maxItems, _reader.size()));
+    T value;
+    while ((out.size() < maxItems) && (_reader.pull(value) == BufferStatus::DataReceived))
+    {
+        out.emplace_back(std::move(value));
+    }
     checkPromiseState();
     return out;
 }
@@ -474,6 +789,49 @@ int SharedState<Buffer<T>>::closeBuffer()
     return 0;
 }
 
+template <class T>
+int SharedState<Buffer<T>>::setCapacity(size_t capacity)
+{
+    //========= LOCKED SCOPE =========
+    Mutex::Guard lock(_mutex);
+    if ((_state != FutureState::PromiseNotSatisfied) || !_reader.empty())
+    {
+        throw std::runtime_error("Buffer capacity must be set before pushing");
+    }
+    //Both sides are preallocated so that swapping them never allocates
+    _writer = Buffer<T>(capacity);
+    _reader = Buffer<T>(capacity);
+    return 0;
+}
+
+template <class T>
+bool SharedState<Buffer<T>>::onSet(std::function<void()> callback)
+{
+    UNUSED(callback);
+    return false;
+}
+
+template <class T>
+bool SharedState<Buffer<T>>::canPush() const
+{
+    return !_writer.isFull() ||
+           ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData)) ||
+           (_exception != nullptr);
+}
+
+template <class T>
+bool SharedState<Buffer<T>>::transfer()
+{
+    //The reader is empty at this point so the producer gets its storage back
+    bool wasFull = _writer.isFull();
+    std::swap(_reader, _writer);
+    if (_reader.isClosed())
+    {
+        _writer.close();
+    }
+    return wasFull;
+}
+
 template <class T>
 void SharedState<Buffer<T>>::checkPromiseState() const
 {
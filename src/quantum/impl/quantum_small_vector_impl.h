@@ -0,0 +1,147 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <new>
+
+namespace Bloomberg {
+namespace quantum {
+
+template <typename T, size_t N>
+SmallVector<T, N>::SmallVector(size_t count, const T& value)
+{
+    reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        emplace_back(value);
+    }
+}
+
+template <typename T, size_t N>
+SmallVector<T, N>::SmallVector(const SmallVector& other)
+{
+    *this = other;
+}
+
+template <typename T, size_t N>
+SmallVector<T, N>::SmallVector(SmallVector&& other)
+{
+    *this = std::move(other);
+}
+
+template <typename T, size_t N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(const SmallVector& other)
+{
+    if (this != &other) {
+        clear();
+        reserve(other._size);
+        for (const T& value : other) {
+            emplace_back(value);
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(SmallVector&& other)
+{
+    if (this != &other) {
+        clear();
+        if (other.isInline()) {
+            reserve(other._size);
+            for (T& value : other) {
+                emplace_back(std::move(value));
+            }
+            other.clear();
+        }
+        else {
+            //steal the heap buffer
+            if (!isInline()) {
+                ::operator delete(_data);
+            }
+            _data = other._data;
+            _size = other._size;
+            _capacity = other._capacity;
+            other._data = other.inlineData();
+            other._size = 0;
+            other._capacity = N;
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t N>
+SmallVector<T, N>::~SmallVector()
+{
+    clear();
+    if (!isInline()) {
+        ::operator delete(_data);
+    }
+}
+
+template <typename T, size_t N>
+template <typename ... ARGS>
+T& SmallVector<T, N>::emplace_back(ARGS&&... args)
+{
+    if (_size == _capacity) {
+        grow(_capacity * 2);
+    }
+    T* value = new (_data + _size) T(std::forward<ARGS>(args)...);
+    ++_size;
+    return *value;
+}
+
+template <typename T, size_t N>
+void SmallVector<T, N>::pop_back()
+{
+    _data[--_size].~T();
+}
+
+template <typename T, size_t N>
+void SmallVector<T, N>::clear()
+{
+    while (_size > 0) {
+        pop_back();
+    }
+}
+
+template <typename T, size_t N>
+void SmallVector<T, N>::reserve(size_t capacity)
+{
+    if (capacity > _capacity) {
+        grow(capacity);
+    }
+}
+
+template <typename T, size_t N>
+void SmallVector<T, N>::grow(size_t capacity)
+{
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T must be nothrow move constructible");
+    T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+    for (size_t i = 0; i < _size; ++i) {
+        new (data + i) T(std::move(_data[i]));
+        _data[i].~T();
+    }
+    if (!isInline()) {
+        ::operator delete(_data);
+    }
+    _data = data;
+    _capacity = capacity;
+}
+
+}}
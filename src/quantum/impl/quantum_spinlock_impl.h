@@ -18,31 +18,117 @@
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
+#include <thread>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace Bloomberg {
 namespace quantum {
 
 inline
 SpinLock::SpinLock() :
-    _flag(ATOMIC_FLAG_INIT)
+    _flag(false)
+#ifdef __QUANTUM_PROFILE_LOCKS
+    , _site(nullptr)
+#endif
 {}
 
+inline
+SpinLock::SpinLock(const LockSite& site) :
+    _flag(false)
+#ifdef __QUANTUM_PROFILE_LOCKS
+    , _site(&site)
+#endif
+{
+    (void)site;
+}
+
 inline
 void SpinLock::lock()
 {
-    while (_flag.test_and_set(std::memory_order_acquire)); //spin
+    size_t backoff = 1;
+    size_t spins = 0;
+    size_t yields = 0;
+    bool isContended = false;
+    while (_flag.exchange(true, std::memory_order_acquire))
+    {
+        isContended = true;
+        //Spin locally until the lock looks free before attempting another exchange
+        do
+        {
+            if (backoff <= MaxBackoff)
+            {
+                for (size_t i = 0; i < backoff; ++i)
+                {
+                    pause();
+                }
+                spins += backoff;
+                backoff <<= 1;
+            }
+            else
+            {
+                std::this_thread::yield();
+                ++yields;
+            }
+        }
+        while (_flag.load(std::memory_order_relaxed));
+    }
+    profile(isContended, spins, yields);
 }
 
 inline
 bool SpinLock::tryLock()
 {
-    return !_flag.test_and_set(std::memory_order_acquire);
+    bool isLocked = !_flag.load(std::memory_order_relaxed) &&
+                    !_flag.exchange(true, std::memory_order_acquire);
+#ifdef __QUANTUM_PROFILE_LOCKS
+    if (_site)
+    {
+        if (isLocked)
+        {
+            _site->record(false, 0, 0);
+        }
+        else
+        {
+            _site->recordFailure();
+        }
+    }
+#endif
+    return isLocked;
+}
+
+inline
+void SpinLock::profile(bool isContended, size_t spins, size_t yields) const
+{
+#ifdef __QUANTUM_PROFILE_LOCKS
+    if (_site)
+    {
+        _site->record(isContended, spins, yields);
+    }
+#else
+    (void)isContended;
+    (void)spins;
+    (void)yields;
+#endif
 }
 
 inline
 void SpinLock::unlock()
 {
-    _flag.clear(std::memory_order_release);
+    _flag.store(false, std::memory_order_release);
+}
+
+inline
+void SpinLock::pause()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
 }
 
 inline
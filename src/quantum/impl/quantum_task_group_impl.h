@@ -0,0 +1,233 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+template <class RET>
+TaskGroup::TaskGroup(std::shared_ptr<ICoroContext<RET>> ctx) :
+    _sync(ctx),
+    _dispatcher(static_cast<Context<RET>&>(*ctx)._dispatcher),
+    _queueId(static_cast<Context<RET>&>(*ctx)._task->getQueueId()),
+    _state(std::make_shared<State>())
+{
+    if (ctx->isCancelled())
+    {
+        //the children of a cancelled coroutine must not run either
+        _state->_token->cancel();
+    }
+}
+
+inline
+TaskGroup::~TaskGroup()
+{
+    try
+    {
+        wait();
+    }
+    catch (...)
+    {
+        //failures are reported by wait() or by the contexts of the children
+    }
+}
+
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+TaskGroup::post(FUNC&& func, ARGS&&... args)
+{
+    return post<OTHER_RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+TaskGroup::post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Same)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    auto capture = makeCapture(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    auto ctx = Context<OTHER_RET>::create(*_dispatcher);
+    //Inherited by the tasks the child posts. The child itself is not dropped by its queue since
+    //it must run to count itself as completed.
+    ctx->setCancellationToken(_state->_token);
+    auto task = Task::create(ctx,
+                             (queueId == (int)IQueue::QueueId::Same) ? _queueId : queueId,
+                             isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal,
+                             ITask::Type::Standalone,
+                             CoroChild<OTHER_RET, decltype(capture)>{_state, std::move(capture)});
+    ctx->setTask(task);
+    _state->_numPending.fetch_add(1, std::memory_order_relaxed);
+    try
+    {
+        _dispatcher->post(task);
+    }
+    catch (...)
+    {
+        _state->complete();
+        throw;
+    }
+    return ctx;
+}
+
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+TaskGroup::postAsyncIo(FUNC&& func, ARGS&&... args)
+{
+    return postAsyncIo<OTHER_RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+TaskGroup::postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    auto capture = makeCapture(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    auto promise = Promise<OTHER_RET>::create();
+    auto task = IoTask::Ptr(new IoTask(promise,
+                                       queueId,
+                                       isHighPriority ? (int)IQueue::Priority::High : (int)IQueue::Priority::Normal,
+                                       IoChild<OTHER_RET, decltype(capture)>{_state, std::move(capture)}),
+                            IoTask::deleter);
+    _state->_numPending.fetch_add(1, std::memory_order_relaxed);
+    try
+    {
+        _dispatcher->postAsyncIo(task);
+    }
+    catch (...)
+    {
+        _state->complete();
+        throw;
+    }
+    return promise->getICoroFuture();
+}
+
+inline
+void TaskGroup::wait()
+{
+    if (_state->_numPending.load(std::memory_order_acquire) != 0)
+    {
+        _state->_waiters.wait(_sync, [this]()->bool{ return _state->_numPending != 0; });
+    }
+    std::exception_ptr ex;
+    {
+        SpinLock::Guard lock(_state->_lock);
+        ex = _state->_exception;
+    }
+    if (ex)
+    {
+        std::rethrow_exception(ex);
+    }
+}
+
+inline
+void TaskGroup::cancel()
+{
+    _state->_token->cancel();
+}
+
+inline
+bool TaskGroup::isCancelled() const
+{
+    return _state->_token->isCancelled();
+}
+
+inline
+size_t TaskGroup::size() const
+{
+    return _state->_numPending.load(std::memory_order_acquire);
+}
+
+inline
+void TaskGroup::State::fail(std::exception_ptr ex)
+{
+    {
+        SpinLock::Guard lock(_lock);
+        if (!_exception)
+        {
+            _exception = ex;
+        }
+    }
+    _token->cancel();
+}
+
+inline
+void TaskGroup::State::complete()
+{
+    //Only the last child wakes up the parent
+    if ((_numPending.fetch_sub(1, std::memory_order_seq_cst) == 1) && _waiters.hasWaiters())
+    {
+        _waiters.notifyAll();
+    }
+}
+
+template <class OTHER_RET, class CAPTURE>
+int TaskGroup::CoroChild<OTHER_RET, CAPTURE>::operator()(CoroContextPtr<OTHER_RET> ctx)
+{
+    struct Completion
+    {
+        ~Completion() { _state.complete(); }
+        State& _state;
+    } completion{*_state};
+    _state->_token->throwIfCancelled();
+    try
+    {
+        return _capture(std::move(ctx));
+    }
+    catch (const CancellationException&)
+    {
+        throw;
+    }
+    catch (...)
+    {
+        _state->fail(std::current_exception());
+        throw;
+    }
+}
+
+template <class OTHER_RET, class CAPTURE>
+int TaskGroup::IoChild<OTHER_RET, CAPTURE>::operator()(ThreadPromisePtr<OTHER_RET> promise)
+{
+    struct Completion
+    {
+        ~Completion() { _state.complete(); }
+        State& _state;
+    } completion{*_state};
+    _state->_token->throwIfCancelled();
+    try
+    {
+        return _capture(std::move(promise));
+    }
+    catch (const CancellationException&)
+    {
+        throw;
+    }
+    catch (...)
+    {
+        _state->fail(std::current_exception());
+        throw;
+    }
+}
+
+}}
@@ -20,6 +20,9 @@
 //##############################################################################################
 #include <quantum/quantum_allocator.h>
 #include <quantum/quantum_traits.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace Bloomberg {
 namespace quantum {
@@ -29,50 +32,122 @@ namespace quantum {
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using TaskAllocator = HeapAllocator<Task>;
+        using TaskAllocator = HeapAllocator<SharedBlock<Task>>;
     #else
-        using TaskAllocator = StackAllocator<Task, __QUANTUM_TASK_ALLOC_SIZE>;
+        using TaskAllocator = StackAllocator<SharedBlock<Task>, __QUANTUM_TASK_ALLOC_SIZE>;
     #endif
 #else
-    using TaskAllocator = StlAllocator<Task>;
+    using TaskAllocator = StlAllocator<SharedBlock<Task>>;
 #endif
 
+struct TaskPool
+{
+    static TaskAllocator& instance()
+    {
+        return Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize());
+    }
+};
+
 template <class RET, class FUNC, class ... ARGS>
 Task::Task(std::shared_ptr<Context<RET>> ctx,
            ITask::Type type,
            FUNC&& func,
            ARGS&&... args) :
     _ctx(ctx),
-    _coro(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()),
-          Util::bindCaller(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...)),
+#ifdef __QUANTUM_STATIC_DISPATCH
+    _state(ctx.get()),
+#endif
+    _coro{stackAllocator(ctx->getStackSize()), //braced init guarantees this is evaluated before the move below
+          Util::bindCaller(std::move(ctx), std::forward<FUNC>(func), std::forward<ARGS>(args)...)},
     _queueId((int)IQueue::QueueId::Any),
-    _isHighPriority(false),
+    _priority((int)IQueue::Priority::Normal),
+    _isPinned(false),
+    _isStarted(false),
+    _isParked(false),
+    _intakeNext(nullptr),
+    _deadline(std::chrono::high_resolution_clock::time_point::max()),
+    _readySinceNs(0),
+    _runTime(0),
+    _numResumes(0),
     _rc((int)ITask::RetCode::Running),
     _type(type),
-    _terminated(ATOMIC_FLAG_INIT)
+    _terminated(ATOMIC_FLAG_INIT),
+    _tag(CoroStackTag::current())
 {}
 
 template <class RET, class FUNC, class ... ARGS>
 Task::Task(std::shared_ptr<Context<RET>> ctx,
            int queueId,
-           bool isHighPriority,
+           int priority,
            ITask::Type type,
            FUNC&& func,
            ARGS&&... args) :
     _ctx(ctx),
-    _coro(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()),
-          Util::bindCaller(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...)),
+#ifdef __QUANTUM_STATIC_DISPATCH
+    _state(ctx.get()),
+#endif
+    _coro{stackAllocator(ctx->getStackSize()), //braced init guarantees this is evaluated before the move below
+          Util::bindCaller(std::move(ctx), std::forward<FUNC>(func), std::forward<ARGS>(args)...)},
     _queueId(queueId),
-    _isHighPriority(isHighPriority),
+    _priority(priority),
+    _isPinned(queueId != (int)IQueue::QueueId::Any),
+    _isStarted(false),
+    _isParked(false),
+    _intakeNext(nullptr),
+    _deadline(std::chrono::high_resolution_clock::time_point::max()),
+    _readySinceNs(0),
+    _runTime(0),
+    _numResumes(0),
     _rc((int)ITask::RetCode::Running),
     _type(type),
-    _terminated(ATOMIC_FLAG_INIT)
+    _terminated(ATOMIC_FLAG_INIT),
+    _tag(CoroStackTag::current())
 {}
 
+inline
+CoroStackAllocator& Task::stackAllocator(size_t stackSize)
+{
+    if (stackSize == 0) {
+        return Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize());
+    }
+    static constexpr size_t NumSizeClasses = sizeof(size_t) * 8;
+    static std::unique_ptr<CoroStackAllocator> allocators[NumSizeClasses];
+    static std::atomic<CoroStackAllocator*> cache[NumSizeClasses];
+    static std::mutex mutex;
+    
+    stackSize = std::max(stackSize, StackTraits::minimumSize());
+    if (!StackTraits::isUnbounded()) {
+        stackSize = std::min(stackSize, StackTraits::maximumSize());
+    }
+    size_t sizeClass = 0;
+    while (((size_t)1 << sizeClass) < stackSize) {
+        ++sizeClass;
+    }
+    CoroStackAllocator* allocator = cache[sizeClass].load(std::memory_order_acquire);
+    if (!allocator) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!allocators[sizeClass]) {
+#ifndef __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR
+            allocators[sizeClass].reset(new CoroStackAllocator(AllocatorTraits::defaultCoroPoolAllocSize(),
+                                                               (size_t)1 << sizeClass));
+#else
+            allocators[sizeClass].reset(new CoroStackAllocator((size_t)1 << sizeClass));
+#endif
+            cache[sizeClass].store(allocators[sizeClass].get(), std::memory_order_release);
+        }
+        allocator = allocators[sizeClass].get();
+    }
+    return *allocator;
+}
+
 inline
 Task::~Task()
 {
     terminate();
+    if (_registryEntry)
+    {
+        TaskRegistry::remove(*_registryEntry);
+    }
 }
 
 inline
@@ -89,6 +164,7 @@ int Task::run()
 {
     if (_coro)
     {
+        _isStarted = true;
         _coro(_rc);
         return _rc;
     }
@@ -151,41 +227,79 @@ ITaskContinuation::Ptr Task::getErrorHandlerOrFinalTask()
 inline
 bool Task::isBlocked() const
 {
+#ifdef __QUANTUM_STATIC_DISPATCH
+    return _state ? _state->isBlocked() : false; //coroutine is waiting on some signal
+#else
     return _ctx ? _ctx->isBlocked() : false; //coroutine is waiting on some signal
+#endif
 }
 
 inline
 bool Task::isSleeping(bool updateTimer)
 {
+#ifdef __QUANTUM_STATIC_DISPATCH
+    return _state ? _state->isSleeping(updateTimer) : false; //coroutine is sleeping
+#else
     return _ctx ? _ctx->isSleeping(updateTimer) : false; //coroutine is sleeping
+#endif
 }
 
 inline
 bool Task::isHighPriority() const
 {
-    return _isHighPriority;
+    return _priority > (int)IQueue::Priority::Normal;
 }
 
 inline
-void* Task::operator new(size_t)
+int Task::getPriority() const
 {
-    return Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).allocate();
+    return _priority;
 }
 
 inline
-void Task::operator delete(void* p)
+bool Task::isStealable() const
 {
-    Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).deallocate(static_cast<Task*>(p));
+    return !_isPinned && !_isStarted;
 }
 
 inline
-void Task::deleter(Task* p)
+std::chrono::high_resolution_clock::time_point Task::getSleepDeadline() const
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).dispose(p);
+#ifdef __QUANTUM_STATIC_DISPATCH
+    return _state ? _state->getSleepDeadline() : std::chrono::high_resolution_clock::time_point{};
 #else
-    delete p;
+    return _ctx ? _ctx->getSleepDeadline() : std::chrono::high_resolution_clock::time_point{};
 #endif
 }
 
+inline
+void Task::setDeadline(std::chrono::high_resolution_clock::time_point deadline)
+{
+    _deadline = deadline;
+}
+
+inline
+std::chrono::high_resolution_clock::time_point Task::getDeadline() const
+{
+    return _deadline;
+}
+
+inline
+void Task::setCancellationToken(CancellationToken::Ptr token)
+{
+    _cancellationToken = std::move(token);
+}
+
+inline
+const CancellationToken::Ptr& Task::getCancellationToken() const
+{
+    return _cancellationToken;
+}
+
+template <class ... ARGS>
+Task::Ptr Task::create(ARGS&&... args)
+{
+    return allocateShared<Task, TaskPool>(std::forward<ARGS>(args)...);
+}
+
 }}
@@ -29,24 +29,95 @@ TaskQueue::TaskQueue() :
 }
 
 inline
-TaskQueue::TaskQueue(const Configuration&) :
+TaskQueue::TaskQueue(const Configuration& config) :
     _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
+    _parkedQueue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
+    _intakeHead(nullptr),
+    _intakeSize(0),
     _queueIt(_queue.end()),
     _blockedIt(_queue.end()),
+    _spinlock(LockProfiler::site<TaskQueue>("TaskQueue")),
     _isEmpty(true),
     _isInterrupted(false),
     _isIdle(true),
     _terminated(ATOMIC_FLAG_INIT),
-    _isAdvanced(false)
+    _isAdvanced(false),
+    _isParkingEnabled(config.getParkBlockedCoroutines()),
+    _isWorkStealing(config.getCoroutineWorkStealing()),
+    _workStealingPollIntervalUs(config.getCoroutineWorkStealingPollIntervalUs()),
+    _migrationThreshold(config.getParkBlockedCoroutines() ? config.getCoroutineMigrationThreshold() : 0),
+    _siblingQueues(nullptr),
+    _idleSignal(nullptr),
+    _pendingTaskCounter(nullptr),
+    _idleSpinCount(config.getIdleSpinCount()),
+    _idleYieldCount(config.getIdleYieldCount()),
+    _idleCount(0),
+    _idleDeadline(TimePoint::max()),
+    _idleWakeUpCount(0),
+    _wakeUpCount(0),
+    _isIdleParked(false),
+    _collectLatencyHistograms(config.getCollectLatencyHistograms()),
+    _registry(config.getTrackTasks() ? std::make_shared<TaskRegistry>() : nullptr),
+    _isDeadlineScheduling(config.getCoroutineSchedulingPolicy() == Configuration::SchedulingPolicy::EarliestDeadlineFirst),
+    _isDroppingExpired(config.getDropExpiredCoroutines()),
+    _isInliningContinuations(config.getInlineContinuations()),
+    _isRestarted(false),
+    _queueId(0),
+    _isRetired(false),
+    _longSliceThresholdUs(config.getLongSliceThresholdUs()),
+    _longSliceCallback(config.getLongSliceCallback()),
+    _priorityWeights(config.getPriorityLevelWeights()),
+    _pass(0),
+    _maxWeightInPass(0),
+    _hasRunInPass(false)
 {
     _thread = std::make_shared<std::thread>(std::bind(&TaskQueue::run, this));
 }
 
 inline
-TaskQueue::TaskQueue(const TaskQueue&) :
-    TaskQueue()
+TaskQueue::TaskQueue(const TaskQueue& other) :
+    _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
+    _parkedQueue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
+    _intakeHead(nullptr),
+    _intakeSize(0),
+    _queueIt(_queue.end()),
+    _blockedIt(_queue.end()),
+    _spinlock(LockProfiler::site<TaskQueue>("TaskQueue")),
+    _isEmpty(true),
+    _isInterrupted(false),
+    _isIdle(true),
+    _terminated(ATOMIC_FLAG_INIT),
+    _isAdvanced(false),
+    _isParkingEnabled(other._isParkingEnabled),
+    _isWorkStealing(other._isWorkStealing),
+    _workStealingPollIntervalUs(other._workStealingPollIntervalUs),
+    _migrationThreshold(other._migrationThreshold),
+    _siblingQueues(nullptr),
+    _idleSignal(nullptr),
+    _pendingTaskCounter(nullptr),
+    _idleSpinCount(other._idleSpinCount),
+    _idleYieldCount(other._idleYieldCount),
+    _idleCount(0),
+    _idleDeadline(TimePoint::max()),
+    _idleWakeUpCount(0),
+    _wakeUpCount(0),
+    _isIdleParked(false),
+    _collectLatencyHistograms(other._collectLatencyHistograms),
+    _registry(other._registry ? std::make_shared<TaskRegistry>() : nullptr),
+    _isDeadlineScheduling(other._isDeadlineScheduling),
+    _isDroppingExpired(other._isDroppingExpired),
+    _isInliningContinuations(other._isInliningContinuations),
+    _isRestarted(false),
+    _queueId(0),
+    _isRetired(false),
+    _longSliceThresholdUs(other._longSliceThresholdUs),
+    _longSliceCallback(other._longSliceCallback),
+    _priorityWeights(other._priorityWeights),
+    _pass(0),
+    _maxWeightInPass(0),
+    _hasRunInPass(false)
 {
-
+    _thread = std::make_shared<std::thread>(std::bind(&TaskQueue::run, this));
 }
 
 inline
@@ -72,20 +143,59 @@ void TaskQueue::pinToCore(int coreId)
 #endif
 }
 
+inline
+void TaskQueue::pinToCpus(const NumaTopology::CpuSet& cpus)
+{
+    NumaTopology::pinThread(*_thread, cpus);
+}
+
 inline
 void TaskQueue::run()
 {
+    currentQueue() = this;
+    _schedulerStart = std::chrono::high_resolution_clock::now();
     while (true)
     {
         try
         {
             if (_isEmpty)
             {
+                if (_collectLatencyHistograms)
+                {
+                    addSchedulerTime(std::chrono::high_resolution_clock::now());
+                }
+                IdleSignal* signal = _idleSignal;
+                if (signal)
+                {
+                    signal->signal();
+                }
                 _blockedIt = _queue.end(); //clear iterator
-                std::unique_lock<std::mutex> lock(_notEmptyMutex);
-                //========================= BLOCK WHEN EMPTY =========================
-                //Wait for the queue to have at least one element
-                _notEmptyCond.wait(lock, [this]()->bool { return !_isEmpty || _isInterrupted; });
+                if (!_isWorkStealing || !steal())
+                {
+                    //Find out when the next parked coroutine must wake up. This must be
+                    //done before acquiring the mutex to preserve the locking order.
+                    TimePoint deadline = nextTimerDeadline();
+                    if (_isWorkStealing)
+                    {
+                        //Wake up at the end of the poll interval to try stealing again
+                        deadline = std::min(deadline, std::chrono::high_resolution_clock::now() + _workStealingPollIntervalUs);
+                    }
+                    std::unique_lock<std::mutex> lock(_notEmptyMutex);
+                    //========================= BLOCK WHEN EMPTY =========================
+                    //Wait for the queue to have at least one element
+                    if (deadline == TimePoint::max())
+                    {
+                        _notEmptyCond.wait(lock, [this]()->bool { return !_isEmpty || _isInterrupted; });
+                    }
+                    else
+                    {
+                        _notEmptyCond.wait_until(lock, deadline, [this]()->bool { return !_isEmpty || _isInterrupted; });
+                    }
+                }
+                if (_collectLatencyHistograms)
+                {
+                    _schedulerStart = std::chrono::high_resolution_clock::now();
+                }
             }
             
             if (_isInterrupted)
@@ -101,25 +211,145 @@ void TaskQueue::run()
             
             //Check if we need to pause this thread
             if (_blockedIt == _queueIt) {
-                //All coroutines are blocked so we yield
-                YieldingThread()();
+                if (_isWorkStealing && steal())
+                {
+                    //We have new work to do
+                    _blockedIt = _queue.end();
+                }
+                else
+                {
+                    //All coroutines are blocked so we spin, yield or sleep
+                    if (_collectLatencyHistograms)
+                    {
+                        addSchedulerTime(std::chrono::high_resolution_clock::now());
+                        idle();
+                        _schedulerStart = std::chrono::high_resolution_clock::now();
+                    }
+                    else
+                    {
+                        idle();
+                    }
+                }
             }
             
             //Process current task
+#ifdef __QUANTUM_STATIC_DISPATCH
+            Task::Ptr task = *_queueIt; //final methods called on the concrete type are not virtual
+#else
             ITaskContinuation::Ptr task = *_queueIt;
+#endif
             
             //Check if blocked or sleeping
-            if (task->isBlocked() || task->isSleeping(true))
+            bool isBlocked = task->isBlocked();
+            if (isBlocked || task->isSleeping(true))
             {
+                if (_isParkingEnabled && park())
+                {
+                    continue; //moved out of the run queue
+                }
                 if (_blockedIt == _queue.end()) {
                     _blockedIt = _queueIt;
+                    _idleWakeUpCount = _wakeUpCount;
+                    _idleDeadline = TimePoint::max();
+                }
+                if (!isBlocked) {
+                    _idleDeadline = std::min(_idleDeadline, (*_queueIt)->getSleepDeadline());
                 }
                 continue;
             }
             
+            Task* rawTask = _queueIt->get();
+            if ((_isDroppingExpired && dropExpired(*rawTask)) ||
+                (rawTask->_cancellationToken && dropCancelled(*rawTask)))
+            {
+                //The result would arrive too late or is no longer wanted so the coroutine never starts
+                if (_blockedIt == _queueIt) {
+                    _blockedIt = _queue.end();
+                }
+                enqueue(task->getErrorHandlerOrFinalTask());
+                dequeue(_isIdle);
+                continue;
+            }
+            bool isTimed = _collectLatencyHistograms || (_longSliceThresholdUs.count() > 0);
+            TimePoint runStart;
+            if (isTimed)
+            {
+                runStart = std::chrono::high_resolution_clock::now();
+                rawTask->_readySinceNs = 0; //running, or blocked when it yields
+                if (_collectLatencyHistograms)
+                {
+                    addSchedulerTime(runStart);
+                    if (!rawTask->_isStarted)
+                    {
+                        _stats.recordQueueWaitTimeNs(std::chrono::duration_cast<std::chrono::nanoseconds>(runStart - rawTask->_postTimestamp).count());
+                    }
+                }
+            }
+            if (rawTask->_isStarted)
+            {
+                _stats.incResumeCount();
+            }
+            TaskRegistry::Entry* entry = rawTask->_registryEntry.get();
+            if (entry)
+            {
+                if (rawTask->_isStarted)
+                {
+                    entry->incResumeCount();
+                }
+                entry->setState(TaskInfo::State::Running, _queueId, TaskRegistry::Clock::now());
+            }
+            
+            QUANTUM_TRACE(rawTask->_isStarted ? Tracer::Event::Resumed : Tracer::Event::Started,
+                          static_cast<const ITask*>(rawTask), IQueue::QueueType::Coro, _queueId);
             //========================= START/RESUME COROUTINE =========================
             int rc = task->run();
             //=========================== END/YIELD COROUTINE ==========================
+            QUANTUM_TRACE(rc == (int)ITask::RetCode::Running ? Tracer::Event::Suspended : Tracer::Event::Finished,
+                          static_cast<const ITask*>(rawTask), IQueue::QueueType::Coro, _queueId);
+            _idleCount = 0;
+            _isRestarted = _isDeadlineScheduling; //pick the earliest deadline again
+            _hasRunInPass = true;
+            
+            TimePoint runEnd;
+            if (isTimed)
+            {
+                runEnd = std::chrono::high_resolution_clock::now();
+                if (_longSliceThresholdUs.count() > 0)
+                {
+                    checkSlice(*rawTask, runStart, runEnd);
+                }
+            }
+            if (rc == (int)ITask::RetCode::Running)
+            {
+                _stats.incYieldCount();
+            }
+            if (entry)
+            {
+                if (rc == (int)ITask::RetCode::Running)
+                {
+                    entry->setState(task->isBlocked() ? TaskInfo::State::Blocked :
+                                    task->isSleeping() ? TaskInfo::State::Sleeping : TaskInfo::State::Ready,
+                                    _queueId, TaskRegistry::Clock::now());
+                }
+                else
+                {
+                    //the context may outlive the coroutine
+                    TaskRegistry::remove(*entry);
+                    rawTask->_registryEntry.reset();
+                }
+            }
+            if (_collectLatencyHistograms)
+            {
+                _stats.addTaskTimeNs(std::chrono::duration_cast<std::chrono::nanoseconds>(runEnd - runStart).count());
+                _schedulerStart = runEnd;
+                rawTask->_runTime += runEnd - runStart;
+                ++rawTask->_numResumes;
+                if (rc != (int)ITask::RetCode::Running)
+                {
+                    _stats.recordRunTimeNs(rawTask->_runTime.count());
+                    _stats.recordNumResumes(rawTask->_numResumes);
+                }
+            }
             
             if (rc != (int)ITask::RetCode::Running) //Coroutine ended
             {
@@ -135,11 +365,17 @@ void TaskQueue::run()
                     
                     //check if there's another task scheduled to run after this one
                     nextTask = task->getNextTask();
-                    if (nextTask && (nextTask->getType() == ITask::Type::ErrorHandler))
+#ifdef __QUANTUM_STATIC_DISPATCH
+                    //continuations of a coroutine are always coroutines
+                    Task* next = static_cast<Task*>(nextTask.get());
+#else
+                    ITaskContinuation* next = nextTask.get();
+#endif
+                    if (next && (next->getType() == ITask::Type::ErrorHandler))
                     {
                         //skip error handler since we don't have any errors
-                        nextTask->terminate(); //invalidate the error handler
-                        nextTask = nextTask->getNextTask();
+                        next->terminate(); //invalidate the error handler
+                        nextTask = next->getNextTask();
                     }
                 }
                 else
@@ -161,13 +397,24 @@ void TaskQueue::run()
                     //Check if we have a final task to run
                     nextTask = task->getErrorHandlerOrFinalTask();
                 }
-                //queue next task and de-queue current one
-                enqueue(nextTask);
-                dequeue(_isIdle);
+                //queue next task and de-queue current one, or replace the current one with the next
+                if (!_isInliningContinuations || !inlineContinuation(nextTask))
+                {
+                    enqueue(nextTask);
+                    dequeue(_isIdle);
+                }
+            }
+            else if (_isParkingEnabled && (task->isBlocked() || task->isSleeping()) && park())
+            {
+                //Coroutine left the run queue until it gets signalled or its timer expires
             }
             else if (!task->isBlocked() && !task->isSleeping()) {
                 //This coroutine will run again so we reset the blocked position iterator
                 _blockedIt = _queue.end();
+                if (_longSliceThresholdUs.count() > 0)
+                {
+                    rawTask->_readySinceNs = toNs(runEnd);
+                }
             }
         }
         catch (std::exception& ex)
@@ -197,9 +444,7 @@ void TaskQueue::enqueue(ITask::Ptr task)
     {
         return; //nothing to do
     }
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock);
-    doEnqueue(task);
+    push(std::static_pointer_cast<Task>(task));
 }
 
 inline
@@ -209,90 +454,203 @@ bool TaskQueue::tryEnqueue(ITask::Ptr task)
     {
         return false; //nothing to do
     }
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
-    if (lock.ownsLock())
+    //Posting never contends on the queue lock so this always succeeds
+    push(std::static_pointer_cast<Task>(task));
+    return true;
+}
+
+inline
+void TaskQueue::enqueue(std::vector<Task::Ptr>& tasks)
+{
+    if (tasks.empty())
+    {
+        return; //nothing to do
+    }
+    //Link the tasks so that the last one ends up on top of the stack
+    Task* last = tasks.front().get();
+    Task* first = nullptr;
+    bool isTimed = _collectLatencyHistograms || (_longSliceThresholdUs.count() > 0);
+    TimePoint now = isTimed ? std::chrono::high_resolution_clock::now() : TimePoint{};
+    for (auto&& task : tasks)
+    {
+        Task* raw = task.get();
+        QUANTUM_TRACE(Tracer::Event::Posted, static_cast<const ITask*>(raw), IQueue::QueueType::Coro, _queueId);
+        track(*raw);
+        raw->_postTimestamp = now;
+        raw->_readySinceNs = toNs(now);
+        raw->_intakeNext = first;
+        raw->_intakeSelf = std::move(task);
+        first = raw;
+    }
+    push(first, last, tasks.size());
+    tasks.clear();
+}
+
+inline
+void TaskQueue::push(Task::Ptr task)
+{
+    //The task holds a reference to itself until the runner thread picks it up
+    Task* raw = task.get();
+    QUANTUM_TRACE(Tracer::Event::Posted, static_cast<const ITask*>(raw), IQueue::QueueType::Coro, _queueId);
+    track(*raw);
+    if (_collectLatencyHistograms || (_longSliceThresholdUs.count() > 0))
     {
-        doEnqueue(task);
+        raw->_postTimestamp = std::chrono::high_resolution_clock::now();
+        raw->_readySinceNs = toNs(raw->_postTimestamp);
     }
-    return lock.ownsLock();
+    raw->_intakeSelf = std::move(task);
+    push(raw, raw, 1);
 }
 
 inline
-void TaskQueue::doEnqueue(ITask::Ptr task)
+void TaskQueue::push(Task* first, Task* last, size_t num)
+{
+    //NOTE: 'first' is the latest posted task and the chain down to 'last' is already linked
+    _intakeSize += num;
+    incPendingCount(num); //before the tasks become visible to the runner
+    Task* head = _intakeHead.load();
+    do
+    {
+        last->_intakeNext = head;
+    }
+    while (!_intakeHead.compare_exchange_weak(head, first));
+    
+    //Only wake up the runner thread on the empty to non-empty transition. If the runner
+    //marks itself empty after this point, it will find the task when re-checking the stack.
+    if (!head && (_isEmpty || _isIdleParked))
+    {
+        signalEmptyCondition(false);
+    }
+}
+
+inline
+void TaskQueue::drainIntake()
+{
+    //NOTE: must be called with the spinlock held
+    Task* head = _intakeHead.exchange(nullptr);
+    
+    //reverse the stack so that tasks run in the same order they were posted
+    Task* ordered = nullptr;
+    while (head)
+    {
+        Task* next = head->_intakeNext;
+        head->_intakeNext = ordered;
+        ordered = head;
+        head = next;
+    }
+    if (ordered)
+    {
+        //New tasks are runnable so the current round cannot end up all blocked
+        _blockedIt = _queue.end();
+    }
+    while (ordered)
+    {
+        Task* next = ordered->_intakeNext;
+        ordered->_intakeNext = nullptr;
+        doEnqueue(std::move(ordered->_intakeSelf));
+        --_intakeSize;
+        ordered = next;
+    }
+}
+
+inline
+void TaskQueue::doEnqueue(Task::Ptr task)
 {
     //NOTE: _queueIt remains unchanged following this operation
-    if (_queue.empty() || !task->isHighPriority())
+    //Continuations posted to any queue keep IQueue::QueueId::Any until they get here. Notifications
+    //are routed by queue id so it must always designate the queue which holds the task.
+    task->setQueueId(_queueId);
+    bool isHighPriority = task->isHighPriority();
+    if (_queue.empty() || !isHighPriority || _isDeadlineScheduling)
     {
         //insert before the current position. If _queueIt == begin(), then the new
         //task will be at the head of the queue.
-        _queue.insert(_queueIt, std::static_pointer_cast<Task>(task));
+        TaskListIter pos = getInsertPosition(*task);
+        _queue.insert(pos, std::move(task));
     }
     else
     {
         //insert after the current position. If next(_queueIt) == end()
         //then the new task will be the last element in the queue
-        _queue.insert(std::next(_queueIt), std::static_pointer_cast<Task>(task));
+        _queue.insert(std::next(_queueIt), std::move(task));
     }
-    if (task->isHighPriority())
+    if (isHighPriority)
     {
         _stats.incHighPriorityCount();
     }
     _stats.incPostedCount();
     _stats.incNumElements();
-    signalEmptyCondition(false);
 }
 
 inline
 ITask::Ptr TaskQueue::dequeue(std::atomic_bool& hint)
 {
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock);
-    return doDequeue(hint);
+    ITask::Ptr task;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        task = doDequeue(hint);
+    }
+    //Terminate outside the lock since this may notify coroutines parked on this queue
+    if (task)
+    {
+        task->terminate();
+    }
+    return nullptr; //not used!
 }
 
 inline
 ITask::Ptr TaskQueue::tryDequeue(std::atomic_bool& hint)
 {
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
-    if (lock.ownsLock())
+    ITask::Ptr task;
     {
-        return doDequeue(hint);
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
+        if (!lock.ownsLock())
+        {
+            return nullptr;
+        }
+        task = doDequeue(hint);
     }
-    return nullptr;
+    if (task)
+    {
+        task->terminate();
+    }
+    return nullptr; //not used!
 }
 
 inline
 ITask::Ptr TaskQueue::doDequeue(std::atomic_bool& hint)
 {
+    ITask::Ptr task;
     hint = (_queueIt == _queue.end());
     if (!hint)
     {
-        (*_queueIt)->terminate();
+        task = std::move(*_queueIt);
         //Remove error task from the queue
         _queueIt = _queue.erase(_queueIt);
         _stats.decNumElements();
+        decPendingCount(1);
         _isAdvanced = true; //_queueIt now points to the next element in the list or to _queue.end()
     }
-    return nullptr; //not used!
+    return task;
 }
 
 inline
 size_t TaskQueue::size() const
 {
 #if (__cplusplus >= 201703L)
-    return _queue.size();
+    return _queue.size() + _intakeSize;
 #else
     //Avoid linear time implementation
-    return _stats.numElements();
+    return _stats.numElements() + _intakeSize;
 #endif
 }
 
 inline
 bool TaskQueue::empty() const
 {
-    return _queue.empty();
+    return _queue.empty() && _parkedQueue.empty() && (_intakeSize == 0);
 }
 
 inline
@@ -307,12 +665,32 @@ void TaskQueue::terminate()
         _notEmptyCond.notify_all();
         _thread->join();
         
+        {
+            //wait for any sibling which may be stealing from this queue
+            SpinLock::Guard lock(_spinlock);
+        }
+        
         //clear the queue
         while (!_queue.empty())
         {
             _queue.front()->terminate();
             _queue.pop_front();
         }
+        while (!_parkedQueue.empty())
+        {
+            _parkedQueue.front()->terminate();
+            _parkedQueue.pop_front();
+        }
+        _timers = TimerQueue();
+        Task* head = _intakeHead.exchange(nullptr);
+        while (head)
+        {
+            Task::Ptr task = std::move(head->_intakeSelf);
+            head = head->_intakeNext;
+            task->_intakeNext = nullptr;
+            task->terminate();
+            --_intakeSize;
+        }
     }
 }
 
@@ -347,24 +725,604 @@ TaskQueue::TaskListIter TaskQueue::advance()
 {
     //========================= LOCKED SCOPE =========================
     SpinLock::Guard lock(_spinlock);
+    //Pick up the newly posted tasks.
+    drainIntake();
     //Iterate to the next element
-    if ((_queueIt == _queue.end()) || (!_isAdvanced && (++_queueIt == _queue.end())))
+    if (_isRestarted || (_queueIt == _queue.end()) || (!_isAdvanced && (++_queueIt == _queue.end())))
     {
-        _queueIt = _queue.begin();
+        startPass();
+    }
+    _isAdvanced = false; //reset flags
+    _isRestarted = false;
+    //Skip the coroutines which used up their slices for this round
+    while ((_queueIt != _queue.end()) && !hasCredit(**_queueIt))
+    {
+        _blockedIt = _queue.end(); //the skipped coroutine may be runnable
+        if (++_queueIt == _queue.end())
+        {
+            startPass();
+        }
     }
-    _isAdvanced = false; //reset flag
     if (_queueIt == _queue.end())
     {
         signalEmptyCondition(true);
+        if (_intakeHead != nullptr)
+        {
+            //A task was posted before we were marked as empty
+            signalEmptyCondition(false);
+        }
     }
     return _queueIt;
 }
 
+inline
+void TaskQueue::startPass()
+{
+    //Put back any sleeping coroutine whose time has come before starting a new pass
+    expireTimers();
+    _queueIt = _queue.begin();
+    //A new round starts once no coroutine has slices left, or if none could run during the last pass
+    _pass = (_hasRunInPass && (_pass + 1 < _maxWeightInPass)) ? _pass + 1 : 0;
+    _maxWeightInPass = 0;
+    _hasRunInPass = false;
+}
+
+inline
+bool TaskQueue::hasCredit(const Task& task)
+{
+    if (_isDeadlineScheduling)
+    {
+        return true; //priorities are ignored
+    }
+    //Each round is made of several passes over the run queue and a coroutine at level k
+    //runs in the first 'weight^k' of them, so the levels get interleaved slices.
+    size_t level = std::min(static_cast<size_t>(task.getPriority()), _priorityWeights.size()-1);
+    _maxWeightInPass = std::max(_maxWeightInPass, _priorityWeights[level]);
+    return _pass < _priorityWeights[level];
+}
+
 inline
 bool TaskQueue::isIdle() const
 {
     return _isIdle;
 }
 
-}}
+inline
+void TaskQueue::setSiblingQueues(std::vector<TaskQueue>* coroQueues)
+{
+    _siblingQueues = coroQueues;
+}
+
+inline
+void TaskQueue::setIdleSignal(IdleSignal* signal)
+{
+    _idleSignal = signal;
+}
+
+inline
+void TaskQueue::setPendingTaskCounter(std::atomic<size_t>* counter)
+{
+    _pendingTaskCounter = counter;
+}
+
+inline
+void TaskQueue::incPendingCount(size_t num)
+{
+    std::atomic<size_t>* counter = _pendingTaskCounter;
+    if (counter)
+    {
+        counter->fetch_add(num, std::memory_order_relaxed);
+    }
+}
+
+inline
+void TaskQueue::decPendingCount(size_t num)
+{
+    std::atomic<size_t>* counter = _pendingTaskCounter;
+    if (counter)
+    {
+        counter->fetch_sub(num, std::memory_order_relaxed);
+    }
+}
+
+inline
+bool TaskQueue::park()
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    Task::Ptr& task = *_queueIt;
+    //Mark the task parked before checking its signal again. A notifier raises the signal before
+    //reading this flag so either we see the signal here or it sees the flag and takes the lock.
+    task->_isParked = true;
+    if (task->isBlocked())
+    {
+        //wait indefinitely until signalled
+    }
+    else if (task->isSleeping())
+    {
+        //wait until signalled or until the sleep time expires
+        _timers.push(Timer{task->getSleepDeadline(), task});
+    }
+    else
+    {
+        task->_isParked = false;
+        return false;
+    }
+    if (_blockedIt == _queueIt)
+    {
+        _blockedIt = _queue.end();
+    }
+    task->_parkedIt = _parkedQueue.insert(_parkedQueue.end(), task);
+    _queueIt = _queue.erase(_queueIt);
+    _isAdvanced = true; //_queueIt now points to the next element in the list or to _queue.end()
+    return true;
+}
+
+inline
+void TaskQueue::wakeUp(Task::Ptr task)
+{
+    ++_wakeUpCount;
+    if (!_isParkingEnabled)
+    {
+        if (_isIdleParked)
+        {
+            {
+                //========================= LOCKED SCOPE =========================
+                std::lock_guard<std::mutex> lock(_notEmptyMutex);
+            }
+            _notEmptyCond.notify_all();
+        }
+        return;
+    }
+    if (!task->_isParked)
+    {
+        return; //still in the run queue. Only parked tasks need the lock.
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    if (!isParkedHere(*task) || _isInterrupted)
+    {
+        return; //still in the run queue, migrated or shutting down
+    }
+    doWakeUp(task);
+}
+
+inline
+void TaskQueue::doWakeUp(const Task::Ptr& task)
+{
+    task->_isParked = false;
+    if (_longSliceThresholdUs.count() > 0)
+    {
+        task->_readySinceNs = toNs(std::chrono::high_resolution_clock::now());
+    }
+    if ((_migrationThreshold > 0) && !task->_isPinned && migrateWokenUp(task))
+    {
+        return; //resumes on a sibling queue
+    }
+    //insert first so that the queue never appears empty
+    _queue.insert(getInsertPosition(*task), task);
+    _parkedQueue.erase(task->_parkedIt);
+    signalEmptyCondition(false);
+}
+
+inline
+bool TaskQueue::migrateWokenUp(const Task::Ptr& task)
+{
+    //NOTE: must be called with the spinlock held
+    std::vector<TaskQueue>* queues = _siblingQueues;
+    size_t load = size();
+    if (!queues || (load < _migrationThreshold))
+    {
+        return false;
+    }
+    
+    //Find the least loaded sibling which is lighter than this queue by at least the threshold
+    TaskQueue* target = nullptr;
+    size_t minSize = load - _migrationThreshold + 1;
+    for (auto&& queue : *queues)
+    {
+        if ((&queue != this) && !queue._isRetired)
+        {
+            size_t queueSize = queue.size();
+            if (queueSize < minSize)
+            {
+                minSize = queueSize;
+                target = &queue;
+            }
+        }
+    }
+    if (!target)
+    {
+        return false;
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        //Don't wait on the sibling's lock since it may be migrating a coroutine to this queue.
+        SpinLock::Guard lock(target->_spinlock, SpinLock::TryToLock{});
+        if (!lock.ownsLock() || target->_isInterrupted)
+        {
+            return false;
+        }
+        //Later notifications are routed to the new queue
+        task->setQueueId(target->_queueId);
+        target->_queue.insert(target->getInsertPosition(*task), task);
+        target->_stats.incNumElements();
+    }
+    _parkedQueue.erase(task->_parkedIt);
+    _stats.decNumElements();
+    _stats.incMigratedCount();
+    ++target->_wakeUpCount;
+    target->signalEmptyCondition(false);
+    return true;
+}
+
+inline
+bool TaskQueue::isParkedHere(const Task& task) const
+{
+    //NOTE: must be called with the spinlock held. The queue id is checked first since a coroutine
+    //which migrated away may be parked again on its new queue.
+    return ((_migrationThreshold == 0) || (task._queueId == _queueId)) && task._isParked;
+}
+
+inline
+TaskQueue::TaskListIter TaskQueue::getInsertPosition(const Task& task)
+{
+    if (!_isDeadlineScheduling)
+    {
+        return _queueIt;
+    }
+    //Keep the run queue sorted by deadline. Tasks with equal deadlines keep their posting order.
+    return std::find_if(_queue.begin(), _queue.end(), [&task](const Task::Ptr& other)->bool
+    {
+        return other->_deadline > task._deadline;
+    });
+}
+
+inline
+bool TaskQueue::dropExpired(Task& task)
+{
+    if (task._isStarted ||
+        (task._deadline == TimePoint::max()) ||
+        (task._deadline > std::chrono::high_resolution_clock::now()))
+    {
+        return false;
+    }
+    task._ctx->setException(std::make_exception_ptr(std::runtime_error("Coroutine deadline expired")));
+    _stats.incExpiredCount();
+    return true;
+}
+
+inline
+bool TaskQueue::dropCancelled(Task& task)
+{
+    if (task._isStarted || !task._cancellationToken->isCancelled())
+    {
+        return false;
+    }
+    task._ctx->setException(std::make_exception_ptr(CancellationException()));
+    _stats.incCancelledCount();
+    return true;
+}
+
+inline
+void TaskQueue::track(Task& task)
+{
+    if (_registry && !task._registryEntry)
+    {
+        task._registryEntry = _registry->add(_queueId, task._tag);
+    }
+}
+
+inline
+void TaskQueue::snapshotTasks(std::vector<TaskInfo>& tasks) const
+{
+    if (_registry)
+    {
+        _registry->snapshot(tasks, TaskRegistry::Clock::now());
+    }
+}
+
+inline
+void TaskQueue::addSchedulerTime(TimePoint now)
+{
+    _stats.addSchedulerTimeNs(std::chrono::duration_cast<std::chrono::nanoseconds>(now - _schedulerStart).count());
+    _schedulerStart = now;
+}
+
+inline
+void TaskQueue::checkSlice(Task& task, TimePoint runStart, TimePoint runEnd)
+{
+    std::chrono::microseconds duration = std::chrono::duration_cast<std::chrono::microseconds>(runEnd - runStart);
+    if (duration < _longSliceThresholdUs)
+    {
+        return;
+    }
+    _stats.incLongSliceCount();
+    if (_longSliceCallback)
+    {
+        try
+        {
+            _longSliceCallback(_queueId, &task, duration);
+        }
+        catch (...)
+        {
+            //never let a faulty callback terminate the coroutine
+        }
+    }
+}
+
+inline
+int64_t TaskQueue::toNs(TimePoint time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+inline
+void TaskQueue::setQueueId(int queueId)
+{
+    _queueId = queueId;
+}
+
+inline
+const TaskQueue*& TaskQueue::currentQueue()
+{
+    static thread_local const TaskQueue* queue = nullptr;
+    return queue;
+}
+
+inline
+const TaskQueue* TaskQueue::getCurrentQueue()
+{
+    return currentQueue();
+}
+
+inline
+void TaskQueue::setRetired(bool value)
+{
+    _isRetired = value;
+}
 
+inline
+void TaskQueue::migrate(std::vector<Task::Ptr>& tasks)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    drainIntake();
+    for (auto it = _queue.begin(); it != _queue.end();)
+    {
+        //The task at the current position may be running
+        if ((it != _queueIt) && (it != _blockedIt) && (*it)->isStealable())
+        {
+            tasks.emplace_back(std::move(*it));
+            it = _queue.erase(it);
+            _stats.decNumElements();
+            decPendingCount(1); //counted again when re-posted
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+inline
+std::chrono::microseconds TaskQueue::oldestRunnableWaitTime() const
+{
+    int64_t oldest = 0;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        for (const auto& task : _queue)
+        {
+            int64_t readySince = task->_readySinceNs;
+            if ((readySince != 0) && ((oldest == 0) || (readySince < oldest)))
+            {
+                oldest = readySince;
+            }
+        }
+        //Tasks in the intake cannot be removed while we hold the lock
+        for (Task* task = _intakeHead; task; task = task->_intakeNext)
+        {
+            int64_t readySince = task->_readySinceNs;
+            if ((readySince != 0) && ((oldest == 0) || (readySince < oldest)))
+            {
+                oldest = readySince;
+            }
+        }
+    }
+    if (oldest == 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+    int64_t waited = toNs(std::chrono::high_resolution_clock::now()) - oldest;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(std::max<int64_t>(waited, 0)));
+}
+
+inline
+void TaskQueue::expireTimers()
+{
+    if (_timers.empty())
+    {
+        return;
+    }
+    TimePoint now = std::chrono::high_resolution_clock::now();
+    while (!_timers.empty() && (_timers.top()._deadline <= now))
+    {
+        Task::Ptr task = _timers.top()._task.lock();
+        _timers.pop();
+        //Stale entries belong to tasks which were signalled before the timer expired
+        if (task && isParkedHere(*task))
+        {
+            doWakeUp(task);
+        }
+    }
+}
+
+inline
+TaskQueue::TimePoint TaskQueue::nextTimerDeadline() const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    return _timers.empty() ? TimePoint::max() : _timers.top()._deadline;
+}
+
+inline
+void TaskQueue::idle()
+{
+    if (_idleCount < _idleSpinCount)
+    {
+        ++_idleCount;
+        CpuPause()();
+        return;
+    }
+    if ((_idleYieldCount < 0) || (_idleCount - _idleSpinCount < _idleYieldCount))
+    {
+        if (_idleYieldCount >= 0)
+        {
+            ++_idleCount;
+        }
+        YieldingThread()();
+        return;
+    }
+    
+    //Sleep until a coroutine gets signalled, a sleeping one is due or new work arrives.
+    //The deadline must be computed before acquiring the mutex to preserve the locking order.
+    TimePoint deadline = std::min(_idleDeadline, nextTimerDeadline());
+    if (_isWorkStealing)
+    {
+        deadline = std::min(deadline, std::chrono::high_resolution_clock::now() + _workStealingPollIntervalUs);
+    }
+    _isIdleParked = true;
+    {
+        std::unique_lock<std::mutex> lock(_notEmptyMutex);
+        auto isWokenUp = [this]()->bool
+        {
+            return (_wakeUpCount != _idleWakeUpCount) || (_intakeHead != nullptr) || _isInterrupted;
+        };
+        if (deadline == TimePoint::max())
+        {
+            _notEmptyCond.wait(lock, isWokenUp);
+        }
+        else
+        {
+            _notEmptyCond.wait_until(lock, deadline, isWokenUp);
+        }
+    }
+    _isIdleParked = false;
+    
+    //Start a new round of checks
+    _idleWakeUpCount = _wakeUpCount;
+    _idleDeadline = TimePoint::max();
+}
+
+inline
+bool TaskQueue::steal()
+{
+    std::vector<TaskQueue>* queues = _siblingQueues;
+    if (!queues || _isRetired)
+    {
+        return false;
+    }
+    
+    //Find the busiest sibling. Queues holding a single task are never robbed since
+    //that task is either running or about to run.
+    TaskQueue* victim = nullptr;
+    size_t maxSize = 1;
+    for (auto&& queue : *queues)
+    {
+        size_t queueSize = queue.size();
+        if ((&queue != this) && (queueSize > maxSize))
+        {
+            maxSize = queueSize;
+            victim = &queue;
+        }
+    }
+    if (!victim)
+    {
+        return false;
+    }
+    
+    std::vector<Task::Ptr> stolen;
+    if (doStealFrom(*victim, stolen) == 0)
+    {
+        return false;
+    }
+    
+    int queueId = static_cast<int>(this - queues->data());
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        for (auto&& task : stolen)
+        {
+            task->setQueueId(queueId);
+            TaskListIter pos = getInsertPosition(*task);
+            _queue.insert(pos, std::move(task));
+            _stats.incNumElements();
+            _stats.incStolenCount();
+        }
+    }
+    signalEmptyCondition(false);
+    return true;
+}
+
+inline
+size_t TaskQueue::doStealFrom(TaskQueue& victim, std::vector<Task::Ptr>& stolen)
+{
+    //========================= LOCKED SCOPE =========================
+    //Don't wait on the victim's lock since it's busy and we can always try again later.
+    SpinLock::Guard lock(victim._spinlock, SpinLock::TryToLock{});
+    if (!lock.ownsLock() || victim._isInterrupted || (victim._queue.size() <= 1))
+    {
+        return 0;
+    }
+    //Take at most half of the tasks starting from the tail of the victim's queue. The task
+    //currently pointed at by the victim's iterators is never taken since it may be running.
+    size_t maxStolen = victim._queue.size() / 2;
+    stolen.reserve(maxStolen);
+    auto it = victim._queue.end();
+    while ((it != victim._queue.begin()) && (stolen.size() < maxStolen))
+    {
+        --it;
+        if ((it != victim._queueIt) && (it != victim._blockedIt) && (*it)->isStealable())
+        {
+            stolen.emplace_back(std::move(*it));
+            it = victim._queue.erase(it);
+            victim._stats.decNumElements();
+        }
+    }
+    return stolen.size();
+}
+
+inline
+bool TaskQueue::inlineContinuation(ITaskContinuation::Ptr nextTask)
+{
+    Task::Ptr next = std::static_pointer_cast<Task>(nextTask);
+    if (!next || (next->_isPinned && (next->getQueueId() != _queueId)))
+    {
+        return false;
+    }
+    Task* raw = next.get();
+    raw->setQueueId(_queueId); //see doEnqueue()
+    QUANTUM_TRACE(Tracer::Event::Posted, static_cast<const ITask*>(raw), IQueue::QueueType::Coro, _queueId);
+    track(*raw);
+    if (_collectLatencyHistograms || (_longSliceThresholdUs.count() > 0))
+    {
+        raw->_postTimestamp = std::chrono::high_resolution_clock::now();
+        raw->_readySinceNs = toNs(raw->_postTimestamp);
+    }
+    ITask::Ptr task;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        //The continuation takes the position of the completed task, which siblings never steal,
+        //and the next iteration resumes from that same position.
+        task = std::move(*_queueIt);
+        *_queueIt = std::move(next);
+        _isAdvanced = true;
+        _stats.incPostedCount();
+    }
+    task->terminate();
+    return true;
+}
+
+}}
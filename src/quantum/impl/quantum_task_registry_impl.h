@@ -0,0 +1,109 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+void TaskRegistry::Entry::setState(TaskInfo::State state, int queueId, Clock::time_point now)
+{
+    _queueId.store(queueId, std::memory_order_relaxed);
+    _stateSinceNs.store(toNs(now), std::memory_order_relaxed);
+    _state.store((int)state, std::memory_order_relaxed);
+}
+
+inline
+void TaskRegistry::Entry::incResumeCount()
+{
+    _resumeCount.store(_resumeCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline
+TaskRegistry::EntryPtr TaskRegistry::add(int queueId, const char* tag)
+{
+    EntryPtr entry(new Entry);
+    entry->_registry = shared_from_this();
+    entry->_postTime = Clock::now();
+    entry->_tag = tag;
+    entry->_queueId.store(queueId, std::memory_order_relaxed);
+    entry->_stateSinceNs.store(toNs(entry->_postTime), std::memory_order_relaxed);
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    entry->_next = _head;
+    if (_head)
+    {
+        _head->_prev = entry.get();
+    }
+    _head = entry.get();
+    ++_size;
+    return entry;
+}
+
+inline
+void TaskRegistry::remove(Entry& entry)
+{
+    TaskRegistry& registry = *entry._registry;
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(registry._spinlock);
+    if (entry._prev)
+    {
+        entry._prev->_next = entry._next;
+    }
+    else
+    {
+        registry._head = entry._next;
+    }
+    if (entry._next)
+    {
+        entry._next->_prev = entry._prev;
+    }
+    --registry._size;
+}
+
+inline
+void TaskRegistry::snapshot(std::vector<TaskInfo>& tasks, Clock::time_point now) const
+{
+    int64_t nowNs = toNs(now);
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    tasks.reserve(tasks.size() + _size);
+    for (const Entry* entry = _head; entry; entry = entry->_next)
+    {
+        TaskInfo info;
+        info._queueId = entry->_queueId.load(std::memory_order_relaxed);
+        info._state = static_cast<TaskInfo::State>(entry->_state.load(std::memory_order_relaxed));
+        info._age = std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry->_postTime);
+        info._timeInState = std::chrono::nanoseconds(
+            std::max<int64_t>(0, nowNs - entry->_stateSinceNs.load(std::memory_order_relaxed)));
+        info._resumeCount = entry->_resumeCount.load(std::memory_order_relaxed);
+        info._tag = entry->_tag;
+        tasks.push_back(info);
+    }
+}
+
+inline
+int64_t TaskRegistry::toNs(Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+}}
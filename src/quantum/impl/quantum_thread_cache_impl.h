@@ -0,0 +1,194 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+ThreadCache::Magazine::Magazine(size_t capacity) :
+    _blocks(new index_type[capacity]),
+    _capacity(capacity),
+    _size(0)
+{}
+
+inline
+bool ThreadCache::Magazine::pop(index_type& index)
+{
+    size_t size = _size.load(std::memory_order_relaxed);
+    if (size == 0) {
+        return false;
+    }
+    index = _blocks[--size];
+    _size.store(size, std::memory_order_relaxed);
+    return true;
+}
+
+inline
+bool ThreadCache::Magazine::push(index_type index)
+{
+    size_t size = _size.load(std::memory_order_relaxed);
+    if (size == _capacity) {
+        return false;
+    }
+    _blocks[size++] = index;
+    _size.store(size, std::memory_order_relaxed);
+    return true;
+}
+
+inline
+size_t ThreadCache::Magazine::size() const
+{
+    return _size.load(std::memory_order_relaxed);
+}
+
+inline
+size_t ThreadCache::Magazine::capacity() const
+{
+    return _capacity;
+}
+
+inline
+size_t ThreadCache::Magazine::batchSize() const
+{
+    return (_capacity + 1) / 2;
+}
+
+inline
+ThreadCache::ThreadCache(size_t capacity) :
+    _capacity(capacity)
+{
+    if (_capacity > 0) {
+        _magazines.reset(new std::atomic<Magazine*>[MaxThreadSlots]);
+        for (int i = 0; i < MaxThreadSlots; ++i) {
+            _magazines[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline
+ThreadCache::~ThreadCache()
+{
+    if (_magazines) {
+        for (int i = 0; i < MaxThreadSlots; ++i) {
+            delete _magazines[i].load(std::memory_order_acquire);
+        }
+    }
+}
+
+inline
+ThreadCache::Magazine* ThreadCache::magazine()
+{
+    if (!_magazines) {
+        return nullptr;
+    }
+    int slot = threadSlot();
+    if (slot < 0) {
+        return nullptr;
+    }
+    Magazine* magazine = _magazines[slot].load(std::memory_order_relaxed);
+    if (!magazine) {
+        //only the owner of the slot creates its magazine
+        magazine = new Magazine(_capacity);
+        _magazines[slot].store(magazine, std::memory_order_release);
+    }
+    return magazine;
+}
+
+inline
+size_t ThreadCache::cachedBlocks() const
+{
+    size_t total = 0;
+    if (_magazines) {
+        for (int i = 0; i < MaxThreadSlots; ++i) {
+            Magazine* magazine = _magazines[i].load(std::memory_order_acquire);
+            if (magazine) {
+                total += magazine->size();
+            }
+        }
+    }
+    return total;
+}
+
+template <typename FUNC>
+void ThreadCache::drain(FUNC&& func)
+{
+    if (_magazines) {
+        for (int i = 0; i < MaxThreadSlots; ++i) {
+            Magazine* magazine = _magazines[i].load(std::memory_order_acquire);
+            index_type index;
+            while (magazine && magazine->pop(index)) {
+                func(index);
+            }
+        }
+    }
+}
+
+inline
+int ThreadCache::threadSlot()
+{
+    struct Slot
+    {
+        Slot() : _slot(acquireSlot()) {}
+        ~Slot() { releaseSlot(_slot); }
+        int _slot;
+    };
+    static thread_local Slot slot;
+    return slot._slot;
+}
+
+struct ThreadCacheSlots
+{
+    std::mutex          _mutex;
+    std::vector<int>    _free;
+    int                 _next{0};
+    
+    static ThreadCacheSlots& instance()
+    {
+        static ThreadCacheSlots slots;
+        return slots;
+    }
+};
+
+inline
+int ThreadCache::acquireSlot()
+{
+    ThreadCacheSlots& slots = ThreadCacheSlots::instance();
+    std::lock_guard<std::mutex> lock(slots._mutex);
+    if (!slots._free.empty()) {
+        int slot = slots._free.back();
+        slots._free.pop_back();
+        return slot;
+    }
+    return (slots._next < MaxThreadSlots) ? slots._next++ : -1;
+}
+
+inline
+void ThreadCache::releaseSlot(int slot)
+{
+    if (slot < 0) {
+        return;
+    }
+    ThreadCacheSlots& slots = ThreadCacheSlots::instance();
+    std::lock_guard<std::mutex> lock(slots._mutex);
+    slots._free.push_back(slot);
+}
+
+}}
@@ -0,0 +1,162 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#include <stdexcept>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+TimerService::TimerService() :
+    _nextId(1),
+    _isInterrupted(false),
+    _runningId(0),
+    _thread(std::bind(&TimerService::run, this))
+{
+}
+
+inline
+TimerService::~TimerService()
+{
+    terminate();
+}
+
+inline
+void TimerService::terminate()
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isInterrupted)
+        {
+            return;
+        }
+        _isInterrupted = true;
+    }
+    _cond.notify_one();
+    _thread.join();
+    _timers.clear();
+}
+
+inline
+uint64_t TimerService::schedule(std::chrono::microseconds delay,
+                                std::chrono::microseconds period,
+                                Callback callback)
+{
+    Clock::time_point due = Clock::now() + std::max(delay, std::chrono::microseconds::zero());
+    bool isEarliest;
+    uint64_t id;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isInterrupted)
+        {
+            throw std::runtime_error("Timer service terminated");
+        }
+        id = _nextId++;
+        _timers.emplace(id, Timer{due, std::max(period, std::chrono::microseconds::zero()), std::move(callback)});
+        isEarliest = _heap.empty() || (due < _heap.top().first);
+        _heap.emplace(due, id);
+    }
+    if (isEarliest)
+    {
+        _cond.notify_one();
+    }
+    return id;
+}
+
+inline
+bool TimerService::cancel(uint64_t id)
+{
+    //========================= LOCKED SCOPE =========================
+    std::unique_lock<std::mutex> lock(_mutex);
+    bool isPending = _timers.erase(id) > 0; //the heap entry is discarded when it comes due
+    if (std::this_thread::get_id() != _thread.get_id())
+    {
+        _callbackDone.wait(lock, [this, id]()->bool{ return _runningId != id; });
+    }
+    return isPending;
+}
+
+inline
+size_t TimerService::size() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _timers.size();
+}
+
+inline
+void TimerService::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_isInterrupted)
+    {
+        if (_heap.empty())
+        {
+            _cond.wait(lock);
+            continue;
+        }
+        HeapEntry next = _heap.top();
+        if (Clock::now() < next.first)
+        {
+            _cond.wait_until(lock, next.first);
+            continue;
+        }
+        _heap.pop();
+        auto it = _timers.find(next.second);
+        if ((it == _timers.end()) || (it->second._due != next.first))
+        {
+            continue; //cancelled
+        }
+        Callback callback;
+        if (it->second._period.count() == 0)
+        {
+            callback = std::move(it->second._callback);
+            _timers.erase(it);
+        }
+        else
+        {
+            //Fixed rate. If the thread fell behind, skip the missed periods instead of firing them in a burst.
+            callback = it->second._callback;
+            Clock::time_point due = it->second._due + it->second._period;
+            Clock::time_point now = Clock::now();
+            if (due <= now)
+            {
+                due = now + it->second._period;
+            }
+            it->second._due = due;
+            _heap.emplace(due, next.second);
+        }
+        _runningId = next.second;
+        lock.unlock();
+        try
+        {
+            callback();
+        }
+        catch (...) {}
+        lock.lock();
+        _runningId = 0;
+        _callbackDone.notify_all();
+    }
+}
+
+}}
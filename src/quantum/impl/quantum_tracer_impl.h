@@ -0,0 +1,212 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+Tracer::Buffer::Buffer(size_t size) :
+    _slots(std::max(size, size_t(1)))
+{
+}
+
+inline
+void Tracer::record(Event event,
+                    const void* object,
+                    IQueue::QueueType queueType,
+                    int queueId) noexcept
+{
+    try
+    {
+        Buffer& buffer = threadBuffer();
+        uint64_t head = buffer._head.load(std::memory_order_relaxed);
+        Slot& slot = buffer._slots[head % buffer._slots.size()];
+        slot._timestampNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        slot._object.store(object, std::memory_order_relaxed);
+        slot._info.store((uint64_t)event |
+                         ((uint64_t)(uint8_t)queueType << 8) |
+                         ((uint64_t)(uint32_t)queueId << 32), std::memory_order_relaxed);
+        //publish the slot to the readers
+        buffer._head.store(head + 1, std::memory_order_release);
+    }
+    catch (...)
+    {
+        //the buffer could not be allocated so the event is lost
+    }
+}
+
+inline
+size_t& Tracer::bufferSize()
+{
+    static size_t size = __QUANTUM_TRACE_BUFFER_SIZE;
+    return size;
+}
+
+inline
+std::vector<std::vector<Tracer::Record>> Tracer::records()
+{
+    std::vector<BufferPtr> buffers;
+    {
+        //========================= LOCKED SCOPE =========================
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg._mutex);
+        buffers = reg._buffers;
+    }
+    std::vector<std::vector<Record>> records;
+    records.reserve(buffers.size());
+    for (const BufferPtr& buffer : buffers)
+    {
+        const uint64_t size = buffer->_slots.size();
+        uint64_t end = buffer->_head.load(std::memory_order_acquire);
+        uint64_t begin = (end > size) ? end - size : 0;
+        std::vector<Record> thread;
+        thread.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const Slot& slot = buffer->_slots[i % size];
+            uint64_t info = slot._info.load(std::memory_order_relaxed);
+            thread.push_back({slot._timestampNs.load(std::memory_order_relaxed),
+                              slot._object.load(std::memory_order_relaxed),
+                              static_cast<Event>(info & 0xFF),
+                              static_cast<IQueue::QueueType>((info >> 8) & 0xFF),
+                              (int)(uint32_t)(info >> 32)});
+        }
+        //Drop the events the owning thread may have overwritten while they were being copied. The slot of
+        //event 'head' is being written, which replaces event 'head - size'.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t head = buffer->_head.load(std::memory_order_relaxed);
+        if (head >= begin + size)
+        {
+            size_t overwritten = std::min<uint64_t>(head - size + 1 - begin, thread.size());
+            thread.erase(thread.begin(), thread.begin() + overwritten);
+        }
+        records.emplace_back(std::move(thread));
+    }
+    return records;
+}
+
+inline
+void Tracer::dump(std::ostream& out)
+{
+    std::vector<std::vector<Record>> threads = records();
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool isFirst = true;
+    for (size_t threadId = 0; threadId < threads.size(); ++threadId)
+    {
+        //A thread may have resumed a slice which started before its oldest event remaining
+        size_t depth = 0;
+        for (const Record& record : threads[threadId])
+        {
+            bool isEnd = (record._event == Event::Suspended) || (record._event == Event::Finished);
+            if (isEnd && (depth == 0))
+            {
+                continue;
+            }
+            if ((record._event == Event::Started) || (record._event == Event::Resumed))
+            {
+                ++depth;
+            }
+            else if (isEnd)
+            {
+                --depth;
+            }
+            out << (isFirst ? "\n" : ",\n");
+            isFirst = false;
+            write(out, record, threadId);
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+inline
+Tracer::Registry& Tracer::registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+inline
+Tracer::Buffer& Tracer::threadBuffer()
+{
+    static thread_local BufferPtr buffer;
+    if (!buffer)
+    {
+        BufferPtr created = std::make_shared<Buffer>(bufferSize());
+        //========================= LOCKED SCOPE =========================
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg._mutex);
+        reg._buffers.push_back(created);
+        buffer = std::move(created);
+    }
+    return *buffer;
+}
+
+inline
+void Tracer::write(std::ostream& out, const Record& record, size_t threadId)
+{
+    static const char* names[] = {"post", "start", "resume", "yield", "block", "suspend", "finish", "set"};
+    const char* phase = "i";
+    switch (record._event)
+    {
+        case Event::Started:
+        case Event::Resumed:
+            phase = "B";
+            break;
+        case Event::Suspended:
+        case Event::Finished:
+            phase = "E";
+            break;
+        default:
+            break;
+    }
+    out << "{\"name\":\"" << names[(size_t)record._event] << "\",\"ph\":\"" << phase << "\"";
+    if (phase[0] == 'i')
+    {
+        out << ",\"s\":\"t\"";
+    }
+    out << ",\"ts\":" << std::fixed << std::setprecision(3) << (record._timestampNs / 1000.0)
+        << ",\"pid\":1,\"tid\":" << threadId
+        << ",\"args\":{\"object\":\"" << record._object << "\"";
+    if (record._queueType != IQueue::QueueType::All)
+    {
+        out << ",\"queue\":\"" << ((record._queueType == IQueue::QueueType::Coro) ? "coro " : "io ");
+        if (record._queueId == (int)IQueue::QueueId::Any)
+        {
+            out << "any";
+        }
+        else
+        {
+            out << record._queueId;
+        }
+        out << "\"";
+    }
+    out << "}}";
+}
+
+}}
@@ -0,0 +1,145 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+WaitQueue::WaitQueue() :
+    _numWaiters(0),
+    _spinlock(LockProfiler::site<WaitQueue>("WaitQueue")),
+    _head(nullptr),
+    _tail(nullptr)
+{}
+
+template <class PREDICATE>
+void WaitQueue::wait(PREDICATE shouldWait)
+{
+    Waiter waiter;
+    if (enqueue(waiter, shouldWait))
+    {
+        block(waiter._signal);
+    }
+}
+
+template <class PREDICATE>
+void WaitQueue::wait(ICoroSync::Ptr sync, PREDICATE shouldWait)
+{
+    Waiter waiter;
+    waiter._sync = sync;
+    std::atomic_int& signal = sync->signal();
+    signal = 0; //blocked until notified
+    if (enqueue(waiter, shouldWait))
+    {
+        Traits::Yield& yield = sync->getYieldHandle();
+        while (signal != 1)
+        {
+            yield();
+        }
+    }
+    signal = -1; //reset
+}
+
+inline
+bool WaitQueue::hasWaiters() const
+{
+    return _numWaiters.load(std::memory_order_seq_cst) != 0;
+}
+
+inline
+size_t WaitQueue::notify(size_t num)
+{
+    size_t count = 0;
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_spinlock);
+    while (_head && (count < num))
+    {
+        Waiter* next = _head;
+        _head = next->_next;
+        if (!_head)
+        {
+            _tail = nullptr;
+        }
+        _numWaiters.fetch_sub(1, std::memory_order_relaxed);
+        ++count;
+        //The node may go out of scope as soon as the waiter is signalled
+        if (next->_sync)
+        {
+            ICoroSync::Ptr sync = next->_sync;
+            sync->notify();
+        }
+        else
+        {
+            next->_signal.store(1, std::memory_order_release);
+            Futex::wake(next->_signal); //only the address is used
+        }
+    }
+    return count;
+}
+
+inline
+size_t WaitQueue::notifyAll()
+{
+    return notify(static_cast<size_t>(-1));
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 12)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdangling-pointer" //the waiter is removed from the list before it goes out of scope
+#endif
+template <class PREDICATE>
+bool WaitQueue::enqueue(Waiter& waiter, PREDICATE& shouldWait)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard guard(_spinlock);
+    //Register first, then check the condition. Notifiers update the condition first, then check
+    //for waiters, so at least one of them always observes the other.
+    _numWaiters.fetch_add(1, std::memory_order_seq_cst);
+    if (!shouldWait())
+    {
+        _numWaiters.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (_tail)
+    {
+        _tail->_next = &waiter;
+    }
+    else
+    {
+        _head = &waiter;
+    }
+    _tail = &waiter;
+    return true;
+}
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 12)
+#pragma GCC diagnostic pop
+#endif
+
+inline
+void WaitQueue::block(std::atomic_int& signal)
+{
+    while (signal.load(std::memory_order_acquire) == 0)
+    {
+        Futex::wait(signal, 0);
+    }
+}
+
+}}
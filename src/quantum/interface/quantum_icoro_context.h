@@ -20,6 +20,7 @@
 #include <quantum/interface/quantum_icoro_context_base.h>
 #include <quantum/interface/quantum_icoro_future.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace Bloomberg {
@@ -28,6 +29,9 @@ namespace quantum {
 template <class RET>
 class Context;
 
+template <class T>
+class SharedFuture;
+
 //==============================================================================================
 //                                  interface ICoroContext
 //==============================================================================================
@@ -57,6 +61,38 @@ struct ICoroContext : public ICoroContextBase
     template <class V = RET>
     const NonBufferRetType<V>& getRef(ICoroSync::Ptr sync) const;
     
+    /// @brief Get a view of the future value associated with this context which any number of consumers can read
+    ///        without copying it.
+    /// @return A shared future on the same state.
+    /// @note Once shared, read the value via getRef() or the shared future only, since get() moves it out.
+    template <class V = RET>
+    SharedFuture<NonBufferRetType<V>> share() const;
+    
+    /// @brief Get the future value associated with this context if it becomes ready within 'timeMs' milliseconds.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait.
+    /// @param[out] value Receives the future value. Left untouched on timeout.
+    /// @return True if the value was retrieved, false on timeout.
+    /// @note Equivalent to waitFor() followed by get() but in a single pass. Throws if the future holds an exception.
+    ///       On timeout, the future is still valid and can be waited on again.
+    template <class V = RET>
+    bool getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value);
+    
+    /// @brief Same as getFor() but waits until an absolute point in time.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] deadline Time after which the wait fails. A deadline in the past only checks if the value is ready.
+    /// @param[out] value Receives the future value. Left untouched on timeout.
+    /// @return True if the value was retrieved, false on timeout.
+    template <class CLOCK, class DURATION, class V = RET>
+    bool getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value);
+    
+    /// @brief Invokes a callback once the future value associated with this context is ready.
+    /// @param[in] callback Callable with signature void(). It's invoked inline from the thread or coroutine which
+    ///            sets the value, or immediately if the value is already available.
+    /// @note Method available for non-buffered futures only. The callback must not block nor throw.
+    template <class FUNC>
+    void onReady(FUNC&& callback);
+    
     /// @brief Get the future value associated with the previous coroutine context in the continuation chain.
     /// @tparam OTHER_RET The type of the future value of the previous context.
     /// @return The previous future value.
@@ -100,6 +136,21 @@ struct ICoroContext : public ICoroContextBase
     template <class OTHER_RET>
     const NonBufferRetType<OTHER_RET>& getRefAt(int num, ICoroSync::Ptr sync) const;
     
+    /// @brief Same as getFor() but for the future in the 'num-th' continuation context.
+    /// @tparam OTHER_RET The type of the future value associated with the 'num-th' context.
+    /// @param[in] num The number indicating which future to wait on. See getAt() for the allowed range.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait.
+    /// @param[out] value Receives the future value. Left untouched on timeout.
+    /// @return True if the value was retrieved, false on timeout.
+    template <class OTHER_RET>
+    bool getForAt(int num, ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<OTHER_RET>& value);
+    
+    /// @brief Same as getUntil() but for the future in the 'num-th' continuation context.
+    /// @tparam OTHER_RET The type of the future value associated with the 'num-th' context.
+    template <class OTHER_RET, class CLOCK, class DURATION>
+    bool getUntilAt(int num, ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<OTHER_RET>& value);
+    
     /// @brief Set the promised value associated with this context.
     /// @tparam V Type of the promised value. This should be implicitly deduced by the compiler and should always == RET.
     /// @param[in] value A reference to the value (l-value or r-value).
@@ -117,6 +168,15 @@ struct ICoroContext : public ICoroContextBase
     template <class V, class = BufferType<RET,V>>
     void push(V&& value);
     
+    /// @brief Push a range of values into the promise buffer.
+    /// @tparam ITER An input iterator type dereferencing to a value convertible to the buffered type.
+    /// @param[in] first Iterator to the first value to push.
+    /// @param[in] last Iterator past the last value to push.
+    /// @note Method available for buffered futures only. All the values are pushed in a single locked section
+    ///       and the consumer is woken up once. A bounded buffer which fills up suspends this coroutine until the consumer pulls.
+    template <class ITER, class V = RET, class = BufferRetType<V>>
+    void pushBatch(ITER first, ITER last);
+    
     /// @brief Pull a single value from the future buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -127,6 +187,17 @@ struct ICoroContext : public ICoroContextBase
     template <class V = RET>
     BufferRetType<V> pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
+    /// @brief Pull up to 'maxItems' values from the future buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] maxItems The maximum number of values to return.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The values pulled out from the front of the buffer, in order.
+    /// @note Method available for buffered futures only. Blocks until at least one value is available and returns
+    ///       all the values already received (up to 'maxItems') without waiting for more.
+    template <class V = RET>
+    std::vector<BufferRetType<V>> pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
@@ -135,6 +206,15 @@ struct ICoroContext : public ICoroContextBase
     template <class V = RET, class = BufferRetType<V>>
     int closeBuffer();
     
+    /// @brief Limit the number of values a promise buffer holds.
+    /// @param[in] capacity The maximum number of values waiting to be pulled. Zero means unbounded.
+    /// @note Once the capacity is reached, push operations suspend this coroutine until the consumer pulls. Must be called
+    ///       before the first push. The consumer drains values in batches, so the preallocated memory holds
+    ///       up to 2 x capacity values.
+    /// @return 0 on success.
+    template <class V = RET, class = BufferRetType<V>>
+    int setBufferCapacity(size_t capacity);
+    
     /// @brief Returns the number of underlying coroutine threads as specified in the dispatcher constructor.
     ///        If -1 was passed than this number essentially indicates the number of cores.
     /// @return The number of threads.
@@ -161,6 +241,9 @@ struct ICoroContext : public ICoroContextBase
     /// @endcode
     ///
     /// @note post() methods are standalone and do not allow continuations.
+    /// @note Coroutines and IO tasks posted from within a coroutine, as well as continuation chains, are exempt from
+    ///       the dispatcher pending task limits (see Configuration::setMaxPendingCoroTasks()). They count towards the
+    ///       limits but are never rejected, since failing them would abort work which has already been admitted.
     //-----------------------------------------------------------------------------------------
     
     /// @brief Post a coroutine to run asynchronously.
@@ -203,6 +286,45 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<OTHER_RET>::Ptr
     post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as post() above but using one of several priority levels.
+    /// @param[in] priority The priority level in the range [0, numPriorityLevels) where 0 is the lowest.
+    ///                     Higher values are capped to the highest configured level.
+    ///                     See Configuration::setNumPriorityLevels().
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    post(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a batch of coroutines to run asynchronously.
+    /// @details The coroutines are spread over all the coroutine threads. Each thread receiving a part of the batch
+    ///          is only notified once, regardless of how many coroutines it receives.
+    /// @tparam OTHER_RET Type of future returned by each coroutine.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(CoroContext<OTHER_RET>::Ptr)'.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine context objects, one for each callable in the range in the same order.
+    /// @note This function is non-blocking and returns immediately. The returned contexts cannot be used to chain
+    ///       further coroutines.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<typename ICoroContext<OTHER_RET>::Ptr>
+    postBatch(INPUT_IT first, INPUT_IT last);
+    
+    /// @brief Post a batch of coroutines to run asynchronously on a specific queue (thread).
+    /// @tparam OTHER_RET Type of future returned by each coroutine.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(CoroContext<OTHER_RET>::Ptr)'.
+    /// @param[in] queueId Id of the queue where the coroutines should run. Valid range is [0, numCoroutineThreads),
+    ///                    IQueue::QueueId::Any or IQueue::QueueId::Same.
+    /// @param[in] isHighPriority If set to true, the coroutines will be scheduled to run immediately after the currently
+    ///                           executing coroutine on 'queueId' has completed or has yielded.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine context objects, one for each callable in the range in the same order.
+    /// @note This function is non-blocking and returns immediately.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<typename ICoroContext<OTHER_RET>::Ptr>
+    postBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last);
+    
     /// @brief Posts a coroutine to run asynchronously.
     /// @details This function is the head of a coroutine continuation chain and must be called only once in the chain.
     /// @tparam OTHER_RET Type of future returned by this coroutine.
@@ -242,6 +364,14 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<OTHER_RET>::Ptr
     postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as postFirst() above but using one of several priority levels.
+    /// @param[in] priority The priority level in the range [0, numPriorityLevels) where 0 is the lowest.
+    ///                     Higher values are capped to the highest configured level.
+    ///                     See Configuration::setNumPriorityLevels().
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postFirst(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
     /// @brief Posts a coroutine to run asynchronously.
     /// @details This function is optional for the continuation chain and may be called 0 or more times. If called,
     ///          it must follow postFirst() or another then() method.
@@ -339,6 +469,83 @@ struct ICoroContext : public ICoroContextBase
     CoroFuturePtr<OTHER_RET>
     postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as postAsyncIo() above but using one of several priority levels.
+    /// @param[in] priority The priority level in the range [0, numPriorityLevels) where 0 is the lowest.
+    ///                     Higher values are capped to the highest configured level.
+    ///                     See Configuration::setNumPriorityLevels().
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIo(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Posts a batch of IO functions to run asynchronously on the IO thread pool.
+    /// @details All the functions are inserted with a single lock on the shared queue and at most one IO thread
+    ///          is woken up per function.
+    /// @tparam OTHER_RET Type of future returned by each function.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(ThreadPromise<OTHER_RET>::Ptr)'.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine future objects, one for each callable in the range in the same order.
+    /// @note This method does not block. The futures can be waited on together with a FutureJoiner.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(INPUT_IT first, INPUT_IT last);
+    
+    /// @brief Posts a batch of IO functions to run asynchronously on a specific IO thread.
+    /// @tparam OTHER_RET Type of future returned by each function.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(ThreadPromise<OTHER_RET>::Ptr)'.
+    /// @param[in] queueId Id of the queue where the functions should run. Valid range is [0, numIoThreads) or
+    ///                    IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the functions will be scheduled ahead of the normal priority ones.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine future objects, one for each callable in the range in the same order.
+    /// @note This method does not block.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last);
+    
+    /// @brief Posts an IO function which counts against the limits of a named IO task group.
+    /// @tparam OTHER_RET Type of future returned by this function.
+    /// @param[in] group The group name. See Dispatcher::setIoGroupLimits().
+    /// @param[in] func Callable object with the signature 'int f(ThreadPromise<OTHER_RET>::Ptr, ...)'.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a coroutine future object.
+    /// @note This method does not block. See Dispatcher::postAsyncIoGroup() for details.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIoGroup(const std::string& group, FUNC&& func, ARGS&&... args);
+    
+#if defined(__linux__)
+    /// @brief Suspends the current coroutine until a file descriptor becomes readable.
+    /// @param[in] fd The file descriptor. Should be in non-blocking mode.
+    /// @param[in] timeMs Maximum time to wait. A negative value waits forever.
+    /// @return The epoll event mask reported for the descriptor or 0 if the wait timed out.
+    /// @note The descriptor is watched by the dispatcher's reactor thread, so no IO thread is blocked while waiting.
+    int awaitReadable(int fd, std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    
+    /// @brief Suspends the current coroutine until a file descriptor becomes writable.
+    /// @param[in] fd The file descriptor. Should be in non-blocking mode.
+    /// @param[in] timeMs Maximum time to wait. A negative value waits forever.
+    /// @return The epoll event mask reported for the descriptor or 0 if the wait timed out.
+    int awaitWritable(int fd, std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    
+    /// @brief Reads from a non-blocking file descriptor, suspending the coroutine until data is available.
+    /// @param[in] fd The file descriptor.
+    /// @param[in] buf The destination buffer.
+    /// @param[in] count The maximum number of bytes to read.
+    /// @return Same as ::read().
+    ssize_t read(int fd, void* buf, size_t count);
+    
+    /// @brief Writes to a non-blocking file descriptor, suspending the coroutine until it can accept data.
+    /// @param[in] fd The file descriptor.
+    /// @param[in] buf The source buffer.
+    /// @param[in] count The number of bytes to write.
+    /// @return Same as ::write(). Writes may be partial.
+    ssize_t write(int fd, const void* buf, size_t count);
+#endif
+    
     /// @brief Applies the given unary function to all the elements in the range [first,last).
     ///        This function runs in parallel.
     /// @tparam OTHER_RET The return value of the unary function.
@@ -401,6 +608,46 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
     forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
     
+    /// @brief Applies the given unary function to all the elements in the range [first,last) in chunks
+    ///        of 'grainSize' elements. One coroutine per thread repeatedly claims the next unprocessed
+    ///        chunk, so that faster threads end up processing more chunks.
+    /// @tparam OTHER_RET The return value of the unary function.
+    /// @tparam InputIt The type of iterator.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] func The unary function.
+    /// @param[in] grainSize The number of elements processed per chunk. If 0, it is chosen so that each
+    ///            coroutine thread gets several chunks.
+    /// @return A vector of values corresponding to the output of 'func' on every element in the range.
+    /// @note Use this function if InputIt meets the requirement of a RandomAccessIterator.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    forEachChunked(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, size_t grainSize = 0);
+    
+    /// @brief Same as above but takes a length as second argument.
+    /// @note Use this function if InputIt *does not* meet the requirement of a RandomAccessIterator.
+    template <class OTHER_RET = int, class INPUT_IT>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    forEachChunked(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, size_t grainSize = 0);
+    
+    /// @brief Applies the given unary function to all the elements in the range [first,last) by recursively
+    ///        splitting the range between coroutines in the manner of a parallel_for.
+    /// @details A single coroutine starts with the whole range and processes it 'grainSize' elements at a time.
+    ///          Between two grains, the right half of the remaining elements is split off into a new coroutine
+    ///          whenever fewer ranges are being processed than there are coroutine threads. Threads which run
+    ///          out of work therefore take over part of the slowest ranges instead of waiting for them.
+    /// @tparam OTHER_RET The return value of the unary function.
+    /// @tparam InputIt The type of iterator. Must be a RandomAccessIterator. The input is never copied.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] func The unary function.
+    /// @param[in] grainSize The minimum number of elements in a split range. If 0, a value is chosen based
+    ///            on the range length and the number of coroutine threads.
+    /// @return A vector of value vectors, one per processed sub-range, in the order of the input.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatchSplit(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, size_t grainSize = 0);
+    
     /// @brief Implementation of map-reduce functionality.
     /// @tparam KEY The KEY type used for mapping and reducing.
     /// @tparam MAPPED_TYPE The output type after a map operation.
@@ -464,7 +711,149 @@ struct ICoroContext : public ICoroContextBase
     mapReduceBatch(INPUT_IT first,
                    size_t num,
                    Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
-                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);    
+    /// @brief Version of mapReduce() which shuffles the mapped values in parallel.
+    /// @details Mappers claim chunks of the input dynamically and scatter their output into one bucket per
+    ///          partition, based on the hash of the key. Each partition then merges the buckets of all the
+    ///          mappers into a hash table and reduces its keys, independently of the other partitions.
+    ///          Unlike mapReduce(), no single coroutine inserts all the mapped values into one tree.
+    /// @tparam RESULT The type of the reduced output. Any map type with emplace(KEY, REDUCED_TYPE), such as
+    ///         std::map, can be used if ordered results are needed.
+    /// @param[in] numPartitions The number of partitions the keys are hashed into. If 0, the number of
+    ///            coroutine threads is used.
+    /// @param[in] combiner Optional function which merges a value into the one accumulated for the same key.
+    ///            When provided, each mapper pre-reduces its own output per key, and the reducer receives a single
+    ///            combined value per key. It must be associative, so that values can be combined in any order.
+    /// @note KEY must be hashable with std::hash and equality comparable.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<RESULT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                         size_t numPartitions = 0,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner = nullptr);
+    
+    /// @brief Same as mapReducePartitioned() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    typename ICoroContext<RESULT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                         size_t numPartitions = 0,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner = nullptr);
+    
+    /// @brief Same as mapReducePartitioned() but maps the values of a buffered future as they are produced.
+    /// @details Mapping starts as soon as the first values are pushed into the buffer, without waiting for the
+    ///          whole input to be available. The reduce stage starts once the buffer is closed.
+    /// @param[in] input Buffered future from which the input values are pulled, as returned by
+    ///            Promise<Buffer<T>>::getICoroFuture(). This must be the only consumer of the buffer.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class T>
+    typename ICoroContext<RESULT>::Ptr
+    mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                    Functions::StreamMapFunc<KEY, MAPPED_TYPE, T> mapper,
+                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                    size_t numPartitions = 0,
+                    Functions::CombineFunc<MAPPED_TYPE> combiner = nullptr);
+    
+    /// @brief Parallel reduction of a range of elements.
+    /// @details The range is split into one contiguous chunk per coroutine thread. The partial results of the chunks
+    ///          are then combined pairwise, in order, and the result is combined with 'init'.
+    /// @tparam OTHER_RET The type of the reduced value. Each element must be convertible to it.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] init The initial value, combined with the reduction of the range as op(init, reduced).
+    /// @param[in] op The binary operator. It must be associative but needs not be commutative.
+    /// @return A future to the reduced value. If the range is empty, 'init' is returned.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           INPUT_IT last,
+           OTHER_RET init,
+           Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    /// @brief Same as reduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           size_t num,
+           OTHER_RET init,
+           Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    /// @brief Same as reduce() but applies 'transform' to each element before reducing it.
+    /// @param[in] transform The unary function applied to each element.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    INPUT_IT last,
+                    OTHER_RET init,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                    Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    /// @brief Same as transformReduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    size_t num,
+                    OTHER_RET init,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                    Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    /// @brief Parallel inclusive prefix scan of a range of elements.
+    /// @details Two-pass algorithm: each coroutine thread first scans its own chunk of the range, then every chunk
+    ///          but the first one is offset by the combined totals of the chunks preceding it.
+    /// @tparam OTHER_RET The type of the scanned values. Each element must be convertible to it.
+    /// @param[in] op The binary operator. It must be associative but needs not be commutative.
+    /// @return A future to a vector where the i-th value is the combination of the first i+1 elements.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    /// @brief Same as inclusiveScan() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  size_t num,
+                  Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    /// @brief Sorts a range of elements in parallel.
+    /// @details The range is split into one chunk per coroutine thread which are sorted concurrently. Sorted chunks are
+    ///          then merged pairwise in successive rounds, and each merge is itself split between several coroutines.
+    ///          Since every phase is made of short independent coroutines, other coroutines keep running in between.
+    /// @tparam RANDOM_IT The type of iterator. Must be a random access iterator.
+    /// @tparam COMPARE The comparison function type, as for std::sort().
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] comp The comparison function object.
+    /// @return A future which completes when the range is sorted.
+    /// @note The sort is not stable. The range must remain valid until the returned future completes.
+    template <class RANDOM_IT,
+              class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>,
+              class = Traits::IsInputIterator<RANDOM_IT>>
+    std::shared_ptr<ICoroContext<int>>
+    sort(RANDOM_IT first,
+         RANDOM_IT last,
+         COMPARE comp = COMPARE());
 };
 
 template <class RET>
@@ -20,6 +20,8 @@
 #include <chrono>
 #include <quantum/interface/quantum_icontext_base.h>
 #include <quantum/interface/quantum_icoro_sync.h>
+#include <quantum/quantum_coro_local.h>
+#include <quantum/quantum_coro_arena.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -74,6 +76,23 @@ struct ICoroContextBase : public virtual IContextBase,
     /// @param[in] sync Pointer to the coroutine synchronization object.
     /// @note Blocks until all future values are ready. If any future throws, the exception is swallowed.
     virtual void waitAll(ICoroSync::Ptr sync) const = 0;
+    
+    /// @brief Checks if the cancellation token this coroutine was posted with has been cancelled.
+    /// @return True if cancelled, false otherwise or if the coroutine was posted without a token.
+    /// @note This is a single atomic load. Once cancelled, the next call to yield() throws
+    ///       a CancellationException. See CancellationToken for details.
+    virtual bool isCancelled() const = 0;
+    
+    /// @brief Gives access to the coroutine-local slots of this context.
+    /// @return The slot storage. Use a CoroLocal key to read or write a slot in O(1).
+    /// @note Inheritable slots are copied into coroutines posted from this one and into its continuations
+    ///       when they are created. See CoroLocal for details.
+    virtual CoroLocalStorage& localStorage() = 0;
+    
+    /// @brief Gives access to the memory arena of this coroutine.
+    /// @return The arena. Memory allocated from it is released all at once when the coroutine returns.
+    /// @note Use ArenaAllocator to back STL containers with it. Each continuation has its own arena.
+    virtual CoroArena& arena() = 0;
 };
 
 using ICoroContextBasePtr = ICoroContextBase::Ptr;
@@ -19,6 +19,7 @@
 #include <quantum/interface/quantum_icontext_base.h>
 #include <quantum/interface/quantum_icoro_future_base.h>
 #include <quantum/quantum_traits.h>
+#include <vector>
 
 namespace Bloomberg {
 namespace quantum {
@@ -26,6 +27,9 @@ namespace quantum {
 template <class T>
 class Future;
 
+template <class T>
+class SharedFuture;
+
 //==============================================================================================
 //                                interface ICoroFuture
 //==============================================================================================
@@ -54,6 +58,31 @@ struct ICoroFuture : public ICoroFutureBase
     template <class V = T>
     const NonBufferRetType<V>& getRef(ICoroSync::Ptr sync) const;
     
+    /// @brief Get a view of the future value which any number of consumers can read without copying it.
+    /// @return A shared future on the same state.
+    /// @note Once shared, read the value via getRef() or the shared future only, since get() moves it out.
+    template <class V = T>
+    SharedFuture<NonBufferRetType<V>> share() const;
+    
+    /// @brief Get the future value if it becomes ready within 'timeMs' milliseconds.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait.
+    /// @param[out] value Receives the future value. Left untouched on timeout.
+    /// @return True if the value was retrieved, false on timeout.
+    /// @note Waits and retrieves the value in a single pass. The coroutine sleeps on its queue's timers while
+    ///       waiting. Throws if the future holds an exception. On success, the future becomes invalidated and
+    ///       on timeout it can be waited on again.
+    template <class V = T>
+    bool getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value);
+    
+    /// @brief Same as getFor() but waits until an absolute point in time.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] deadline Time after which the wait fails. A deadline in the past only checks if the value is ready.
+    /// @param[out] value Receives the future value. Left untouched on timeout.
+    /// @return True if the value was retrieved, false on timeout.
+    template <class CLOCK, class DURATION, class V = T>
+    bool getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value);
+    
     /// @brief Pull a single value from the future buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -62,7 +91,45 @@ struct ICoroFuture : public ICoroFutureBase
     /// @return The next value pulled out from the front of the buffer.
     /// @note Method available for buffered futures only. Blocks until one value is retrieved from the buffer.
     template <class V = T>
-    BufferRetType<V> pull(ICoroSync::Ptr sync, bool& isBufferClosed);
+    BufferRetType<V> pull(ICoroSync::Ptr sync, bool& isBufferClosed);    
+    
+    /// @brief Pull up to 'maxItems' values from the future buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] maxItems The maximum number of values to return.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The values pulled out from the front of the buffer, in order.
+    /// @note Method available for buffered futures only. Blocks until at least one value is available and returns
+    ///       all the values already received (up to 'maxItems') without waiting for more.
+    template <class V = T>
+    std::vector<BufferRetType<V>> pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed);
+    
+    /// @brief Invokes a callback once the future is ready.
+    /// @param[in] callback Callable with signature void(). It's invoked inline from the thread or coroutine which
+    ///            satisfies the promise, or immediately if the future is already ready.
+    /// @note Method available for non-buffered futures only. The callback must not block nor throw.
+    template <class FUNC>
+    void onReady(FUNC&& callback);
+    
+    /// @brief Schedules a continuation on a coroutine queue once the future is ready.
+    /// @tparam DISPATCHER The dispatcher type.
+    /// @param[in] dispatcher Dispatcher on which the continuation is posted.
+    /// @param[in] func Callable with signature void(ICoroContext<int>::Ptr, ICoroFuture<T>::Ptr). It runs as a coroutine and
+    ///            receives this future which is guaranteed to be ready, so it can be read without blocking.
+    /// @note Method available for non-buffered futures only. No coroutine is created until the future is ready.
+    template <class DISPATCHER, class FUNC>
+    void onReady(DISPATCHER& dispatcher, FUNC&& func);
+    
+    /// @brief Schedules a continuation on a coroutine queue once the future is ready.
+    /// @tparam DISPATCHER The dispatcher type.
+    /// @param[in] dispatcher Dispatcher on which the continuation is posted.
+    /// @param[in] queueId Id of the queue where the continuation will run.
+    /// @param[in] isHighPriority If set to true, the continuation is scheduled to run immediately.
+    /// @param[in] func Callable with signature void(ICoroContext<int>::Ptr, ICoroFuture<T>::Ptr). It runs as a coroutine and
+    ///            receives this future which is guaranteed to be ready, so it can be read without blocking.
+    /// @note Method available for non-buffered futures only. No coroutine is created until the future is ready.
+    template <class DISPATCHER, class FUNC>
+    void onReady(DISPATCHER& dispatcher, int queueId, bool isHighPriority, FUNC&& func);
 };
 
 template <class T>
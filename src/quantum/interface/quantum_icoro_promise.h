@@ -65,6 +65,16 @@ struct ICoroPromise : public Traits::DerivedFrom<PROMISE<T>,
     template <class V, class = BufferType<T,V>>
     void push(ICoroSync::Ptr sync, V&& value);
     
+    /// @brief Push a range of values into the promise buffer.
+    /// @tparam ITER An input iterator type dereferencing to a value convertible to the buffered type.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] first Iterator to the first value to push.
+    /// @param[in] last Iterator past the last value to push.
+    /// @note Method available for buffered futures only. All the values are pushed in a single locked section
+    ///       and the consumer is woken up once. A bounded buffer which fills up suspends the coroutine until the consumer pulls.
+    template <class ITER, class V = T, class = BufferRetType<V>>
+    void pushBatch(ICoroSync::Ptr sync, ITER first, ITER last);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
@@ -72,6 +82,15 @@ struct ICoroPromise : public Traits::DerivedFrom<PROMISE<T>,
     /// @return 0 on success.
     template <class V = T, class = BufferRetType<V>>
     int closeBuffer();
+    
+    /// @brief Limit the number of values a promise buffer holds.
+    /// @param[in] capacity The maximum number of values waiting to be pulled. Zero means unbounded.
+    /// @note Once the capacity is reached, push operations block until the consumer pulls. Must be called
+    ///       before the first push. The consumer drains values in batches, so the preallocated memory holds
+    ///       up to 2 x capacity values.
+    /// @return 0 on success.
+    template <class V = T, class = BufferRetType<V>>
+    int setBufferCapacity(size_t capacity);
 };
 
 template <class T> class Promise;
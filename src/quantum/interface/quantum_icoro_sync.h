@@ -54,6 +54,11 @@ struct ICoroSync
     /// @return An atomic integer used to synchronize with other primitive types.
     virtual std::atomic_int& signal() = 0;
     
+    /// @brief Signals the underlying synchronization variable.
+    /// @details If the coroutine was parked by its queue while waiting on this variable, it is also
+    ///          moved back to the run queue.
+    virtual void notify() = 0;
+    
     /// @brief Sleeps the coroutine associated with this context for *at least* 'timeMs' milliseconds or
     ///        'timeUs' microseconds depending on the overload chosen.
     /// @param[in] timeMs/timeUs Time to sleep.
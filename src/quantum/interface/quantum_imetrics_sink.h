@@ -0,0 +1,47 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_IMETRICS_SINK_H
+#define QUANTUM_IMETRICS_SINK_H
+
+#include <memory>
+
+namespace Bloomberg {
+namespace quantum {
+
+struct MetricsSnapshot;
+
+//==============================================================================================
+//                                  interface IMetricsSink
+//==============================================================================================
+/// @interface IMetricsSink
+/// @brief Receives the metrics exported periodically by a Dispatcher. See Configuration::setMetricsSink().
+struct IMetricsSink
+{
+    using Ptr = std::shared_ptr<IMetricsSink>;
+    
+    /// @brief Virtual destructor.
+    virtual ~IMetricsSink() = default;
+    
+    /// @brief Called once per export period from the metrics thread of the dispatcher.
+    /// @param[in] metrics The metrics collected at the end of the period. Counters hold the change since the
+    ///            previous call while gauges and histograms hold current values.
+    /// @note Exceptions thrown by this method are ignored.
+    virtual void publish(const MetricsSnapshot& metrics) = 0;
+};
+
+}}
+
+#endif //QUANTUM_IMETRICS_SINK_H
@@ -17,6 +17,7 @@
 #define QUANTUM_IPROMISE_BASE_H
 
 #include <exception>
+#include <functional>
 #include <quantum/interface/quantum_iterminate.h>
 #include <quantum/interface/quantum_ifuture.h>
 #include <quantum/quantum_traits.h>
@@ -45,6 +46,12 @@ struct IPromiseBase : public ITerminate
     /// @return 0 on success
     virtual int setException(std::exception_ptr ex) = 0;
     
+    /// @brief Register a function which runs on the thread satisfying this promise, before any thread or
+    ///        coroutine waiting on the associated future can observe the value, the exception or the broken promise.
+    /// @param[in] callback The function. It must be registered before the promise can be satisfied.
+    /// @return True if registered, false if this type of promise does not support it (i.e. buffered promises).
+    virtual bool onSet(std::function<void()> callback) = 0;
+    
     /// @brief Get a thread-compatible interface used to access the associated future.
     /// @return An interface to the associated future.
     virtual IThreadFutureBase::Ptr getIThreadFutureBase() const = 0;
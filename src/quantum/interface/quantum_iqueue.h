@@ -16,6 +16,7 @@
 #ifndef QUANTUM_IQUEUE_H
 #define QUANTUM_IQUEUE_H
 
+#include <limits>
 #include <quantum/quantum_spinlock.h>
 #include <quantum/interface/quantum_iterminate.h>
 #include <quantum/interface/quantum_itask.h>
@@ -36,6 +37,8 @@ struct IQueue : public ITerminate
     using Ptr = std::shared_ptr<IQueue>;
     enum class QueueType : int { Coro, IO, All };
     enum class QueueId : int { Any = -1, Same = -2, All = -3 };
+    enum class Priority : int { Normal = 0,                                ///< Lowest priority level
+                                High = std::numeric_limits<int>::max() };  ///< Highest configured priority level
     
     //Interface methods
     virtual void pinToCore(int coreId) = 0;
@@ -17,6 +17,7 @@
 #define QUANTUM_IQUEUE_STATISTICS_H
 
 #include <ostream>
+#include <quantum/quantum_histogram.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -85,6 +86,101 @@ struct IQueueStatistics
     /// @brief Increment this counter.
     virtual void incHighPriorityCount() = 0;
     
+    /// @brief Count of all coroutines which were stolen by this queue from sibling queues.
+    /// @return Counter value.
+    virtual size_t stolenCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incStolenCount() = 0;
+    
+    /// @brief Count of all suspended coroutines which were moved by this queue to a less loaded sibling
+    ///        queue when they became runnable again.
+    /// @return Counter value.
+    virtual size_t migratedCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incMigratedCount() = 0;
+    
+    /// @brief Count of all coroutines which were dropped because their deadline passed before they started.
+    /// @return Counter value.
+    virtual size_t expiredCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incExpiredCount() = 0;
+    
+    /// @brief Count of all tasks which were dropped because their cancellation token was cancelled before they started.
+    /// @return Counter value.
+    virtual size_t cancelledCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incCancelledCount() = 0;
+    
+    /// @brief Count of all coroutine run slices which exceeded the configured long slice threshold.
+    /// @return Counter value.
+    virtual size_t longSliceCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incLongSliceCount() = 0;
+    
+    /// @brief Count of all the times coroutines which had already started were resumed on this queue.
+    /// @return Counter value.
+    virtual size_t resumeCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incResumeCount() = 0;
+    
+    /// @brief Count of all the times coroutines gave control back to this queue without having completed,
+    ///        i.e. because they yielded, slept or blocked on a primitive.
+    /// @return Counter value.
+    virtual size_t yieldCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incYieldCount() = 0;
+    
+    /// @brief Total time in nanoseconds spent inside coroutines, across all their run slices.
+    /// @return Counter value.
+    /// @note Only collected if enabled via Configuration::setCollectLatencyHistograms().
+    virtual size_t taskTimeNs() const = 0;
+    
+    /// @brief Add to this counter.
+    virtual void addTaskTimeNs(size_t value) = 0;
+    
+    /// @brief Total time in nanoseconds the thread running this queue spent scheduling coroutines, i.e. picking
+    ///        the next one and skipping the blocked or sleeping ones. Excludes the time spent inside coroutines
+    ///        as well as the time spent idle waiting for work.
+    /// @return Counter value.
+    /// @note Only collected if enabled via Configuration::setCollectLatencyHistograms().
+    virtual size_t schedulerTimeNs() const = 0;
+    
+    /// @brief Add to this counter.
+    virtual void addSchedulerTimeNs(size_t value) = 0;
+    
+    /// @brief Distribution of the time in nanoseconds coroutines waited in the queue between being posted
+    ///        and running for the first time.
+    /// @return Histogram.
+    /// @note Only collected if enabled via Configuration::setCollectLatencyHistograms().
+    virtual const Histogram& queueWaitTimeNs() const = 0;
+    
+    /// @brief Record a value in this histogram.
+    virtual void recordQueueWaitTimeNs(uint64_t value) = 0;
+    
+    /// @brief Distribution of the total time in nanoseconds completed coroutines spent running, summed
+    ///        over all their resumes.
+    /// @return Histogram.
+    /// @note Only collected if enabled via Configuration::setCollectLatencyHistograms().
+    virtual const Histogram& runTimeNs() const = 0;
+    
+    /// @brief Record a value in this histogram.
+    virtual void recordRunTimeNs(uint64_t value) = 0;
+    
+    /// @brief Distribution of the number of times completed coroutines were resumed.
+    /// @return Histogram.
+    /// @note Only collected if enabled via Configuration::setCollectLatencyHistograms().
+    virtual const Histogram& numResumes() const = 0;
+    
+    /// @brief Record a value in this histogram.
+    virtual void recordNumResumes(uint64_t value) = 0;
+    
     /// @brief Print to std::cout the value of all internal counters.
     /// @param[in,out] out Output stream.
     virtual void print(std::ostream& out) const = 0;
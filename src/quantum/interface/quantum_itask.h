@@ -45,6 +45,7 @@ struct ITask : public ITerminate
         Running = std::numeric_limits<int>::max(),
         Exception = (int)Running-1,
         NotCallable = (int)Running-2,
+        Cancelled = (int)Running-3,
     };
     
     ~ITask() = default;
@@ -62,6 +63,8 @@ struct ITask : public ITerminate
     virtual bool isSleeping(bool updateTimer = false) = 0;
     
     virtual bool isHighPriority() const = 0;
+    
+    virtual int getPriority() const = 0;
 };
 
 using ITaskPtr = ITask::Ptr;
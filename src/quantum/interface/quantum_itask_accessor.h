@@ -17,6 +17,8 @@
 #define QUANTUM_ITASK_ACCESSOR_H
 
 #include <memory>
+#include <chrono>
+#include <exception>
 #include <quantum/interface/quantum_itask.h>
 #include <quantum/interface/quantum_iterminate.h>
 
@@ -39,6 +41,10 @@ struct ITaskAccessor : public ITerminate
     virtual bool isBlocked() const = 0;
     
     virtual bool isSleeping(bool updateTimer = false) = 0;
+    
+    virtual std::chrono::high_resolution_clock::time_point getSleepDeadline() const = 0;
+    
+    virtual int setException(std::exception_ptr ex) = 0;
 };
 
 using ITaskAccessorPtr = ITaskAccessor::Ptr;
@@ -18,6 +18,7 @@
 
 #include <future>
 #include <chrono>
+#include <vector>
 #include <quantum/quantum_traits.h>
 #include <quantum/interface/quantum_ithread_context_base.h>
 
@@ -27,6 +28,9 @@ namespace quantum {
 template <class RET>
 class Context;
 
+template <class T>
+class SharedFuture;
+
 //==============================================================================================
 //                                      interface IThreadContext
 //==============================================================================================
@@ -85,6 +89,20 @@ struct IThreadContext : public IThreadContextBase
     template <class V = RET>
     const NonBufferRetType<V>& getRef() const;
     
+    /// @brief Get a view of the future value associated with this context which any number of consumers can read
+    ///        without copying it.
+    /// @return A shared future on the same state.
+    /// @note Once shared, read the value via getRef() or the shared future only, since get() moves it out.
+    template <class V = RET>
+    SharedFuture<NonBufferRetType<V>> share() const;
+    
+    /// @brief Invokes a callback once the future value associated with this context is ready.
+    /// @param[in] callback Callable with signature void(). It's invoked inline from the thread or coroutine which
+    ///            sets the value, or immediately if the value is already available.
+    /// @note Method available for non-buffered futures only. The callback must not block nor throw.
+    template <class FUNC>
+    void onReady(FUNC&& callback);
+    
     /// @brief Get the future value from the 'num-th' continuation context.
     /// @details Allowed range for num is [-1, total_continuations). -1 is equivalent of calling get() or
     ///          getAt(total_continuations-1) on the last context in the chain (i.e. the context which is returned
@@ -126,6 +144,15 @@ struct IThreadContext : public IThreadContextBase
     template <class V, class = BufferType<RET,V>>
     void push(V&& value);
     
+    /// @brief Push a range of values into the promise buffer.
+    /// @tparam ITER An input iterator type dereferencing to a value convertible to the buffered type.
+    /// @param[in] first Iterator to the first value to push.
+    /// @param[in] last Iterator past the last value to push.
+    /// @note Method available for buffered futures only. All the values are pushed in a single locked section
+    ///       and the consumer is woken up once. A bounded buffer which fills up blocks until the consumer pulls.
+    template <class ITER, class V = RET, class = BufferRetType<V>>
+    void pushBatch(ITER first, ITER last);
+    
     /// @brief Pull a single value from the future buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -135,6 +162,16 @@ struct IThreadContext : public IThreadContextBase
     template <class V = RET>
     BufferRetType<V> pull(bool& isBufferClosed);
     
+    /// @brief Pull up to 'maxItems' values from the future buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] maxItems The maximum number of values to return.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The values pulled out from the front of the buffer, in order.
+    /// @note Method available for buffered futures only. Blocks until at least one value is available and returns
+    ///       all the values already received (up to 'maxItems') without waiting for more.
+    template <class V = RET>
+    std::vector<BufferRetType<V>> pullBatch(size_t maxItems, bool& isBufferClosed);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
@@ -19,6 +19,7 @@
 #include <quantum/interface/quantum_icontext_base.h>
 #include <quantum/interface/quantum_icoro_future_base.h>
 #include <quantum/quantum_traits.h>
+#include <vector>
 
 namespace Bloomberg {
 namespace quantum {
@@ -26,6 +27,9 @@ namespace quantum {
 template <class T>
 class Future;
 
+template <class T>
+class SharedFuture;
+
 //==============================================================================================
 //                                 interface IThreadFuture
 //==============================================================================================
@@ -52,6 +56,12 @@ struct IThreadFuture : public IThreadFutureBase
     template <class V = T>
     const NonBufferRetType<V>& getRef() const;
     
+    /// @brief Get a view of the future value which any number of consumers can read without copying it.
+    /// @return A shared future on the same state.
+    /// @note Once shared, read the value via getRef() or the shared future only, since get() moves it out.
+    template <class V = T>
+    SharedFuture<NonBufferRetType<V>> share() const;
+    
     /// @brief Pull a single value from the future buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -59,7 +69,44 @@ struct IThreadFuture : public IThreadFutureBase
     /// @return The next value pulled out from the front of the buffer.
     /// @note Method available for buffered futures only. Blocks until one value is retrieved from the buffer.
     template <class V = T>
-    BufferRetType<V> pull(bool& isBufferClosed);
+    BufferRetType<V> pull(bool& isBufferClosed);    
+    
+    /// @brief Pull up to 'maxItems' values from the future buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] maxItems The maximum number of values to return.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The values pulled out from the front of the buffer, in order.
+    /// @note Method available for buffered futures only. Blocks until at least one value is available and returns
+    ///       all the values already received (up to 'maxItems') without waiting for more.
+    template <class V = T>
+    std::vector<BufferRetType<V>> pullBatch(size_t maxItems, bool& isBufferClosed);
+    
+    /// @brief Invokes a callback once the future is ready.
+    /// @param[in] callback Callable with signature void(). It's invoked inline from the thread or coroutine which
+    ///            satisfies the promise, or immediately if the future is already ready.
+    /// @note Method available for non-buffered futures only. The callback must not block nor throw.
+    template <class FUNC>
+    void onReady(FUNC&& callback);
+    
+    /// @brief Schedules a continuation on a coroutine queue once the future is ready.
+    /// @tparam DISPATCHER The dispatcher type.
+    /// @param[in] dispatcher Dispatcher on which the continuation is posted.
+    /// @param[in] func Callable with signature void(ICoroContext<int>::Ptr, IThreadFuture<T>::Ptr). It runs as a coroutine and
+    ///            receives this future which is guaranteed to be ready, so it can be read without blocking.
+    /// @note Method available for non-buffered futures only. No coroutine is created until the future is ready.
+    template <class DISPATCHER, class FUNC>
+    void onReady(DISPATCHER& dispatcher, FUNC&& func);
+    
+    /// @brief Schedules a continuation on a coroutine queue once the future is ready.
+    /// @tparam DISPATCHER The dispatcher type.
+    /// @param[in] dispatcher Dispatcher on which the continuation is posted.
+    /// @param[in] queueId Id of the queue where the continuation will run.
+    /// @param[in] isHighPriority If set to true, the continuation is scheduled to run immediately.
+    /// @param[in] func Callable with signature void(ICoroContext<int>::Ptr, IThreadFuture<T>::Ptr). It runs as a coroutine and
+    ///            receives this future which is guaranteed to be ready, so it can be read without blocking.
+    /// @note Method available for non-buffered futures only. No coroutine is created until the future is ready.
+    template <class DISPATCHER, class FUNC>
+    void onReady(DISPATCHER& dispatcher, int queueId, bool isHighPriority, FUNC&& func);
 };
 
 template <class T>
@@ -55,6 +55,14 @@ struct IThreadPromise : public Traits::DerivedFrom<PROMISE<T>,
     template <class V, class = NonBufferType<T,V>>
     int set(V&& value);
     
+    /// @brief Set the promised value by constructing it in place.
+    /// @tparam ARGS The types of the constructor arguments of T.
+    /// @param[in] args The arguments forwarded to the constructor of T.
+    /// @return 0 on success
+    /// @note T does not need to be default-constructible or assignable.
+    template <class... ARGS, class V = T, class = NonBufferRetType<V>>
+    int emplace(ARGS&&... args);
+    
     /// @brief Push a single value into the promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -64,6 +72,15 @@ struct IThreadPromise : public Traits::DerivedFrom<PROMISE<T>,
     template <class V, class = BufferType<T,V>>
     void push(V&& value);
     
+    /// @brief Push a range of values into the promise buffer.
+    /// @tparam ITER An input iterator type dereferencing to a value convertible to the buffered type.
+    /// @param[in] first Iterator to the first value to push.
+    /// @param[in] last Iterator past the last value to push.
+    /// @note Method available for buffered futures only. All the values are pushed in a single locked section
+    ///       and the consumer is woken up once. A bounded buffer which fills up blocks until the consumer pulls.
+    template <class ITER, class V = T, class = BufferRetType<V>>
+    void pushBatch(ITER first, ITER last);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
@@ -71,6 +88,15 @@ struct IThreadPromise : public Traits::DerivedFrom<PROMISE<T>,
     /// @return 0 on success.
     template <class V = T, class = BufferRetType<V>>
     int closeBuffer();
+    
+    /// @brief Limit the number of values a promise buffer holds.
+    /// @param[in] capacity The maximum number of values waiting to be pulled. Zero means unbounded.
+    /// @note Once the capacity is reached, push operations block until the consumer pulls. Must be called
+    ///       before the first push. The consumer drains values in batches, so the preallocated memory holds
+    ///       up to 2 x capacity values.
+    /// @return 0 on success.
+    template <class V = T, class = BufferRetType<V>>
+    int setBufferCapacity(size_t capacity);
 };
 
 template <class T> class Promise;
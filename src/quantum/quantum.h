@@ -26,6 +26,7 @@
 #include <quantum/interface/quantum_icoro_promise.h>
 #include <quantum/interface/quantum_icoro_sync.h>
 #include <quantum/interface/quantum_ifuture.h>
+#include <quantum/interface/quantum_imetrics_sink.h>
 #include <quantum/interface/quantum_ipromise.h>
 #include <quantum/interface/quantum_ipromise_base.h>
 #include <quantum/interface/quantum_iqueue.h>
@@ -39,39 +40,75 @@
 #include <quantum/interface/quantum_ithread_future.h>
 #include <quantum/interface/quantum_ithread_future_base.h>
 #include <quantum/interface/quantum_ithread_promise.h>
+#include <quantum/quantum_affinity_key.h>
 #include <quantum/quantum_allocator.h>
+#include <quantum/quantum_allocator_statistics.h>
 #include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_barrier.h>
 #include <quantum/quantum_buffer.h>
+#include <quantum/quantum_cancellation_token.h>
 #include <quantum/quantum_capture.h>
+#include <quantum/quantum_channel.h>
 #include <quantum/quantum_condition_variable.h>
 #include <quantum/quantum_configuration.h>
 #include <quantum/quantum_context.h>
 #include <quantum/quantum_contiguous_pool_manager.h>
+#include <quantum/quantum_coro_arena.h>
+#include <quantum/quantum_coro_local.h>
 #include <quantum/quantum_coroutine_pool_allocator.h>
+#include <quantum/quantum_coroutine_state.h>
 #include <quantum/quantum_dispatcher.h>
 #include <quantum/quantum_dispatcher_core.h>
+#include <quantum/quantum_fiber.h>
 #include <quantum/quantum_functions.h>
+#include <quantum/quantum_futex.h>
 #include <quantum/quantum_future.h>
 #include <quantum/quantum_future_state.h>
+#include <quantum/quantum_heap_allocator.h>
+#include <quantum/quantum_histogram.h>
+#include <quantum/quantum_huge_pages.h>
+#include <quantum/quantum_idle_signal.h>
+#include <quantum/quantum_io_group.h>
 #include <quantum/quantum_io_queue.h>
 #include <quantum/quantum_io_task.h>
+#include <quantum/quantum_latch.h>
+#include <quantum/quantum_lock_profiler.h>
 #include <quantum/quantum_macros.h>
+#include <quantum/quantum_metrics.h>
+#include <quantum/quantum_mpmc_ring.h>
 #include <quantum/quantum_mutex.h>
+#include <quantum/quantum_numa_topology.h>
+#include <quantum/quantum_pipeline.h>
 #include <quantum/quantum_promise.h>
 #include <quantum/quantum_queue_statistics.h>
+#include <quantum/quantum_reactor.h>
+#include <quantum/quantum_read_write_mutex.h>
+#include <quantum/quantum_semaphore.h>
+#include <quantum/quantum_shared_allocator.h>
+#include <quantum/quantum_shared_future.h>
+#include <quantum/quantum_shared_memory_queue.h>
 #include <quantum/quantum_shared_state.h>
+#include <quantum/quantum_small_vector.h>
 #include <quantum/quantum_spinlock.h>
 #include <quantum/quantum_stack_allocator.h>
 #include <quantum/quantum_stack_traits.h>
 #include <quantum/quantum_task.h>
+#include <quantum/quantum_task_group.h>
 #include <quantum/quantum_task_queue.h>
+#include <quantum/quantum_task_registry.h>
+#include <quantum/quantum_thread_cache.h>
 #include <quantum/quantum_thread_traits.h>
+#include <quantum/quantum_timer_service.h>
+#include <quantum/quantum_tracer.h>
 #include <quantum/quantum_traits.h>
+#include <quantum/quantum_wait_queue.h>
 #include <quantum/quantum_yielding_thread.h>
 #include <quantum/util/quantum_future_joiner.h>
+#include <quantum/util/quantum_sequence_key_chain.h>
 #include <quantum/util/quantum_sequence_key_statistics.h>
 #include <quantum/util/quantum_sequencer.h>
 #include <quantum/util/quantum_sequencer_configuration.h>
 #include <quantum/util/quantum_util.h>
+#include <quantum/util/quantum_when_any.h>
 
 #endif //QUANTUM_H
@@ -0,0 +1,60 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_AFFINITY_KEY_H
+#define QUANTUM_AFFINITY_KEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                       class AffinityKey
+//==============================================================================================
+/// @class AffinityKey.
+/// @brief Identifies an entity (e.g. an account or a symbol) whose coroutines should all run on the same thread.
+/// @details Coroutines posted with equal keys always land on the same coroutine queue for the lifetime of the
+///          dispatcher, which keeps the entity's data hot in that core's cache. Unlike the Sequencer, this does
+///          not serialize the coroutines, it only routes them.
+class AffinityKey
+{
+public:
+    /// @brief Constructor.
+    /// @tparam KEY Any type for which std::hash (or HASH) is defined.
+    /// @param[in] key The key.
+    template <class KEY, class HASH = std::hash<KEY>>
+    explicit AffinityKey(const KEY& key, const HASH& hasher = HASH());
+    
+    /// @brief Get the hash value of this key.
+    /// @return The hash, mixed so that all its bits are well distributed.
+    uint64_t hash() const;
+    
+    /// @brief Mix the bits of a hash value. Useful since std::hash is the identity for integers.
+    /// @param[in] value The value.
+    /// @return The mixed value.
+    static uint64_t mix(uint64_t value);
+    
+private:
+    uint64_t _hash;
+};
+
+}}
+
+#include <quantum/impl/quantum_affinity_key_impl.h>
+
+#endif //QUANTUM_AFFINITY_KEY_H
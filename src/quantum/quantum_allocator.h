@@ -21,6 +21,7 @@
 #include <quantum/quantum_stack_allocator.h>
 #include <quantum/quantum_heap_allocator.h>
 #include <quantum/quantum_coroutine_pool_allocator.h>
+#include <quantum/quantum_shared_allocator.h>
 #include <boost/context/stack_traits.hpp>
 #include <boost/coroutine2/pooled_fixedsize_stack.hpp>
 #include <boost/coroutine2/fixedsize_stack.hpp>
@@ -45,6 +46,10 @@ template <typename Traits>
 struct BoostAllocator : public boost::context::basic_fixedsize_stack<Traits>
 {
     typedef std::true_type default_constructor;
+    
+    BoostAllocator(std::size_t stackSize = Traits::default_size()) :
+        boost::context::basic_fixedsize_stack<Traits>(stackSize)
+    {}
 };
 
 //==============================================================================================
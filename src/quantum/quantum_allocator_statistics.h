@@ -0,0 +1,101 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_ALLOCATOR_STATISTICS_H
+#define QUANTUM_ALLOCATOR_STATISTICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <quantum/quantum_spinlock.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+template <typename T>
+struct ContiguousPoolManager;
+
+template <typename STACK_TRAITS>
+struct CoroutinePoolAllocator;
+
+struct FunctionAllocator;
+
+//==============================================================================================
+//                                 class AllocatorStatistics
+//==============================================================================================
+/// @class AllocatorStatistics.
+/// @brief Snapshot of the counters of an object or coroutine stack pool. See Dispatcher::allocatorStats().
+class AllocatorStatistics
+{
+    template <typename T>
+    friend struct ContiguousPoolManager;
+    template <typename STACK_TRAITS>
+    friend struct CoroutinePoolAllocator;
+    friend struct FunctionAllocator;
+public:
+    /// @brief Number of blocks the pool can hand out before falling back to the heap.
+    size_t capacity() const;
+    
+    /// @brief Number of blocks currently allocated, including heap blocks.
+    /// @note Blocks held in per-thread caches are counted as free.
+    size_t allocatedCount() const;
+    
+    /// @brief Largest number of blocks allocated at any time, including heap blocks.
+    /// @note Blocks held in per-thread caches are counted as allocated.
+    size_t peakAllocatedCount() const;
+    
+    /// @brief Number of blocks currently allocated from the heap because the pool was exhausted.
+    size_t heapAllocatedCount() const;
+    
+    /// @brief Number of allocations which fell back to the heap since the pool was created.
+    size_t heapFallbackCount() const;
+    
+    /// @brief Number of times a thread found the pool locked by another thread.
+    size_t lockContentionCount() const;
+    
+    /// @brief Print to std::cout the content of this object.
+    void print(std::ostream& out = std::cout) const;
+    
+private:
+    size_t  _capacity{0};
+    size_t  _allocatedCount{0};
+    size_t  _peakAllocatedCount{0};
+    size_t  _heapAllocatedCount{0};
+    size_t  _heapFallbackCount{0};
+    size_t  _lockContentionCount{0};
+};
+
+std::ostream& operator<<(std::ostream& out, const AllocatorStatistics& stats);
+
+//==============================================================================================
+//                                     class PoolGuard
+//==============================================================================================
+/// @class PoolGuard.
+/// @brief Acquires a pool spinlock and counts the acquisitions which had to wait for another thread.
+/// @note For internal use only.
+class PoolGuard
+{
+public:
+    PoolGuard(SpinLock& lock, std::atomic<size_t>& contentionCount);
+    
+private:
+    SpinLock::Guard     _guard;
+};
+
+}}
+
+#include <quantum/impl/quantum_allocator_statistics_impl.h>
+
+#endif //QUANTUM_ALLOCATOR_STATISTICS_H
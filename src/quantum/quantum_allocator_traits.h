@@ -34,10 +34,42 @@ namespace quantum {
     #define __QUANTUM_DEFAULT_CORO_POOL_ALLOC_SIZE 200
 #endif
 
+#ifndef __QUANTUM_CORO_STACK_RELEASE_THRESHOLD
+    #define __QUANTUM_CORO_STACK_RELEASE_THRESHOLD -1
+#endif
+
+#ifndef __QUANTUM_THREAD_CACHE_SIZE
+    #define __QUANTUM_THREAD_CACHE_SIZE 0
+#endif
+
+#ifndef __QUANTUM_POOL_SEGMENT_SIZE
+    #define __QUANTUM_POOL_SEGMENT_SIZE 0
+#endif
+
 #ifndef __QUANTUM_FUNCTION_ALLOC_SIZE
     #define __QUANTUM_FUNCTION_ALLOC_SIZE 128
 #endif
 
+#ifndef __QUANTUM_CONTEXT_INLINE_PROMISES
+    #define __QUANTUM_CONTEXT_INLINE_PROMISES 4 //continuation stages stored without heap allocation
+#endif
+
+#ifndef __QUANTUM_CORO_POOL_CHUNK_SIZE
+    #define __QUANTUM_CORO_POOL_CHUNK_SIZE 16 //coroutine stacks allocated together on first use
+#endif
+
+#ifndef __QUANTUM_CORO_ARENA_CHUNK_SIZE
+    #define __QUANTUM_CORO_ARENA_CHUNK_SIZE 4096 //bytes per coroutine arena chunk
+#endif
+
+#ifndef __QUANTUM_CORO_ARENA_CACHE_SIZE
+    #define __QUANTUM_CORO_ARENA_CACHE_SIZE 16 //arena chunks kept by each thread for reuse
+#endif
+
+#ifndef __QUANTUM_FUNCTION_POOL_ALLOC_SIZE
+    #define __QUANTUM_FUNCTION_POOL_ALLOC_SIZE 256
+#endif
+
 //==============================================================================================
 //                                 struct AllocatorTraits
 //==============================================================================================
@@ -74,6 +106,68 @@ struct AllocatorTraits {
         return value;
     }
     
+    /**
+     * @brief Get/set if coroutine stacks should be mapped from virtual memory with a guard page below each stack.
+     * @return A modifiable reference to the value.
+     * @remark Stack pages are committed lazily by the kernel as the coroutine touches them, and overflowing a stack
+     *         faults on its guard page instead of corrupting the neighbouring one. Only available on POSIX systems
+     *         and must be set before the first coroutine is created.
+     */
+    static bool& useGuardedCoroStacks() {
+#ifdef __QUANTUM_USE_GUARDED_CORO_STACKS
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
+    /**
+     * @brief Get/set if coroutine stack pools and heap-allocated object pools should be backed by 2MB pages.
+     * @return A modifiable reference to the value.
+     * @remark Reduces TLB misses when switching between many coroutines. Explicitly reserved huge pages are used when
+     *         available, otherwise the pools are aligned on huge page boundaries and advised for transparent huge
+     *         pages. Falls back to regular allocations on systems without huge page support. Ignored for guarded
+     *         coroutine stacks since guard pages cannot be placed inside a huge page. Only available on Linux and
+     *         must be set before the pools are created.
+     */
+    static bool& useHugePages() {
+#ifdef __QUANTUM_USE_HUGE_PAGES
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
+    /**
+     * @brief Get/set if the peak usage of each coroutine stack should be measured.
+     * @return A modifiable reference to the value.
+     * @remark Stacks are painted with a fixed pattern when allocated and scanned for the deepest overwritten byte
+     *         when released. The results are collected in a histogram per coroutine stack pool, optionally split by
+     *         CoroStackTag. This is meant for profiling since painting commits every stack page up front. Must be set
+     *         before the pools are created.
+     */
+    static bool& profileCoroStacks() {
+#ifdef __QUANTUM_PROFILE_CORO_STACKS
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
+    /**
+     * @brief Get/set the number of unused pooled coroutine stacks above which returned stacks give their pages back
+     *        to the OS.
+     * @return A modifiable reference to the value.
+     * @remark Only applies to guarded coroutine stacks. A negative value never releases stack pages.
+     */
+    static int& coroStackReleaseThreshold() {
+        static int value = __QUANTUM_CORO_STACK_RELEASE_THRESHOLD;
+        return value;
+    }
+    
     /**
      * @brief Get/set if the allocator pool for internal objects should use the heap or the application stack.
      * @return A modifiable reference to the value.
@@ -106,6 +200,90 @@ struct AllocatorTraits {
         return size;
     }
     
+    /**
+     * @brief Get/set the number of coroutine stacks allocated at once when a coroutine stack pool grows.
+     * @return A modifiable reference to the value.
+     * @remark Pools start empty and allocate their stacks in chunks of this many the first time they are needed, up
+     *         to the pool size. Use warmUp() on the pool (or Dispatcher::warmUpPools()) to allocate them ahead of time.
+     *         A value of 0 allocates all the stacks when the pool is created. Does not apply to guarded or huge page
+     *         backed stacks. Must be set before the pools are created.
+     */
+    static size_type& coroPoolChunkSize() {
+        static size_type size = __QUANTUM_CORO_POOL_CHUNK_SIZE;
+        return size;
+    }
+    
+    /**
+     * @brief Get/set the size in bytes of the chunks backing coroutine arenas (see CoroArena).
+     * @return A modifiable reference to the value.
+     * @remark Allocations which do not fit in a chunk get a dedicated block.
+     */
+    static size_type& coroArenaChunkSize() {
+        static size_type size = __QUANTUM_CORO_ARENA_CHUNK_SIZE;
+        return size;
+    }
+    
+    /**
+     * @brief Get/set the number of released coroutine arena chunks each thread keeps for reuse.
+     * @return A modifiable reference to the value.
+     * @remark Chunks released beyond this number are returned to the system. A value of 0 disables the cache.
+     */
+    static size_type& coroArenaCacheSize() {
+        static size_type size = __QUANTUM_CORO_ARENA_CACHE_SIZE;
+        return size;
+    }
+    
+    /**
+     * @brief Get/set the number of blocks in each segment added to an exhausted object pool.
+     * @return A modifiable reference to the value.
+     * @remark When an object pool runs out of blocks it grows by one contiguous segment of this many blocks, with
+     *         its own free list, instead of allocating each object from the heap. A value of 0 disables growth.
+     *         Must be set before the pools are created.
+     */
+    static size_type& poolSegmentSize() {
+        static size_type size = __QUANTUM_POOL_SEGMENT_SIZE;
+        return size;
+    }
+    
+    /**
+     * @brief Get/set if object pool segments should be released once all their blocks are free.
+     * @return A modifiable reference to the value.
+     * @remark A segment is only released while another segment still has free blocks, so that a pool oscillating
+     *         around a segment boundary does not keep allocating and releasing memory.
+     */
+    static bool& releaseIdlePoolSegments() {
+#ifdef __QUANTUM_RELEASE_IDLE_POOL_SEGMENTS
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
+    /**
+     * @brief Get/set the number of free blocks each thread caches in front of an object or coroutine stack pool.
+     * @return A modifiable reference to the value.
+     * @remark Allocations and deallocations are served from the calling thread's cache without touching the shared
+     *         pool, which is only visited to refill or flush half a cache at a time. Blocks held in one thread's
+     *         cache are not available to other threads. A value of 0 disables the cache. Must be set before the
+     *         pools are created.
+     */
+    static size_type& threadCacheSize() {
+        static size_type size = __QUANTUM_THREAD_CACHE_SIZE;
+        return size;
+    }
+    
+    /**
+     * @brief Get/set the number of blocks in each of the pools holding functors too large to be stored inline.
+     * @return A modifiable reference to the value.
+     * @remark Functors larger than __QUANTUM_FUNCTION_ALLOC_SIZE bytes, such as coroutines capturing many arguments,
+     *         are allocated from one pool per power of two size class up to 4096 bytes.
+     */
+    static size_type& functionPoolAllocSize() {
+        static size_type size = __QUANTUM_FUNCTION_POOL_ALLOC_SIZE;
+        return size;
+    }
+    
     /**
      * @brief Get/set if the default size for promise object pools.
      * @return A modifiable reference to the value.
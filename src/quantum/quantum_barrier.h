@@ -0,0 +1,77 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_BARRIER_H
+#define QUANTUM_BARRIER_H
+
+#include <atomic>
+#include <stdexcept>
+#include <quantum/quantum_wait_queue.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                        class Barrier
+//==============================================================================================
+/// @class Barrier.
+/// @brief Coroutine-compatible reusable barrier.
+/// @details A fixed number of participants arrive at the barrier and wait until all of them have
+///          arrived, at which point the barrier moves to the next phase and can be reused.
+class Barrier
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] numParticipants The number of participants in each phase. Must be greater than zero.
+    explicit Barrier(size_t numParticipants);
+    
+    Barrier(const Barrier& other) = delete;
+    Barrier& operator=(const Barrier& other) = delete;
+    
+    /// @brief Arrives at the barrier and waits until all participants have arrived.
+    /// @return True for the last participant to arrive, false for all others.
+    /// @note Must be called in a non-coroutine context.
+    bool arriveAndWait();
+    
+    /// @brief Arrives at the barrier and waits until all participants have arrived.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @return True for the last participant to arrive, false for all others.
+    /// @note Must be called from a coroutine.
+    bool arriveAndWait(ICoroSync::Ptr sync);
+    
+    /// @brief Returns the number of participants.
+    /// @return The number of participants.
+    size_t numParticipants() const;
+    
+    /// @brief Returns the number of completed phases.
+    /// @return The phase number.
+    size_t phase() const;
+    
+private:
+    bool arrive(size_t& phase);
+    
+    //Members
+    const size_t        _numParticipants;
+    std::atomic_size_t  _remaining;
+    std::atomic_size_t  _phase;
+    WaitQueue           _waiters;
+};
+
+}}
+
+#include <quantum/impl/quantum_barrier_impl.h>
+
+#endif //QUANTUM_BARRIER_H
@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <deque>
+#include <vector>
 #include <quantum/quantum_future_state.h>
 #include <quantum/quantum_traits.h>
 
@@ -34,6 +35,7 @@ enum class BufferStatus
     DataReceived,   ///< Data has been successfully read from the buffer.
     DataPosted,     ///< Data has been successfully written to the buffer.
     DataPending,    ///< Buffer is empty and more data is on the way.
+    Full,           ///< Bounded buffer is at capacity. Push operations are not allowed until values are pulled.
     Closed          ///< Buffer is closed. Push operations are not allowed. Pull operations are allowed until buffer is emtpy.
 };
 
@@ -44,6 +46,7 @@ enum class BufferStatus
 /// @brief Container which allows buffered access to a series of values. Values are pushed-in (written)
 ///        by a producer(s) and pulled-out (read) by a consumer(s).
 /// @tparam T Type of the contained value.
+/// @note A bounded buffer stores its values in a ring preallocated to the requested capacity.
 /// @warning This class is not thread safe.
 template <class T, class ALLOCATOR>
 class Buffer
@@ -51,9 +54,13 @@ class Buffer
 public:
     using ValueType = T; ///< Type definition for the contained value.
     
-    /// @brief Constructor
+    /// @brief Constructor. The buffer is unbounded.
     Buffer(const ALLOCATOR& alloc = ALLOCATOR());
     
+    /// @brief Constructor. The buffer holds at most 'capacity' values.
+    /// @param[in] capacity The maximum number of values. Zero creates an unbounded buffer.
+    explicit Buffer(size_t capacity, const ALLOCATOR& alloc = ALLOCATOR());
+    
     /// @brief Pushes a value at the end of the buffer. This increases the size of the buffer by one.
     /// @tparam V Type of the contained value. Must be inferred and always equal to T.
     /// @param[in] value Value pushed into the buffer
@@ -81,8 +88,19 @@ public:
     /// @return True if empty, false otherwise.
     bool empty() const;
     
+    /// @brief Get the maximum number of values which can be stored.
+    /// @return The capacity or 0 if the buffer is unbounded.
+    size_t capacity() const;
+    
+    /// @brief Indicates if a bounded buffer is at capacity.
+    /// @return True if full, false otherwise. Always false for unbounded buffers.
+    bool isFull() const;
+    
 private:
-    std::deque<T,ALLOCATOR>     _buffer;
+    std::deque<T,ALLOCATOR>     _buffer;    //unbounded storage
+    std::vector<T,ALLOCATOR>    _ring;      //bounded storage
+    size_t                      _head;      //index of the front value in the ring
+    size_t                      _size;      //number of values in the ring
     bool                        _isClosed;
 };
 
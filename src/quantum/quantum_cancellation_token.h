@@ -0,0 +1,81 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CANCELLATION_TOKEN_H
+#define QUANTUM_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                struct CancellationException
+//==============================================================================================
+/// @struct CancellationException
+/// @brief Exception set on the future of a task which was cancelled, or thrown inside a running coroutine
+///        when it yields after its token was cancelled.
+struct CancellationException : public std::runtime_error
+{
+    CancellationException() :
+        std::runtime_error("Task cancelled")
+    {}
+};
+
+//==============================================================================================
+//                                  class CancellationToken
+//==============================================================================================
+/// @class CancellationToken.
+/// @brief Cooperative cancellation flag shared by a group of tasks.
+/// @details A token is passed when posting coroutines or IO tasks and is inherited by every coroutine and IO task
+///          posted from within a coroutine which holds it. Once cancelled:
+///          - Tasks which have not started yet are dropped by their queue and their future is set with a
+///            CancellationException. Coroutines posted after the token was cancelled are never scheduled and
+///            never get a stack.
+///          - Running coroutines get a CancellationException thrown at their next yield(). They can also poll
+///            ICoroContextBase::isCancelled() to unwind on their own, e.g. between calls to sleep().
+///          - Running IO tasks are not interrupted. They can poll isCancelled() on the token they captured.
+/// @note This class is thread safe. Cancellation cannot be undone.
+class CancellationToken
+{
+public:
+    using Ptr = std::shared_ptr<CancellationToken>;
+    
+    /// @brief Creates a token which is not cancelled.
+    static Ptr create();
+    
+    /// @brief Cancels all the tasks holding this token.
+    void cancel();
+    
+    /// @brief Checks if the token was cancelled. This is a single atomic load.
+    /// @return True if cancelled.
+    bool isCancelled() const;
+    
+    /// @brief Throws a CancellationException if the token was cancelled.
+    void throwIfCancelled() const;
+    
+private:
+    std::atomic_bool    _isCancelled{false};
+};
+
+using CancellationTokenPtr = CancellationToken::Ptr;
+
+}}
+
+#include <quantum/impl/quantum_cancellation_token_impl.h>
+
+#endif //QUANTUM_CANCELLATION_TOKEN_H
@@ -19,8 +19,15 @@
 #include <quantum/impl/quantum_stl_impl.h>
 #include <quantum/quantum_traits.h>
 #include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_allocator.h>
+#include <quantum/quantum_allocator_statistics.h>
 #include <type_traits>
 #include <assert.h>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <tuple>
 #include <array>
@@ -52,32 +59,76 @@ template <typename FUNC, typename ... ARGS>
 Capture<FUNC, ARGS...>
 makeCapture(FUNC&& func, ARGS&& ... args);
 
+//==============================================================================================
+//                                 struct FunctionAllocator
+//==============================================================================================
+/// @struct FunctionAllocator
+/// @brief Provides the memory for functors which do not fit in the inline buffer of a Function.
+/// @details Requests up to 'MaxPooledSize' bytes are rounded up to a power of two (minimum 'MinPooledSize')
+///          and served from a pool per size class. Larger requests are allocated from the heap.
+/// @note For internal use only.
+struct FunctionAllocator
+{
+    static constexpr size_t MinPooledSize = 256;
+    static constexpr size_t MaxPooledSize = 4096;
+    
+    static void* allocate(size_t size);
+    static void deallocate(void* p, size_t size);
+    
+    /// @brief Returns the statistics of the size class pools created so far, keyed by "function<size>",
+    ///        and of the heap allocations larger than 'MaxPooledSize', keyed by "functionHeap".
+    static std::map<std::string, AllocatorStatistics> stats();
+    
+private:
+    template <size_t SIZE>
+    struct Block
+    {
+        alignas(std::max_align_t) char _data[SIZE];
+    };
+    
+    template <size_t SIZE>
+    using Pool = HeapAllocator<Block<SIZE>>;
+    
+    static constexpr size_t NumSizeClasses = 5;
+    
+    template <size_t SIZE>
+    static Pool<SIZE>& pool();
+    static size_t sizeClass(size_t size);
+    static std::atomic_bool& isUsed(size_t sizeClass);
+    static std::atomic<size_t>& numHeapAllocated();
+    static std::atomic<size_t>& numHeapFallbacks();
+};
+
 //==============================================================================================
 //                                   class Function
 //==============================================================================================
 /// @class Function
 /// @brief Similar implementation to std::function except that it allows capture of non-copyable types.
-/// @note For internal use only.
-template <typename RET, typename ... ARGS>
+/// @tparam SIG The function signature.
+/// @tparam SIZE Size of the inline buffer. Larger functors are allocated via FunctionAllocator.
+///         The default is __QUANTUM_FUNCTION_ALLOC_SIZE.
+/// @note For internal use only. Copying a Function holding a non-copyable functor throws.
+template <typename SIG, size_t SIZE = __QUANTUM_FUNCTION_ALLOC_SIZE>
 class Function;
 
-template <typename RET, typename ... ARGS>
-class Function<RET(ARGS...)>
+template <typename RET, typename ... ARGS, size_t SIZE>
+class Function<RET(ARGS...), SIZE>
 {
-    static constexpr size_t size{__QUANTUM_FUNCTION_ALLOC_SIZE};
     using Func = RET(*)(ARGS...);
     using Callback = RET(*)(void*, ARGS...);
-    using Deleter = void(*)(void*);
+    enum class Op { Move, Copy, Destroy };
+    using Manager = void*(*)(Op, void* src, void* storage);
     
 public:
     // Ctors
     Function(RET(*ptr)(ARGS...)); //construct with function pointer
-    template <typename FUNCTOR>
+    template <typename FUNCTOR,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<FUNCTOR>, Function>::value>>
     Function(FUNCTOR&& functor); //construct with functor
-    Function(const Function<RET(ARGS...)>& other);
-    Function(Function<RET(ARGS...)>&& other);
-    Function& operator=(const Function<RET(ARGS...)>& other);
-    Function& operator=(Function<RET(ARGS...)>&& other);
+    Function(const Function& other);
+    Function(Function&& other);
+    Function& operator=(const Function& other);
+    Function& operator=(Function&& other);
     ~Function();
     
     // Methods
@@ -85,8 +136,17 @@ public:
     explicit operator bool() const;
     
 private:
-    static void dummyDeleter(void*) {}
-    static void deleter(void* p) { delete[] static_cast<char*>(p); }
+    template <typename FUNCTOR>
+    static constexpr bool fitsInline();
+    
+    template <typename FUNCTOR>
+    static void* manage(Op op, void* src, void* storage);
+    
+    template <typename FUNCTOR>
+    static void* copy(void* src, void* storage, std::true_type);
+    
+    template <typename FUNCTOR>
+    static void* copy(void* src, void* storage, std::false_type);
     
     template <typename FUNCTOR>
     void initFunctor(FUNCTOR&& functor, std::true_type);
@@ -94,10 +154,14 @@ private:
     template <typename FUNCTOR>
     void initFunctor(FUNCTOR&& functor, std::false_type);
     
-    std::array<char, size>  _storage;
-    void*                   _callable;
-    Callback                _callback;
-    Deleter                 _deleter;
+    void* storage() { return &_storage; }
+    bool isInline() const { return _callable == &_storage; }
+    void reset();
+    
+    typename std::aligned_storage<SIZE, alignof(std::max_align_t)>::type  _storage;
+    void*                   _callable{nullptr};
+    Callback                _callback{nullptr};
+    Manager                 _manager{nullptr}; //null if the callable is not owned
 };
 
 }}
@@ -0,0 +1,162 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CHANNEL_H
+#define QUANTUM_CHANNEL_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <quantum/quantum_mpmc_ring.h>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_wait_queue.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                        class Channel
+//==============================================================================================
+/// @class Channel.
+/// @brief Closable multi-producer multi-consumer FIFO shared by coroutines and threads.
+/// @details A bounded channel stores its values in a lock-free ring and an unbounded channel in a
+///          spinlock-protected deque. Senders and receivers are only parked when the channel is full
+///          or empty respectively, and are woken up when a value is received or sent. Once closed,
+///          sending fails and receivers drain the remaining values.
+/// @tparam T The type of the values. Must be default constructible and movable.
+template <class T>
+class Channel
+{
+public:
+    using Ptr = std::shared_ptr<Channel<T>>;
+    
+    /// @brief Constructor.
+    /// @param[in] capacity The maximum number of values the channel can hold, rounded up to the
+    ///            next power of two. Zero creates an unbounded channel.
+    explicit Channel(size_t capacity = 0);
+    
+    Channel(const Channel& other) = delete;
+    Channel& operator=(const Channel& other) = delete;
+    
+    /// @brief Sends a value, waiting while the channel is full.
+    /// @param[in] value The value to send.
+    /// @return True if the value was sent, false if the channel is closed.
+    /// @note Must be called in a non-coroutine context.
+    template <class V = T>
+    bool send(V&& value);
+    
+    /// @brief Sends a value, waiting while the channel is full.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] value The value to send.
+    /// @return True if the value was sent, false if the channel is closed.
+    /// @note Must be called from a coroutine.
+    template <class V = T>
+    bool send(ICoroSync::Ptr sync, V&& value);
+    
+    /// @brief Sends a value if the channel has room for it. Never waits.
+    /// @param[in] value The value to send. Moved from on success, left untouched otherwise.
+    /// @return True if the value was sent, false if the channel is full or closed.
+    bool trySend(T& value);
+    
+    /// @brief Receives a value, waiting while the channel is empty.
+    /// @param[out] value The received value.
+    /// @return True if a value was received, false if the channel is closed and empty.
+    /// @note Must be called in a non-coroutine context.
+    bool recv(T& value);
+    
+    /// @brief Receives a value, waiting while the channel is empty.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[out] value The received value.
+    /// @return True if a value was received, false if the channel is closed and empty.
+    /// @note Must be called from a coroutine.
+    bool recv(ICoroSync::Ptr sync, T& value);
+    
+    /// @brief Receives a value if one is available. Never waits.
+    /// @param[out] value The received value.
+    /// @return True if a value was received, false otherwise.
+    bool tryRecv(T& value);
+    
+    /// @brief Receives a value from the first of several channels to have one.
+    /// @param[in] channels The channels to receive from. Earlier channels are preferred if several have values.
+    /// @param[out] value The received value.
+    /// @return The index of the channel the value was received from, or -1 if all channels are closed and empty.
+    /// @note Must be called in a non-coroutine context.
+    static int select(const std::vector<Ptr>& channels, T& value);
+    
+    /// @brief Receives a value from the first of several channels to have one.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] channels The channels to receive from. Earlier channels are preferred if several have values.
+    /// @param[out] value The received value.
+    /// @return The index of the channel the value was received from, or -1 if all channels are closed and empty.
+    /// @note Must be called from a coroutine.
+    static int select(ICoroSync::Ptr sync, const std::vector<Ptr>& channels, T& value);
+    
+    /// @brief Closes the channel and wakes up all waiting senders and receivers.
+    void close();
+    
+    /// @brief Indicates if the channel is closed.
+    bool isClosed() const;
+    
+    /// @brief Returns the number of values in the channel.
+    /// @note The value is only an approximation while other threads are sending or receiving.
+    size_t size() const;
+    
+    /// @brief Helper function equivalent to size() == 0.
+    bool empty() const;
+    
+    /// @brief Returns the maximum number of values the channel can hold, or 0 if unbounded.
+    size_t capacity() const;
+    
+private:
+    //Waiter registered on every channel passed to select()
+    struct Selector
+    {
+        void signal();
+        
+        WaitQueue           _waiters;
+        std::atomic_bool    _isSignalled{false};
+    };
+    
+    bool push(T& value);
+    bool pop(T& value);
+    bool isFull() const;
+    void onValueSent();
+    void onValueReceived();
+    void addSelector(Selector& selector);
+    void removeSelector(Selector& selector);
+    
+    template <class WAIT>
+    static int selectImpl(const std::vector<Ptr>& channels, T& value, Selector& selector, WAIT&& wait);
+    
+    //Members
+    std::unique_ptr<MpmcRing<T>>    _ring;      //bounded channels only
+    mutable SpinLock                _spinlock;  //protects the deque
+    std::deque<T>                   _queue;     //unbounded channels only
+    std::atomic_size_t              _queueSize;
+    std::atomic_bool                _isClosed;
+    WaitQueue                       _senders;
+    WaitQueue                       _receivers;
+    SpinLock                        _selectorLock; //protects the selector list
+    std::vector<Selector*>          _selectors;
+    std::atomic_size_t              _numSelectors;
+};
+
+}}
+
+#include <quantum/impl/quantum_channel_impl.h>
+
+#endif //QUANTUM_CHANNEL_H
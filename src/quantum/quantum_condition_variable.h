@@ -16,10 +16,11 @@
 #ifndef QUANTUM_CONDITION_VARIABLE_H
 #define QUANTUM_CONDITION_VARIABLE_H
 
-#include <list>
 #include <atomic>
+#include <quantum/quantum_spinlock.h>
 #include <quantum/quantum_mutex.h>
 #include <quantum/quantum_yielding_thread.h>
+#include <quantum/quantum_futex.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/quantum_traits.h>
 
@@ -33,6 +34,9 @@ namespace quantum {
 /// @brief This class represents a coroutine-compatible implementation of the std::condition_variable.
 ///        Most methods of the latter have been recreated with the same behavior. This object will yield
 ///        instead of blocking if called from a coroutine.
+/// @details A waiting thread sleeps on a futex (Linux) until it is notified or its timeout expires, so it
+///          uses no CPU while waiting and wakes up as soon as the kernel schedules it. On other platforms it
+///          yields for ThreadTraits::yieldSleepIntervalUs() between checks.
 class ConditionVariable
 {
 public:
@@ -198,30 +202,51 @@ private:
     template <class YIELDING>
     void waitImpl(YIELDING&& yield,
                   Mutex& mutex,
-                  std::atomic_int& signal);
+                  std::atomic_int& signal,
+                  const ICoroSync::Ptr& sync);
     
     template <class YIELDING, class PREDICATE = bool()>
     void waitImpl(YIELDING&& yield,
                   Mutex& mutex,
                   PREDICATE predicate,
-                  std::atomic_int& signal);
+                  std::atomic_int& signal,
+                  const ICoroSync::Ptr& sync);
     
     template <class YIELDING, class REP, class PERIOD>
     bool waitForImpl(YIELDING&& yield,
                      Mutex& mutex,
                      std::chrono::duration<REP, PERIOD>& time,
-                     std::atomic_int& signal);
+                     std::atomic_int& signal,
+                     const ICoroSync::Ptr& sync);
     
     template <class YIELDING, class REP, class PERIOD, class PREDICATE = bool()>
     bool waitForImpl(YIELDING&& yield,
                      Mutex& mutex,
                      const std::chrono::duration<REP, PERIOD>& time,
                      PREDICATE predicate,
-                     std::atomic_int& signal);
+                     std::atomic_int& signal,
+                     const ICoroSync::Ptr& sync);
+    
+    //Node of the intrusive waiter list. Lives on the stack of the waiting coroutine or thread.
+    struct Waiter
+    {
+        std::atomic_int*    _signal;
+        ICoroSync::Ptr      _sync;              //null for threads
+        Waiter*             _prev{nullptr};
+        Waiter*             _next{nullptr};
+        bool                _isQueued{false};
+    };
+    
+    //The following must be called with _thisLock held
+    void pushBack(Waiter& waiter);
+    void remove(Waiter& waiter);
+    void notify(Waiter& waiter);
+    void notifyAllImpl();
     
     //MEMBERS
-    Mutex                           _thisLock; //sync access to this object
-    std::list<std::atomic_int*>     _waiters;
+    SpinLock                        _thisLock; //sync access to this object
+    Waiter*                         _head;
+    Waiter*                         _tail;
     std::atomic_bool                _destroyed;
 };
 
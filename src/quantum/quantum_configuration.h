@@ -17,7 +17,12 @@
 #define QUANTUM_CONFIGURATION_H
 
 #include <quantum/quantum_thread_traits.h>
+#include <quantum/interface/quantum_imetrics_sink.h>
+#include <quantum/quantum_shared_memory_queue.h>
 #include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
 
 namespace Bloomberg {
 namespace quantum {
@@ -32,6 +37,25 @@ class Configuration
 public:
      enum class BackoffPolicy : int { Linear,        ///< Linear backoff
                                       Exponential }; ///< Exponential backoff (doubles every time)
+     enum class SchedulingPolicy : int { RoundRobin,             ///< Resume coroutines in turn
+                                         EarliestDeadlineFirst }; ///< Resume the coroutine with the earliest deadline
+     enum class ThreadPlacement : int { Default,                  ///< Let the OS decide unless pinning to cores
+                                        SpreadThreadsAcrossNodes, ///< Distribute threads evenly over NUMA nodes
+                                        PackThreadsOnNodes };     ///< Fill one NUMA node with threads before using the next
+     enum class PlacementPolicy : int { LeastLoaded,       ///< Shortest of all the queues
+                                        PowerOfTwoChoices, ///< Shortest of two random queues
+                                        RoundRobin,        ///< Next queue for each posting thread
+                                        CurrentQueue };    ///< Queue of the posting coroutine
+     enum class RingFullPolicy : int { Spill,  ///< Hand the task over to an overflow list
+                                       Block,  ///< Wait until there is room in one of the rings
+                                       Fail }; ///< Throw an exception
+     enum class SchedPolicy : int { Default,    ///< Leave the OS default policy (SCHED_OTHER)
+                                    Fifo,       ///< Real-time first-in first-out (SCHED_FIFO)
+                                    RoundRobin, ///< Real-time round robin (SCHED_RR)
+                                    Batch,      ///< Non-interactive batch (SCHED_BATCH)
+                                    Idle };     ///< Lowest priority background (SCHED_IDLE)
+     using LongSliceCallback = std::function<void(int queueId, const void* taskId, std::chrono::microseconds duration)>;
+     using OverloadCallback = std::function<void(bool isIoTask, size_t numPendingTasks)>;
                            
     /// @brief Get the JSON schema corresponding to this configuration object.
     /// @return The draft-04 compatible schema.
@@ -62,6 +86,8 @@ public:
     ///              throughput if dealing with high task loads. Default is false.
     /// @note To achieve higher performance, the threads run in polling mode which
     ///       increases CPU usage even when idle.
+    /// @note The BM_IoWakeup and BM_IoIdleCpu benchmarks (see QUANTUM_ENABLE_BENCHMARKS) measure the
+    ///       wake-up latency, throughput and idle CPU of each mode for a given thread count and poll interval.
     void setLoadBalanceSharedIoQueues(bool value);
     
     /// @brief Set the interval between IO thread polls.
@@ -79,6 +105,240 @@ public:
     ///                    When the number of backoffs is reached, the poll interval remains unchanged thereafter.
     void setLoadBalancePollIntervalNumBackoffs(size_t numBackoffs);
     
+    /// @brief Enable work stealing between coroutine queues.
+    /// @oaram[in] value If set to true, a coroutine thread which runs out of work (or whose coroutines
+    ///              are all blocked) will take coroutines which have not started yet from the tail of the
+    ///              busiest sibling queue. Only coroutines posted to the 'any' queue can be stolen.
+    ///              Default is false.
+    void setCoroutineWorkStealing(bool value);
+    
+    /// @brief Set the interval at which an idle coroutine thread looks for work on sibling queues.
+    /// @oaram[in] interval Interval in microseconds. Default is 1000us.
+    /// @note Only used when work stealing is enabled.
+    void setCoroutineWorkStealingPollIntervalUs(std::chrono::microseconds interval);
+    
+    /// @brief Park blocked coroutines outside of the run queue.
+    /// @oaram[in] value If set to true, a coroutine which blocks on a future, a condition variable or any
+    ///              other signal-based primitive is moved to a separate list and is not visited by the
+    ///              scheduler until the primitive notifies it, e.g. when an IO task sets the promise the
+    ///              coroutine is waiting on. This makes scheduling cost independent of the number of blocked
+    ///              coroutines. If set to false, blocked coroutines stay in the run queue and are polled on
+    ///              every pass. Default is true.
+    void setParkBlockedCoroutines(bool value);
+    
+    /// @brief Migrate suspended coroutines to less loaded queues when they become runnable.
+    /// @oaram[in] threshold When a parked coroutine is woken up and its queue holds at least this many more
+    ///                  coroutines than the least loaded sibling queue, the coroutine resumes on the sibling
+    ///                  instead. Only coroutines posted to the 'any' queue are migrated. Set to 0 to disable.
+    ///                  Default is 0.
+    /// @note Only used when blocked coroutines are parked. See setParkBlockedCoroutines().
+    void setCoroutineMigrationThreshold(size_t threshold);
+    
+    /// @brief Set the number of times a coroutine thread spins when all its coroutines are blocked or sleeping.
+    /// @oaram[in] count Number of busy-wait iterations using a cpu pause instruction, after which the thread
+    ///              starts yielding. Default is 0.
+    void setIdleSpinCount(int count);
+    
+    /// @brief Set the number of times a coroutine thread yields after it has finished spinning.
+    /// @oaram[in] count Number of yields, after which the thread sleeps until one of its coroutines gets
+    ///              signalled, a sleeping coroutine is due or new work arrives. Set to -1 to never sleep
+    ///              on the signal and keep yielding instead. Default is -1.
+    /// @note Each yield sleeps for ThreadTraits::yieldSleepIntervalUs() (or Ms).
+    void setIdleYieldCount(int count);
+    
+    /// @brief Collect per-queue latency histograms for coroutines.
+    /// @oaram[in] value If set to true, each coroutine queue records the time coroutines wait between being
+    ///              posted and running for the first time, their total run time across all resumes and the
+    ///              number of times they were resumed. The queue also accumulates the total time spent inside
+    ///              coroutines apart from the time spent scheduling them. See IQueueStatistics. Default is false.
+    /// @note Enabling this adds two clock reads per coroutine resume.
+    void setCollectLatencyHistograms(bool value);
+    
+    /// @brief Keep track of the live coroutines so that they can be inspected at any time.
+    /// @oaram[in] value If set to true, each coroutine queue registers the coroutines posted to it along with
+    ///              their state. See Dispatcher::snapshotTasks(). Default is false.
+    /// @note Enabling this adds an allocation and two spinlock acquisitions per coroutine, and two clock reads
+    ///       per coroutine resume.
+    void setTrackTasks(bool value);
+    
+    /// @brief Set the number of priority levels for coroutines and IO tasks.
+    /// @oaram[in] num The number of levels. Level 0 is the lowest and level 'num-1' is the one used when
+    ///            posting with 'isHighPriority' set to true. Default is 2.
+    void setNumPriorityLevels(int num);
+    
+    /// @brief Set the scheduling weight between two consecutive priority levels.
+    /// @oaram[in] weight When all levels have pending work, a task at level k+1 is scheduled 'weight' times
+    ///               for every time a task at level k is scheduled. This guarantees that lower levels keep
+    ///               progressing under a flood of higher priority work. For coroutines, the weight of a level
+    ///               is the number of slices each of its coroutines gets per scheduling round, interleaved with
+    ///               the other coroutines. Default is 4.
+    void setPriorityLevelWeight(int weight);
+    
+    /// @brief Set the order in which coroutines are resumed on each coroutine thread.
+    /// @oaram[in] policy The scheduling policy. When set to 'EarliestDeadlineFirst', every time the running
+    ///               coroutine yields, the runnable coroutine with the earliest deadline is resumed next.
+    ///               Coroutines posted without a deadline run after all the others in posting order
+    ///               and priorities are ignored. Default is 'RoundRobin'.
+    void setCoroutineSchedulingPolicy(SchedulingPolicy policy);
+    
+    /// @brief Do not start coroutines which are already past their deadline.
+    /// @oaram[in] value If set to true, a coroutine whose deadline has passed before it got the chance to run
+    ///               is discarded and its future is set with an exception. Any error handler or final
+    ///               continuation still runs. Default is false.
+    void setDropExpiredCoroutines(bool value);
+    
+    /// @brief Run then() continuations as soon as the previous coroutine in the chain completes.
+    /// @oaram[in] value If set to true, a continuation which may run on the same coroutine thread takes the place
+    ///               of the completed coroutine in the run queue and is started right away, instead of being
+    ///               posted and waiting for its turn. Deep chains then run back to back at the expense of the
+    ///               other coroutines on the same thread. Default is false.
+    void setInlineContinuations(bool value);
+    
+    /// @brief Set the duration after which a coroutine which did not yield is reported as monopolizing its thread.
+    /// @oaram[in] threshold Every run slice longer than this is counted in IQueueStatistics::longSliceCount() and
+    ///                  reported via the long slice callback if one is set. Setting a non-zero value also enables
+    ///                  Dispatcher::oldestRunnableWaitTime(). Default is 0 (disabled).
+    void setLongSliceThresholdUs(std::chrono::microseconds threshold);
+    
+    /// @brief Set a function to be called every time a coroutine runs longer than the long slice threshold.
+    /// @oaram[in] callback The function receives the id of the coroutine queue, an opaque identity of the coroutine
+    ///                 and the duration of the slice. The identity is the same for all slices of a coroutine.
+    ///                 The callback runs on the coroutine thread so it must be fast and must not throw.
+    /// @note This setting is not part of the JSON schema.
+    void setLongSliceCallback(LongSliceCallback callback);
+    
+    /// @brief Set the maximum number of coroutines which can be pending in the dispatcher at any time.
+    /// @oaram[in] num Once all the coroutine queues together hold this many coroutines (running, blocked or waiting
+    ///            to run), Dispatcher::post() rejects new ones: no task, coroutine or stack is created and the
+    ///            returned context holds an OverloadException. Default is 0 (unlimited).
+    /// @note Only coroutines posted from a thread via Dispatcher::post() are rejected. Continuation chains and
+    ///       coroutines posted from within other coroutines are always accepted.
+    void setMaxPendingCoroTasks(size_t num);
+    
+    /// @brief Set the maximum number of IO tasks which can be pending in the dispatcher at any time.
+    /// @oaram[in] num Once all the IO queues together hold this many tasks, Dispatcher::postAsyncIo() rejects new ones
+    ///            and the returned future holds an OverloadException. Default is 0 (unlimited).
+    /// @note IO tasks posted from within coroutines via ICoroContext::postAsyncIo() are always accepted.
+    void setMaxPendingIoTasks(size_t num);
+    
+    /// @brief Set a function to be called every time a task is rejected because of the pending task limits.
+    /// @oaram[in] callback The function receives the kind of task which was rejected and the number of pending tasks
+    ///                 of that kind. It runs on the posting thread before post() returns, so it can be used to shed
+    ///                 the work elsewhere or to run a degraded version of it.
+    /// @note This setting is not part of the JSON schema.
+    void setOverloadCallback(OverloadCallback callback);
+    
+    /// @brief Set how coroutine and IO threads are placed on the NUMA nodes of the machine.
+    /// @oaram[in] placement When set to 'SpreadThreadsAcrossNodes', consecutive threads alternate between nodes. When set
+    ///                  to 'PackThreadsOnNodes', the cores of a node are filled up before moving to the next node.
+    ///                  In both cases coroutine threads are pinned to a single core, physical cores first, and
+    ///                  IO threads are bound to all the cores of their node. This overrides
+    ///                  setPinCoroutineThreadsToCores(). Default is 'Default' which leaves placement unchanged.
+    /// @note Only the threads are placed. Tasks, contexts and coroutine stacks are allocated by the posting thread
+    ///       from pools shared by all the nodes, so their memory is not local to the node running them.
+    void setThreadPlacement(ThreadPlacement placement);
+    
+    /// @brief Set the maximum number of coroutine threads, allowing the pool to be resized at runtime.
+    /// @oaram[in] num The number of coroutine threads which are created. Only 'numCoroutineThreads' of them
+    ///            receive coroutines posted to IQueue::QueueId::Any until Dispatcher::setNumActiveCoroutineThreads()
+    ///            is called. Inactive threads sleep without consuming any CPU. Default is -1 (same as
+    ///            'numCoroutineThreads', i.e. the pool cannot grow).
+    void setMaxNumCoroutineThreads(int num);
+    
+    /// @brief Set how a queue is picked for coroutines posted to IQueue::QueueId::Any.
+    /// @oaram[in] policy 'LeastLoaded' scans all the queues for the shortest one. 'PowerOfTwoChoices' picks the
+    ///               shorter of two random queues. 'RoundRobin' cycles through the queues using a cursor per
+    ///               posting thread. 'CurrentQueue' posts to the queue of the calling coroutine and behaves like
+    ///               'PowerOfTwoChoices' when called from any other thread. All but 'LeastLoaded' run in
+    ///               constant time. Default is 'LeastLoaded'.
+    void setCoroutinePlacementPolicy(PlacementPolicy policy);
+    
+    /// @brief Set how coroutines posted with an AffinityKey are mapped to coroutine queues.
+    /// @oaram[in] num If 0, keys are spread over all the coroutine queues and the mapping never changes. If
+    ///            positive, keys are mapped on a consistent hash ring of the active queues where each queue
+    ///            owns 'num' virtual nodes. Resizing the pool then only moves the keys owned by the added or
+    ///            removed queues. Default is 0.
+    void setAffinityVirtualNodes(int num);
+    
+    /// @brief Use lock-free ring buffers for the load-balanced shared IO queues.
+    /// @oaram[in] capacity Maximum number of tasks held by each ring, rounded up to a power of two. When
+    ///                     set to 0 (default), the shared queues are spinlocked lists instead.
+    /// @note Only applies if 'setLoadBalanceSharedIoQueues' is set. Tasks in a ring are run in FIFO order
+    ///       regardless of their priority. See 'setSharedIoRingFullPolicy' for the behavior when full.
+    void setSharedIoRingCapacity(size_t capacity);
+    
+    /// @brief Set the behavior when posting an IO task while all the shared IO rings are full.
+    /// @oaram[in] policy 'Spill' (default) moves the task to the overflow list of one of the shared queues,
+    ///                   'Block' retries until a slot becomes available and 'Fail' throws an exception.
+    void setSharedIoRingFullPolicy(RingFullPolicy policy);
+    
+    /// @brief Let load-balanced IO threads sleep until woken up once they run out of work.
+    /// @oaram[in] numPolls Number of consecutive empty polls after which an IO thread stops polling and waits
+    ///                     to be signalled by the next IO task posted. Default is 0 (always poll).
+    /// @note Only applies if 'setLoadBalanceSharedIoQueues' is set. Threads keep the polling throughput
+    ///       while busy without burning CPU or adding up to a full poll interval of latency when idle.
+    void setLoadBalanceNumPollsBeforeParking(size_t numPolls);
+    
+    /// @brief Set the maximum number of extra IO threads which can be started to serve the shared IO queue.
+    /// @oaram[in] num The maximum number of extra threads. Default is 0 (disabled).
+    /// @note A thread is added when the oldest task in the shared queue has waited longer than
+    ///       'setElasticIoSpawnThresholdMs' and no IO thread is idle. Extra threads never run tasks posted
+    ///       to a specific IO queue. Does not apply if 'setLoadBalanceSharedIoQueues' is set.
+    void setMaxNumElasticIoThreads(int num);
+    
+    /// @brief Set how long the oldest task in the shared IO queue may wait before an extra IO thread is started.
+    /// @oaram[in] threshold Threshold in milliseconds. Default is 10ms. This is also the interval at which
+    ///                      the shared queue is checked.
+    void setElasticIoSpawnThresholdMs(std::chrono::milliseconds threshold);
+    
+    /// @brief Set how long an extra IO thread may stay idle before being stopped.
+    /// @oaram[in] timeout Timeout in milliseconds. Default is 1000ms.
+    void setElasticIoIdleTimeoutMs(std::chrono::milliseconds timeout);
+    
+    /// @brief Set the CPUs on which IO threads are allowed to run.
+    /// @oaram[in] cpuList List of CPU ids and ranges such as '4-7,12'. When set, IO threads (including elastic ones)
+    ///                are bound to these CPUs, which keeps them off cores isolated for the coroutine threads.
+    ///                This overrides the IO thread placement of setThreadPlacement(). Default is empty (no binding).
+    void setIoThreadCpus(const std::string& cpuList);
+    
+    /// @brief Indicate if each IO thread should be pinned to a dedicated core.
+    /// @oaram[in] value When true, IO thread 'i' is pinned to the i-th CPU (modulo) of setIoThreadCpus(), or of
+    ///            all the cores if no list is set. When false, IO threads share the whole list. Default is False.
+    void setPinIoThreadsToCores(bool value);
+    
+    /// @brief Set the OS scheduling policy of the IO threads.
+    /// @oaram[in] policy The policy. 'Fifo' and 'RoundRobin' are real-time policies which usually require elevated
+    ///            privileges; if the policy cannot be applied the threads keep the default one. Default is 'Default'.
+    void setIoThreadSchedPolicy(SchedPolicy policy);
+    
+    /// @brief Set the OS scheduling priority of the IO threads.
+    /// @oaram[in] priority The static priority used with the 'Fifo' and 'RoundRobin' policies, typically in
+    ///            the range [1, 99]. Ignored by the other policies. Default is 0.
+    void setIoThreadSchedPriority(int priority);
+    
+    /// @brief Set the sink receiving the metrics of the dispatcher.
+    /// @oaram[in] sink The sink. When set, the dispatcher collects the metrics of its queues, of the allocators and
+    ///            of the sources registered via Dispatcher::setMetricsSource() once per export period and publishes
+    ///            them from a low priority thread. Default is null (no export).
+    void setMetricsSink(IMetricsSink::Ptr sink);
+    
+    /// @brief Set the metrics export period.
+    /// @oaram[in] period The period. Default is 1000ms.
+    void setMetricsExportPeriodMs(std::chrono::milliseconds period);
+    
+    /// @brief Set a queue shared with other processes, from which the IO threads take work when idle.
+    /// @oaram[in] queue The queue with its handlers registered. Each IO thread which runs out of local work pops a
+    ///            message from it and runs the handler in this process, so that processes sharing the queue balance
+    ///            their load. Default is null (no shared memory queue).
+    /// @note Posts from other processes cannot wake up an idle thread, so IO threads poll the queue while idle.
+    ///       See setSharedMemoryQueuePollIntervalMs().
+    void setSharedMemoryQueue(SharedMemoryQueue::Ptr queue);
+    
+    /// @brief Set the interval at which idle IO threads poll the shared memory queue.
+    /// @oaram[in] interval The interval. Default is 10ms. When 'loadBalanceSharedIoQueues' is set, the IO threads
+    ///            poll it along with the shared IO queues instead, at 'loadBalancePollIntervalMs', and never park.
+    void setSharedMemoryQueuePollIntervalMs(std::chrono::milliseconds interval);
+    
     /// @brief Get the number of coroutine threads.
     /// @return The number of threads.
     int getNumCoroutineThreads() const;
@@ -107,6 +367,155 @@ public:
     /// @return The number of backoffs.
     size_t getLoadBalancePollIntervalNumBackoffs() const;
     
+    /// @brief Check if work stealing between coroutine queues is enabled.
+    /// @return True or False.
+    bool getCoroutineWorkStealing() const;
+    
+    /// @brief Get the work stealing poll interval.
+    /// @return The number of microseconds.
+    std::chrono::microseconds getCoroutineWorkStealingPollIntervalUs() const;
+    
+    /// @brief Check if blocked coroutines are parked outside of the run queue.
+    /// @return True or False.
+    bool getParkBlockedCoroutines() const;
+    
+    /// @brief Get the load difference above which woken up coroutines migrate to a sibling queue.
+    /// @return The threshold or 0 if disabled.
+    size_t getCoroutineMigrationThreshold() const;
+    
+    /// @brief Get the number of idle spin iterations.
+    /// @return The number of iterations.
+    int getIdleSpinCount() const;
+    
+    /// @brief Get the number of idle yields before sleeping.
+    /// @return The number of yields.
+    int getIdleYieldCount() const;
+    
+    /// @brief Check if latency histograms are collected.
+    /// @return True or False.
+    bool getCollectLatencyHistograms() const;
+    
+    /// @brief Check if the live coroutines are tracked.
+    /// @return True or False.
+    bool getTrackTasks() const;
+    
+    /// @brief Get the number of priority levels.
+    /// @return The number of levels.
+    int getNumPriorityLevels() const;
+    
+    /// @brief Get the weight between two consecutive priority levels.
+    /// @return The weight.
+    int getPriorityLevelWeight() const;
+    
+    /// @brief Get the scheduling weight of each priority level.
+    /// @return A vector of size 'getNumPriorityLevels()' where level k has weight 'getPriorityLevelWeight()^k'.
+    /// @note Throws if the priority level settings are invalid.
+    std::vector<size_t> getPriorityLevelWeights() const;
+    
+    /// @brief Get the coroutine scheduling policy.
+    /// @return The policy.
+    SchedulingPolicy getCoroutineSchedulingPolicy() const;
+    
+    /// @brief Check if expired coroutines are dropped.
+    /// @return True if dropped.
+    bool getDropExpiredCoroutines() const;
+    
+    /// @brief Check if continuations run inline.
+    /// @return True if inline.
+    bool getInlineContinuations() const;
+    
+    /// @brief Get the long slice threshold.
+    /// @return The threshold in microseconds.
+    std::chrono::microseconds getLongSliceThresholdUs() const;
+    
+    /// @brief Get the long slice callback.
+    /// @return The callback or an empty function if not set.
+    const LongSliceCallback& getLongSliceCallback() const;
+    
+    /// @brief Get the maximum number of pending coroutines.
+    /// @return The limit or 0 if unlimited.
+    size_t getMaxPendingCoroTasks() const;
+    
+    /// @brief Get the maximum number of pending IO tasks.
+    /// @return The limit or 0 if unlimited.
+    size_t getMaxPendingIoTasks() const;
+    
+    /// @brief Get the function called when a task is rejected.
+    /// @return The callback or an empty function.
+    const OverloadCallback& getOverloadCallback() const;
+    
+    /// @brief Get the thread placement policy.
+    /// @return The policy.
+    ThreadPlacement getThreadPlacement() const;
+    
+    /// @brief Get the maximum number of coroutine threads.
+    /// @return The number of threads.
+    int getMaxNumCoroutineThreads() const;
+    
+    /// @brief Get the coroutine placement policy.
+    /// @return The policy.
+    PlacementPolicy getCoroutinePlacementPolicy() const;
+    
+    /// @brief Get the number of virtual nodes per queue used for affinity routing.
+    /// @return The number of virtual nodes.
+    int getAffinityVirtualNodes() const;
+    
+    /// @brief Get the capacity of each shared IO ring buffer.
+    /// @return The capacity or 0 if disabled.
+    size_t getSharedIoRingCapacity() const;
+    
+    /// @brief Get the shared IO ring full policy.
+    /// @return The policy.
+    RingFullPolicy getSharedIoRingFullPolicy() const;
+    
+    /// @brief Get the number of empty polls before a load-balanced IO thread goes to sleep.
+    /// @return The number of polls or 0 if disabled.
+    size_t getLoadBalanceNumPollsBeforeParking() const;
+    
+    /// @brief Get the maximum number of extra IO threads.
+    /// @return The number of threads.
+    int getMaxNumElasticIoThreads() const;
+    
+    /// @brief Get the wait time threshold for starting extra IO threads.
+    /// @return The threshold.
+    std::chrono::milliseconds getElasticIoSpawnThresholdMs() const;
+    
+    /// @brief Get the idle timeout of extra IO threads.
+    /// @return The timeout.
+    std::chrono::milliseconds getElasticIoIdleTimeoutMs() const;
+    
+    /// @brief Get the CPUs on which IO threads are allowed to run.
+    /// @return The CPU list.
+    std::string getIoThreadCpus() const;
+    
+    /// @brief Get the IO thread dedicated core setting.
+    /// @return True or False.
+    bool getPinIoThreadsToCores() const;
+    
+    /// @brief Get the OS scheduling policy of the IO threads.
+    /// @return The policy.
+    SchedPolicy getIoThreadSchedPolicy() const;
+    
+    /// @brief Get the OS scheduling priority of the IO threads.
+    /// @return The priority.
+    int getIoThreadSchedPriority() const;
+    
+    /// @brief Get the metrics sink.
+    /// @return The sink or null.
+    const IMetricsSink::Ptr& getMetricsSink() const;
+    
+    /// @brief Get the metrics export period.
+    /// @return The period.
+    std::chrono::milliseconds getMetricsExportPeriodMs() const;
+    
+    /// @brief Get the shared memory queue.
+    /// @return The queue or null.
+    const SharedMemoryQueue::Ptr& getSharedMemoryQueue() const;
+    
+    /// @brief Get the interval at which idle IO threads poll the shared memory queue.
+    /// @return The interval.
+    std::chrono::milliseconds getSharedMemoryQueuePollIntervalMs() const;
+    
 private:
     int                         _numCoroutineThreads{-1};
     int                         _numIoThreads{5};
@@ -115,6 +524,42 @@ private:
     std::chrono::milliseconds   _loadBalancePollIntervalMs{100};
     BackoffPolicy               _loadBalancePollIntervalBackoffPolicy{BackoffPolicy::Linear};
     size_t                      _loadBalancePollIntervalNumBackoffs{0};
+    bool                        _coroutineWorkStealing{false};
+    std::chrono::microseconds   _coroutineWorkStealingPollIntervalUs{1000};
+    bool                        _parkBlockedCoroutines{true};
+    size_t                      _coroutineMigrationThreshold{0};
+    int                         _idleSpinCount{0};
+    int                         _idleYieldCount{-1};
+    bool                        _collectLatencyHistograms{false};
+    bool                        _trackTasks{false};
+    int                         _numPriorityLevels{2};
+    int                         _priorityLevelWeight{4};
+    SchedulingPolicy            _coroutineSchedulingPolicy{SchedulingPolicy::RoundRobin};
+    bool                        _dropExpiredCoroutines{false};
+    bool                        _inlineContinuations{false};
+    std::chrono::microseconds   _longSliceThresholdUs{0};
+    LongSliceCallback           _longSliceCallback;
+    size_t                      _maxPendingCoroTasks{0};
+    size_t                      _maxPendingIoTasks{0};
+    OverloadCallback            _overloadCallback;
+    ThreadPlacement             _threadPlacement{ThreadPlacement::Default};
+    int                         _maxNumCoroutineThreads{-1};
+    PlacementPolicy             _coroutinePlacementPolicy{PlacementPolicy::LeastLoaded};
+    int                         _affinityVirtualNodes{0};
+    size_t                      _sharedIoRingCapacity{0};
+    RingFullPolicy              _sharedIoRingFullPolicy{RingFullPolicy::Spill};
+    size_t                      _loadBalanceNumPollsBeforeParking{0};
+    int                         _maxNumElasticIoThreads{0};
+    std::chrono::milliseconds   _elasticIoSpawnThresholdMs{10};
+    std::chrono::milliseconds   _elasticIoIdleTimeoutMs{1000};
+    std::string                 _ioThreadCpus{};
+    bool                        _pinIoThreadsToCores{false};
+    SchedPolicy                 _ioThreadSchedPolicy{SchedPolicy::Default};
+    int                         _ioThreadSchedPriority{0};
+    IMetricsSink::Ptr           _metricsSink;
+    std::chrono::milliseconds   _metricsExportPeriodMs{1000};
+    SharedMemoryQueue::Ptr      _sharedMemoryQueue;
+    std::chrono::milliseconds   _sharedMemoryQueuePollIntervalMs{10};
 };
 
 }}
@@ -21,6 +21,7 @@
 #include <quantum/quantum_io_task.h>
 #include <quantum/quantum_dispatcher_core.h>
 #include <quantum/quantum_traits.h>
+#include <quantum/quantum_small_vector.h>
 #include <iterator>
 
 namespace Bloomberg {
@@ -36,12 +37,16 @@ template <class RET>
 class Context : public IThreadContext<RET>,
                 public ICoroContext<RET>,
                 public ITaskAccessor,
+                public CoroutineState,
                 public std::enable_shared_from_this<Context<RET>>
 {
     friend class Util;
     friend class Task;
     friend class Dispatcher;
     template <class OTHER_RET> friend class Context;
+    template <class T> friend class FutureJoiner;
+    friend class TaskGroup;
+    template <class T, class POOL> friend struct SharedAllocator;
     
 public:
     using Ptr = std::shared_ptr<Context<RET>>;
@@ -65,6 +70,15 @@ public:
     ITask::Ptr getTask() const final;
     bool isBlocked() const final;
     bool isSleeping(bool updateTimer = false) final;
+    std::chrono::high_resolution_clock::time_point getSleepDeadline() const final;
+    
+    //Coroutine stack size used by this context and inherited by its continuations. 0 selects the default size.
+    void setStackSize(size_t stackSize);
+    size_t getStackSize() const;
+    
+    //Cancellation token of this coroutine, inherited by its continuations and by all the tasks it posts.
+    void setCancellationToken(CancellationToken::Ptr token);
+    const CancellationToken::Ptr& getCancellationToken() const;
 
     //===================================
     //         ICONTEXTBASE
@@ -89,16 +103,24 @@ public:
     NonBufferRetType<V> get();
     template <class V = RET>
     const NonBufferRetType<V>& getRef() const;
+    template <class V = RET>
+    SharedFuture<NonBufferRetType<V>> share() const;
     template <class V, class = NonBufferType<RET,V>>
     int set(V&& value);
     template <class V, class = BufferType<RET,V>>
     void push(V&& value);
     template <class V = RET>
     BufferRetType<V> pull(bool& isBufferClosed);
+    template <class ITER, class V = RET, class = BufferRetType<V>>
+    void pushBatch(ITER first, ITER last);
+    template <class V = RET>
+    std::vector<BufferRetType<V>> pullBatch(size_t maxItems, bool& isBufferClosed);
     template <class OTHER_RET>
     NonBufferRetType<OTHER_RET> getAt(int num);
     template <class OTHER_RET>
     const NonBufferRetType<OTHER_RET>& getRefAt(int num) const;
+    template <class FUNC>
+    void onReady(FUNC&& callback);
     
     //===================================
     //        ICOROCONTEXTBASE
@@ -108,6 +130,9 @@ public:
     void wait(ICoroSync::Ptr sync) const final;
     std::future_status waitFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs) const final;
     void waitAll(ICoroSync::Ptr sync) const final;
+    bool isCancelled() const final;
+    CoroLocalStorage& localStorage() final;
+    CoroArena& arena() final;
     
     //===================================
     //         ICOROCONTEXT
@@ -116,17 +141,29 @@ public:
     NonBufferRetType<V> get(ICoroSync::Ptr sync);
     template <class V = RET>
     const NonBufferRetType<V>& getRef(ICoroSync::Ptr sync) const;
+    template <class V = RET>
+    bool getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value);
+    template <class CLOCK, class DURATION, class V = RET>
+    bool getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value);
     template <class V, class = NonBufferType<RET,V>>
     int set(ICoroSync::Ptr sync, V&& value);
     template <class V, class = BufferType<RET,V>>
     void push(ICoroSync::Ptr sync, V&& value);
     template <class V = RET>
     BufferRetType<V> pull(ICoroSync::Ptr sync, bool& isBufferClosed);
+    template <class ITER, class V = RET, class = BufferRetType<V>>
+    void pushBatch(ICoroSync::Ptr sync, ITER first, ITER last);
+    template <class V = RET>
+    std::vector<BufferRetType<V>> pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed);
     template <class OTHER_RET>
     NonBufferRetType<OTHER_RET> getAt(int num, ICoroSync::Ptr sync);
     template <class OTHER_RET>
     const NonBufferRetType<OTHER_RET>& getRefAt(int num, ICoroSync::Ptr sync) const;
     template <class OTHER_RET>
+    bool getForAt(int num, ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<OTHER_RET>& value);
+    template <class OTHER_RET, class CLOCK, class DURATION>
+    bool getUntilAt(int num, ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<OTHER_RET>& value);
+    template <class OTHER_RET>
     NonBufferRetType<OTHER_RET> getPrev(ICoroSync::Ptr sync);
     template <class OTHER_RET>
     const NonBufferRetType<OTHER_RET>& getPrevRef(ICoroSync::Ptr sync);
@@ -138,6 +175,7 @@ public:
     Traits::Yield& getYieldHandle() final;
     void yield() final;
     std::atomic_int& signal() final;
+    void notify() final;
     void sleep(const std::chrono::milliseconds& timeMs) final;
     void sleep(const std::chrono::microseconds& timeUs) final;
     
@@ -146,6 +184,8 @@ public:
     //===================================
     template <class V = RET, class = BufferRetType<V>>
     int closeBuffer();
+    template <class V = RET, class = BufferRetType<V>>
+    int setBufferCapacity(size_t capacity);
     int getNumCoroutineThreads() const;
     int getNumIoThreads() const;
     
@@ -160,6 +200,18 @@ public:
     typename Context<OTHER_RET>::Ptr
     post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    post(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<CoroContextPtr<OTHER_RET>>
+    postBatch(INPUT_IT first, INPUT_IT last);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<CoroContextPtr<OTHER_RET>>
+    postBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last);
+    
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
     postFirst(FUNC&& func, ARGS&&... args);
@@ -168,6 +220,10 @@ public:
     typename Context<OTHER_RET>::Ptr
     postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postFirst(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
     then(FUNC&& func, ARGS&&... args);
@@ -193,6 +249,35 @@ public:
     CoroFuturePtr<OTHER_RET>
     postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIo(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(INPUT_IT first, INPUT_IT last);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIoGroup(const std::string& group, FUNC&& func, ARGS&&... args);
+    
+#if defined(__linux__)
+    //===================================
+    //           ASYNC IO
+    //===================================
+    int awaitReadable(int fd, std::chrono::milliseconds timeMs);
+    
+    int awaitWritable(int fd, std::chrono::milliseconds timeMs);
+    
+    ssize_t read(int fd, void* buf, size_t count);
+    
+    ssize_t write(int fd, const void* buf, size_t count);
+#endif
+    
     //===================================
     //           FOR EACH
     //===================================
@@ -212,6 +297,18 @@ public:
     typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
     forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
     
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    forEachChunked(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, size_t grainSize);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    forEachChunked(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, size_t grainSize);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatchSplit(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, size_t grainSize);
+    
     //===================================
     //           MAP REDUCE
     //===================================
@@ -257,12 +354,101 @@ public:
                    Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
     
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<RESULT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                         size_t numPartitions,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT,
+              class INPUT_IT>
+    typename Context<RESULT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                         size_t numPartitions,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT,
+              class T>
+    typename Context<RESULT>::Ptr
+    mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                    Functions::StreamMapFunc<KEY, MAPPED_TYPE, T> mapper,
+                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                    size_t numPartitions,
+                    Functions::CombineFunc<MAPPED_TYPE> combiner);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           INPUT_IT last,
+           OTHER_RET init,
+           Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           size_t num,
+           OTHER_RET init,
+           Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    INPUT_IT last,
+                    OTHER_RET init,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                    Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    size_t num,
+                    OTHER_RET init,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform,
+                    Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  size_t num,
+                  Functions::BinaryOpFunc<OTHER_RET> op);
+    
+    template <class RANDOM_IT,
+              class COMPARE,
+              class = Traits::IsInputIterator<RANDOM_IT>>
+    std::shared_ptr<Context<int>>
+    sort(RANDOM_IT first,
+         RANDOM_IT last,
+         COMPARE comp);
+    
     //===================================
-    //           NEW / DELETE
+    //           CREATE
     //===================================
-    static void* operator new(size_t size);
-    static void operator delete(void* p);
-    static void deleter(Context<RET>* p);
+    /// @brief Creates a new object. It shares a single pool block with its reference counts.
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
     explicit Context(DispatcherCore& dispatcher);
@@ -278,27 +464,32 @@ private:
 
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
-    postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&& func, ARGS&&... args);
+    postImpl(int queueId, int priority, ITask::Type type, FUNC&& func, ARGS&&... args);
     
     template <class OTHER_RET, class FUNC, class ... ARGS>
     CoroFuturePtr<OTHER_RET>
-    postAsyncIoImpl(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    postAsyncIoImpl(int queueId, int priority, FUNC&& func, ARGS&&... args);
     
     int index(int num) const;
     
+#if defined(__linux__)
+    int awaitFd(int fd, Reactor::Direction direction, std::chrono::milliseconds timeMs);
+#endif
+    
     void validateTaskType(ITask::Type type) const; //throws
     
     void validateContext(ICoroSync::Ptr sync) const; //throws
     
     //Members
     ITask::Ptr                          _task;
-    std::vector<IPromiseBase::Ptr>      _promises;
+    SmallVector<IPromiseBase::Ptr, __QUANTUM_CONTEXT_INLINE_PROMISES> _promises; //one per continuation
     DispatcherCore*                     _dispatcher;
     std::atomic_flag                    _terminated;
-    std::atomic_int                     _signal;
     Traits::Yield*                      _yield;
-    std::chrono::microseconds           _sleepDuration;
-    std::chrono::high_resolution_clock::time_point  _sleepTimestamp;
+    size_t                              _stackSize;
+    CancellationToken::Ptr              _cancellationToken;
+    CoroLocalStorage                    _localStorage;
+    CoroArena                           _arena;
 };
 
 template <class RET>
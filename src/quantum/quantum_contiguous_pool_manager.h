@@ -16,12 +16,18 @@
 #ifndef QUANTUM_POOL_MANAGER_H
 #define QUANTUM_POOL_MANAGER_H
 
+#include <algorithm>
 #include <memory>
 #include <assert.h>
 #include <limits>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_allocator_statistics.h>
+#include <quantum/quantum_huge_pages.h>
+#include <quantum/quantum_thread_cache.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -32,8 +38,10 @@ namespace quantum {
 /// @struct ContiguousPoolManager.
 /// @brief Provides fast (quasi zero-time) in-place allocation for STL containers.
 ///        Objects are allocated from a contiguous buffer (aka object pool). When the
-///        buffer is exhausted, allocation is delegated to the heap. The default
-///        buffer size is 1000.
+///        buffer is exhausted, the pool grows by contiguous segments if
+///        AllocatorTraits::poolSegmentSize() is set, otherwise allocation is delegated
+///        to the heap. The default buffer size is 1000. Single object allocations are
+///        served from a per-thread cache when AllocatorTraits::threadCacheSize() is set.
 /// @tparam T The type to allocate.
 /// @note This allocator is thread safe. For internal use only.
 template <typename T>
@@ -75,15 +83,35 @@ struct ContiguousPoolManager
     void dispose(pointer p);
     size_t allocatedBlocks() const;
     size_t allocatedHeapBlocks() const;
+    size_t numSegments() const;
+    AllocatorStatistics stats() const;
     bool isFull() const;
     bool isEmpty() const;
+    void warmUp(size_type num); //commits the pages of the next 'num' free blocks
     
 private:
+    struct Segment
+    {
+        explicit Segment(index_type size);
+        
+        std::unique_ptr<aligned_type[]> _buffer;
+        std::unique_ptr<index_type[]>   _freeBlocks;
+        ssize_t                         _freeBlockIndex;
+        index_type                      _size;
+        bool                            _available; //listed in _availableSegments
+    };
+    
     pointer bufferStart();
     pointer bufferEnd();
     bool isManaged(pointer p);
     index_type blockIndex(pointer p);
     bool findContiguous(index_type n);
+    bool refill(ThreadCache::Magazine& magazine, index_type& index);
+    void flush(ThreadCache::Magazine& magazine);
+    pointer allocateFromSegment();
+    bool deallocateToSegment(pointer p);
+    void releaseSegment(Segment* segment);
+    void updatePeak();
 
     //------------------------------- Members ----------------------------------
     index_type          _size{0};
@@ -91,7 +119,16 @@ private:
     index_type*         _freeBlocks{nullptr};
     ssize_t             _freeBlockIndex{-1};
     size_t              _numHeapAllocatedBlocks{0};
-    mutable SpinLock    _spinlock;
+    mutable PaddedSpinLock _spinlock{LockProfiler::site<ContiguousPoolManager>("ContiguousPoolManager")};
+    ThreadCache         _cache{AllocatorTraits::threadCacheSize()};
+    index_type          _segmentSize{AllocatorTraits::poolSegmentSize()};
+    bool                _releaseIdleSegments{AllocatorTraits::releaseIdlePoolSegments()};
+    std::vector<Segment*> _segments;            //sorted by buffer address
+    std::vector<Segment*> _availableSegments;   //segments with at least one free block
+    size_t              _numSegmentAllocatedBlocks{0};
+    size_t              _peakAllocatedBlocks{0};
+    size_t              _numHeapFallbacks{0};
+    mutable std::atomic<size_t> _lockContentionCount{0};
 };
 
 }} //namespaces
@@ -0,0 +1,147 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CORO_ARENA_H
+#define QUANTUM_CORO_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <quantum/quantum_allocator_traits.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     class CoroArena
+//==============================================================================================
+/// @class CoroArena.
+/// @brief Bump allocator owned by a coroutine context for short-lived data which dies with the coroutine.
+/// @details Memory is carved out of fixed-size chunks (see AllocatorTraits::coroArenaChunkSize()) by advancing
+///          a pointer, so an allocation never takes a lock. Individual deallocations are ignored except for the
+///          most recent allocation, which is reclaimed. All the chunks are released at once when the coroutine
+///          returns, into a cache owned by the releasing thread, normally the coroutine thread, from which the next
+///          coroutines running there take their chunks. Requests larger than a chunk get a dedicated block which
+///          is freed on release.
+/// @warning Objects allocated from the arena must not outlive the coroutine, e.g. they cannot be part of its
+///          return value. Not thread safe: only use the arena from the coroutine owning it.
+class CoroArena
+{
+public:
+    CoroArena() = default;
+    CoroArena(const CoroArena&) = delete;
+    CoroArena& operator=(const CoroArena&) = delete;
+    ~CoroArena();
+    
+    /// @brief Allocates memory from the arena.
+    /// @param[in] size Number of bytes.
+    /// @param[in] alignment Required alignment. Must be a power of two.
+    /// @return Pointer to the memory. Throws std::bad_alloc if the system is out of memory.
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    
+    /// @brief Returns memory to the arena. Only the most recent allocation is actually reclaimed.
+    /// @param[in] ptr Pointer returned by allocate().
+    /// @param[in] size Number of bytes passed to allocate().
+    void deallocate(void* ptr, size_t size);
+    
+    /// @brief Releases all the memory of the arena. Called automatically when the coroutine returns.
+    /// @note Standard chunks are cached by the calling thread for reuse, up to AllocatorTraits::coroArenaCacheSize().
+    void release();
+    
+    /// @brief Number of bytes currently held by the arena, including unused space in its chunks.
+    size_t capacity() const;
+    
+private:
+    struct Chunk
+    {
+        Chunk*  _next;
+        size_t  _size; //total size including this header
+    };
+    struct ChunkCache;
+    
+    static ChunkCache& threadCache();
+    static size_t chunkSize();
+    static size_t headerSize();
+    void* allocateDedicated(size_t size, size_t alignment);
+    
+    Chunk*      _chunks{nullptr};
+    char*       _cursor{nullptr};
+    char*       _end{nullptr};
+    size_t      _capacity{0};
+};
+
+//==============================================================================================
+//                                   struct ArenaAllocator
+//==============================================================================================
+/// @struct ArenaAllocator.
+/// @brief STL allocator drawing from a CoroArena, e.g. ArenaAllocator<int>(ctx->arena()).
+/// @tparam T The type to allocate.
+/// @note Containers using it must be destroyed before the coroutine returns.
+template <typename T>
+struct ArenaAllocator
+{
+    //------------------------------ Typedefs ----------------------------------
+    typedef ArenaAllocator<T>       this_type;
+    typedef T                       value_type;
+    typedef value_type*             pointer;
+    typedef const value_type*       const_pointer;
+    typedef value_type&             reference;
+    typedef const value_type&       const_reference;
+    typedef size_t                  size_type;
+    typedef std::ptrdiff_t          difference_type;
+    typedef std::true_type          propagate_on_container_move_assignment;
+    typedef std::true_type          propagate_on_container_copy_assignment;
+    typedef std::true_type          propagate_on_container_swap;
+    typedef std::false_type         is_always_equal;
+    
+    template <typename U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+    //------------------------------- Methods ----------------------------------
+    explicit ArenaAllocator(CoroArena& arena) : _arena(&arena)
+    {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : _arena(&other.arena())
+    {}
+    pointer allocate(size_type n, const_pointer = 0) {
+        return static_cast<pointer>(_arena->allocate(n * sizeof(value_type), alignof(value_type)));
+    }
+    void deallocate(pointer p, size_type n) {
+        _arena->deallocate(p, n * sizeof(value_type));
+    }
+    CoroArena& arena() const {
+        return *_arena;
+    }
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return _arena == &other.arena();
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return _arena != &other.arena();
+    }
+    
+private:
+    //------------------------------- Members ----------------------------------
+    CoroArena*  _arena;
+};
+
+}}
+
+#include <quantum/impl/quantum_coro_arena_impl.h>
+
+#endif //QUANTUM_CORO_ARENA_H
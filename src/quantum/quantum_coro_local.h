@@ -0,0 +1,109 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CORO_LOCAL_H
+#define QUANTUM_CORO_LOCAL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#ifndef __QUANTUM_CORO_LOCAL_SLOTS
+    #define __QUANTUM_CORO_LOCAL_SLOTS 8 //coroutine-local slots stored inline in each context
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                  class CoroLocalStorage
+//==============================================================================================
+/// @class CoroLocalStorage.
+/// @brief Fixed array of coroutine-local slots stored inline in each coroutine context.
+/// @details Slots hold non-owning pointers and are addressed by the index of a CoroLocal key, so an access is
+///          a single array lookup. Nothing is allocated. When a coroutine posts another coroutine or when a
+///          continuation is chained, the slots of inheritable keys are copied into the new context at that moment.
+///          Values set afterwards in the parent are not seen by the child.
+/// @note Not thread safe. A context's slots should only be accessed from the coroutine running on it,
+///       or before it is posted.
+class CoroLocalStorage
+{
+public:
+    static constexpr int Size = __QUANTUM_CORO_LOCAL_SLOTS;
+    
+    /// @brief Returns the value stored in a slot or nullptr if the slot was never set.
+    void* get(int slot) const;
+    
+    /// @brief Stores a value in a slot. Setting nullptr clears it.
+    void set(int slot, void* value);
+    
+    /// @brief Copies the slots of all inheritable keys from another storage.
+    void inherit(const CoroLocalStorage& other);
+    
+private:
+    template <class T>
+    friend class CoroLocal;
+    
+    static int allocateSlot(bool inherit); //throws
+    static std::atomic<uint64_t>& inheritableMask();
+    
+    uint64_t    _setMask{0}; //slots which hold a value. Only these are read from _values.
+    void*       _values[Size];
+};
+
+//==============================================================================================
+//                                      class CoroLocal
+//==============================================================================================
+/// @class CoroLocal.
+/// @brief Key to a coroutine-local slot holding a T*.
+/// @details Each key takes one of the __QUANTUM_CORO_LOCAL_SLOTS slots for the lifetime of the process, hence keys
+///          should be static or global objects. A typical use is to attach a per-request arena to the coroutine
+///          handling the request so that every coroutine it posts finds it without any lookup.
+/// @note The pointed-to object is not owned. It must outlive all the coroutines which may read it.
+template <class T>
+class CoroLocal
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] inherit If true, the value is copied into coroutines posted from a coroutine holding it
+    ///                    as well as into its continuations.
+    /// @note Throws if all the slots are taken.
+    explicit CoroLocal(bool inherit = true);
+    
+    /// @brief Returns the value for this key or nullptr if none was set.
+    T* get(const CoroLocalStorage& storage) const;
+    
+    /// @brief Sets the value for this key.
+    void set(CoroLocalStorage& storage, T* value) const;
+    
+    /// @brief Convenience overloads taking a coroutine context (i.e. ICoroContextPtr).
+    template <class CTX>
+    T* get(const std::shared_ptr<CTX>& ctx) const;
+    template <class CTX>
+    void set(const std::shared_ptr<CTX>& ctx, T* value) const;
+    
+    /// @brief Index of the slot used by this key.
+    int slot() const;
+    
+private:
+    int     _slot;
+};
+
+}}
+
+#include <quantum/impl/quantum_coro_local_impl.h>
+
+#endif //QUANTUM_CORO_LOCAL_H
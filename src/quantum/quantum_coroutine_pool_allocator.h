@@ -19,21 +19,64 @@
 #include <memory>
 #include <assert.h>
 #include <limits>
+#include <map>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_allocator_statistics.h>
+#include <quantum/quantum_histogram.h>
+#include <quantum/quantum_huge_pages.h>
+#include <quantum/quantum_thread_cache.h>
 #include <boost/context/stack_context.hpp>
 
 namespace Bloomberg {
 namespace quantum {
 
+//==============================================================================
+//                             struct CoroStackTag
+//==============================================================================
+/// @struct CoroStackTag.
+/// @brief Tags the coroutine stacks allocated by the current thread while this
+///        object is in scope, i.e. by post() and then() calls. When stack profiling
+///        is enabled, the peak usage of these stacks is also recorded under the tag.
+///        See AllocatorTraits::profileCoroStacks(). The tag is also reported for
+///        the coroutines listed by Dispatcher::snapshotTasks().
+/// @note The tag string must outlive all the coroutines posted in scope. String
+///       literals are recommended.
+struct CoroStackTag
+{
+    explicit CoroStackTag(const char* tag) : _previous(current()) { currentRef() = tag; }
+    CoroStackTag(const CoroStackTag&) = delete;
+    CoroStackTag& operator=(const CoroStackTag&) = delete;
+    ~CoroStackTag() { currentRef() = _previous; }
+    
+    /// @brief The tag applied to stacks allocated by this thread or nullptr.
+    static const char* current() { return currentRef(); }
+    
+private:
+    static const char*& currentRef() {
+        static thread_local const char* tag = nullptr;
+        return tag;
+    }
+    const char* _previous;
+};
+
 //==============================================================================
 //                        struct CoroutinePoolAllocator
 //==============================================================================
 /// @struct CoroutinePoolAllocator.
 /// @brief Provides fast (quasi zero-time) in-place allocation for coroutines.
-///        Coroutine stacks are pre-allocated from separate (i.e. non-contiguous)
-///        heap blocks and maintained in a reusable list.
+///        Coroutine stacks are allocated from the heap in chunks of
+///        AllocatorTraits::coroPoolChunkSize() stacks the first time they are
+///        needed, and maintained in a reusable list. When guarded stacks are
+///        enabled (see AllocatorTraits::useGuardedCoroStacks()), all stacks are
+///        mapped from a single virtual memory reservation instead, each with a
+///        PROT_NONE guard page below it, and pages are committed lazily. Otherwise,
+///        when huge pages are enabled (see AllocatorTraits::useHugePages()), all
+///        stacks are carved out of a single huge page backed region. Free stacks
+///        are cached per thread when AllocatorTraits::threadCacheSize() is set.
 /// @note This allocator is thread safe. For internal use only and is meant to
 ///       replace the boost fixed size pool allocator which crashes.
 template <typename STACK_TRAITS>
@@ -46,7 +89,7 @@ struct CoroutinePoolAllocator
     typedef STACK_TRAITS                          traits;
     
     //------------------------------- Methods ----------------------------------
-    CoroutinePoolAllocator(index_type size);
+    CoroutinePoolAllocator(index_type size, size_t stackSize = 0); //0 uses the default stack size
     CoroutinePoolAllocator(const this_type&) = delete;
     CoroutinePoolAllocator(this_type&&);
     CoroutinePoolAllocator& operator=(const this_type&) = delete;
@@ -58,10 +101,16 @@ struct CoroutinePoolAllocator
     void deallocate(const boost::context::stack_context& ctx);
     size_t allocatedBlocks() const;
     size_t allocatedHeapBlocks() const;
+    AllocatorStatistics stats() const;
+    Histogram stackUsage() const;
+    Histogram stackUsage(const std::string& tag) const;
     bool isFull() const;
     bool isEmpty() const;
+    void warmUp(size_type num); //allocates the chunks holding the next 'num' free stacks
     
 private:
+    static constexpr char StackPaintPattern = (char)0xA5;
+    
     struct Header {
         int _pos;
     };
@@ -69,15 +118,47 @@ private:
     int blockIndex(const boost::context::stack_context& ctx) const;
     bool isManaged(const boost::context::stack_context& ctx) const;
     Header* getHeader(const boost::context::stack_context& ctx) const;
+    bool takeBlock(index_type& index);
+    void ensureBlock(index_type index);
+    index_type numChunks() const;
+    void returnBlock(index_type index);
+    void updatePeak();
+    
+    boost::context::stack_context allocateBlock();
+    
+    //Stack profiling
+    void paintStack(const boost::context::stack_context& ctx) const;
+    void recordStackUsage(const boost::context::stack_context& ctx);
+    
+    //Guarded stacks
+    void mapRegion();
+    char* mapSlot() const;
+    void guardSlot(char* slot) const;
+    boost::context::stack_context allocateMapped();
+    void deallocateMapped(const boost::context::stack_context& ctx);
     
     //------------------------------- Members ----------------------------------
     index_type          _size;
     Header**            _blocks;
+    char**              _chunks;        //heap backed stacks only. Null until first used.
+    index_type          _chunkSize;
     index_type*         _freeBlocks;
     ssize_t             _freeBlockIndex;
     size_t              _numHeapAllocatedBlocks;
     size_t              _stackSize;
-    mutable SpinLock    _spinlock;
+    mutable PaddedSpinLock _spinlock;
+    char*               _region;        //guarded stacks only
+    size_t              _pageSize;      //size of the guard page
+    size_t              _slotSize;      //guard page + stack, page aligned. Stack stride for huge pages and chunks.
+    char*               _hugeRegion;    //huge page backed stacks only
+    ThreadCache         _cache;
+    size_t              _peakAllocatedBlocks;
+    size_t              _numHeapFallbacks;
+    mutable std::atomic<size_t> _lockContentionCount;
+    bool                _profileStacks;
+    mutable SpinLock    _profileLock;
+    Histogram           _stackUsage;
+    std::map<std::string, Histogram> _taggedStackUsage;
 };
 
 template <typename STACK_TRAITS>
@@ -85,7 +166,8 @@ struct CoroutinePoolAllocatorProxy
 {
     typedef std::false_type default_constructor;
     
-    CoroutinePoolAllocatorProxy(uint16_t size) : _alloc(new CoroutinePoolAllocator<STACK_TRAITS>(size))
+    CoroutinePoolAllocatorProxy(uint16_t size, size_t stackSize = 0) :
+        _alloc(new CoroutinePoolAllocator<STACK_TRAITS>(size, stackSize))
     {
         if (!_alloc) {
             throw std::bad_alloc();
@@ -96,6 +178,10 @@ struct CoroutinePoolAllocatorProxy
     void deallocate(const boost::context::stack_context& ctx) { return _alloc->deallocate(ctx); }
     size_t allocatedBlocks() const { return _alloc->allocatedBlocks(); }
     size_t allocatedHeapBlocks() const { return _alloc->allocatedHeapBlocks(); }
+    AllocatorStatistics stats() const { return _alloc->stats(); }
+    void warmUp(size_t num) { _alloc->warmUp(num); }
+    Histogram stackUsage() const { return _alloc->stackUsage(); }
+    Histogram stackUsage(const std::string& tag) const { return _alloc->stackUsage(tag); }
     bool isFull() const { return _alloc->isFull(); }
     bool isEmpty() const { return _alloc->isEmpty(); }
 private:
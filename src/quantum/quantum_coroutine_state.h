@@ -0,0 +1,59 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_COROUTINE_STATE_H
+#define QUANTUM_COROUTINE_STATE_H
+
+#include <atomic>
+#include <chrono>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                  class CoroutineState
+//==============================================================================================
+/// @class CoroutineState.
+/// @brief Signal and sleep state of a coroutine context, read by the task queues on every scheduling pass.
+/// @details This state does not depend on the return type of the context so it is kept in a non-template base
+///          class with non-virtual accessors. When __QUANTUM_STATIC_DISPATCH is defined, tasks read it
+///          directly instead of going through the ITaskAccessor interface.
+/// @note For internal use only.
+class CoroutineState
+{
+public:
+    /// @brief Returns true if the coroutine is waiting on a signal without a timeout.
+    bool isBlocked() const;
+    
+    /// @brief Returns true if the coroutine is sleeping or in a timed wait which has not expired yet.
+    /// @param[in] updateTimer If true, the remaining sleep time is reduced by the time elapsed since the last call.
+    bool isSleeping(bool updateTimer = false);
+    
+    /// @brief Returns the time when a sleeping coroutine is due to wake up.
+    std::chrono::high_resolution_clock::time_point getSleepDeadline() const;
+    
+protected:
+    CoroutineState() = default;
+    
+    std::atomic_int                     _signal{-1};
+    std::chrono::microseconds           _sleepDuration{0};
+    std::chrono::high_resolution_clock::time_point  _sleepTimestamp;
+};
+
+}}
+
+#include <quantum/impl/quantum_coroutine_state_impl.h>
+
+#endif //QUANTUM_COROUTINE_STATE_H
@@ -18,13 +18,36 @@
 
 #include <quantum/quantum_context.h>
 #include <quantum/quantum_configuration.h>
+#include <quantum/quantum_affinity_key.h>
 #include <quantum/quantum_macros.h>
+#include <quantum/quantum_metrics.h>
 #include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <string>
 #include <chrono>
 
 namespace Bloomberg {
 namespace quantum {
 
+//==============================================================================================
+//                                 struct OverloadException
+//==============================================================================================
+/// @struct OverloadException
+/// @brief Exception set on the future of a task which was rejected because the dispatcher already holds
+///        the maximum number of pending tasks. See Configuration::setMaxPendingCoroTasks().
+/// @note Only tasks posted via the Dispatcher are checked. Tasks posted from a coroutine context (ICoroContext::post(),
+///       ICoroContext::postAsyncIo() and continuations) are exempt.
+struct OverloadException : public std::runtime_error
+{
+    OverloadException() :
+        std::runtime_error("Dispatcher overloaded")
+    {}
+};
+
 //==============================================================================================
 //                                 class Dispatcher
 //==============================================================================================
@@ -34,7 +57,10 @@ namespace quantum {
 class Dispatcher : public ITerminate
 {
 public:
+    using TimePoint = std::chrono::high_resolution_clock::time_point;
+    
     using ContextTag = ThreadContextTag;
+    using MetricsSource = std::function<void(MetricsSnapshot::Gauges& gauges)>;
     
     /// @brief Constructor.
     /// @details This will build two thread pools, one used for running parallel coroutines and another
@@ -95,6 +121,143 @@ public:
     ThreadContextPtr<RET>
     post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as post() above but using one of several priority levels.
+    /// @param[in] priority The priority level in the range [0, numPriorityLevels) where 0 is the lowest.
+    ///                     Higher values are capped to the highest configured level. Levels are served in a
+    ///                     weighted fair manner so that lower levels keep progressing under load.
+    ///                     See Configuration::setNumPriorityLevels().
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine to the queue owning an affinity key.
+    /// @details All the coroutines posted with equal keys run on the same thread, which preserves cache locality
+    ///          for the data of that key. The coroutines are not serialized. See Configuration::setAffinityVirtualNodes()
+    ///          for how keys are mapped when the pool is resized.
+    /// @param[in] key The affinity key, e.g. AffinityKey(accountId).
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note See post() above for details.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(AffinityKey key, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine which must complete by a certain time.
+    /// @details The deadline is used when the coroutine queues run with the 'EarliestDeadlineFirst' scheduling policy
+    ///          in which case the runnable coroutine with the earliest deadline is always resumed first. In addition,
+    ///          if Configuration::setDropExpiredCoroutines() is enabled, a coroutine which did not start by its deadline
+    ///          is discarded and the returned context holds an exception.
+    /// @param[in] deadline The time by which the result is needed.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note See post() above for details. Coroutines posted from within this coroutine do not inherit the deadline.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postWithDeadline(TimePoint deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postWithDeadline() above but runs on a specific queue.
+    /// @param[in] queueId Id of the queue where this coroutine should run or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutine will be scheduled to run immediately after the currently
+    ///                           executing coroutine. Ignored with the 'EarliestDeadlineFirst' scheduling policy.
+    /// @param[in] deadline The time by which the result is needed.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postWithDeadline(int queueId, bool isHighPriority, TimePoint deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine which can be cancelled cooperatively.
+    /// @details If the token is cancelled before the coroutine starts, it is dropped by its queue and the returned
+    ///          context holds a CancellationException. Once running, the coroutine gets a CancellationException
+    ///          thrown at its next yield() and can poll ICoroContextBase::isCancelled().
+    /// @param[in] token The cancellation token shared by all the tasks to cancel together.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note See post() above for details. Coroutines and IO tasks posted from within this coroutine inherit the token.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postWithToken(CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postWithToken() above but runs on a specific queue.
+    /// @param[in] queueId Id of the queue where this coroutine should run or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutine will be scheduled to run immediately after the currently
+    ///                           executing coroutine.
+    /// @param[in] token The cancellation token.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postWithToken(int queueId, bool isHighPriority, CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine which runs on a stack of a specific size.
+    /// @details Stack sizes are rounded up to the next power of two, clamped to StackTraits::minimumSize() and
+    ///          StackTraits::maximumSize(), and each resulting size class is served by its own pool of
+    ///          AllocatorTraits::defaultCoroPoolAllocSize() stacks. This allows most coroutines to run on small
+    ///          stacks while the few which need deep call chains get larger ones.
+    /// @param[in] stackSize The stack size in bytes. 0 selects StackTraits::defaultSize().
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note See post() above for details. Coroutines posted from within this coroutine use the default stack size.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postWithStackSize(size_t stackSize, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postWithStackSize() above but runs on a specific queue.
+    /// @param[in] queueId Id of the queue where this coroutine should run or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutine will be scheduled to run immediately after the currently
+    ///                           executing coroutine.
+    /// @param[in] stackSize The stack size in bytes. 0 selects StackTraits::defaultSize().
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postWithStackSize(int queueId, bool isHighPriority, size_t stackSize, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine which runs after a delay.
+    /// @details Until the delay expires the coroutine is held by the dispatcher's timer service and is not placed
+    ///          on any coroutine queue, therefore waiting does not add to the cost of scheduling other coroutines.
+    /// @param[in] delay Time to wait before the coroutine is posted.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note See post() above for details. Pending delayed coroutines are not waited on by drain() and are
+    ///       discarded if the dispatcher terminates.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAfter(std::chrono::milliseconds delay, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postAfter() above but runs on a specific queue.
+    /// @param[in] delay Time to wait before the coroutine is posted.
+    /// @param[in] queueId Id of the queue where this coroutine should run or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutine will be scheduled to run immediately after the currently
+    ///                           executing coroutine once the delay expires.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAfter(std::chrono::milliseconds delay, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a new coroutine every period until the timer is cancelled.
+    /// @details A copy of the callable object and of its arguments is made for every run. Runs which would fall
+    ///          while the dispatcher is draining are skipped, as are periods missed because the system was busy.
+    /// @param[in] period Time between consecutive posts. The first post happens one period from now.
+    /// @param[in] func Callable object with the signature 'int f(CoroContext<RET>::Ptr, ...)'.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A timer id which can be passed to cancelTimer().
+    /// @note The result of each run is discarded. Runs do not wait for the previous one to complete.
+    template <class RET = int, class FUNC, class ... ARGS>
+    uint64_t
+    postEvery(std::chrono::milliseconds period, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postEvery() above but runs on a specific queue.
+    /// @param[in] period Time between consecutive posts.
+    /// @param[in] queueId Id of the queue where the coroutines should run or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutines will be scheduled ahead of the normal priority ones.
+    template <class RET = int, class FUNC, class ... ARGS>
+    uint64_t
+    postEvery(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Cancel a periodic post.
+    /// @param[in] timerId The id returned by postEvery().
+    /// @return True if the timer was active, false if it was already cancelled.
+    bool cancelTimer(uint64_t timerId);
+    
     /// @brief Post the first coroutine in a continuation chain to run asynchronously.
     /// @tparam RET Type of future returned by this coroutine.
     /// @tparam FUNC Callable object type which will be wrapped in a coroutine. Can be a standalone function, a method,
@@ -130,6 +293,64 @@ public:
     ThreadContextPtr<RET>
     postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as postFirst() above but using one of several priority levels.
+    /// @param[in] priority The priority level in the range [0, numPriorityLevels) where 0 is the lowest.
+    ///                     Higher values are capped to the highest configured level. Levels are served in a
+    ///                     weighted fair manner so that lower levels keep progressing under load.
+    ///                     See Configuration::setNumPriorityLevels().
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postFirst() above but runs on a stack of a specific size. See postWithStackSize().
+    /// @param[in] stackSize The stack size in bytes. 0 selects StackTraits::defaultSize().
+    /// @note All the continuations chained to the returned context via then(), onError() and finally() run on stacks
+    ///       of the same size.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirstWithStackSize(size_t stackSize, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postFirst() above but runs on a specific queue and on a stack of a specific size.
+    /// @param[in] queueId Id of the queue where this coroutine should run or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutine will be scheduled to run immediately after the currently
+    ///                           executing coroutine.
+    /// @param[in] stackSize The stack size in bytes. 0 selects StackTraits::defaultSize().
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirstWithStackSize(int queueId, bool isHighPriority, size_t stackSize, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a batch of coroutines to run asynchronously.
+    /// @details The coroutines are spread over all the coroutine threads. Each thread receiving a part of the batch
+    ///          is only notified once, regardless of how many coroutines it receives.
+    /// @tparam RET Type of future returned by each coroutine.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(CoroContext<RET>::Ptr)'.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread context objects, one for each callable in the range in the same order.
+    /// @note This function is non-blocking and returns immediately. Use std::make_move_iterator() to move the
+    ///       callables instead of copying them.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<ThreadContextPtr<RET>>
+    postBatch(INPUT_IT first, INPUT_IT last);
+    
+    /// @brief Post a batch of coroutines to run asynchronously on a specific queue (thread).
+    /// @tparam RET Type of future returned by each coroutine.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(CoroContext<RET>::Ptr)'.
+    /// @param[in] queueId Id of the queue where the coroutines should run. Note that the user can specify IQueue::QueueId::Any
+    ///                    as a value, which is equivalent to running the simpler version of postBatch() above. Valid range is
+    ///                    [0, numCoroutineThreads) or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the coroutines will be scheduled to run immediately after the currently
+    ///                           executing coroutine on 'queueId' has completed or has yielded.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread context objects, one for each callable in the range in the same order.
+    /// @note This function is non-blocking and returns immediately.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<ThreadContextPtr<RET>>
+    postBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last);
+    
     /// @brief Post a blocking IO (or long running) task to run asynchronously on the IO thread pool.
     /// @tparam RET Type of future returned by this task.
     /// @tparam FUNC Callable object type. Can be a standalone function, a method, an std::function,
@@ -162,6 +383,88 @@ public:
     ThreadFuturePtr<RET>
     postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as postAsyncIo() above but using one of several priority levels.
+    /// @param[in] priority The priority level in the range [0, numPriorityLevels) where 0 is the lowest.
+    ///                     Higher values are capped to the highest configured level. Levels are served in a
+    ///                     weighted fair manner so that lower levels keep progressing under load.
+    ///                     See Configuration::setNumPriorityLevels().
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIo(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postAsyncIo() above but the task can be cancelled cooperatively.
+    /// @details If the token is cancelled before the task starts, it is dropped by its queue and the returned
+    ///          future holds a CancellationException. A running task is not interrupted.
+    /// @param[in] token The cancellation token shared by all the tasks to cancel together.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIoWithToken(CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postAsyncIoWithToken() above but runs on a specific queue.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIoWithToken(int queueId, bool isHighPriority, CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a batch of blocking IO (or long running) tasks to run asynchronously on the IO thread pool.
+    /// @details All the tasks are inserted with a single lock on the shared queue and at most one IO thread
+    ///          is woken up per task.
+    /// @tparam RET Type of future returned by each task.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(ThreadPromise<RET>::Ptr)'.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread future objects, one for each callable in the range in the same order.
+    /// @note This function is non-blocking and returns immediately. The futures can be waited on together
+    ///       with a FutureJoiner.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<ThreadFuturePtr<RET>>
+    postAsyncIoBatch(INPUT_IT first, INPUT_IT last);
+    
+    /// @brief Post a batch of blocking IO (or long running) tasks to run asynchronously on a specific IO thread.
+    /// @tparam RET Type of future returned by each task.
+    /// @tparam INPUT_IT The type of iterator. Each element in the range must be a callable object with the
+    ///                  signature 'int f(ThreadPromise<RET>::Ptr)'.
+    /// @param[in] queueId Id of the queue where the tasks should run. Valid range is [0, numIoThreads) or
+    ///                    IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the tasks will be scheduled ahead of the normal priority ones.
+    /// @oaram[in] first The first callable in the range.
+    /// @oaram[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread future objects, one for each callable in the range in the same order.
+    /// @note This function is non-blocking and returns immediately.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::vector<ThreadFuturePtr<RET>>
+    postAsyncIoBatch(int queueId, bool isHighPriority, INPUT_IT first, INPUT_IT last);
+    
+    /// @brief Post a blocking IO (or long running) task which counts against the limits of a named group.
+    /// @details Tasks exceeding the group limits wait in a group-local queue and are posted to the shared IO queue
+    ///          in order as running tasks complete or as the rate limit allows, so a slow dependency cannot take
+    ///          over every IO thread.
+    /// @param[in] group The group name. The group must have been created via setIoGroupLimits().
+    /// @param[in] func Callable object with the signature 'int f(ThreadPromise<RET>::Ptr, ...)'.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread future object.
+    /// @note This function is non-blocking and returns immediately.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIoGroup(const std::string& group, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Create a named IO task group or change its limits.
+    /// @param[in] group The group name.
+    /// @param[in] maxInFlight Maximum number of tasks of this group posted to the IO queues at any time.
+    ///                        Set to 0 for no limit.
+    /// @param[in] ratePerSecond Maximum number of tasks started per second. Set to 0 for no limit.
+    /// @param[in] burst Number of tasks which can start back to back when the rate limit is set. Minimum is 1.
+    /// @note This function is thread safe.
+    void setIoGroupLimits(const std::string& group,
+                          size_t maxInFlight,
+                          double ratePerSecond = 0,
+                          size_t burst = 0);
+    
+    /// @brief Returns the statistics of a named IO task group.
+    /// @param[in] group The group name.
+    /// @return The group counters.
+    IoGroupStatistics ioGroupStats(const std::string& group) const;
+    
     /// @brief Applies the given unary function to all the elements in the range [first,last).
     ///        This function runs in parallel.
     /// @tparam RET The return value of the unary function.
@@ -170,18 +473,22 @@ public:
     /// @oaram[in] first The first element in the range.
     /// @oaram[in] last The last element in the range (exclusive).
     /// @oaram[in] func The unary function.
+    /// @oaram[in] token Optional cancellation token. Once cancelled, the invocations which have not started yet
+    ///                  are dropped and the returned context holds a CancellationException.
     /// @return A vector of future values corresponding to the output of 'func' on every element in the range.
     /// @note Use this function if InputIt meets the requirement of a RandomAccessIterator
     /// @note Each func invocation will run inside its own coroutine instance.
     template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
     ThreadContextPtr<std::vector<RET>>
-    forEach(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<RET, INPUT_IT> func);
+    forEach(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<RET, INPUT_IT> func,
+            CancellationToken::Ptr token = nullptr);
     
     /// @brief Same as forEach() but takes a length as second argument in case INPUT_IT
     ///        is not a random access iterator.
     template <class RET = int, class INPUT_IT>
     ThreadContextPtr<std::vector<RET>>
-    forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func);
+    forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func,
+            CancellationToken::Ptr token = nullptr);
     
     /// @brief The batched version of forEach(). This function applies the given unary function
     ///        to all the elements in the range [first,last). This function runs serially with respect
@@ -200,6 +507,35 @@ public:
     ThreadContextPtr<std::vector<std::vector<RET>>>
     forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func);
     
+    /// @brief Applies the given unary function to all the elements in the range [first,last) in chunks
+    ///        of 'grainSize' elements. One coroutine per thread repeatedly claims the next unprocessed
+    ///        chunk, so that faster threads end up processing more chunks.
+    /// @param[in] grainSize The number of elements processed per chunk. If 0, it is chosen so that each
+    ///            coroutine thread gets several chunks.
+    /// @return A vector of values corresponding to the output of 'func' on every element in the range.
+    /// @note Use this function instead of forEach() for large ranges of cheap elements and instead of
+    ///       forEachBatch() when the cost per element varies.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<RET>>
+    forEachChunked(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<RET, INPUT_IT> func, size_t grainSize = 0);
+    
+    /// @brief Same as forEachChunked() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET = int, class INPUT_IT>
+    ThreadContextPtr<std::vector<RET>>
+    forEachChunked(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func, size_t grainSize = 0);
+    
+    /// @brief Version of forEachBatch() which balances the load by recursively splitting the range.
+    ///        A range is only split when a coroutine thread would otherwise be idle, so that
+    ///        stragglers with expensive elements are shared with the threads which finished early.
+    /// @param[in] grainSize The minimum number of elements in a split range. If 0, a value is chosen based
+    ///            on the range length and the number of coroutine threads.
+    /// @return A vector of value vectors, one per processed sub-range, in the order of the input.
+    /// @note INPUT_IT must meet the requirements of a RandomAccessIterator. The input is never copied.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatchSplit(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<RET, INPUT_IT> func, size_t grainSize = 0);
+    
     /// @brief Implementation of map-reduce functionality.
     /// @tparam KEY The KEY type used for mapping and reducing.
     /// @tparam MAPPED_TYPE The output type after a map operation.
@@ -264,6 +600,149 @@ public:
                    size_t num,
                    Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Version of mapReduce() which shuffles the mapped values in parallel.
+    /// @details Mappers claim chunks of the input dynamically and scatter their output into one bucket per
+    ///          partition, based on the hash of the key. Each partition then merges the buckets of all the
+    ///          mappers into a hash table and reduces its keys, independently of the other partitions.
+    ///          Unlike mapReduce(), no single coroutine inserts all the mapped values into one tree.
+    /// @tparam RESULT The type of the reduced output. Any map type with emplace(KEY, REDUCED_TYPE), such as
+    ///         std::map, can be used if ordered results are needed.
+    /// @param[in] numPartitions The number of partitions the keys are hashed into. If 0, the number of
+    ///            coroutine threads is used.
+    /// @param[in] combiner Optional function which merges a value into the one accumulated for the same key.
+    ///            When provided, each mapper pre-reduces its own output per key, and the reducer receives a single
+    ///            combined value per key. It must be associative, so that values can be combined in any order.
+    /// @note KEY must be hashable with std::hash and equality comparable.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<RESULT>
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                         size_t numPartitions = 0,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner = nullptr);
+    
+    /// @brief Same as mapReducePartitioned() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    ThreadContextPtr<RESULT>
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                         size_t numPartitions = 0,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner = nullptr);
+    
+    /// @brief Same as mapReducePartitioned() but maps the values of a buffered future as they are produced.
+    /// @details Mapping starts as soon as the first values are pushed into the buffer, without waiting for the
+    ///          whole input to be available. The reduce stage starts once the buffer is closed.
+    /// @param[in] input Buffered future from which the input values are pulled, as returned by
+    ///            Promise<Buffer<T>>::getICoroFuture(). This must be the only consumer of the buffer.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class RESULT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class T>
+    ThreadContextPtr<RESULT>
+    mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                    Functions::StreamMapFunc<KEY, MAPPED_TYPE, T> mapper,
+                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer,
+                    size_t numPartitions = 0,
+                    Functions::CombineFunc<MAPPED_TYPE> combiner = nullptr);
+    
+    /// @brief Parallel reduction of a range of elements.
+    /// @details The range is split into one contiguous chunk per coroutine thread. The partial results of the chunks
+    ///          are then combined pairwise, in order, and the result is combined with 'init'.
+    /// @tparam RET The type of the reduced value. Each element must be convertible to it.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] init The initial value, combined with the reduction of the range as op(init, reduced).
+    /// @param[in] op The binary operator. It must be associative but needs not be commutative.
+    /// @return A future to the reduced value. If the range is empty, 'init' is returned.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<RET>
+    reduce(INPUT_IT first,
+           INPUT_IT last,
+           RET init,
+           Functions::BinaryOpFunc<RET> op);
+    
+    /// @brief Same as reduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<RET>
+    reduce(INPUT_IT first,
+           size_t num,
+           RET init,
+           Functions::BinaryOpFunc<RET> op);
+    
+    /// @brief Same as reduce() but applies 'transform' to each element before reducing it.
+    /// @param[in] transform The unary function applied to each element.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<RET>
+    transformReduce(INPUT_IT first,
+                    INPUT_IT last,
+                    RET init,
+                    Functions::ForEachFunc<RET, INPUT_IT> transform,
+                    Functions::BinaryOpFunc<RET> op);
+    
+    /// @brief Same as transformReduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<RET>
+    transformReduce(INPUT_IT first,
+                    size_t num,
+                    RET init,
+                    Functions::ForEachFunc<RET, INPUT_IT> transform,
+                    Functions::BinaryOpFunc<RET> op);
+    
+    /// @brief Parallel inclusive prefix scan of a range of elements.
+    /// @details Two-pass algorithm: each coroutine thread first scans its own chunk of the range, then every chunk
+    ///          but the first one is offset by the combined totals of the chunks preceding it.
+    /// @tparam RET The type of the scanned values. Each element must be convertible to it.
+    /// @param[in] op The binary operator. It must be associative but needs not be commutative.
+    /// @return A future to a vector where the i-th value is the combination of the first i+1 elements.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<RET>>
+    inclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  Functions::BinaryOpFunc<RET> op);
+    
+    /// @brief Same as inclusiveScan() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<std::vector<RET>>
+    inclusiveScan(INPUT_IT first,
+                  size_t num,
+                  Functions::BinaryOpFunc<RET> op);
+    
+    /// @brief Sorts a range of elements in parallel.
+    /// @details The range is split into one chunk per coroutine thread which are sorted concurrently. Sorted chunks are
+    ///          then merged pairwise in successive rounds, and each merge is itself split between several coroutines.
+    ///          Since every phase is made of short independent coroutines, other coroutines keep running in between.
+    /// @tparam RANDOM_IT The type of iterator. Must be a random access iterator.
+    /// @tparam COMPARE The comparison function type, as for std::sort().
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] comp The comparison function object.
+    /// @return A future which completes when the range is sorted.
+    /// @note The sort is not stable. The range must remain valid until the returned future completes.
+    template <class RANDOM_IT,
+              class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>,
+              class = Traits::IsInputIterator<RANDOM_IT>>
+    ThreadContextPtr<int>
+    sort(RANDOM_IT first,
+         RANDOM_IT last,
+         COMPARE comp = COMPARE());
 
     /// @brief Signal all threads to immediately terminate and exit. All other pending coroutines and IO tasks will not complete.
     ///        Call this function for a fast shutdown of the dispatcher.
@@ -290,10 +769,21 @@ public:
     bool empty(IQueue::QueueType type = IQueue::QueueType::All,
                int queueId = (int)IQueue::QueueId::All) const;
     
+    /// @brief Returns how long the oldest runnable coroutine on a queue has been waiting for its thread.
+    /// @details A coroutine is waiting from the moment it is posted, signalled or yields until it resumes.
+    ///          A large value indicates that other coroutines on the same thread are monopolizing it.
+    /// @param[in] queueId The coroutine queue to query in the range [0, numCoroutineThreads) or IQueue::QueueId::All
+    ///                    for the largest value across all queues.
+    /// @return The waiting time or 0 if no coroutine is waiting.
+    /// @note Only tracked when Configuration::setLongSliceThresholdUs() is set to a non-zero value. In non-parking
+    ///       mode, a coroutine which was blocked only counts as waiting once it resumes and yields again.
+    std::chrono::microseconds oldestRunnableWaitTime(int queueId = (int)IQueue::QueueId::All) const;
+    
     /// @brief Drains all queues on this dispatcher object.
     /// @param[in] timeout Maximum time for this function to wait. Set to 0 to wait indefinitely until all queues drain.
     /// @note This function blocks until all coroutines and IO tasks have completed. During this time, posting
     ///       of new tasks is disabled unless they are posted from within an already executing coroutine.
+    ///       The calling thread sleeps and is woken up by the queues as they run out of work.
     void drain(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
     
     /// @brief Returns the number of underlying coroutine threads as specified in the constructor. If -1 was passed
@@ -303,12 +793,30 @@ public:
     ///       to a specific queue.
     int getNumCoroutineThreads() const;
     
+    /// @brief Returns the number of coroutine threads which currently receive coroutines posted to IQueue::QueueId::Any.
+    /// @return The number of threads in the range [1, getNumCoroutineThreads()].
+    int getNumActiveCoroutineThreads() const;
+    
+    /// @brief Grow or shrink the number of coroutine threads used for coroutines posted to IQueue::QueueId::Any.
+    /// @details Threads [0, num) are active. When shrinking, the coroutines which have not started yet are moved from
+    ///          the retiring threads to the remaining ones. Coroutines already running, or posted to a specific queue,
+    ///          complete on their original thread. Retiring threads are kept alive and can be re-activated later.
+    /// @param[in] num The number of active threads in the range [1, getNumCoroutineThreads()]. The upper bound is set
+    ///                via Configuration::setMaxNumCoroutineThreads().
+    /// @note This function is thread safe.
+    void setNumActiveCoroutineThreads(int num);
+    
     /// @brief Returns the number of underlying IO threads as specified in the constructor.
     /// @return The number of threads.
     /// @note Each thread services its own queueId, therefore this number can be used when assigning IO tasks
     ///       to a specific queue.
     int getNumIoThreads() const;
     
+    /// @brief Returns the number of extra IO threads currently serving IQueue::QueueId::Any.
+    /// @return The number of threads in the range [0, Configuration::getMaxNumElasticIoThreads()].
+    /// @note Extra threads are started and stopped based on the load of the shared IO queue.
+    int getNumElasticIoThreads() const;
+    
     /// @brief Returns a statistics object for the specified type and queue id.
     /// @param[in] type The type of queue.
     /// @param[in] queueId The queue number to query. Valid range is [0, numCoroutineThreads) for IQueue::QueueType::Coro,
@@ -322,19 +830,87 @@ public:
     /// @brief Resets all coroutine and IO queue counters.
     void resetStats();
     
+    /// @brief Lists the live coroutines along with their state.
+    /// @return One entry per coroutine which was posted and has not completed yet, in no particular order.
+    /// @note Only available if enabled via Configuration::setTrackTasks(). Otherwise the list is empty. This does
+    ///       not wait for the coroutine threads, so it can be called while they are busy or stalled.
+    std::vector<TaskInfo> snapshotTasks() const;
+    
+    /// @brief Returns the statistics of the internal object and coroutine stack pools.
+    /// @return The pool counters keyed by pool name, i.e. "context", "coroStack", "future", "ioTask", "promise"
+    ///         and "task", as well as the functor pools described in FunctionAllocator::stats().
+    /// @note Pools are shared by all dispatchers in the process. Pools are not reported when the system allocator
+    ///       is used in their place (see __QUANTUM_USE_DEFAULT_ALLOCATOR and __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR).
+    static std::map<std::string, AllocatorStatistics> allocatorStats();
+    
+    /// @brief Prepares the internal object pools and the default coroutine stack pool to serve the given number of
+    ///        coroutines without allocating or faulting in memory.
+    /// @param[in] num The number of objects of each kind, e.g. coroutine stacks, contexts and tasks.
+    /// @note Pools otherwise grow on first use, see AllocatorTraits::coroPoolChunkSize(). This is meant for latency
+    ///       sensitive applications and should be called once at startup, after the allocator traits are set.
+    static void warmUpPools(size_t num);
+    
+    /// @brief Returns the contention counters of the internal locks.
+    /// @return The counters keyed by lock site, i.e. "TaskQueue", "IoQueue", "ContiguousPoolManager",
+    ///         "CoroutinePoolAllocator", "SharedState", "ConditionVariable" and "WaitQueue", as well as the
+    ///         sites of the user locks (see LockSite).
+    /// @note Sites are shared by all dispatchers in the process. Only collected when built with
+    ///       __QUANTUM_PROFILE_LOCKS, otherwise the report is empty. See LockProfiler::reset().
+    static std::map<std::string, LockStatistics> lockStats();
+    
+    /// @brief Returns the distribution of the peak stack usage in bytes of the coroutines which have completed.
+    /// @param[in] stackSize Selects the pool of coroutines posted with this stack size. See postWithStackSize().
+    /// @return The histogram of peak stack usage.
+    /// @note Only collected if enabled via AllocatorTraits::profileCoroStacks().
+    static Histogram coroStackUsage(size_t stackSize = 0);
+    
+    /// @brief Same as coroStackUsage() above but only for the coroutines posted within the scope of a CoroStackTag.
+    /// @param[in] tag The tag.
+    /// @param[in] stackSize Selects the pool of coroutines posted with this stack size. See postWithStackSize().
+    static Histogram coroStackUsage(const std::string& tag, size_t stackSize = 0);
+    
+    /// @brief Registers a source of gauges which are published along with the metrics of this dispatcher.
+    /// @param[in] name Name of the source. Each gauge it adds is published as "<name>.<gauge>".
+    /// @param[in] source Called from the metrics thread once per export period. An empty function removes the source.
+    /// @note Only used when a sink is set via Configuration::setMetricsSink(). See Sequencer::collectMetrics() for
+    ///       a source of sequencer statistics.
+    void setMetricsSource(const std::string& name, MetricsSource source);
+    
 private:
     template <class RET, class FUNC, class ... ARGS>
     ThreadContextPtr<RET>
-    postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&& func, ARGS&&... args);
+    postImpl(int queueId, int priority, ITask::Type type, TimePoint deadline, size_t stackSize, CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    template <class RET, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAfterImpl(std::chrono::milliseconds delay, int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    template <class RET, class FUNC, class ... ARGS>
+    uint64_t
+    postEveryImpl(std::chrono::milliseconds period, int queueId, int priority, FUNC&& func, ARGS&&... args);
     
     template <class RET, class FUNC, class ... ARGS>
     ThreadFuturePtr<RET>
-    postAsyncIoImpl(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    postAsyncIoImpl(int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    template <class RET, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIoImpl(const std::string* group, CancellationToken::Ptr token, int queueId, int priority, FUNC&& func, ARGS&&... args);
+    
+    void collectMetrics(MetricsSnapshot& metrics);
+    
+    bool isOverloaded(bool isIoTask) const; //notifies the overload callback
     
     //Members
-    DispatcherCore              _dispatcher;
-    bool                        _drain;
-    std::atomic_flag            _terminated;
+    DispatcherCore                          _dispatcher;
+    bool                                    _drain;
+    std::atomic_flag                        _terminated;
+    std::mutex                              _metricsSourcesMutex;
+    std::map<std::string, MetricsSource>    _metricsSources;
+    std::unique_ptr<MetricsExporter>        _metricsExporter;
+    size_t                                  _maxPendingCoroTasks;
+    size_t                                  _maxPendingIoTasks;
+    Configuration::OverloadCallback         _overloadCallback;
 };
 
 using TaskDispatcher = Dispatcher; //alias
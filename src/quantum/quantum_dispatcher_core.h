@@ -17,6 +17,10 @@
 #define QUANTUM_DISPATCHER_CORE_H
 
 #include <vector>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <memory>
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
@@ -30,7 +34,11 @@
 #endif
 #include <quantum/quantum_configuration.h>
 #include <quantum/quantum_task_queue.h>
+#include <quantum/quantum_io_group.h>
 #include <quantum/quantum_io_queue.h>
+#include <quantum/quantum_affinity_key.h>
+#include <quantum/quantum_reactor.h>
+#include <quantum/quantum_timer_service.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -55,17 +63,51 @@ public:
     
     bool empty(IQueue::QueueType type, int queueId) const;
     
+    //Number of tasks held by all the queues of this type. Only counted when a pending task limit
+    //is configured for this type, otherwise returns 0.
+    size_t numPendingTasks(IQueue::QueueType type) const;
+    
     QueueStatistics stats(IQueue::QueueType type, int queueId);
     
+    std::chrono::microseconds oldestRunnableWaitTime(int queueId) const;
+    
     void resetStats();
     
+    std::vector<TaskInfo> snapshotTasks() const;
+    
     void post(Task::Ptr task);
     
+    void postBatch(std::vector<Task::Ptr>& tasks);
+    
     void postAsyncIo(IoTask::Ptr task);
     
+    void postAsyncIoBatch(std::vector<IoTask::Ptr>& tasks);
+    
+    void postAsyncIoGroup(const std::string& group, IoTask::Ptr task);
+    
+    void setIoGroupLimits(const std::string& group, size_t maxInFlight, double ratePerSecond, size_t burst);
+    
+    IoGroupStatistics ioGroupStats(const std::string& group) const;
+    
+    void wakeUp(ITask::Ptr task);
+    
     int getNumCoroutineThreads() const;
     
+    int getNumActiveCoroutineThreads() const;
+    
+    void setNumActiveCoroutineThreads(int num);
+    
+    int getAffinityQueueId(const AffinityKey& key) const;
+    
     int getNumIoThreads() const;
+    
+    int getNumElasticIoThreads() const;
+    
+    TimerService& getTimerService();
+    
+#if defined(__linux__)
+    Reactor& getReactor();
+#endif
 
 private:
     // TODO : Remove - deprecated
@@ -87,12 +129,74 @@ private:
     
     QueueStatistics ioStats(int queueId);
     
+    using AffinityRing = std::vector<std::pair<uint64_t, size_t>>; //sorted virtual node hashes and their queue
+    
+    void buildAffinityRing(size_t numQueues);
+    
+    size_t selectCoroQueue() const;
+    
+    size_t randomCoroQueue(size_t numQueues) const;
+    
+    static size_t getNumActiveCoroQueues(const Configuration& config);
+    
+    static size_t getNumCoroQueues(const Configuration& config);
+    
+    void manageElasticIoThreads();
+    
+    void stopElasticIoThreads();
+    
+    size_t elasticIoSize() const;
+    
+    void placeIoThread(IoQueue& queue, size_t index);
+    
+    IoGroup::Ptr getIoGroup(const std::string& group) const;
+    
+    void pumpIoGroup(const IoGroup::Ptr& group);
+    
+    //Blocks until all the queues are empty or until 'timeout' expires. Zero means wait indefinitely.
+    //Returns true if the queues are empty.
+    bool waitUntilEmpty(std::chrono::milliseconds timeout);
+    
+    void setIdleSignal();
+    
+    void setPendingTaskCounters(const Configuration& config);
+    
     //Members
+    IdleSignal              _idleSignal;     //signalled by the queues when they run out of work
     std::vector<TaskQueue>  _coroQueues;     //coroutine queues
     std::vector<IoQueue>    _sharedIoQueues; //shared IO task queues (hold tasks posted to 'Any' IO queue)
     std::vector<IoQueue>    _ioQueues;       //dedicated IO task queues
     bool                    _loadBalanceSharedIoQueues; //tasks posted to 'Any' IO queue are load balanced
+    Configuration::RingFullPolicy _sharedIoRingFullPolicy;
     std::atomic_flag        _terminated;
+    std::atomic<size_t>     _numPendingCoroTasks; //only counted when Dispatcher limits pending coroutines
+    std::atomic<size_t>     _numPendingIoTasks;   //only counted when Dispatcher limits pending IO tasks
+    std::atomic<size_t>     _numActiveCoroQueues; //queues in [0, _numActiveCoroQueues) receive tasks posted to 'Any'
+    std::mutex              _resizeMutex;
+    Configuration::PlacementPolicy _placementPolicy;
+    int                     _affinityVirtualNodes;
+    std::shared_ptr<const AffinityRing> _affinityRing; //swapped atomically when resizing
+    NumaTopology::CpuSet    _ioThreadCpus; //set via configuration, overrides the NUMA placement of IO threads
+    bool                    _pinIoThreadsToCores;
+    Configuration::SchedPolicy _ioThreadSchedPolicy;
+    int                     _ioThreadSchedPriority;
+    std::list<std::unique_ptr<IoQueue>> _elasticIoQueues; //extra threads serving the shared IO queue
+    QueueStatistics         _retiredElasticIoStats;
+    mutable std::mutex      _elasticIoMutex; //protects the elastic IO members
+    std::condition_variable _elasticIoCond;
+    bool                    _isElasticIoStopped;
+    size_t                  _maxNumElasticIoThreads;
+    std::chrono::milliseconds _elasticIoSpawnThresholdMs;
+    std::chrono::milliseconds _elasticIoIdleTimeoutMs;
+    std::thread             _elasticIoThread; //grows and shrinks '_elasticIoQueues'
+    mutable std::mutex      _ioGroupMutex;
+    std::unordered_map<std::string, IoGroup::Ptr> _ioGroups; //named IO task groups
+    std::once_flag          _timerServiceOnce;
+    std::unique_ptr<TimerService> _timerService; //created on first use
+#if defined(__linux__)
+    std::once_flag          _reactorOnce;
+    std::unique_ptr<Reactor> _reactor; //created on first use
+#endif
 };
 
 }}
@@ -0,0 +1,121 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_FIBER_H
+#define QUANTUM_FIBER_H
+
+#include <exception>
+#include <boost/context/detail/fcontext.hpp>
+#include <boost/context/stack_context.hpp>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class FiberYield
+//==============================================================================================
+/// @class FiberYield.
+/// @brief Yield handle of a FiberCoroutine. It has the same interface as the boost::coroutines2
+///        pull_type used by the default backend: calling it suspends the coroutine and get() returns
+///        the return code passed to the last resume.
+/// @note The object lives at the top of the coroutine stack. For internal use only.
+class FiberYield
+{
+    friend class FiberCoroutine;
+public:
+    FiberYield(const FiberYield&) = delete;
+    FiberYield& operator=(const FiberYield&) = delete;
+
+    /// @brief Suspends the coroutine and returns control to the thread which resumed it.
+    /// @note If the coroutine is destroyed while suspended, this throws FiberUnwind to unwind its stack.
+    FiberYield& operator()();
+
+    /// @brief Return code passed to the last resume.
+    int& get() const;
+
+protected:
+    FiberYield(const boost::context::stack_context& stack);
+    virtual ~FiberYield() = default;
+
+    /// @brief Runs the coroutine function on the coroutine stack.
+    virtual void run() = 0;
+
+    /// @brief Destroys this object and releases the stack. Called from outside the coroutine.
+    virtual void destroy() = 0;
+
+    static void entry(boost::context::detail::transfer_t transfer);
+
+    boost::context::stack_context       _stack;
+    boost::context::detail::fcontext_t  _fiber{nullptr}; //where to resume the coroutine
+    boost::context::detail::fcontext_t  _caller{nullptr}; //where to return on yield
+    int*                                _rc{nullptr};
+    std::exception_ptr                  _exception;
+    bool                                _isStarted{false};
+    bool                                _isComplete{false};
+    bool                                _isUnwinding{false};
+};
+
+/// @brief Thrown from a yield when a suspended FiberCoroutine is destroyed. It does not derive from
+///        std::exception and should not be caught, or if it is, it must be rethrown.
+struct FiberUnwind {};
+
+//==============================================================================================
+//                                     class FiberCoroutine
+//==============================================================================================
+/// @class FiberCoroutine.
+/// @brief Stackful coroutine switching directly with boost::context fcontext, i.e. the primitive underneath
+///        boost::coroutines2 and boost::context::fiber, without their generic machinery. A resume or a
+///        yield is a single context jump.
+/// @details This backend is selected with __QUANTUM_USE_FIBER_COROUTINES. It is a drop-in replacement for
+///          the boost::coroutines2 push_type, with the same resume semantics: the coroutine function does not
+///          start until the first resume, exceptions escaping it are rethrown to the resumer and a coroutine
+///          destroyed while suspended has its stack unwound.
+/// @note For internal use only.
+class FiberCoroutine
+{
+public:
+    /// @brief Constructor. The stack is allocated immediately and the function stored on it.
+    /// @param[in] allocator The stack allocator. A copy is kept to release the stack.
+    /// @param[in] func Callable taking a FiberYield&.
+    template <class STACK_ALLOCATOR, class FUNC>
+    FiberCoroutine(STACK_ALLOCATOR&& allocator, FUNC&& func);
+
+    FiberCoroutine(const FiberCoroutine&) = delete;
+    FiberCoroutine(FiberCoroutine&& other);
+    FiberCoroutine& operator=(const FiberCoroutine&) = delete;
+    FiberCoroutine& operator=(FiberCoroutine&& other);
+    ~FiberCoroutine();
+
+    /// @brief Runs the coroutine until it yields or completes.
+    /// @param[in] rc Return code made available to the coroutine via FiberYield::get().
+    FiberCoroutine& operator()(int& rc);
+
+    /// @brief Returns true if the coroutine has not completed yet.
+    explicit operator bool() const;
+
+private:
+    template <class STACK_ALLOCATOR, class FUNC>
+    class Record;
+
+    void release();
+
+    FiberYield*     _record;
+};
+
+}}
+
+#include <quantum/impl/quantum_fiber_impl.h>
+
+#endif //QUANTUM_FIBER_H
@@ -38,6 +38,15 @@ struct Functions
     
     template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE>
     using ReduceFunc = std::function<std::pair<KEY, REDUCED_TYPE>(std::pair<KEY, std::vector<MAPPED_TYPE>>&&)>;
+    
+    template <class KEY, class MAPPED_TYPE, class T>
+    using StreamMapFunc = MapFunc<KEY, MAPPED_TYPE, const T*>; //maps a 'const T&'
+    
+    template <class MAPPED_TYPE>
+    using CombineFunc = std::function<void(MAPPED_TYPE& accumulated, MAPPED_TYPE&& value)>;
+    
+    template <class RET>
+    using BinaryOpFunc = std::function<RET(const RET&, const RET&)>;
 };
 
 }}
@@ -0,0 +1,60 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_FUTEX_H
+#define QUANTUM_FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <quantum/quantum_yielding_thread.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct Futex
+//==============================================================================================
+/// @struct Futex.
+/// @brief Parks and wakes threads on a process-private atomic integer.
+/// @details On Linux the calls map onto the futex(2) system call. On other platforms a wait yields
+///          the thread once (or sleeps for at most the yielding thread interval) and a wake is a no-op,
+///          so callers must always re-check their condition after a wait returns.
+/// @note For internal use only.
+struct Futex
+{
+    /// @brief Blocks the calling thread while the value of 'signal' equals 'expected'.
+    /// @param[in] signal The atomic the thread waits on.
+    /// @param[in] expected The value which keeps the thread blocked.
+    /// @note May return spuriously.
+    static void wait(std::atomic_int& signal, int expected);
+    
+    /// @brief Same as above but returns after at most 'time' has elapsed.
+    /// @param[in] signal The atomic the thread waits on.
+    /// @param[in] expected The value which keeps the thread blocked.
+    /// @param[in] time The maximum time to block. Returns immediately if not positive.
+    /// @note May return spuriously.
+    static void waitFor(std::atomic_int& signal, int expected, std::chrono::microseconds time);
+    
+    /// @brief Wakes up to 'num' threads blocked on 'signal'.
+    /// @param[in] signal The atomic the threads wait on.
+    /// @param[in] num The maximum number of threads to wake.
+    static void wake(std::atomic_int& signal, int num = 1);
+};
+
+}}
+
+#include <quantum/impl/quantum_futex_impl.h>
+
+#endif //QUANTUM_FUTEX_H
@@ -18,8 +18,10 @@
 
 #include <exception>
 #include <quantum/quantum_shared_state.h>
+#include <quantum/quantum_shared_future.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/interface/quantum_ifuture.h>
+#include <quantum/interface/quantum_iqueue.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -56,9 +58,15 @@ public:
     template <class V = T>
     const NonBufferRetType<V>& getRef() const;
     
+    template <class V = T>
+    SharedFuture<NonBufferRetType<V>> share() const;
+    
     template <class V = T>
     BufferRetType<V> pull(bool& isBufferClosed);
     
+    template <class V = T>
+    std::vector<BufferRetType<V>> pullBatch(size_t maxItems, bool& isBufferClosed);
+    
     //ICoroFutureBase
     void wait(ICoroSync::Ptr sync) const final;
     std::future_status waitFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs) const final;
@@ -70,9 +78,25 @@ public:
     template <class V = T>
     const NonBufferRetType<V>& getRef(ICoroSync::Ptr sync) const;
     
+    template <class V = T>
+    bool getFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs, NonBufferRetType<V>& value);
+    
+    template <class CLOCK, class DURATION, class V = T>
+    bool getUntil(ICoroSync::Ptr sync, const std::chrono::time_point<CLOCK, DURATION>& deadline, NonBufferRetType<V>& value);
+    
     template <class V = T>
     BufferRetType<V> pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
+    template <class V = T>
+    std::vector<BufferRetType<V>> pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed);
+    
+    template <class FUNC>
+    void onReady(FUNC&& callback);
+    
+    //Continuations. FUTURE is the interface type passed to func.
+    template <class FUTURE, class DISPATCHER, class FUNC>
+    void onReady(DISPATCHER& dispatcher, int queueId, bool isHighPriority, FUNC&& func);
+    
     //===================================
     //           NEW / DELETE
     //===================================
@@ -17,6 +17,7 @@
 #define QUANTUM_HEAP_ALLOCATOR_H
 
 #include <quantum/quantum_contiguous_pool_manager.h>
+#include <quantum/quantum_huge_pages.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -59,8 +60,16 @@ struct HeapAllocator : public ContiguousPoolManager<T>
     //------------------------------- Methods ----------------------------------
     HeapAllocator(index_type size) :
         _size(size),
-        _buffer(new aligned_type[size])
+        _buffer(nullptr),
+        _isHugePageBacked(false)
     {
+        if (AllocatorTraits::useHugePages()) {
+            _buffer = static_cast<aligned_type*>(HugePages::allocate(size * sizeof(aligned_type)));
+            _isHugePageBacked = (_buffer != nullptr);
+        }
+        if (!_buffer) {
+            _buffer = new aligned_type[size];
+        }
         if (!_buffer) {
             throw std::bad_alloc();
         }
@@ -80,11 +89,17 @@ struct HeapAllocator : public ContiguousPoolManager<T>
         static_cast<ContiguousPoolManager<T>>(*this) = static_cast<ContiguousPoolManager<T>&&>(other);
         _size = other._size;
         _buffer = other._buffer;
+        _isHugePageBacked = other._isHugePageBacked;
         other._size = 0;
         other._buffer = nullptr;
     }
     ~HeapAllocator() {
-        delete[] _buffer;
+        if (_isHugePageBacked) {
+            HugePages::deallocate(_buffer, _size * sizeof(aligned_type));
+        }
+        else {
+            delete[] _buffer;
+        }
     }
     static HeapAllocator select_on_container_copy_construction(const HeapAllocator& other) {
         return HeapAllocator(other.size());
@@ -107,6 +122,7 @@ private:
     //------------------------------- Members ----------------------------------
     index_type      _size;
     aligned_type*   _buffer;
+    bool            _isHugePageBacked;
 };
 
 }} //namespaces
@@ -0,0 +1,98 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_HISTOGRAM_H
+#define QUANTUM_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                       class Histogram
+//==============================================================================================
+/// @class Histogram.
+/// @brief Log-linear histogram of unsigned integer values.
+/// @details Values are grouped by powers of two and each power of two is further split into 'SubBuckets'
+///          linear buckets. This gives a constant relative precision of 1/SubBuckets over the entire 64-bit
+///          range with a fixed memory footprint. Histograms can be merged with operator+=.
+/// @note This class is not thread safe.
+class Histogram
+{
+public:
+    static constexpr size_t SubBucketBits = 4;
+    static constexpr size_t SubBuckets = (size_t)1 << SubBucketBits;
+    static constexpr size_t NumBuckets = SubBuckets + (64 - SubBucketBits) * SubBuckets;
+
+    Histogram();
+
+    /// @brief Clears all the recorded values.
+    void reset();
+
+    /// @brief Records a single value.
+    /// @param[in] value The value.
+    void record(uint64_t value);
+
+    /// @brief Number of recorded values.
+    /// @return The count.
+    uint64_t count() const;
+
+    /// @brief The smallest recorded value or 0 if the histogram is empty.
+    uint64_t min() const;
+
+    /// @brief The largest recorded value or 0 if the histogram is empty.
+    uint64_t max() const;
+
+    /// @brief The average of all recorded values.
+    double mean() const;
+
+    /// @brief Returns the value below which a given percentage of the recorded values fall.
+    /// @param[in] percent The percentile in the range [0, 100].
+    /// @return The highest value equivalent to the bucket holding the percentile, capped by max().
+    uint64_t percentile(double percent) const;
+
+    /// @brief Print a summary of the distribution.
+    /// @param[in,out] out Output stream.
+    void print(std::ostream& out) const;
+
+    /// @brief Merge the values recorded in another histogram.
+    Histogram& operator+=(const Histogram& rhs);
+
+private:
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketHighestValue(size_t index);
+
+    std::array<uint64_t, NumBuckets>    _buckets;
+    uint64_t                            _count;
+    uint64_t                            _min;
+    uint64_t                            _max;
+    double                              _sum;
+};
+
+/// @brief Overloads stream operator for Histogram object
+/// @param[in] out Output stream.
+/// @param[in] histogram Histogram object to stream.
+/// @return Reference to the same input stream.
+std::ostream& operator<<(std::ostream& out, const Histogram& histogram);
+
+}}
+
+#include <quantum/impl/quantum_histogram_impl.h>
+
+#endif //QUANTUM_HISTOGRAM_H
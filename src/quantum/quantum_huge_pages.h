@@ -0,0 +1,62 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_HUGE_PAGES_H
+#define QUANTUM_HUGE_PAGES_H
+
+#include <cstddef>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     struct HugePages
+//==============================================================================================
+/// @struct HugePages
+/// @brief Maps memory backed by 2MB pages to reduce TLB pressure on large pools.
+/// @details Explicit huge pages (MAP_HUGETLB) are tried first. If none are reserved on the system,
+///          the memory is mapped with regular pages, aligned on a 2MB boundary and advised for
+///          transparent huge pages so that the kernel can back it with huge pages when possible.
+/// @note For internal use only.
+struct HugePages
+{
+    static constexpr size_t PageSize = 2 * 1024 * 1024;
+    
+    /// @brief Round a size up to a whole number of huge pages.
+    static size_t roundUp(size_t bytes);
+    
+    /// @brief Map a zero-filled region.
+    /// @param[in] bytes The size of the region. Rounded up to a whole number of huge pages.
+    /// @return The start of the region or nullptr if huge pages are not supported on this platform
+    ///         or the region could not be mapped.
+    static void* allocate(size_t bytes);
+    
+    /// @brief Unmap a region returned by allocate().
+    /// @param[in] p The start of the region.
+    /// @param[in] bytes The size passed to allocate().
+    static void deallocate(void* p, size_t bytes);
+    
+    /// @brief Advise the kernel to back the huge page aligned part of an existing buffer with
+    ///        transparent huge pages.
+    /// @param[in] p The start of the buffer.
+    /// @param[in] bytes The size of the buffer.
+    static void advise(void* p, size_t bytes);
+};
+
+}}
+
+#include <quantum/impl/quantum_huge_pages_impl.h>
+
+#endif //QUANTUM_HUGE_PAGES_H
@@ -0,0 +1,59 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_IDLE_SIGNAL_H
+#define QUANTUM_IDLE_SIGNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class IdleSignal
+//==============================================================================================
+/// @class IdleSignal.
+/// @brief Wakes up the threads waiting for a set of queues to run out of work.
+/// @details Each queue signals this object whenever its thread finds no more work to do, so that a waiter
+///          re-evaluates its condition only when it may have changed instead of polling it. Signalling costs
+///          a single atomic load while nobody is waiting.
+/// @note For internal use only. See Dispatcher::drain().
+class IdleSignal
+{
+public:
+    /// @brief Wakes up all the waiters, if any.
+    void signal();
+    
+    /// @brief Waits until a condition becomes true, re-evaluating it each time a queue signals.
+    /// @param[in] timeout Maximum time to wait. Zero means wait indefinitely.
+    /// @param[in] isIdle Condition to wait for. It is evaluated with an internal mutex held.
+    /// @return The last value of the condition.
+    template <class PREDICATE>
+    bool waitFor(std::chrono::milliseconds timeout, PREDICATE&& isIdle);
+    
+private:
+    std::atomic_int         _numWaiters{0};
+    std::mutex              _mutex;
+    std::condition_variable _cond;
+};
+
+}}
+
+#include <quantum/impl/quantum_idle_signal_impl.h>
+
+#endif //QUANTUM_IDLE_SIGNAL_H
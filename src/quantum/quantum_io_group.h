@@ -0,0 +1,126 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_IO_GROUP_H
+#define QUANTUM_IO_GROUP_H
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <quantum/quantum_io_task.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class IoGroupStatistics
+//==============================================================================================
+/// @class IoGroupStatistics.
+/// @brief Counters of a named IO task group. See Dispatcher::setIoGroupLimits().
+class IoGroupStatistics
+{
+    friend class IoGroup;
+public:
+    /// @brief Number of tasks posted to the group.
+    size_t postedCount() const;
+    
+    /// @brief Number of tasks which have finished running.
+    size_t completedCount() const;
+    
+    /// @brief Number of tasks currently posted to an IO queue.
+    size_t inFlightCount() const;
+    
+    /// @brief Number of tasks currently held in the group queue.
+    size_t queuedCount() const;
+    
+    /// @brief Largest number of tasks held in the group queue at any time.
+    size_t maxQueuedCount() const;
+    
+    /// @brief Number of tasks which could not be posted immediately because a limit was reached.
+    size_t throttledCount() const;
+    
+    /// @brief Print to std::cout the content of this object.
+    void print(std::ostream& out = std::cout) const;
+    
+private:
+    size_t  _postedCount{0};
+    size_t  _completedCount{0};
+    size_t  _inFlightCount{0};
+    size_t  _queuedCount{0};
+    size_t  _maxQueuedCount{0};
+    size_t  _throttledCount{0};
+};
+
+std::ostream& operator<<(std::ostream& out, const IoGroupStatistics& stats);
+
+//==============================================================================================
+//                                      class IoGroup
+//==============================================================================================
+/// @class IoGroup.
+/// @brief Holds back the IO tasks of a group which exceed its concurrency or rate limit.
+/// @details Tasks waiting for a slot are kept in a group-local queue so that they do not occupy IO threads.
+///          The rate limit is a token bucket which refills continuously.
+/// @note For internal use only.
+class IoGroup
+{
+public:
+    using Ptr = std::shared_ptr<IoGroup>;
+    using Clock = std::chrono::steady_clock;
+    
+    IoGroup(size_t maxInFlight, double ratePerSecond, size_t burst);
+    
+    /// @brief Change the limits. Tasks already running are not affected.
+    void setLimits(size_t maxInFlight, double ratePerSecond, size_t burst);
+    
+    /// @brief Add a task to the group queue.
+    void enqueue(IoTask::Ptr task);
+    
+    /// @brief Remove the tasks which can run now within the limits.
+    /// @param[out] retryAfter Set when tasks are only held back by the rate limit and the caller should
+    ///                        call again after that time. Zero otherwise.
+    /// @return The tasks to post, in order.
+    std::vector<IoTask::Ptr> acquire(std::chrono::microseconds& retryAfter);
+    
+    /// @brief Called when a task acquired from this group finishes running.
+    void release();
+    
+    /// @brief Called when a retry scheduled via acquire() fires.
+    void retry();
+    
+    IoGroupStatistics stats() const;
+    
+private:
+    void refill(Clock::time_point now); //must be called with the lock held
+    
+    mutable std::mutex          _mutex;
+    std::deque<IoTask::Ptr>     _pending;
+    size_t                      _maxInFlight;   //0 means unlimited
+    double                      _ratePerSecond; //0 means unlimited
+    double                      _burst;
+    double                      _tokens;
+    Clock::time_point           _lastRefill;
+    bool                        _isRetryScheduled;
+    IoGroupStatistics           _stats;
+};
+
+}}
+
+#include <quantum/impl/quantum_io_group_impl.h>
+
+#endif //QUANTUM_IO_GROUP_H
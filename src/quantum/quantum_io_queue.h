@@ -21,12 +21,17 @@
 #include <condition_variable>
 #include <iostream>
 #include <atomic>
+#include <vector>
 #include <quantum/interface/quantum_itask.h>
 #include <quantum/interface/quantum_iterminate.h>
 #include <quantum/interface/quantum_iqueue.h>
 #include <quantum/quantum_io_task.h>
 #include <quantum/quantum_queue_statistics.h>
 #include <quantum/quantum_configuration.h>
+#include <quantum/quantum_idle_signal.h>
+#include <quantum/quantum_numa_topology.h>
+#include <quantum/quantum_mpmc_ring.h>
+#include <quantum/quantum_tracer.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -40,7 +45,7 @@ namespace quantum {
 class IoQueue : public IQueue
 {
 public:
-    using TaskList = std::list<IoTask::Ptr, QueueListAllocator>;
+    using TaskList = std::list<IoTask::Ptr, std::allocator_traits<QueueListAllocator>::rebind_alloc<IoTask::Ptr>>;
     using TaskListIter = TaskList::iterator;
     
     IoQueue();
@@ -58,6 +63,10 @@ public:
     
     void pinToCore(int coreId) final;
     
+    void pinToCpus(const NumaTopology::CpuSet& cpus);
+    
+    void setSchedPolicy(Configuration::SchedPolicy policy, int priority);
+    
     void run() final;
     
     void enqueue(ITask::Ptr task) final;
@@ -80,13 +89,62 @@ public:
     
     bool isIdle() const final;
     
+    //Enqueues several tasks with a single lock and signals the thread once
+    void enqueueBatch(std::vector<ITask::Ptr>& tasks);
+    
+    //Enqueues a task into the shared queue and hands it off to one idle IO thread, if any
+    void enqueueShared(ITask::Ptr task);
+    
+    //Same as above for several tasks. Wakes up at most one idle IO thread per task.
+    void enqueueSharedBatch(std::vector<ITask::Ptr>& tasks);
+    
+    //Wakes up one sleeping IO thread if any. Called after posting a task into a load-balanced shared queue.
+    void wakeIdleWorker();
+    
+    //How long the oldest task of this shared queue has been waiting. Only tracked if extra IO threads are allowed.
+    std::chrono::milliseconds oldestTaskWaitTime() const;
+    
+    //True if at least one IO thread is waiting for work on this shared queue
+    bool hasIdleWorkers() const;
+    
+    //Removes this thread from the idle list if it has been idle for at least 'timeout'. Once it returns true,
+    //the thread will no longer be woken up and can be terminated.
+    bool retireIfIdle(std::chrono::milliseconds timeout);
+    
+    //True if this shared queue holds its tasks in a lock-free ring. 'tryEnqueue' then only fails when the
+    //ring is full while 'enqueue' always goes to the overflow list.
+    bool hasRing() const;
+    
+    //Signalled each time this queue runs out of work. Must be set before any task is enqueued.
+    //Copies of this queue share the same signal.
+    void setIdleSignal(IdleSignal* signal);
+    
+    //Counts the tasks held by all the queues sharing 'counter'. Must be set before any task is enqueued.
+    //Copies of this queue share the same counter.
+    void setPendingTaskCounter(std::atomic<size_t>* counter);
+    
 private:
     ITask::Ptr grabWorkItem();
     ITask::Ptr grabWorkItemFromAll();
     void doEnqueue(ITask::Ptr task);
+    void incPendingCount();
+    void decPendingCount();
+    void push(const ITask::Ptr& task);
     ITask::Ptr doDequeue(std::atomic_bool& hint);
     ITask::Ptr tryDequeueFromShared();
     std::chrono::milliseconds getBackoffInterval();
+    void setIdle();
+    ITask::Ptr park();
+    void signalIdle();
+    bool runSharedMemoryTask();
+    void addIdleWorker();
+    void removeIdleWorker();
+    IoQueue* popIdleWorker();
+    void initPriorityLevels(const std::vector<size_t>& weights);
+    size_t getPriorityLevel(const ITask::Ptr& task) const;
+    TaskList* selectPriorityLevel();
+    bool isQueueEmpty() const;
+    size_t queueSize() const;
     
     //async IO queue
     std::vector<IoQueue>*           _sharedIoQueues;
@@ -95,9 +153,14 @@ private:
     Configuration::BackoffPolicy    _loadBalancePollIntervalBackoffPolicy;
     size_t                          _loadBalancePollIntervalNumBackoffs;
     size_t                          _loadBalanceBackoffNum;
+    size_t                          _loadBalanceNumPollsBeforeParking;
+    size_t                          _loadBalanceNumEmptyPolls;
     std::shared_ptr<std::thread>    _thread;
-    TaskList                        _queue;
-    mutable SpinLock                _spinlock;
+    std::unique_ptr<MpmcRing<IoTask::Ptr>> _ring; //load balanced shared queue only
+    std::vector<TaskList>           _queues;    //one list per priority level, lowest first
+    std::vector<size_t>             _weights;   //number of tasks each level may run per round
+    std::vector<size_t>             _credits;   //tasks left to run in the current round per level
+    mutable PaddedSpinLock          _spinlock;
     std::mutex                      _notEmptyMutex; //for accessing the condition variable
     std::condition_variable         _notEmptyCond;
     std::atomic_bool                _isEmpty;
@@ -105,6 +168,16 @@ private:
     std::atomic_bool                _isIdle;
     std::atomic_flag                _terminated;
     QueueStatistics                 _stats;
+    std::vector<IoQueue*>           _idleWorkers; //shared queue only: threads waiting for work, most recent last
+    std::atomic<size_t>             _numIdleWorkers; //shared queue only: size of '_idleWorkers'
+    bool                            _isIdleWorker; //this thread is in the idle list of the shared queue
+    std::chrono::steady_clock::time_point _idleSince; //when this thread was added to the idle list
+    bool                            _isElastic; //shared queue only: tasks are timestamped for the elastic IO threads
+    std::atomic<IdleSignal*>        _idleSignal; //set once all the queues are constructed
+    std::atomic<std::atomic<size_t>*> _pendingTaskCounter; //null unless the dispatcher limits pending IO tasks
+    SharedMemoryQueue::Ptr          _sharedMemoryQueue; //threaded queues only: work from other processes
+    std::chrono::milliseconds       _sharedMemoryQueuePollIntervalMs;
+    SharedMemoryQueue::Message      _sharedMemoryMessage; //reused to avoid allocating for each message
 };
 
 }}
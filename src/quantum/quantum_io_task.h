@@ -16,10 +16,12 @@
 #ifndef QUANTUM_IO_TASK_H
 #define QUANTUM_IO_TASK_H
 
+#include <chrono>
 #include <functional>
 #include <quantum/interface/quantum_itask.h>
 #include <quantum/quantum_capture.h>
 #include <quantum/quantum_promise.h>
+#include <quantum/quantum_cancellation_token.h>
 #include <quantum/util/quantum_util.h>
 
 namespace Bloomberg {
@@ -33,6 +35,7 @@ namespace quantum {
 /// @note For internal use only.
 class IoTask : public ITask
 {
+    friend class IoQueue;
 public:
     using Ptr = std::shared_ptr<IoTask>;
     using WeakPtr = std::weak_ptr<IoTask>;
@@ -45,7 +48,7 @@ public:
     template <class RET, class FUNC, class ... ARGS>
     IoTask(std::shared_ptr<Promise<RET>> promise,
            int queueId,
-           bool isHighPriority,
+           int priority,
            FUNC&& func,
            ARGS&&... args);
     
@@ -67,6 +70,20 @@ public:
     bool isBlocked() const final;
     bool isSleeping(bool updateTimer = false) final;
     bool isHighPriority() const final;
+    int getPriority() const final;
+    
+    /// @brief Set a function called after the task has run, even if it threw.
+    /// @note If a completion promise is set, the function is also called as soon as that promise is satisfied,
+    ///       so it must tolerate being called twice.
+    void setCompletionHandler(std::function<void()> handler);
+    
+    /// @brief Also call the completion handler when 'promise' is satisfied, before its waiters are notified.
+    /// @note Must be called before setCompletionHandler().
+    void setCompletionPromise(IPromiseBase::Ptr promise);
+    
+    /// @brief Drop the task if 'token' is cancelled before it starts, in which case 'promise' is set
+    ///        with a CancellationException and run() returns ITask::RetCode::Cancelled.
+    void setCancellationToken(CancellationToken::Ptr token, IPromiseBase::Ptr promise);
     
     //===================================
     //           NEW / DELETE
@@ -76,10 +93,17 @@ public:
     static void deleter(IoTask* p);
     
 private:
+    int invoke();
+    
     Function<int()>         _func;      //the current runnable io function
     std::atomic_flag        _terminated;
     int                     _queueId;
-    bool                    _isHighPriority;
+    int                     _priority;
+    std::chrono::steady_clock::time_point _postTimestamp; //only set when posted to an elastic shared queue
+    std::function<void()>   _onComplete; //used by IO task groups
+    IPromiseBase::Ptr       _completionPromise; //used by IO task groups
+    CancellationToken::Ptr  _cancellationToken; //null if the task cannot be cancelled
+    IPromiseBase::Ptr       _cancellationPromise; //set when the task is dropped
 };
 
 using IoTaskPtr = IoTask::Ptr;
@@ -0,0 +1,87 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_LATCH_H
+#define QUANTUM_LATCH_H
+
+#include <atomic>
+#include <stdexcept>
+#include <quantum/quantum_wait_queue.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                        class Latch
+//==============================================================================================
+/// @class Latch.
+/// @brief Coroutine-compatible single-use countdown latch.
+/// @details Waiters are released once the counter reaches zero. Counting down is a single atomic
+///          operation and only the final count down wakes up parked callers.
+class Latch
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] count The initial value of the counter.
+    explicit Latch(size_t count);
+    
+    Latch(const Latch& other) = delete;
+    Latch& operator=(const Latch& other) = delete;
+    
+    /// @brief Decrements the counter and releases all waiters if it reaches zero.
+    /// @param[in] num The value by which the counter is decremented.
+    /// @note Throws if num is greater than the current value of the counter.
+    void countDown(size_t num = 1);
+    
+    /// @brief Determines if the counter has reached zero.
+    /// @return True if it has, false otherwise.
+    bool tryWait() const;
+    
+    /// @brief Waits until the counter reaches zero.
+    /// @note Must be called in a non-coroutine context.
+    void wait();
+    
+    /// @brief Waits until the counter reaches zero.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void wait(ICoroSync::Ptr sync);
+    
+    /// @brief Decrements the counter and waits until it reaches zero.
+    /// @param[in] num The value by which the counter is decremented.
+    /// @note Must be called in a non-coroutine context.
+    void arriveAndWait(size_t num = 1);
+    
+    /// @brief Decrements the counter and waits until it reaches zero.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] num The value by which the counter is decremented.
+    /// @note Must be called from a coroutine.
+    void arriveAndWait(ICoroSync::Ptr sync, size_t num = 1);
+    
+    /// @brief Returns the current value of the counter.
+    /// @return The counter value.
+    size_t count() const;
+    
+private:
+    //Members
+    std::atomic_size_t  _count;
+    WaitQueue           _waiters;
+};
+
+}}
+
+#include <quantum/impl/quantum_latch_impl.h>
+
+#endif //QUANTUM_LATCH_H
@@ -0,0 +1,147 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_LOCK_PROFILER_H
+#define QUANTUM_LOCK_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Bloomberg {
+namespace quantum {
+
+class LockProfiler;
+
+//==============================================================================================
+//                                   class LockStatistics
+//==============================================================================================
+/// @class LockStatistics.
+/// @brief Snapshot of the contention counters of a lock site. See Dispatcher::lockStats().
+class LockStatistics
+{
+    friend class LockProfiler;
+public:
+    /// @brief Number of times a lock of this site was acquired.
+    size_t acquisitionCount() const;
+    
+    /// @brief Number of times the first attempt to acquire a lock of this site failed.
+    size_t contentionCount() const;
+    
+    /// @brief Number of pause instructions executed while spinning on a lock of this site.
+    size_t spinCount() const;
+    
+    /// @brief Number of times a waiter yielded its thread or coroutine, or slept, on a lock of this site.
+    size_t yieldCount() const;
+    
+    /// @brief Print to std::cout the content of this object.
+    void print(std::ostream& out = std::cout) const;
+    
+private:
+    size_t  _acquisitionCount{0};
+    size_t  _contentionCount{0};
+    size_t  _spinCount{0};
+    size_t  _yieldCount{0};
+};
+
+std::ostream& operator<<(std::ostream& out, const LockStatistics& stats);
+
+//==============================================================================================
+//                                      class LockSite
+//==============================================================================================
+/// @class LockSite.
+/// @brief Name under which the contention of a set of locks is reported.
+/// @details Sites are only registered when contention profiling is compiled in by defining
+///          __QUANTUM_PROFILE_LOCKS. Otherwise this object is empty and the locks naming it are not instrumented.
+///          Sites are meant to be static objects, see LockProfiler::site().
+class LockSite
+{
+    friend class SpinLock;
+    friend class Mutex;
+public:
+    /// @brief Constructor.
+    /// @param[in] name Name of the site. Sites with the same name share their counters.
+    explicit LockSite(const char* name);
+    
+    /// @brief Records a lock acquisition.
+    /// @param[in] isContended True if the first attempt to acquire the lock failed.
+    /// @param[in] spins Number of pause instructions executed.
+    /// @param[in] yields Number of yields or sleeps.
+    void record(bool isContended, size_t spins, size_t yields) const;
+    
+    /// @brief Records a failed attempt to acquire a lock without waiting.
+    void recordFailure() const;
+    
+private:
+    struct Counters
+    {
+        std::atomic_size_t  _acquisitionCount{0};
+        std::atomic_size_t  _contentionCount{0};
+        std::atomic_size_t  _spinCount{0};
+        std::atomic_size_t  _yieldCount{0};
+    };
+    friend class LockProfiler;
+    
+#ifdef __QUANTUM_PROFILE_LOCKS
+    Counters*   _counters;
+#endif
+};
+
+//==============================================================================================
+//                                    class LockProfiler
+//==============================================================================================
+/// @class LockProfiler.
+/// @brief Registry of the lock sites.
+/// @note Profiling adds a few relaxed atomic increments to every lock acquisition of the named sites.
+class LockProfiler
+{
+public:
+    /// @brief Gets the site of a type of lock owner.
+    /// @tparam OWNER The type owning the locks, used to create the site only once.
+    /// @param[in] name Name of the site.
+    /// @return The site.
+    template <class OWNER>
+    static const LockSite& site(const char* name);
+    
+    /// @brief Gets the counters of all the sites.
+    /// @return The counters keyed by site name. Empty unless __QUANTUM_PROFILE_LOCKS is defined.
+    static std::map<std::string, LockStatistics> stats();
+    
+    /// @brief Resets the counters of all the sites.
+    static void reset();
+    
+private:
+    friend class LockSite;
+    using Counters = LockSite::Counters;
+    
+    struct Registry
+    {
+        std::mutex                                          _mutex;
+        std::map<std::string, std::unique_ptr<Counters>>    _counters;
+    };
+    
+    static Registry& registry();
+    static Counters* counters(const char* name);
+};
+
+}}
+
+#include <quantum/impl/quantum_lock_profiler_impl.h>
+
+#endif //QUANTUM_LOCK_PROFILER_H
@@ -0,0 +1,204 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_METRICS_H
+#define QUANTUM_METRICS_H
+
+#include <quantum/interface/quantum_imetrics_sink.h>
+#include <quantum/interface/quantum_iqueue.h>
+#include <quantum/quantum_allocator_statistics.h>
+#include <quantum/quantum_histogram.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct QueueMetrics
+//==============================================================================================
+/// @struct QueueMetrics
+/// @brief Metrics of a single coroutine or IO queue. See MetricsSnapshot.
+struct QueueMetrics
+{
+    IQueue::QueueType   _type{IQueue::QueueType::Coro};
+    int                 _queueId{0}; ///< IQueue::QueueId::Any for the shared IO queues
+    size_t              _numElements{0}; ///< Gauge
+    size_t              _postedCount{0};
+    size_t              _completedCount{0}; ///< Includes the IO tasks completed from the shared queue
+    size_t              _errorCount{0}; ///< Includes the IO tasks failed from the shared queue
+    size_t              _stolenCount{0};
+    size_t              _migratedCount{0};
+    size_t              _expiredCount{0};
+    size_t              _cancelledCount{0};
+    size_t              _longSliceCount{0};
+    Histogram           _queueWaitTimeNs; ///< Since the queue was created or its statistics were reset
+    Histogram           _runTimeNs; ///< Since the queue was created or its statistics were reset
+};
+
+//==============================================================================================
+//                                      struct MetricsSnapshot
+//==============================================================================================
+/// @struct MetricsSnapshot
+/// @brief Metrics published to an IMetricsSink at the end of each export period.
+struct MetricsSnapshot
+{
+    using Gauges = std::map<std::string, double>;
+    
+    std::chrono::system_clock::time_point       _timestamp;
+    std::chrono::milliseconds                   _period{0}; ///< Time covered by the counters
+    std::vector<QueueMetrics>                   _queues;
+    std::map<std::string, AllocatorStatistics>  _allocators; ///< See Dispatcher::allocatorStats()
+    Gauges                                      _gauges; ///< See Dispatcher::setMetricsSource()
+};
+
+//==============================================================================================
+//                                      struct MetricsNames
+//==============================================================================================
+/// @struct MetricsNames
+/// @brief Naming helpers shared by the metrics sinks.
+/// @note For internal use only.
+struct MetricsNames
+{
+    using Counter = std::pair<const char*, size_t QueueMetrics::*>;
+    
+    /// @brief Gets the counters of a queue along with their name.
+    static const std::vector<Counter>& queueCounters();
+    
+    /// @brief Gets the name of the type of a queue, i.e. "coro" or "io".
+    static const char* queueType(const QueueMetrics& queue);
+    
+    /// @brief Gets the id of a queue as a string, or "any" for the shared IO queues.
+    static std::string queueId(const QueueMetrics& queue);
+    
+    /// @brief Replaces the characters which are not allowed in a metric name.
+    static std::string sanitize(const std::string& name, char replacement);
+};
+
+//==============================================================================================
+//                                class PrometheusMetricsSink
+//==============================================================================================
+/// @class PrometheusMetricsSink
+/// @brief Renders the published metrics in the Prometheus text exposition format.
+/// @details Counters are accumulated across periods and latency histograms are rendered as summaries. The text is
+///          rebuilt on each publish() and can be served from any thread via text().
+class PrometheusMetricsSink : public IMetricsSink
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] prefix Prefix of all the metric names.
+    explicit PrometheusMetricsSink(std::string prefix = "quantum");
+    
+    void publish(const MetricsSnapshot& metrics) final;
+    
+    /// @brief Gets the metrics of the last publish() call.
+    /// @return The text exposition or an empty string if nothing was published yet.
+    std::string text() const;
+    
+private:
+    using Labels = std::pair<std::string, std::string>; //metric name and labels
+    
+    void addCounter(std::ostream& out, const std::string& name, const std::string& labels, size_t delta);
+    
+    std::string                     _prefix;
+    std::map<Labels, size_t>        _totals;
+    mutable std::mutex              _mutex;
+    std::string                     _text;
+};
+
+//==============================================================================================
+//                                  class StatsdMetricsSink
+//==============================================================================================
+/// @class StatsdMetricsSink
+/// @brief Sends the published metrics in the StatsD line format.
+/// @details Counters are sent as '|c' deltas, everything else as '|g' gauges, with histograms reduced to a few
+///          percentiles. The lines are grouped into packets no larger than the maximum packet size, which are handed
+///          to a writer, e.g. a function sending a UDP datagram to the StatsD agent.
+class StatsdMetricsSink : public IMetricsSink
+{
+public:
+    using Writer = std::function<void(const std::string& packet)>;
+    
+    /// @brief Constructor.
+    /// @param[in] writer Sends a packet.
+    /// @param[in] prefix Prefix of all the metric names.
+    /// @param[in] maxPacketSize Maximum size of a packet in bytes. A line longer than this is sent on its own.
+    explicit StatsdMetricsSink(Writer writer,
+                               std::string prefix = "quantum",
+                               size_t maxPacketSize = 1432);
+    
+    void publish(const MetricsSnapshot& metrics) final;
+    
+private:
+    void addLine(std::string& packet, const std::string& name, double value, const char* type);
+    
+    Writer      _writer;
+    std::string _prefix;
+    size_t      _maxPacketSize;
+};
+
+//==============================================================================================
+//                                   class MetricsExporter
+//==============================================================================================
+/// @class MetricsExporter
+/// @brief Collects the metrics of a dispatcher at regular intervals and publishes the changes to a sink.
+/// @note For internal use only. See Configuration::setMetricsSink().
+class MetricsExporter
+{
+public:
+    using Collector = std::function<void(MetricsSnapshot& metrics)>;
+    
+    /// @brief Constructor. Starts the metrics thread at the lowest scheduling priority available.
+    /// @param[in] sink The sink.
+    /// @param[in] period The export period.
+    /// @param[in] collector Fills in the current value of all the metrics.
+    MetricsExporter(IMetricsSink::Ptr sink,
+                    std::chrono::milliseconds period,
+                    Collector collector);
+    
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+    
+    ~MetricsExporter();
+    
+    /// @brief Stops the metrics thread. Nothing is published once this returns.
+    void terminate();
+    
+private:
+    void run();
+    void publish();
+    static size_t delta(size_t current, size_t previous);
+    
+    IMetricsSink::Ptr           _sink;
+    std::chrono::milliseconds   _period;
+    Collector                   _collector;
+    MetricsSnapshot             _previous;
+    std::mutex                  _mutex;
+    std::condition_variable     _cond;
+    bool                        _isInterrupted;
+    std::thread                 _thread;
+};
+
+}}
+
+#include <quantum/impl/quantum_metrics_impl.h>
+
+#endif //QUANTUM_METRICS_H
@@ -0,0 +1,95 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_MPMC_RING_H
+#define QUANTUM_MPMC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     class MpmcRing
+//==============================================================================================
+/// @class MpmcRing
+/// @brief Bounded lock-free multi-producer multi-consumer FIFO.
+/// @details Each slot carries a sequence number which tells producers and consumers whether the slot
+///          is ready for them, so that a push or a pop only needs a single compare-and-swap on the shared
+///          position. Operations never block and never spin on another thread's progress.
+/// @tparam T The element type. Must be default constructible and movable.
+/// @note For internal use only.
+template <typename T>
+class MpmcRing
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] capacity The maximum number of elements. Rounded up to the next power of two.
+    explicit MpmcRing(size_t capacity);
+    
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+    
+    /// @brief Insert an element at the back.
+    /// @param[in] value The element to insert.
+    /// @return True if successful, false if the ring is full in which case 'value' is left untouched.
+    bool tryPush(T& value);
+    
+    /// @brief Remove the element at the front.
+    /// @param[out] value The removed element.
+    /// @return True if successful, false if the ring is empty.
+    bool tryPop(T& value);
+    
+    /// @brief Number of elements in the ring.
+    /// @return The size.
+    /// @note The value is only an approximation if other threads are pushing or popping concurrently.
+    size_t size() const;
+    
+    /// @brief Check if the ring is empty.
+    /// @return True if empty.
+    bool empty() const;
+    
+    /// @brief The maximum number of elements.
+    /// @return The capacity.
+    size_t capacity() const;
+    
+private:
+    static constexpr size_t CacheLineSize = 64;
+    
+    struct Slot
+    {
+        std::atomic<size_t>     _sequence;
+        T                       _value;
+    };
+    
+    static size_t roundUp(size_t capacity);
+    
+    const size_t                _mask;
+    std::unique_ptr<Slot[]>     _slots;
+    char                        _pad0[CacheLineSize];
+    std::atomic<size_t>         _pushPos;
+    char                        _pad1[CacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t>         _popPos;
+    char                        _pad2[CacheLineSize - sizeof(std::atomic<size_t>)];
+};
+
+}}
+
+#include <quantum/impl/quantum_mpmc_ring_impl.h>
+
+#endif //QUANTUM_MPMC_RING_H
@@ -21,6 +21,7 @@
 #include <quantum/quantum_spinlock.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/quantum_yielding_thread.h>
+#include <quantum/quantum_futex.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -30,9 +31,11 @@ namespace quantum {
 //==============================================================================================
 /// @class Mutex.
 /// @brief Coroutine-compatible implementation of a mutex.
-/// @details This mutex wraps a specialized form of spinlock. The mutex must be used to protect
-///          a critical region which is shared between coroutines and (optionally) other code
-///          running in a non-coroutine (i.e. regular threaded) context.
+/// @details The mutex must be used to protect a critical region which is shared between coroutines and
+///          (optionally) other code running in a non-coroutine (i.e. regular threaded) context.
+///          Contended callers wait in FIFO order and ownership is handed directly to the next waiter on
+///          unlock(). A waiting coroutine is blocked, and can be parked by its queue, while a waiting
+///          thread sleeps on a futex (Linux) or yields.
 class Mutex
 {
 public:
@@ -40,28 +43,34 @@ public:
     /// @note Mutex object is in unlocked state.
     Mutex();
     
+    /// @brief Constructor.
+    /// @param[in] site Site under which the contention on this mutex is reported, see LockProfiler.
+    /// @note Mutex object is in unlocked state.
+    explicit Mutex(const LockSite& site);
+    
     Mutex(const Mutex& other) = delete;
     Mutex& operator=(const Mutex& other) = delete;
     
     /// @brief Locks this mutex.
-    /// @details The mutex object yields (or conditionally sleeps) the current thread for a short
-    ///          period of time until locking succeeds. See YieldingThreadDuration for more details.
+    /// @details The current thread waits until the mutex is handed over to it.
     /// @note Must be called in a non-coroutine context.
     /// @warning Wrongfully calling this method from a coroutine will block all coroutines running in the
     ///          same queue and thus result in noticeable performance degradation.
     void lock();
     
     /// @brief Locks this mutex.
-    /// @details The mutex object yields the current coroutine until locking succeeds.
+    /// @details The current coroutine is blocked until the mutex is handed over to it.
     /// @param[in] sync Pointer to a coroutine synchronization object.
     /// @note Must be called from a coroutine.
     void lock(ICoroSync::Ptr sync);
     
     /// @brief Tries to lock the mutex object.
     /// @return True if succeeds, false otherwise.
+    /// @note Never succeeds while other callers are waiting for the mutex.
     bool tryLock();
     
     /// @brief Unlock this mutex.
+    /// @details If callers are waiting, the longest waiting one becomes the owner.
     void unlock();
     
     //==============================================================================================
@@ -139,11 +148,30 @@ public:
     };
     
 private:
-    template <class YIELDING>
-    void lockImpl(YIELDING&& yield);
+    //Node of the waiter list. Lives on the stack of the waiting coroutine or thread.
+    struct Waiter
+    {
+        ICoroSync::Ptr      _sync;      //null for threads
+        std::atomic_int     _signal{0}; //set to 1 when a thread waiter becomes the owner
+        Waiter*             _next{nullptr};
+    };
+    
+    bool enqueue(Waiter& waiter); //returns false if the mutex was acquired instead
+    
+    bool tryAcquire();
+    
+    void profile(bool isContended, size_t yields) const;
+    
+    static size_t wait(std::atomic_int& signal); //returns the number of sleeps or yields
     
     //Members
-    mutable SpinLock  _spinlock;
+    std::atomic_bool  _isLocked;
+    mutable SpinLock  _spinlock; //protects the waiter list
+    Waiter*           _head;
+    Waiter*           _tail;
+#ifdef __QUANTUM_PROFILE_LOCKS
+    const LockSite*   _site;
+#endif
 };
 
 }}
@@ -0,0 +1,96 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_NUMA_TOPOLOGY_H
+#define QUANTUM_NUMA_TOPOLOGY_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <quantum/quantum_configuration.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                       class NumaTopology
+//==============================================================================================
+/// @class NumaTopology.
+/// @brief Describes which CPUs belong to which NUMA node and computes thread placements.
+/// @details On Linux the topology is read from sysfs which does not require any additional library.
+///          Within each node, the first hardware thread of every physical core is listed before
+///          any hyper-thread sibling so that threads get spread over physical cores first.
+///          On other platforms, or if the information is not available, a single node holding
+///          all the CPUs is assumed.
+class NumaTopology
+{
+public:
+    using CpuSet = std::vector<int>;
+    
+    /// @brief Constructor. Discovers the topology of the current machine.
+    NumaTopology();
+    
+    /// @brief Constructor.
+    /// @param[in] nodes The CPUs belonging to each node, in order of preference.
+    explicit NumaTopology(std::vector<CpuSet> nodes);
+    
+    /// @brief Get the topology of the current machine.
+    /// @return The topology. This is only discovered once.
+    static const NumaTopology& instance();
+    
+    /// @brief Get the number of NUMA nodes.
+    size_t numNodes() const;
+    
+    /// @brief Get the CPUs belonging to a node.
+    /// @param[in] node The node in the range [0, numNodes()).
+    const CpuSet& getNodeCpus(size_t node) const;
+    
+    /// @brief Get the CPU on which a coroutine thread should run.
+    /// @param[in] placement The placement policy.
+    /// @param[in] threadIndex The index of the coroutine thread.
+    /// @return A set holding a single CPU or an empty set if the thread should not be pinned.
+    CpuSet getCoroutineThreadCpus(Configuration::ThreadPlacement placement, size_t threadIndex) const;
+    
+    /// @brief Get the CPUs on which an IO thread may run.
+    /// @details IO threads spend most of their time blocked, so they are bound to all the CPUs
+    ///          of a node rather than to a single one.
+    /// @param[in] placement The placement policy.
+    /// @param[in] threadIndex The index of the IO thread.
+    /// @return The CPUs of the selected node or an empty set if the thread should not be pinned.
+    CpuSet getIoThreadCpus(Configuration::ThreadPlacement placement, size_t threadIndex) const;
+    
+    /// @brief Restrict a thread to a set of CPUs.
+    /// @param[in] thread The thread.
+    /// @param[in] cpus The CPUs. An empty set leaves the thread unchanged.
+    static void pinThread(std::thread& thread, const CpuSet& cpus);
+    
+    /// @brief Parse a list of CPUs in the Linux sysfs format, e.g. "0-3,8,10-11".
+    /// @param[in] list The list.
+    /// @return The CPUs in the list.
+    static CpuSet parseCpuList(const std::string& list);
+    
+private:
+    static std::vector<CpuSet> discover();
+    size_t getNodeOf(int cpu) const;
+    
+    std::vector<CpuSet>     _nodes;
+    CpuSet                  _packed; //all CPUs, node by node
+};
+
+}}
+
+#include <quantum/impl/quantum_numa_topology_impl.h>
+
+#endif //QUANTUM_NUMA_TOPOLOGY_H
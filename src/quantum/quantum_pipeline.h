@@ -0,0 +1,212 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_PIPELINE_H
+#define QUANTUM_PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <quantum/quantum_channel.h>
+#include <quantum/quantum_dispatcher.h>
+#include <quantum/quantum_spinlock.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+/// @brief Where the workers of a pipeline stage run.
+enum class PipelineStageKind : int
+{
+    Coroutine,      ///< Each worker is a coroutine. For CPU-bound or non-blocking stages.
+    Io              ///< Each worker occupies an IO thread. For stages making blocking calls.
+};
+
+template <class IN, class OUT>
+class Pipeline;
+
+//==============================================================================================
+//                                 class PipelineStageStatistics
+//==============================================================================================
+/// @class PipelineStageStatistics.
+/// @brief Snapshot of the counters of a pipeline stage. See Pipeline::stats().
+class PipelineStageStatistics
+{
+    template <class IN, class OUT>
+    friend class Pipeline;
+public:
+    /// @brief Name of the stage.
+    const std::string& name() const;
+    
+    /// @brief Number of concurrent workers of the stage.
+    size_t parallelism() const;
+    
+    /// @brief Number of values processed by the stage so far.
+    size_t processedCount() const;
+    
+    /// @brief Number of values waiting in the input queue of the stage.
+    size_t queueDepth() const;
+    
+    /// @brief Maximum number of values the input queue of the stage can hold.
+    size_t queueCapacity() const;
+    
+    /// @brief Average number of values processed per second since the stage was added.
+    double throughput() const;
+    
+    /// @brief Print to std::cout the content of this object.
+    void print(std::ostream& out = std::cout) const;
+    
+private:
+    std::string _name;
+    size_t      _parallelism{0};
+    size_t      _processedCount{0};
+    size_t      _queueDepth{0};
+    size_t      _queueCapacity{0};
+    double      _throughput{0};
+};
+
+std::ostream& operator<<(std::ostream& out, const PipelineStageStatistics& stats);
+
+//==============================================================================================
+//                                 struct PipelineStage
+//==============================================================================================
+/// @struct PipelineStage.
+/// @brief State shared by the workers of a pipeline stage.
+/// @note For internal use only.
+struct PipelineStage
+{
+    std::string                             _name;
+    size_t                                  _parallelism{0};
+    std::function<size_t()>                 _queueDepth;
+    size_t                                  _queueCapacity{0};
+    std::atomic_size_t                      _processedCount{0};
+    std::atomic_size_t                      _activeWorkers{0};
+    std::chrono::steady_clock::time_point   _started{std::chrono::steady_clock::now()};
+    std::vector<std::function<void()>>      _waiters; //wait for the completion of each worker
+};
+
+/// @struct PipelineCore.
+/// @brief State shared by all the handles of a pipeline.
+/// @note For internal use only.
+struct PipelineCore
+{
+    explicit PipelineCore(Dispatcher& dispatcher);
+    
+    Dispatcher&                                 _dispatcher;
+    mutable SpinLock                            _lock; //protects the stage list
+    std::vector<std::shared_ptr<PipelineStage>> _stages;
+};
+
+//==============================================================================================
+//                                      class Pipeline
+//==============================================================================================
+/// @class Pipeline.
+/// @brief Chain of processing stages connected by bounded queues.
+/// @details Each stage runs a number of workers which pull values from the queue of the previous stage, apply the
+///          stage function and push the results into the queue of the next stage. A full queue suspends the workers
+///          feeding it, so memory stays bounded and a slow stage throttles the ones before it.
+///          Pipeline objects are handles: adding a stage returns a new handle whose output is the new stage, and
+///          all the handles of a pipeline share the same stages.
+/// @tparam IN The type of the values pushed into the pipeline.
+/// @tparam OUT The type of the values output by the last stage.
+template <class IN, class OUT = IN>
+class Pipeline
+{
+    template <class, class>
+    friend class Pipeline;
+public:
+    /// @brief Constructor.
+    /// @param[in] dispatcher The dispatcher running the workers of all the stages.
+    /// @param[in] capacity The capacity of the input queue of the pipeline. Zero means unbounded.
+    explicit Pipeline(Dispatcher& dispatcher, size_t capacity = 1024);
+    
+    /// @brief Adds a stage at the end of the pipeline. Its workers start immediately.
+    /// @tparam NEXT The type of the values output by the new stage.
+    /// @param[in] name The name of the stage, used in the statistics.
+    /// @param[in] func The function applied to every value.
+    /// @param[in] parallelism The number of workers of the stage.
+    /// @param[in] kind Indicates if the workers are coroutines or IO tasks.
+    /// @param[in] capacity The capacity of the output queue of the stage. Zero means unbounded.
+    /// @return A handle to the pipeline whose output is the new stage.
+    /// @note Values are output in the order they are processed which, if parallelism is greater than one,
+    ///       may differ from the order they were pushed.
+    template <class NEXT>
+    Pipeline<IN, NEXT> addStage(std::string name,
+                                std::function<NEXT(OUT&&)> func,
+                                size_t parallelism = 1,
+                                PipelineStageKind kind = PipelineStageKind::Coroutine,
+                                size_t capacity = 1024) const;
+    
+    /// @brief Adds a final stage which consumes the values and has no output.
+    /// @return A handle to the pipeline which cannot be pulled from.
+    Pipeline<IN, OUT> addSink(std::string name,
+                              std::function<void(OUT&&)> func,
+                              size_t parallelism = 1,
+                              PipelineStageKind kind = PipelineStageKind::Coroutine) const;
+    
+    /// @brief Pushes a value into the pipeline, waiting while its input queue is full.
+    /// @return True if the value was pushed, false if the pipeline is closed.
+    /// @note Must be called in a non-coroutine context.
+    bool push(IN value);
+    
+    /// @brief Same as above but from a coroutine.
+    bool push(ICoroSync::Ptr sync, IN value);
+    
+    /// @brief Closes the input of the pipeline. Each stage completes once it has processed all its
+    ///        input values, and then closes its own output.
+    void close();
+    
+    /// @brief Pulls a value output by the last stage, waiting while there is none.
+    /// @return True if a value was pulled, false once the pipeline has completed and all values were pulled.
+    /// @note Must be called in a non-coroutine context. Throws if the pipeline ends with a sink.
+    bool pull(OUT& value);
+    
+    /// @brief Same as above but from a coroutine.
+    bool pull(ICoroSync::Ptr sync, OUT& value);
+    
+    /// @brief Waits for the workers of all the stages to complete.
+    /// @note Rethrows the first exception thrown by a stage function. A stage whose function throws closes
+    ///       its queues so that the rest of the pipeline completes.
+    void wait();
+    
+    /// @brief Returns the statistics of every stage, in pipeline order.
+    std::vector<PipelineStageStatistics> stats() const;
+    
+private:
+    Pipeline(std::shared_ptr<PipelineCore> core,
+             typename Channel<IN>::Ptr input,
+             typename Channel<OUT>::Ptr output);
+    
+    template <class NEXT>
+    void launch(std::string name,
+                std::function<bool(ICoroSync::Ptr, OUT&&)> process,
+                size_t parallelism,
+                PipelineStageKind kind,
+                typename Channel<NEXT>::Ptr output) const;
+    
+    //Members
+    std::shared_ptr<PipelineCore>       _core;
+    typename Channel<IN>::Ptr   _input;
+    typename Channel<OUT>::Ptr  _output; //null once a sink was added
+};
+
+}}
+
+#include <quantum/impl/quantum_pipeline_impl.h>
+
+#endif //QUANTUM_PIPELINE_H
@@ -48,6 +48,8 @@ public:
     ICoroFutureBase::Ptr getICoroFutureBase() const final;
     ThreadFuturePtr<T> getIThreadFuture() const;
     CoroFuturePtr<T> getICoroFuture() const;
+    template <class V = T>
+    SharedFuture<NonBufferRetType<V>> getSharedFuture() const;
     
     //ITerminate
     void terminate() final;
@@ -55,6 +57,7 @@ public:
     //IPromiseBase
     bool valid() const final;
     int setException(std::exception_ptr ex) final;
+    bool onSet(std::function<void()> callback) final;
     
     //IThreadPromise
     template <class V, class = NonBufferType<T,V>>
@@ -63,6 +66,12 @@ public:
     template <class V, class = BufferType<T,V>>
     void push(V&& value);
     
+    template <class ITER, class V = T, class = BufferRetType<V>>
+    void pushBatch(ITER first, ITER last);
+    
+    template <class... ARGS, class V = T, class = NonBufferRetType<V>>
+    int emplace(ARGS&&... args);
+    
     //ICoroPromise
     template <class V, class = NonBufferType<T,V>>
     int set(ICoroSync::Ptr sync, V&& value);
@@ -70,15 +79,21 @@ public:
     template <class V, class = BufferType<T,V>>
     void push(ICoroSync::Ptr sync, V&& value);
     
+    template <class ITER, class V = T, class = BufferRetType<V>>
+    void pushBatch(ICoroSync::Ptr sync, ITER first, ITER last);
+    
     template <class V = T, class = BufferRetType<V>>
     int closeBuffer();
     
+    template <class V = T, class = BufferRetType<V>>
+    int setBufferCapacity(size_t capacity);
+    
     //===================================
-    //           NEW / DELETE
+    //           CREATE
     //===================================
-    static void* operator new(size_t size);
-    static void operator delete(void* p);
-    static void deleter(Promise<T>* p);
+    /// @brief Creates a new object. It shares a single pool block with its reference counts.
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
     std::shared_ptr<SharedState<T>> _sharedState;
@@ -17,6 +17,8 @@
 #define QUANTUM_QUEUE_STATISTICS_H
 
 #include <quantum/interface/quantum_iqueue_statistics.h>
+#include <quantum/quantum_spinlock.h>
+#include <atomic>
 
 namespace Bloomberg {
 namespace quantum {
@@ -26,6 +28,9 @@ namespace quantum {
 //==============================================================================================
 /// @class QueueStatistics.
 /// @brief Provides various counters related to queues and task execution.
+/// @details The counters are relaxed atomics grouped by the threads updating them, so that the threads posting to
+///          the queue and the thread running it do not write to the same cache line. The counters can be read while
+///          the queue runs, however the histograms should only be read from a copy of the statistics.
 /// @note See IQueueStatistics for detailed description.
 class QueueStatistics : public IQueueStatistics
 {
@@ -35,9 +40,22 @@ class QueueStatistics : public IQueueStatistics
 public:
     QueueStatistics();
     
+    /// @brief Copy constructor. Takes a snapshot of 'other', see snapshot().
+    QueueStatistics(const QueueStatistics& other);
+    
+    /// @brief Copy assignment. Takes a snapshot of 'other', see snapshot().
+    QueueStatistics& operator=(const QueueStatistics& other);
+    
+    /// @brief Takes a copy of all the counters and histograms while the queue keeps updating them.
+    /// @return The copy.
+    /// @note The completion counters are read before the posting counters so that a task is never seen as completed
+    ///       without being seen as posted.
+    QueueStatistics snapshot() const;
+    
     //===================================
     //         IQUEUESTATISTICS
     //===================================
+    /// @note The number of elements is a gauge and is not reset.
     void reset() final;
     
     size_t numElements() const final;
@@ -70,6 +88,54 @@ public:
     
     void incHighPriorityCount() final;
     
+    size_t stolenCount() const final;
+    
+    void incStolenCount() final;
+    
+    size_t migratedCount() const final;
+    
+    void incMigratedCount() final;
+    
+    size_t expiredCount() const final;
+    
+    void incExpiredCount() final;
+    
+    size_t cancelledCount() const final;
+    
+    void incCancelledCount() final;
+    
+    size_t longSliceCount() const final;
+    
+    void incLongSliceCount() final;
+    
+    size_t resumeCount() const final;
+    
+    void incResumeCount() final;
+    
+    size_t yieldCount() const final;
+    
+    void incYieldCount() final;
+    
+    size_t taskTimeNs() const final;
+    
+    void addTaskTimeNs(size_t value) final;
+    
+    size_t schedulerTimeNs() const final;
+    
+    void addSchedulerTimeNs(size_t value) final;
+    
+    const Histogram& queueWaitTimeNs() const final;
+    
+    void recordQueueWaitTimeNs(uint64_t value) final;
+    
+    const Histogram& runTimeNs() const final;
+    
+    void recordRunTimeNs(uint64_t value) final;
+    
+    const Histogram& numResumes() const final;
+    
+    void recordNumResumes(uint64_t value) final;
+    
     void print(std::ostream& out) const final;
     
     QueueStatistics& operator+=(const IQueueStatistics& rhs);
@@ -78,13 +144,44 @@ public:
                                      const IQueueStatistics& rhs);
 
 private:
-    size_t      _numElements;
-    size_t      _errorCount;
-    size_t      _sharedQueueErrorCount;
-    size_t      _completedCount;
-    size_t      _sharedQueueCompletedCount;
-    size_t      _postedCount;
-    size_t      _highPriorityCount;
+    void copy(const QueueStatistics& other);
+    static void copyCounter(std::atomic_size_t& counter, const std::atomic_size_t& other);
+    
+    // Updated by the threads posting to the queue
+    struct ProducerCounters
+    {
+        char                _padBefore[CacheLinePadding::CacheLineSize];
+        std::atomic_size_t  _postedCount{0};
+        std::atomic_size_t  _highPriorityCount{0};
+        std::atomic_size_t  _enqueuedCount{0};
+        char                _padAfter[CacheLinePadding::CacheLineSize - 3 * sizeof(std::atomic_size_t)];
+    };
+    
+    // Updated by the thread running the queue
+    struct ConsumerCounters
+    {
+        std::atomic_size_t  _dequeuedCount{0};
+        std::atomic_size_t  _errorCount{0};
+        std::atomic_size_t  _sharedQueueErrorCount{0};
+        std::atomic_size_t  _completedCount{0};
+        std::atomic_size_t  _sharedQueueCompletedCount{0};
+        std::atomic_size_t  _stolenCount{0};
+        std::atomic_size_t  _migratedCount{0};
+        std::atomic_size_t  _expiredCount{0};
+        std::atomic_size_t  _cancelledCount{0};
+        std::atomic_size_t  _longSliceCount{0};
+        std::atomic_size_t  _resumeCount{0};
+        std::atomic_size_t  _yieldCount{0};
+        std::atomic_size_t  _taskTimeNs{0};
+        std::atomic_size_t  _schedulerTimeNs{0};
+    };
+    
+    ProducerCounters    _producer;
+    ConsumerCounters    _consumer;
+    mutable SpinLock    _histogramLock; //only contended while a snapshot is taken
+    Histogram           _queueWaitTimeNs;
+    Histogram           _runTimeNs;
+    Histogram           _numResumes;
 };
 
 }}
@@ -0,0 +1,100 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_REACTOR_H
+#define QUANTUM_REACTOR_H
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <quantum/quantum_promise.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Reactor
+//==============================================================================================
+/// @class Reactor
+/// @brief Waits for file descriptor readiness on behalf of coroutines using a single epoll thread.
+/// @details Each wait is registered as a one-shot interest and completed by setting a promise with the
+///          returned event mask. Coroutines waiting on that promise are resumed on their own queue, which means
+///          that a large number of sockets can be serviced without dedicating an IO thread to each of them.
+/// @note For internal use only. See ICoroContext::awaitReadable() and ICoroContext::awaitWritable().
+class Reactor
+{
+public:
+    enum class Direction : int { Read,  ///< Wait until the descriptor is readable
+                                 Write  ///< Wait until the descriptor is writable
+                               };
+    
+    Reactor();
+    
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+    
+    ~Reactor();
+    
+    /// @brief Stops the reactor thread. Pending waits complete with an exception.
+    void terminate();
+    
+    /// @brief Register interest in a file descriptor.
+    /// @param[in] fd The file descriptor. Should be in non-blocking mode.
+    /// @param[in] direction Whether to wait for readability or writability.
+    /// @param[in] promise Set with the epoll event mask once the descriptor is ready.
+    /// @note Only one wait per descriptor and direction can be pending at any time.
+    void await(int fd, Direction direction, PromisePtr<int> promise);
+    
+    /// @brief Remove a pending wait.
+    /// @param[in] fd The file descriptor.
+    /// @param[in] direction The direction of the wait.
+    /// @return True if the wait was removed, false if there was none (e.g. it already completed).
+    /// @note The promise of a removed wait is never set.
+    bool cancel(int fd, Direction direction);
+    
+    /// @brief Number of file descriptors being watched.
+    size_t size() const;
+    
+private:
+    struct Entry
+    {
+        PromisePtr<int>     _reader;
+        PromisePtr<int>     _writer;
+        bool                _isRegistered{false};
+    };
+    
+    void run();
+    void update(int fd, Entry& entry); //must be called with the lock held
+    
+    int                                 _epollFd;
+    int                                 _eventFd; //used to interrupt the reactor thread
+    std::atomic_bool                    _isInterrupted;
+    std::atomic_flag                    _terminated;
+    mutable std::mutex                  _mutex;
+    std::unordered_map<int, Entry>      _entries;
+    std::thread                         _thread;
+};
+
+}}
+
+#include <quantum/impl/quantum_reactor_impl.h>
+
+#endif //__linux__
+
+#endif //QUANTUM_REACTOR_H
@@ -0,0 +1,205 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_READ_WRITE_MUTEX_H
+#define QUANTUM_READ_WRITE_MUTEX_H
+
+#include <array>
+#include <atomic>
+#include <quantum/quantum_mutex.h>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+#include <quantum/quantum_yielding_thread.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class ReadWriteMutex
+//==============================================================================================
+/// @class ReadWriteMutex.
+/// @brief Coroutine-compatible implementation of a reader-writer mutex.
+/// @details Multiple readers may hold the mutex at the same time while writers have exclusive
+///          access. Readers register in one of several cache-line padded slots selected per thread,
+///          so concurrent readers running on different threads do not contend with each other.
+///          Writers are serialized on a quantum::Mutex and wait until all reader slots are drained.
+///          Waiting coroutines yield and waiting threads use a yielding wait.
+class ReadWriteMutex
+{
+public:
+    /// @brief Determines which side wins when readers and writers compete for the mutex.
+    enum class Preference : int
+    {
+        Writers,    ///< A pending writer blocks new readers. Default.
+        Readers     ///< A pending writer backs off while readers are active.
+    };
+    
+    /// @brief Constructor.
+    /// @param[in] preference Writer or reader preference.
+    /// @note Mutex object is in unlocked state.
+    explicit ReadWriteMutex(Preference preference = Preference::Writers);
+    
+    ReadWriteMutex(const ReadWriteMutex& other) = delete;
+    ReadWriteMutex& operator=(const ReadWriteMutex& other) = delete;
+    
+    /// @brief Acquires the mutex for reading.
+    /// @note Must be called in a non-coroutine context.
+    void lockRead();
+    
+    /// @brief Acquires the mutex for reading.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void lockRead(ICoroSync::Ptr sync);
+    
+    /// @brief Tries to acquire the mutex for reading.
+    /// @return True if succeeds, false otherwise.
+    bool tryLockRead();
+    
+    /// @brief Releases a read lock.
+    /// @note Must be called from the same thread or coroutine which acquired the read lock.
+    void unlockRead();
+    
+    /// @brief Acquires the mutex for writing.
+    /// @note Must be called in a non-coroutine context.
+    void lockWrite();
+    
+    /// @brief Acquires the mutex for writing.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void lockWrite(ICoroSync::Ptr sync);
+    
+    /// @brief Tries to acquire the mutex for writing.
+    /// @return True if succeeds, false otherwise.
+    bool tryLockWrite();
+    
+    /// @brief Releases the write lock.
+    void unlockWrite();
+    
+    /// @brief Returns the number of readers currently holding the mutex.
+    /// @return The number of readers.
+    size_t numReaders() const;
+    
+    /// @brief Determines if the mutex is held or being acquired by a writer.
+    /// @return True if a writer is active or pending.
+    bool isWriteLocked() const;
+    
+    //==============================================================================================
+    //                                class ReadWriteMutex::ReadGuard
+    //==============================================================================================
+    /// @class ReadWriteMutex::ReadGuard
+    /// @brief RAII-style mechanism for shared ownership.
+    ///        Acquires a read lock on construction and releases it inside the destructor.
+    class ReadGuard
+    {
+    public:
+        /// @brief Construct this object and read-lock the passed-in mutex.
+        /// @param[in] mutex ReadWriteMutex which protects a scope during the lifetime of the guard.
+        /// @param[in] tryLock If set to true, tries to lock the mutex instead of unconditionally locking it.
+        /// @note This constructor must be used in a non-coroutine context.
+        explicit ReadGuard(ReadWriteMutex& mutex,
+                           bool tryLock = false);
+        
+        /// @brief Construct this object and read-lock the passed-in mutex.
+        /// @param[in] sync Pointer to a coroutine synchronization object.
+        /// @param[in] mutex ReadWriteMutex which protects a scope during the lifetime of the guard.
+        /// @param[in] tryLock If set to true, tries to lock the mutex instead of unconditionally locking it.
+        /// @note This constructor must be used in a coroutine context.
+        ReadGuard(ICoroSync::Ptr sync,
+                  ReadWriteMutex& mutex,
+                  bool tryLock = false);
+        
+        /// @brief Destructor. This will release the read lock.
+        ~ReadGuard();
+        
+        /// @brief Determines if this object owns a read lock.
+        /// @return True if the mutex is read-locked, false otherwise.
+        bool ownsLock() const;
+        
+    private:
+        //Members
+        ReadWriteMutex&     _mutex;
+        bool                _ownsLock;
+    };
+    
+    //==============================================================================================
+    //                                class ReadWriteMutex::WriteGuard
+    //==============================================================================================
+    /// @class ReadWriteMutex::WriteGuard
+    /// @brief RAII-style mechanism for exclusive ownership.
+    ///        Acquires a write lock on construction and releases it inside the destructor.
+    class WriteGuard
+    {
+    public:
+        /// @brief Construct this object and write-lock the passed-in mutex.
+        /// @param[in] mutex ReadWriteMutex which protects a scope during the lifetime of the guard.
+        /// @param[in] tryLock If set to true, tries to lock the mutex instead of unconditionally locking it.
+        /// @note This constructor must be used in a non-coroutine context.
+        explicit WriteGuard(ReadWriteMutex& mutex,
+                            bool tryLock = false);
+        
+        /// @brief Construct this object and write-lock the passed-in mutex.
+        /// @param[in] sync Pointer to a coroutine synchronization object.
+        /// @param[in] mutex ReadWriteMutex which protects a scope during the lifetime of the guard.
+        /// @param[in] tryLock If set to true, tries to lock the mutex instead of unconditionally locking it.
+        /// @note This constructor must be used in a coroutine context.
+        WriteGuard(ICoroSync::Ptr sync,
+                   ReadWriteMutex& mutex,
+                   bool tryLock = false);
+        
+        /// @brief Destructor. This will release the write lock.
+        ~WriteGuard();
+        
+        /// @brief Determines if this object owns the write lock.
+        /// @return True if the mutex is write-locked, false otherwise.
+        bool ownsLock() const;
+        
+    private:
+        //Members
+        ReadWriteMutex&     _mutex;
+        bool                _ownsLock;
+    };
+    
+    static constexpr size_t NumReaderSlots = 16;
+    
+private:
+    //Reader counter occupying its own cache line
+    struct ReaderSlot
+    {
+        std::atomic_size_t  _count{0};
+        char                _padding[CacheLinePadding::CacheLineSize - sizeof(std::atomic_size_t)];
+    };
+    
+    static size_t slotIndex();
+    
+    template <class YIELDING>
+    void lockReadImpl(YIELDING&& yield);
+    
+    template <class YIELDING>
+    void lockWriteImpl(YIELDING&& yield);
+    
+    bool tryAcquireRead(std::atomic_size_t& slot);
+    
+    //Members
+    std::array<ReaderSlot, NumReaderSlots>  _readers;
+    std::atomic_bool                        _isWriterPending;
+    Preference                              _preference;
+    Mutex                                   _writerMutex; //serializes writers
+};
+
+}}
+
+#include <quantum/impl/quantum_read_write_mutex_impl.h>
+
+#endif //QUANTUM_READ_WRITE_MUTEX_H
@@ -0,0 +1,112 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SEMAPHORE_H
+#define QUANTUM_SEMAPHORE_H
+
+#include <atomic>
+#include <quantum/quantum_wait_queue.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Semaphore
+//==============================================================================================
+/// @class Semaphore.
+/// @brief Coroutine-compatible implementation of a counting semaphore.
+/// @details Permits are acquired and released with atomic operations. Callers are only parked when
+///          no permit is available and are woken up as permits are released.
+class Semaphore
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] count The initial number of permits.
+    explicit Semaphore(size_t count = 0);
+    
+    Semaphore(const Semaphore& other) = delete;
+    Semaphore& operator=(const Semaphore& other) = delete;
+    
+    /// @brief Acquires a permit, waiting until one becomes available.
+    /// @note Must be called in a non-coroutine context.
+    void acquire();
+    
+    /// @brief Acquires a permit, waiting until one becomes available.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void acquire(ICoroSync::Ptr sync);
+    
+    /// @brief Tries to acquire a permit without waiting.
+    /// @return True if succeeds, false otherwise.
+    bool tryAcquire();
+    
+    /// @brief Releases permits and wakes up as many waiters.
+    /// @param[in] num The number of permits to release.
+    void release(size_t num = 1);
+    
+    /// @brief Returns the number of available permits.
+    /// @return The number of permits.
+    size_t count() const;
+    
+    //==============================================================================================
+    //                                      class Semaphore::Guard
+    //==============================================================================================
+    /// @class Semaphore::Guard
+    /// @brief RAII-style mechanism for holding a permit.
+    ///        Acquires a permit on construction and releases it inside the destructor.
+    class Guard
+    {
+    public:
+        /// @brief Construct this object and acquire a permit.
+        /// @param[in] semaphore Semaphore from which the permit is acquired.
+        /// @param[in] tryAcquire If set to true, tries to acquire a permit instead of waiting for one.
+        /// @note This constructor must be used in a non-coroutine context.
+        explicit Guard(Semaphore& semaphore,
+                       bool tryAcquire = false);
+        
+        /// @brief Construct this object and acquire a permit.
+        /// @param[in] sync Pointer to a coroutine synchronization object.
+        /// @param[in] semaphore Semaphore from which the permit is acquired.
+        /// @param[in] tryAcquire If set to true, tries to acquire a permit instead of waiting for one.
+        /// @note This constructor must be used in a coroutine context.
+        Guard(ICoroSync::Ptr sync,
+              Semaphore& semaphore,
+              bool tryAcquire = false);
+        
+        /// @brief Destructor. This will release the permit.
+        ~Guard();
+        
+        /// @brief Determines if this object holds a permit.
+        /// @return True if a permit was acquired, false otherwise.
+        bool ownsPermit() const;
+        
+    private:
+        //Members
+        Semaphore&      _semaphore;
+        bool            _ownsPermit;
+    };
+    
+private:
+    //Members
+    std::atomic_size_t  _count;
+    WaitQueue           _waiters;
+};
+
+}}
+
+#include <quantum/impl/quantum_semaphore_impl.h>
+
+#endif //QUANTUM_SEMAPHORE_H
@@ -0,0 +1,101 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SHARED_ALLOCATOR_H
+#define QUANTUM_SHARED_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     struct SharedBlock
+//==============================================================================================
+/// @struct SharedBlock
+/// @brief Pool block large enough to hold an object of type T along with the std::shared_ptr
+///        control block which std::allocate_shared places in front of it.
+/// @tparam T The type of object stored.
+template <typename T>
+struct SharedBlock
+{
+    static constexpr size_t ControlBlockSize = 4 * sizeof(void*);
+    
+    typename std::aligned_storage<sizeof(T) + ControlBlockSize, alignof(std::max_align_t)>::type _storage;
+};
+
+//==============================================================================================
+//                                    struct SharedAllocator
+//==============================================================================================
+/// @struct SharedAllocator
+/// @brief Stateless STL allocator allowing std::allocate_shared to fuse an object and its reference
+///        counts into a single block taken from an object pool.
+/// @tparam T The type to allocate. The standard library rebinds it to its internal control block type.
+/// @tparam POOL Type providing 'static Pool& instance()' for a pool of SharedBlock objects or void to use
+///         the default heap. Types which do not fit in a pool block are allocated from the heap.
+/// @note For internal use only.
+template <typename T, typename POOL = void>
+struct SharedAllocator
+{
+    typedef T value_type;
+    
+    template <typename U>
+    struct rebind
+    {
+        typedef SharedAllocator<U, POOL> other;
+    };
+    
+    SharedAllocator() = default;
+    template <typename U>
+    SharedAllocator(const SharedAllocator<U, POOL>&) {}
+    
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n);
+    
+    template <typename U, typename ... ARGS>
+    void construct(U* p, ARGS&&... args);
+    template <typename U>
+    void destroy(U* p);
+    
+    template <typename U>
+    bool operator==(const SharedAllocator<U, POOL>&) const { return true; }
+    template <typename U>
+    bool operator!=(const SharedAllocator<U, POOL>&) const { return false; }
+    
+private:
+    template <typename P = POOL>
+    static constexpr bool fitsPool(std::enable_if_t<std::is_void<P>::value, int> = 0) { return false; }
+    template <typename P = POOL>
+    static constexpr bool fitsPool(std::enable_if_t<!std::is_void<P>::value, long> = 0);
+    
+    T* allocate(size_t n, std::true_type);
+    T* allocate(size_t n, std::false_type);
+    void deallocate(T* p, size_t n, std::true_type);
+    void deallocate(T* p, size_t n, std::false_type);
+};
+
+/// @brief Creates a shared object whose reference counts live in the same allocation.
+/// @tparam T The type to create. Private constructors must befriend SharedAllocator.
+/// @tparam POOL See SharedAllocator.
+template <typename T, typename POOL = void, typename ... ARGS>
+std::shared_ptr<T> allocateShared(ARGS&&... args);
+
+}}
+
+#include <quantum/impl/quantum_shared_allocator_impl.h>
+
+#endif //QUANTUM_SHARED_ALLOCATOR_H
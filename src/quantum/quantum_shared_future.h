@@ -0,0 +1,110 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SHARED_FUTURE_H
+#define QUANTUM_SHARED_FUTURE_H
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <quantum/quantum_shared_state.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+template <class T>
+class Promise;
+
+template <class T>
+class Future;
+
+//==============================================================================================
+//                                   class SharedFuture
+//==============================================================================================
+/// @class SharedFuture
+/// @brief Read-only view of a promised value which any number of consumers may read without copying it.
+/// @details Contrary to Future::get(), get() never moves the value out of the shared state: every consumer
+///          receives a const reference to the same object, which stays alive for as long as any copy of this
+///          class does. Copies are cheap and can be handed to other threads or coroutines.
+/// @tparam T Type of the promised value. Buffered futures cannot be shared.
+/// @note Obtained via Promise::getSharedFuture() or share() on a future or a context.
+/// @warning Calling get() on another future of the same promise moves the value out from under the readers.
+///          Once a result is shared, read it with getRef() or through a SharedFuture only.
+template <class T>
+class SharedFuture
+{
+    template <class F> friend class Promise;
+    template <class F> friend class Future;
+public:
+    //Default constructor with empty state
+    SharedFuture() = default;
+    
+    /// @brief Determines if this object has a shared state.
+    /// @return True if valid.
+    bool valid() const;
+    
+    /// @brief Waits for the value to be ready.
+    /// @note Blocks the calling thread.
+    void wait() const;
+    
+    /// @brief Waits for the value to be ready for a maximum of 'timeMs' milliseconds.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait.
+    /// @return 'ready' if the value was set before the duration expired or 'timeout' otherwise.
+    std::future_status waitFor(std::chrono::milliseconds timeMs) const;
+    
+    /// @brief Waits for the value to be ready.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @note Yields the coroutine instead of blocking its thread.
+    void wait(ICoroSync::Ptr sync) const;
+    
+    /// @brief Waits for the value to be ready for a maximum of 'timeMs' milliseconds.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait.
+    /// @return 'ready' if the value was set before the duration expired or 'timeout' otherwise.
+    std::future_status waitFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs) const;
+    
+    /// @brief Get a reference to the value.
+    /// @return A reference to the value, valid for as long as this object or any of its copies.
+    /// @note Blocks until the value is ready. Throws the exception set on the promise, if any. May be called
+    ///       any number of times from any number of consumers.
+    const T& get() const;
+    
+    /// @brief Get a reference to the value.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @return A reference to the value, valid for as long as this object or any of its copies.
+    /// @note Yields until the value is ready. Throws the exception set on the promise, if any.
+    const T& get(ICoroSync::Ptr sync) const;
+    
+    /// @brief Invokes a callback once the value is ready.
+    /// @param[in] callback Callable with signature void(). It's invoked inline from the thread or coroutine which
+    ///            satisfies the promise, or immediately if the value is already available.
+    /// @note The callback must not block nor throw.
+    template <class FUNC>
+    void onReady(FUNC&& callback) const;
+    
+private:
+    static_assert(!Traits::IsBuffer<T>::value, "Buffered futures cannot be shared");
+    
+    explicit SharedFuture(std::shared_ptr<SharedState<T>> sharedState);
+    
+    //Members
+    std::shared_ptr<SharedState<T>>     _sharedState;
+};
+
+}}
+
+#include <quantum/impl/quantum_shared_future_impl.h>
+
+#endif //QUANTUM_SHARED_FUTURE_H
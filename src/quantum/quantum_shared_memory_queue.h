@@ -0,0 +1,177 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SHARED_MEMORY_QUEUE_H
+#define QUANTUM_SHARED_MEMORY_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                  class SharedMemoryQueue
+//==============================================================================================
+/// @class SharedMemoryQueue
+/// @brief Bounded lock-free multi-producer multi-consumer FIFO living in a named POSIX shared memory segment,
+///        through which cooperating processes on the same host hand work to each other.
+/// @details A message is a function id plus a payload of at most 'maxPayloadSize' bytes, copied into a fixed-size
+///          slot of the ring. Any process which mapped the segment may post messages, and every process which set
+///          the queue via Configuration::setSharedMemoryQueue() consumes them from its IO threads whenever they run
+///          out of local work. The consumer copies the message out of the ring and calls the handler registered in
+///          its own process for that function id. The ring uses the same per-slot sequence protocol as MpmcRing,
+///          so producers and consumers only contend on a single compare-and-swap.
+/// @warning A process dying between claiming and publishing a slot stalls the ring at that slot, and so does a
+///          message for which no consumer registered a handler. Payloads are copied bitwise: they must not
+///          contain pointers.
+/// @note Only supported on Linux. On older glibc versions the application must link with -lrt.
+class SharedMemoryQueue
+{
+public:
+    using Ptr = std::shared_ptr<SharedMemoryQueue>;
+    /// @brief Function called with the payload of a message. Returns 0 on success like an IO task.
+    using Handler = std::function<int(const char* payload, size_t size)>;
+    
+    /// @brief A message copied out of the ring.
+    struct Message
+    {
+        uint32_t            _functionId{0};
+        std::vector<char>   _payload;
+    };
+    
+    /// @brief Maps the segment 'name', creating it if it doesn't exist yet.
+    /// @param[in] name Name of the segment, e.g. "/myapp.work". See shm_open().
+    /// @param[in] capacity The maximum number of messages. Rounded up to the next power of two.
+    /// @param[in] maxPayloadSize The maximum size of a payload in bytes.
+    /// @param[in] mode Permissions of the segment if created.
+    /// @note If the segment already exists, it must have been created with the same capacity and payload size.
+    ///       Throws std::system_error if the segment cannot be mapped and std::runtime_error if its layout differs.
+    SharedMemoryQueue(const std::string& name,
+                      size_t capacity,
+                      size_t maxPayloadSize,
+                      int mode = 0600);
+    
+    SharedMemoryQueue(const SharedMemoryQueue&) = delete;
+    SharedMemoryQueue& operator=(const SharedMemoryQueue&) = delete;
+    
+    /// @brief Unmaps the segment. The segment itself persists until remove() is called.
+    ~SharedMemoryQueue();
+    
+    /// @brief Deletes a segment by name. Processes which mapped it keep using it until they unmap it.
+    /// @param[in] name Name of the segment.
+    /// @return True if the segment was removed, false if it did not exist.
+    static bool remove(const std::string& name);
+    
+    /// @brief Registers the function handling the messages with a given id in this process.
+    /// @param[in] functionId The id used by the posting processes.
+    /// @param[in] handler The function.
+    /// @warning Not thread safe. Register all the handlers before passing the queue to a Dispatcher.
+    void registerHandler(uint32_t functionId, Handler handler);
+    
+    /// @brief Copies a message into the ring.
+    /// @param[in] functionId Identifies the handler in the consuming process.
+    /// @param[in] payload The payload.
+    /// @param[in] size The size of the payload. Throws std::invalid_argument if larger than maxPayloadSize().
+    /// @return True if successful, false if the ring is full.
+    bool tryPost(uint32_t functionId, const void* payload, size_t size);
+    
+    /// @brief Removes the message at the front of the ring.
+    /// @param[out] message The removed message. Its payload buffer is reused.
+    /// @return True if successful, false if the ring is empty or if no handler is registered in this process
+    ///         for the message at the front, which is then left in the ring for another consumer.
+    /// @note Messages whose size exceeds maxPayloadSize() are discarded and counted in numRejected().
+    bool tryPop(Message& message);
+    
+    /// @brief Calls the handler registered for a message.
+    /// @param[in] message The message.
+    /// @return The value returned by the handler or ITask::RetCode::NotCallable if no handler is registered.
+    int run(const Message& message) const;
+    
+    /// @brief Number of messages in the ring.
+    /// @return The size.
+    /// @note The value is only an approximation if other threads or processes are posting or consuming.
+    size_t size() const;
+    
+    /// @brief Number of messages discarded by tryPop() because their size exceeded the payload capacity.
+    /// @return The count for this process.
+    size_t numRejected() const;
+    
+    /// @brief The maximum number of messages.
+    /// @return The capacity.
+    size_t capacity() const;
+    
+    /// @brief The maximum size of a payload.
+    /// @return The size in bytes.
+    size_t maxPayloadSize() const;
+    
+    /// @brief The name of the segment.
+    /// @return The name.
+    const std::string& name() const;
+    
+private:
+    static constexpr size_t CacheLineSize = 64;
+    static constexpr uint32_t Magic = 0x514D5351; //'QMSQ'
+    static constexpr uint32_t Version = 1;
+    
+    struct Header
+    {
+        std::atomic<uint32_t>   _magic; //set last by the creator once the ring is initialized
+        uint32_t                _version;
+        uint64_t                _mask;
+        uint64_t                _slotSize;
+        uint64_t                _maxPayloadSize;
+        alignas(CacheLineSize) std::atomic<uint64_t>    _pushPos;
+        alignas(CacheLineSize) std::atomic<uint64_t>    _popPos;
+    };
+    
+    struct Slot
+    {
+        std::atomic<uint64_t>   _sequence;
+        uint32_t                _functionId;
+        uint32_t                _size;
+        //payload follows
+    };
+    
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory rings require lock-free 64-bit atomics");
+    
+    static size_t roundUp(size_t capacity);
+    static size_t slotSize(size_t maxPayloadSize);
+    static size_t segmentSize(size_t capacity, size_t maxPayloadSize);
+    void initialize(size_t capacity, size_t maxPayloadSize);
+    void validate(size_t capacity, size_t maxPayloadSize) const;
+    Slot& slot(uint64_t pos) const;
+    char* payload(Slot& slot) const;
+    
+    std::string                             _name;
+    size_t                                  _segmentSize{0};
+    Header*                                 _header{nullptr};
+    char*                                   _slots{nullptr};
+    std::unordered_map<uint32_t, Handler>   _handlers;
+    std::atomic<size_t>                     _numRejected{0};
+};
+
+}}
+
+#include <quantum/impl/quantum_shared_memory_queue_impl.h>
+
+#endif //QUANTUM_SHARED_MEMORY_QUEUE_H
@@ -17,13 +17,19 @@
 #define QUANTUM_SHARED_STATE_MUTEX_H
 
 #include <memory>
+#include <atomic>
 #include <exception>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
 #include <quantum/quantum_traits.h>
 #include <quantum/quantum_future_state.h>
 #include <quantum/quantum_yielding_thread.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/quantum_condition_variable.h>
 #include <quantum/quantum_buffer.h>
+#include <quantum/quantum_tracer.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -38,14 +44,21 @@ template <class T>
 class SharedState
 {
     friend class Promise<T>;
+    template <class U, class POOL> friend struct SharedAllocator;
     
 public:
+    ~SharedState();
+    
     template <class V = T>
     int set(V&& value);
     
     template <class V = T>
     int set(ICoroSync::Ptr sync, V&& value);
     
+    //Constructs the value in place
+    template <class... ARGS>
+    int emplace(ARGS&&... args);
+    
     //Moves value out of the shared state
     T get();
     
@@ -55,6 +68,12 @@ public:
     
     const T& getRef(ICoroSync::Ptr sync) const;
     
+    //Moves value out of the shared state if it becomes ready within 'time'. Returns false on timeout.
+    template<class REP, class PERIOD>
+    bool getFor(ICoroSync::Ptr sync,
+                const std::chrono::duration<REP, PERIOD> &time,
+                T& value);
+    
     void breakPromise();
     
     void wait() const;
@@ -72,23 +91,64 @@ public:
     
     int setException(ICoroSync::Ptr sync,
                      std::exception_ptr ex);
+    
+    //Invokes the callback once the state is ready, either immediately or from the thread which satisfies it
+    void onReady(std::function<void()> callback);
+    
+    //Invokes the callback from the thread which satisfies the state, before readers can observe it.
+    //Must be registered before the state can be satisfied.
+    bool onSet(std::function<void()> callback);
+    
 private:
+    //The low bits hold the phase of the value. HasWaiters is set by readers before blocking and when
+    //callbacks are registered, so that satisfying the promise only takes the slow path when someone
+    //needs to be notified.
+    enum Status : int
+    {
+        Pending = 0,     //promise not satisfied
+        Setting = 1,     //claimed by the thread satisfying the promise
+        Ready = 2,       //value, exception or broken promise published
+        PhaseMask = 3,
+        HasWaiters = 4
+    };
+    
     SharedState();
     
+    bool claim();
+    
+    void publish();
+    
+    void publish(ICoroSync::Ptr sync);
+    
+    static void invokeCallback(const std::function<void()>& callback);
+    
+    bool isReady() const;
+    
+    template <class... ARGS>
+    void construct(ARGS&&... args);
+    
+    T& value();
+    
+    const T& value() const;
+    
+    T retrieve();
+    
     void conditionWait() const;
     
     void conditionWait(ICoroSync::Ptr sync) const;
     
     void checkPromiseState() const;
     
-    bool stateHasChanged() const;
-    
     // ============================= MEMBERS ==============================
     mutable ConditionVariable       _cond;
     mutable Mutex                   _mutex;
-    FutureState                     _state;
+    mutable std::atomic_int         _status;
+    std::atomic<FutureState>        _state;
     std::exception_ptr              _exception;
-    T                               _value;
+    std::aligned_storage_t<sizeof(T), alignof(T)> _storage; //constructed only when the promise is set
+    bool                            _hasValue;
+    std::vector<std::function<void()>> _callbacks; //protected by _mutex
+    std::function<void()>           _onSet; //only accessed before the state is claimed and by the claiming thread
 };
 
 //==============================================================================================
@@ -98,6 +158,7 @@ template <class T>
 class SharedState<Buffer<T>>
 {
     friend class Promise<Buffer<T>>;
+    template <class U, class POOL> friend struct SharedAllocator;
     
 public:
     template <class V = T>
@@ -110,6 +171,18 @@ public:
     
     T pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
+    //Pushes all the values, waiting only if a bounded buffer fills up
+    template <class ITER>
+    void pushBatch(ITER first, ITER last);
+    
+    template <class ITER>
+    void pushBatch(ICoroSync::Ptr sync, ITER first, ITER last);
+    
+    //Pulls up to maxItems values which are already available, waiting only if there are none
+    std::vector<T> pullBatch(size_t maxItems, bool& isBufferClosed);
+    
+    std::vector<T> pullBatch(ICoroSync::Ptr sync, size_t maxItems, bool& isBufferClosed);
+    
     void breakPromise();
     
     void wait() const;
@@ -129,6 +202,12 @@ public:
                      std::exception_ptr ex);
     
     int closeBuffer();
+    
+    int setCapacity(size_t capacity);
+    
+    //Not supported since a buffer is satisfied incrementally
+    bool onSet(std::function<void()> callback);
+    
 private:
     SharedState();
     
@@ -136,6 +215,19 @@ private:
     
     bool stateHasChanged(BufferStatus status) const;
     
+    bool canPush() const;
+    
+    bool transfer(); //moves the writer buffer to the reader
+    
+    void waitForData();
+    
+    void waitForData(ICoroSync::Ptr sync);
+    
+    template <class ITER>
+    ITER pushAvailable(ITER first, ITER last);
+    
+    std::vector<T> pullAvailable(size_t maxItems, bool& isBufferClosed);
+    
     // ============================= MEMBERS ==============================
     mutable ConditionVariable       _cond;
     mutable Mutex                   _mutex;
@@ -0,0 +1,100 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SMALL_VECTOR_H
+#define QUANTUM_SMALL_VECTOR_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     class SmallVector
+//==============================================================================================
+/// @class SmallVector
+/// @brief Contiguous sequence which stores its first N elements inline and only moves them to the heap
+///        once it grows beyond that.
+/// @tparam T The element type. Must be nothrow move constructible.
+/// @tparam N The number of elements stored inline.
+/// @note For internal use only.
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(N > 0, "Inline capacity must be positive");
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    
+    SmallVector() = default;
+    
+    /// @brief Constructs 'count' copies of 'value'.
+    SmallVector(size_t count, const T& value);
+    
+    SmallVector(const SmallVector& other);
+    SmallVector(SmallVector&& other);
+    SmallVector& operator=(const SmallVector& other);
+    SmallVector& operator=(SmallVector&& other);
+    ~SmallVector();
+    
+    /// @brief Constructs an element in place at the back.
+    template <typename ... ARGS>
+    T& emplace_back(ARGS&&... args);
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void pop_back();
+    void clear();
+    
+    /// @brief Makes room for at least 'capacity' elements.
+    void reserve(size_t capacity);
+    
+    T& operator[](size_t index) { return _data[index]; }
+    const T& operator[](size_t index) const { return _data[index]; }
+    T& back() { return _data[_size-1]; }
+    const T& back() const { return _data[_size-1]; }
+    T& front() { return _data[0]; }
+    const T& front() const { return _data[0]; }
+    
+    iterator begin() { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+    
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+    bool empty() const { return _size == 0; }
+    
+    /// @brief Check if the elements are stored in the inline buffer.
+    bool isInline() const { return _data == inlineData(); }
+    
+private:
+    T* inlineData() { return reinterpret_cast<T*>(&_inline); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(&_inline); }
+    void grow(size_t capacity);
+    
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type  _inline;
+    T*          _data{inlineData()};
+    size_t      _size{0};
+    size_t      _capacity{N};
+};
+
+}}
+
+#include <quantum/impl/quantum_small_vector_impl.h>
+
+#endif //QUANTUM_SMALL_VECTOR_H
@@ -18,6 +18,7 @@
 
 #include <atomic>
 #include <mutex>
+#include <quantum/quantum_lock_profiler.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -28,6 +29,11 @@ namespace quantum {
 /// @class SpinLock
 /// @brief Coroutine-compatible spinlock. Used internally for mutexes since threads running
 ///        coroutines cannot block.
+/// @details Test-and-test-and-set lock. Waiters spin on a plain load, which keeps the cache line shared
+///          until the owner releases it, and back off exponentially with a CPU pause hint. Once the bounded
+///          backoff is exhausted, the waiting thread yields its time slice on every retry.
+///          When __QUANTUM_PROFILE_LOCKS is defined, the acquisitions of the spinlocks constructed with a
+///          LockSite are counted under that site, see LockProfiler.
 class SpinLock
 {
 public:
@@ -36,6 +42,10 @@ public:
     /// @brief Constructor. The object is in the unlocked state.
     SpinLock();
     
+    /// @brief Constructor. The object is in the unlocked state.
+    /// @param[in] site Site under which the contention on this spinlock is reported.
+    explicit SpinLock(const LockSite& site);
+    
     /// @brief Copy constructor.
     SpinLock(const SpinLock&) = delete;
     
@@ -122,7 +132,39 @@ public:
     };
     
 private:
-    std::atomic_flag 	_flag;
+    static constexpr size_t MaxBackoff = 1024; //maximum number of pause instructions between two loads
+    
+    static void pause();
+    void profile(bool isContended, size_t spins, size_t yields) const;
+    
+    std::atomic_bool 	_flag;
+#ifdef __QUANTUM_PROFILE_LOCKS
+    const LockSite*     _site;
+#endif
+};
+
+/// @brief Leading padding of PaddedSpinLock.
+struct CacheLinePadding
+{
+    static constexpr size_t CacheLineSize = 64;
+    char _padBefore[CacheLineSize];
+};
+
+//==============================================================================================
+//                                 class PaddedSpinLock
+//==============================================================================================
+/// @class PaddedSpinLock
+/// @brief SpinLock occupying a cache line of its own so that spinning on it does not interfere with
+///        the neighbouring members of the owning object.
+/// @note Used for the locks of the task queues and the allocators. Can be used anywhere a SpinLock is expected.
+class PaddedSpinLock : private CacheLinePadding, public SpinLock
+{
+public:
+    PaddedSpinLock() = default;
+    explicit PaddedSpinLock(const LockSite& site) : SpinLock(site) {}
+    
+private:
+    char _padAfter[CacheLineSize - sizeof(SpinLock)];
 };
 
 }}
@@ -26,7 +26,7 @@ namespace quantum {
 //==============================================================================================
 /// @struct StackTraits.
 /// @brief Allows application-wide overrides for the coroutine stack traits which are used
-///        internally by boost::coroutines2.
+///        internally by boost::coroutines2 or FiberCoroutine.
 /// @note See boost::context::stack_traits for details. Typically only the default size should be modified.
 struct StackTraits {
     /// @brief Get/set if the environment defines a limit for the stack size.
@@ -26,6 +26,9 @@
 #include <quantum/interface/quantum_itask_continuation.h>
 #include <quantum/interface/quantum_itask_accessor.h>
 #include <quantum/quantum_traits.h>
+#include <quantum/quantum_cancellation_token.h>
+#include <quantum/quantum_coroutine_state.h>
+#include <quantum/quantum_task_registry.h>
 #include <quantum/util/quantum_util.h>
 
 namespace Bloomberg {
@@ -40,9 +43,13 @@ namespace quantum {
 class Task : public ITaskContinuation,
              public std::enable_shared_from_this<Task>
 {
+    friend class TaskQueue;
+    
 public:
     using Ptr = std::shared_ptr<Task>;
     using WeakPtr = std::weak_ptr<Task>;
+    //Run and parked lists of the coroutine queues
+    using List = std::list<Ptr, std::allocator_traits<QueueListAllocator>::rebind_alloc<Ptr>>;
     
     template <class RET, class FUNC, class ... ARGS>
     Task(std::shared_ptr<Context<RET>> ctx,
@@ -53,7 +60,7 @@ public:
     template <class RET, class FUNC, class ... ARGS>
     Task(std::shared_ptr<Context<RET>> ctx,
          int queueId,
-         bool isHighPriority,
+         int priority,
          ITask::Type type,
          FUNC&& func,
          ARGS&&... args);
@@ -76,6 +83,22 @@ public:
     bool isBlocked() const final;
     bool isSleeping(bool updateTimer = false) final;
     bool isHighPriority() const final;
+    int getPriority() const final;
+    
+    //Returns true if this task was posted to any queue and has not started running yet,
+    //in which case it can be safely moved to another queue.
+    bool isStealable() const;
+    
+    //Returns the time when a sleeping task is due to wake up.
+    std::chrono::high_resolution_clock::time_point getSleepDeadline() const;
+    
+    //Deadline used by the earliest-deadline-first scheduling policy. Default is time_point::max().
+    void setDeadline(std::chrono::high_resolution_clock::time_point deadline);
+    std::chrono::high_resolution_clock::time_point getDeadline() const;
+    
+    //Token checked by the queue before the task starts. A cancelled task is dropped without running.
+    void setCancellationToken(CancellationToken::Ptr token);
+    const CancellationToken::Ptr& getCancellationToken() const;
     
     //ITaskContinuation
     ITaskContinuation::Ptr getNextTask() final;
@@ -89,22 +112,43 @@ public:
     ITaskContinuation::Ptr getErrorHandlerOrFinalTask() final;
     
     //===================================
-    //           NEW / DELETE
+    //           CREATE
     //===================================
-    static void* operator new(size_t size);
-    static void operator delete(void* p);
-    static void deleter(Task* p);
+    /// @brief Creates a new object. It shares a single pool block with its reference counts.
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
+    
+    //Returns the coroutine stack allocator for the given stack size. Sizes are rounded up to the next
+    //power of two and each size class has its own pool. 0 selects the default stack size.
+    static CoroStackAllocator& stackAllocator(size_t stackSize);
     
 private:
     ITaskAccessor::Ptr          _ctx; //holds execution context
+#ifdef __QUANTUM_STATIC_DISPATCH
+    CoroutineState*             _state; //same object as _ctx, read without virtual calls
+#endif
     Traits::Coroutine           _coro; //the current runnable coroutine
     int                         _queueId;
-    bool                        _isHighPriority;
+    int                         _priority;
+    bool                        _isPinned; //task was posted to a specific queue
+    bool                        _isStarted;
+    std::atomic_bool            _isParked; //task sits in the parked list of its queue
+    List::iterator              _parkedIt; //position in the parked list
+    Ptr                         _intakeSelf; //keeps the task alive while in the intake stack of its queue
+    Task*                       _intakeNext; //next task in the intake stack
+    std::chrono::high_resolution_clock::time_point _deadline; //latest time the result is still useful
+    CancellationToken::Ptr      _cancellationToken; //null if the task cannot be cancelled
+    std::atomic<int64_t>        _readySinceNs; //when the task last became runnable or 0 if blocked. Only set when monitoring slices
+    std::chrono::high_resolution_clock::time_point _postTimestamp; //only set when collecting latency histograms
+    std::chrono::nanoseconds    _runTime; //accumulated over all resumes
+    size_t                      _numResumes;
     int                         _rc; //return from the co-routine
     ITaskContinuation::Ptr      _next; //Task scheduled to run after current completes.
     ITaskContinuation::WeakPtr  _prev; //Previous task in the chain
     ITask::Type                 _type;
     std::atomic_flag            _terminated;
+    const char*                 _tag; //see CoroStackTag
+    TaskRegistry::EntryPtr      _registryEntry; //only set when tasks are tracked
 };
 
 using TaskPtr = Task::Ptr;
@@ -0,0 +1,148 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TASK_GROUP_H
+#define QUANTUM_TASK_GROUP_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <quantum/quantum_context.h>
+#include <quantum/quantum_cancellation_token.h>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_wait_queue.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class TaskGroup
+//==============================================================================================
+/// @class TaskGroup.
+/// @brief Scope owning the coroutines and IO tasks spawned by a parent coroutine.
+/// @details Children are posted through the group onto any queue and are tracked by a single atomic counter.
+///          Waiting on the group parks the parent until the counter drops to zero, so it is woken up once by
+///          the last child instead of once per child. The first child which throws cancels the group: the
+///          remaining children which have not started complete with a CancellationException without running
+///          and the running ones get it thrown at their next yield(). The destructor waits for all children
+///          so none of them outlives the scope of the group.
+/// @note A TaskGroup must be created and waited on from the same coroutine. It is not thread safe.
+class TaskGroup
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] ctx The context of the parent coroutine.
+    template <class RET>
+    explicit TaskGroup(std::shared_ptr<ICoroContext<RET>> ctx);
+    
+    TaskGroup(const TaskGroup& other) = delete;
+    TaskGroup& operator=(const TaskGroup& other) = delete;
+    
+    /// @brief Destructor. Waits for all the children to complete without throwing.
+    ~TaskGroup();
+    
+    /// @brief Post a child coroutine.
+    /// @tparam OTHER_RET Type of future returned by the child.
+    /// @param[in] func Callable object with signature 'int f(CoroContextPtr<OTHER_RET>, ...)'.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to the context of the child. Its value can be read as usual.
+    /// @note Coroutines posted by the child inherit the cancellation token of the group.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroContextPtr<OTHER_RET>
+    post(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as post() above but runs on a specific queue.
+    /// @param[in] queueId Id of the queue where the child should run. Can be IQueue::QueueId::Same to run on the
+    ///                    queue of the parent or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the child will be scheduled to run immediately after the currently
+    ///                           executing coroutine.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroContextPtr<OTHER_RET>
+    post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a child IO task.
+    /// @tparam OTHER_RET Type of future returned by the child.
+    /// @param[in] func Callable object with signature 'int f(ThreadPromisePtr<OTHER_RET>, ...)'.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to the future of the child.
+    /// @note A running IO task is not interrupted when the group is cancelled.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIo(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postAsyncIo() above but runs on a specific IO queue or IQueue::QueueId::Any.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Waits for all the children posted so far to complete.
+    /// @note Rethrows the exception of the first child which failed, if any. Children cancelled via cancel()
+    ///       do not count as failures.
+    void wait();
+    
+    /// @brief Cancels all the children which have not completed yet.
+    void cancel();
+    
+    /// @brief Checks if the group was cancelled, either explicitly or because a child failed.
+    /// @return True if cancelled.
+    bool isCancelled() const;
+    
+    /// @brief Returns the number of children which have not completed yet.
+    /// @return The number of children.
+    size_t size() const;
+    
+private:
+    struct State
+    {
+        void fail(std::exception_ptr ex);
+        void complete();
+        
+        std::atomic_size_t      _numPending{0};
+        WaitQueue               _waiters;
+        SpinLock                _lock; //protects the exception
+        std::exception_ptr      _exception; //first failure
+        CancellationToken::Ptr  _token{CancellationToken::create()};
+    };
+    
+    template <class OTHER_RET, class CAPTURE>
+    struct CoroChild
+    {
+        int operator()(CoroContextPtr<OTHER_RET> ctx);
+        
+        std::shared_ptr<State>  _state;
+        CAPTURE                 _capture;
+    };
+    
+    template <class OTHER_RET, class CAPTURE>
+    struct IoChild
+    {
+        int operator()(ThreadPromisePtr<OTHER_RET> promise);
+        
+        std::shared_ptr<State>  _state;
+        CAPTURE                 _capture;
+    };
+    
+    //Members
+    ICoroSync::Ptr          _sync; //the parent coroutine
+    DispatcherCore*         _dispatcher;
+    int                     _queueId; //queue of the parent coroutine
+    std::shared_ptr<State>  _state; //shared with the children which may still be running
+};
+
+}}
+
+#include <quantum/impl/quantum_task_group_impl.h>
+
+#endif //QUANTUM_TASK_GROUP_H
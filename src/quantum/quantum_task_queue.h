@@ -17,6 +17,9 @@
 #define QUANTUM_TASK_QUEUE_H
 
 #include <list>
+#include <vector>
+#include <queue>
+#include <chrono>
 #include <atomic>
 #include <functional>
 #include <algorithm>
@@ -32,6 +35,9 @@
 #include <quantum/quantum_yielding_thread.h>
 #include <quantum/quantum_queue_statistics.h>
 #include <quantum/quantum_configuration.h>
+#include <quantum/quantum_idle_signal.h>
+#include <quantum/quantum_numa_topology.h>
+#include <quantum/quantum_tracer.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -45,7 +51,7 @@ namespace quantum {
 class TaskQueue : public IQueue
 {
 public:
-    using TaskList = std::list<Task::Ptr, QueueListAllocator>;
+    using TaskList = Task::List;
     using TaskListIter = TaskList::iterator;
     
     TaskQueue();
@@ -60,12 +66,16 @@ public:
     
     void pinToCore(int coreId) final;
     
+    void pinToCpus(const NumaTopology::CpuSet& cpus);
+    
     void run() final;
     
     void enqueue(ITask::Ptr task) final;
     
     bool tryEnqueue(ITask::Ptr task) final;
     
+    void enqueue(std::vector<Task::Ptr>& tasks);
+    
     ITask::Ptr dequeue(std::atomic_bool& hint) final;
     
     ITask::Ptr tryDequeue(std::atomic_bool& hint) final;
@@ -83,17 +93,86 @@ public:
     void signalEmptyCondition(bool value) final;
     
     bool isIdle() const final;
+    
+    void setSiblingQueues(std::vector<TaskQueue>* coroQueues);
+    
+    //Signalled each time this queue runs out of work. Must be set before any task is enqueued.
+    void setIdleSignal(IdleSignal* signal);
+    
+    //Counts the coroutines held by all the queues sharing 'counter'. Must be set before any task is enqueued.
+    void setPendingTaskCounter(std::atomic<size_t>* counter);
+    
+    void wakeUp(Task::Ptr task);
+    
+    void setQueueId(int queueId);
+    
+    //A retired queue stops stealing work. Tasks can still be posted to it explicitly.
+    void setRetired(bool value);
+    
+    //Returns the queue whose thread is the calling thread or nullptr if not called from a coroutine thread.
+    static const TaskQueue* getCurrentQueue();
+    
+    //Moves all the coroutines which have not started and are not pinned to this queue into 'tasks'.
+    void migrate(std::vector<Task::Ptr>& tasks);
+    
+    //Returns how long the oldest runnable coroutine has been waiting to run. Only tracked when
+    //a long slice threshold is configured.
+    std::chrono::microseconds oldestRunnableWaitTime() const;
+    
+    //Appends the description of the live coroutines posted to this queue. Only tracked when enabled
+    //via Configuration::setTrackTasks().
+    void snapshotTasks(std::vector<TaskInfo>& tasks) const;
 
 private:
+    using TimePoint = std::chrono::high_resolution_clock::time_point;
+    
+    struct Timer
+    {
+        bool operator>(const Timer& other) const { return _deadline > other._deadline; }
+        
+        TimePoint       _deadline;
+        Task::WeakPtr   _task;
+    };
+    using TimerQueue = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>;
+    
     TaskListIter advance();
-    void doEnqueue(ITask::Ptr task);
+    void startPass();
+    bool hasCredit(const Task& task);
+    void push(Task::Ptr task);
+    void push(Task* first, Task* last, size_t num);
+    void drainIntake();
+    void incPendingCount(size_t num);
+    void decPendingCount(size_t num);
+    void doEnqueue(Task::Ptr task);
     ITask::Ptr doDequeue(std::atomic_bool& hint);
+    bool park();
+    void doWakeUp(const Task::Ptr& task);
+    bool migrateWokenUp(const Task::Ptr& task);
+    bool isParkedHere(const Task& task) const;
+    TaskListIter getInsertPosition(const Task& task);
+    bool dropExpired(Task& task);
+    bool dropCancelled(Task& task);
+    void checkSlice(Task& task, TimePoint runStart, TimePoint runEnd);
+    void addSchedulerTime(TimePoint now);
+    void track(Task& task);
+    static int64_t toNs(TimePoint time);
+    static const TaskQueue*& currentQueue();
+    void expireTimers();
+    TimePoint nextTimerDeadline() const;
+    void idle();
+    bool steal();
+    size_t doStealFrom(TaskQueue& victim, std::vector<Task::Ptr>& stolen);
+    bool inlineContinuation(ITaskContinuation::Ptr nextTask);
     
     std::shared_ptr<std::thread>        _thread;
     TaskList                            _queue;
+    TaskList                            _parkedQueue; //blocked coroutines waiting to be signalled
+    TimerQueue                          _timers; //wake-up times of the parked sleeping coroutines
+    std::atomic<Task*>                  _intakeHead; //lock-free stack of newly posted tasks
+    std::atomic<size_t>                 _intakeSize;
     TaskListIter                        _queueIt;
     TaskListIter                        _blockedIt;
-    mutable SpinLock                    _spinlock;
+    mutable PaddedSpinLock              _spinlock;
     std::mutex                          _notEmptyMutex; //for accessing the condition variable
     std::condition_variable             _notEmptyCond;
     std::atomic_bool                    _isEmpty;
@@ -102,6 +181,35 @@ private:
     std::atomic_flag                    _terminated;
     bool                                _isAdvanced;
     QueueStatistics                     _stats;
+    bool                                _isParkingEnabled;
+    bool                                _isWorkStealing;
+    std::chrono::microseconds           _workStealingPollIntervalUs;
+    size_t                              _migrationThreshold; //0 if woken up coroutines never migrate
+    std::atomic<std::vector<TaskQueue>*> _siblingQueues; //set once all the queues are constructed
+    std::atomic<IdleSignal*>            _idleSignal; //set once all the queues are constructed
+    std::atomic<std::atomic<size_t>*>   _pendingTaskCounter; //null unless the dispatcher limits pending coroutines
+    int                                 _idleSpinCount;
+    int                                 _idleYieldCount;
+    int                                 _idleCount; //consecutive rounds without any runnable coroutine
+    TimePoint                           _idleDeadline; //earliest wake-up time of the sleeping coroutines
+    size_t                              _idleWakeUpCount; //value of _wakeUpCount when the round started
+    std::atomic<size_t>                 _wakeUpCount; //number of times a coroutine got signalled
+    std::atomic_bool                    _isIdleParked;
+    bool                                _collectLatencyHistograms;
+    TaskRegistry::Ptr                   _registry; //null unless tasks are tracked
+    TimePoint                           _schedulerStart; //since the last coroutine run or idle wait
+    bool                                _isDeadlineScheduling;
+    bool                                _isDroppingExpired;
+    bool                                _isInliningContinuations;
+    bool                                _isRestarted; //next iteration starts from the head of the run queue
+    int                                 _queueId;
+    std::atomic_bool                    _isRetired;
+    std::chrono::microseconds           _longSliceThresholdUs;
+    Configuration::LongSliceCallback    _longSliceCallback;
+    std::vector<size_t>                 _priorityWeights; //slices per round granted to each priority level
+    size_t                              _pass; //index of the current pass over the run queue within a round
+    size_t                              _maxWeightInPass; //largest weight of the coroutines seen during this pass
+    bool                                _hasRunInPass; //a coroutine ran during this pass
 };
 
 }}
@@ -0,0 +1,117 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TASK_REGISTRY_H
+#define QUANTUM_TASK_REGISTRY_H
+
+#include <quantum/quantum_spinlock.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct TaskInfo
+//==============================================================================================
+/// @struct TaskInfo
+/// @brief Describes a live coroutine. See Dispatcher::snapshotTasks().
+struct TaskInfo
+{
+    enum class State : int
+    {
+        Pending,    ///< Posted and never run
+        Running,    ///< Currently running on its queue thread
+        Ready,      ///< Yielded and runnable
+        Blocked,    ///< Waiting on a future or a synchronization primitive (as of its last run)
+        Sleeping    ///< Waiting for a timer (as of its last run)
+    };
+    
+    int                         _queueId{0}; ///< Queue which last ran the coroutine or the one it was posted to
+    State                       _state{State::Pending};
+    std::chrono::nanoseconds    _age{0}; ///< Time since the coroutine was posted
+    std::chrono::nanoseconds    _timeInState{0}; ///< Time since the coroutine entered its current state
+    size_t                      _resumeCount{0}; ///< Number of times the coroutine was resumed after it started
+    const char*                 _tag{nullptr}; ///< See CoroStackTag
+};
+
+//==============================================================================================
+//                                     class TaskRegistry
+//==============================================================================================
+/// @class TaskRegistry
+/// @brief Tracks the live coroutines of a queue so that they can be inspected while the queue runs.
+/// @details Each tracked coroutine owns an entry which is linked into the registry of its queue under a
+///          spinlock when posted and unlinked when the coroutine is destroyed. The queue thread updates the state
+///          of the entry with relaxed stores around each run slice.
+/// @note For internal use only. See Configuration::setTrackTasks().
+class TaskRegistry : public std::enable_shared_from_this<TaskRegistry>
+{
+public:
+    using Ptr = std::shared_ptr<TaskRegistry>;
+    using Clock = std::chrono::steady_clock;
+    
+    class Entry
+    {
+        friend class TaskRegistry;
+    public:
+        /// @brief Records the state of the coroutine. Called by the thread running it.
+        void setState(TaskInfo::State state, int queueId, Clock::time_point now);
+        
+        /// @brief Increments the resume count. Called by the thread running the coroutine.
+        void incResumeCount();
+        
+    private:
+        Ptr                     _registry; //keeps the registry alive for as long as the coroutine
+        Entry*                  _prev{nullptr};
+        Entry*                  _next{nullptr};
+        Clock::time_point       _postTime;
+        const char*             _tag{nullptr};
+        std::atomic<int>        _queueId{0};
+        std::atomic<int>        _state{(int)TaskInfo::State::Pending};
+        std::atomic<int64_t>    _stateSinceNs{0};
+        std::atomic<size_t>     _resumeCount{0};
+    };
+    using EntryPtr = std::unique_ptr<Entry>;
+    
+    /// @brief Creates an entry for a coroutine and links it into this registry.
+    /// @param[in] queueId The id of the queue the coroutine is posted to.
+    /// @param[in] tag The tag of the coroutine or nullptr.
+    /// @return The entry, to be destroyed along with the coroutine via remove().
+    EntryPtr add(int queueId, const char* tag);
+    
+    /// @brief Unlinks an entry from the registry it was added to.
+    /// @param[in] entry The entry.
+    static void remove(Entry& entry);
+    
+    /// @brief Appends the description of all the coroutines in this registry.
+    /// @param[out] tasks The descriptions.
+    /// @param[in] now The time the ages are computed against.
+    void snapshot(std::vector<TaskInfo>& tasks, Clock::time_point now) const;
+    
+private:
+    static int64_t toNs(Clock::time_point time);
+    
+    mutable SpinLock    _spinlock;
+    Entry*              _head{nullptr};
+    size_t              _size{0};
+};
+
+}}
+
+#include <quantum/impl/quantum_task_registry_impl.h>
+
+#endif //QUANTUM_TASK_REGISTRY_H
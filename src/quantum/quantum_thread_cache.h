@@ -0,0 +1,114 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_THREAD_CACHE_H
+#define QUANTUM_THREAD_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     class ThreadCache
+//==============================================================================================
+/// @class ThreadCache
+/// @brief Per-thread magazines of free block indices, placed in front of the shared free list
+///        of an object pool.
+/// @details Each thread owns one magazine per pool, so allocating and releasing a block only
+///          touches thread-private memory. When a magazine runs dry the pool refills half of it
+///          from the shared free list under a single lock, and when it fills up the pool flushes
+///          half of it back the same way. Threads are mapped to magazines through a recyclable
+///          slot number; a thread exiting leaves its cached blocks to the next thread which is
+///          given the same slot. Threads beyond the maximum number of slots bypass the cache.
+/// @note For internal use only.
+class ThreadCache
+{
+public:
+    using index_type = uint16_t;
+    
+    static constexpr int MaxThreadSlots = 64;
+    
+    class Magazine
+    {
+    public:
+        explicit Magazine(size_t capacity);
+        
+        /// @brief Take a cached block.
+        /// @param[out] index The block index.
+        /// @return True if successful, false if the magazine is empty.
+        bool pop(index_type& index);
+        
+        /// @brief Cache a block.
+        /// @param[in] index The block index.
+        /// @return True if successful, false if the magazine is full.
+        bool push(index_type index);
+        
+        /// @brief Number of cached blocks.
+        size_t size() const;
+        
+        /// @brief Maximum number of cached blocks.
+        size_t capacity() const;
+        
+        /// @brief Number of blocks moved at once between the magazine and the shared pool.
+        size_t batchSize() const;
+        
+    private:
+        std::unique_ptr<index_type[]>   _blocks;
+        size_t                          _capacity;
+        std::atomic<size_t>             _size;
+    };
+    
+    /// @brief Constructor.
+    /// @param[in] capacity Maximum number of blocks cached per thread. Zero disables the cache.
+    explicit ThreadCache(size_t capacity);
+    ThreadCache(ThreadCache&&) = default;
+    ThreadCache& operator=(ThreadCache&&) = default;
+    ~ThreadCache();
+    
+    /// @brief Get the magazine of the calling thread. Only the calling thread may use it.
+    /// @return The magazine or nullptr if the cache is disabled or the thread has no slot.
+    Magazine* magazine();
+    
+    /// @brief Total number of blocks cached across all threads.
+    /// @return The number of blocks.
+    /// @note The value is only an approximation if other threads are using the pool concurrently.
+    size_t cachedBlocks() const;
+    
+    /// @brief Visit every cached block and empty all the magazines.
+    /// @param[in] func Callable invoked with each block index.
+    /// @warning Not thread safe. Only call when no other thread is using the pool.
+    template <typename FUNC>
+    void drain(FUNC&& func);
+    
+private:
+    static int threadSlot();
+    static int acquireSlot();
+    static void releaseSlot(int slot);
+    
+    size_t                                      _capacity;
+    std::unique_ptr<std::atomic<Magazine*>[]>   _magazines;
+};
+
+}}
+
+#include <quantum/impl/quantum_thread_cache_impl.h>
+
+#endif //QUANTUM_THREAD_CACHE_H
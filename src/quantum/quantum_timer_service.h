@@ -0,0 +1,99 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TIMER_SERVICE_H
+#define QUANTUM_TIMER_SERVICE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                  class TimerService
+//==============================================================================================
+/// @class TimerService
+/// @brief Runs callbacks at a future time, once or periodically, from a single timer thread.
+/// @details Timers are kept in a min-heap ordered by their due time so that only the timer thread waits for them.
+///          Callbacks run on the timer thread and should be short, typically posting a task to a queue.
+/// @note For internal use only. See Dispatcher::postAfter() and Dispatcher::postEvery().
+class TimerService
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    
+    TimerService();
+    
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+    
+    ~TimerService();
+    
+    /// @brief Stops the timer thread. Pending timers are discarded.
+    void terminate();
+    
+    /// @brief Schedule a callback.
+    /// @param[in] delay Time after which the callback runs.
+    /// @param[in] period If non-zero, the callback runs again every period until cancelled.
+    /// @param[in] callback The callback. Exceptions thrown by it are ignored.
+    /// @return A timer id which can be passed to cancel().
+    uint64_t schedule(std::chrono::microseconds delay, std::chrono::microseconds period, Callback callback);
+    
+    /// @brief Cancel a timer.
+    /// @param[in] id The timer id.
+    /// @return True if the timer was pending and will no longer run.
+    /// @note If the callback of this timer is running, waits for it to complete unless called from the callback
+    ///       itself, so nothing is posted by the timer once this returns.
+    bool cancel(uint64_t id);
+    
+    /// @brief Number of pending timers.
+    size_t size() const;
+    
+private:
+    struct Timer
+    {
+        Clock::time_point           _due;
+        std::chrono::microseconds   _period;
+        Callback                    _callback;
+    };
+    using HeapEntry = std::pair<Clock::time_point, uint64_t>; //due time and timer id
+    
+    void run();
+    
+    mutable std::mutex                          _mutex;
+    std::condition_variable                     _cond;
+    std::condition_variable                     _callbackDone;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> _heap; //may hold cancelled ids
+    std::unordered_map<uint64_t, Timer>         _timers;
+    uint64_t                                    _nextId;
+    bool                                        _isInterrupted;
+    uint64_t                                    _runningId; //timer whose callback is running or 0
+    std::thread                                 _thread;
+};
+
+}}
+
+#include <quantum/impl/quantum_timer_service_impl.h>
+
+#endif //QUANTUM_TIMER_SERVICE_H
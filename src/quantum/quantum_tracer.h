@@ -0,0 +1,136 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TRACER_H
+#define QUANTUM_TRACER_H
+
+#include <quantum/interface/quantum_iqueue.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#ifndef __QUANTUM_TRACE_BUFFER_SIZE
+    #define __QUANTUM_TRACE_BUFFER_SIZE 65536
+#endif
+
+/// @brief Records a task lifecycle event. Compiled out unless __QUANTUM_ENABLE_TRACING is defined, in which case
+///        the arguments are not evaluated either.
+#ifdef __QUANTUM_ENABLE_TRACING
+    #define QUANTUM_TRACE(event, object, queueType, queueId) \
+        Bloomberg::quantum::Tracer::record(event, object, queueType, queueId)
+#else
+    #define QUANTUM_TRACE(event, object, queueType, queueId)
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                        class Tracer
+//==============================================================================================
+/// @class Tracer.
+/// @brief Collects the lifecycle events of coroutines and IO tasks for offline latency analysis.
+/// @details Each thread records into its own fixed-size ring buffer without locking, overwriting its oldest
+///          events when full. The events recorded by the library itself are compiled in by defining
+///          __QUANTUM_ENABLE_TRACING, and cost nothing otherwise. The buffers can be dumped at any time in the
+///          Chrome trace event format, which chrome://tracing and Perfetto can load.
+class Tracer
+{
+public:
+    enum class Event : uint8_t
+    {
+        Posted,     ///< Task was pushed onto a queue
+        Started,    ///< Task runs for the first time
+        Resumed,    ///< Coroutine runs again after having yielded
+        Yielded,    ///< Coroutine yields voluntarily (see ICoroSync::yield())
+        Blocked,    ///< Coroutine yields until a timer expires (see ICoroContextBase::sleep())
+        Suspended,  ///< Coroutine is back to its queue without having completed
+        Finished,   ///< Task completed, failed or was cancelled
+        Set         ///< A future value or exception was published. The object is the shared state.
+    };
+    
+    struct Record
+    {
+        int64_t             _timestampNs; ///< Since the epoch of the steady clock
+        const void*         _object;      ///< Task identity, i.e. its ITask address
+        Event               _event;
+        IQueue::QueueType   _queueType;   ///< IQueue::QueueType::All when not related to a queue
+        int                 _queueId;
+    };
+    
+    /// @brief Records an event into the buffer of the calling thread.
+    /// @param[in] event The event.
+    /// @param[in] object The task or shared state the event relates to.
+    /// @param[in] queueType The type of queue the task belongs to.
+    /// @param[in] queueId The id of the queue the task belongs to.
+    /// @note Allocates the buffer of the calling thread the first time it is called on that thread.
+    static void record(Event event,
+                       const void* object,
+                       IQueue::QueueType queueType = IQueue::QueueType::All,
+                       int queueId = (int)IQueue::QueueId::All) noexcept;
+    
+    /// @brief Get/set the number of events kept for each thread.
+    /// @return A modifiable reference to the value.
+    /// @note Only applies to the threads which have not recorded any event yet. Default is
+    ///       __QUANTUM_TRACE_BUFFER_SIZE.
+    static size_t& bufferSize();
+    
+    /// @brief Gets the events currently held by all the buffers.
+    /// @return One vector per recording thread, each ordered from the oldest to the latest event.
+    /// @note Can be called while other threads are recording.
+    static std::vector<std::vector<Record>> records();
+    
+    /// @brief Writes all the events held by the buffers as a Chrome trace.
+    /// @param[out] out The stream to write the JSON document to.
+    /// @details Each recording thread is a separate track. Coroutine slices are delimited by their
+    ///          Started/Resumed and Suspended/Finished events, all other events are instants.
+    static void dump(std::ostream& out);
+    
+private:
+    struct Slot
+    {
+        std::atomic<int64_t>        _timestampNs{0};
+        std::atomic<const void*>    _object{nullptr};
+        std::atomic<uint64_t>       _info{0}; //event, queue type and queue id
+    };
+    
+    struct Buffer
+    {
+        explicit Buffer(size_t size);
+        
+        std::vector<Slot>       _slots;
+        std::atomic<uint64_t>   _head{0}; //number of events ever recorded
+    };
+    using BufferPtr = std::shared_ptr<Buffer>;
+    
+    struct Registry
+    {
+        std::mutex              _mutex;
+        std::vector<BufferPtr>  _buffers; //outlive their thread so the events remain available
+    };
+    
+    static Registry& registry();
+    static Buffer& threadBuffer();
+    static void write(std::ostream& out, const Record& record, size_t threadId);
+};
+
+}}
+
+#include <quantum/impl/quantum_tracer_impl.h>
+
+#endif //QUANTUM_TRACER_H
@@ -18,7 +18,11 @@
 
 #include <quantum/quantum_stack_traits.h>
 #include <quantum/quantum_allocator.h>
-#include <boost/coroutine2/all.hpp>
+#ifdef __QUANTUM_USE_FIBER_COROUTINES
+    #include <quantum/quantum_fiber.h>
+#else
+    #include <boost/coroutine2/all.hpp>
+#endif
 #include <iterator>
 #include <type_traits>
 
@@ -54,9 +58,14 @@ struct StackTraitsProxy {
 /// @brief Contains definitions for various traits used by this library. For internal use only.
 struct Traits
 {
+#ifdef __QUANTUM_USE_FIBER_COROUTINES
+    using Yield     = FiberYield;
+    using Coroutine = FiberCoroutine;
+#else
     using BoostCoro = boost::coroutines2::coroutine<int&>;
     using Yield     = typename BoostCoro::pull_type;
     using Coroutine = typename BoostCoro::push_type;
+#endif
     
     template <class IT>
     using IsInputIterator = std::enable_if_t<std::is_convertible<typename std::iterator_traits<IT>::iterator_category, std::input_iterator_tag>::value>;
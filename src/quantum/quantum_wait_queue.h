@@ -0,0 +1,100 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_WAIT_QUEUE_H
+#define QUANTUM_WAIT_QUEUE_H
+
+#include <atomic>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+#include <quantum/quantum_yielding_thread.h>
+#include <quantum/quantum_futex.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class WaitQueue
+//==============================================================================================
+/// @class WaitQueue.
+/// @brief FIFO queue of parked coroutines and threads used to build synchronization primitives.
+/// @details A caller only parks if its wait condition still holds once it's registered as a waiter,
+///          so the state guarded by the condition must be modified with sequentially consistent
+///          atomics before calling hasWaiters() or notify(). A parked coroutine is blocked, and can be
+///          parked by its queue, while a parked thread sleeps on a futex (Linux) or yields.
+/// @note For internal use only.
+class WaitQueue
+{
+public:
+    /// @brief Constructor.
+    WaitQueue();
+    
+    WaitQueue(const WaitQueue& other) = delete;
+    WaitQueue& operator=(const WaitQueue& other) = delete;
+    
+    /// @brief Parks the current thread until notified.
+    /// @param[in] shouldWait Predicate returning true if the caller must wait. Evaluated once
+    ///            the caller is registered as a waiter.
+    /// @note Must be called in a non-coroutine context.
+    template <class PREDICATE>
+    void wait(PREDICATE shouldWait);
+    
+    /// @brief Parks the current coroutine until notified.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] shouldWait Predicate returning true if the caller must wait. Evaluated once
+    ///            the caller is registered as a waiter.
+    /// @note Must be called from a coroutine.
+    template <class PREDICATE>
+    void wait(ICoroSync::Ptr sync, PREDICATE shouldWait);
+    
+    /// @brief Determines if callers are waiting or about to wait.
+    /// @return True if there are waiters.
+    bool hasWaiters() const;
+    
+    /// @brief Wakes up the longest waiting callers.
+    /// @param[in] num The maximum number of callers to wake up.
+    /// @return The number of callers woken up.
+    size_t notify(size_t num = 1);
+    
+    /// @brief Wakes up all waiting callers.
+    /// @return The number of callers woken up.
+    size_t notifyAll();
+    
+private:
+    //Node of the waiter list. Lives on the stack of the waiting coroutine or thread.
+    struct Waiter
+    {
+        ICoroSync::Ptr      _sync;      //null for threads
+        std::atomic_int     _signal{0}; //set to 1 when a thread waiter is woken up
+        Waiter*             _next{nullptr};
+    };
+    
+    template <class PREDICATE>
+    bool enqueue(Waiter& waiter, PREDICATE& shouldWait); //returns false if the caller must not wait
+    
+    static void block(std::atomic_int& signal);
+    
+    //Members
+    std::atomic_size_t  _numWaiters;
+    mutable SpinLock    _spinlock; //protects the waiter list
+    Waiter*             _head;
+    Waiter*             _tail;
+};
+
+}}
+
+#include <quantum/impl/quantum_wait_queue_impl.h>
+
+#endif //QUANTUM_WAIT_QUEUE_H
@@ -18,6 +18,9 @@
 
 #include <thread>
 #include <chrono>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #include <quantum/quantum_thread_traits.h>
 
 namespace Bloomberg {
@@ -56,6 +59,26 @@ struct YieldingThreadDuration
 
 using YieldingThread = YieldingThreadDuration<std::chrono::microseconds>;
 
+//==============================================================================================
+//                                      struct CpuPause
+//==============================================================================================
+/// @struct CpuPause.
+/// @brief Hints the processor that the calling thread is inside a busy-wait loop.
+/// @note For internal use only.
+struct CpuPause
+{
+    void operator()()
+    {
+#if defined(_MSC_VER)
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+};
+
 }}
 
 #endif //QUANTUM_YIELDING_THREAD_H
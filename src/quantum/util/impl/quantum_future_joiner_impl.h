@@ -56,32 +56,11 @@ FutureJoiner<T>::operator()(DISPATCHER& dispatcher, std::vector<CoroFuturePtr<T>
 template <typename T>
 template <template<class> class FUTURE, class DISPATCHER>
 ThreadFuturePtr<std::vector<T>>
-FutureJoiner<T>::join(ThreadContextTag, DISPATCHER& dispatcher, std::vector<typename FUTURE<T>::Ptr>&& futures)
+FutureJoiner<T>::join(ThreadContextTag, DISPATCHER&, std::vector<typename FUTURE<T>::Ptr>&& futures)
 {
-#if (__cplusplus == 201103L)
-    std::shared_ptr<std::vector<typename FUTURE<T>::Ptr>> containerPtr(new std::vector<typename FUTURE<T>::Ptr>(std::move(futures)));
-    return dispatcher.template postAsyncIo<std::vector<T>>([containerPtr](ThreadPromisePtr<std::vector<T>> promise)
-    {
-        std::vector<T> result;
-        result.reserve(containerPtr->size());
-        for (auto&& f : *containerPtr)
-        {
-            result.emplace_back(f->get());
-        }
-        return promise->set(std::move(result));
-    });
-#else
-    return dispatcher.template postAsyncIo<std::vector<T>>([container{std::move(futures)}](ThreadPromisePtr<std::vector<T>> promise)
-    {
-        std::vector<T> result;
-        result.reserve(container.size());
-        for (auto&& f : container)
-        {
-            result.emplace_back(f->get());
-        }
-        return promise->set(std::move(result));
-    });
-#endif
+    PromisePtr<std::vector<T>> promise = Promise<std::vector<T>>::create();
+    joinImpl(std::move(futures), promise);
+    return promise->getIThreadFuture();
 }
 
 template <typename T>
@@ -89,30 +68,79 @@ template <template<class> class FUTURE, class DISPATCHER>
 CoroContextPtr<std::vector<T>>
 FutureJoiner<T>::join(CoroContextTag, DISPATCHER& dispatcher, std::vector<typename FUTURE<T>::Ptr>&& futures)
 {
-#if (__cplusplus == 201103L)
-    std::shared_ptr<std::vector<typename FUTURE<T>::Ptr>> containerPtr(new std::vector<typename FUTURE<T>::Ptr>(std::move(futures)));
-    return dispatcher.template post<std::vector<T>>([containerPtr](CoroContextPtr<std::vector<T>> ctx)
+    //The joined context is never scheduled. It only carries the promise fulfilled by the last child.
+    auto& impl = static_cast<typename DISPATCHER::Impl&>(dispatcher);
+    typename Context<std::vector<T>>::Ptr ctx = Context<std::vector<T>>::create(*impl._dispatcher);
+    joinImpl(std::move(futures), ctx);
+    return ctx;
+}
+
+template <typename T>
+template <class FUTURE_PTR, class PROMISE_PTR>
+void FutureJoiner<T>::joinImpl(std::vector<FUTURE_PTR>&& futures, PROMISE_PTR promise)
+{
+    if (futures.empty())
+    {
+        promise->set(std::vector<T>());
+        return;
+    }
+    std::shared_ptr<JoinState<FUTURE_PTR, PROMISE_PTR>> state =
+        std::make_shared<JoinState<FUTURE_PTR, PROMISE_PTR>>(std::move(futures), std::move(promise));
+    for (auto&& future : state->_futures)
     {
-        std::vector<T> result;
-        result.reserve(containerPtr->size());
-        for (auto&& f : *containerPtr)
+        future->onReady([state]()
         {
-            result.emplace_back(f->get(ctx));
-        }
-        return ctx->set(std::move(result));
-    });
-#else
-    return dispatcher.template post<std::vector<T>>([container{std::move(futures)}](CoroContextPtr<std::vector<T>> ctx)
+            if (state->_numPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                complete(*state); //last child to complete
+            }
+        });
+    }
+}
+
+template <typename T>
+template <class FUTURE_PTR, class PROMISE_PTR>
+void FutureJoiner<T>::complete(JoinState<FUTURE_PTR, PROMISE_PTR>& state)
+{
+    std::vector<T> result;
+    result.reserve(state._futures.size());
+    try
     {
-        std::vector<T> result;
-        result.reserve(container.size());
-        for (auto&& f : container)
+        for (auto&& future : state._futures)
         {
-            result.emplace_back(f->get(ctx));
+            result.emplace_back(getValue(future));
         }
-        return ctx->set(std::move(result));
-    });
-#endif
+    }
+    catch (...)
+    {
+        state._promise->setException(std::current_exception());
+        return;
+    }
+    state._promise->set(std::move(result));
+}
+
+template <typename T>
+T FutureJoiner<T>::getValue(const ThreadContextPtr<T>& future)
+{
+    return future->get();
+}
+
+template <typename T>
+T FutureJoiner<T>::getValue(const ThreadFuturePtr<T>& future)
+{
+    return future->get();
+}
+
+template <typename T>
+T FutureJoiner<T>::getValue(const CoroContextPtr<T>& future)
+{
+    return future->get(ICoroSync::Ptr()); //ready, does not yield
+}
+
+template <typename T>
+T FutureJoiner<T>::getValue(const CoroFuturePtr<T>& future)
+{
+    return future->get(ICoroSync::Ptr()); //ready, does not yield
 }
 
 }} //namespace
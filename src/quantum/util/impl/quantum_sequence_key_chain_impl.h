@@ -0,0 +1,156 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+SequenceKeyChain::SequenceKeyChain(bool isRunning) :
+    _isRunning(isRunning),
+    _isClosed(false),
+    _done(1)
+{
+}
+
+inline
+bool SequenceKeyChain::append(LinkPtr& link)
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_lock);
+        if (_isClosed)
+        {
+            return false;
+        }
+        if (_isRunning)
+        {
+            _links.emplace_back(std::move(link));
+            return true;
+        }
+        _isRunning = true;
+    }
+    try
+    {
+        link->post(shared_from_this(), nullptr);
+    }
+    catch (...)
+    {
+        next(nullptr);
+        throw;
+    }
+    return true;
+}
+
+inline
+void SequenceKeyChain::next(const CoroContextPtr<int>& ctx)
+{
+    while (true)
+    {
+        LinkPtr link;
+        bool isDone = false;
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_lock);
+            if (_links.empty())
+            {
+                _isRunning = false;
+                isDone = _isClosed;
+            }
+            else
+            {
+                link = std::move(_links.front());
+                _links.pop_front();
+            }
+        }
+        if (!link)
+        {
+            if (isDone)
+            {
+                _done.countDown();
+            }
+            return;
+        }
+        try
+        {
+            link->post(shared_from_this(), ctx);
+            return;
+        }
+        catch (...)
+        {
+            //the dispatcher no longer accepts tasks so drop this one and carry on
+        }
+    }
+}
+
+inline
+SequenceKeyChain::LinkPtr SequenceKeyChain::pop(int queueId)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_lock);
+    if (_links.empty())
+    {
+        return nullptr;
+    }
+    int linkQueueId = _links.front()->getQueueId();
+    if (!_links.front()->canRunInline() ||
+        ((linkQueueId != (int)IQueue::QueueId::Any) && (linkQueueId != queueId)))
+    {
+        return nullptr;
+    }
+    LinkPtr link = std::move(_links.front());
+    _links.pop_front();
+    return link;
+}
+
+inline
+void SequenceKeyChain::close()
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_lock);
+        if (_isClosed)
+        {
+            return;
+        }
+        _isClosed = true;
+        if (_isRunning)
+        {
+            return; //the last task completes the chain
+        }
+    }
+    _done.countDown();
+}
+
+inline
+bool SequenceKeyChain::isIdle() const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_lock);
+    return !_isRunning;
+}
+
+inline
+void SequenceKeyChain::wait(ICoroSync::Ptr sync)
+{
+    _done.wait(std::move(sync));
+}
+
+}}
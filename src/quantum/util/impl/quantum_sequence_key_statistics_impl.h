@@ -24,31 +24,51 @@ namespace quantum {
 
 inline
 SequenceKeyStatistics::SequenceKeyStatistics(const SequenceKeyStatistics& that) :
-    _postedTaskCount(that._postedTaskCount),
-    _pendingTaskCount(that._pendingTaskCount.load())
+    _postedTaskCount(that._postedTaskCount.load()),
+    _pendingTaskCount(that._pendingTaskCount.load()),
+    _completedTaskCount(that._completedTaskCount.load()),
+    _totalQueueingDelay(that._totalQueueingDelay.load()),
+    _maxQueueingDelay(that._maxQueueingDelay.load()),
+    _totalExecutionTime(that._totalExecutionTime.load()),
+    _maxExecutionTime(that._maxExecutionTime.load())
 {
 }
 
 inline
 SequenceKeyStatistics::SequenceKeyStatistics(SequenceKeyStatistics&& that) :
-    _postedTaskCount(std::move(that._postedTaskCount)),
-    _pendingTaskCount(that._pendingTaskCount.load())
+    _postedTaskCount(that._postedTaskCount.load()),
+    _pendingTaskCount(that._pendingTaskCount.load()),
+    _completedTaskCount(that._completedTaskCount.load()),
+    _totalQueueingDelay(that._totalQueueingDelay.load()),
+    _maxQueueingDelay(that._maxQueueingDelay.load()),
+    _totalExecutionTime(that._totalExecutionTime.load()),
+    _maxExecutionTime(that._maxExecutionTime.load())
 {
 }
 
 inline
 SequenceKeyStatistics& SequenceKeyStatistics::operator = (SequenceKeyStatistics&& that)
 {
-    _postedTaskCount = std::move(that._postedTaskCount);
+    _postedTaskCount = that._postedTaskCount.load();
     _pendingTaskCount = that._pendingTaskCount.load();
+    _completedTaskCount = that._completedTaskCount.load();
+    _totalQueueingDelay = that._totalQueueingDelay.load();
+    _maxQueueingDelay = that._maxQueueingDelay.load();
+    _totalExecutionTime = that._totalExecutionTime.load();
+    _maxExecutionTime = that._maxExecutionTime.load();
     return *this;
 }
 
 inline
 SequenceKeyStatistics& SequenceKeyStatistics::operator = (const SequenceKeyStatistics& that)
 {
-    _postedTaskCount = that._postedTaskCount;
-    _pendingTaskCount = _pendingTaskCount.load();
+    _postedTaskCount = that._postedTaskCount.load();
+    _pendingTaskCount = that._pendingTaskCount.load();
+    _completedTaskCount = that._completedTaskCount.load();
+    _totalQueueingDelay = that._totalQueueingDelay.load();
+    _maxQueueingDelay = that._maxQueueingDelay.load();
+    _totalExecutionTime = that._totalExecutionTime.load();
+    _maxExecutionTime = that._maxExecutionTime.load();
     return *this;
 }
  
@@ -65,6 +85,43 @@ SequenceKeyStatistics::getPendingTaskCount() const
 {
     return _pendingTaskCount;
 }
+
+inline
+size_t
+SequenceKeyStatistics::getCompletedTaskCount() const
+{
+    return _completedTaskCount;
+}
+
+inline
+std::chrono::microseconds
+SequenceKeyStatistics::getAverageQueueingDelay() const
+{
+    size_t count = _completedTaskCount;
+    return std::chrono::microseconds(count ? _totalQueueingDelay / count : 0);
+}
+
+inline
+std::chrono::microseconds
+SequenceKeyStatistics::getMaxQueueingDelay() const
+{
+    return std::chrono::microseconds(_maxQueueingDelay);
+}
+
+inline
+std::chrono::microseconds
+SequenceKeyStatistics::getAverageExecutionTime() const
+{
+    size_t count = _completedTaskCount;
+    return std::chrono::microseconds(count ? _totalExecutionTime / count : 0);
+}
+
+inline
+std::chrono::microseconds
+SequenceKeyStatistics::getMaxExecutionTime() const
+{
+    return std::chrono::microseconds(_maxExecutionTime);
+}
  
 inline
 void
@@ -86,5 +143,25 @@ SequenceKeyStatisticsWriter::decrementPendingTaskCount()
 {
     --_pendingTaskCount;
 }
+
+inline
+void
+SequenceKeyStatisticsWriter::recordCompletedTask(std::chrono::microseconds queueingDelay,
+                                                 std::chrono::microseconds executionTime)
+{
+    _totalQueueingDelay += queueingDelay.count();
+    updateMax(_maxQueueingDelay, queueingDelay.count());
+    _totalExecutionTime += executionTime.count();
+    updateMax(_maxExecutionTime, executionTime.count());
+    ++_completedTaskCount;
+}
+
+inline
+void
+SequenceKeyStatisticsWriter::updateMax(std::atomic<uint64_t>& max, uint64_t value)
+{
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while ((value > current) && !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
  
 }}
@@ -20,6 +20,8 @@
 //##############################################################################################
 
 #include <quantum/util/quantum_sequence_key_statistics.h>
+#include <quantum/util/quantum_sequence_key_chain.h>
+#include <quantum/quantum_semaphore.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -30,8 +32,11 @@ struct SequenceKeyData
     SequenceKeyData() :
         _stats(std::make_shared<SequenceKeyStatisticsWriter>())
     {}
-    ICoroContextBasePtr _context;
-    StatsPtr            _stats;
+    ICoroContextBasePtr     _context;
+    StatsPtr                _stats;
+    SequenceKeyChain::Ptr   _chain; //open chain of directly dispatched tasks, if any
+    std::shared_ptr<Semaphore> _pendingPermits; //one permit per pending task if the key pending count is limited
+    uint64_t                _epoch{0}; //universal epoch of the last task posted for the key
 };
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
@@ -48,6 +53,147 @@ SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getControlQueueI
     return _controllerQueueId;
 }
 
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setControlQueueCount(int controlQueueCount)
+{
+    _controllerQueueCount = controlQueueCount;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+int
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getControlQueueCount() const
+{
+    return _controllerQueueCount;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setDirectDispatch(bool directDispatch)
+{
+    _directDispatch = directDispatch;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+bool
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getDirectDispatch() const
+{
+    return _directDispatch;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setMaxBatchSize(size_t maxBatchSize)
+{
+    _maxBatchSize = maxBatchSize;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getMaxBatchSize() const
+{
+    return _maxBatchSize;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setHotKeyCapacity(size_t hotKeyCapacity)
+{
+    _hotKeyCapacity = hotKeyCapacity;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getHotKeyCapacity() const
+{
+    return _hotKeyCapacity;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setMaxPendingTaskCount(size_t maxPendingTaskCount)
+{
+    _maxPendingTaskCount = maxPendingTaskCount;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getMaxPendingTaskCount() const
+{
+    return _maxPendingTaskCount;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setMaxPendingTaskCountPerKey(
+    size_t maxPendingTaskCountPerKey)
+{
+    _maxPendingTaskCountPerKey = maxPendingTaskCountPerKey;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getMaxPendingTaskCountPerKey() const
+{
+    return _maxPendingTaskCountPerKey;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setBackpressurePolicy(BackpressurePolicy policy)
+{
+    _backpressurePolicy = policy;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+typename SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::BackpressurePolicy
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getBackpressurePolicy() const
+{
+    return _backpressurePolicy;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setTrimInterval(size_t trimInterval)
+{
+    _trimInterval = trimInterval;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getTrimInterval() const
+{
+    return _trimInterval;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setTrimBatchSize(size_t trimBatchSize)
+{
+    _trimBatchSize = trimBatchSize;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getTrimBatchSize() const
+{
+    return _trimBatchSize;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setTrimThreshold(size_t trimThreshold)
+{
+    _trimThreshold = trimThreshold;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::getTrimThreshold() const
+{
+    return _trimThreshold;
+}
+
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
 void
 SequencerConfiguration<SequenceKey, Hash, KeyEqual, Allocator>::setBucketCount(size_t bucketCount)
@@ -19,6 +19,7 @@
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
 
+#include <iterator>
 #include <stdexcept>
 
 namespace Bloomberg {
@@ -30,17 +31,92 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::Sequencer(Dispatcher& dispatc
     _dispatcher(dispatcher),
     _controllerQueueId(configuration.getControlQueueId()),
     _universalContext(),
-    _contexts(configuration.getBucketCount(),
-              configuration.getHash(),
-              configuration.getKeyEqual(),
-              configuration.getAllocator()),
+    _hash(configuration.getHash()),
     _exceptionCallback(configuration.getExceptionCallback()),
-    _taskStats(std::make_shared<SequenceKeyStatisticsWriter>())
+    _taskStats(std::make_shared<SequenceKeyStatisticsWriter>()),
+    _isDirectDispatch(configuration.getDirectDispatch()),
+    _maxBatchSize(configuration.getMaxBatchSize()),
+    _hotKeyCapacity(configuration.getHotKeyCapacity()),
+    _maxPendingTaskCount(configuration.getMaxPendingTaskCount()),
+    _maxPendingTaskCountPerKey(configuration.getMaxPendingTaskCountPerKey()),
+    _backpressurePolicy(configuration.getBackpressurePolicy()),
+    _pendingPermits(_maxPendingTaskCount),
+    _trimInterval(configuration.getTrimInterval()),
+    _trimBatchSize(configuration.getTrimBatchSize()),
+    _trimThreshold(configuration.getTrimThreshold())
 {
     if (_controllerQueueId <= (int)IQueue::QueueId::Any || _controllerQueueId >= _dispatcher.getNumCoroutineThreads())
     {
         throw std::out_of_range("Allowed range is 0 <= controllerQueueId < _dispatcher.getNumCoroutineThreads()");
     }
+    int numShards = configuration.getControlQueueCount();
+    if (numShards < 1 || numShards > _dispatcher.getNumCoroutineThreads())
+    {
+        throw std::out_of_range("Allowed range is 1 <= controlQueueCount <= _dispatcher.getNumCoroutineThreads()");
+    }
+    for (int i = 0; i < numShards; ++i)
+    {
+        _shards.emplace_back((_controllerQueueId + i) % _dispatcher.getNumCoroutineThreads(),
+                             configuration,
+                             _universalContext);
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::Shard::Shard(int queueId,
+                                                          const Configuration& configuration,
+                                                          const SequenceKeyData& universalContext) :
+    _queueId(queueId),
+    _universalContext(universalContext),
+    _epoch(std::make_shared<Epoch>()),
+    _contexts(configuration.getBucketCount(),
+              configuration.getHash(),
+              configuration.getKeyEqual(),
+              configuration.getAllocator())
+{
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::Epoch::enter()
+{
+    _count.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::Epoch::leave()
+{
+    if (_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        _done.countDown();
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::Epoch::wait(ICoroSync::Ptr sync)
+{
+    _done.wait(sync);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::CrossShardDependents::CrossShardDependents(size_t numShards) :
+    _latch(numShards)
+{
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getShardIndex(const SequenceKey& sequenceKey)
+{
+    if (_shards.size() == 1)
+    {
+        return 0;
+    }
+    //mix the hash so that the keys of a shard still spread evenly over the buckets of its map
+    uint64_t hash = static_cast<uint64_t>(_hash(sequenceKey)) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> 32) % _shards.size();
 }
     
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
@@ -51,16 +127,13 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::post(
     FUNC&& func,
     ARGS&&... args)
 {
-    _dispatcher.post<int>(_controllerQueueId,
-                          false,
-                          singleSequenceKeyTaskScheduler<FUNC, ARGS...>,
-                          nullptr,
-                          (int)IQueue::QueueId::Any,
-                          false,
-                          *this,
-                          SequenceKey(sequenceKey),
-                          std::forward<FUNC>(func),
-                          std::forward<ARGS>(args)...);
+    acquirePermits(nullptr, &sequenceKey, &sequenceKey + 1);
+    postSequenceKey(nullptr,
+                    (int)IQueue::QueueId::Any,
+                    false,
+                    sequenceKey,
+                    std::forward<FUNC>(func),
+                    std::forward<ARGS>(args)...);
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
@@ -78,17 +151,38 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::post(
     {
         throw std::runtime_error("Invalid IO queue id");
     }
+    acquirePermits(nullptr, &sequenceKey, &sequenceKey + 1);
+    postSequenceKey(opaque,
+                    queueId,
+                    isHighPriority,
+                    sequenceKey,
+                    std::forward<FUNC>(func),
+                    std::forward<ARGS>(args)...);
+}
 
-    _dispatcher.post<int>(_controllerQueueId,
-                          false,
-                          singleSequenceKeyTaskScheduler<FUNC, ARGS...>,
-                          std::move(opaque),
-                          std::move(queueId),
-                          std::move(isHighPriority),
-                          *this,
-                          SequenceKey(sequenceKey),
-                          std::forward<FUNC>(func),
-                          std::forward<ARGS>(args)...);
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::post(
+    ICoroSync::Ptr sync,
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    const SequenceKey& sequenceKey,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    acquirePermits(sync, &sequenceKey, &sequenceKey + 1);
+    postSequenceKey(opaque,
+                    queueId,
+                    isHighPriority,
+                    sequenceKey,
+                    std::forward<FUNC>(func),
+                    std::forward<ARGS>(args)...);
 }
  
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
@@ -99,16 +193,13 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::post(
     FUNC&& func,
     ARGS&&... args)
 {
-    _dispatcher.post<int>(_controllerQueueId,
-                          false,
-                          multiSequenceKeyTaskScheduler<FUNC, ARGS...>,
-                          nullptr,
-                          (int)IQueue::QueueId::Any,
-                          false,
-                          *this,
-                          std::vector<SequenceKey>(sequenceKeys),
-                          std::forward<FUNC>(func),
-                          std::forward<ARGS>(args)...);
+    acquirePermits(nullptr, sequenceKeys.data(), sequenceKeys.data() + sequenceKeys.size());
+    postSequenceKeys(nullptr,
+                     (int)IQueue::QueueId::Any,
+                     false,
+                     sequenceKeys,
+                     std::forward<FUNC>(func),
+                     std::forward<ARGS>(args)...);
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
@@ -126,212 +217,1043 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::post(
     {
         throw std::runtime_error("Invalid IO queue id");
     }
-    _dispatcher.post<int>(_controllerQueueId,
-                          false,
-                          multiSequenceKeyTaskScheduler<FUNC, ARGS...>,
-                          std::move(opaque),
-                          std::move(queueId),
-                          std::move(isHighPriority),
-                          *this,
-                          std::vector<SequenceKey>(sequenceKeys),
-                          std::forward<FUNC>(func),
-                          std::forward<ARGS>(args)...);
+    acquirePermits(nullptr, sequenceKeys.data(), sequenceKeys.data() + sequenceKeys.size());
+    postSequenceKeys(opaque,
+                     queueId,
+                     isHighPriority,
+                     sequenceKeys,
+                     std::forward<FUNC>(func),
+                     std::forward<ARGS>(args)...);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::post(
+    ICoroSync::Ptr sync,
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    const std::vector<SequenceKey>& sequenceKeys,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    acquirePermits(sync, sequenceKeys.data(), sequenceKeys.data() + sequenceKeys.size());
+    postSequenceKeys(opaque,
+                     queueId,
+                     isHighPriority,
+                     sequenceKeys,
+                     std::forward<FUNC>(func),
+                     std::forward<ARGS>(args)...);
+}
+ 
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postAll(FUNC&& func, ARGS&&... args)
+{
+    acquirePermits(nullptr, nullptr, nullptr);
+    postUniversal(nullptr, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postAll(
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    acquirePermits(nullptr, nullptr, nullptr);
+    postUniversal(opaque, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postAll(
+    ICoroSync::Ptr sync,
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    acquirePermits(sync, nullptr, nullptr);
+    postUniversal(opaque, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::acquirePermits(const ICoroSync::Ptr& sync,
+                                                                  const SequenceKey* first,
+                                                                  const SequenceKey* last)
+{
+    if ((_maxPendingTaskCount != 0) && !acquirePermit(sync, _pendingPermits))
+    {
+        throw std::runtime_error("Sequencer pending task limit reached");
+    }
+    if ((_maxPendingTaskCountPerKey == 0) || (first == last))
+    {
+        return;
+    }
+    std::vector<std::shared_ptr<Semaphore>> acquired;
+    acquired.reserve(last - first);
+    for (const SequenceKey* it = first; it != last; ++it)
+    {
+        std::shared_ptr<Semaphore> permits = getKeyPermits(*it);
+        if (!acquirePermit(sync, *permits))
+        {
+            // give back the permits already taken for this task
+            for (auto& acquiredPermits : acquired)
+            {
+                acquiredPermits->release();
+            }
+            releasePermit();
+            throw std::runtime_error("Sequencer pending task limit reached for sequence key");
+        }
+        acquired.emplace_back(std::move(permits));
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+bool
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::acquirePermit(const ICoroSync::Ptr& sync, Semaphore& permits)
+{
+    if (permits.tryAcquire())
+    {
+        return true;
+    }
+    if (_backpressurePolicy == Configuration::BackpressurePolicy::Reject)
+    {
+        return false;
+    }
+    if (sync)
+    {
+        permits.acquire(sync);
+    }
+    else
+    {
+        permits.acquire();
+    }
+    return true;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+std::shared_ptr<Semaphore>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getKeyPermits(const SequenceKey& sequenceKey)
+{
+    Shard& shard = _shards[getShardIndex(sequenceKey)];
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    SequenceKeyData& data = shard._contexts[sequenceKey];
+    if (!data._pendingPermits)
+    {
+        data._pendingPermits = std::make_shared<Semaphore>(_maxPendingTaskCountPerKey);
+    }
+    return data._pendingPermits;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::releasePermit()
+{
+    if (_maxPendingTaskCount != 0)
+    {
+        _pendingPermits.release();
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::releaseKeyPermit(const SequenceKeyData& data)
+{
+    if (data._pendingPermits)
+    {
+        data._pendingPermits->release();
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postSequenceKey(
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    const SequenceKey& sequenceKey,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    Shard& shard = _shards[getShardIndex(sequenceKey)];
+    bool isDispatched = false;
+    bool isTrimDue = false;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(shard._lock);
+        isTrimDue = this->isTrimDue(shard);
+        isDispatched = _isDirectDispatch && (shard._numScheduling == 0);
+        if (isDispatched)
+        {
+            // nothing posted earlier is still waiting on the control queue so the task can be scheduled right away
+            directDispatch(shard,
+                           opaque,
+                           queueId,
+                           isHighPriority,
+                           sequenceKey,
+                           std::forward<FUNC>(func),
+                           std::forward<ARGS>(args)...);
+        }
+        else
+        {
+            ++shard._numScheduling;
+        }
+    }
+    if (!isDispatched)
+    {
+        _dispatcher.post<int>(shard._queueId,
+                              false,
+                              singleSequenceKeyTaskScheduler<FUNC, ARGS...>,
+                              std::move(opaque),
+                              std::move(queueId),
+                              std::move(isHighPriority),
+                              *this,
+                              Clock::now(),
+                              shard,
+                              SequenceKey(sequenceKey),
+                              std::forward<FUNC>(func),
+                              std::forward<ARGS>(args)...);
+    }
+    if (isTrimDue)
+    {
+        postTrim(shard);
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::directDispatch(
+    Shard& shard,
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    const SequenceKey& sequenceKey,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    // find the dependent
+    typename ContextMap::iterator contextIt = shard._contexts.find(sequenceKey);
+    if (contextIt == shard._contexts.end())
+    {
+        contextIt = shard._contexts.emplace(sequenceKey, SequenceKeyData()).first;
+    }
+    SequenceKeyData& data = contextIt->second;
+    // update stats
+    data._stats->incrementPostedTaskCount();
+    data._stats->incrementPendingTaskCount();
+    trackHotKey(shard, _hotKeyCapacity, sequenceKey, data._stats);
+    // update task stats
+    _taskStats->incrementPostedTaskCount();
+    _taskStats->incrementPendingTaskCount();
+    
+    using Link = ChainLink<Capture<FUNC, ARGS...>>;
+    SequenceKeyChain::LinkPtr link(new Link(*this,
+                                            opaque,
+                                            queueId,
+                                            isHighPriority,
+                                            data._stats,
+                                            data._pendingPermits,
+                                            enterEpoch(shard),
+                                            makeCapture(std::forward<FUNC>(func), std::forward<ARGS>(args)...)));
+    // posted now if the key was idle, or when the running task completes
+    getChain(nullptr, shard, data, queueId, isHighPriority)->append(link);
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+SequenceKeyChain::Ptr
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getChain(
+    const CoroContextPtr<int>& ctx,
+    Shard& shard,
+    SequenceKeyData& data,
+    int queueId,
+    bool isHighPriority)
+{
+    bool isCurrent = isCurrentEpoch(shard, data);
+    if (isCurrent && data._chain)
+    {
+        return data._chain;
+    }
+    // Start a new chain. If the key was used by a cross-shard task or if a universal task was posted since the
+    // last task of the key, the chain is held by a single coroutine until they complete.
+    ICoroContextBasePtr universalDependent = isCurrent ? nullptr : shard._universalContext._context;
+    bool isBlocked = data._context || data._chain || universalDependent;
+    SequenceKeyChain::Ptr chain = std::make_shared<SequenceKeyChain>(isBlocked);
+    if (isBlocked && ctx)
+    {
+        ctx->post<int>(std::move(queueId),
+                       std::move(isHighPriority),
+                       waitForChainDependents,
+                       closeChain(data),
+                       std::move(universalDependent),
+                       SequenceKeyChain::Ptr(chain));
+    }
+    else if (isBlocked)
+    {
+        _dispatcher.post<int>(std::move(queueId),
+                              std::move(isHighPriority),
+                              waitForChainDependents,
+                              closeChain(data),
+                              std::move(universalDependent),
+                              SequenceKeyChain::Ptr(chain));
+    }
+    data._context.reset();
+    data._chain = chain;
+    data._epoch = shard._epochNumber;
+    return chain;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postSequenceKeys(
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    const std::vector<SequenceKey>& sequenceKeys,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    // group the keys by shard
+    std::vector<std::vector<SequenceKey>> shardKeys;
+    size_t numShards = 0;
+    size_t shardIndex = 0;
+    if (_shards.size() > 1)
+    {
+        shardKeys.resize(_shards.size());
+        for (const SequenceKey& sequenceKey : sequenceKeys)
+        {
+            size_t index = getShardIndex(sequenceKey);
+            if (shardKeys[index].empty())
+            {
+                ++numShards;
+                shardIndex = index;
+            }
+            shardKeys[index].push_back(sequenceKey);
+        }
+    }
+    if (numShards <= 1)
+    {
+        // the shard can schedule the task on its own
+        bool isTrimDue = false;
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_shards[shardIndex]._lock);
+            isTrimDue = this->isTrimDue(_shards[shardIndex]);
+            ++_shards[shardIndex]._numScheduling;
+        }
+        _dispatcher.post<int>(_shards[shardIndex]._queueId,
+                              false,
+                              multiSequenceKeyTaskScheduler<FUNC, ARGS...>,
+                              std::move(opaque),
+                              std::move(queueId),
+                              std::move(isHighPriority),
+                              *this,
+                              Clock::now(),
+                              _shards[shardIndex],
+                              std::vector<SequenceKey>(sequenceKeys),
+                              std::forward<FUNC>(func),
+                              std::forward<ARGS>(args)...);
+        if (isTrimDue)
+        {
+            postTrim(_shards[shardIndex]);
+        }
+        return;
+    }
+    // update task stats
+    _taskStats->incrementPostedTaskCount();
+    _taskStats->incrementPendingTaskCount();
+    
+    // the task waits until each shard has added the dependents of its keys
+    CrossShardDependentsPtr dependents = std::make_shared<CrossShardDependents>(numShards);
+    // the posted context is also a coroutine context which the next tasks can wait on
+    ICoroContextBasePtr taskCtx = std::static_pointer_cast<Context<int>>(_dispatcher.post<int>(
+            std::move(queueId),
+            std::move(isHighPriority),
+            waitForCrossShardDependents<FUNC, ARGS...>,
+            std::move(opaque),
+            *this,
+            Clock::now(),
+            CrossShardDependentsPtr(dependents),
+            StatsPtr(),
+            std::forward<FUNC>(func),
+            std::forward<ARGS>(args)...));
+    
+    //========================= LOCKED SCOPE =========================
+    // all the shards must see the cross-shard posts in the same order, otherwise two tasks could wait on each other
+    std::lock_guard<std::mutex> lock(_crossShardMutex);
+    for (size_t i = 0; i < _shards.size(); ++i)
+    {
+        if (!shardKeys[i].empty())
+        {
+            bool isTrimDue = false;
+            {
+                //========================= LOCKED SCOPE =========================
+                SpinLock::Guard shardLock(_shards[i]._lock);
+                isTrimDue = this->isTrimDue(_shards[i]);
+                ++_shards[i]._numScheduling;
+            }
+            _dispatcher.post<int>(_shards[i]._queueId,
+                                  false,
+                                  crossShardKeyCollector,
+                                  _shards[i],
+                                  std::move(shardKeys[i]),
+                                  CrossShardDependentsPtr(dependents),
+                                  ICoroContextBasePtr(taskCtx));
+            if (isTrimDue)
+            {
+                postTrim(_shards[i]);
+            }
+        }
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postUniversal(
+    void* opaque,
+    int queueId,
+    bool isHighPriority,
+    FUNC&& func,
+    ARGS&&... args)
+{
+    if (_shards.size() == 1)
+    {
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_shards.front()._lock);
+            ++_shards.front()._numScheduling;
+        }
+        _dispatcher.post<int>(_shards.front()._queueId,
+                              false,
+                              universalTaskScheduler<FUNC, ARGS...>,
+                              std::move(opaque),
+                              std::move(queueId),
+                              std::move(isHighPriority),
+                              *this,
+                              Clock::now(),
+                              _shards.front(),
+                              std::forward<FUNC>(func),
+                              std::forward<ARGS>(args)...);
+        return;
+    }
+    // update the universal stats only
+    _universalContext._stats->incrementPostedTaskCount();
+    _universalContext._stats->incrementPendingTaskCount();
+    // update task stats
+    _taskStats->incrementPostedTaskCount();
+    _taskStats->incrementPendingTaskCount();
+    
+    // the task waits until every shard has added its pending keys
+    CrossShardDependentsPtr dependents = std::make_shared<CrossShardDependents>(_shards.size());
+    // the posted context is also a coroutine context which the next tasks can wait on
+    ICoroContextBasePtr taskCtx = std::static_pointer_cast<Context<int>>(_dispatcher.post<int>(
+            std::move(queueId),
+            std::move(isHighPriority),
+            waitForCrossShardDependents<FUNC, ARGS...>,
+            std::move(opaque),
+            *this,
+            Clock::now(),
+            CrossShardDependentsPtr(dependents),
+            StatsPtr(_universalContext._stats),
+            std::forward<FUNC>(func),
+            std::forward<ARGS>(args)...));
+    
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_crossShardMutex);
+    for (Shard& shard : _shards)
+    {
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard shardLock(shard._lock);
+            ++shard._numScheduling;
+        }
+        _dispatcher.post<int>(shard._queueId,
+                              false,
+                              crossShardUniversalCollector,
+                              shard,
+                              CrossShardDependentsPtr(dependents),
+                              ICoroContextBasePtr(taskCtx));
+    }
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::trimSequenceKeys()
+{
+    std::vector<ThreadContextPtr<size_t>> results;
+    results.reserve(_shards.size());
+    for (Shard& shard : _shards)
+    {
+        auto trimFunc = [&shard](CoroContextPtr<size_t> ctx)->int
+        {
+            size_t size = 0;
+            {
+                //========================= LOCKED SCOPE =========================
+                SpinLock::Guard lock(shard._lock);
+                for (auto it = shard._contexts.begin(); it != shard._contexts.end();)
+                {
+                    auto trimIt = it++;
+                    if (canTrimContext(ctx, trimIt->second._context) &&
+                        (!trimIt->second._chain || trimIt->second._chain->isIdle()))
+                    {
+                        shard._contexts.erase(trimIt);
+                    }
+                }
+                size = shard._contexts.size();
+            }
+            //The caller may destroy the sequencer as soon as the result is set
+            return ctx->set(size);
+        };
+        results.push_back(_dispatcher.post<size_t>(shard._queueId, true, std::move(trimFunc)));
+    }
+    size_t count = 0;
+    for (auto& result : results)
+    {
+        count += result->get();
+    }
+    return count;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+SequenceKeyStatistics
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getStatistics(const SequenceKey& sequenceKey)
+{
+    Shard& shard = _shards[getShardIndex(sequenceKey)];
+    auto statsFunc = [&shard, sequenceKey](CoroContextPtr<SequenceKeyStatistics> ctx)->int
+    {
+        SequenceKeyStatistics stats;
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(shard._lock);
+            typename ContextMap::iterator ctxIt = shard._contexts.find(sequenceKey);
+            if (ctxIt != shard._contexts.end())
+            {
+                stats = *ctxIt->second._stats;
+            }
+        }
+        //The caller may destroy the sequencer as soon as the result is set
+        return ctx->set(std::move(stats));
+    };
+    return _dispatcher.post<SequenceKeyStatistics>(shard._queueId, true, std::move(statsFunc))->get();
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+SequenceKeyStatistics
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getStatistics()
+{
+    return *_universalContext._stats;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+SequenceKeyStatistics
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getTaskStatistics()
+{
+    return *_taskStats;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::collectMetrics(MetricsSnapshot::Gauges& gauges)
+{
+    const SequenceKeyStatistics& stats = *_taskStats;
+    gauges["postedTaskCount"] = stats.getPostedTaskCount();
+    gauges["pendingTaskCount"] = stats.getPendingTaskCount();
+    gauges["completedTaskCount"] = stats.getCompletedTaskCount();
+    gauges["avgQueueingDelayUs"] = stats.getAverageQueueingDelay().count();
+    gauges["maxQueueingDelayUs"] = stats.getMaxQueueingDelay().count();
+    gauges["avgExecutionTimeUs"] = stats.getAverageExecutionTime().count();
+    gauges["maxExecutionTimeUs"] = stats.getMaxExecutionTime().count();
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+std::vector<std::pair<SequenceKey, SequenceKeyStatistics>>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getHotKeys(size_t maxKeys, HotKeyOrder order)
+{
+    std::vector<std::pair<SequenceKey, SequenceKeyStatistics>> hotKeys;
+    for (Shard& shard : _shards)
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(shard._lock);
+        for (const HotKey& hotKey : shard._hotKeys)
+        {
+            hotKeys.emplace_back(hotKey._key, SequenceKeyStatistics(*hotKey._stats));
+        }
+    }
+    using Entry = std::pair<SequenceKey, SequenceKeyStatistics>;
+    auto isHotter = [order](const Entry& lhs, const Entry& rhs)->bool
+    {
+        if (order == HotKeyOrder::QueueingDelay)
+        {
+            return lhs.second.getAverageQueueingDelay() > rhs.second.getAverageQueueingDelay();
+        }
+        return lhs.second.getPendingTaskCount() > rhs.second.getPendingTaskCount();
+    };
+    if (hotKeys.size() > maxKeys)
+    {
+        std::partial_sort(hotKeys.begin(), hotKeys.begin() + maxKeys, hotKeys.end(), isHotter);
+        hotKeys.erase(hotKeys.begin() + maxKeys, hotKeys.end());
+    }
+    else
+    {
+        std::sort(hotKeys.begin(), hotKeys.end(), isHotter);
+    }
+    return hotKeys;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+size_t
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getSequenceKeyCount()
+{
+    std::vector<ThreadContextPtr<size_t>> results;
+    results.reserve(_shards.size());
+    for (Shard& shard : _shards)
+    {
+        auto statsFunc = [&shard](CoroContextPtr<size_t> ctx)->int
+        {
+            size_t size = 0;
+            {
+                //========================= LOCKED SCOPE =========================
+                SpinLock::Guard lock(shard._lock);
+                size = shard._contexts.size();
+            }
+            //The caller may destroy the sequencer as soon as the result is set
+            return ctx->set(size);
+        };
+        results.push_back(_dispatcher.post<size_t>(shard._queueId, true, std::move(statsFunc)));
+    }
+    size_t count = 0;
+    for (auto& result : results)
+    {
+        count += result->get();
+    }
+    return count;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForTwoDependents(
+        CoroContextPtr<int> ctx,
+        void* opaque,
+        Sequencer& sequencer,
+        TimePoint postTime,
+        EpochPtr epoch,
+        SequenceKeyData&& dependent,
+        ICoroContextBasePtr universalDependent,
+        FUNC&& func,
+        ARGS&&... args)
+{
+    // wait until all the dependents are done
+    waitForDependent(ctx, dependent);
+    if (universalDependent)
+    {
+        universalDependent->wait(ctx);
+    }
+    // update task stats
+    dependent._stats->decrementPendingTaskCount();
+    releaseKeyPermit(dependent);
+    sequencer._taskStats->decrementPendingTaskCount();
+    sequencer.releasePermit();
+    TimePoint startTime = Clock::now();
+    callPosted(ctx, opaque, sequencer, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    TimePoint endTime = Clock::now();
+    recordCompletedTask(*dependent._stats, postTime, startTime, endTime);
+    recordCompletedTask(*sequencer._taskStats, postTime, startTime, endTime);
+    epoch->leave();
+    return 0;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForUniversalDependent(
+        CoroContextPtr<int> ctx,
+        void* opaque,
+        Sequencer& sequencer,
+        TimePoint postTime,
+        EpochPtr previousEpoch,
+        EpochPtr epoch,
+        StatsPtr stats,
+        FUNC&& func,
+        ARGS&&... args)
+{
+    // wait until all the tasks posted before, including the previous universal task, are done
+    previousEpoch->wait(ctx);
+    stats->decrementPendingTaskCount();
+    // update task stats
+    sequencer._taskStats->decrementPendingTaskCount();
+    sequencer.releasePermit();
+    TimePoint startTime = Clock::now();
+    callPosted(ctx, opaque, sequencer, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    TimePoint endTime = Clock::now();
+    recordCompletedTask(*stats, postTime, startTime, endTime);
+    recordCompletedTask(*sequencer._taskStats, postTime, startTime, endTime);
+    epoch->leave();
+    return 0;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class FUNC, class ... ARGS>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForCrossShardDependents(
+        CoroContextPtr<int> ctx,
+        void* opaque,
+        Sequencer& sequencer,
+        TimePoint postTime,
+        CrossShardDependentsPtr dependents,
+        StatsPtr stats,
+        FUNC&& func,
+        ARGS&&... args)
+{
+    // wait until all the shards have collected the dependents
+    dependents->_latch.wait(ctx);
+    // wait until all the dependents are done
+    for (const auto& dependent : dependents->_dependents)
+    {
+        waitForDependent(ctx, dependent);
+    }
+    for (const auto& dependent : dependents->_universalDependents)
+    {
+        dependent->wait(ctx);
+    }
+    for (const auto& epoch : dependents->_previousEpochs)
+    {
+        epoch->wait(ctx);
+    }
+    //update stats
+    for (const auto& dependent : dependents->_dependents)
+    {
+        dependent._stats->decrementPendingTaskCount();
+        releaseKeyPermit(dependent);
+    }
+    if (stats)
+    {
+        stats->decrementPendingTaskCount();
+    }
+    // update task stats
+    sequencer._taskStats->decrementPendingTaskCount();
+    sequencer.releasePermit();
+    TimePoint startTime = Clock::now();
+    callPosted(ctx, opaque, sequencer, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    TimePoint endTime = Clock::now();
+    for (const auto& dependent : dependents->_dependents)
+    {
+        recordCompletedTask(*dependent._stats, postTime, startTime, endTime);
+    }
+    if (stats)
+    {
+        recordCompletedTask(*stats, postTime, startTime, endTime);
+    }
+    recordCompletedTask(*sequencer._taskStats, postTime, startTime, endTime);
+    for (const auto& epoch : dependents->_epochs)
+    {
+        epoch->leave();
+    }
+    return 0;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class CAPTURE>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::ChainLink<CAPTURE>::ChainLink(Sequencer& sequencer,
+                                                                          void* opaque,
+                                                                          int queueId,
+                                                                          bool isHighPriority,
+                                                                          StatsPtr stats,
+                                                                          std::shared_ptr<Semaphore> permits,
+                                                                          EpochPtr epoch,
+                                                                          CAPTURE&& capture) :
+    _sequencer(sequencer),
+    _opaque(opaque),
+    _queueId(queueId),
+    _isHighPriority(isHighPriority),
+    _postTime(Clock::now()),
+    _stats(std::move(stats)),
+    _permits(std::move(permits)),
+    _epoch(std::move(epoch)),
+    _capture(std::move(capture))
+{
 }
- 
+
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-template <class FUNC, class ... ARGS>
+template <class CAPTURE>
 void
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postAll(FUNC&& func, ARGS&&... args)
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::ChainLink<CAPTURE>::post(const SequenceKeyChain::Ptr& chain,
+                                                                    const CoroContextPtr<int>& ctx)
 {
-    _dispatcher.post<int>(_controllerQueueId,
-                          false,
-                          universalTaskScheduler<FUNC, ARGS...>,
-                          nullptr,
-                          (int)IQueue::QueueId::Any,
-                          false,
-                          *this,
-                          std::forward<FUNC>(func),
-                          std::forward<ARGS>(args)...);
+    if (ctx)
+    {
+        // posted by the previous task of the key, which is allowed while the dispatcher drains
+        ctx->template post<int>(_queueId,
+                                _isHighPriority,
+                                runChainLink<CAPTURE>,
+                                std::move(_opaque),
+                                std::move(_queueId),
+                                _sequencer,
+                                std::move(_postTime),
+                                std::move(_stats),
+                                std::move(_permits),
+                                std::move(_epoch),
+                                SequenceKeyChain::Ptr(chain),
+                                std::move(_capture));
+        return;
+    }
+    _sequencer._dispatcher.template post<int>(_queueId,
+                                              _isHighPriority,
+                                              runChainLink<CAPTURE>,
+                                              std::move(_opaque),
+                                              std::move(_queueId),
+                                              _sequencer,
+                                              std::move(_postTime),
+                                              std::move(_stats),
+                                              std::move(_permits),
+                                              std::move(_epoch),
+                                              SequenceKeyChain::Ptr(chain),
+                                              std::move(_capture));
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-template <class FUNC, class ... ARGS>
+template <class CAPTURE>
 void
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postAll(
-    void* opaque,
-    int queueId,
-    bool isHighPriority,
-    FUNC&& func,
-    ARGS&&... args)
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::ChainLink<CAPTURE>::run(const CoroContextPtr<int>& ctx)
 {
-    if (queueId < (int)IQueue::QueueId::Any)
+    // update stats
+    _stats->decrementPendingTaskCount();
+    if (_permits)
     {
-        throw std::runtime_error("Invalid IO queue id");
+        _permits->release();
     }
-    _dispatcher.post<int>(_controllerQueueId,
-                          false,
-                          universalTaskScheduler<FUNC, ARGS...>,
-                          std::move(opaque),
-                          std::move(queueId),
-                          std::move(isHighPriority),
-                          *this,
-                          std::forward<FUNC>(func),
-                          std::forward<ARGS>(args)...);
+    // update task stats
+    _sequencer._taskStats->decrementPendingTaskCount();
+    _sequencer.releasePermit();
+    // the previous task of the batch has already set the value of the coroutine
+    Util::resetPromise<int>(ctx);
+    TimePoint startTime = Clock::now();
+    callPosted(ctx, _opaque, _sequencer, std::move(_capture));
+    TimePoint endTime = Clock::now();
+    recordCompletedTask(*_stats, _postTime, startTime, endTime);
+    recordCompletedTask(*_sequencer._taskStats, _postTime, startTime, endTime);
+    _epoch->leave();
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-size_t
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::trimSequenceKeys()
+template <class CAPTURE>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::ChainLink<CAPTURE>::getQueueId() const
+{
+    return _queueId;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class CAPTURE>
+bool
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::ChainLink<CAPTURE>::canRunInline() const
+{
+    return true;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class CAPTURE>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::runChainLink(
+        CoroContextPtr<int> ctx,
+        void* opaque,
+        int queueId,
+        Sequencer& sequencer,
+        TimePoint postTime,
+        StatsPtr stats,
+        std::shared_ptr<Semaphore> permits,
+        EpochPtr epoch,
+        SequenceKeyChain::Ptr chain,
+        CAPTURE&& capture)
 {
-    auto trimFunc = [this](CoroContextPtr<size_t> ctx)->int
+    // update stats
+    stats->decrementPendingTaskCount();
+    if (permits)
+    {
+        permits->release();
+    }
+    // update task stats
+    sequencer._taskStats->decrementPendingTaskCount();
+    sequencer.releasePermit();
+    TimePoint startTime = Clock::now();
+    callPosted(ctx, opaque, sequencer, std::forward<CAPTURE>(capture));
+    TimePoint endTime = Clock::now();
+    recordCompletedTask(*stats, postTime, startTime, endTime);
+    recordCompletedTask(*sequencer._taskStats, postTime, startTime, endTime);
+    epoch->leave();
+    // drain the tasks already waiting for this key without switching coroutines
+    for (size_t batchSize = 1; batchSize < sequencer._maxBatchSize; ++batchSize)
     {
-        for (auto it = _contexts.begin(); it != _contexts.end();)
+        SequenceKeyChain::LinkPtr link = chain->pop(queueId);
+        if (!link)
         {
-            auto trimIt = it++;
-            if (canTrimContext(ctx, trimIt->second._context))
-            {
-                _contexts.erase(trimIt);
-            }
+            break;
         }
-        return ctx->set(_contexts.size());
-    };
-    return _dispatcher.post<size_t>(_controllerQueueId, true, std::move(trimFunc))->get();
+        link->run(ctx);
+    }
+    // post the next task of the key, if any
+    chain->next(ctx);
+    return 0;
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-SequenceKeyStatistics
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getStatistics(const SequenceKey& sequenceKey)
+template <class CAPTURE>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::KeyJoin<CAPTURE>::KeyJoin(Sequencer& sequencer,
+                                                                      void* opaque,
+                                                                      int queueId,
+                                                                      bool isHighPriority,
+                                                                      TimePoint postTime,
+                                                                      EpochPtr epoch,
+                                                                      CAPTURE&& capture) :
+    _sequencer(sequencer),
+    _opaque(opaque),
+    _queueId(queueId),
+    _isHighPriority(isHighPriority),
+    _postTime(postTime),
+    _epoch(std::move(epoch)),
+    _capture(std::move(capture))
+{
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class CAPTURE>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::KeyJoin<CAPTURE>::arrive(const CoroContextPtr<int>& ctx)
 {
-    auto statsFunc = [this, sequenceKey](CoroContextPtr<SequenceKeyStatistics> ctx)->int
+    if (_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
     {
-        typename ContextMap::iterator ctxIt = _contexts.find(sequenceKey);
-        if (ctxIt == _contexts.end())
-        {
-            return ctx->set(SequenceKeyStatistics());
-        }
-        return ctx->set(SequenceKeyStatistics(*ctxIt->second._stats));
-    };
-    return _dispatcher.post<SequenceKeyStatistics>(_controllerQueueId, true, std::move(statsFunc))->get();
+        return; // still waiting for the previous task of another key
+    }
+    if (ctx)
+    {
+        ctx->template post<int>(_queueId,
+                                _isHighPriority,
+                                runKeyJoin<CAPTURE>,
+                                this->shared_from_this());
+        return;
+    }
+    _sequencer._dispatcher.template post<int>(_queueId,
+                                              _isHighPriority,
+                                              runKeyJoin<CAPTURE>,
+                                              this->shared_from_this());
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-SequenceKeyStatistics
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getStatistics()
+template <class CAPTURE>
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::JoinLink<CAPTURE>::JoinLink(std::shared_ptr<KeyJoin<CAPTURE>> join) :
+    _join(std::move(join))
 {
-    return *_universalContext._stats;
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-SequenceKeyStatistics
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getTaskStatistics()
+template <class CAPTURE>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::JoinLink<CAPTURE>::post(const SequenceKeyChain::Ptr&,
+                                                                   const CoroContextPtr<int>& ctx)
 {
-    return *_taskStats;
+    // the chain is resumed by the joined task
+    _join->arrive(ctx);
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-size_t
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::getSequenceKeyCount()
+template <class CAPTURE>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::JoinLink<CAPTURE>::run(const CoroContextPtr<int>&)
 {
-    auto statsFunc = [this](CoroContextPtr<size_t> ctx)->int
-    {
-        return ctx->set(_contexts.size());
-    };
-    return _dispatcher.post<size_t>(_controllerQueueId, true, std::move(statsFunc))->get();
+    // never called since the task cannot run inline
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-template <class FUNC, class ... ARGS>
+template <class CAPTURE>
 int
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForTwoDependents(
-        CoroContextPtr<int> ctx,
-        void* opaque,
-        Sequencer& sequencer,
-        SequenceKeyData&& dependent,
-        SequenceKeyData&& universalDependent,
-        FUNC&& func,
-        ARGS&&... args)
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::JoinLink<CAPTURE>::getQueueId() const
 {
-    // wait until all the dependents are done
-    if (dependent._context)
-    {
-        dependent._context->wait(ctx);
-    }
-    if (universalDependent._context)
-    {
-        universalDependent._context->wait(ctx);
-    }
-    // update task stats
-    dependent._stats->decrementPendingTaskCount();
-    sequencer._taskStats->decrementPendingTaskCount();
-    callPosted(ctx, opaque, sequencer, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
-    return 0;
+    return _join->_queueId;
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-template <class FUNC, class ... ARGS>
+template <class CAPTURE>
+bool
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::JoinLink<CAPTURE>::canRunInline() const
+{
+    return false;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+template <class CAPTURE>
 int
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForDependents(
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::runKeyJoin(
         CoroContextPtr<int> ctx,
-        void* opaque,
-        Sequencer& sequencer,
-        std::vector<SequenceKeyData>&& dependents,
-        SequenceKeyData&& universalDependent,
-        FUNC&& func,
-        ARGS&&... args)
+        std::shared_ptr<KeyJoin<CAPTURE>> join)
 {
-    // wait until all the dependents are done
-    for (const auto& dependent : dependents)
-    {
-        if (dependent._context)
-        {
-            dependent._context->wait(ctx);
-        }
-    }
-    //wait until the universal dependent is done
-    if (universalDependent._context)
-    {
-        universalDependent._context->wait(ctx);
-    }
+    Sequencer& sequencer = join->_sequencer;
     //update stats
-    for (const auto& dependent : dependents)
+    for (const auto& dependent : join->_dependents)
     {
         dependent._stats->decrementPendingTaskCount();
+        releaseKeyPermit(dependent);
     }
     // update task stats
     sequencer._taskStats->decrementPendingTaskCount();
-    callPosted(ctx, opaque, sequencer, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    sequencer.releasePermit();
+    TimePoint startTime = Clock::now();
+    callPosted(ctx, join->_opaque, sequencer, std::move(join->_capture));
+    TimePoint endTime = Clock::now();
+    for (const auto& dependent : join->_dependents)
+    {
+        recordCompletedTask(*dependent._stats, join->_postTime, startTime, endTime);
+    }
+    recordCompletedTask(*sequencer._taskStats, join->_postTime, startTime, endTime);
+    join->_epoch->leave();
+    // post the next task of each key, if any
+    for (const auto& chain : join->_chains)
+    {
+        chain->next(ctx);
+    }
     return 0;
 }
 
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
-template <class FUNC, class ... ARGS>
 int
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForUniversalDependent(
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForChainDependents(
         CoroContextPtr<int> ctx,
-        void* opaque,
-        Sequencer& sequencer,
-        std::vector<SequenceKeyData>&& dependents,
-        SequenceKeyData&& universalDependent,
-        FUNC&& func,
-        ARGS&&... args)
+        SequenceKeyData&& dependent,
+        ICoroContextBasePtr universalDependent,
+        SequenceKeyChain::Ptr chain)
 {
-    // wait until all the dependents are done
-    for (const auto& dependent : dependents)
-    {
-        if (dependent._context)
-        {
-            dependent._context->wait(ctx);
-        }
-    }
-    //wait until the universal dependent is done
-    if (universalDependent._context)
+    waitForDependent(ctx, dependent);
+    if (universalDependent)
     {
-        universalDependent._context->wait(ctx);
+        universalDependent->wait(ctx);
     }
-    universalDependent._stats->decrementPendingTaskCount();
-    // update task stats
-    sequencer._taskStats->decrementPendingTaskCount();
-    callPosted(ctx, opaque, sequencer, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    // start the chain
+    chain->next(ctx);
     return 0;
 }
 
@@ -344,32 +1266,46 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::singleSequenceKeyTaskSchedule
         int queueId,
         bool isHighPriority,
         Sequencer& sequencer,
+        TimePoint postTime,
+        Shard& shard,
         SequenceKey&& sequenceKey,
         FUNC&& func,
         ARGS&&... args)
 {
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    --shard._numScheduling;
     // find the dependent
-    typename ContextMap::iterator contextIt = sequencer._contexts.find(sequenceKey);
-    if (contextIt == sequencer._contexts.end())
+    typename ContextMap::iterator contextIt = shard._contexts.find(sequenceKey);
+    if (contextIt == shard._contexts.end())
     {
-        contextIt = sequencer._contexts.emplace(sequenceKey, SequenceKeyData()).first;
+        contextIt = shard._contexts.emplace(sequenceKey, SequenceKeyData()).first;
     }
     // update stats
     contextIt->second._stats->incrementPostedTaskCount();
     contextIt->second._stats->incrementPendingTaskCount();
+    trackHotKey(shard, sequencer._hotKeyCapacity, sequenceKey, contextIt->second._stats);
     // update task stats
     sequencer._taskStats->incrementPostedTaskCount();
     sequencer._taskStats->incrementPendingTaskCount();
     
+    // only the first task of the key since the last universal task has to wait for it
+    ICoroContextBasePtr universalDependent =
+        isCurrentEpoch(shard, contextIt->second) ? nullptr : shard._universalContext._context;
+    contextIt->second._epoch = shard._epochNumber;
+    
     // save the context as the last for this sequenceKey
+    SequenceKeyData dependent = closeChain(contextIt->second);
     contextIt->second._context = ctx->post<int>(
             std::move(queueId),
             std::move(isHighPriority),
             waitForTwoDependents<FUNC, ARGS...>,
             std::move(opaque),
             sequencer,
-            SequenceKeyData(contextIt->second),
-            SequenceKeyData(sequencer._universalContext),
+            std::move(postTime),
+            enterEpoch(shard),
+            std::move(dependent),
+            std::move(universalDependent),
             std::forward<FUNC>(func),
             std::forward<ARGS>(args)...);
     return 0;
@@ -384,45 +1320,54 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::multiSequenceKeyTaskScheduler
     int queueId,
     bool isHighPriority,
     Sequencer& sequencer,
+    TimePoint postTime,
+    Shard& shard,
     std::vector<SequenceKey>&& sequenceKeys,
     FUNC&& func,
     ARGS&&... args)
 {
-    // construct the dependent collection
-    std::vector<SequenceKeyData> dependents;
-    dependents.reserve(sequenceKeys.size());
-    dependents.push_back(sequencer._universalContext);
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    --shard._numScheduling;
+    using Join = KeyJoin<Capture<FUNC, ARGS...>>;
+    std::shared_ptr<Join> join = std::make_shared<Join>(sequencer,
+                                                        opaque,
+                                                        queueId,
+                                                        isHighPriority,
+                                                        postTime,
+                                                        enterEpoch(shard),
+                                                        makeCapture(std::forward<FUNC>(func),
+                                                                    std::forward<ARGS>(args)...));
+    join->_dependents.reserve(sequenceKeys.size());
+    join->_chains.reserve(sequenceKeys.size());
     for (const SequenceKey& sequenceKey : sequenceKeys)
     {
-        auto taskIt = sequencer._contexts.find(sequenceKey);
-        if (taskIt != sequencer._contexts.end())
+        auto taskIt = shard._contexts.find(sequenceKey);
+        if (taskIt != shard._contexts.end())
         {
             // add the dependent and increment stats
             taskIt->second._stats->incrementPostedTaskCount();
             taskIt->second._stats->incrementPendingTaskCount();
-            dependents.emplace_back(taskIt->second);
+            trackHotKey(shard, sequencer._hotKeyCapacity, sequenceKey, taskIt->second._stats);
+            join->_dependents.push_back(taskIt->second);
+        }
+        SequenceKeyData& data = (taskIt != shard._contexts.end()) ? taskIt->second : shard._contexts[sequenceKey];
+        SequenceKeyChain::Ptr chain = sequencer.getChain(ctx, shard, data, queueId, isHighPriority);
+        if (std::find(join->_chains.begin(), join->_chains.end(), chain) != join->_chains.end())
+        {
+            continue; // the key is listed twice
         }
+        join->_chains.push_back(chain);
+        join->_remaining.fetch_add(1, std::memory_order_relaxed);
+        SequenceKeyChain::LinkPtr link(new JoinLink<Capture<FUNC, ARGS...>>(join));
+        chain->append(link);
     }
     // update task stats
     sequencer._taskStats->incrementPostedTaskCount();
     sequencer._taskStats->incrementPendingTaskCount();
     
-    ICoroContextBasePtr newCtx = ctx->post<int>(
-            std::move(queueId),
-            std::move(isHighPriority),
-            waitForDependents<FUNC, ARGS...>,
-            std::move(opaque),
-            sequencer,
-            std::move(dependents),
-            SequenceKeyData(sequencer._universalContext),
-            std::forward<FUNC>(func),
-            std::forward<ARGS>(args)...);
-    
-    // save the context as the last for each sequenceKey
-    for (const SequenceKey& sequenceKey : sequenceKeys)
-    {
-        sequencer._contexts[sequenceKey]._context = newCtx;
-    }
+    // the task is posted here if all its keys were idle
+    join->arrive(ctx);
     return 0;
 }
 
@@ -435,42 +1380,111 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::universalTaskScheduler(
     int queueId,
     bool isHighPriority,
     Sequencer& sequencer,
+    TimePoint postTime,
+    Shard& shard,
     FUNC&& func,
     ARGS&&... args)
 {
-    // construct the dependent collection
-    std::vector<SequenceKeyData> dependents;
-    dependents.reserve(sequencer._contexts.size());
-    for (auto ctxIt = sequencer._contexts.begin(); ctxIt != sequencer._contexts.end(); ++ctxIt)
-    {
-        // check if the context still has a pending task
-        if (isPendingContext(ctx, ctxIt->second._context))
-        {
-            // we will need to wait on this context to finish its current running task
-            dependents.emplace_back(ctxIt->second);
-        }
-    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    --shard._numScheduling;
+    // the task waits for all the tasks of the current epoch and runs as part of the next one
+    EpochPtr previousEpoch = startEpoch(shard);
     // update the universal stats only
-    sequencer._universalContext._stats->incrementPostedTaskCount();
-    sequencer._universalContext._stats->incrementPendingTaskCount();
+    shard._universalContext._stats->incrementPostedTaskCount();
+    shard._universalContext._stats->incrementPendingTaskCount();
     // update task stats
     sequencer._taskStats->incrementPostedTaskCount();
     sequencer._taskStats->incrementPendingTaskCount();
 
     // post the task and save the context as the last for the universal sequenceKey
-    sequencer._universalContext._context = ctx->post<int>(
+    shard._universalContext._context = ctx->post<int>(
             std::move(queueId),
             std::move(isHighPriority),
             waitForUniversalDependent<FUNC, ARGS...>,
             std::move(opaque),
             sequencer,
-            std::move(dependents),
-            SequenceKeyData(sequencer._universalContext),
+            std::move(postTime),
+            std::move(previousEpoch),
+            enterEpoch(shard),
+            StatsPtr(shard._universalContext._stats),
             std::forward<FUNC>(func),
             std::forward<ARGS>(args)...);
     return 0;
 }
 
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::crossShardKeyCollector(
+    CoroContextPtr<int>,
+    Shard& shard,
+    std::vector<SequenceKey>&& sequenceKeys,
+    CrossShardDependentsPtr dependents,
+    ICoroContextBasePtr taskCtx)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    --shard._numScheduling;
+    std::vector<SequenceKeyData> keyDependents;
+    keyDependents.reserve(sequenceKeys.size());
+    bool isCurrent = false;
+    for (const SequenceKey& sequenceKey : sequenceKeys)
+    {
+        auto taskIt = shard._contexts.find(sequenceKey);
+        if (taskIt != shard._contexts.end())
+        {
+            // add the dependent and increment stats
+            taskIt->second._stats->incrementPostedTaskCount();
+            taskIt->second._stats->incrementPendingTaskCount();
+            isCurrent = isCurrent || isCurrentEpoch(shard, taskIt->second);
+            keyDependents.emplace_back(closeChain(taskIt->second));
+        }
+    }
+    // save the context as the last for each sequenceKey
+    for (const SequenceKey& sequenceKey : sequenceKeys)
+    {
+        SequenceKeyData& data = shard._contexts[sequenceKey];
+        data._context = taskCtx;
+        data._epoch = shard._epochNumber;
+    }
+    {
+        SpinLock::Guard dependentsLock(dependents->_lock);
+        dependents->_dependents.insert(dependents->_dependents.end(),
+                                       std::make_move_iterator(keyDependents.begin()),
+                                       std::make_move_iterator(keyDependents.end()));
+        if (!isCurrent && shard._universalContext._context)
+        {
+            dependents->_universalDependents.push_back(shard._universalContext._context);
+        }
+        dependents->_epochs.push_back(enterEpoch(shard));
+    }
+    dependents->_latch.countDown();
+    return 0;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::crossShardUniversalCollector(
+    CoroContextPtr<int>,
+    Shard& shard,
+    CrossShardDependentsPtr dependents,
+    ICoroContextBasePtr taskCtx)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    --shard._numScheduling;
+    EpochPtr previousEpoch = startEpoch(shard);
+    // save the context as the last for the universal sequenceKey
+    shard._universalContext._context = taskCtx;
+    {
+        SpinLock::Guard dependentsLock(dependents->_lock);
+        dependents->_previousEpochs.push_back(std::move(previousEpoch));
+        dependents->_epochs.push_back(enterEpoch(shard));
+    }
+    dependents->_latch.countDown();
+    return 0;
+}
+
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
 template <class FUNC, class ... ARGS>
 void
@@ -502,6 +1516,128 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::callPosted(
     }
 }
 
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::trackHotKey(Shard& shard,
+                                                               size_t capacity,
+                                                               const SequenceKey& sequenceKey,
+                                                               const StatsPtr& stats)
+{
+    // must be called with the shard lock held
+    if (capacity == 0)
+    {
+        return;
+    }
+    auto minIt = shard._hotKeys.end();
+    for (auto it = shard._hotKeys.begin(); it != shard._hotKeys.end(); ++it)
+    {
+        if (shard._contexts.key_eq()(it->_key, sequenceKey))
+        {
+            ++it->_count;
+            it->_stats = stats; //the key may have been trimmed and tracked again since
+            return;
+        }
+        if ((minIt == shard._hotKeys.end()) || (it->_count < minIt->_count))
+        {
+            minIt = it;
+        }
+    }
+    if (shard._hotKeys.size() < capacity)
+    {
+        shard._hotKeys.push_back({sequenceKey, 1, stats});
+        return;
+    }
+    // replace the least frequent candidate, inheriting its count as the possible error
+    minIt->_key = sequenceKey;
+    ++minIt->_count;
+    minIt->_stats = stats;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::recordCompletedTask(SequenceKeyStatisticsWriter& stats,
+                                                                       TimePoint postTime,
+                                                                       TimePoint startTime,
+                                                                       TimePoint endTime)
+{
+    stats.recordCompletedTask(std::chrono::duration_cast<std::chrono::microseconds>(startTime - postTime),
+                              std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime));
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+bool
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::isTrimDue(Shard& shard)
+{
+    // must be called with the shard lock held
+    if ((_trimInterval == 0) || (++shard._numPostsSinceTrim < _trimInterval))
+    {
+        return false;
+    }
+    shard._numPostsSinceTrim = 0;
+    ++shard._numTrimBatches;
+    if (shard._isTrimPending)
+    {
+        return false; // the pending pass will examine one more batch
+    }
+    shard._isTrimPending = true;
+    return true;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::postTrim(Shard& shard)
+{
+    _dispatcher.post<int>(shard._queueId,
+                          false,
+                          trimShard,
+                          shard,
+                          size_t(_trimBatchSize),
+                          size_t(_trimThreshold));
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+int
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::trimShard(CoroContextPtr<int> ctx,
+                                                             Shard& shard,
+                                                             size_t batchSize,
+                                                             size_t threshold)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(shard._lock);
+    size_t maxExamined = batchSize * shard._numTrimBatches;
+    shard._numTrimBatches = 0;
+    shard._isTrimPending = false;
+    if (shard._contexts.size() <= threshold)
+    {
+        return 0;
+    }
+    // examine whole buckets, resuming at the one where the previous pass stopped
+    std::vector<SequenceKey> trimmedKeys;
+    size_t numBuckets = shard._contexts.bucket_count();
+    size_t numExamined = 0;
+    for (size_t i = 0; (i < numBuckets) && (numExamined < maxExamined); ++i)
+    {
+        size_t bucket = shard._trimBucket++ % numBuckets;
+        for (auto it = shard._contexts.begin(bucket); it != shard._contexts.end(bucket); ++it, ++numExamined)
+        {
+            if (canTrimContext(ctx, it->second._context) && (!it->second._chain || it->second._chain->isIdle()))
+            {
+                trimmedKeys.push_back(it->first);
+            }
+        }
+    }
+    shard._trimBucket %= numBuckets;
+    for (const SequenceKey& sequenceKey : trimmedKeys)
+    {
+        if (shard._contexts.size() <= threshold)
+        {
+            break;
+        }
+        shard._contexts.erase(sequenceKey);
+    }
+    return 0;
+}
+
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
 bool
 Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::canTrimContext(const ICoroContextBasePtr& ctx,
@@ -511,14 +1647,61 @@ Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::canTrimContext(const ICoroCon
            ctxToValidate->waitFor(ctx, std::chrono::milliseconds(0)) == std::future_status::ready;
 }
 
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+void
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::waitForDependent(const ICoroContextBasePtr& ctx,
+                                                                   const SequenceKeyData& dependent)
+{
+    if (dependent._context)
+    {
+        dependent._context->wait(ctx);
+    }
+    if (dependent._chain)
+    {
+        dependent._chain->wait(ctx);
+    }
+}
+
 template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
 bool
-Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::isPendingContext(const ICoroContextBasePtr& ctx,
-                                                                    const ICoroContextBasePtr& ctxToValidate)
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::isCurrentEpoch(const Shard& shard, const SequenceKeyData& data)
+{
+    return data._epoch == shard._epochNumber;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+typename Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::EpochPtr
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::enterEpoch(Shard& shard)
+{
+    shard._epoch->enter();
+    return shard._epoch;
+}
+
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+typename Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::EpochPtr
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::startEpoch(Shard& shard)
 {
-    return ctxToValidate && ctxToValidate->valid() &&
-           ctxToValidate->waitFor(ctx, std::chrono::milliseconds(0)) == std::future_status::timeout;
+    EpochPtr previousEpoch = std::move(shard._epoch);
+    shard._epoch = std::make_shared<Epoch>();
+    ++shard._epochNumber;
+    // the previous epoch completes once its remaining tasks are done
+    previousEpoch->leave();
+    return previousEpoch;
 }
 
+template <class SequenceKey, class Hash, class KeyEqual, class Allocator>
+SequenceKeyData
+Sequencer<SequenceKey, Hash, KeyEqual, Allocator>::closeChain(SequenceKeyData& data)
+{
+    SequenceKeyData dependent(data);
+    if (data._chain)
+    {
+        // the next tasks of the key are scheduled after the ones already in the chain
+        data._chain->close();
+        data._chain.reset();
+    }
+    return dependent;
+}
 
 }}
@@ -25,13 +25,14 @@ namespace quantum {
 
 template <typename RET, typename CAPTURE>
 int bindCoro(Traits::Yield& yield,
-             std::shared_ptr<CoroContext<RET>> ctx,
+             CoroContext<RET>* ctx,
              CAPTURE&& capture)
 {
     try
     {
         ctx->setYieldHandle(yield); //set coroutine yield
         yield.get() = std::forward<CAPTURE>(capture)();
+        ctx->arena().release(); //coroutine is done with its arena
         return 0;
     }
     catch(std::exception& ex)
@@ -51,17 +52,19 @@ int bindCoro(Traits::Yield& yield,
 #endif
         ctx->setException(std::current_exception());
     }
+    ctx->arena().release();
     yield.get() = (int)ITask::RetCode::Exception;
     return (int)ITask::RetCode::Exception;
 }
 
 template <typename RET, typename CAPTURE>
-int bindIo(std::shared_ptr<Promise<RET>> promise,
+int bindIo(std::shared_ptr<Promise<RET>>&& promise,
            CAPTURE&& capture)
 {
     try
     {
-        return std::forward<CAPTURE>(capture)();
+        //the promise is passed as the first argument of the user function
+        return std::forward<CAPTURE>(capture)(promise);
     }
     catch(std::exception& ex)
     {
@@ -87,16 +90,40 @@ template<class RET, class FUNC, class ...ARGS>
 Function<int(Traits::Yield&)>
 Util::bindCaller(std::shared_ptr<Context<RET>> context, FUNC&& func, ARGS&& ...args)
 {
-    auto capture = makeCapture(std::forward<FUNC>(func), std::shared_ptr<Context<RET>>(context), std::forward<ARGS>(args)...);
-    return makeCapture(bindCoro<RET, decltype(capture)>, std::shared_ptr<Context<RET>>(context), std::move(capture));
+    return bindCaller<__QUANTUM_FUNCTION_ALLOC_SIZE>(std::move(context), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template<class RET, class FUNC, class ...ARGS>
 Function<int()>
 Util::bindIoCaller(std::shared_ptr<Promise<RET>> promise, FUNC&& func, ARGS&& ...args)
 {
-    auto capture = makeCapture(std::forward<FUNC>(func), std::shared_ptr<Promise<RET>>(promise), std::forward<ARGS>(args)...);
-    return makeCapture(bindIo<RET, decltype(capture)>, std::shared_ptr<Promise<RET>>(promise), std::move(capture));
+    return bindIoCaller<__QUANTUM_FUNCTION_ALLOC_SIZE>(std::move(promise), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template<size_t SIZE, class RET, class FUNC, class ...ARGS>
+Function<int(Traits::Yield&), SIZE>
+Util::bindCaller(std::shared_ptr<Context<RET>> context, FUNC&& func, ARGS&& ...args)
+{
+    //The only owning reference is moved into the user capture. The context outlives the coroutine since
+    //the task also keeps a reference, so the wrapper only needs the raw pointer.
+    CoroContext<RET>* ctx = context.get();
+    auto capture = makeCapture(std::forward<FUNC>(func), std::move(context), std::forward<ARGS>(args)...);
+    return makeCapture(bindCoro<RET, decltype(capture)>, std::move(ctx), std::move(capture));
+}
+
+template<size_t SIZE, class RET, class FUNC, class ...ARGS>
+Function<int(), SIZE>
+Util::bindIoCaller(std::shared_ptr<Promise<RET>> promise, FUNC&& func, ARGS&& ...args)
+{
+    //The promise must outlive the user function to report exceptions, so it is held by the wrapper only.
+    auto capture = makeCapture(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return makeCapture(bindIo<RET, decltype(capture)>, std::move(promise), std::move(capture));
+}
+
+template<class RET>
+void Util::resetPromise(const CoroContextPtr<RET>& ctx)
+{
+    std::static_pointer_cast<Context<RET>>(ctx)->_promises.back() = Promise<RET>::create();
 }
 
 template <class RET, class INPUT_IT>
@@ -155,6 +182,191 @@ int Util::forEachBatchCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
     return ctx->set(FutureJoiner<std::vector<RET>>()(*ctx, std::move(asyncResults))->get(ctx));
 }
 
+template <class RET, class INPUT_IT>
+int Util::forEachChunkedCoro(CoroContextPtr<std::vector<RET>> ctx,
+                             INPUT_IT inputIt,
+                             size_t num,
+                             const Functions::ForEachFunc<RET, INPUT_IT>& func,
+                             size_t grainSize,
+                             size_t numCoroutineThreads)
+{
+    constexpr size_t chunksPerThread = 8; //enough chunks to even out the load between threads
+    if (num == 0)
+    {
+        return ctx->set(std::vector<RET>());
+    }
+    if (grainSize == 0)
+    {
+        grainSize = std::max<size_t>(1, num/(numCoroutineThreads*chunksPerThread));
+    }
+    const size_t numChunks = (num + grainSize - 1)/grainSize;
+    
+    //locate the beginning of each chunk, so that workers can claim them in any order
+    std::vector<INPUT_IT> chunkBegin;
+    chunkBegin.reserve(numChunks);
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        chunkBegin.push_back(inputIt);
+        if (i+1 < numChunks)
+        {
+            std::advance(inputIt, grainSize);
+        }
+    }
+    std::vector<std::vector<RET>> chunkResults(numChunks);
+    std::atomic<size_t> nextChunk{0};
+    
+    //Post one worker per coroutine thread. The shared state lives on this coroutine's stack
+    //which stays valid until all the workers have completed.
+    const size_t numWorkers = std::min(numChunks, numCoroutineThreads);
+    std::vector<CoroContextPtr<int>> workers;
+    workers.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        workers.emplace_back(ctx->template post<int>((int)i, false,
+                                                     [&, num, grainSize, numChunks](CoroContextPtr<int> ctx)->int
+        {
+            for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+            {
+                size_t chunkSize = std::min(grainSize, num - chunk*grainSize);
+                std::vector<RET>& result = chunkResults[chunk];
+                result.reserve(chunkSize);
+                auto it = chunkBegin[chunk];
+                for (size_t j = 0; j < chunkSize; ++j, ++it)
+                {
+                    result.emplace_back(func(*it));
+                }
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& worker : workers)
+    {
+        worker->wait(ctx);
+    }
+    for (auto&& worker : workers)
+    {
+        worker->get(ctx); //rethrows any exception thrown by 'func'
+    }
+    
+    std::vector<RET> results;
+    results.reserve(num);
+    for (auto&& chunkResult : chunkResults)
+    {
+        std::move(chunkResult.begin(), chunkResult.end(), std::back_inserter(results));
+    }
+    return ctx->set(std::move(results));
+}
+
+template <class RET, class INPUT_IT>
+int Util::forEachBatchSplitCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
+                                INPUT_IT first,
+                                INPUT_IT last,
+                                const Functions::ForEachFunc<RET, INPUT_IT>& func,
+                                size_t grainSize,
+                                size_t numCoroutineThreads)
+{
+    static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                  typename std::iterator_traits<INPUT_IT>::iterator_category>::value,
+                  "forEachBatchSplit requires random access iterators");
+    constexpr size_t grainsPerThread = 8;
+    using Batch = std::pair<size_t, std::vector<RET>>; //starting offset and results of a sub-range
+    
+    const size_t num = std::distance(first, last);
+    if (num == 0)
+    {
+        return ctx->set(std::vector<std::vector<RET>>());
+    }
+    if (grainSize == 0)
+    {
+        grainSize = std::max<size_t>(1, num/(numCoroutineThreads*grainsPerThread));
+    }
+    
+    //The shared state lives on this coroutine's stack which stays valid until all the workers have completed.
+    std::atomic<size_t> numActive{1}; //sub-ranges currently owned by a running or pending worker
+    SpinLock lock;
+    std::vector<CoroContextPtr<int>> workers; //guarded by 'lock'
+    std::vector<Batch> batches;               //guarded by 'lock'
+    
+    std::function<int(CoroContextPtr<int>, size_t, size_t)> process;
+    auto spawn = [&](size_t begin, size_t end)
+    {
+        CoroContextPtr<int> worker = ctx->template post<int>(process, size_t{begin}, size_t{end});
+        SpinLock::Guard guard(lock);
+        workers.emplace_back(std::move(worker));
+    };
+    process = [&, grainSize, numCoroutineThreads](CoroContextPtr<int> workerCtx, size_t begin, size_t end)->int
+    {
+        Batch batch(begin, std::vector<RET>());
+        batch.second.reserve(end - begin);
+        try
+        {
+            for (size_t pos = begin; pos < end;)
+            {
+                //Split off the right half while some threads have nothing to do
+                size_t active = numActive.load(std::memory_order_relaxed);
+                while ((end - pos >= 2*grainSize) && (active < numCoroutineThreads))
+                {
+                    if (numActive.compare_exchange_weak(active, active + 1, std::memory_order_relaxed))
+                    {
+                        size_t mid = pos + (end - pos)/2;
+                        spawn(mid, end);
+                        end = mid;
+                        active = numActive.load(std::memory_order_relaxed);
+                    }
+                }
+                size_t grainEnd = std::min(pos + grainSize, end);
+                for (auto it = first + pos; pos < grainEnd; ++pos, ++it)
+                {
+                    batch.second.emplace_back(func(*it));
+                }
+            }
+        }
+        catch (...)
+        {
+            numActive.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        numActive.fetch_sub(1, std::memory_order_relaxed);
+        {
+            SpinLock::Guard guard(lock);
+            batches.emplace_back(std::move(batch));
+        }
+        return workerCtx->set(0);
+    };
+    spawn(0, num);
+    
+    //Join all the workers. New ones are only posted by running workers, so once every known
+    //worker has completed, the list cannot grow anymore.
+    for (size_t i = 0;; ++i)
+    {
+        CoroContextPtr<int> worker;
+        {
+            SpinLock::Guard guard(lock);
+            if (i == workers.size())
+            {
+                break;
+            }
+            worker = workers[i];
+        }
+        worker->wait(ctx);
+    }
+    for (auto&& worker : workers)
+    {
+        worker->get(ctx); //rethrows any exception thrown by 'func'
+    }
+    
+    std::sort(batches.begin(), batches.end(), [](const Batch& lhs, const Batch& rhs) {
+        return lhs.first < rhs.first;
+    });
+    std::vector<std::vector<RET>> results;
+    results.reserve(batches.size());
+    for (auto&& batch : batches)
+    {
+        results.emplace_back(std::move(batch.second));
+    }
+    return ctx->set(std::move(results));
+}
+
 template <class KEY,
           class MAPPED_TYPE,
           class REDUCED_TYPE,
@@ -249,6 +461,538 @@ int Util::mapReduceBatchCoro(CoroContextPtr<std::map<KEY, REDUCED_TYPE>> ctx,
     return ctx->set(std::move(reducerOutput));
 }
 
+template <class INPUT_IT>
+std::vector<std::pair<INPUT_IT, size_t>> Util::splitRange(INPUT_IT inputIt, size_t num, size_t numChunks)
+{
+    std::vector<std::pair<INPUT_IT, size_t>> chunks;
+    chunks.reserve(numChunks);
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        size_t chunkSize = (num*(i+1))/numChunks - (num*i)/numChunks;
+        chunks.emplace_back(inputIt, chunkSize);
+        if (i+1 < numChunks)
+        {
+            std::advance(inputIt, chunkSize);
+        }
+    }
+    return chunks;
+}
+
+template <class RET, class INPUT_IT, class TRANSFORM>
+int Util::transformReduceCoro(CoroContextPtr<RET> ctx,
+                              INPUT_IT inputIt,
+                              size_t num,
+                              RET init,
+                              const TRANSFORM& transform,
+                              const Functions::BinaryOpFunc<RET>& op,
+                              size_t numCoroutineThreads)
+{
+    if (num == 0)
+    {
+        return ctx->set(std::move(init));
+    }
+    // Each worker reduces one contiguous chunk, so the order of the elements is preserved
+    std::vector<std::pair<INPUT_IT, size_t>> chunks = splitRange(inputIt, num, std::min(num, numCoroutineThreads));
+    std::vector<CoroContextPtr<RET>> workers;
+    workers.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        workers.emplace_back(ctx->template post<RET>((int)i, false, [&, i](CoroContextPtr<RET> ctx)->int
+        {
+            INPUT_IT it = chunks[i].first;
+            RET partial = transform(*it);
+            for (size_t j = 1; j < chunks[i].second; ++j)
+            {
+                partial = op(partial, transform(*++it));
+            }
+            return ctx->set(std::move(partial));
+        }));
+    }
+    for (auto&& worker : workers)
+    {
+        worker->wait(ctx);
+    }
+    std::vector<RET> partials;
+    partials.reserve(workers.size());
+    for (auto&& worker : workers)
+    {
+        partials.emplace_back(worker->get(ctx)); //rethrows any exception thrown by 'transform' or 'op'
+    }
+    // Combine adjacent partial results pairwise
+    for (size_t step = 1; step < partials.size(); step *= 2)
+    {
+        for (size_t i = 0; i + step < partials.size(); i += 2*step)
+        {
+            partials[i] = op(partials[i], partials[i+step]);
+        }
+    }
+    return ctx->set(op(init, partials.front()));
+}
+
+template <class RET, class INPUT_IT>
+int Util::inclusiveScanCoro(CoroContextPtr<std::vector<RET>> ctx,
+                            INPUT_IT inputIt,
+                            size_t num,
+                            const Functions::BinaryOpFunc<RET>& op,
+                            size_t numCoroutineThreads)
+{
+    if (num == 0)
+    {
+        return ctx->set(std::vector<RET>());
+    }
+    std::vector<std::pair<INPUT_IT, size_t>> chunks = splitRange(inputIt, num, std::min(num, numCoroutineThreads));
+    std::vector<std::vector<RET>> chunkResults(chunks.size());
+    std::vector<CoroContextPtr<int>> workers;
+    workers.reserve(chunks.size());
+    
+    // First pass: scan each chunk independently
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        workers.emplace_back(ctx->template post<int>((int)i, false, [&, i](CoroContextPtr<int> ctx)->int
+        {
+            std::vector<RET>& result = chunkResults[i];
+            result.reserve(chunks[i].second);
+            INPUT_IT it = chunks[i].first;
+            result.emplace_back(RET(*it));
+            for (size_t j = 1; j < chunks[i].second; ++j)
+            {
+                result.emplace_back(op(result.back(), RET(*++it)));
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& worker : workers)
+    {
+        worker->wait(ctx);
+    }
+    for (auto&& worker : workers)
+    {
+        worker->get(ctx); //rethrows any exception thrown by 'op'
+    }
+    
+    // Second pass: offset every chunk but the first by the total of the preceding chunks
+    std::vector<RET> offsets;
+    offsets.reserve(chunks.size());
+    offsets.emplace_back(chunkResults.front().back());
+    for (size_t i = 1; i+1 < chunks.size(); ++i)
+    {
+        offsets.emplace_back(op(offsets.back(), chunkResults[i].back()));
+    }
+    workers.clear();
+    for (size_t i = 1; i < chunks.size(); ++i)
+    {
+        workers.emplace_back(ctx->template post<int>((int)i, false, [&, i](CoroContextPtr<int> ctx)->int
+        {
+            const RET& offset = offsets[i-1];
+            for (auto&& value : chunkResults[i])
+            {
+                value = op(offset, value);
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& worker : workers)
+    {
+        worker->wait(ctx);
+    }
+    for (auto&& worker : workers)
+    {
+        worker->get(ctx);
+    }
+    
+    std::vector<RET> results = std::move(chunkResults.front());
+    results.reserve(num);
+    for (size_t i = 1; i < chunkResults.size(); ++i)
+    {
+        std::move(chunkResults[i].begin(), chunkResults[i].end(), std::back_inserter(results));
+    }
+    return ctx->set(std::move(results));
+}
+
+template <class RANDOM_IT, class COMPARE>
+int Util::sortCoro(CoroContextPtr<int> ctx,
+                   RANDOM_IT first,
+                   RANDOM_IT last,
+                   const COMPARE& comp,
+                   size_t numCoroutineThreads)
+{
+    static_assert(std::is_same<typename std::iterator_traits<RANDOM_IT>::iterator_category,
+                               std::random_access_iterator_tag>::value, "Sort requires random access iterators");
+    using Value = typename std::iterator_traits<RANDOM_IT>::value_type;
+    using Runs = std::vector<std::pair<size_t, size_t>>; //[begin, end) offsets of the sorted runs
+    constexpr size_t minParallelSize = 4096; //below this, splitting costs more than it saves
+    
+    const size_t num = std::distance(first, last);
+    if ((num < minParallelSize) || (numCoroutineThreads < 2))
+    {
+        std::sort(first, last, comp);
+        return ctx->set(0);
+    }
+    auto waitAll = [&ctx](std::vector<CoroContextPtr<int>>& workers)
+    {
+        for (auto&& worker : workers)
+        {
+            worker->wait(ctx);
+        }
+        for (auto&& worker : workers)
+        {
+            worker->get(ctx); //rethrows any exception thrown by 'comp'
+        }
+        workers.clear();
+    };
+    std::vector<CoroContextPtr<int>> workers;
+    workers.reserve(numCoroutineThreads);
+    
+    // Sort one run per coroutine thread
+    Runs runs;
+    for (size_t i = 0; i < numCoroutineThreads; ++i)
+    {
+        runs.emplace_back((num*i)/numCoroutineThreads, (num*(i+1))/numCoroutineThreads);
+        workers.emplace_back(ctx->template post<int>((int)i, false, [&, i](CoroContextPtr<int> ctx)->int
+        {
+            std::sort(first + runs[i].first, first + runs[i].second, comp);
+            return ctx->set(0);
+        }));
+    }
+    waitAll(workers);
+    
+    // Merge adjacent runs pairwise, alternating between the range and a buffer. Each merge is split
+    // in pieces at positions found by binary search, so that all the threads take part in every round.
+    std::vector<Value> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    auto mergeRound = [&](auto src, auto dst)
+    {
+        Runs merged;
+        const size_t numPairs = runs.size()/2;
+        const size_t numPieces = (numCoroutineThreads + numPairs - 1)/numPairs;
+        for (size_t p = 0; p < numPairs; ++p)
+        {
+            const size_t lo = runs[2*p].first, mid = runs[2*p].second, hi = runs[2*p+1].second;
+            merged.emplace_back(lo, hi);
+            //split the left run evenly and find the matching split points in the right run. This is
+            //done before any piece starts moving elements out of the source.
+            std::vector<std::pair<size_t, size_t>> splits;
+            splits.reserve(numPieces+1);
+            splits.emplace_back(lo, mid);
+            for (size_t k = 1; k < numPieces; ++k)
+            {
+                size_t left = lo + ((mid-lo)*k)/numPieces;
+                splits.emplace_back(left, std::lower_bound(src + mid, src + hi, *(src + left), comp) - src);
+            }
+            splits.emplace_back(mid, hi);
+            for (size_t k = 0; k < numPieces; ++k)
+            {
+                const std::pair<size_t, size_t> from = splits[k], to = splits[k+1];
+                workers.emplace_back(ctx->template post<int>((int)(workers.size() % numCoroutineThreads), false,
+                                                             [=, &comp](CoroContextPtr<int> ctx)->int
+                {
+                    std::merge(std::make_move_iterator(src + from.first), std::make_move_iterator(src + to.first),
+                               std::make_move_iterator(src + from.second), std::make_move_iterator(src + to.second),
+                               dst + from.first + (from.second - mid), comp);
+                    return ctx->set(0);
+                }));
+            }
+        }
+        if (runs.size() % 2)
+        {
+            //the last run has no pair in this round
+            const std::pair<size_t, size_t> run = runs.back();
+            merged.push_back(run);
+            workers.emplace_back(ctx->template post<int>((int)(workers.size() % numCoroutineThreads), false,
+                                                         [=](CoroContextPtr<int> ctx)->int
+            {
+                std::move(src + run.first, src + run.second, dst + run.first);
+                return ctx->set(0);
+            }));
+        }
+        waitAll(workers);
+        runs = std::move(merged);
+    };
+    bool inBuffer = true;
+    while (runs.size() > 1)
+    {
+        if (inBuffer)
+        {
+            mergeRound(buffer.begin(), first);
+        }
+        else
+        {
+            mergeRound(first, buffer.begin());
+        }
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+    {
+        //move the result back into the range in parallel
+        for (size_t i = 0; i < numCoroutineThreads; ++i)
+        {
+            workers.emplace_back(ctx->template post<int>((int)i, false, [&, i](CoroContextPtr<int> ctx)->int
+            {
+                size_t begin = (num*i)/numCoroutineThreads, end = (num*(i+1))/numCoroutineThreads;
+                std::move(buffer.begin() + begin, buffer.begin() + end, first + begin);
+                return ctx->set(0);
+            }));
+        }
+        waitAll(workers);
+    }
+    return ctx->set(0);
+}
+
+template <class KEY>
+size_t Util::partitionOf(const KEY& key, size_t numPartitions)
+{
+    //The hash is scrambled before taking the modulo so that the keys of a partition remain
+    //well distributed inside that partition's own hash table.
+    uint64_t hash = static_cast<uint64_t>(std::hash<KEY>()(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(hash >> 32) % numPartitions;
+}
+
+template <class KEY, class MAPPED_TYPE>
+void Util::combine(std::unordered_map<KEY, MAPPED_TYPE>& combined,
+                   KEY&& key,
+                   MAPPED_TYPE&& value,
+                   const Functions::CombineFunc<MAPPED_TYPE>& combiner)
+{
+    auto it = combined.find(key);
+    if (it == combined.end())
+    {
+        combined.emplace(std::move(key), std::move(value));
+    }
+    else
+    {
+        combiner(it->second, std::move(value));
+    }
+}
+
+template <class KEY, class MAPPED_TYPE>
+void Util::partitionMapped(PartitionBuckets<KEY, MAPPED_TYPE>& buckets,
+                           std::vector<std::pair<KEY, MAPPED_TYPE>>&& mapped,
+                           const Functions::CombineFunc<MAPPED_TYPE>& combiner)
+{
+    for (auto&& mappedResult : mapped)
+    {
+        PartitionBucket<KEY, MAPPED_TYPE>& bucket = buckets[partitionOf(mappedResult.first, buckets.size())];
+        if (combiner)
+        {
+            combine(bucket._combined, std::move(mappedResult.first), std::move(mappedResult.second), combiner);
+        }
+        else
+        {
+            bucket._values.emplace_back(std::move(mappedResult));
+        }
+    }
+}
+
+template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE, class RESULT>
+RESULT Util::reducePartitions(CoroContextPtr<RESULT> ctx,
+                              std::vector<PartitionBuckets<KEY, MAPPED_TYPE>>& buckets,
+                              const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                              const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                              size_t numPartitions,
+                              size_t numCoroutineThreads)
+{
+    using Partition = std::unordered_map<KEY, std::vector<MAPPED_TYPE>>;
+    using CombinedPartition = std::unordered_map<KEY, MAPPED_TYPE>;
+    using ReducedResults = std::vector<std::pair<KEY, REDUCED_TYPE>>;
+    
+    //Each partition merges its bucket from every mapper and reduces its keys. The buckets live on
+    //the caller's stack which stays valid until all the reducers have completed.
+    std::vector<CoroContextPtr<ReducedResults>> reducers;
+    reducers.reserve(numPartitions);
+    for (size_t p = 0; p < numPartitions; ++p)
+    {
+        reducers.emplace_back(ctx->template post<ReducedResults>((int)(p % numCoroutineThreads), false,
+                                                                 [&, p](CoroContextPtr<ReducedResults> ctx)->int
+        {
+            ReducedResults reducedResults;
+            if (combiner)
+            {
+                //values are already pre-reduced per mapper, so only one value per key is left to reduce
+                CombinedPartition partition;
+                for (auto&& mapperBuckets : buckets)
+                {
+                    for (auto&& entry : mapperBuckets[p]._combined)
+                    {
+                        combine(partition, KEY(entry.first), std::move(entry.second), combiner);
+                    }
+                    CombinedPartition().swap(mapperBuckets[p]._combined); //release the memory as soon as possible
+                }
+                reducedResults.reserve(partition.size());
+                for (auto&& entry : partition)
+                {
+                    std::vector<MAPPED_TYPE> values;
+                    values.emplace_back(std::move(entry.second));
+                    reducedResults.emplace_back(reducer(std::pair<KEY, std::vector<MAPPED_TYPE>>
+                                                        (entry.first, std::move(values))));
+                }
+            }
+            else
+            {
+                Partition partition;
+                for (auto&& mapperBuckets : buckets)
+                {
+                    for (auto&& mappedResult : mapperBuckets[p]._values)
+                    {
+                        partition[std::move(mappedResult.first)].emplace_back(std::move(mappedResult.second));
+                    }
+                    std::vector<std::pair<KEY, MAPPED_TYPE>>().swap(mapperBuckets[p]._values);
+                }
+                reducedResults.reserve(partition.size());
+                for (auto&& entry : partition)
+                {
+                    reducedResults.emplace_back(reducer(std::pair<KEY, std::vector<MAPPED_TYPE>>
+                                                        (entry.first, std::move(entry.second))));
+                }
+            }
+            return ctx->set(std::move(reducedResults));
+        }));
+    }
+    for (auto&& worker : reducers)
+    {
+        worker->wait(ctx);
+    }
+    RESULT reducerOutput;
+    for (auto&& worker : reducers)
+    {
+        for (auto&& reducedResult : worker->get(ctx)) //rethrows any exception thrown by 'reducer'
+        {
+            reducerOutput.emplace(std::move(reducedResult.first), std::move(reducedResult.second));
+        }
+    }
+    return reducerOutput;
+}
+
+template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE, class RESULT, class INPUT_IT>
+int Util::mapReducePartitionedCoro(CoroContextPtr<RESULT> ctx,
+                                   INPUT_IT inputIt,
+                                   size_t num,
+                                   const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
+                                   const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                                   size_t numPartitions,
+                                   const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                                   size_t numCoroutineThreads)
+{
+    constexpr size_t chunksPerThread = 8; //enough chunks to even out the load between mappers
+    if (num == 0)
+    {
+        return ctx->set(RESULT());
+    }
+    if (numPartitions == 0)
+    {
+        numPartitions = numCoroutineThreads;
+    }
+    const size_t grainSize = std::max<size_t>(1, num/(numCoroutineThreads*chunksPerThread));
+    const size_t numChunks = (num + grainSize - 1)/grainSize;
+    
+    //locate the beginning of each chunk, so that mappers can claim them in any order
+    std::vector<INPUT_IT> chunkBegin;
+    chunkBegin.reserve(numChunks);
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        chunkBegin.push_back(inputIt);
+        if (i+1 < numChunks)
+        {
+            std::advance(inputIt, grainSize);
+        }
+    }
+    std::atomic<size_t> nextChunk{0};
+    
+    // Map stage. Each mapper owns one bucket per partition so it needs no synchronization.
+    // The shared state lives on this coroutine's stack which stays valid until all the mappers
+    // and reducers have completed.
+    const size_t numMappers = std::min(numChunks, numCoroutineThreads);
+    std::vector<PartitionBuckets<KEY, MAPPED_TYPE>> buckets(numMappers, PartitionBuckets<KEY, MAPPED_TYPE>(numPartitions));
+    std::vector<CoroContextPtr<int>> mappers;
+    mappers.reserve(numMappers);
+    for (size_t i = 0; i < numMappers; ++i)
+    {
+        mappers.emplace_back(ctx->template post<int>((int)i, false,
+                                                     [&, i, num, grainSize, numChunks](CoroContextPtr<int> ctx)->int
+        {
+            for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+            {
+                size_t chunkSize = std::min(grainSize, num - chunk*grainSize);
+                auto it = chunkBegin[chunk];
+                for (size_t j = 0; j < chunkSize; ++j, ++it)
+                {
+                    partitionMapped(buckets[i], mapper(*it), combiner);
+                }
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& worker : mappers)
+    {
+        worker->wait(ctx);
+    }
+    for (auto&& worker : mappers)
+    {
+        worker->get(ctx); //rethrows any exception thrown by 'mapper'
+    }
+    
+    // Shuffle and reduce stage
+    return ctx->set(reducePartitions<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>
+        (ctx, buckets, reducer, combiner, numPartitions, numCoroutineThreads));
+}
+
+template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE, class RESULT, class T>
+int Util::mapReduceStreamCoro(CoroContextPtr<RESULT> ctx,
+                              std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                              const Functions::StreamMapFunc<KEY, MAPPED_TYPE, T>& mapper,
+                              const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                              size_t numPartitions,
+                              const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                              size_t numCoroutineThreads)
+{
+    constexpr size_t batchSize = 64; //values pulled from the input by a mapper at a time
+    if (numPartitions == 0)
+    {
+        numPartitions = numCoroutineThreads;
+    }
+    
+    // Map stage. Mappers take turns pulling batches of values from the input as they are
+    // produced and map them in parallel. Each mapper owns one bucket per partition.
+    Mutex inputMutex;
+    bool inputClosed = false;
+    std::vector<PartitionBuckets<KEY, MAPPED_TYPE>> buckets(numCoroutineThreads, PartitionBuckets<KEY, MAPPED_TYPE>(numPartitions));
+    std::vector<CoroContextPtr<int>> mappers;
+    mappers.reserve(numCoroutineThreads);
+    for (size_t i = 0; i < numCoroutineThreads; ++i)
+    {
+        mappers.emplace_back(ctx->template post<int>((int)i, false, [&, i](CoroContextPtr<int> ctx)->int
+        {
+            while (true)
+            {
+                std::vector<T> batch;
+                {//========= LOCKED SCOPE =========
+                    Mutex::Guard lock(ctx, inputMutex);
+                    if (inputClosed)
+                    {
+                        break;
+                    }
+                    batch = input->pullBatch(ctx, batchSize, inputClosed);
+                }
+                for (auto&& value : batch)
+                {
+                    partitionMapped(buckets[i], mapper(value), combiner);
+                }
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& worker : mappers)
+    {
+        worker->wait(ctx);
+    }
+    for (auto&& worker : mappers)
+    {
+        worker->get(ctx); //rethrows any exception thrown by 'mapper' or by the producer
+    }
+    
+    // Shuffle and reduce stage
+    return ctx->set(reducePartitions<KEY, MAPPED_TYPE, REDUCED_TYPE, RESULT>
+        (ctx, buckets, reducer, combiner, numPartitions, numCoroutineThreads));
+}
+
 #ifdef __QUANTUM_PRINT_DEBUG
 std::mutex& Util::LogMutex()
 {
@@ -0,0 +1,198 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <stdexcept>
+
+namespace Bloomberg {
+namespace quantum {
+
+template <typename T>
+std::pair<size_t, T> FutureSelector<T>::whenAny(const std::vector<ThreadFuturePtr<T>>& futures)
+{
+    int index = waitForAnyImpl(futures, std::chrono::milliseconds(-1));
+    return std::make_pair((size_t)index, futures[index]->get());
+}
+
+template <typename T>
+std::pair<size_t, T> FutureSelector<T>::whenAny(const std::vector<ThreadContextPtr<T>>& futures)
+{
+    int index = waitForAnyImpl(futures, std::chrono::milliseconds(-1));
+    return std::make_pair((size_t)index, futures[index]->get());
+}
+
+template <typename T>
+std::pair<size_t, T> FutureSelector<T>::whenAny(ICoroSync::Ptr sync, const std::vector<CoroFuturePtr<T>>& futures)
+{
+    int index = waitForAnyImpl(sync, futures, std::chrono::milliseconds(-1));
+    return std::make_pair((size_t)index, futures[index]->get(sync));
+}
+
+template <typename T>
+std::pair<size_t, T> FutureSelector<T>::whenAny(ICoroSync::Ptr sync, const std::vector<CoroContextPtr<T>>& futures)
+{
+    int index = waitForAnyImpl(sync, futures, std::chrono::milliseconds(-1));
+    return std::make_pair((size_t)index, futures[index]->get(sync));
+}
+
+template <typename T>
+int FutureSelector<T>::waitForAny(const std::vector<ThreadFuturePtr<T>>& futures,
+                                  std::chrono::milliseconds timeMs)
+{
+    return waitForAnyImpl(futures, timeMs);
+}
+
+template <typename T>
+int FutureSelector<T>::waitForAny(const std::vector<ThreadContextPtr<T>>& futures,
+                                  std::chrono::milliseconds timeMs)
+{
+    return waitForAnyImpl(futures, timeMs);
+}
+
+template <typename T>
+int FutureSelector<T>::waitForAny(ICoroSync::Ptr sync,
+                                  const std::vector<CoroFuturePtr<T>>& futures,
+                                  std::chrono::milliseconds timeMs)
+{
+    return waitForAnyImpl(sync, futures, timeMs);
+}
+
+template <typename T>
+int FutureSelector<T>::waitForAny(ICoroSync::Ptr sync,
+                                  const std::vector<CoroContextPtr<T>>& futures,
+                                  std::chrono::milliseconds timeMs)
+{
+    return waitForAnyImpl(sync, futures, timeMs);
+}
+
+template <typename T>
+void FutureSelector<T>::Selection::select(int index)
+{
+    int expected = -1;
+    if (!_winner.compare_exchange_strong(expected, index))
+    {
+        return; //another future completed first or the waiter timed out
+    }
+    if (_sync)
+    {
+        _sync->notify();
+        _isNotified = true;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isNotified = true;
+        _cond.notify_one();
+    }
+}
+
+template <typename T>
+template <class FUTURE>
+void FutureSelector<T>::registerWaiter(const std::shared_ptr<Selection>& selection, const std::vector<FUTURE>& futures)
+{
+    if (futures.empty())
+    {
+        throw std::runtime_error("No futures to wait on");
+    }
+    for (size_t i = 0; (i < futures.size()) && (selection->_winner == -1); ++i)
+    {
+        int index = static_cast<int>(i);
+        futures[i]->onReady([selection, index]()
+        {
+            selection->select(index);
+        });
+    }
+}
+
+template <typename T>
+template <class FUTURE>
+int FutureSelector<T>::waitForAnyImpl(const std::vector<FUTURE>& futures, std::chrono::milliseconds timeMs)
+{
+    std::shared_ptr<Selection> selection = std::make_shared<Selection>();
+    registerWaiter(selection, futures);
+    std::unique_lock<std::mutex> lock(selection->_mutex);
+    auto isNotified = [&selection]()->bool { return selection->_isNotified; };
+    if (timeMs < std::chrono::milliseconds::zero())
+    {
+        selection->_cond.wait(lock, isNotified);
+    }
+    else if (!selection->_cond.wait_for(lock, timeMs, isNotified))
+    {
+        int expected = -1;
+        if (selection->_winner.compare_exchange_strong(expected, -2))
+        {
+            return -1; //timeout
+        }
+        selection->_cond.wait(lock, isNotified); //completed just as the time expired
+    }
+    return selection->_winner;
+}
+
+template <typename T>
+template <class FUTURE>
+int FutureSelector<T>::waitForAnyImpl(ICoroSync::Ptr sync, const std::vector<FUTURE>& futures, std::chrono::milliseconds timeMs)
+{
+    std::shared_ptr<Selection> selection = std::make_shared<Selection>();
+    selection->_sync = sync;
+    std::atomic_int& signal = sync->signal();
+    signal = 0; //blocked until notified
+    try
+    {
+        registerWaiter(selection, futures);
+    }
+    catch (...)
+    {
+        signal = -1;
+        throw;
+    }
+    bool isTimed = (timeMs >= std::chrono::milliseconds::zero());
+    auto start = std::chrono::steady_clock::now();
+    
+    //The coroutine must not resume before the winning callback is done notifying it
+    while (!selection->_isNotified)
+    {
+        if (isTimed && (selection->_winner == -1))
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed >= timeMs)
+            {
+                int expected = -1;
+                if (selection->_winner.compare_exchange_strong(expected, -2))
+                {
+                    break; //timeout
+                }
+                continue;
+            }
+            //Resumes when notified or when the remaining time expires
+            sync->sleep(std::chrono::duration_cast<std::chrono::microseconds>(timeMs - elapsed));
+        }
+        else
+        {
+            sync->getYieldHandle()();
+        }
+    }
+    if (isTimed)
+    {
+        sync->sleep(std::chrono::microseconds(0)); //cancel any remaining sleep time
+    }
+    signal = -1; //reset
+    return (selection->_winner < 0) ? -1 : selection->_winner.load();
+}
+
+}}
@@ -20,7 +20,10 @@
 #include <quantum/interface/quantum_ithread_future.h>
 #include <quantum/interface/quantum_icoro_context.h>
 #include <quantum/interface/quantum_icoro_future.h>
+#include <quantum/quantum_promise.h>
 #include <quantum/impl/quantum_stl_impl.h>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <type_traits>
 
@@ -33,7 +36,10 @@ namespace quantum {
 /// @class FutureJoiner
 /// @brief Utility class that joins N futures into a single one.
 /// @details Instead of waiting for N futures to complete, the user can join them and wait
-///          on a single future which returns N values.
+///          on a single future which returns N values. No task is used for joining: each future
+///          decrements a shared counter when it completes and the last one fulfills the joined future.
+///          Each value is moved out of its future into the joined vector, so values are never copied and T
+///          may be move-only. Use share() on the joined future to let several consumers read the vector.
 /// @tparam T The type returned by the future.
 template <typename T>
 class FutureJoiner
@@ -60,6 +66,31 @@ private:
     
     template <template<class> class FUTURE, class DISPATCHER>
     CoroContextPtr<std::vector<T>> join(CoroContextTag, DISPATCHER& dispatcher, std::vector<typename FUTURE<T>::Ptr>&& futures);
+    
+    template <class FUTURE_PTR, class PROMISE_PTR>
+    struct JoinState
+    {
+        JoinState(std::vector<FUTURE_PTR>&& futures, PROMISE_PTR&& promise) :
+            _futures(std::move(futures)),
+            _promise(std::move(promise)),
+            _numPending(_futures.size())
+        {}
+        
+        std::vector<FUTURE_PTR>     _futures;
+        PROMISE_PTR                 _promise;
+        std::atomic_size_t          _numPending;
+    };
+    
+    template <class FUTURE_PTR, class PROMISE_PTR>
+    static void joinImpl(std::vector<FUTURE_PTR>&& futures, PROMISE_PTR promise);
+    
+    template <class FUTURE_PTR, class PROMISE_PTR>
+    static void complete(JoinState<FUTURE_PTR, PROMISE_PTR>& state);
+    
+    static T getValue(const ThreadContextPtr<T>& future);
+    static T getValue(const ThreadFuturePtr<T>& future);
+    static T getValue(const CoroContextPtr<T>& future);
+    static T getValue(const CoroFuturePtr<T>& future);
 };
 
 }}
@@ -0,0 +1,111 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SEQUENCE_KEY_CHAIN_H
+#define QUANTUM_SEQUENCE_KEY_CHAIN_H
+
+#include <quantum/interface/quantum_icoro_context.h>
+#include <quantum/interface/quantum_iqueue.h>
+#include <quantum/quantum_latch.h>
+#include <quantum/quantum_spinlock.h>
+#include <deque>
+#include <memory>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                  class SequenceKeyChain
+//==============================================================================================
+/// @class SequenceKeyChain.
+/// @brief Chain of the tasks posted to a single sequence key through the direct dispatch path of the Sequencer.
+/// @details Only one task of the chain is posted to the dispatcher at any time. Tasks appended while it runs wait
+///          in the chain, and each one is posted by its predecessor when it completes, so no coroutine is blocked
+///          waiting on the previous task of the key. A closed chain rejects new tasks and completes once its last
+///          task is done.
+/// @note For internal use only.
+class SequenceKeyChain : public std::enable_shared_from_this<SequenceKeyChain>
+{
+public:
+    using Ptr = std::shared_ptr<SequenceKeyChain>;
+    
+    /// @brief A task waiting in the chain.
+    struct Link
+    {
+        virtual ~Link() = default;
+        
+        /// @brief Posts the task to the dispatcher. The task must call next() on the chain when it completes.
+        /// @param[in] chain The chain this link belongs to.
+        /// @param[in] ctx The context of the coroutine posting the task or null if posted from a thread.
+        virtual void post(const Ptr& chain, const CoroContextPtr<int>& ctx) = 0;
+        
+        /// @brief Runs the task inline, in the coroutine which ran the previous task of the chain.
+        /// @param[in] ctx The context of the running coroutine.
+        virtual void run(const CoroContextPtr<int>& ctx) = 0;
+        
+        /// @brief Gets the queue id the task was posted to.
+        /// @return The queue id.
+        virtual int getQueueId() const = 0;
+        
+        /// @brief Checks if the task can be run inline by the coroutine of its predecessor.
+        /// @return False if the task must be posted, e.g. if it also waits for other chains.
+        virtual bool canRunInline() const = 0;
+    };
+    using LinkPtr = std::unique_ptr<Link>;
+    
+    /// @brief Constructor.
+    /// @param[in] isRunning If true, appended links are held until next() is called. This allows a coroutine to
+    ///                      wait for the dependents of the key before starting the chain.
+    explicit SequenceKeyChain(bool isRunning);
+    
+    /// @brief Appends a task to the chain. If the chain is idle, the task is posted immediately.
+    /// @param[in] link The task. It is moved from only if the chain accepts it.
+    /// @return False if the chain is closed.
+    bool append(LinkPtr& link);
+    
+    /// @brief Posts the next task of the chain or marks the chain as idle.
+    /// @param[in] ctx The context of the coroutine which completed the previous task or started the chain.
+    void next(const CoroContextPtr<int>& ctx);
+    
+    /// @brief Removes the next task of the chain so that the caller can run it inline. The chain stays running.
+    /// @param[in] queueId The queue id of the running coroutine. Only a task posted to the same queue or to
+    ///                    IQueue::QueueId::Any is removed.
+    /// @return The task or null if there is none, if it must run on another queue or if it cannot run inline.
+    LinkPtr pop(int queueId);
+    
+    /// @brief Rejects any further task.
+    void close();
+    
+    /// @brief Checks if no task of the chain is running or waiting.
+    /// @return True if idle.
+    bool isIdle() const;
+    
+    /// @brief Waits until the chain is closed and all its tasks are done.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    void wait(ICoroSync::Ptr sync);
+    
+private:
+    mutable SpinLock        _lock;
+    std::deque<LinkPtr>     _links;
+    bool                    _isRunning;
+    bool                    _isClosed;
+    Latch                   _done;
+};
+
+}}
+
+#include <quantum/util/impl/quantum_sequence_key_chain_impl.h>
+
+#endif //QUANTUM_SEQUENCE_KEY_CHAIN_H
@@ -19,6 +19,8 @@
 #include <vector>
 #include <tuple>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 
 namespace Bloomberg {
@@ -57,11 +59,40 @@ public:
     /// @return the number of tasks
     size_t getPendingTaskCount() const;
 
+    /// @brief Gets the total number of completed tasks associated with the key
+    /// @return the number of tasks
+    size_t getCompletedTaskCount() const;
+
+    /// @brief Gets the average time the completed tasks waited between being posted and being started
+    /// @remark This includes the time spent waiting for the previous tasks of the key, i.e. head-of-line blocking.
+    /// @return the average delay
+    std::chrono::microseconds getAverageQueueingDelay() const;
+
+    /// @brief Gets the longest time a completed task waited between being posted and being started
+    /// @return the maximum delay
+    std::chrono::microseconds getMaxQueueingDelay() const;
+
+    /// @brief Gets the average running time of the completed tasks
+    /// @return the average time
+    std::chrono::microseconds getAverageExecutionTime() const;
+
+    /// @brief Gets the longest running time of a completed task
+    /// @return the maximum time
+    std::chrono::microseconds getMaxExecutionTime() const;
+
 protected:
     /// @brief Number of posted tasks associated with the sequence key
-    size_t _postedTaskCount{0};
+    std::atomic<size_t> _postedTaskCount{0};
     /// @brief Number of pending tasks associated with the sequence key
     std::atomic<size_t> _pendingTaskCount{0};
+    /// @brief Number of completed tasks associated with the sequence key
+    std::atomic<size_t> _completedTaskCount{0};
+    /// @brief Sum and maximum of the queueing delays in microseconds
+    std::atomic<uint64_t> _totalQueueingDelay{0};
+    std::atomic<uint64_t> _maxQueueingDelay{0};
+    /// @brief Sum and maximum of the execution times in microseconds
+    std::atomic<uint64_t> _totalExecutionTime{0};
+    std::atomic<uint64_t> _maxExecutionTime{0};
 };
 
 //==============================================================================================
@@ -81,6 +112,14 @@ public:
 
     /// @brief Increments the total number of pending tasks associated with the key
     void decrementPendingTaskCount();
+
+    /// @brief Records the timings of a completed task associated with the key
+    /// @param queueingDelay the time between the post and the start of the task
+    /// @param executionTime the running time of the task
+    void recordCompletedTask(std::chrono::microseconds queueingDelay, std::chrono::microseconds executionTime);
+
+private:
+    static void updateMax(std::atomic<uint64_t>& max, uint64_t value);
 };
 
 }}
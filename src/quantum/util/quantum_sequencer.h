@@ -20,6 +20,13 @@
 #include <quantum/interface/quantum_ithread_context_base.h>
 #include <quantum/util/quantum_sequencer_configuration.h>
 #include <quantum/util/quantum_sequence_key_statistics.h>
+#include <quantum/quantum_latch.h>
+#include <quantum/quantum_semaphore.h>
+#include <quantum/quantum_spinlock.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
  
@@ -87,6 +94,20 @@ public:
     void
     post(void* opaque, int queueId, bool isHighPriority, const SequenceKey& sequenceKey, FUNC&& func, ARGS&&... args);
 
+    /// @brief Same as above but called from a coroutine.
+    /// @details If a pending task limit is reached and the backpressure policy is
+    ///          SequencerConfiguration::BackpressurePolicy::Block, the calling coroutine is suspended until the task fits.
+    /// @param[in] sync Pointer to the coroutine synchronization object of the caller.
+    template <class FUNC, class ... ARGS>
+    void
+    post(ICoroSync::Ptr sync,
+         void* opaque,
+         int queueId,
+         bool isHighPriority,
+         const SequenceKey& sequenceKey,
+         FUNC&& func,
+         ARGS&&... args);
+
     /// @brief Post a coroutine to run asynchronously.
     /// @details This method will post the coroutine on any thread available and will run when the previous coroutine(s)
     ///          associated with all the 'sequenceKeys' complete. If there are none, then it will run immediately.
@@ -128,6 +149,20 @@ public:
          FUNC&& func,
          ARGS&&... args);
 
+    /// @brief Same as above but called from a coroutine.
+    /// @details If a pending task limit is reached and the backpressure policy is
+    ///          SequencerConfiguration::BackpressurePolicy::Block, the calling coroutine is suspended until the task fits.
+    /// @param[in] sync Pointer to the coroutine synchronization object of the caller.
+    template <class FUNC, class ... ARGS>
+    void
+    post(ICoroSync::Ptr sync,
+         void* opaque,
+         int queueId,
+         bool isHighPriority,
+         const std::vector<SequenceKey>& sequenceKeys,
+         FUNC&& func,
+         ARGS&&... args);
+
     /// @brief Post a coroutine to run asynchronously.
     /// @details This method will post the coroutine on any thread available. The posted task is assumed to be associated
     ///          with the entire universe of sequenceKeys already running or pending, which means that it will wait
@@ -162,8 +197,17 @@ public:
     void
     postAll(void* opaque, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
 
+    /// @brief Same as above but called from a coroutine.
+    /// @details If the global pending task limit is reached and the backpressure policy is
+    ///          SequencerConfiguration::BackpressurePolicy::Block, the calling coroutine is suspended until the task fits.
+    /// @param[in] sync Pointer to the coroutine synchronization object of the caller.
+    template <class FUNC, class ... ARGS>
+    void
+    postAll(ICoroSync::Ptr sync, void* opaque, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+
     /// @brief Trims the sequence keys not used by the sequencer anymore.
-    /// @details It's recommended to call this function periodically to clean up state sequence keys.
+    /// @details It's recommended to call this function periodically to clean up state sequence keys, unless
+    ///          automatic trimming is enabled (@see SequencerConfiguration::setTrimInterval).
     /// @remark This call clears all the statistics for trimmed keys. 
     /// @return The number of sequenceKeys after the trimming.
     /// @note This function blocks until the trimming job posted to the dispatcher is finished
@@ -190,42 +234,233 @@ public:
     /// @note The difference with the previous two statistics methods is that it aggregates stats on a per-task basis,
     ///       not on per-key basis.
     SequenceKeyStatistics getTaskStatistics();
+    
+    /// @brief Adds the per-task statistics to a set of gauges.
+    /// @param gauges the gauges i.e. "postedTaskCount", "pendingTaskCount", "completedTaskCount",
+    ///        "avgQueueingDelayUs", "maxQueueingDelayUs", "avgExecutionTimeUs" and "maxExecutionTimeUs"
+    /// @note This function does not post any job to the dispatcher. It can be registered as a metrics source with
+    ///       Dispatcher::setMetricsSource(), in which case the source must be removed before the sequencer is destroyed.
+    void collectMetrics(MetricsSnapshot::Gauges& gauges);
+
+    /// @brief Ordering of the hot key report
+    enum class HotKeyOrder : int
+    {
+        PendingTaskCount,   ///< Keys with the most pending tasks first
+        QueueingDelay       ///< Keys with the longest average queueing delay first
+    };
+    
+    /// @brief Gets the keys most likely to cause head-of-line blocking.
+    /// @details The candidates are the most frequently posted keys of each shard, maintained incrementally with a
+    ///          bounded sketch on every post (@see SequencerConfiguration::setHotKeyCapacity).
+    /// @param maxKeys the maximum number of keys to return
+    /// @param order how the candidates are ranked
+    /// @return the keys along with a snapshot of their statistics
+    /// @note This function does not post any job to the dispatcher and returns immediately.
+    std::vector<std::pair<SequenceKey, SequenceKeyStatistics>>
+    getHotKeys(size_t maxKeys, HotKeyOrder order = HotKeyOrder::PendingTaskCount);
 
 private:
     using ContextMap = std::unordered_map<SequenceKey, SequenceKeyData, Hash, KeyEqual, Allocator>;
     using ExceptionCallback = typename Configuration::ExceptionCallback;
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    
+    // Candidate hot key, tracked with the Space-Saving algorithm
+    struct HotKey
+    {
+        SequenceKey     _key;
+        size_t          _count; //upper bound of the number of posts for the key
+        StatsPtr        _stats;
+    };
+    
+    // Tasks posted between two universal tasks. The universal task opening the next epoch waits until all the
+    // tasks of this one, including the universal task which opened it, have completed.
+    struct Epoch
+    {
+        void enter();
+        void leave();
+        void wait(ICoroSync::Ptr sync);
+        
+        std::atomic<size_t>     _count{1}; //the extra count is held until the next epoch starts
+        Latch                   _done{1};
+    };
+    using EpochPtr = std::shared_ptr<Epoch>;
+    
+    // Slice of the sequencing state owned by a single control queue. It is shared with the threads
+    // dispatching single key tasks directly.
+    struct Shard
+    {
+        Shard(int queueId, const Configuration& configuration, const SequenceKeyData& universalContext);
+        
+        int                 _queueId;
+        SpinLock            _lock; //protects the members below
+        size_t              _numScheduling{0}; //jobs posted to the control queue which have not run yet
+        size_t              _numPostsSinceTrim{0};
+        size_t              _numTrimBatches{0}; //batches earned by the posts since the last trimming pass
+        size_t              _trimBucket{0}; //bucket where the next automatic trimming pass starts
+        bool                _isTrimPending{false};
+        SequenceKeyData     _universalContext; //last universal task seen by this shard
+        uint64_t            _epochNumber{0}; //incremented by each universal task
+        EpochPtr            _epoch; //tasks posted since the last universal task
+        ContextMap          _contexts;
+        std::vector<HotKey> _hotKeys;
+    };
+    
+    // Task waiting in the chain of a sequence key
+    template <class CAPTURE>
+    struct ChainLink : public SequenceKeyChain::Link
+    {
+        ChainLink(Sequencer& sequencer,
+                  void* opaque,
+                  int queueId,
+                  bool isHighPriority,
+                  StatsPtr stats,
+                  std::shared_ptr<Semaphore> permits,
+                  EpochPtr epoch,
+                  CAPTURE&& capture);
+        void post(const SequenceKeyChain::Ptr& chain, const CoroContextPtr<int>& ctx) final;
+        void run(const CoroContextPtr<int>& ctx) final;
+        int getQueueId() const final;
+        bool canRunInline() const final;
+        
+        Sequencer&  _sequencer;
+        void*       _opaque;
+        int         _queueId;
+        bool        _isHighPriority;
+        TimePoint   _postTime;
+        StatsPtr    _stats;
+        std::shared_ptr<Semaphore> _permits;
+        EpochPtr    _epoch;
+        CAPTURE     _capture;
+    };
+    
+    // Task posted to several sequence keys of the same shard. It is added to the chain of each key and is posted
+    // once, by the last of these chains to reach it.
+    template <class CAPTURE>
+    struct KeyJoin : public std::enable_shared_from_this<KeyJoin<CAPTURE>>
+    {
+        KeyJoin(Sequencer& sequencer,
+                void* opaque,
+                int queueId,
+                bool isHighPriority,
+                TimePoint postTime,
+                EpochPtr epoch,
+                CAPTURE&& capture);
+        void arrive(const CoroContextPtr<int>& ctx);
+        
+        Sequencer&  _sequencer;
+        void*       _opaque;
+        int         _queueId;
+        bool        _isHighPriority;
+        TimePoint   _postTime;
+        EpochPtr    _epoch;
+        std::atomic<size_t> _remaining{1}; //chains which have not reached the task, plus one for the scheduler
+        std::vector<SequenceKeyData>        _dependents; //the stats of these are updated when the task starts
+        std::vector<SequenceKeyChain::Ptr>  _chains; //resumed when the task completes
+        CAPTURE     _capture;
+    };
+    
+    // Placeholder of a KeyJoin in the chain of one of its keys
+    template <class CAPTURE>
+    struct JoinLink : public SequenceKeyChain::Link
+    {
+        explicit JoinLink(std::shared_ptr<KeyJoin<CAPTURE>> join);
+        void post(const SequenceKeyChain::Ptr& chain, const CoroContextPtr<int>& ctx) final;
+        void run(const CoroContextPtr<int>& ctx) final;
+        int getQueueId() const final;
+        bool canRunInline() const final;
+        
+        std::shared_ptr<KeyJoin<CAPTURE>> _join;
+    };
+    
+    // Dependents of a task whose keys span several shards, collected by each of these shards.
+    struct CrossShardDependents
+    {
+        explicit CrossShardDependents(size_t numShards);
+        
+        Latch                               _latch; //released when all the shards have added their dependents
+        SpinLock                            _lock;
+        std::vector<SequenceKeyData>        _dependents; //the stats of these are updated when the task starts
+        std::vector<ICoroContextBasePtr>    _universalDependents;
+        std::vector<EpochPtr>               _previousEpochs; //completed before a universal task starts
+        std::vector<EpochPtr>               _epochs; //left when the task completes
+    };
+    using CrossShardDependentsPtr = std::shared_ptr<CrossShardDependents>;
+    
+    size_t getShardIndex(const SequenceKey& sequenceKey);
+    void acquirePermits(const ICoroSync::Ptr& sync, const SequenceKey* first, const SequenceKey* last);
+    bool acquirePermit(const ICoroSync::Ptr& sync, Semaphore& permits);
+    std::shared_ptr<Semaphore> getKeyPermits(const SequenceKey& sequenceKey);
+    void releasePermit();
+    static void releaseKeyPermit(const SequenceKeyData& data);
+    template <class FUNC, class ... ARGS>
+    void postSequenceKey(void* opaque,
+                         int queueId,
+                         bool isHighPriority,
+                         const SequenceKey& sequenceKey,
+                         FUNC&& func,
+                         ARGS&&... args);
+    template <class FUNC, class ... ARGS>
+    void directDispatch(Shard& shard,
+                        void* opaque,
+                        int queueId,
+                        bool isHighPriority,
+                        const SequenceKey& sequenceKey,
+                        FUNC&& func,
+                        ARGS&&... args);
+    SequenceKeyChain::Ptr getChain(const CoroContextPtr<int>& ctx,
+                                   Shard& shard,
+                                   SequenceKeyData& data,
+                                   int queueId,
+                                   bool isHighPriority);
+    template <class FUNC, class ... ARGS>
+    void postSequenceKeys(void* opaque,
+                          int queueId,
+                          bool isHighPriority,
+                          const std::vector<SequenceKey>& sequenceKeys,
+                          FUNC&& func,
+                          ARGS&&... args);
+    template <class FUNC, class ... ARGS>
+    void postUniversal(void* opaque, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
 
     template <class FUNC, class ... ARGS>
     static int waitForTwoDependents(CoroContextPtr<int> ctx,
                                     void* opaque,
                                     Sequencer& sequencer,
+                                    TimePoint postTime,
+                                    EpochPtr epoch,
                                     SequenceKeyData&& dependent,
-                                    SequenceKeyData&& universalDependent,
+                                    ICoroContextBasePtr universalDependent,
                                     FUNC&& func,
                                     ARGS&&... args);
     template <class FUNC, class ... ARGS>
-    static int waitForDependents(CoroContextPtr<int> ctx,
-                                 void* opaque,
-                                 Sequencer& sequencer,
-                                 std::vector<SequenceKeyData>&& dependents,
-                                 SequenceKeyData&& universalDependent,
-                                 FUNC&& func,
-                                 ARGS&&... args);
-    template <class FUNC, class ... ARGS>
     static int waitForUniversalDependent(CoroContextPtr<int> ctx,
                                          void* opaque,
                                          Sequencer& sequencer,
-                                         std::vector<SequenceKeyData>&& dependents,
-                                         SequenceKeyData&& universalDependent,
+                                         TimePoint postTime,
+                                         EpochPtr previousEpoch,
+                                         EpochPtr epoch,
+                                         StatsPtr stats,
                                          FUNC&& func,
                                          ARGS&&... args);
     template <class FUNC, class ... ARGS>
+    static int waitForCrossShardDependents(CoroContextPtr<int> ctx,
+                                           void* opaque,
+                                           Sequencer& sequencer,
+                                           TimePoint postTime,
+                                           CrossShardDependentsPtr dependents,
+                                           StatsPtr stats,
+                                           FUNC&& func,
+                                           ARGS&&... args);
+    template <class FUNC, class ... ARGS>
     static int singleSequenceKeyTaskScheduler(
                                     CoroContextPtr<int> ctx,
                                     void* opaque,
                                     int queueId,
                                     bool isHighPriority,
                                     Sequencer& sequencer,
+                                    TimePoint postTime,
+                                    Shard& shard,
                                     SequenceKey&& sequenceKey,
                                     FUNC&& func,
                                     ARGS&&... args);
@@ -236,6 +471,8 @@ private:
                                     int queueId,
                                     bool isHighPriority,
                                     Sequencer& sequencer,
+                                    TimePoint postTime,
+                                    Shard& shard,
                                     std::vector<SequenceKey>&& sequenceKeys,
                                     FUNC&& func,
                                     ARGS&&... args);
@@ -246,8 +483,37 @@ private:
                                     int queueId,
                                     bool isHighPriority,
                                     Sequencer& sequencer,
+                                    TimePoint postTime,
+                                    Shard& shard,
                                     FUNC&& func,
                                     ARGS&&... args);
+    template <class CAPTURE>
+    static int runChainLink(CoroContextPtr<int> ctx,
+                            void* opaque,
+                            int queueId,
+                            Sequencer& sequencer,
+                            TimePoint postTime,
+                            StatsPtr stats,
+                            std::shared_ptr<Semaphore> permits,
+                            EpochPtr epoch,
+                            SequenceKeyChain::Ptr chain,
+                            CAPTURE&& capture);
+    template <class CAPTURE>
+    static int runKeyJoin(CoroContextPtr<int> ctx,
+                          std::shared_ptr<KeyJoin<CAPTURE>> join);
+    static int waitForChainDependents(CoroContextPtr<int> ctx,
+                                      SequenceKeyData&& dependent,
+                                      ICoroContextBasePtr universalDependent,
+                                      SequenceKeyChain::Ptr chain);
+    static int crossShardKeyCollector(CoroContextPtr<int> ctx,
+                                      Shard& shard,
+                                      std::vector<SequenceKey>&& sequenceKeys,
+                                      CrossShardDependentsPtr dependents,
+                                      ICoroContextBasePtr taskCtx);
+    static int crossShardUniversalCollector(CoroContextPtr<int> ctx,
+                                            Shard& shard,
+                                            CrossShardDependentsPtr dependents,
+                                            ICoroContextBasePtr taskCtx);
     template <class FUNC, class ... ARGS>
     static void callPosted(CoroContextPtr<int> ctx,
                            void* opaque,
@@ -255,17 +521,40 @@ private:
                            FUNC&& func,
                            ARGS&&... args);
 
+    bool isTrimDue(Shard& shard);
+    void postTrim(Shard& shard);
+    static int trimShard(CoroContextPtr<int> ctx, Shard& shard, size_t batchSize, size_t threshold);
+    static void trackHotKey(Shard& shard, size_t capacity, const SequenceKey& sequenceKey, const StatsPtr& stats);
+    static void recordCompletedTask(SequenceKeyStatisticsWriter& stats,
+                                    TimePoint postTime,
+                                    TimePoint startTime,
+                                    TimePoint endTime);
     static bool canTrimContext(const ICoroContextBasePtr& ctx,
                                const ICoroContextBasePtr& ctxToValidate);
-    static bool isPendingContext(const ICoroContextBasePtr& ctx,
-                                 const ICoroContextBasePtr& ctxToValidate);
+    static void waitForDependent(const ICoroContextBasePtr& ctx, const SequenceKeyData& dependent);
+    static bool isCurrentEpoch(const Shard& shard, const SequenceKeyData& data);
+    static EpochPtr enterEpoch(Shard& shard);
+    static EpochPtr startEpoch(Shard& shard);
+    static SequenceKeyData closeChain(SequenceKeyData& data);
 
     Dispatcher&              _dispatcher;
     int                      _controllerQueueId;
-    SequenceKeyData          _universalContext;
-    ContextMap               _contexts;
+    SequenceKeyData          _universalContext; //holds the universal stats shared by all the shards
+    std::deque<Shard>        _shards;
+    Hash                     _hash;
+    std::mutex               _crossShardMutex; //orders the posts spanning several shards
     ExceptionCallback        _exceptionCallback;
     std::shared_ptr<SequenceKeyStatisticsWriter> _taskStats;
+    bool                     _isDirectDispatch;
+    size_t                   _maxBatchSize;
+    size_t                   _hotKeyCapacity;
+    size_t                   _maxPendingTaskCount;
+    size_t                   _maxPendingTaskCountPerKey;
+    typename Configuration::BackpressurePolicy _backpressurePolicy;
+    Semaphore                _pendingPermits; //one permit per pending task if the global pending count is limited
+    size_t                   _trimInterval;
+    size_t                   _trimBatchSize;
+    size_t                   _trimThreshold;
 };
 
 }}
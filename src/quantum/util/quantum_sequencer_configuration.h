@@ -47,6 +47,13 @@ public:
     /// @param opaque opaque data passed when posting a task
     using ExceptionCallback = std::function<void(std::exception_ptr exception, void* opaque)>;
 
+    /// @brief Behavior of a post exceeding one of the pending task limits
+    enum class BackpressurePolicy : int
+    {
+        Reject,     ///< The post throws std::runtime_error and the task is discarded
+        Block       ///< The posting thread is blocked, or the posting coroutine suspended, until the task fits
+    };
+
 public:
     /// @brief Sets the id of the control queue
     /// @param controlQueueId the queue id
@@ -56,7 +63,117 @@ public:
     /// @return the queue id
     int getControlQueueId() const;
 
-    /// @brief Sets the minimal number of buckets to be used for the context hash map
+    /// @brief Sets the number of controller shards
+    /// @param controlQueueCount the number of shards
+    /// @remark Sequence keys are hashed to a shard and each shard schedules its keys on its own control queue, so
+    ///         that scheduling decisions for different keys do not serialize on a single coroutine thread.
+    ///         Shard i runs on queue (controlQueueId + i) % numCoroutineThreads. Tasks posted with keys from several
+    ///         shards, as well as universal tasks, are still ordered with respect to all the other posts.
+    ///         Default is 1.
+    void setControlQueueCount(int controlQueueCount);
+
+    /// @brief Gets the number of controller shards
+    /// @return the number of shards
+    int getControlQueueCount() const;
+
+    /// @brief Enables the direct dispatch of single key tasks
+    /// @param directDispatch true to schedule single key tasks on the posting thread
+    /// @remark When enabled, a task posted with a single key is scheduled by the caller instead of a coroutine on the
+    ///         control queue. If the key is idle the task is posted immediately, otherwise it is appended to the chain
+    ///         of tasks of the key and posted when its predecessor completes. Single key tasks fall back to the
+    ///         control queue while multi-key or universal tasks of the same shard are being scheduled, so the order
+    ///         of the posts is preserved. Default is true.
+    void setDirectDispatch(bool directDispatch);
+
+    /// @brief Checks if direct dispatch of single key tasks is enabled
+    /// @return true if enabled
+    bool getDirectDispatch() const;
+
+    /// @brief Sets the number of posts between two automatic trimming passes of a shard
+    /// @param trimInterval the number of posts. Set to 0 to disable automatic trimming.
+    /// @remark Every 'trimInterval' posts earn the shard a batch of keys to examine (@see setTrimBatchSize). A job
+    ///         posted to the control queue of the shard examines the batches earned so far and removes the keys not
+    ///         used by the sequencer anymore, the same way trimSequenceKeys() does. The next pass resumes where the previous one stopped, so the whole
+    ///         map is eventually covered without ever pausing the sequencing. Default is 0.
+    void setTrimInterval(size_t trimInterval);
+
+    /// @brief Gets the number of posts between two automatic trimming passes of a shard
+    /// @return the number of posts
+    size_t getTrimInterval() const;
+
+    /// @brief Sets the maximum number of keys examined by an automatic trimming pass
+    /// @param trimBatchSize the number of keys
+    /// @remark Default is 128.
+    void setTrimBatchSize(size_t trimBatchSize);
+
+    /// @brief Gets the maximum number of keys examined by an automatic trimming pass
+    /// @return the number of keys
+    size_t getTrimBatchSize() const;
+
+    /// @brief Sets the number of keys a shard retains before automatic trimming starts evicting idle ones
+    /// @param trimThreshold the number of keys
+    /// @remark Idle keys keep their statistics until they are trimmed. Default is 0.
+    void setTrimThreshold(size_t trimThreshold);
+
+    /// @brief Gets the number of keys a shard retains before automatic trimming starts evicting idle ones
+    /// @return the number of keys
+    size_t getTrimThreshold() const;
+
+    /// @brief Sets the maximum number of tasks of a key run back-to-back by a single coroutine
+    /// @param maxBatchSize the number of tasks
+    /// @remark When direct dispatch is enabled, the coroutine running a task of a key also runs the tasks queued
+    ///         behind it for the same key, in order, until 'maxBatchSize' tasks have run or the key has no more
+    ///         pending tasks. The next task is then posted as a new coroutine, which bounds the latency of the other
+    ///         coroutines sharing the thread. Tasks posted to a specific queue are only batched with tasks posted to
+    ///         the same queue. Default is 1, i.e. each task runs in its own coroutine.
+    void setMaxBatchSize(size_t maxBatchSize);
+
+    /// @brief Gets the maximum number of tasks of a key run back-to-back by a single coroutine
+    /// @return the number of tasks
+    size_t getMaxBatchSize() const;
+
+    /// @brief Sets the maximum number of pending tasks across all the keys
+    /// @param maxPendingTaskCount the number of tasks. Set to 0 for no limit.
+    /// @remark A task is pending from the time it is posted until it starts running. Posts exceeding the limit are
+    ///         handled according to the backpressure policy (@see setBackpressurePolicy). Default is 0.
+    void setMaxPendingTaskCount(size_t maxPendingTaskCount);
+
+    /// @brief Gets the maximum number of pending tasks across all the keys
+    /// @return the number of tasks
+    size_t getMaxPendingTaskCount() const;
+
+    /// @brief Sets the maximum number of pending tasks of a single key
+    /// @param maxPendingTaskCountPerKey the number of tasks. Set to 0 for no limit.
+    /// @remark A task posted with several keys counts against the limit of each of them. Universal tasks are only
+    ///         subject to the global limit. Default is 0.
+    void setMaxPendingTaskCountPerKey(size_t maxPendingTaskCountPerKey);
+
+    /// @brief Gets the maximum number of pending tasks of a single key
+    /// @return the number of tasks
+    size_t getMaxPendingTaskCountPerKey() const;
+
+    /// @brief Sets how posts exceeding a pending task limit are handled
+    /// @param policy the policy
+    /// @remark With the Block policy, coroutines must post with the overloads taking an ICoroSync::Ptr so that they
+    ///         are suspended instead of blocking their thread. Default is BackpressurePolicy::Reject.
+    void setBackpressurePolicy(BackpressurePolicy policy);
+
+    /// @brief Gets how posts exceeding a pending task limit are handled
+    /// @return the policy
+    BackpressurePolicy getBackpressurePolicy() const;
+
+    /// @brief Sets the number of candidate hot keys tracked by each shard
+    /// @param hotKeyCapacity the number of keys. Set to 0 to disable hot key tracking.
+    /// @remark The candidates are the most frequently posted keys, estimated with the Space-Saving algorithm so that
+    ///         memory stays bounded regardless of the number of keys. They are reported by Sequencer::getHotKeys().
+    ///         Each post scans the candidates of its shard, so keep this number small. Default is 0.
+    void setHotKeyCapacity(size_t hotKeyCapacity);
+
+    /// @brief Gets the number of candidate hot keys tracked by each shard
+    /// @return the number of keys
+    size_t getHotKeyCapacity() const;
+
+    /// @brief Sets the minimal number of buckets to be used for the context hash map of each shard
     /// @param bucketCount the bucket number
     void setBucketCount(size_t bucketCount);
 
@@ -98,6 +215,16 @@ public:
 
 private:
     int _controllerQueueId{0};
+    int _controllerQueueCount{1};
+    bool _directDispatch{true};
+    size_t _maxBatchSize{1};
+    size_t _hotKeyCapacity{0};
+    size_t _maxPendingTaskCount{0};
+    size_t _maxPendingTaskCountPerKey{0};
+    BackpressurePolicy _backpressurePolicy{BackpressurePolicy::Reject};
+    size_t _trimInterval{0};
+    size_t _trimBatchSize{128};
+    size_t _trimThreshold{0};
     size_t _bucketCount{0};
     Hash _hash;
     KeyEqual _keyEqual;
@@ -16,11 +16,14 @@
 #ifndef QUANTUM_UTIL_H
 #define QUANTUM_UTIL_H
 
+#include <algorithm>
+#include <atomic>
 #include <tuple>
 #include <functional>
 #include <utility>
 #include <iostream>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <iterator>
 #include <quantum/quantum_traits.h>
@@ -28,6 +31,7 @@
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/interface/quantum_ipromise.h>
 #include <quantum/quantum_capture.h>
+#include <quantum/quantum_mutex.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -52,6 +56,21 @@ struct Util
     static Function<int()>
     bindIoCaller(std::shared_ptr<Promise<RET>> promise, FUNC&& func0, ARGS&& ...args0);
     
+    /// @brief Same as above but with an explicit inline buffer size for the returned Function.
+    ///        Call sites with large captures can avoid allocating from the function pools.
+    template<size_t SIZE, class RET, class FUNC, class ...ARGS>
+    static Function<int(Traits::Yield&), SIZE>
+    bindCaller(std::shared_ptr<Context<RET>> ctx, FUNC&& func0, ARGS&& ...args0);
+    
+    template<size_t SIZE, class RET, class FUNC, class ...ARGS>
+    static Function<int(), SIZE>
+    bindIoCaller(std::shared_ptr<Promise<RET>> promise, FUNC&& func0, ARGS&& ...args0);
+    
+    /// @brief Replaces the promise of the running coroutine with a new one, so that another user function run
+    ///        inline by the same coroutine can set its own value. The previous promise must not have any waiter.
+    template<class RET>
+    static void resetPromise(const CoroContextPtr<RET>& ctx);
+    
     //------------------------------------------------------------------------------------------
     //                                      ForEach
     //------------------------------------------------------------------------------------------
@@ -68,6 +87,22 @@ struct Util
                                 const Functions::ForEachFunc<RET, INPUT_IT>& func,
                                 size_t numCoroutineThreads);
     
+    template <class RET, class INPUT_IT>
+    static int forEachChunkedCoro(CoroContextPtr<std::vector<RET>> ctx,
+                                  INPUT_IT inputIt,
+                                  size_t num,
+                                  const Functions::ForEachFunc<RET, INPUT_IT>& func,
+                                  size_t grainSize,
+                                  size_t numCoroutineThreads);
+    
+    template <class RET, class INPUT_IT>
+    static int forEachBatchSplitCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
+                                     INPUT_IT first,
+                                     INPUT_IT last,
+                                     const Functions::ForEachFunc<RET, INPUT_IT>& func,
+                                     size_t grainSize,
+                                     size_t numCoroutineThreads);
+    
     //------------------------------------------------------------------------------------------
     //                                      MapReduce
     //------------------------------------------------------------------------------------------
@@ -91,6 +126,93 @@ struct Util
                                   const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
                                   const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer);
     
+    template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE, class RESULT, class INPUT_IT>
+    static int mapReducePartitionedCoro(CoroContextPtr<RESULT> ctx,
+                                        INPUT_IT inputIt,
+                                        size_t num,
+                                        const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
+                                        const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                                        size_t numPartitions,
+                                        const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                                        size_t numCoroutineThreads);
+    
+    template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE, class RESULT, class T>
+    static int mapReduceStreamCoro(CoroContextPtr<RESULT> ctx,
+                                   std::shared_ptr<ICoroFuture<Buffer<T>>> input,
+                                   const Functions::StreamMapFunc<KEY, MAPPED_TYPE, T>& mapper,
+                                   const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                                   size_t numPartitions,
+                                   const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                                   size_t numCoroutineThreads);
+    
+    template <class RET, class INPUT_IT, class TRANSFORM>
+    static int transformReduceCoro(CoroContextPtr<RET> ctx,
+                                   INPUT_IT inputIt,
+                                   size_t num,
+                                   RET init,
+                                   const TRANSFORM& transform,
+                                   const Functions::BinaryOpFunc<RET>& op,
+                                   size_t numCoroutineThreads);
+    
+    template <class RET, class INPUT_IT>
+    static int inclusiveScanCoro(CoroContextPtr<std::vector<RET>> ctx,
+                                 INPUT_IT inputIt,
+                                 size_t num,
+                                 const Functions::BinaryOpFunc<RET>& op,
+                                 size_t numCoroutineThreads);
+    
+    template <class RANDOM_IT, class COMPARE>
+    static int sortCoro(CoroContextPtr<int> ctx,
+                        RANDOM_IT first,
+                        RANDOM_IT last,
+                        const COMPARE& comp,
+                        size_t numCoroutineThreads);
+    
+    //Transform used by reduce() which converts each element to the reduced type
+    template <class RET>
+    struct Identity
+    {
+        template <class T>
+        RET operator()(const T& value) const { return RET(value); }
+    };
+    
+    //Splits 'num' elements into 'numChunks' contiguous chunks of nearly equal size and
+    //returns the beginning and the size of each chunk.
+    template <class INPUT_IT>
+    static std::vector<std::pair<INPUT_IT, size_t>> splitRange(INPUT_IT inputIt, size_t num, size_t numChunks);
+    
+    //Output of a single mapper for one partition of the keys
+    template <class KEY, class MAPPED_TYPE>
+    struct PartitionBucket
+    {
+        std::vector<std::pair<KEY, MAPPED_TYPE>> _values;   //mapped values when there is no combiner
+        std::unordered_map<KEY, MAPPED_TYPE>     _combined; //pre-reduced values when there is a combiner
+    };
+    template <class KEY, class MAPPED_TYPE>
+    using PartitionBuckets = std::vector<PartitionBucket<KEY, MAPPED_TYPE>>;
+    
+    template <class KEY>
+    static size_t partitionOf(const KEY& key, size_t numPartitions);
+    
+    template <class KEY, class MAPPED_TYPE>
+    static void combine(std::unordered_map<KEY, MAPPED_TYPE>& combined,
+                        KEY&& key,
+                        MAPPED_TYPE&& value,
+                        const Functions::CombineFunc<MAPPED_TYPE>& combiner);
+    
+    template <class KEY, class MAPPED_TYPE>
+    static void partitionMapped(PartitionBuckets<KEY, MAPPED_TYPE>& buckets,
+                                std::vector<std::pair<KEY, MAPPED_TYPE>>&& mapped,
+                                const Functions::CombineFunc<MAPPED_TYPE>& combiner);
+    
+    template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE, class RESULT>
+    static RESULT reducePartitions(CoroContextPtr<RESULT> ctx,
+                                   std::vector<PartitionBuckets<KEY, MAPPED_TYPE>>& buckets,
+                                   const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                                   const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                                   size_t numPartitions,
+                                   size_t numCoroutineThreads);
+    
 #ifdef __QUANTUM_PRINT_DEBUG
     //Synchronize logging
     static std::mutex& LogMutex();
@@ -0,0 +1,114 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_WHEN_ANY_H
+#define QUANTUM_WHEN_ANY_H
+
+#include <quantum/interface/quantum_ithread_context.h>
+#include <quantum/interface/quantum_ithread_future.h>
+#include <quantum/interface/quantum_icoro_context.h>
+#include <quantum/interface/quantum_icoro_future.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                    class FutureSelector
+//==============================================================================================
+/// @class FutureSelector
+/// @brief Waits for the first of N futures to complete.
+/// @details A single waiter is registered on all the futures via onReady() callbacks and the first
+///          future to complete wakes it up. No polling takes place and waiting coroutines are blocked
+///          until then. Futures which complete later only run a no-op callback.
+/// @tparam T The type returned by the futures.
+/// @note Supports non-buffered futures only.
+template <typename T>
+class FutureSelector
+{
+public:
+    /// @brief Wait for the first thread future or context to complete.
+    /// @param[in] futures A vector of thread futures or thread contexts of type T.
+    /// @return The index and the value of the first completed future.
+    /// @note Blocks the current thread. Re-throws the exception of the first completed future, if any.
+    static std::pair<size_t, T> whenAny(const std::vector<ThreadFuturePtr<T>>& futures);
+    static std::pair<size_t, T> whenAny(const std::vector<ThreadContextPtr<T>>& futures);
+    
+    /// @brief Wait for the first coroutine future or context to complete.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] futures A vector of coroutine futures or coroutine contexts of type T.
+    /// @return The index and the value of the first completed future.
+    /// @note Must be called from a coroutine. Re-throws the exception of the first completed future, if any.
+    static std::pair<size_t, T> whenAny(ICoroSync::Ptr sync, const std::vector<CoroFuturePtr<T>>& futures);
+    static std::pair<size_t, T> whenAny(ICoroSync::Ptr sync, const std::vector<CoroContextPtr<T>>& futures);
+    
+    /// @brief Wait for the first thread future or context to complete, for a maximum of 'timeMs' milliseconds.
+    /// @param[in] futures A vector of thread futures or thread contexts of type T.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait. A negative value waits forever.
+    /// @return The index of the first completed future or -1 on timeout.
+    /// @note Blocks the current thread. The value of the completed future can be read without blocking.
+    static int waitForAny(const std::vector<ThreadFuturePtr<T>>& futures,
+                          std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    static int waitForAny(const std::vector<ThreadContextPtr<T>>& futures,
+                          std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    
+    /// @brief Wait for the first coroutine future or context to complete, for a maximum of 'timeMs' milliseconds.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] futures A vector of coroutine futures or coroutine contexts of type T.
+    /// @param[in] timeMs The maximum amount of milliseconds to wait. A negative value waits forever.
+    /// @return The index of the first completed future or -1 on timeout.
+    /// @note Must be called from a coroutine. The value of the completed future can be read without blocking.
+    static int waitForAny(ICoroSync::Ptr sync,
+                          const std::vector<CoroFuturePtr<T>>& futures,
+                          std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    static int waitForAny(ICoroSync::Ptr sync,
+                          const std::vector<CoroContextPtr<T>>& futures,
+                          std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    
+private:
+    //Shared between the waiter and the callbacks registered on each future
+    struct Selection
+    {
+        void select(int index);
+        
+        std::atomic_int             _winner{-1};
+        std::atomic_bool            _isNotified{false}; //set once the waiter can no longer be touched
+        ICoroSync::Ptr              _sync; //null for threads
+        std::mutex                  _mutex;
+        std::condition_variable     _cond;
+    };
+    
+    template <class FUTURE>
+    static void registerWaiter(const std::shared_ptr<Selection>& selection, const std::vector<FUTURE>& futures);
+    
+    template <class FUTURE>
+    static int waitForAnyImpl(const std::vector<FUTURE>& futures, std::chrono::milliseconds timeMs);
+    
+    template <class FUTURE>
+    static int waitForAnyImpl(ICoroSync::Ptr sync, const std::vector<FUTURE>& futures, std::chrono::milliseconds timeMs);
+};
+
+}}
+
+#include <quantum/util/impl/quantum_when_any_impl.h>
+
+#endif //QUANTUM_WHEN_ANY_H
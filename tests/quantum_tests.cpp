@@ -21,6 +21,14 @@
 #include <map>
 #include <unordered_map>
 #include <list>
+#include <numeric>
+#include <deque>
+#include <random>
+#include <cstring>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace quantum;
 using ms = std::chrono::milliseconds;
@@ -420,6 +428,40 @@ TEST(ExecutionTest, ChainCoroutinesFromCoroutineContext)
     EXPECT_EQ(validation, v);
 }
 
+TEST(ExecutionTest, InlineContinuations)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setInlineContinuations(true);
+    Dispatcher dispatcher(config);
+
+    std::atomic_bool started(false), released(false);
+    std::vector<int> v;
+    auto func = [&v](CoroContext<int>::Ptr, int i)->int
+    {
+        v.push_back(i);
+        return 0;
+    };
+    dispatcher.postFirst([&](CoroContext<int>::Ptr)->int {
+        started = true;
+        while (!released)
+        {
+            std::this_thread::yield();
+        }
+        v.push_back(1);
+        return 0;
+    })->then(func, 2)->then(func, 3)->onError(func, 10)->finally(func, 4)->end();
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+    dispatcher.post(func, 5); //waits until the whole chain is done
+    released = true;
+    dispatcher.drain();
+    EXPECT_EQ(std::vector<int>({1,2,3,4,5}), v);
+}
+
 TEST(ExecutionTest, OnErrorTaskRuns)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -543,6 +585,91 @@ TEST(PromiseTest, BufferedFuture)
     }
 }
 
+TEST(PromiseTest, BoundedBufferedFuture)
+{
+    const int capacity = 4;
+    std::atomic_int numPushed{0}, numPulled{0}, maxPending{0};
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    ThreadContext<Buffer<int>>::Ptr ctx = dispatcher.post<Buffer<int>>([&](CoroContext<Buffer<int>>::Ptr ctx)->int{
+        ctx->setBufferCapacity(capacity);
+        for (int d = 0; d < 100; d++)
+        {
+            ctx->push(d); //suspends when the buffer is full
+            int pending = ++numPushed - numPulled;
+            if (pending > maxPending) maxPending = pending;
+        }
+        EXPECT_THROW(ctx->setBufferCapacity(10), std::runtime_error);
+        return ctx->closeBuffer();
+    });
+    
+    std::vector<int> v;
+    while (1)
+    {
+        bool isBufferClosed = false;
+        int value = ctx->pull(isBufferClosed);
+        if (isBufferClosed) break;
+        ++numPulled;
+        v.push_back(value);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    
+    //Validate
+    EXPECT_EQ(100u, v.size());
+    for (int i = 0; i < (int)v.size(); ++i) {
+        EXPECT_EQ(i, v[i]);
+    }
+    EXPECT_LE(maxPending, 2*capacity + 1); //reader and writer sides of the buffer
+    
+    //bounded ring
+    Buffer<int> buffer(2);
+    EXPECT_EQ(2u, buffer.capacity());
+    EXPECT_EQ(BufferStatus::DataPosted, buffer.push(1));
+    EXPECT_EQ(BufferStatus::DataPosted, buffer.push(2));
+    EXPECT_TRUE(buffer.isFull());
+    EXPECT_EQ(BufferStatus::Full, buffer.push(3));
+    int value = 0;
+    EXPECT_EQ(BufferStatus::DataReceived, buffer.pull(value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(BufferStatus::DataPosted, buffer.push(3)); //wraps around
+    EXPECT_EQ(BufferStatus::DataReceived, buffer.pull(value));
+    EXPECT_EQ(2, value);
+    EXPECT_EQ(BufferStatus::DataReceived, buffer.pull(value));
+    EXPECT_EQ(3, value);
+    EXPECT_EQ(BufferStatus::DataPending, buffer.pull(value));
+}
+
+TEST(PromiseTest, BufferedFutureBatches)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    ThreadContext<Buffer<int>>::Ptr ctx = dispatcher.post<Buffer<int>>([](CoroContext<Buffer<int>>::Ptr ctx)->int{
+        ctx->setBufferCapacity(50); //batches larger than the capacity are split
+        std::vector<int> batch(100);
+        for (int d = 0; d < 10; d++)
+        {
+            std::iota(batch.begin(), batch.end(), d*100);
+            ctx->pushBatch(batch.begin(), batch.end());
+        }
+        return ctx->closeBuffer();
+    });
+    
+    std::vector<int> v;
+    while (1)
+    {
+        bool isBufferClosed = false;
+        std::vector<int> values = ctx->pullBatch(64, isBufferClosed);
+        if (isBufferClosed) break;
+        EXPECT_FALSE(values.empty());
+        EXPECT_LE(values.size(), 64u);
+        v.insert(v.end(), values.begin(), values.end());
+    }
+    
+    //Validate
+    EXPECT_EQ(1000u, v.size());
+    for (int i = 0; i < (int)v.size(); ++i) {
+        EXPECT_EQ(i, v[i]);
+    }
+}
+
 TEST(PromiseTest, BufferedFutureException)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -712,6 +839,106 @@ TEST(PromiseTest, SetExceptionInPromise)
     EXPECT_THROW(ctx->get(), int);
 }
 
+TEST(PromiseTest, SatisfyPromiseOnce)
+{
+    Promise<int> promise;
+    ThreadFuturePtr<int> future = promise.getIThreadFuture();
+    EXPECT_EQ(std::future_status::timeout, future->waitFor(ms(1)));
+    promise.set(5);
+    EXPECT_THROW(promise.set(6), PromiseAlreadySatisfiedException);
+    promise.setException(std::make_exception_ptr(std::runtime_error("ignored")));
+    EXPECT_EQ(std::future_status::ready, future->waitFor(ms(0)));
+    EXPECT_EQ(5, future->getRef());
+    EXPECT_EQ(5, future->get());
+    EXPECT_THROW(future->get(), FutureAlreadyRetrievedException);
+    
+    //exceptions complete the future
+    Promise<int> promise2;
+    ThreadFuturePtr<int> future2 = promise2.getIThreadFuture();
+    std::thread thread([&promise2]{
+        std::this_thread::sleep_for(ms(10));
+        promise2.setException(std::make_exception_ptr(std::runtime_error("error")));
+    });
+    EXPECT_EQ(std::future_status::ready, future2->waitFor(ms(5000)));
+    EXPECT_THROW(future2->get(), std::runtime_error);
+    thread.join();
+}
+
+TEST(PromiseTest, EmplaceNonDefaultConstructible)
+{
+    struct Message
+    {
+        Message(int id, std::string text) : _id(id), _text(std::move(text)) { ++numConstructed(); }
+        Message(Message&& other) : _id(other._id), _text(std::move(other._text)) { ++numConstructed(); }
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+        static int& numConstructed() { static int num = 0; return num; }
+        int _id;
+        std::string _text;
+    };
+    {
+        Promise<Message> promise;
+        ThreadFuturePtr<Message> future = promise.getIThreadFuture();
+        EXPECT_EQ(0, Message::numConstructed()); //no default value
+        promise.emplace(7, "hello");
+        EXPECT_EQ(1, Message::numConstructed());
+        EXPECT_THROW(promise.emplace(8, "again"), PromiseAlreadySatisfiedException);
+        EXPECT_EQ(7, future->getRef()._id);
+        EXPECT_EQ("hello", future->getRef()._text);
+        Message message = future->get();
+        EXPECT_EQ("hello", message._text);
+    }
+    {
+        //a broken promise never constructs a value
+        Promise<Message> promise;
+        ThreadFuturePtr<Message> future = promise.getIThreadFuture();
+        promise.terminate();
+        EXPECT_THROW(future->get(), BrokenPromiseException);
+    }
+    EXPECT_EQ(2, Message::numConstructed());
+}
+
+TEST(PromiseTest, OnReadyContinuation)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Latch latch(3);
+    std::atomic_int sum{0};
+    
+    Promise<int> promise;
+    ThreadFuturePtr<int> threadFuture = promise.getIThreadFuture();
+    CoroFuturePtr<int> coroFuture = promise.getICoroFuture();
+    threadFuture->onReady(dispatcher, [&sum, &latch](ICoroContext<int>::Ptr, ThreadFuturePtr<int> future){
+        sum += future->getRef();
+        latch.countDown();
+    });
+    coroFuture->onReady(dispatcher, 0, true, [&sum, &latch](ICoroContext<int>::Ptr ctx, CoroFuturePtr<int> future){
+        sum += 10 * future->getRef(ctx);
+        latch.countDown();
+    });
+    std::this_thread::sleep_for(ms(10));
+    EXPECT_EQ(0, sum); //nothing runs until the promise is satisfied
+    promise.set(5);
+    
+    //callbacks on a ready future run immediately
+    bool called = false;
+    threadFuture->onReady([&called]{ called = true; });
+    EXPECT_TRUE(called);
+    
+    //broken promises also trigger continuations
+    std::atomic_bool broken{false};
+    {
+        Promise<int> promise2;
+        promise2.getIThreadFuture()->onReady(dispatcher, [&broken, &latch](ICoroContext<int>::Ptr, ThreadFuturePtr<int> future){
+            EXPECT_THROW(future->get(), BrokenPromiseException);
+            broken = true;
+            latch.countDown();
+        });
+    }
+    latch.wait();
+    EXPECT_EQ(55, sum);
+    EXPECT_TRUE(broken);
+}
+
 TEST(PromiseTest, FutureTimeout)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -767,6 +994,37 @@ TEST(PromiseTest, WaitForAllFutures)
     EXPECT_GE(elapsed, (size_t)200);
 }
 
+TEST(MutexTest, SpinLockContention)
+{
+    SpinLock lock;
+    PaddedSpinLock paddedLock;
+    EXPECT_EQ(CacheLinePadding::CacheLineSize * 2, sizeof(PaddedSpinLock));
+    size_t count = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&]{
+            for (int j = 0; j < 10000; ++j)
+            {
+                SpinLock::Guard guard((j % 2) ? lock : static_cast<SpinLock&>(paddedLock));
+                SpinLock::Guard other((j % 2) ? static_cast<SpinLock&>(paddedLock) : lock, SpinLock::TryToLock());
+                if (other.ownsLock())
+                {
+                    ++count;
+                }
+            }
+        });
+    }
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_GT(count, 0u);
+    EXPECT_TRUE(lock.tryLock());
+    EXPECT_FALSE(lock.tryLock());
+    lock.unlock();
+}
+
 TEST(MutexTest, LockingAndUnlocking)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -802,6 +1060,317 @@ TEST(MutexTest, LockingAndUnlocking)
     EXPECT_TRUE((6 == v[1] || 7 == v[1]) && (6 == v[2] || 7 == v[2]));
 }
 
+TEST(MutexTest, FifoHandoff)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Mutex m;
+    std::vector<int> order;
+    
+    //waiters acquire the mutex in arrival order
+    m.lock();
+    for (int i = 0; i < 5; ++i)
+    {
+        dispatcher.post(i % 2, false, [&m, &order, i](CoroContext<int>::Ptr ctx)->int{
+            Mutex::Guard guard(ctx, m);
+            order.push_back(i);
+            return ctx->set(0);
+        });
+        std::this_thread::sleep_for(ms(10));
+    }
+    std::thread thread([&m, &order]{
+        Mutex::Guard guard(m);
+        order.push_back(5);
+    });
+    std::this_thread::sleep_for(ms(10));
+    EXPECT_FALSE(m.tryLock());
+    m.unlock();
+    thread.join();
+    dispatcher.drain();
+    EXPECT_EQ(std::vector<int>({0,1,2,3,4,5}), order);
+    
+    //mixed coroutine and thread contention
+    size_t count = 0;
+    std::vector<ThreadContextPtr<int>> contexts;
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.emplace_back(dispatcher.post([&m, &count](CoroContext<int>::Ptr ctx)->int{
+            for (int j = 0; j < 100; ++j)
+            {
+                Mutex::Guard guard(ctx, m);
+                ++count;
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (int j = 0; j < 1000; ++j)
+    {
+        Mutex::Guard guard(m);
+        ++count;
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->get();
+    }
+    EXPECT_EQ(3000u, count);
+    Mutex::Guard guard(m, true);
+    EXPECT_TRUE(guard.ownsLock());
+}
+
+TEST(MutexTest, ReadWriteMutex)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    for (auto preference : {ReadWriteMutex::Preference::Writers, ReadWriteMutex::Preference::Readers})
+    {
+        ReadWriteMutex m(preference);
+        
+        //readers share the mutex and exclude writers
+        {
+            ReadWriteMutex::ReadGuard guard1(m);
+            ReadWriteMutex::ReadGuard guard2(m, true);
+            EXPECT_TRUE(guard2.ownsLock());
+            EXPECT_EQ(2u, m.numReaders());
+            ReadWriteMutex::WriteGuard guard3(m, true);
+            EXPECT_FALSE(guard3.ownsLock());
+        }
+        {
+            ReadWriteMutex::WriteGuard guard(m);
+            EXPECT_TRUE(m.isWriteLocked());
+            EXPECT_FALSE(m.tryLockRead());
+            EXPECT_FALSE(m.tryLockWrite());
+        }
+        EXPECT_FALSE(m.isWriteLocked());
+        
+        //writers see a consistent pair while coroutines and threads read
+        size_t first = 0, second = 0;
+        std::atomic_int inconsistent{0};
+        std::vector<ThreadContextPtr<int>> contexts;
+        for (int i = 0; i < 20; ++i)
+        {
+            contexts.emplace_back(dispatcher.post([&, i](CoroContext<int>::Ptr ctx)->int{
+                for (int j = 0; j < 100; ++j)
+                {
+                    if (i % 4 == 0)
+                    {
+                        ReadWriteMutex::WriteGuard guard(ctx, m);
+                        ++first;
+                        ++second;
+                    }
+                    else
+                    {
+                        ReadWriteMutex::ReadGuard guard(ctx, m);
+                        if (first != second) ++inconsistent;
+                    }
+                }
+                return ctx->set(0);
+            }));
+        }
+        for (int j = 0; j < 500; ++j)
+        {
+            ReadWriteMutex::ReadGuard guard(m);
+            if (first != second) ++inconsistent;
+        }
+        for (auto&& ctx : contexts)
+        {
+            ctx->get();
+        }
+        EXPECT_EQ(0, inconsistent);
+        EXPECT_EQ(500u, first);
+        EXPECT_EQ(0u, m.numReaders());
+    }
+}
+
+TEST(MutexTest, Semaphore)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Semaphore semaphore(3);
+    std::atomic_int inside{0}, maxInside{0};
+    auto enter = [&inside, &maxInside]{
+        int num = ++inside;
+        int max = maxInside;
+        while ((num > max) && !maxInside.compare_exchange_weak(max, num));
+        --inside;
+    };
+    std::vector<ThreadContextPtr<int>> contexts;
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.emplace_back(dispatcher.post([&semaphore, &enter](CoroContext<int>::Ptr ctx)->int{
+            for (int j = 0; j < 50; ++j)
+            {
+                Semaphore::Guard guard(ctx, semaphore);
+                enter();
+                ctx->yield();
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (int j = 0; j < 500; ++j)
+    {
+        Semaphore::Guard guard(semaphore);
+        enter();
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->get();
+    }
+    EXPECT_LE(maxInside, 3);
+    EXPECT_EQ(3u, semaphore.count());
+    
+    //release wakes up a parked waiter
+    Semaphore empty;
+    EXPECT_FALSE(empty.tryAcquire());
+    ThreadContextPtr<int> ctx = dispatcher.post([&empty](CoroContext<int>::Ptr ctx)->int{
+        empty.acquire(ctx);
+        return ctx->set(1);
+    });
+    std::this_thread::sleep_for(ms(10));
+    empty.release();
+    EXPECT_EQ(1, ctx->get());
+    EXPECT_EQ(0u, empty.count());
+}
+
+TEST(MutexTest, LatchAndBarrier)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Latch latch(5);
+    std::vector<ThreadContextPtr<int>> contexts;
+    for (int i = 0; i < 4; ++i)
+    {
+        contexts.emplace_back(dispatcher.post([&latch](CoroContext<int>::Ptr ctx)->int{
+            latch.arriveAndWait(ctx);
+            return ctx->set(0);
+        }));
+    }
+    EXPECT_FALSE(latch.tryWait());
+    latch.countDown();
+    latch.wait();
+    EXPECT_TRUE(latch.tryWait());
+    EXPECT_THROW(latch.countDown(), std::runtime_error);
+    for (auto&& ctx : contexts)
+    {
+        ctx->get();
+    }
+    
+    //all participants observe the previous phase before the next one starts
+    Barrier barrier(5);
+    std::atomic_int arrived{0}, errors{0}, last{0};
+    contexts.clear();
+    for (int i = 0; i < 4; ++i)
+    {
+        contexts.emplace_back(dispatcher.post([&](CoroContext<int>::Ptr ctx)->int{
+            for (int phase = 1; phase <= 10; ++phase)
+            {
+                ++arrived;
+                if (barrier.arriveAndWait(ctx)) ++last;
+                if (arrived < 5 * phase) ++errors;
+                barrier.arriveAndWait(ctx);
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (int phase = 1; phase <= 10; ++phase)
+    {
+        ++arrived;
+        if (barrier.arriveAndWait()) ++last;
+        if (arrived < 5 * phase) ++errors;
+        barrier.arriveAndWait();
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->get();
+    }
+    EXPECT_EQ(0, errors);
+    EXPECT_EQ(10, last);
+    EXPECT_EQ(20u, barrier.phase());
+    EXPECT_THROW(Barrier(0), std::runtime_error);
+}
+
+TEST(ChannelTest, MultipleProducersAndConsumers)
+{
+    for (size_t capacity : {0, 8}) {
+        Channel<int> channel(capacity);
+        const int numValues = 1000;
+        std::atomic_int sum{0}, numReceived{0};
+        Dispatcher& dispatcher = DispatcherSingleton::instance();
+        std::vector<ThreadContext<int>::Ptr> producers;
+        for (int p = 0; p < 4; ++p) {
+            producers.push_back(dispatcher.post([&channel, p](CoroContext<int>::Ptr ctx)->int {
+                for (int i = p; i < numValues; i += 4) {
+                    EXPECT_TRUE(channel.send(ctx, i));
+                }
+                return ctx->set(0);
+            }));
+        }
+        std::vector<ThreadContext<int>::Ptr> consumers;
+        for (int c = 0; c < 2; ++c) {
+            consumers.push_back(dispatcher.post([&](CoroContext<int>::Ptr ctx)->int {
+                int value = 0;
+                while (channel.recv(ctx, value)) {
+                    sum += value;
+                    ++numReceived;
+                }
+                return ctx->set(0);
+            }));
+        }
+        std::thread thread([&]{
+            int value = 0;
+            while (channel.recv(value)) {
+                sum += value;
+                ++numReceived;
+            }
+        });
+        for (auto& producer : producers) {
+            producer->get();
+        }
+        channel.close();
+        for (auto& consumer : consumers) {
+            consumer->get();
+        }
+        thread.join();
+        EXPECT_EQ(numValues, numReceived);
+        EXPECT_EQ(numValues*(numValues-1)/2, sum);
+        EXPECT_FALSE(channel.send(1)); //closed
+        EXPECT_TRUE(channel.empty());
+    }
+}
+
+TEST(ChannelTest, TrySendAndSelect)
+{
+    Channel<int> bounded(2);
+    EXPECT_EQ(2u, bounded.capacity());
+    int value = 1;
+    EXPECT_TRUE(bounded.trySend(value));
+    value = 2;
+    EXPECT_TRUE(bounded.trySend(value));
+    value = 3;
+    EXPECT_FALSE(bounded.trySend(value)); //full
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(bounded.tryRecv(value));
+    EXPECT_EQ(1, value);
+    
+    std::vector<Channel<int>::Ptr> channels{std::make_shared<Channel<int>>(), std::make_shared<Channel<int>>()};
+    int selected = -2;
+    ThreadContext<int>::Ptr ctx = DispatcherSingleton::instance().post([&](CoroContext<int>::Ptr ctx)->int {
+        int received = 0;
+        selected = Channel<int>::select(ctx, channels, received); //blocks until a value is sent
+        return ctx->set(received);
+    });
+    std::this_thread::sleep_for(ms(10));
+    channels[1]->send(42);
+    EXPECT_EQ(42, ctx->get());
+    EXPECT_EQ(1, selected);
+    
+    channels[0]->send(5);
+    EXPECT_EQ(0, Channel<int>::select(channels, value));
+    EXPECT_EQ(5, value);
+    std::thread thread([&]{
+        std::this_thread::sleep_for(ms(10));
+        channels[0]->close();
+        channels[1]->close();
+    });
+    EXPECT_EQ(-1, Channel<int>::select(channels, value)); //all closed
+    thread.join();
+}
+
 TEST(MutexTest, SignalWithConditionVariable)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -841,6 +1410,114 @@ TEST(MutexTest, SignalWithConditionVariable)
     EXPECT_TRUE((6 == v[1] || 7 == v[1]) && (6 == v[2] || 7 == v[2]));
 }
 
+TEST(MutexTest, ConditionVariableWaitFor)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Mutex m;
+    ConditionVariable cv;
+    
+    //expired waits are removed so they don't consume later notifications
+    ThreadContextPtr<int> ctx = dispatcher.post([&m, &cv](CoroContext<int>::Ptr ctx)->int{
+        int notified = 0;
+        {
+            Mutex::Guard guard(ctx, m);
+            notified = cv.waitFor(ctx, m, ms(10)) ? 1 : 0;
+            notified += cv.waitFor(ctx, m, ms(5000)) ? 10 : 0;
+        }
+        return ctx->set(notified);
+    });
+    {
+        Mutex::Guard guard(m);
+        EXPECT_FALSE(cv.waitFor(m, ms(10)));
+    }
+    std::this_thread::sleep_for(ms(100));
+    cv.notifyOne();
+    EXPECT_EQ(10, ctx->get());
+}
+
+//A coroutine woken up by a condition variable relocks the mutex while another coroutine on the same
+//thread was handed that mutex. Relocking must yield rather than block the thread running both.
+static void relockOnSharedCoroutineThread(std::function<bool(CoroContext<int>::Ptr, Mutex&, ConditionVariable&, bool&)> wait)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    Mutex m;
+    ConditionVariable cv;
+    bool ready = false;
+    std::atomic_bool isWaiting{false}, isContending{false};
+    
+    ThreadContextPtr<int> waiter = dispatcher.post(0, false, [&](CoroContext<int>::Ptr ctx)->int{
+        Mutex::Guard guard(ctx, m);
+        isWaiting = true;
+        return ctx->set(wait(ctx, m, cv, ready) ? 1 : 0);
+    });
+    while (!isWaiting)
+    {
+        std::this_thread::sleep_for(ms(1));
+    }
+    m.lock(); //acquired once the waiter releases it
+    ThreadContextPtr<int> contender = dispatcher.post(0, false, [&](CoroContext<int>::Ptr ctx)->int{
+        isContending = true;
+        Mutex::Guard guard(ctx, m);
+        return ctx->set(2);
+    });
+    while (!isContending)
+    {
+        std::this_thread::sleep_for(ms(1));
+    }
+    std::this_thread::sleep_for(ms(20));
+    ready = true;
+    cv.notifyAll();
+    m.unlock(); //hands the mutex over to the contender
+    ASSERT_EQ(std::future_status::ready, contender->waitFor(ms(5000)));
+    ASSERT_EQ(std::future_status::ready, waiter->waitFor(ms(5000)));
+    EXPECT_EQ(2, contender->get());
+    EXPECT_EQ(1, waiter->get());
+}
+
+TEST(MutexTest, ConditionVariableRelockOnSharedThread)
+{
+    relockOnSharedCoroutineThread([](CoroContext<int>::Ptr ctx, Mutex& m, ConditionVariable& cv, bool& ready)->bool{
+        cv.wait(ctx, m, [&ready]()->bool{ return ready; });
+        return true;
+    });
+}
+
+TEST(MutexTest, ConditionVariableTimedRelockOnSharedThread)
+{
+    relockOnSharedCoroutineThread([](CoroContext<int>::Ptr ctx, Mutex& m, ConditionVariable& cv, bool& ready)->bool{
+        return cv.waitFor(ctx, m, ms(5000), [&ready]()->bool{ return ready; });
+    });
+}
+
+TEST(MutexTest, ConditionVariableThreadWaitBlocks)
+{
+    //Thread waiters sleep on the signal rather than polling it, so they wake up regardless of the yield interval
+    std::chrono::milliseconds interval = ThreadTraits::yieldSleepIntervalMs();
+    ThreadTraits::yieldSleepIntervalMs() = ms(500);
+    Mutex m;
+    ConditionVariable cv;
+    bool ready = false;
+    std::chrono::high_resolution_clock::time_point notified;
+    std::thread notifier([&]{
+        std::this_thread::sleep_for(ms(50));
+        Mutex::Guard guard(m);
+        ready = true;
+        notified = std::chrono::high_resolution_clock::now();
+        cv.notifyOne();
+    });
+    {
+        Mutex::Guard guard(m);
+        cv.wait(m, [&ready]()->bool{ return ready; });
+        EXPECT_LT(std::chrono::high_resolution_clock::now() - notified, ms(250));
+        EXPECT_FALSE(cv.waitFor(m, ms(20)));
+    }
+    notifier.join();
+    ThreadTraits::yieldSleepIntervalMs() = interval;
+}
+
 TEST(StressTest, ParallelFibonacciSerie)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -935,27 +1612,2069 @@ TEST(StressTest, AsyncIoAnyQueueLoadBalance)
     EXPECT_EQ(10000, s.size()); //all elements unique
 }
 
-TEST(ForEachTest, Simple)
-{
-    std::vector<int> start{0,1,2,3,4,5,6,7,8,9};
-    std::vector<char> end{'a','b','c','d','e','f','g','h','i','j'};
-    std::vector<char> results = DispatcherSingleton::instance().forEach<char>(start.begin(), start.size(),
-        [](int val)->char {
-        return 'a'+val;
-    })->get();
-    EXPECT_EQ(end, results);
-}
-
-TEST(ForEachTest, SmallBatch)
+TEST(StressTest, AsyncIoSharedRing)
 {
-    std::vector<int> start{0,1,2};
-    std::vector<char> end{'a','b','c'};
+    auto makeConfig = [](Configuration::RingFullPolicy policy)->Configuration{
+        Configuration config;
+        config.setNumCoroutineThreads(1);
+        config.setNumIoThreads(2);
+        config.setLoadBalanceSharedIoQueues(true);
+        config.setLoadBalancePollIntervalMs(ms(1));
+        config.setSharedIoRingCapacity(4);
+        config.setSharedIoRingFullPolicy(policy);
+        return config;
+    };
+    std::atomic<int> count{0};
+    auto task = [&count](ThreadPromise<int>::Ptr promise)->int{
+        ++count;
+        return promise->set(0);
+    };
     
-    std::vector<std::vector<char>> results = DispatcherSingleton::instance().forEachBatch<char>(start.begin(), start.size(),
-        [](int val)->char
+    //Overflowing tasks are spilled
     {
-        return 'a'+val;
-    })->get();
+        Dispatcher dispatcher(makeConfig(Configuration::RingFullPolicy::Spill));
+        for (int i = 0; i < 10000; ++i)
+        {
+            dispatcher.postAsyncIo<int>(task);
+        }
+        dispatcher.drain();
+        EXPECT_EQ(10000, count);
+    }
+    
+    //Posting to full rings fails until the IO threads make progress
+    {
+        count = 0;
+        Dispatcher dispatcher(makeConfig(Configuration::RingFullPolicy::Fail));
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        auto blockingTask = [gateFuture, &count](ThreadPromise<int>::Ptr promise)->int{
+            gateFuture.wait();
+            ++count;
+            return promise->set(0);
+        };
+        int posted = 0;
+        bool isFull = false;
+        for (int i = 0; (i < 100) && !isFull; ++i)
+        {
+            try
+            {
+                dispatcher.postAsyncIo<int>(blockingTask);
+                ++posted;
+            }
+            catch (const std::runtime_error&)
+            {
+                isFull = true;
+            }
+        }
+        EXPECT_TRUE(isFull);
+        EXPECT_LE(posted, 2 * 4 + 2); //two rings plus one running task per thread
+        gate.set_value();
+        dispatcher.drain();
+        EXPECT_EQ(posted, count);
+    }
+    
+    //Posting to full rings waits
+    {
+        count = 0;
+        Dispatcher dispatcher(makeConfig(Configuration::RingFullPolicy::Block));
+        for (int i = 0; i < 1000; ++i)
+        {
+            dispatcher.postAsyncIo<int>([&count](ThreadPromise<int>::Ptr promise)->int{
+                std::this_thread::sleep_for(us(10));
+                ++count;
+                return promise->set(0);
+            });
+        }
+        dispatcher.drain();
+        EXPECT_EQ(1000, count);
+    }
+}
+
+TEST(StressTest, AsyncIoLoadBalanceParking)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(4);
+    config.setLoadBalanceSharedIoQueues(true);
+    config.setLoadBalancePollIntervalMs(ms(1000));
+    config.setLoadBalanceNumPollsBeforeParking(1);
+    config.setSharedIoRingCapacity(64);
+    Dispatcher dispatcher(config);
+    auto now = []()->std::chrono::steady_clock::time_point{ return std::chrono::steady_clock::now(); };
+    
+    //Sleeping threads wake up as soon as a task is posted instead of waiting for the next poll
+    for (int i = 0; i < 5; ++i)
+    {
+        std::this_thread::sleep_for(ms(20));
+        auto start = now();
+        dispatcher.postAsyncIo<int>([](ThreadPromise<int>::Ptr promise)->int{
+            return promise->set(0);
+        })->get();
+        EXPECT_LT(now() - start, ms(500));
+        dispatcher.postAsyncIo<int>(i % 4, false, [](ThreadPromise<int>::Ptr promise)->int{
+            return promise->set(0);
+        })->get();
+        EXPECT_LT(now() - start, ms(500));
+    }
+    
+    std::atomic<int> count{0};
+    for (int i = 0; i < 10000; ++i)
+    {
+        dispatcher.postAsyncIo<int>([&count](ThreadPromise<int>::Ptr promise)->int{
+            ++count;
+            return promise->set(0);
+        });
+    }
+    dispatcher.drain();
+    EXPECT_EQ(10000, count);
+}
+
+TEST(StressTest, ElasticIoThreads)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(2);
+    config.setMaxNumElasticIoThreads(4);
+    config.setElasticIoSpawnThresholdMs(ms(5));
+    config.setElasticIoIdleTimeoutMs(ms(100));
+    Dispatcher dispatcher(config);
+    EXPECT_EQ(0, dispatcher.getNumElasticIoThreads());
+    
+    //Slow tasks back up the shared queue so extra threads get started, up to the cap
+    std::atomic<int> count{0};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    for (int i = 0; i < 60; ++i)
+    {
+        dispatcher.postAsyncIo<int>([&](ThreadPromise<int>::Ptr promise)->int{
+            int current = ++running;
+            int expected = maxRunning;
+            while ((current > expected) && !maxRunning.compare_exchange_weak(expected, current));
+            std::this_thread::sleep_for(ms(10));
+            --running;
+            ++count;
+            return promise->set(0);
+        });
+    }
+    dispatcher.drain();
+    EXPECT_EQ(60, count);
+    EXPECT_GT(maxRunning, 2);
+    EXPECT_LE(maxRunning, 6);
+    EXPECT_LE(dispatcher.getNumElasticIoThreads(), 4);
+    
+    //Idle extra threads are stopped
+    for (int i = 0; (i < 100) && (dispatcher.getNumElasticIoThreads() > 0); ++i)
+    {
+        std::this_thread::sleep_for(ms(20));
+    }
+    EXPECT_EQ(0, dispatcher.getNumElasticIoThreads());
+    EXPECT_EQ(60u, dispatcher.stats(IQueue::QueueType::IO).sharedQueueCompletedCount());
+}
+
+TEST(StressTest, SharedMemoryQueue)
+{
+    using ms = std::chrono::milliseconds;
+    std::string name = "/quantum_tests." + std::to_string(::getpid());
+    SharedMemoryQueue::remove(name);
+    //the producer stands for another process mapping the same segment
+    auto consumer = std::make_shared<SharedMemoryQueue>(name, 64, 16);
+    SharedMemoryQueue producer(name, 64, 16);
+    EXPECT_THROW(SharedMemoryQueue(name, 128, 16), std::runtime_error);
+    EXPECT_THROW(producer.tryPost(1, "0123456789abcdefg", 17), std::invalid_argument);
+    EXPECT_EQ(64u, producer.capacity());
+    
+    //messages without a local handler stay in the ring for another consumer
+    SharedMemoryQueue::Message message;
+    EXPECT_TRUE(producer.tryPost(3, nullptr, 0));
+    EXPECT_FALSE(consumer->tryPop(message));
+    EXPECT_EQ(1u, producer.size());
+    consumer->registerHandler(3, [](const char*, size_t)->int { return 0; });
+    EXPECT_TRUE(consumer->tryPop(message));
+    EXPECT_EQ(3u, message._functionId);
+    
+    std::atomic<int> sum{0}, numEmpty{0};
+    consumer->registerHandler(1, [&sum](const char* payload, size_t size)->int {
+        int value;
+        EXPECT_EQ(sizeof(value), size);
+        memcpy(&value, payload, size);
+        sum += value;
+        return 0;
+    });
+    //fill the ring before any consumer runs
+    int numPosted = 0;
+    while (producer.tryPost(1, &numPosted, sizeof(numPosted)))
+    {
+        ++numPosted;
+    }
+    EXPECT_EQ(64, numPosted);
+    EXPECT_TRUE(consumer->tryPop(message));
+    EXPECT_EQ(0, consumer->run(message)); //message 0
+    message._functionId = 4;
+    EXPECT_EQ((int)ITask::RetCode::NotCallable, consumer->run(message));
+    EXPECT_TRUE(producer.tryPost(2, nullptr, 0));
+    
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(2);
+    config.setSharedMemoryQueue(consumer);
+    config.setSharedMemoryQueuePollIntervalMs(ms(1));
+    consumer->registerHandler(2, [&numEmpty](const char*, size_t)->int {
+        ++numEmpty;
+        return 0;
+    });
+    Dispatcher dispatcher(config);
+    //idle IO threads drain the ring, then keep polling it
+    for (int i = numPosted; i < numPosted + 100; ++i)
+    {
+        while (!producer.tryPost(1, &i, sizeof(i)))
+        {
+            std::this_thread::sleep_for(ms(1));
+        }
+    }
+    int expected = (numPosted + 99) * (numPosted + 100) / 2;
+    for (int i = 0; (i < 5000) && ((sum != expected) || (numEmpty != 1)); ++i)
+    {
+        std::this_thread::sleep_for(ms(1));
+    }
+    EXPECT_EQ(expected, sum);
+    EXPECT_EQ(1, numEmpty);
+    EXPECT_EQ(0u, producer.size());
+    EXPECT_EQ(0u, consumer->numRejected());
+    //local work still runs
+    EXPECT_EQ(5, dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+        return promise->set(5);
+    })->get());
+    EXPECT_TRUE(SharedMemoryQueue::remove(name));
+}
+
+TEST(StressTest, CoroutineWorkStealing)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(1);
+    config.setCoroutineWorkStealing(true);
+    config.setCoroutineWorkStealingPollIntervalUs(us(100));
+    Dispatcher dispatcher(config);
+    
+    //Block the first queue so that the coroutines queued behind it have to be stolen
+    dispatcher.post(0, false, [](CoroContext<int>::Ptr)->int{
+        std::this_thread::sleep_for(ms(200));
+        return 0;
+    });
+    std::atomic_int count{0};
+    for (int i = 0; i < 100; ++i)
+    {
+        dispatcher.post([&count](CoroContext<int>::Ptr)->int{
+            std::this_thread::sleep_for(ms(1));
+            ++count;
+            return 0;
+        });
+    }
+    dispatcher.drain();
+    EXPECT_EQ(100, count);
+    QueueStatistics stats = dispatcher.stats(IQueue::QueueType::Coro);
+    EXPECT_EQ((size_t)101, stats.completedCount());
+    EXPECT_LT((size_t)0, stats.stolenCount());
+    EXPECT_EQ((size_t)0, dispatcher.stats(IQueue::QueueType::Coro, 0).stolenCount());
+}
+
+TEST(StressTest, ConcurrentPosting)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    std::atomic_int count{0};
+    std::vector<int> order;
+    
+    //Tasks posted by a single producer to the same queue run in posting order
+    std::thread ordered([&dispatcher, &order]{
+        for (int i = 0; i < 1000; ++i)
+        {
+            dispatcher.post(0, false, [&order, i](CoroContext<int>::Ptr ctx)->int{
+                order.push_back(i);
+                return ctx->set(0);
+            });
+        }
+    });
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 8; ++p)
+    {
+        producers.emplace_back([&dispatcher, &count]{
+            for (int i = 0; i < 1000; ++i)
+            {
+                dispatcher.post([&count](CoroContext<int>::Ptr ctx)->int{
+                    ++count;
+                    return ctx->set(0);
+                });
+            }
+        });
+    }
+    ordered.join();
+    for (auto&& producer : producers)
+    {
+        producer.join();
+    }
+    dispatcher.drain();
+    EXPECT_EQ(8000, count);
+    ASSERT_EQ((size_t)1000, order.size());
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+    EXPECT_EQ((size_t)9000, dispatcher.stats(IQueue::QueueType::Coro).postedCount());
+    EXPECT_EQ((size_t)9000, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+}
+
+TEST(StressTest, PostBatch)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<std::function<int(CoroContext<int>::Ptr)>> funcs;
+    for (int i = 0; i < 100; ++i)
+    {
+        funcs.emplace_back([i](CoroContext<int>::Ptr ctx)->int{
+            return ctx->set(i);
+        });
+    }
+    std::vector<ThreadContextPtr<int>> contexts = dispatcher.postBatch<int>(funcs.begin(), funcs.end());
+    ASSERT_EQ(funcs.size(), contexts.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, contexts[i]->get());
+    }
+    
+    //Post a batch from within a coroutine on the same queue
+    int sum = dispatcher.post([&funcs](CoroContext<int>::Ptr ctx)->int{
+        std::vector<CoroContextPtr<int>> children = ctx->postBatch<int>((int)IQueue::QueueId::Same, false, funcs.begin(), funcs.end());
+        int total = 0;
+        for (auto&& child : children)
+        {
+            total += child->get(ctx);
+        }
+        return ctx->set(total);
+    })->get();
+    EXPECT_EQ(4950, sum);
+}
+
+TEST(StressTest, PostAsyncIoBatch)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<std::function<int(ThreadPromise<int>::Ptr)>> funcs;
+    for (int i = 0; i < 100; ++i)
+    {
+        funcs.emplace_back([i](ThreadPromise<int>::Ptr promise)->int{
+            return promise->set(i);
+        });
+    }
+    std::vector<ThreadFuturePtr<int>> futures = dispatcher.postAsyncIoBatch<int>(funcs.begin(), funcs.end());
+    ASSERT_EQ(funcs.size(), futures.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, futures[i]->get());
+    }
+    futures = dispatcher.postAsyncIoBatch<int>(1, true, funcs.begin(), funcs.end());
+    EXPECT_EQ(4950, std::accumulate(futures.begin(), futures.end(), 0, [](int total, ThreadFuturePtr<int>& future){
+        return total + future->get();
+    }));
+    EXPECT_THROW(dispatcher.postAsyncIoBatch<int>(DispatcherSingleton::numThreads, false, funcs.begin(), funcs.end()),
+                 std::runtime_error);
+    
+    //Post a batch from within a coroutine and join the results
+    std::vector<int> output = dispatcher.post<std::vector<int>>([&funcs](CoroContext<std::vector<int>>::Ptr ctx)->int{
+        std::vector<CoroFuturePtr<int>> children = ctx->postAsyncIoBatch<int>(funcs.begin(), funcs.end());
+        return ctx->set(FutureJoiner<int>()(*ctx, std::move(children))->get(ctx));
+    })->get();
+    ASSERT_EQ(100u, output.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, output[i]);
+    }
+}
+
+#if defined(__linux__)
+TEST(StressTest, AwaitFileDescriptor)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    int fds[2];
+    ASSERT_EQ(0, ::pipe2(fds, O_NONBLOCK));
+    
+    //Nothing has been written yet so the wait times out
+    EXPECT_EQ(0, dispatcher.post<int>([&fds](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(ctx->awaitReadable(fds[0], ms(10)));
+    })->get());
+    
+    //Read blocks the coroutine until the data is written from another thread
+    auto future = dispatcher.post<std::string>([&fds](CoroContext<std::string>::Ptr ctx)->int{
+        std::string data;
+        char buf[16];
+        while (data.size() < 10)
+        {
+            ssize_t rc = ctx->read(fds[0], buf, sizeof(buf));
+            if (rc <= 0)
+            {
+                break;
+            }
+            data.append(buf, rc);
+        }
+        return ctx->set(data);
+    });
+    std::this_thread::sleep_for(ms(20));
+    EXPECT_EQ(std::future_status::timeout, future->waitFor(ms(0)));
+    ASSERT_EQ(5, ::write(fds[1], "hello", 5));
+    std::this_thread::sleep_for(ms(20));
+    ASSERT_EQ(5, ::write(fds[1], "world", 5));
+    EXPECT_EQ("helloworld", future->get());
+    
+    EXPECT_NE(0, dispatcher.post<int>([&fds](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(ctx->awaitWritable(fds[1], ms(1000)));
+    })->get());
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+#endif
+
+TEST(StressTest, PostAfterAndEvery)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto start = std::chrono::steady_clock::now();
+    auto ctx = dispatcher.postAfter<int>(ms(50), [](CoroContext<int>::Ptr ctx, int value)->int{
+        return ctx->set(value);
+    }, 5);
+    EXPECT_EQ(7, dispatcher.postAfter<int>(ms(10), 0, true, [](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(7);
+    })->get());
+    EXPECT_EQ(std::future_status::timeout, ctx->waitFor(ms(0)));
+    EXPECT_EQ(5, ctx->get());
+    EXPECT_GE(std::chrono::duration_cast<ms>(std::chrono::steady_clock::now() - start).count(), 50);
+    
+    std::atomic_int count(0);
+    uint64_t timerId = dispatcher.postEvery(ms(10), [&count](CoroContext<int>::Ptr ctx)->int{
+        ++count;
+        return ctx->set(0);
+    });
+    std::this_thread::sleep_for(ms(100));
+    EXPECT_TRUE(dispatcher.cancelTimer(timerId));
+    EXPECT_FALSE(dispatcher.cancelTimer(timerId));
+    EXPECT_GE(count, 5);
+    dispatcher.drain();
+    int total = count;
+    std::this_thread::sleep_for(ms(30));
+    EXPECT_EQ(total, count);
+    EXPECT_THROW(dispatcher.postEvery(ms(0), [](CoroContext<int>::Ptr ctx)->int{ return ctx->set(0); }),
+                 std::runtime_error);
+}
+
+TEST(StressTest, IoGroupLimits)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    dispatcher.setIoGroupLimits("limited", 2);
+    std::atomic_int running(0);
+    std::atomic_int maxRunning(0);
+    std::vector<ThreadFuturePtr<int>> futures;
+    for (int i = 0; i < 20; ++i)
+    {
+        futures.emplace_back(dispatcher.postAsyncIoGroup("limited", [&running, &maxRunning, i](ThreadPromise<int>::Ptr promise)->int{
+            int num = ++running;
+            int max = maxRunning;
+            while ((num > max) && !maxRunning.compare_exchange_weak(max, num));
+            std::this_thread::sleep_for(ms(2));
+            --running;
+            return promise->set(i);
+        }));
+    }
+    EXPECT_EQ(190, std::accumulate(futures.begin(), futures.end(), 0, [](int total, ThreadFuturePtr<int>& future){
+        return total + future->get();
+    }));
+    EXPECT_LE(maxRunning, 2);
+    IoGroupStatistics stats = dispatcher.ioGroupStats("limited");
+    EXPECT_EQ(20u, stats.postedCount());
+    EXPECT_EQ(20u, stats.completedCount());
+    EXPECT_EQ(0u, stats.queuedCount());
+    EXPECT_LE(18u, stats.throttledCount());
+    
+    //10 tasks at 200 per second take at least 45ms after the first one
+    dispatcher.setIoGroupLimits("rated", 0, 200, 1);
+    auto start = std::chrono::steady_clock::now();
+    int total = dispatcher.post<int>([](CoroContext<int>::Ptr ctx)->int{
+        std::vector<CoroFuturePtr<int>> children;
+        for (int i = 0; i < 10; ++i)
+        {
+            children.emplace_back(ctx->postAsyncIoGroup<int>("rated", [](ThreadPromise<int>::Ptr promise)->int{
+                return promise->set(1);
+            }));
+        }
+        int total = 0;
+        for (auto&& child : children)
+        {
+            total += child->get(ctx);
+        }
+        return ctx->set(total);
+    })->get();
+    EXPECT_EQ(10, total);
+    EXPECT_GE(std::chrono::duration_cast<ms>(std::chrono::steady_clock::now() - start).count(), 40);
+    EXPECT_THROW(dispatcher.postAsyncIoGroup("unknown", [](ThreadPromise<int>::Ptr promise)->int{
+        return promise->set(0);
+    }), std::runtime_error);
+}
+
+TEST(StressTest, IdleSleepUntilSignalled)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setIdleSpinCount(100);
+    config.setIdleYieldCount(10);
+    Dispatcher dispatcher(config);
+    
+    //The coroutine thread goes to sleep while both coroutines are waiting and
+    //gets woken up by the IO task and by the sleep timer respectively.
+    ThreadContextPtr<int> waiter = dispatcher.post([](CoroContext<int>::Ptr ctx)->int{
+        CoroFuturePtr<int> io = ctx->postAsyncIo([](ThreadPromisePtr<int> promise)->int{
+            std::this_thread::sleep_for(ms(50));
+            return promise->set(7);
+        });
+        return ctx->set(io->get(ctx));
+    });
+    ThreadContextPtr<int> sleeper = dispatcher.post([](CoroContext<int>::Ptr ctx)->int{
+        ctx->sleep(ms(20));
+        return ctx->set(3);
+    });
+    EXPECT_EQ(3, sleeper->get());
+    EXPECT_EQ(7, waiter->get());
+}
+
+TEST(StressTest, IoPriorityLevels)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setNumPriorityLevels(3);
+    config.setPriorityLevelWeight(2);
+    Dispatcher dispatcher(config);
+    
+    //Hold the IO thread until all the tasks are queued
+    std::promise<void> gate, started;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+    ThreadFuturePtr<int> blocker = dispatcher.postAsyncIo(0, false, [gateFuture, &started](ThreadPromisePtr<int> promise)->int{
+        started.set_value();
+        gateFuture.wait();
+        return promise->set(0);
+    });
+    started.get_future().wait();
+    
+    std::vector<int> order;
+    std::vector<ThreadFuturePtr<int>> futures;
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int level = 0; level < 3; ++level)
+        {
+            futures.push_back(dispatcher.postAsyncIo(0, level, [&order, level](ThreadPromisePtr<int> promise)->int{
+                order.push_back(level);
+                return promise->set(level);
+            }));
+        }
+    }
+    gate.set_value();
+    for (auto&& future : futures)
+    {
+        future->get();
+    }
+    ASSERT_EQ(30u, order.size());
+    //The highest level runs first but the lowest level still progresses before it drains
+    EXPECT_EQ(2, order[0]);
+    size_t firstLow = std::find(order.begin(), order.end(), 0) - order.begin();
+    size_t lastHigh = std::find(order.rbegin(), order.rend(), 2).base() - order.begin() - 1;
+    EXPECT_LT(firstLow, lastHigh);
+    
+    //Negative priorities are rejected
+    EXPECT_THROW(dispatcher.post(0, -1, [](CoroContext<int>::Ptr ctx)->int{ return ctx->set(0); }), std::runtime_error);
+}
+
+TEST(StressTest, CoroutinePriorityLevels)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setNumPriorityLevels(2);
+    config.setPriorityLevelWeight(3);
+    Dispatcher dispatcher(config);
+    
+    //Hold the coroutine thread until all the coroutines are queued
+    std::promise<void> gate, started;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+    ThreadContextPtr<int> blocker = dispatcher.post(0, false, [gateFuture, &started](CoroContext<int>::Ptr ctx)->int{
+        started.set_value();
+        gateFuture.wait();
+        return ctx->set(0);
+    });
+    started.get_future().wait();
+    
+    std::vector<int> order;
+    std::vector<ThreadContextPtr<int>> contexts;
+    auto post = [&](int id, int level, int numSlices)
+    {
+        contexts.push_back(dispatcher.post(0, level, [&order, id, numSlices](CoroContext<int>::Ptr ctx)->int{
+            for (int i = 0; i < numSlices; ++i)
+            {
+                order.push_back(id);
+                ctx->yield();
+            }
+            return ctx->set(id);
+        }));
+    };
+    post(1, 1, 9);
+    post(2, 1, 9);
+    post(0, 0, 3);
+    gate.set_value();
+    for (auto&& context : contexts)
+    {
+        context->get();
+    }
+    ASSERT_EQ(21u, order.size());
+    //While all three are runnable, each round gives 3 slices to each high priority coroutine and
+    //1 to the low priority one, interleaved rather than back to back.
+    for (size_t i = 1; i < 14; ++i)
+    {
+        EXPECT_NE(order[i-1], order[i]);
+    }
+    EXPECT_EQ(2, std::count(order.begin(), order.begin() + 14, 0));
+}
+
+TEST(StressTest, EarliestDeadlineFirst)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setCoroutineSchedulingPolicy(Configuration::SchedulingPolicy::EarliestDeadlineFirst);
+    config.setDropExpiredCoroutines(true);
+    Dispatcher dispatcher(config);
+    
+    //Keep the coroutine thread busy until all the coroutines are posted
+    std::atomic_bool released(false), started(false);
+    ThreadContextPtr<int> blocker = dispatcher.post([&](CoroContext<int>::Ptr ctx)->int{
+        started = true;
+        while (!released)
+        {
+            std::this_thread::yield();
+        }
+        return ctx->set(0);
+    });
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+    
+    std::vector<int> order;
+    std::vector<ThreadContextPtr<int>> contexts;
+    Dispatcher::TimePoint now = std::chrono::high_resolution_clock::now();
+    for (int i = 9; i >= 0; --i)
+    {
+        contexts.push_back(dispatcher.postWithDeadline(now + std::chrono::seconds(60 + i), [&order, i](CoroContext<int>::Ptr ctx)->int{
+            order.push_back(i);
+            return ctx->set(i);
+        }));
+    }
+    ThreadContextPtr<int> expired = dispatcher.postWithDeadline(now - ms(1), [](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(-1);
+    });
+    released = true;
+    for (auto&& ctx : contexts)
+    {
+        ctx->get();
+    }
+    EXPECT_EQ(std::vector<int>({0,1,2,3,4,5,6,7,8,9}), order);
+    EXPECT_THROW(expired->get(), std::runtime_error);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::Coro, 0).expiredCount());
+}
+
+TEST(StressTest, LongSliceDetection)
+{
+    std::atomic_int numCallbacks(0), callbackQueueId(-1);
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setLongSliceThresholdUs(std::chrono::microseconds(10000));
+    config.setLongSliceCallback([&](int queueId, const void*, std::chrono::microseconds duration){
+        EXPECT_GE(duration.count(), 10000);
+        callbackQueueId = queueId;
+        ++numCallbacks;
+    });
+    Dispatcher dispatcher(config);
+    
+    //This coroutine monopolizes the thread without yielding
+    std::atomic_bool started(false);
+    ThreadContextPtr<int> hog = dispatcher.post([&started](CoroContext<int>::Ptr ctx)->int{
+        started = true;
+        std::this_thread::sleep_for(ms(100));
+        return ctx->set(0);
+    });
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+    ThreadContextPtr<int> starved = dispatcher.post([](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(1);
+    });
+    std::this_thread::sleep_for(ms(50));
+    EXPECT_GE(dispatcher.oldestRunnableWaitTime(0).count(), 20000);
+    EXPECT_EQ(1, starved->get());
+    hog->get();
+    EXPECT_EQ(std::chrono::microseconds(0), dispatcher.oldestRunnableWaitTime());
+    EXPECT_EQ(1, numCallbacks);
+    EXPECT_EQ(0, callbackQueueId);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::Coro, 0).longSliceCount());
+}
+
+TEST(AllocatorTest, GuardedCoroutineStacks)
+{
+    bool useGuardedStacks = AllocatorTraits::useGuardedCoroStacks();
+    int releaseThreshold = AllocatorTraits::coroStackReleaseThreshold();
+    AllocatorTraits::useGuardedCoroStacks() = true;
+    AllocatorTraits::coroStackReleaseThreshold() = 0;
+    {
+        CoroutinePoolAllocator<StackTraitsProxy> allocator(2);
+        boost::context::stack_context stacks[3];
+        for (auto& stack : stacks) {
+            stack = allocator.allocate();
+            ASSERT_NE(nullptr, stack.sp);
+            std::memset(static_cast<char*>(stack.sp) - stack.size, 0xAB, stack.size); //whole stack is writable
+        }
+        EXPECT_EQ(2u, allocator.allocatedBlocks());
+        EXPECT_EQ(1u, allocator.allocatedHeapBlocks()); //pool exhausted
+        EXPECT_DEATH(*(static_cast<volatile char*>(stacks[0].sp) - stacks[0].size - 1) = 0, ""); //guard page
+        for (auto& stack : stacks) {
+            allocator.deallocate(stack);
+        }
+        EXPECT_TRUE(allocator.isFull());
+        EXPECT_EQ(0u, allocator.allocatedHeapBlocks());
+        //released pages are zero-filled when reused
+        boost::context::stack_context stack = allocator.allocate();
+        EXPECT_EQ(0, *(static_cast<char*>(stack.sp) - 1));
+        allocator.deallocate(stack);
+    }
+    AllocatorTraits::useGuardedCoroStacks() = useGuardedStacks;
+    AllocatorTraits::coroStackReleaseThreshold() = releaseThreshold;
+}
+
+TEST(AllocatorTest, ThreadCache)
+{
+    AllocatorTraits::size_type cacheSize = AllocatorTraits::threadCacheSize();
+    AllocatorTraits::threadCacheSize() = 4;
+    {
+        HeapAllocator<int> allocator(8);
+        int* blocks[3];
+        for (auto& block : blocks) {
+            block = allocator.allocate();
+        }
+        EXPECT_EQ(3u, allocator.allocatedBlocks());
+        for (auto& block : blocks) {
+            allocator.deallocate(block);
+        }
+        EXPECT_TRUE(allocator.isFull());
+        //blocks cached by this thread are not visible to others
+        size_t cached = 0;
+        std::thread([&]{
+            std::vector<int*> others;
+            for (int i = 0; i < 8; ++i) {
+                others.push_back(allocator.allocate());
+            }
+            cached = allocator.allocatedHeapBlocks();
+            for (auto& block : others) {
+                allocator.deallocate(block);
+            }
+        }).join();
+        EXPECT_GT(cached, 0u);
+        EXPECT_LE(cached, 4u);
+        EXPECT_TRUE(allocator.isFull());
+        EXPECT_EQ(0u, allocator.allocatedHeapBlocks());
+    }
+    {
+        CoroutinePoolAllocator<StackTraitsProxy> allocator(4);
+        boost::context::stack_context stacks[5];
+        for (auto& stack : stacks) {
+            stack = allocator.allocate();
+        }
+        EXPECT_EQ(4u, allocator.allocatedBlocks());
+        EXPECT_EQ(1u, allocator.allocatedHeapBlocks());
+        std::thread([&]{
+            for (auto& stack : stacks) {
+                allocator.deallocate(stack);
+            }
+        }).join();
+        EXPECT_TRUE(allocator.isFull());
+        EXPECT_EQ(0u, allocator.allocatedHeapBlocks());
+    }
+    AllocatorTraits::threadCacheSize() = cacheSize;
+}
+
+TEST(AllocatorTest, LazyCoroutineStackChunks)
+{
+    AllocatorTraits::size_type chunkSize = AllocatorTraits::coroPoolChunkSize();
+    AllocatorTraits::size_type cacheSize = AllocatorTraits::threadCacheSize();
+    for (AllocatorTraits::size_type size : {0, 3}) {
+        for (AllocatorTraits::size_type cache : {0, 4}) {
+            AllocatorTraits::coroPoolChunkSize() = size;
+            AllocatorTraits::threadCacheSize() = cache;
+            CoroutinePoolAllocator<StackTraitsProxy> allocator(8);
+            allocator.warmUp(2);
+            std::vector<boost::context::stack_context> stacks;
+            for (int i = 0; i < 8; ++i) {
+                stacks.push_back(allocator.allocate());
+                char* bottom = static_cast<char*>(stacks.back().sp) - stacks.back().size;
+                std::memset(bottom, i, stacks.back().size);
+            }
+            EXPECT_EQ(8u, allocator.allocatedBlocks());
+            EXPECT_EQ(0u, allocator.allocatedHeapBlocks());
+            for (int i = 0; i < 8; ++i) {
+                //stacks carved out of the same chunk do not overlap
+                const char* bottom = static_cast<const char*>(stacks[i].sp) - stacks[i].size;
+                EXPECT_EQ(bottom + stacks[i].size, std::find_if(bottom, bottom + stacks[i].size,
+                                                                [i](char c){ return c != (char)i; }));
+                allocator.deallocate(stacks[i]);
+            }
+            EXPECT_TRUE(allocator.isFull());
+        }
+    }
+    AllocatorTraits::coroPoolChunkSize() = chunkSize;
+    AllocatorTraits::threadCacheSize() = cacheSize;
+    
+    EXPECT_NO_THROW(Dispatcher::warmUpPools(10));
+}
+
+TEST(AllocatorTest, SegmentedPool)
+{
+    AllocatorTraits::size_type segmentSize = AllocatorTraits::poolSegmentSize();
+    bool releaseIdleSegments = AllocatorTraits::releaseIdlePoolSegments();
+    AllocatorTraits::poolSegmentSize() = 10000;
+    AllocatorTraits::releaseIdlePoolSegments() = true;
+    {
+        HeapAllocator<int> allocator(1000);
+        std::vector<int*> blocks;
+        for (int i = 0; i < 70000; ++i) { //more than uint16_t can index
+            blocks.push_back(allocator.allocate());
+            *blocks.back() = i;
+        }
+        EXPECT_EQ(70000u, allocator.allocatedBlocks());
+        EXPECT_EQ(0u, allocator.allocatedHeapBlocks());
+        EXPECT_EQ(7u, allocator.numSegments());
+        for (int i = 0; i < 70000; ++i) {
+            EXPECT_EQ(i, *blocks[i]);
+            allocator.deallocate(blocks[i]);
+        }
+        EXPECT_TRUE(allocator.isFull());
+        EXPECT_EQ(1u, allocator.numSegments()); //idle segments released
+    }
+    AllocatorTraits::poolSegmentSize() = segmentSize;
+    AllocatorTraits::releaseIdlePoolSegments() = releaseIdleSegments;
+}
+
+TEST(AllocatorTest, Statistics)
+{
+    HeapAllocator<int> allocator(2);
+    int* blocks[3];
+    for (auto& block : blocks) {
+        block = allocator.allocate();
+    }
+    allocator.deallocate(blocks[2]);
+    AllocatorStatistics stats = allocator.stats();
+    EXPECT_EQ(2u, stats.capacity());
+    EXPECT_EQ(2u, stats.allocatedCount());
+    EXPECT_EQ(3u, stats.peakAllocatedCount());
+    EXPECT_EQ(0u, stats.heapAllocatedCount());
+    EXPECT_EQ(1u, stats.heapFallbackCount());
+    allocator.deallocate(blocks[0]);
+    allocator.deallocate(blocks[1]);
+    
+    const std::map<std::string, AllocatorStatistics> pools = Dispatcher::allocatorStats();
+    ASSERT_EQ(1u, pools.count("task"));
+    EXPECT_EQ(AllocatorTraits::taskAllocSize(), pools.at("task").capacity());
+    EXPECT_EQ(1u, pools.count("coroStack"));
+}
+
+TEST(AllocatorTest, CrossThreadContention)
+{
+    //blocks are allocated by producers and freed by consumers, with and without the thread cache
+    const int numThreads = 4, numBlocks = 10000;
+    AllocatorTraits::size_type cacheSize = AllocatorTraits::threadCacheSize();
+    for (AllocatorTraits::size_type size : {0, 4}) {
+        AllocatorTraits::threadCacheSize() = size;
+        HeapAllocator<int> allocator(64);
+        std::mutex mutex;
+        std::deque<int*> blocks;
+        std::atomic<int> numProducers(numThreads);
+        std::vector<std::atomic<int>> seen(numThreads * numBlocks);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t]{
+                for (int i = 0; i < numBlocks; ++i) {
+                    int* block = allocator.allocate();
+                    *block = t * numBlocks + i;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    blocks.push_back(block);
+                }
+                --numProducers;
+            });
+            threads.emplace_back([&]{
+                while (true) {
+                    int* block = nullptr;
+                    bool done = (numProducers == 0);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!blocks.empty()) {
+                            block = blocks.front();
+                            blocks.pop_front();
+                        }
+                    }
+                    if (!block) {
+                        if (done) {
+                            break;
+                        }
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    ++seen[*block];
+                    allocator.deallocate(block);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        //a block handed out twice while in use overwrites one value and repeats another
+        EXPECT_EQ(0, std::count_if(seen.begin(), seen.end(), [](const std::atomic<int>& n){ return n != 1; }));
+        EXPECT_TRUE(allocator.isFull());
+        EXPECT_EQ(0u, allocator.allocatedHeapBlocks());
+    }
+    AllocatorTraits::threadCacheSize() = cacheSize;
+}
+
+TEST(AllocatorTest, StackSizeClasses)
+{
+    const size_t largeStack = 1024*1024;
+    EXPECT_NE(&Task::stackAllocator(0), &Task::stackAllocator(largeStack));
+    EXPECT_EQ(&Task::stackAllocator(largeStack-1), &Task::stackAllocator(largeStack));
+    auto deepFunc = [](CoroContext<int>::Ptr ctx)->int {
+        volatile char buffer[512*1024]; //does not fit in the default stack
+        buffer[0] = 1;
+        buffer[sizeof(buffer)-1] = 2;
+        return ctx->set(buffer[0] + buffer[sizeof(buffer)-1]);
+    };
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    ThreadContextPtr<int> ctx = dispatcher.postFirstWithStackSize(largeStack, deepFunc)->then(deepFunc)->end();
+    EXPECT_EQ(3, ctx->get());
+    EXPECT_EQ(3, dispatcher.postWithStackSize(largeStack, deepFunc)->get());
+#ifndef __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR
+    EXPECT_GE(Task::stackAllocator(largeStack).stats().peakAllocatedCount(), 1u);
+#endif
+}
+
+TEST(AllocatorTest, HugePages)
+{
+    void* region = HugePages::allocate(1);
+#if defined(__linux__)
+    ASSERT_NE(nullptr, region);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(region) % HugePages::PageSize);
+    std::memset(region, 1, HugePages::PageSize);
+#endif
+    HugePages::deallocate(region, 1);
+    
+    bool useHugePages = AllocatorTraits::useHugePages();
+    AllocatorTraits::useHugePages() = true;
+    {
+        HeapAllocator<int> allocator(1000);
+        int* block = allocator.allocate();
+        *block = 5;
+        EXPECT_EQ(1u, allocator.allocatedBlocks());
+        allocator.deallocate(block);
+        
+        CoroutinePoolAllocator<StackTraitsProxy> stackAllocator(4);
+        boost::context::stack_context stack = stackAllocator.allocate();
+        ASSERT_NE(nullptr, stack.sp);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(stack.sp) % 16);
+        std::memset(static_cast<char*>(stack.sp) - stack.size, 0xAB, stack.size);
+        stackAllocator.deallocate(stack);
+        EXPECT_TRUE(stackAllocator.isFull());
+    }
+    AllocatorTraits::useHugePages() = useHugePages;
+}
+
+TEST(AllocatorTest, StackProfiling)
+{
+    bool profileStacks = AllocatorTraits::profileCoroStacks();
+    AllocatorTraits::profileCoroStacks() = true;
+    {
+        CoroutinePoolAllocator<StackTraitsProxy> allocator(2);
+        boost::context::stack_context stack;
+        {
+            CoroStackTag tag("deep");
+            stack = allocator.allocate();
+        }
+        std::memset(static_cast<char*>(stack.sp) - 10000, 0, 10000); //simulate 10000 bytes of stack usage
+        allocator.deallocate(stack);
+        stack = allocator.allocate(); //untagged
+        std::memset(static_cast<char*>(stack.sp) - 100, 0, 100);
+        allocator.deallocate(stack);
+        
+        Histogram usage = allocator.stackUsage();
+        EXPECT_EQ(2u, usage.count());
+        EXPECT_EQ(100u, usage.min());
+        EXPECT_EQ(10000u, usage.max());
+        Histogram tagged = allocator.stackUsage("deep");
+        EXPECT_EQ(1u, tagged.count());
+        EXPECT_EQ(10000u, tagged.max());
+        EXPECT_EQ(0u, allocator.stackUsage("other").count());
+    }
+    AllocatorTraits::profileCoroStacks() = profileStacks;
+}
+
+TEST(FiberTest, ResumeYieldAndUnwind)
+{
+    CoroutinePoolAllocatorProxy<StackTraitsProxy> allocator(2);
+    std::vector<int> trace;
+    int rc = 0;
+    {
+        FiberCoroutine coro(allocator, [&](FiberYield& yield) {
+            trace.push_back(yield.get());
+            yield();
+            trace.push_back(yield.get());
+            yield.get() = 3;
+        });
+        EXPECT_TRUE(trace.empty()); //not started until resumed
+        EXPECT_EQ(1u, allocator.allocatedBlocks());
+        rc = 1;
+        coro(rc);
+        ASSERT_TRUE((bool)coro);
+        rc = 2;
+        coro(rc);
+        EXPECT_FALSE((bool)coro);
+        EXPECT_EQ(3, rc);
+        EXPECT_EQ(0u, allocator.allocatedBlocks()); //stack released on completion
+    }
+    EXPECT_EQ(std::vector<int>({1, 2}), trace);
+
+    //exceptions are rethrown to the resumer
+    FiberCoroutine throwing(allocator, [](FiberYield&) { throw std::runtime_error("fiber"); });
+    EXPECT_THROW(throwing(rc), std::runtime_error);
+    EXPECT_FALSE((bool)throwing);
+
+    //destroying a suspended coroutine unwinds its stack
+    bool unwound = false;
+    {
+        std::shared_ptr<int> guard(nullptr, [&](int*) { unwound = true; });
+        FiberCoroutine suspended(allocator, [guard](FiberYield& yield) mutable {
+            std::shared_ptr<int> local = std::move(guard);
+            while (true) {
+                yield();
+            }
+        });
+        guard.reset();
+        suspended(rc);
+        EXPECT_FALSE(unwound);
+    }
+    EXPECT_TRUE(unwound);
+    EXPECT_TRUE(allocator.isFull());
+}
+
+TEST(FunctionTest, PooledAndInline)
+{
+    //inline functor with a non-trivial capture
+    std::string small("abc");
+    Function<size_t()> f1([small]() { return small.size(); });
+    Function<size_t()> f2(f1);
+    Function<size_t()> f3(std::move(f1));
+    EXPECT_FALSE(f1);
+    EXPECT_EQ(3u, f2());
+    EXPECT_EQ(3u, f3());
+    
+    //oversize functor is allocated from the 512-byte size class
+    std::array<char, 300> big;
+    big.fill('x');
+    big[0] = 'y';
+    Function<char()> g1([big]() { return big[0]; });
+    Function<char()> g2(g1);
+    Function<char()> g3(std::move(g1));
+    EXPECT_EQ('y', g2());
+    EXPECT_EQ('y', g3());
+    auto stats = Dispatcher::allocatorStats();
+    ASSERT_EQ(1u, stats.count("function512"));
+    EXPECT_LE(2u, stats["function512"].allocatedCount());
+    
+    //a larger inline buffer keeps the same functor inline
+    Function<char(), 512> h([big]() { return big[0]; });
+    EXPECT_EQ('y', h());
+    
+    //non-copyable functors can be moved but not copied
+    std::unique_ptr<int> ptr(new int(5));
+    Function<int()> u1([p = std::move(ptr)]() { return *p; });
+    Function<int()> u2(std::move(u1));
+    EXPECT_EQ(5, u2());
+    EXPECT_THROW(Function<int()> u3(u2), std::runtime_error);
+}
+
+TEST(FunctionTest, MoveOnlyArguments)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    ThreadContext<int>::Ptr ctx = dispatcher.post([](CoroContext<int>::Ptr ctx, std::unique_ptr<int> coroValue)->int {
+        CoroFuture<int>::Ptr fut = ctx->postAsyncIo<int>([](ThreadPromise<int>::Ptr promise, std::unique_ptr<int> ioValue)->int {
+            return promise->set(*ioValue * 2);
+        }, std::unique_ptr<int>(new int(*coroValue + 1)));
+        return ctx->set(fut->get(ctx));
+    }, std::unique_ptr<int>(new int(20)));
+    EXPECT_EQ(42, ctx->get());
+}
+
+struct TestSharedPool
+{
+    static HeapAllocator<SharedBlock<std::string>>& instance()
+    {
+        static HeapAllocator<SharedBlock<std::string>> pool(4);
+        return pool;
+    }
+};
+
+TEST(AllocatorTest, SharedObjects)
+{
+    //the object and its reference counts take a single pool block
+    std::shared_ptr<std::string> str = allocateShared<std::string, TestSharedPool>("abc");
+    EXPECT_EQ("abc", *str);
+    EXPECT_EQ(1u, TestSharedPool::instance().stats().allocatedCount());
+    std::weak_ptr<std::string> weak = str;
+    str.reset();
+    EXPECT_EQ(1u, TestSharedPool::instance().stats().allocatedCount());
+    weak.reset();
+    EXPECT_EQ(0u, TestSharedPool::instance().stats().allocatedCount());
+    EXPECT_EQ(0u, TestSharedPool::instance().stats().heapFallbackCount());
+    
+#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
+    //contexts, tasks and promises are created the same way
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    EXPECT_EQ(5, dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(5);
+    })->get());
+    auto stats = Dispatcher::allocatorStats();
+    EXPECT_LE(1u, stats["context"].peakAllocatedCount());
+    EXPECT_LE(1u, stats["task"].peakAllocatedCount());
+    EXPECT_LE(1u, stats["promise"].peakAllocatedCount());
+#endif
+}
+
+TEST(SmallVectorTest, InlineAndHeap)
+{
+    SmallVector<std::shared_ptr<int>, 2> vec(1, std::make_shared<int>(0));
+    vec.emplace_back(std::make_shared<int>(1));
+    EXPECT_TRUE(vec.isInline());
+    vec.push_back(std::make_shared<int>(2)); //spills to the heap
+    EXPECT_FALSE(vec.isInline());
+    EXPECT_EQ(3u, vec.size());
+    SmallVector<std::shared_ptr<int>, 2> copy(vec);
+    EXPECT_EQ(2, *copy.back());
+    EXPECT_EQ(2, copy[0].use_count());
+    SmallVector<std::shared_ptr<int>, 2> moved(std::move(vec));
+    EXPECT_TRUE(vec.empty());
+    int sum = 0;
+    for (auto&& value : moved) {
+        sum += *value;
+    }
+    EXPECT_EQ(3, sum);
+    moved.pop_back();
+    EXPECT_EQ(1, *moved.back());
+    EXPECT_EQ(1, copy[2].use_count());
+}
+
+TEST(SmallVectorTest, LongContinuationChain)
+{
+    //more stages than are stored inline
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto stage = [](CoroContext<int>::Ptr ctx)->int {
+        int prev = ctx->getPrev<int>();
+        return ctx->set(prev + 1);
+    };
+    auto ctx = dispatcher.postFirst([](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(0);
+    });
+    for (int i = 0; i < 2 * __QUANTUM_CONTEXT_INLINE_PROMISES; ++i) {
+        ctx = ctx->then(stage);
+    }
+    EXPECT_EQ(2 * __QUANTUM_CONTEXT_INLINE_PROMISES, ctx->end()->get());
+}
+
+TEST(ForEachTest, Chunked)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<int> input(1000);
+    std::iota(input.begin(), input.end(), 0);
+    auto square = [](const int& value)->int { return value * value; };
+    for (size_t grainSize : {0u, 1u, 7u, 5000u}) {
+        std::vector<int> result = dispatcher.forEachChunked<int>(input.cbegin(), input.cend(), square, grainSize)->get();
+        ASSERT_EQ(input.size(), result.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            EXPECT_EQ(input[i] * input[i], result[i]);
+        }
+    }
+    EXPECT_TRUE(dispatcher.forEachChunked<int>(input.cbegin(), size_t{0}, square)->get().empty());
+    
+    //exceptions are propagated after all chunks were processed
+    auto thrower = [](const int& value)->int {
+        if (value == 500) throw std::runtime_error("element");
+        return value;
+    };
+    EXPECT_THROW(dispatcher.forEachChunked<int>(input.cbegin(), input.cend(), thrower, 10)->get(), std::runtime_error);
+    
+    //from within a coroutine
+    std::list<int> list(input.begin(), input.end());
+    int sum = dispatcher.post([&list](CoroContext<int>::Ptr ctx)->int {
+        std::vector<int> values = ctx->forEachChunked<int>(list.cbegin(), list.size(), [](const int& value)->int {
+            return value;
+        })->get(ctx);
+        return ctx->set(std::accumulate(values.begin(), values.end(), 0));
+    })->get();
+    EXPECT_EQ(999*1000/2, sum);
+}
+
+TEST(ForEachTest, BatchSplit)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<int> input(2000);
+    std::iota(input.begin(), input.end(), 0);
+    auto skewed = [](const int& value)->int {
+        if (value >= 1900) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200)); //expensive tail
+        }
+        return value * 2;
+    };
+    for (size_t grainSize : {0u, 1u, 64u, 5000u}) {
+        std::vector<std::vector<int>> batches = dispatcher.forEachBatchSplit<int>(input.cbegin(), input.cend(), skewed, grainSize)->get();
+        std::vector<int> result;
+        for (auto&& batch : batches) {
+            EXPECT_FALSE(batch.empty());
+            result.insert(result.end(), batch.begin(), batch.end());
+        }
+        ASSERT_EQ(input.size(), result.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            EXPECT_EQ(input[i] * 2, result[i]);
+        }
+    }
+    EXPECT_TRUE(dispatcher.forEachBatchSplit<int>(input.cbegin(), input.cbegin(), skewed)->get().empty());
+    
+    auto thrower = [](const int& value)->int {
+        if (value == 1500) throw std::runtime_error("element");
+        return value;
+    };
+    EXPECT_THROW(dispatcher.forEachBatchSplit<int>(input.cbegin(), input.cend(), thrower, 10)->get(), std::runtime_error);
+    
+    //from within a coroutine
+    int total = dispatcher.post([&input](CoroContext<int>::Ptr ctx)->int {
+        int count = 0;
+        for (auto&& batch : ctx->forEachBatchSplit<int>(input.cbegin(), input.cend(), [](const int& value)->int {
+            return value;
+        })->get(ctx)) {
+            count += batch.size();
+        }
+        return ctx->set(count);
+    })->get();
+    EXPECT_EQ((int)input.size(), total);
+}
+
+TEST(NumaTopology, Placement)
+{
+    EXPECT_EQ(NumaTopology::CpuSet({0,1,2,3,8,10,11}), NumaTopology::parseCpuList("0-3,8,10-11\n"));
+    
+    NumaTopology topology({{0,1,2,3},{},{4,5,6,7}});
+    ASSERT_EQ(2u, topology.numNodes());
+    EXPECT_EQ(NumaTopology::CpuSet({4,5,6,7}), topology.getNodeCpus(1));
+    
+    //Spread alternates between the nodes
+    EXPECT_EQ(NumaTopology::CpuSet({0}), topology.getCoroutineThreadCpus(Configuration::ThreadPlacement::SpreadThreadsAcrossNodes, 0));
+    EXPECT_EQ(NumaTopology::CpuSet({4}), topology.getCoroutineThreadCpus(Configuration::ThreadPlacement::SpreadThreadsAcrossNodes, 1));
+    EXPECT_EQ(NumaTopology::CpuSet({1}), topology.getCoroutineThreadCpus(Configuration::ThreadPlacement::SpreadThreadsAcrossNodes, 2));
+    EXPECT_EQ(NumaTopology::CpuSet({4,5,6,7}), topology.getIoThreadCpus(Configuration::ThreadPlacement::SpreadThreadsAcrossNodes, 3));
+    
+    //Pack fills the first node before using the second one
+    EXPECT_EQ(NumaTopology::CpuSet({3}), topology.getCoroutineThreadCpus(Configuration::ThreadPlacement::PackThreadsOnNodes, 3));
+    EXPECT_EQ(NumaTopology::CpuSet({4}), topology.getCoroutineThreadCpus(Configuration::ThreadPlacement::PackThreadsOnNodes, 4));
+    EXPECT_EQ(NumaTopology::CpuSet({0,1,2,3}), topology.getIoThreadCpus(Configuration::ThreadPlacement::PackThreadsOnNodes, 3));
+    EXPECT_TRUE(topology.getCoroutineThreadCpus(Configuration::ThreadPlacement::Default, 0).empty());
+    
+    //The current machine always has at least one node
+    EXPECT_GE(NumaTopology::instance().numNodes(), 1u);
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(2);
+    config.setThreadPlacement(Configuration::ThreadPlacement::SpreadThreadsAcrossNodes);
+    Dispatcher dispatcher(config);
+    EXPECT_EQ(5, dispatcher.post([](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(ctx->postAsyncIo([](ThreadPromisePtr<int> promise)->int{
+            return promise->set(5);
+        })->get(ctx));
+    })->get());
+}
+
+#if defined(__linux__)
+TEST(NumaTopology, IoThreadCpus)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(2);
+    config.setIoThreadCpus("0");
+    config.setPinIoThreadsToCores(true);
+    config.setIoThreadSchedPolicy(Configuration::SchedPolicy::Batch);
+    Dispatcher dispatcher(config);
+    for (int queueId = 0; queueId < 2; ++queueId)
+    {
+        //Each IO thread is bound to CPU 0 only
+        EXPECT_EQ(1, dispatcher.postAsyncIo(queueId, false, [](ThreadPromisePtr<int> promise)->int{
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            return promise->set((CPU_COUNT(&cpus) == 1) && CPU_ISSET(0, &cpus));
+        })->get());
+        EXPECT_EQ(SCHED_BATCH, dispatcher.postAsyncIo(queueId, false, [](ThreadPromisePtr<int> promise)->int{
+            return promise->set(sched_getscheduler(0));
+        })->get());
+    }
+}
+#endif
+
+TEST(StressTest, ResizeCoroutineThreads)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setMaxNumCoroutineThreads(4);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    EXPECT_EQ(4, dispatcher.getNumCoroutineThreads());
+    EXPECT_EQ(2, dispatcher.getNumActiveCoroutineThreads());
+    EXPECT_THROW(dispatcher.setNumActiveCoroutineThreads(5), std::runtime_error);
+    EXPECT_THROW(dispatcher.setNumActiveCoroutineThreads(0), std::runtime_error);
+    
+    std::mutex m;
+    std::set<std::thread::id> threads;
+    auto func = [&](CoroContext<int>::Ptr ctx)->int{
+        ctx->yield();
+        {
+            std::lock_guard<std::mutex> lock(m);
+            threads.insert(std::this_thread::get_id());
+        }
+        return ctx->set(0);
+    };
+    auto runAll = [&](int num)->size_t{
+        std::vector<ThreadContextPtr<int>> contexts;
+        for (int i = 0; i < num; ++i)
+        {
+            contexts.push_back(dispatcher.post(func));
+        }
+        for (auto&& ctx : contexts)
+        {
+            ctx->get();
+        }
+        size_t numThreads = threads.size();
+        threads.clear();
+        return numThreads;
+    };
+    
+    //Only the active queues receive work
+    EXPECT_LE(runAll(100), 2u);
+    
+    //Grow then shrink while keeping some work on the retiring queues
+    dispatcher.setNumActiveCoroutineThreads(4);
+    std::vector<ThreadContextPtr<int>> pending;
+    for (int i = 0; i < 1000; ++i)
+    {
+        pending.push_back(dispatcher.post(func));
+    }
+    dispatcher.setNumActiveCoroutineThreads(1);
+    EXPECT_EQ(1, dispatcher.getNumActiveCoroutineThreads());
+    for (auto&& ctx : pending)
+    {
+        ctx->get();
+    }
+    threads.clear();
+    EXPECT_EQ(1u, runAll(10));
+}
+
+TEST(StressTest, PlacementPolicies)
+{
+    for (auto policy : {Configuration::PlacementPolicy::PowerOfTwoChoices,
+                        Configuration::PlacementPolicy::RoundRobin,
+                        Configuration::PlacementPolicy::CurrentQueue})
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(1);
+        config.setCoroutinePlacementPolicy(policy);
+        Dispatcher dispatcher(config);
+        std::vector<ThreadContextPtr<int>> contexts;
+        for (int i = 0; i < 100; ++i)
+        {
+            contexts.push_back(dispatcher.post([i](CoroContext<int>::Ptr ctx)->int{
+                return ctx->set(i);
+            }));
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(i, contexts[i]->get());
+        }
+        if (policy == Configuration::PlacementPolicy::RoundRobin)
+        {
+            //Every queue got an equal share
+            for (int queueId = 0; queueId < 4; ++queueId)
+            {
+                EXPECT_EQ(25u, dispatcher.stats(IQueue::QueueType::Coro, queueId).postedCount());
+            }
+        }
+        if (policy == Configuration::PlacementPolicy::CurrentQueue)
+        {
+            //Children posted from a coroutine stay on its thread
+            bool isSameThread = dispatcher.post<bool>([](CoroContext<bool>::Ptr ctx)->int{
+                std::thread::id parent = std::this_thread::get_id();
+                std::thread::id child = ctx->post<std::thread::id>([](CoroContext<std::thread::id>::Ptr ctx)->int{
+                    return ctx->set(std::this_thread::get_id());
+                })->get(ctx);
+                return ctx->set(parent == child);
+            })->get();
+            EXPECT_TRUE(isSameThread);
+        }
+    }
+}
+
+TEST(StressTest, AffinityKeyRouting)
+{
+    auto getThreads = [](Dispatcher& dispatcher)->std::map<int, std::thread::id>{
+        std::map<int, std::thread::id> threads;
+        for (int key = 0; key < 200; ++key)
+        {
+            threads[key] = dispatcher.post<std::thread::id>(AffinityKey(key), [](CoroContext<std::thread::id>::Ptr ctx)->int{
+                return ctx->set(std::this_thread::get_id());
+            })->get();
+        }
+        return threads;
+    };
+    
+    //Modulo mapping is stable
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(1);
+        Dispatcher dispatcher(config);
+        std::map<int, std::thread::id> threads = getThreads(dispatcher);
+        EXPECT_EQ(threads, getThreads(dispatcher));
+        EXPECT_EQ(threads[7], dispatcher.post<std::thread::id>(AffinityKey(std::string("7"), [](const std::string& s){ return std::stoi(s); }),
+            [](CoroContext<std::thread::id>::Ptr ctx)->int{
+                return ctx->set(std::this_thread::get_id());
+        })->get());
+    }
+    
+    //Consistent hashing only moves the keys of the retired queue
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(1);
+        config.setAffinityVirtualNodes(64);
+        Dispatcher dispatcher(config);
+        std::map<int, std::thread::id> before = getThreads(dispatcher);
+        std::set<std::thread::id> used;
+        for (auto&& entry : before)
+        {
+            used.insert(entry.second);
+        }
+        EXPECT_EQ(4u, used.size());
+        dispatcher.setNumActiveCoroutineThreads(3);
+        std::map<int, std::thread::id> after = getThreads(dispatcher);
+        std::set<std::thread::id> remaining;
+        for (auto&& entry : after)
+        {
+            remaining.insert(entry.second);
+        }
+        EXPECT_EQ(3u, remaining.size());
+        for (auto&& entry : before)
+        {
+            if (remaining.count(entry.second))
+            {
+                EXPECT_EQ(entry.second, after[entry.first]);
+            }
+        }
+    }
+}
+
+TEST(StressTest, SharedIoQueueWakeup)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(8);
+    Dispatcher dispatcher(config);
+    std::atomic<int> count{0};
+    std::set<std::thread::id> threads;
+    std::mutex m;
+    //Posts arrive in bursts so that threads alternate between being idle and busy
+    for (int burst = 0; burst < 50; ++burst)
+    {
+        std::vector<ThreadFuturePtr<int>> futures;
+        for (int i = 0; i < 100; ++i)
+        {
+            futures.push_back(dispatcher.postAsyncIo([&](ThreadPromisePtr<int> promise)->int{
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    threads.insert(std::this_thread::get_id());
+                }
+                ++count;
+                return promise->set(0);
+            }));
+        }
+        for (auto&& future : futures)
+        {
+            future->get();
+        }
+    }
+    EXPECT_EQ(5000, count);
+    EXPECT_LE(threads.size(), 8u);
+    dispatcher.drain();
+    EXPECT_EQ(0u, dispatcher.size(IQueue::QueueType::IO));
+}
+
+TEST(StressTest, DrainWakesUpOnCompletion)
+{
+    for (bool loadBalance : {false, true})
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(4);
+        config.setLoadBalanceSharedIoQueues(loadBalance);
+        Dispatcher dispatcher(config);
+        std::atomic<int> count{0};
+        for (int round = 0; round < 20; ++round)
+        {
+            for (int i = 0; i < 50; ++i)
+            {
+                dispatcher.post([&](CoroContextPtr<int> ctx)->int{
+                    ctx->sleep(std::chrono::microseconds(500));
+                    ++count;
+                    return ctx->set(0);
+                });
+                dispatcher.postAsyncIo([&](ThreadPromisePtr<int> promise)->int{
+                    ++count;
+                    return promise->set(0);
+                });
+            }
+            dispatcher.drain();
+            EXPECT_TRUE(dispatcher.empty());
+            EXPECT_EQ((round+1)*100, count);
+        }
+    }
+}
+
+TEST(StressTest, DrainTimeout)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(2);
+    Dispatcher dispatcher(config);
+    std::atomic_bool release{false};
+    dispatcher.postAsyncIo([&](ThreadPromisePtr<int> promise)->int{
+        while (!release)
+        {
+            std::this_thread::sleep_for(ms(1));
+        }
+        return promise->set(0);
+    });
+    auto start = std::chrono::steady_clock::now();
+    dispatcher.drain(ms(50));
+    auto elapsed = std::chrono::duration_cast<ms>(std::chrono::steady_clock::now() - start);
+    EXPECT_GE(elapsed.count(), 50);
+    EXPECT_LT(elapsed.count(), 1000);
+    EXPECT_FALSE(dispatcher.empty());
+    release = true;
+    dispatcher.drain();
+    EXPECT_TRUE(dispatcher.empty());
+}
+
+TEST(Histogram, Percentiles)
+{
+    Histogram histogram;
+    EXPECT_EQ(0u, histogram.percentile(50));
+    for (uint64_t i = 1; i <= 1000; ++i)
+    {
+        histogram.record(i);
+    }
+    EXPECT_EQ(1000u, histogram.count());
+    EXPECT_EQ(1u, histogram.min());
+    EXPECT_EQ(1000u, histogram.max());
+    EXPECT_DOUBLE_EQ(500.5, histogram.mean());
+    //values are accurate within the bucket precision
+    EXPECT_NEAR(500, (double)histogram.percentile(50), 500.0/Histogram::SubBuckets);
+    EXPECT_NEAR(990, (double)histogram.percentile(99), 990.0/Histogram::SubBuckets);
+    EXPECT_EQ(1000u, histogram.percentile(100));
+    
+    Histogram other;
+    other.record(std::numeric_limits<uint64_t>::max());
+    histogram += other;
+    EXPECT_EQ(1001u, histogram.count());
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), histogram.percentile(100));
+}
+
+TEST(StressTest, LatencyHistograms)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setCollectLatencyHistograms(true);
+    Dispatcher dispatcher(config);
+    
+    for (int i = 0; i < 100; ++i)
+    {
+        dispatcher.post([](CoroContext<int>::Ptr ctx)->int{
+            ctx->yield();
+            ctx->yield();
+            return ctx->set(0);
+        });
+    }
+    dispatcher.drain();
+    QueueStatistics stats = dispatcher.stats(IQueue::QueueType::Coro);
+    EXPECT_EQ(100u, stats.queueWaitTimeNs().count());
+    EXPECT_EQ(100u, stats.runTimeNs().count());
+    EXPECT_EQ(100u, stats.numResumes().count());
+    EXPECT_EQ(3u, stats.numResumes().min());
+    EXPECT_EQ(3u, stats.numResumes().max());
+    EXPECT_GT(stats.runTimeNs().max(), 0u);
+    EXPECT_EQ(200u, stats.resumeCount());
+    EXPECT_EQ(200u, stats.yieldCount());
+    EXPECT_GE(stats.taskTimeNs(), stats.runTimeNs().max());
+    EXPECT_GT(stats.schedulerTimeNs(), 0u);
+}
+
+TEST(StressTest, StatisticsSnapshotWhileRunning)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setCollectLatencyHistograms(true);
+    Dispatcher dispatcher(config);
+    
+    std::atomic_bool done{false};
+    std::atomic_int inconsistent{0};
+    std::thread reader([&dispatcher, &done, &inconsistent]{
+        while (!done)
+        {
+            QueueStatistics stats = dispatcher.stats(IQueue::QueueType::Coro);
+            if (stats.completedCount() > stats.postedCount() ||
+                stats.runTimeNs().count() > stats.postedCount())
+            {
+                ++inconsistent;
+            }
+        }
+    });
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p)
+    {
+        producers.emplace_back([&dispatcher]{
+            for (int i = 0; i < 500; ++i)
+            {
+                dispatcher.post([](CoroContext<int>::Ptr ctx)->int{
+                    return ctx->set(0);
+                });
+            }
+        });
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    dispatcher.drain();
+    done = true;
+    reader.join();
+    
+    EXPECT_EQ(0, inconsistent);
+    QueueStatistics stats = dispatcher.stats(IQueue::QueueType::Coro);
+    EXPECT_EQ(1000u, stats.postedCount());
+    EXPECT_EQ(1000u, stats.completedCount());
+    EXPECT_EQ(0u, stats.numElements());
+    EXPECT_EQ(1000u, stats.runTimeNs().count());
+    EXPECT_EQ(0u, dispatcher.size(IQueue::QueueType::Coro));
+}
+
+TEST(StressTest, LockContentionProfile)
+{
+    Mutex mutex(LockProfiler::site<StressTest_LockContentionProfile_Test>("test.mutex"));
+    SpinLock spinlock(LockProfiler::site<StressTest_LockContentionProfile_Test>("test.spinlock"));
+    int value = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&]{
+            for (int i = 0; i < 1000; ++i)
+            {
+                Mutex::Guard guard(mutex);
+                SpinLock::Guard lock(spinlock);
+                ++value;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(4000, value);
+    std::map<std::string, LockStatistics> stats = Dispatcher::lockStats();
+#ifdef __QUANTUM_PROFILE_LOCKS
+    EXPECT_EQ(4000u, stats["test.spinlock"].acquisitionCount());
+    EXPECT_EQ(0u, stats["test.spinlock"].contentionCount()); //serialized by the mutex
+    EXPECT_EQ(4000u, stats["test.mutex"].acquisitionCount());
+    EXPECT_GE(stats["test.mutex"].acquisitionCount(), stats["test.mutex"].contentionCount());
+#else
+    EXPECT_TRUE(stats.empty());
+#endif
+}
+
+TEST(StressTest, TaskSnapshot)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setTrackTasks(true);
+    Dispatcher dispatcher(config);
+    
+    std::atomic_bool release{false};
+    {
+        CoroStackTag tag("blocked");
+        dispatcher.post(0, false, [&release](CoroContext<int>::Ptr ctx)->int{
+            ctx->postAsyncIo([&release](ThreadPromise<int>::Ptr promise)->int{
+                while (!release)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                return promise->set(0);
+            })->get(ctx);
+            return ctx->set(0);
+        });
+    }
+    auto sleeping = dispatcher.post(1, false, [&release](CoroContext<int>::Ptr ctx)->int{
+        while (!release)
+        {
+            ctx->sleep(std::chrono::milliseconds(1));
+        }
+        return ctx->set(0);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    std::vector<TaskInfo> tasks = dispatcher.snapshotTasks();
+    ASSERT_EQ(2u, tasks.size());
+    std::sort(tasks.begin(), tasks.end(), [](const TaskInfo& lhs, const TaskInfo& rhs){
+        return lhs._queueId < rhs._queueId;
+    });
+    EXPECT_EQ(TaskInfo::State::Blocked, tasks[0]._state);
+    EXPECT_STREQ("blocked", tasks[0]._tag);
+    EXPECT_GE(tasks[0]._age, std::chrono::milliseconds(50));
+    EXPECT_EQ(1, tasks[1]._queueId);
+    EXPECT_NE(TaskInfo::State::Pending, tasks[1]._state);
+    EXPECT_GT(tasks[1]._resumeCount, 0u);
+    EXPECT_EQ(nullptr, tasks[1]._tag);
+    
+    release = true;
+    dispatcher.drain();
+    EXPECT_TRUE(dispatcher.snapshotTasks().empty()); //even though 'sleeping' holds the context
+    sleeping->get();
+}
+
+TEST(StressTest, MetricsExport)
+{
+    auto prometheus = std::make_shared<PrometheusMetricsSink>();
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setMetricsSink(prometheus);
+    config.setMetricsExportPeriodMs(std::chrono::milliseconds(10));
+    Dispatcher dispatcher(config);
+    dispatcher.setMetricsSource("test", [](MetricsSnapshot::Gauges& gauges){
+        gauges["answer"] = 42;
+    });
+    for (int i = 0; i < 100; ++i)
+    {
+        dispatcher.post(0, false, [](CoroContext<int>::Ptr ctx)->int{
+            return ctx->set(0);
+        });
+    }
+    dispatcher.drain();
+    
+    //counters are accumulated across periods
+    const std::string posted = "quantum_queue_posted_total{type=\"coro\",queue=\"0\"} 100\n";
+    std::string text;
+    for (int i = 0; i < 200 && text.find(posted) == std::string::npos; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        text = prometheus->text();
+    }
+    EXPECT_NE(std::string::npos, text.find(posted));
+    EXPECT_NE(std::string::npos, text.find("quantum_test_answer 42\n"));
+    dispatcher.setMetricsSource("test", nullptr);
+    
+    //statsd lines
+    std::vector<std::string> packets;
+    StatsdMetricsSink statsd([&packets](const std::string& packet){ packets.push_back(packet); }, "app", 64);
+    MetricsSnapshot metrics;
+    metrics._queues.resize(1);
+    metrics._queues[0]._postedCount = 5;
+    metrics._gauges["test.answer"] = 42;
+    statsd.publish(metrics);
+    ASSERT_LT(1u, packets.size());
+    EXPECT_EQ(0u, packets[0].find("app.queue.coro.0.posted:5|c\n"));
+    EXPECT_NE(std::string::npos, packets.back().find("app.test.answer:42|g"));
+    EXPECT_THROW(StatsdMetricsSink(nullptr), std::invalid_argument);
+}
+
+TEST(StressTest, TraceDump)
+{
+    int task = 0;
+    std::thread([&task]{
+        Tracer::record(Tracer::Event::Posted, &task, IQueue::QueueType::Coro, 1);
+        Tracer::record(Tracer::Event::Started, &task, IQueue::QueueType::Coro, 1);
+        Tracer::record(Tracer::Event::Yielded, &task, IQueue::QueueType::Coro, 1);
+        Tracer::record(Tracer::Event::Finished, &task, IQueue::QueueType::Coro, 1);
+        Tracer::record(Tracer::Event::Set, &task);
+    }).join();
+    
+    std::vector<Tracer::Record> events;
+    for (auto&& thread : Tracer::records())
+    {
+        if (!thread.empty() && (thread.front()._object == &task))
+        {
+            events = thread;
+        }
+    }
+    ASSERT_EQ(5u, events.size());
+    EXPECT_EQ(Tracer::Event::Started, events[1]._event);
+    EXPECT_EQ(1, events[1]._queueId);
+    EXPECT_EQ(IQueue::QueueType::All, events[4]._queueType);
+    EXPECT_LE(events[0]._timestampNs, events[4]._timestampNs);
+    
+    std::ostringstream out;
+    Tracer::dump(out);
+    std::string trace = out.str();
+    EXPECT_EQ(0u, trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.find("{\"name\":\"start\",\"ph\":\"B\""));
+    EXPECT_NE(std::string::npos, trace.find("{\"name\":\"finish\",\"ph\":\"E\""));
+    EXPECT_NE(std::string::npos, trace.find("\"queue\":\"coro 1\""));
+}
+
+TEST(StressTest, ParkBlockedCoroutines)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setParkBlockedCoroutines(true);
+    Dispatcher dispatcher(config);
+    
+    std::atomic_int sum{0};
+    dispatcher.post([&sum](CoroContext<int>::Ptr ctx)->int{
+        //All the waiters block on the producer and get parked until it completes
+        CoroContext<int>::Ptr producer = ctx->post([](CoroContext<int>::Ptr ctx2)->int{
+            ctx2->sleep(ms(50));
+            return ctx2->set(2);
+        });
+        for (int i = 0; i < 500; ++i)
+        {
+            ctx->post([&sum, producer](CoroContext<int>::Ptr ctx2)->int{
+                sum += producer->getRef(ctx2);
+                return 0;
+            });
+        }
+        return 0;
+    });
+    dispatcher.drain();
+    EXPECT_EQ(1000, sum);
+    EXPECT_EQ((size_t)502, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+}
+
+TEST(StressTest, ParkBlockedContinuation)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setParkBlockedCoroutines(true);
+    Dispatcher dispatcher(config);
+    
+    //Continuations posted to any queue get parked on the queue which runs them and must be woken up there
+    ThreadContextPtr<int> ctx = dispatcher.postFirst([](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(40);
+    })->then([](CoroContext<int>::Ptr ctx)->int{
+        int value = ctx->getPrev<int>();
+        return ctx->set(value + ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int{
+            std::this_thread::sleep_for(ms(10));
+            return promise->set(2);
+        })->get(ctx));
+    })->end();
+    ASSERT_EQ(std::future_status::ready, ctx->waitFor(ms(5000)));
+    EXPECT_EQ(42, ctx->get());
+}
+
+TEST(StressTest, BlockingContinuationDefaultConfig)
+{
+    //Blocked coroutines are parked by default. A blocking stage of a continuation chain must still be woken up.
+    Configuration config;
+    EXPECT_TRUE(config.getParkBlockedCoroutines());
+    Dispatcher dispatcher(config);
+    
+    ThreadContextPtr<int> ctx = dispatcher.postFirst((int)IQueue::QueueId::Any, false, [](CoroContext<int>::Ptr ctx)->int{
+        return ctx->set(40);
+    })->then([](CoroContext<int>::Ptr ctx)->int{
+        CoroFuturePtr<int> io = ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int{
+            std::this_thread::sleep_for(ms(10));
+            return promise->set(2);
+        });
+        //the timed wait returns as soon as the IO task completes
+        if (io->waitFor(ctx, ms(5000)) != std::future_status::ready)
+        {
+            return ctx->set(-1);
+        }
+        return ctx->set(ctx->getPrev<int>() + io->get(ctx));
+    })->end();
+    ASSERT_EQ(std::future_status::ready, ctx->waitFor(ms(2000)));
+    EXPECT_EQ(42, ctx->get());
+}
+
+TEST(StressTest, PollBlockedCoroutines)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setParkBlockedCoroutines(false);
+    Dispatcher dispatcher(config);
+    
+    //Blocked coroutines stay in the run queue and are checked on every pass
+    std::atomic_int sum{0};
+    dispatcher.post([&sum](CoroContext<int>::Ptr ctx)->int{
+        CoroFuturePtr<int> future = ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int{
+            std::this_thread::sleep_for(ms(50));
+            return promise->set(2);
+        });
+        for (int i = 0; i < 100; ++i)
+        {
+            ctx->post([&sum, future](CoroContext<int>::Ptr ctx2)->int{
+                sum += future->getRef(ctx2);
+                return 0;
+            });
+        }
+        return 0;
+    });
+    dispatcher.drain();
+    EXPECT_EQ(200, sum);
+}
+
+TEST(StressTest, ParkSleepingCoroutines)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setParkBlockedCoroutines(true);
+    Dispatcher dispatcher(config);
+    
+    std::atomic_int count{0};
+    std::atomic_int timeouts{0};
+    dispatcher.post([&count, &timeouts](CoroContext<int>::Ptr ctx)->int{
+        CoroContext<int>::Ptr producer = ctx->post([](CoroContext<int>::Ptr ctx2)->int{
+            ctx2->sleep(ms(100));
+            return ctx2->set(1);
+        });
+        //Sleeping coroutines leave the run queue until their timer expires
+        for (int i = 0; i < 200; ++i)
+        {
+            ctx->post([&count](CoroContext<int>::Ptr ctx2)->int{
+                ctx2->sleep(ms(10+(count%10)));
+                ++count;
+                return 0;
+            });
+        }
+        //A timed wait expires even though nobody signals the waiting coroutine
+        ctx->post([&timeouts, producer](CoroContext<int>::Ptr ctx2)->int{
+            if (producer->waitFor(ctx2, ms(10)) == std::future_status::timeout)
+            {
+                ++timeouts;
+            }
+            //This time the wait is interrupted by the producer
+            if (producer->waitFor(ctx2, ms(5000)) == std::future_status::ready)
+            {
+                return ctx2->set(producer->getRef(ctx2));
+            }
+            return 1;
+        });
+        return 0;
+    });
+    dispatcher.drain();
+    EXPECT_EQ(200, count);
+    EXPECT_EQ(1, timeouts);
+    EXPECT_EQ((size_t)203, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+}
+
+TEST(StressTest, MigrateWokenUpCoroutines)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setMaxNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setParkBlockedCoroutines(true);
+    config.setCoroutineMigrationThreshold(1);
+    Dispatcher dispatcher(config);
+    
+    //The waiters all park on the only active queue
+    Promise<int> promise;
+    CoroFuturePtr<int> future = promise.getICoroFuture();
+    std::atomic_int numParked{0};
+    std::atomic_bool isDone{false};
+    std::mutex m;
+    std::set<std::thread::id> threads;
+    for (int i = 0; i < 100; ++i)
+    {
+        dispatcher.post([&, future](CoroContext<int>::Ptr ctx)->int{
+            ++numParked;
+            int value = future->getRef(ctx);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                threads.insert(std::this_thread::get_id());
+            }
+            //Stay runnable so that the load of the queues reflects the woken up coroutines
+            while (!isDone)
+            {
+                ctx->yield();
+            }
+            return ctx->set(value);
+        });
+    }
+    while (numParked < 100)
+    {
+        std::this_thread::sleep_for(ms(1));
+    }
+    
+    //Once a second queue is active, the coroutines woken up all at once are spread over both
+    dispatcher.setNumActiveCoroutineThreads(2);
+    promise.set(1);
+    for (int i = 0; (i < 5000) && (dispatcher.stats(IQueue::QueueType::Coro, 0).migratedCount() == 0); ++i)
+    {
+        std::this_thread::sleep_for(ms(1));
+    }
+    std::this_thread::sleep_for(ms(10));
+    isDone = true;
+    dispatcher.drain();
+    EXPECT_EQ(2u, threads.size());
+    EXPECT_EQ((size_t)0, dispatcher.stats(IQueue::QueueType::Coro, 1).migratedCount());
+    EXPECT_EQ((size_t)100, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+}
+
+TEST(ForEachTest, Simple)
+{
+    std::vector<int> start{0,1,2,3,4,5,6,7,8,9};
+    std::vector<char> end{'a','b','c','d','e','f','g','h','i','j'};
+    std::vector<char> results = DispatcherSingleton::instance().forEach<char>(start.begin(), start.size(),
+        [](int val)->char {
+        return 'a'+val;
+    })->get();
+    EXPECT_EQ(end, results);
+}
+
+TEST(ForEachTest, SmallBatch)
+{
+    std::vector<int> start{0,1,2};
+    std::vector<char> end{'a','b','c'};
+    
+    std::vector<std::vector<char>> results = DispatcherSingleton::instance().forEachBatch<char>(start.begin(), start.size(),
+        [](int val)->char
+    {
+        return 'a'+val;
+    })->get();
 
     ASSERT_EQ(start.size(), results.size());
     EXPECT_EQ(results[0].front(), end[0]);
@@ -1138,6 +3857,579 @@ TEST(MapReduce, WordLengthFromCoroutine)
     })->get();
 }
 
+TEST(MapReduce, Partitioned)
+{
+    //compare against the ordered mapReduce on a larger input with many repeated keys
+    std::vector<int> input(5000);
+    std::iota(input.begin(), input.end(), 0);
+    auto mapper = [](const int& input)->std::vector<std::pair<int, int>>
+    {
+        return {{input % 97, 1}, {input % 13, input}};
+    };
+    auto reducer = [](std::pair<int, std::vector<int>>&& input)->std::pair<int, long>
+    {
+        return {input.first, std::accumulate(input.second.begin(), input.second.end(), 0L)};
+    };
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::map<int, long> expected = dispatcher.mapReduce<int, int, long>(input.begin(), input.end(),
+                                                                        mapper, reducer)->get();
+    
+    std::unordered_map<int, long> unordered = dispatcher.mapReducePartitioned<int, int, long>
+        (input.begin(), input.end(), mapper, reducer)->get();
+    EXPECT_EQ(expected.size(), unordered.size());
+    for (auto&& entry : expected) {
+        EXPECT_EQ(entry.second, unordered[entry.first]);
+    }
+    
+    //ordered output with an explicit number of partitions, from within a coroutine
+    std::map<int, long> ordered = dispatcher.post<std::map<int, long>>([&](CoroContext<std::map<int, long>>::Ptr ctx)->int
+    {
+        return ctx->set(ctx->mapReducePartitioned<int, int, long, std::map<int, long>>
+            (input.begin(), input.size(), mapper, reducer, 3)->get(ctx));
+    })->get();
+    EXPECT_EQ(expected, ordered);
+    
+    //empty input
+    std::vector<int> empty;
+    EXPECT_TRUE((dispatcher.mapReducePartitioned<int, int, long>(empty.begin(), empty.end(), mapper, reducer)->get().empty()));
+}
+
+TEST(MapReduce, CombinerAndStream)
+{
+    //word count where the combiner pre-reduces the counts of each mapper
+    std::vector<std::string> words = {"a", "bb", "a", "ccc", "bb", "a", "dddd"};
+    std::vector<std::vector<std::string>> input(300, words);
+    auto mapper = [](const std::vector<std::string>& input)->std::vector<std::pair<std::string, size_t>>
+    {
+        std::vector<std::pair<std::string, size_t>> out;
+        for (auto&& i : input) {
+            out.push_back({i, 1});
+        }
+        return out;
+    };
+    auto reducer = [](std::pair<std::string, std::vector<size_t>>&& input)->std::pair<std::string, size_t>
+    {
+        return {std::move(input.first), std::accumulate(input.second.begin(), input.second.end(), size_t(0))};
+    };
+    auto combiner = [](size_t& accumulated, size_t&& value)
+    {
+        accumulated += value;
+    };
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::unordered_map<std::string, size_t> result = dispatcher.mapReducePartitioned<std::string, size_t, size_t>
+        (input.begin(), input.end(), mapper, reducer, 0, combiner)->get();
+    ASSERT_EQ(4u, result.size());
+    EXPECT_EQ(900u, result["a"]);
+    EXPECT_EQ(600u, result["bb"]);
+    EXPECT_EQ(300u, result["ccc"]);
+    EXPECT_EQ(300u, result["dddd"]);
+    
+    //same input streamed through a buffer while the mappers are already running, with and without combiner
+    for (bool combine : {true, false}) {
+        Promise<Buffer<std::vector<std::string>>>::Ptr promise = Promise<Buffer<std::vector<std::string>>>::create();
+        ThreadContext<std::map<std::string, size_t>>::Ptr ctx =
+            dispatcher.mapReduceStream<std::string, size_t, size_t, std::map<std::string, size_t>>
+                (promise->getICoroFuture(), mapper, reducer, 2,
+                 combine ? Functions::CombineFunc<size_t>(combiner) : nullptr);
+        std::thread producer([&]() {
+            for (auto&& i : input) {
+                promise->push(std::vector<std::string>(i));
+            }
+            promise->closeBuffer();
+        });
+        std::map<std::string, size_t> streamed = ctx->get();
+        producer.join();
+        std::map<std::string, size_t> expected(result.begin(), result.end());
+        EXPECT_EQ(expected, streamed);
+    }
+}
+
+TEST(ParallelAlgorithms, ReduceAndScan)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<int> input(10001);
+    std::iota(input.begin(), input.end(), 1);
+    auto plus = [](const long& a, const long& b)->long { return a + b; };
+    
+    EXPECT_EQ(50015001L + 7, dispatcher.reduce<long>(input.begin(), input.end(), 7L, plus)->get());
+    EXPECT_EQ(7L, dispatcher.reduce<long>(input.begin(), input.begin(), 7L, plus)->get());
+    EXPECT_EQ(3L, dispatcher.reduce<long>(input.begin(), 2, 0L, plus)->get());
+    
+    //sum of squares from within a coroutine
+    long squares = dispatcher.post<long>([&](CoroContext<long>::Ptr ctx)->int
+    {
+        return ctx->set(ctx->transformReduce<long>(input.begin(), input.end(), 0L,
+            [](const int& v)->long { return (long)v*v; }, plus)->get(ctx));
+    })->get();
+    long expected = 0;
+    for (int v : input) {
+        expected += (long)v*v;
+    }
+    EXPECT_EQ(expected, squares);
+    
+    //non-commutative operator: the order of the elements must be preserved
+    std::vector<std::string> letters;
+    for (char c = 'a'; c <= 'z'; ++c) {
+        letters.emplace_back(1, c);
+    }
+    auto concat = [](const std::string& a, const std::string& b)->std::string { return a + b; };
+    EXPECT_EQ(">abcdefghijklmnopqrstuvwxyz",
+              dispatcher.reduce<std::string>(letters.begin(), letters.end(), std::string(">"), concat)->get());
+    std::vector<std::string> prefixes = dispatcher.inclusiveScan<std::string>(letters.begin(), letters.end(), concat)->get();
+    ASSERT_EQ(26u, prefixes.size());
+    EXPECT_EQ("a", prefixes.front());
+    EXPECT_EQ("abcdefghijklm", prefixes[12]);
+    EXPECT_EQ("abcdefghijklmnopqrstuvwxyz", prefixes.back());
+    
+    std::vector<long> sums = dispatcher.inclusiveScan<long>(input.begin(), input.size(), plus)->get();
+    std::vector<long> expectedSums(input.size());
+    std::partial_sum(input.begin(), input.end(), expectedSums.begin());
+    EXPECT_EQ(expectedSums, sums);
+}
+
+TEST(ParallelAlgorithms, Sort)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, 1000); //many duplicates
+    for (size_t size : {0, 1, 100, 5000, 100003}) {
+        std::vector<int> v(size);
+        for (auto&& i : v) {
+            i = dist(gen);
+        }
+        std::vector<int> expected = v;
+        std::sort(expected.begin(), expected.end());
+        dispatcher.sort(v.begin(), v.end())->get();
+        EXPECT_EQ(expected, v);
+    }
+    
+    //custom comparator and move-only elements, from within a coroutine
+    std::deque<std::unique_ptr<int>> ptrs;
+    for (int i = 0; i < 20000; ++i) {
+        ptrs.emplace_back(new int(dist(gen)));
+    }
+    dispatcher.post([&](CoroContext<int>::Ptr ctx)->int
+    {
+        ctx->sort(ptrs.begin(), ptrs.end(), [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) {
+            return *a > *b;
+        })->get(ctx);
+        return ctx->set(0);
+    })->get();
+    ASSERT_EQ(20000u, ptrs.size());
+    EXPECT_TRUE(std::is_sorted(ptrs.begin(), ptrs.end(), [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) {
+        return *a > *b;
+    }));
+}
+
+TEST(PipelineTest, StagesAndStatistics)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    //decode -> enrich -> collect, with small queues so that producers regularly wait on consumers
+    Pipeline<int> input(dispatcher, 8);
+    Pipeline<int, std::string> pipeline = input
+        .addStage<long>("decode", [](int&& v)->long { return (long)v * 2; }, 4, PipelineStageKind::Coroutine, 8)
+        .addStage<std::string>("enrich", [](long&& v)->std::string { return std::to_string(v); }, 2, PipelineStageKind::Io, 4);
+    
+    const int num = 2000;
+    std::thread producer([&]() {
+        for (int i = 0; i < num; ++i) {
+            EXPECT_TRUE(input.push(i));
+        }
+        input.close();
+    });
+    long sum = 0;
+    int count = 0;
+    std::string value;
+    while (pipeline.pull(value)) {
+        sum += std::stol(value);
+        ++count;
+    }
+    producer.join();
+    pipeline.wait();
+    EXPECT_EQ(num, count);
+    EXPECT_EQ((long)num*(num-1), sum);
+    
+    std::vector<PipelineStageStatistics> stats = pipeline.stats();
+    ASSERT_EQ(2u, stats.size());
+    EXPECT_EQ("decode", stats[0].name());
+    EXPECT_EQ(4u, stats[0].parallelism());
+    EXPECT_EQ((size_t)num, stats[0].processedCount());
+    EXPECT_EQ(8u, stats[0].queueCapacity());
+    EXPECT_EQ("enrich", stats[1].name());
+    EXPECT_EQ((size_t)num, stats[1].processedCount());
+    EXPECT_EQ(0u, stats[1].queueDepth());
+    EXPECT_GT(stats[1].throughput(), 0);
+}
+
+TEST(PipelineTest, SinkAndException)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::atomic<int> consumed{0};
+    Pipeline<int> input(dispatcher, 4);
+    Pipeline<int, int> pipeline = input
+        .addStage<int>("check", [](int&& v)->int {
+            if (v == 50) {
+                throw std::runtime_error("bad value");
+            }
+            return v;
+        })
+        .addSink("consume", [&](int&&) { ++consumed; }, 2);
+    int pushed = 0;
+    while ((pushed < 1000) && input.push(pushed)) {
+        ++pushed; //stops once the failed stage closes the input
+    }
+    input.close();
+    EXPECT_THROW(pipeline.wait(), std::runtime_error);
+    EXPECT_LT(pushed, 1000);
+    EXPECT_EQ(50, consumed);
+    int value;
+    EXPECT_THROW(pipeline.pull(value), std::runtime_error);
+}
+
+TEST(Cancellation, DropQueuedTasks)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    std::atomic_bool release{false};
+    std::atomic<int> numRuns{0};
+    //Keep both threads busy so that the cancelled tasks are still queued
+    dispatcher.post(0, false, [&](CoroContextPtr<int> ctx)->int{
+        while (!release) std::this_thread::sleep_for(ms(1));
+        return ctx->set(0);
+    });
+    dispatcher.postAsyncIo(0, false, [&](ThreadPromisePtr<int> promise)->int{
+        while (!release) std::this_thread::sleep_for(ms(1));
+        return promise->set(0);
+    });
+    CancellationToken::Ptr token = CancellationToken::create();
+    std::vector<ThreadContextPtr<int>> contexts;
+    std::vector<ThreadFuturePtr<int>> futures;
+    for (int i = 0; i < 100; ++i)
+    {
+        contexts.push_back(dispatcher.postWithToken(0, false, token, [&](CoroContextPtr<int> ctx)->int{
+            ++numRuns;
+            return ctx->set(0);
+        }));
+        futures.push_back(dispatcher.postAsyncIoWithToken(0, false, token, [&](ThreadPromisePtr<int> promise)->int{
+            ++numRuns;
+            return promise->set(0);
+        }));
+    }
+    token->cancel();
+    release = true;
+    //Posting with a cancelled token completes immediately
+    contexts.push_back(dispatcher.postWithToken(token, [&](CoroContextPtr<int> ctx)->int{
+        ++numRuns;
+        return ctx->set(0);
+    }));
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_THROW(ctx->get(), CancellationException);
+    }
+    for (auto&& future : futures)
+    {
+        EXPECT_THROW(future->get(), CancellationException);
+    }
+    dispatcher.drain();
+    EXPECT_EQ(0, numRuns);
+    EXPECT_EQ(100u, dispatcher.stats(IQueue::QueueType::Coro, 0).cancelledCount());
+    EXPECT_EQ(100u, dispatcher.stats(IQueue::QueueType::IO, 0).cancelledCount());
+}
+
+TEST(Cancellation, RunningCoroutines)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    CancellationToken::Ptr token = CancellationToken::create();
+    std::atomic<int> numChildren{0};
+    auto ctx = dispatcher.postWithToken(token, [&](CoroContextPtr<int> ctx)->int{
+        //Children inherit the token of their parent
+        auto child = ctx->post([&](CoroContextPtr<int> ctx)->int{
+            ++numChildren;
+            while (!ctx->isCancelled())
+            {
+                ctx->sleep(ms(1));
+            }
+            return ctx->set(0);
+        });
+        while (true)
+        {
+            ctx->yield(); //throws once cancelled
+        }
+        return ctx->set(0);
+    });
+    std::vector<int> input(2000);
+    std::atomic<int> numInvocations{0};
+    auto forEachCtx = dispatcher.forEach<int>(input.begin(), input.end(), [&](const int&)->int{
+        ++numInvocations;
+        std::this_thread::sleep_for(ms(1));
+        return 0;
+    }, token);
+    std::this_thread::sleep_for(ms(20));
+    EXPECT_FALSE(token->isCancelled());
+    token->cancel();
+    EXPECT_THROW(ctx->get(), CancellationException);
+    EXPECT_THROW(forEachCtx->get(), CancellationException);
+    dispatcher.drain();
+    EXPECT_EQ(1, numChildren);
+    EXPECT_LT(numInvocations, 2000);
+}
+
+TEST(CoroFuture, TimedGet)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto ctx = dispatcher.post([](CoroContextPtr<int> ctx)->int{
+        auto child = ctx->post([](CoroContextPtr<int> ctx)->int{
+            ctx->sleep(ms(50));
+            return ctx->set(7);
+        });
+        int value = -1;
+        //times out and leaves the future valid
+        EXPECT_FALSE(child->getFor(ctx, ms(5), value));
+        EXPECT_EQ(-1, value);
+        EXPECT_TRUE(child->getUntil(ctx, std::chrono::steady_clock::now() + ms(1000), value));
+        EXPECT_EQ(7, value);
+        
+        auto future = ctx->postAsyncIo([](ThreadPromisePtr<int> promise)->int{
+            return promise->set(3);
+        });
+        EXPECT_TRUE(future->getFor(ctx, ms(1000), value));
+        EXPECT_EQ(3, value);
+        
+        auto failing = ctx->post([](CoroContextPtr<int>)->int{
+            throw std::runtime_error("failed");
+        });
+        EXPECT_THROW(failing->getFor(ctx, ms(1000), value), std::runtime_error);
+        
+        //a deadline in the past only checks if the value is ready
+        auto ready = ctx->post([](CoroContextPtr<int> ctx)->int{
+            return ctx->set(5);
+        });
+        ready->wait(ctx);
+        EXPECT_TRUE(ready->getUntil(ctx, std::chrono::steady_clock::now() - ms(10), value));
+        EXPECT_EQ(5, value);
+        return ctx->set(0);
+    });
+    EXPECT_EQ(0, ctx->get());
+}
+
+TEST(AdmissionControl, RejectPendingTasksOverLimit)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setMaxPendingCoroTasks(2);
+    config.setMaxPendingIoTasks(2);
+    std::atomic<int> numCoroRejected{0}, numIoRejected{0};
+    config.setOverloadCallback([&](bool isIoTask, size_t numPending){
+        EXPECT_GE(numPending, 2u);
+        ++(isIoTask ? numIoRejected : numCoroRejected);
+    });
+    Dispatcher dispatcher(config);
+    std::atomic_bool release{false};
+    auto coroFunc = [&](CoroContextPtr<int> ctx)->int{
+        while (!release) ctx->sleep(ms(1));
+        return ctx->set(0);
+    };
+    auto ioFunc = [&](ThreadPromisePtr<int> promise)->int{
+        while (!release) std::this_thread::sleep_for(ms(1));
+        return promise->set(0);
+    };
+    std::vector<ThreadContextPtr<int>> contexts;
+    contexts.push_back(dispatcher.post(0, false, coroFunc));
+    contexts.push_back(dispatcher.post(0, false, coroFunc));
+    ThreadContextPtr<int> rejected = dispatcher.post(0, false, coroFunc);
+    EXPECT_THROW(rejected->get(), OverloadException);
+    EXPECT_EQ(1, numCoroRejected);
+    
+    //The running IO task may not count as pending, depending on the queue
+    std::vector<ThreadFuturePtr<int>> futures;
+    ThreadFuturePtr<int> future;
+    for (int i = 0; i < 4; ++i)
+    {
+        future = dispatcher.postAsyncIo(0, false, ioFunc);
+        if (numIoRejected > 0) break;
+        futures.push_back(future);
+    }
+    EXPECT_EQ(1, numIoRejected);
+    EXPECT_THROW(future->get(), OverloadException);
+    EXPECT_LE(2u, futures.size());
+    EXPECT_GE(3u, futures.size());
+    
+    release = true;
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_EQ(0, ctx->get());
+    }
+    for (auto&& f : futures)
+    {
+        EXPECT_EQ(0, f->get());
+    }
+    dispatcher.drain();
+    //Accepted again once the load is gone
+    EXPECT_EQ(0, dispatcher.post(coroFunc)->get());
+    EXPECT_EQ(0, dispatcher.postAsyncIo(ioFunc)->get());
+    EXPECT_EQ(1, numCoroRejected);
+    EXPECT_EQ(1, numIoRejected);
+    
+    //Continuations and nested posts leave the pending count balanced once they complete
+    auto chain = dispatcher.postFirst([](CoroContextPtr<int> ctx)->int{
+        return ctx->set(1);
+    })->then([](CoroContextPtr<int> ctx)->int{
+        int value = ctx->getPrev<int>();
+        return ctx->set(value + ctx->post([](CoroContextPtr<int> child)->int{
+            return child->set(1);
+        })->get(ctx));
+    })->end();
+    EXPECT_EQ(2, chain->get());
+    dispatcher.drain();
+    release = false;
+    contexts.clear();
+    contexts.push_back(dispatcher.post(0, false, coroFunc));
+    contexts.push_back(dispatcher.post(0, false, coroFunc));
+    EXPECT_THROW(dispatcher.post(0, false, coroFunc)->get(), OverloadException);
+    EXPECT_EQ(2, numCoroRejected);
+    release = true;
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_EQ(0, ctx->get());
+    }
+}
+
+TEST(TaskGroup, WaitAndCancelOnFailure)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(2);
+    Dispatcher dispatcher(config);
+    std::atomic_int counter{0};
+    
+    //all children complete
+    int result = dispatcher.post([&](CoroContextPtr<int> ctx)->int
+    {
+        TaskGroup group(ctx);
+        for (int i = 0; i < 10; ++i)
+        {
+            group.post([&](CoroContextPtr<int> child)->int
+            {
+                child->yield();
+                ++counter;
+                return child->set(0);
+            });
+            group.postAsyncIo([&](ThreadPromisePtr<int> promise)->int
+            {
+                ++counter;
+                return promise->set(0);
+            });
+        }
+        group.wait();
+        EXPECT_EQ(0u, group.size());
+        return ctx->set(counter.load());
+    })->get();
+    EXPECT_EQ(20, result);
+    
+    //a failing child cancels its siblings
+    std::atomic_int numCancelled{0}; //siblings which were running when cancelled
+    bool failed = dispatcher.post<bool>([&](CoroContextPtr<bool> ctx)->int
+    {
+        TaskGroup group(ctx);
+        std::vector<CoroContextPtr<int>> siblings;
+        for (int i = 0; i < 5; ++i)
+        {
+            siblings.push_back(group.post(0, false, [&](CoroContextPtr<int> child)->int
+            {
+                try
+                {
+                    while (true)
+                    {
+                        child->yield();
+                    }
+                }
+                catch (const CancellationException&)
+                {
+                    ++numCancelled;
+                    throw;
+                }
+                return 0;
+            }));
+        }
+        group.post(1, false, [](CoroContextPtr<int> child)->int
+        {
+            child->yield();
+            throw std::runtime_error("child failed");
+        });
+        try
+        {
+            group.wait();
+        }
+        catch (const std::runtime_error& ex)
+        {
+            EXPECT_STREQ("child failed", ex.what());
+            EXPECT_TRUE(group.isCancelled());
+            EXPECT_EQ(0u, group.size());
+            for (auto&& sibling : siblings)
+            {
+                EXPECT_THROW(sibling->get(ctx), CancellationException);
+            }
+            return ctx->set(true);
+        }
+        return ctx->set(false);
+    })->get();
+    EXPECT_TRUE(failed);
+    EXPECT_LE(numCancelled, 5);
+}
+
+TEST(CoroLocal, InheritedByChildrenAndContinuations)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    static CoroLocal<int> arena;
+    static CoroLocal<int> scratch(false);
+    int arenaValue = 1, scratchValue = 2;
+    std::atomic<int> numInherited{0}, numScratch{0};
+    auto check = [&](CoroContextPtr<int> ctx)->int {
+        if (arena.get(ctx) == &arenaValue) ++numInherited;
+        if (scratch.get(ctx)) ++numScratch;
+        return ctx->set(0);
+    };
+    dispatcher.post([&](CoroContextPtr<int> ctx)->int {
+        EXPECT_EQ(nullptr, arena.get(ctx));
+        arena.set(ctx, &arenaValue);
+        scratch.set(ctx, &scratchValue);
+        EXPECT_EQ(&scratchValue, scratch.get(ctx));
+        auto child = ctx->post(check);
+        auto chain = ctx->postFirst(check)->then(check)->finally(check)->end();
+        child->get(ctx);
+        chain->waitAll(ctx);
+        arena.set(ctx, nullptr);
+        ctx->post(check)->get(ctx); //cleared slots are not inherited
+        return ctx->set(0);
+    })->get();
+    EXPECT_EQ(4, numInherited);
+    EXPECT_EQ(0, numScratch);
+    EXPECT_NE(arena.slot(), scratch.slot());
+}
+
+TEST(CoroArena, RecycledPerThread)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto useArena = [](CoroContextPtr<const int*> ctx)->int {
+        std::vector<int, ArenaAllocator<int>> vec{ArenaAllocator<int>(ctx->arena())};
+        for (int i = 0; i < 100; ++i) vec.push_back(i);
+        EXPECT_EQ(99, vec.back());
+        EXPECT_LT(0u, ctx->arena().capacity());
+        //larger than a chunk
+        void* big = ctx->arena().allocate(2 * AllocatorTraits::coroArenaChunkSize());
+        EXPECT_NE(nullptr, big);
+        EXPECT_LT(2u * AllocatorTraits::coroArenaChunkSize(), ctx->arena().capacity());
+        return ctx->set(vec.data());
+    };
+    //both coroutines run on the same thread, so the second one reuses the chunk released by the first
+    const int* first = dispatcher.post<const int*>(0, false, useArena)->get();
+    const int* second = dispatcher.post<const int*>(0, false, useArena)->get();
+    EXPECT_EQ(first, second);
+}
+
 TEST(FutureJoiner, JoinThreadFutures)
 {
     std::vector<ThreadContext<int>::Ptr> futures;
@@ -1172,6 +4464,133 @@ TEST(FutureJoiner, JoinCoroFutures)
     EXPECT_EQ(output, std::vector<int>({0,1,2,3,4,5,6,7,8,9}));
 }
 
+TEST(FutureJoiner, JoinMoveOnlyValues)
+{
+    std::vector<ThreadContext<std::unique_ptr<int>>::Ptr> futures;
+    std::vector<const int*> addresses;
+    for (int i = 0; i < 10; ++i) {
+        futures.push_back(DispatcherSingleton::instance().post<std::unique_ptr<int>>(
+            [i](CoroContext<std::unique_ptr<int>>::Ptr ctx)->int {
+            return ctx->set(std::unique_ptr<int>(new int(i)));
+        }));
+        addresses.push_back(futures.back()->getRef().get());
+    }
+    auto joined = FutureJoiner<std::unique_ptr<int>>()(DispatcherSingleton::instance(), std::move(futures));
+    SharedFuture<std::vector<std::unique_ptr<int>>> shared = joined->share();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(addresses[i], shared.get()[i].get()); //moved, not copied
+        EXPECT_EQ(i, *shared.get()[i]);
+    }
+}
+
+TEST(SharedFuture, ManyReaders)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Promise<std::vector<int>>::Ptr promise = Promise<std::vector<int>>::create();
+    SharedFuture<std::vector<int>> shared = promise->getSharedFuture();
+    std::vector<ThreadContext<const std::vector<int>*>::Ptr> readers;
+    for (int i = 0; i < 10; ++i) {
+        readers.push_back(dispatcher.post<const std::vector<int>*>(
+            [shared](CoroContext<const std::vector<int>*>::Ptr ctx)->int {
+            return ctx->set(&shared.get(ctx));
+        }));
+    }
+    promise->set(std::vector<int>(1000, 7));
+    EXPECT_EQ(1000u, shared.get().size());
+    for (auto&& reader : readers) {
+        EXPECT_EQ(&shared.get(), reader->get()); //every reader sees the same object
+    }
+    EXPECT_EQ(7, shared.get()[999]);
+    EXPECT_FALSE(SharedFuture<int>().valid());
+    EXPECT_THROW(SharedFuture<int>().get(), FutureException);
+    
+    //shared from a context
+    auto ctx = dispatcher.post<std::string>([](CoroContext<std::string>::Ptr ctx)->int {
+        return ctx->set(std::string(100, 'x'));
+    });
+    SharedFuture<std::string> result = ctx->share();
+    EXPECT_EQ(&ctx->getRef(), &result.get());
+    
+    //exceptions are rethrown to every reader
+    Promise<int>::Ptr failed = Promise<int>::create();
+    SharedFuture<int> error = failed->getSharedFuture();
+    failed->setException(std::make_exception_ptr(std::runtime_error("failed")));
+    EXPECT_THROW(error.get(), std::runtime_error);
+    EXPECT_THROW(error.get(), std::runtime_error);
+}
+
+TEST(FutureJoiner, JoinCompletesWithLastFuture)
+{
+    std::vector<Promise<int>> promises(100);
+    std::vector<ThreadFuturePtr<int>> futures;
+    for (auto& promise : promises) {
+        futures.push_back(promise.getIThreadFuture());
+    }
+    ThreadFuturePtr<std::vector<int>> joined = FutureJoiner<int>()(DispatcherSingleton::instance(), std::move(futures));
+    std::vector<int> expected;
+    for (int i = 0; i < 100; ++i) {
+        expected.push_back(i);
+    }
+    for (int i = 99; i >= 0; --i) {
+        EXPECT_NE(std::future_status::ready, joined->waitFor(ms(0)));
+        promises[i].set(i);
+    }
+    EXPECT_EQ(std::future_status::ready, joined->waitFor(ms(0)));
+    EXPECT_EQ(expected, joined->get());
+    
+    //exceptions are propagated to the joined future
+    std::vector<Promise<int>> failingPromises(2);
+    std::vector<ThreadFuturePtr<int>> failingFutures{failingPromises[0].getIThreadFuture(),
+                                                     failingPromises[1].getIThreadFuture()};
+    joined = FutureJoiner<int>()(DispatcherSingleton::instance(), std::move(failingFutures));
+    failingPromises[1].setException(std::make_exception_ptr(std::runtime_error("failed")));
+    failingPromises[0].set(0);
+    EXPECT_THROW(joined->get(), std::runtime_error);
+}
+
+TEST(FutureSelector, WhenAnyThreadFutures)
+{
+    std::vector<Promise<int>> promises(5);
+    std::vector<ThreadFuturePtr<int>> futures;
+    for (auto& promise : promises) {
+        futures.push_back(promise.getIThreadFuture());
+    }
+    EXPECT_EQ(-1, FutureSelector<int>::waitForAny(futures, ms(10))); //timeout
+    std::thread t([&promises]{
+        std::this_thread::sleep_for(ms(20));
+        promises[3].set(33);
+    });
+    std::pair<size_t, int> result = FutureSelector<int>::whenAny(futures);
+    EXPECT_EQ(3u, result.first);
+    EXPECT_EQ(33, result.second);
+    t.join();
+    promises[1].set(11);
+    EXPECT_EQ(1, FutureSelector<int>::waitForAny(futures)); //first ready in index order
+}
+
+TEST(FutureSelector, WhenAnyCoroFutures)
+{
+    std::pair<size_t, int> result{0, 0};
+    int timeoutIndex = 0;
+    
+    DispatcherSingleton::instance().post([&](CoroContext<int>::Ptr ctx)->int {
+        std::vector<CoroContext<int>::Ptr> futures;
+        for (int i = 0; i < 5; ++i) {
+            futures.push_back(ctx->post([i](CoroContext<int>::Ptr ctx2)->int {
+                ctx2->sleep(ms(i == 2 ? 10 : 200));
+                return ctx2->set(i);
+            }));
+        }
+        timeoutIndex = FutureSelector<int>::waitForAny(ctx, futures, ms(1));
+        result = FutureSelector<int>::whenAny(ctx, futures);
+        return ctx->set(0);
+    })->get();
+    
+    EXPECT_EQ(-1, timeoutIndex);
+    EXPECT_EQ(2u, result.first);
+    EXPECT_EQ(2, result.second);
+}
+
 TEST(SerializeExecution, Basic)
 {
     std::unordered_map<int, CoroContextPtr<int>> entryMap;
@@ -172,6 +172,43 @@ TEST(Sequencer, TrimKeys)
     EXPECT_EQ(sequencer.getSequenceKeyCount(), 0u);
 }
 
+TEST(Sequencer, AutoTrimKeys)
+{
+    using namespace Bloomberg::quantum;
+
+    const int keyCount = 1000;
+    const int extraTaskCount = 200;
+    const SequencerTestData::SequenceKey extraKey = keyCount;
+    for (size_t threshold : {0, 100})
+    {
+        SequencerTestData testData;
+        SequencerTestData::TaskSequencer::Configuration config;
+        config.setTrimInterval(10);
+        config.setTrimBatchSize(64);
+        config.setTrimThreshold(threshold);
+        SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+        
+        // one short-lived key per task
+        for (SequencerTestData::TaskId id = 0; id < keyCount; ++id)
+        {
+            sequencer.post(id, testData.makeTask(id));
+        }
+        DispatcherSingleton::instance().drain();
+        
+        // the next posts trim the idle keys incrementally
+        for (SequencerTestData::TaskId id = keyCount; id < keyCount + extraTaskCount; ++id)
+        {
+            sequencer.post(extraKey, testData.makeTask(id));
+        }
+        DispatcherSingleton::instance().drain();
+        
+        size_t keysLeft = sequencer.getSequenceKeyCount();
+        EXPECT_GE(keysLeft, threshold);
+        EXPECT_LE(keysLeft, threshold + 1);
+        EXPECT_EQ(testData.results().size(), (size_t)(keyCount + extraTaskCount));
+    }
+}
+
 TEST(Sequencer, ExceptionHandler)
 {
     using namespace Bloomberg::quantum;
@@ -516,6 +553,436 @@ TEST(Sequencer, CustomHashFunction)
     }
 }
 
+TEST(Sequencer, ShardedControlQueues)
+{
+    using namespace Bloomberg::quantum;
+
+    const int taskCount = 100;
+    const int sequenceKeyCount = 8;
+    const int universalTaskFrequency = 23;
+    SequencerTestData testData;
+    SequencerTestData::SequenceKeyMap sequenceKeys;
+    std::vector<SequencerTestData::TaskId> universal;
+
+    SequencerTestData::TaskSequencerConfiguration config;
+    config.setControlQueueId(1);
+    config.setControlQueueCount(DispatcherSingleton::numCoro);
+    SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+
+    for(SequencerTestData::TaskId id = 0; id < taskCount; ++id)
+    {
+        if (id % universalTaskFrequency == 0)
+        {
+            universal.push_back(id);
+            sequencer.postAll(testData.makeTask(id));
+        }
+        else if (id % 3 == 0)
+        {
+            // these keys usually belong to different shards
+            std::vector<SequencerTestData::SequenceKey> keys{id % sequenceKeyCount, (id + 3) % sequenceKeyCount};
+            for (auto key : keys)
+            {
+                sequenceKeys[key].push_back(id);
+            }
+            sequencer.post(keys, testData.makeTask(id));
+        }
+        else
+        {
+            SequencerTestData::SequenceKey sequenceKey = id % sequenceKeyCount;
+            sequenceKeys[sequenceKey].push_back(id);
+            sequencer.post(sequenceKey, testData.makeTask(id));
+        }
+    }
+    DispatcherSingleton::instance().drain();
+
+    EXPECT_EQ(testData.results().size(), (size_t)taskCount);
+    EXPECT_EQ(sequencer.getSequenceKeyCount(), (size_t)sequenceKeyCount);
+    EXPECT_EQ(sequencer.getTaskStatistics().getPostedTaskCount(), (size_t)taskCount);
+    EXPECT_EQ(sequencer.getTaskStatistics().getPendingTaskCount(), 0u);
+
+    // the tasks must be ordered within the same sequenceKey, across shards
+    for(auto sequenceKeyData : sequenceKeys)
+    {
+        for(size_t i = 1; i < sequenceKeyData.second.size(); ++i)
+        {
+            testData.ensureOrder(sequenceKeyData.second[i-1], sequenceKeyData.second[i]);
+        }
+    }
+    // universal tasks are ordered with respect to all the others
+    for (auto universalTaskId : universal)
+    {
+        for(SequencerTestData::TaskId taskId = 0; taskId < taskCount; ++taskId)
+        {
+            if (taskId < universalTaskId)
+            {
+                testData.ensureOrder(taskId, universalTaskId);
+            }
+            else if (taskId > universalTaskId)
+            {
+                testData.ensureOrder(universalTaskId, taskId);
+            }
+        }
+    }
+    EXPECT_EQ(sequencer.trimSequenceKeys(), 0u);
+
+    config.setControlQueueCount(DispatcherSingleton::numCoro + 1);
+    EXPECT_THROW(SequencerTestData::TaskSequencer(DispatcherSingleton::instance(), config), std::out_of_range);
+}
+
+TEST(Sequencer, DirectDispatchModes)
+{
+    using namespace Bloomberg::quantum;
+
+    const int taskCount = 60;
+    const int sequenceKeyCount = 4;
+    for (bool directDispatch : {true, false})
+    {
+        SequencerTestData testData;
+        SequencerTestData::SequenceKeyMap sequenceKeys;
+        std::vector<SequencerTestData::TaskId> universal;
+
+        SequencerTestData::TaskSequencerConfiguration config;
+        config.setDirectDispatch(directDispatch);
+        SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+
+        for(SequencerTestData::TaskId id = 0; id < taskCount; ++id)
+        {
+            if (id % 17 == 0)
+            {
+                universal.push_back(id);
+                sequencer.postAll(testData.makeTask(id));
+            }
+            else if (id % 5 == 0)
+            {
+                // interleave multi-key tasks with the direct single key ones
+                std::vector<SequencerTestData::SequenceKey> keys{id % sequenceKeyCount, (id + 1) % sequenceKeyCount};
+                for (auto key : keys)
+                {
+                    sequenceKeys[key].push_back(id);
+                }
+                sequencer.post(keys, testData.makeTask(id));
+            }
+            else
+            {
+                SequencerTestData::SequenceKey sequenceKey = id % sequenceKeyCount;
+                sequenceKeys[sequenceKey].push_back(id);
+                sequencer.post(sequenceKey, testData.makeTask(id));
+            }
+        }
+        DispatcherSingleton::instance().drain();
+
+        EXPECT_EQ(testData.results().size(), (size_t)taskCount);
+        EXPECT_EQ(sequencer.getTaskStatistics().getPendingTaskCount(), 0u);
+        for(auto sequenceKeyData : sequenceKeys)
+        {
+            for(size_t i = 1; i < sequenceKeyData.second.size(); ++i)
+            {
+                testData.ensureOrder(sequenceKeyData.second[i-1], sequenceKeyData.second[i]);
+            }
+        }
+        for (auto universalTaskId : universal)
+        {
+            for(SequencerTestData::TaskId taskId = 0; taskId < taskCount; ++taskId)
+            {
+                if (taskId < universalTaskId)
+                {
+                    testData.ensureOrder(taskId, universalTaskId);
+                }
+                else if (taskId > universalTaskId)
+                {
+                    testData.ensureOrder(universalTaskId, taskId);
+                }
+            }
+        }
+        EXPECT_EQ(sequencer.trimSequenceKeys(), 0u);
+    }
+}
+
+TEST(Sequencer, BatchedTasks)
+{
+    using namespace Bloomberg::quantum;
+
+    const int taskCount = 300;
+    const int sequenceKeyCount = 2;
+    const int exceptionFrequency = 50;
+    SequencerTestData testData;
+    SequencerTestData::SequenceKeyMap sequenceKeys;
+    std::atomic<unsigned int> exceptionCallbackCallCount(0);
+
+    SequencerTestData::TaskSequencerConfiguration config;
+    config.setMaxBatchSize(16);
+    config.setExceptionCallback([&exceptionCallbackCallCount](std::exception_ptr, void*)
+    {
+        ++exceptionCallbackCallCount;
+    });
+    SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+
+    // a burst on a few hot keys is drained by a few coroutines
+    for(SequencerTestData::TaskId id = 0; id < taskCount; ++id)
+    {
+        SequencerTestData::SequenceKey sequenceKey = id % sequenceKeyCount;
+        if (id % exceptionFrequency == 0)
+        {
+            sequencer.post(sequenceKey, testData.makeTaskWithException(id, "Error"));
+        }
+        else
+        {
+            sequenceKeys[sequenceKey].push_back(id);
+            sequencer.post(sequenceKey, testData.makeTask(id));
+        }
+    }
+    DispatcherSingleton::instance().drain();
+
+    EXPECT_EQ(testData.results().size(), (size_t)(taskCount - taskCount / exceptionFrequency));
+    EXPECT_EQ(exceptionCallbackCallCount, (unsigned int)(taskCount / exceptionFrequency));
+    EXPECT_EQ(sequencer.getTaskStatistics().getPostedTaskCount(), (size_t)taskCount);
+    EXPECT_EQ(sequencer.getTaskStatistics().getPendingTaskCount(), 0u);
+    for(auto sequenceKeyData : sequenceKeys)
+    {
+        EXPECT_EQ(sequencer.getStatistics(sequenceKeyData.first).getPendingTaskCount(), 0u);
+        for(size_t i = 1; i < sequenceKeyData.second.size(); ++i)
+        {
+            testData.ensureOrder(sequenceKeyData.second[i-1], sequenceKeyData.second[i]);
+        }
+    }
+}
+
+TEST(Sequencer, HotKeysAndLatencyStats)
+{
+    using namespace Bloomberg::quantum;
+
+    const int hotTaskCount = 200;
+    const int coldKeyCount = 20;
+    const SequencerTestData::SequenceKey hotKey = 0;
+    SequencerTestData testData;
+
+    SequencerTestData::TaskSequencerConfiguration config;
+    config.setHotKeyCapacity(4);
+    SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+    EXPECT_TRUE(sequencer.getHotKeys(1).empty());
+
+    SequencerTestData::TaskId id = 0;
+    for (SequencerTestData::SequenceKey sequenceKey = 1; sequenceKey <= coldKeyCount; ++sequenceKey)
+    {
+        sequencer.post(sequenceKey, testData.makeTask(id++));
+        sequencer.post(hotKey, testData.makeTask(id++));
+    }
+    while (id < hotTaskCount + coldKeyCount)
+    {
+        sequencer.post(hotKey, testData.makeTask(id++));
+    }
+    // the hot key is reported while its tasks are still queued
+    auto hotKeys = sequencer.getHotKeys(1);
+    ASSERT_EQ(hotKeys.size(), 1u);
+    EXPECT_EQ(hotKeys.front().first, hotKey);
+    DispatcherSingleton::instance().drain();
+
+    hotKeys = sequencer.getHotKeys(10, SequencerTestData::TaskSequencer::HotKeyOrder::QueueingDelay);
+    ASSERT_EQ(hotKeys.size(), 4u);
+    EXPECT_EQ(hotKeys.front().first, hotKey);
+    const SequenceKeyStatistics& stats = hotKeys.front().second;
+    EXPECT_EQ(stats.getCompletedTaskCount(), (size_t)hotTaskCount);
+    EXPECT_EQ(stats.getPendingTaskCount(), 0u);
+    // the last task waited behind all the others
+    EXPECT_GE(stats.getMaxQueueingDelay(), std::chrono::milliseconds(hotTaskCount / 2));
+    EXPECT_GE(stats.getMaxQueueingDelay(), stats.getAverageQueueingDelay());
+    EXPECT_GT(stats.getAverageExecutionTime().count(), 0);
+    EXPECT_GE(stats.getMaxExecutionTime(), stats.getAverageExecutionTime());
+    EXPECT_EQ(sequencer.getTaskStatistics().getCompletedTaskCount(), (size_t)(hotTaskCount + coldKeyCount));
+}
+
+TEST(Sequencer, PendingTaskLimits)
+{
+    using namespace Bloomberg::quantum;
+    using Policy = SequencerTestData::TaskSequencerConfiguration::BackpressurePolicy;
+
+    {
+        // a stuck key rejects new tasks once its limit is reached while the other keys are unaffected
+        const size_t keyLimit = 5;
+        SequencerTestData testData;
+        SequencerTestData::TaskSequencerConfiguration config;
+        config.setMaxPendingTaskCountPerKey(keyLimit);
+        config.setBackpressurePolicy(Policy::Reject);
+        SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+        
+        std::atomic<bool> blockFlag(true);
+        SequencerTestData::TaskId id = 0;
+        sequencer.post(0, testData.makeTaskWithBlock(id++, &blockFlag));
+        while (sequencer.getStatistics(0).getPendingTaskCount() != 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (size_t i = 0; i < keyLimit; ++i)
+        {
+            sequencer.post(0, testData.makeTask(id++));
+        }
+        EXPECT_THROW(sequencer.post(0, testData.makeTask(id)), std::runtime_error);
+        sequencer.post(1, testData.makeTask(id++));
+        blockFlag = false;
+        DispatcherSingleton::instance().drain();
+        EXPECT_EQ(testData.results().size(), (size_t)id);
+        
+        // the permits are given back when the tasks start
+        sequencer.post(0, testData.makeTask(id++));
+        DispatcherSingleton::instance().drain();
+        EXPECT_EQ(testData.results().size(), (size_t)id);
+    }
+    {
+        // producer threads and coroutines are held back by the global limit
+        const size_t globalLimit = 2;
+        const int taskCount = 30;
+        SequencerTestData testData;
+        SequencerTestData::TaskSequencerConfiguration config;
+        config.setMaxPendingTaskCount(globalLimit);
+        config.setBackpressurePolicy(Policy::Block);
+        SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+        
+        std::atomic<size_t> maxPending(0);
+        for (SequencerTestData::TaskId id = 0; id < taskCount; ++id)
+        {
+            sequencer.post(id % 3, testData.makeTask(id));
+            maxPending = std::max(maxPending.load(), sequencer.getTaskStatistics().getPendingTaskCount());
+        }
+        DispatcherSingleton::instance().post([&](CoroContext<int>::Ptr ctx)->int
+        {
+            for (SequencerTestData::TaskId id = taskCount; id < 2 * taskCount; ++id)
+            {
+                sequencer.post(ctx, nullptr, (int)IQueue::QueueId::Any, false, id % 3, testData.makeTask(id));
+                maxPending = std::max(maxPending.load(), sequencer.getTaskStatistics().getPendingTaskCount());
+            }
+            return ctx->set(0);
+        })->get();
+        DispatcherSingleton::instance().drain();
+        EXPECT_EQ(testData.results().size(), (size_t)(2 * taskCount));
+        EXPECT_LE(maxPending, globalLimit);
+    }
+}
+
+TEST(Sequencer, UniversalEpochs)
+{
+    using namespace Bloomberg::quantum;
+
+    const int taskCount = 400;
+    const int sequenceKeyCount = 50;
+    const int universalTaskFrequency = 37;
+    SequencerTestData testData;
+    SequencerTestData::SequenceKeyMap sequenceKeys;
+    std::vector<SequencerTestData::TaskId> universal;
+
+    SequencerTestData::TaskSequencerConfiguration config;
+    config.setMaxBatchSize(8);
+    SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance(), config);
+
+    for(SequencerTestData::TaskId id = 0; id < taskCount; ++id)
+    {
+        // back-to-back universal tasks must also be ordered with each other
+        if (id % universalTaskFrequency == 0 || id % universalTaskFrequency == 1)
+        {
+            universal.push_back(id);
+            sequencer.postAll(testData.makeTask(id));
+        }
+        else
+        {
+            SequencerTestData::SequenceKey sequenceKey = id % sequenceKeyCount;
+            sequenceKeys[sequenceKey].push_back(id);
+            sequencer.post(sequenceKey, testData.makeTask(id));
+        }
+    }
+    DispatcherSingleton::instance().drain();
+
+    EXPECT_EQ(testData.results().size(), (size_t)taskCount);
+    EXPECT_EQ(sequencer.getStatistics().getPostedTaskCount(), universal.size());
+    EXPECT_EQ(sequencer.getStatistics().getPendingTaskCount(), 0u);
+    EXPECT_EQ(sequencer.getTaskStatistics().getPendingTaskCount(), 0u);
+    for(auto sequenceKeyData : sequenceKeys)
+    {
+        for(size_t i = 1; i < sequenceKeyData.second.size(); ++i)
+        {
+            testData.ensureOrder(sequenceKeyData.second[i-1], sequenceKeyData.second[i]);
+        }
+    }
+    for (auto universalTaskId : universal)
+    {
+        for(SequencerTestData::TaskId taskId = 0; taskId < taskCount; ++taskId)
+        {
+            if (taskId < universalTaskId)
+            {
+                testData.ensureOrder(taskId, universalTaskId);
+            }
+            else if (taskId > universalTaskId)
+            {
+                testData.ensureOrder(universalTaskId, taskId);
+            }
+        }
+    }
+}
+
+TEST(Sequencer, MultiKeyJoin)
+{
+    using namespace Bloomberg::quantum;
+
+    const int taskCount = 300;
+    const int sequenceKeyCount = 6;
+    const int universalTaskFrequency = 41;
+    SequencerTestData testData;
+    SequencerTestData::SequenceKeyMap sequenceKeys;
+    std::vector<SequencerTestData::TaskId> universal;
+
+    SequencerTestData::TaskSequencer sequencer(DispatcherSingleton::instance());
+    for(SequencerTestData::TaskId id = 0; id < taskCount; ++id)
+    {
+        if (id % universalTaskFrequency == 0)
+        {
+            universal.push_back(id);
+            sequencer.postAll(testData.makeTask(id));
+        }
+        else if (id % 2 == 0)
+        {
+            // the first key is listed twice
+            std::vector<SequencerTestData::SequenceKey> keys{id % sequenceKeyCount,
+                                                             (id + 1) % sequenceKeyCount,
+                                                             id % sequenceKeyCount};
+            sequenceKeys[keys[0]].push_back(id);
+            sequenceKeys[keys[1]].push_back(id);
+            sequencer.post(keys, testData.makeTask(id));
+        }
+        else
+        {
+            SequencerTestData::SequenceKey sequenceKey = id % sequenceKeyCount;
+            sequenceKeys[sequenceKey].push_back(id);
+            sequencer.post(sequenceKey, testData.makeTask(id));
+        }
+    }
+    DispatcherSingleton::instance().drain();
+
+    EXPECT_EQ(testData.results().size(), (size_t)taskCount);
+    EXPECT_EQ(sequencer.getTaskStatistics().getPostedTaskCount(), (size_t)taskCount);
+    EXPECT_EQ(sequencer.getTaskStatistics().getPendingTaskCount(), 0u);
+    for(auto sequenceKeyData : sequenceKeys)
+    {
+        EXPECT_EQ(sequencer.getStatistics(sequenceKeyData.first).getPendingTaskCount(), 0u);
+        for(size_t i = 1; i < sequenceKeyData.second.size(); ++i)
+        {
+            testData.ensureOrder(sequenceKeyData.second[i-1], sequenceKeyData.second[i]);
+        }
+    }
+    for (auto universalTaskId : universal)
+    {
+        for(SequencerTestData::TaskId taskId = 0; taskId < taskCount; ++taskId)
+        {
+            if (taskId < universalTaskId)
+            {
+                testData.ensureOrder(taskId, universalTaskId);
+            }
+            else if (taskId > universalTaskId)
+            {
+                testData.ensureOrder(universalTaskId, taskId);
+            }
+        }
+    }
+    EXPECT_EQ(sequencer.trimSequenceKeys(), 0u);
+}
+
 //This test **must** come last to make Valgrind happy.
 TEST(Sequencer, DeleteDispatcherInstance)
 {